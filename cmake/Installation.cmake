@@ -41,6 +41,7 @@ if(APPLE)
   
   install(FILES img/icons/qtox.icns DESTINATION ${BUNDLE_PATH}/Contents/Resources/)
   install(FILES img/icons/qtox_profile.icns DESTINATION ${BUNDLE_PATH}/Contents/Resources/)
+  install(FILES ${${PROJECT_NAME}_RCC_FILES} DESTINATION ${BUNDLE_PATH}/Contents/Resources/)
 
   install(CODE "
   message(STATUS \"Creating dmg image\")
@@ -52,6 +53,8 @@ else()
   # follow the xdg-desktop specification
   install(TARGETS ${PROJECT_NAME} RUNTIME DESTINATION "${CMAKE_INSTALL_BINDIR}")
   install(FILES "res/io.github.qtox.qTox.appdata.xml" DESTINATION "${CMAKE_INSTALL_DATAROOTDIR}/metainfo")
+  # lazily registered asset bundles, looked up via the generic data dirs
+  install(FILES ${${PROJECT_NAME}_RCC_FILES} DESTINATION "${CMAKE_INSTALL_DATAROOTDIR}/qtox")
   install(FILES "io.github.qtox.qTox.desktop" DESTINATION "${CMAKE_INSTALL_DATAROOTDIR}/applications")
 
   # Install application icons according to the XDG spec
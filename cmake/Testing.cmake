@@ -34,6 +34,7 @@ function(auto_test subsystem module)
     COMMAND ${TEST_CROSSCOMPILING_EMULATOR} test_${module})
 endfunction()
 
+auto_test(audio audiokernels)
 auto_test(core core)
 auto_test(core contactid)
 auto_test(core toxid)
@@ -45,6 +46,7 @@ auto_test(persistence paths)
 auto_test(persistence dbschema)
 auto_test(persistence offlinemsgengine)
 auto_test(model friendmessagedispatcher)
+auto_test(model inboundmsgqueue)
 auto_test(model groupmessagedispatcher)
 auto_test(model messageprocessor)
 auto_test(model sessionchatlog)
@@ -52,3 +54,35 @@ auto_test(model sessionchatlog)
 if (UNIX)
   auto_test(platform posixsignalnotifier)
 endif()
+
+# Benchmarks are built on request and never registered with ctest; run
+# qtox_bench_db by hand and compare its JSON output across revisions.
+add_executable(qtox_bench_db EXCLUDE_FROM_ALL
+  test/persistence/db_bench.cpp)
+target_link_libraries(qtox_bench_db
+  ${PROJECT_NAME}_static
+  Qt5::Test)
+
+add_executable(qtox_bench_chatlog EXCLUDE_FROM_ALL
+  test/chatlog/chatlog_bench.cpp)
+target_link_libraries(qtox_bench_chatlog
+  ${PROJECT_NAME}_static
+  Qt5::Test)
+
+add_executable(qtox_bench_video EXCLUDE_FROM_ALL
+  test/video/videoframe_bench.cpp)
+target_link_libraries(qtox_bench_video
+  ${PROJECT_NAME}_static
+  Qt5::Test)
+
+add_executable(qtox_bench_audio EXCLUDE_FROM_ALL
+  test/audio/audio_bench.cpp)
+target_link_libraries(qtox_bench_audio
+  ${PROJECT_NAME}_static
+  Qt5::Test)
+
+add_executable(qtox_soak_messagestorm EXCLUDE_FROM_ALL
+  test/model/messagestorm_soak.cpp)
+target_link_libraries(qtox_soak_messagestorm
+  ${PROJECT_NAME}_static
+  Qt5::Test)
@@ -83,6 +83,20 @@ void AlSink::stopLoop()
     }
 }
 
+uint32_t AlSink::getJitterTargetDepth() const
+{
+    QMutexLocker{&killLock};
+
+    return killed ? 0 : audio.getJitterTargetDepth(sourceId);
+}
+
+uint64_t AlSink::getJitterUnderruns() const
+{
+    QMutexLocker{&killLock};
+
+    return killed ? 0 : audio.getJitterUnderruns(sourceId);
+}
+
 uint AlSink::getSourceId() const
 {
     uint tmp = sourceId;
@@ -43,6 +43,9 @@ public:
     void startLoop();
     void stopLoop();
 
+    uint32_t getJitterTargetDepth() const;
+    uint64_t getJitterUnderruns() const;
+
     operator bool() const;
 
     uint getSourceId() const;
@@ -0,0 +1,256 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "audiokernels.h"
+
+#include <QtGlobal>
+
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief Applies a gain factor to 16-bit PCM samples, clipping to the sample range.
+ *
+ * The vector paths process eight samples per iteration: widen to 32 bit,
+ * scale in single precision with round-to-nearest, and let the saturating
+ * narrowing store do the clipping. NEON is only used on AArch64, where
+ * vcvtnq gives the same round-to-nearest as the scalar qRound.
+ *
+ * @param buffer the samples to scale in place.
+ * @param samples number of samples in the buffer.
+ * @param gainFactor linear gain factor to apply.
+ */
+void AudioKernels::applyGain(int16_t* buffer, uint32_t samples, float gainFactor)
+{
+    uint32_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128 gainVec = _mm_set1_ps(gainFactor);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= samples; i += 8) {
+        const __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + i));
+        // widen to 32 bit with sign extension
+        const __m128i negMask = _mm_cmpgt_epi16(zero, pcm);
+        const __m128i lo = _mm_unpacklo_epi16(pcm, negMask);
+        const __m128i hi = _mm_unpackhi_epi16(pcm, negMask);
+        const __m128i loScaled = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(lo), gainVec));
+        const __m128i hiScaled = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(hi), gainVec));
+        // the saturating pack is the clipping step
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + i),
+                         _mm_packs_epi32(loScaled, hiScaled));
+    }
+#elif defined(__aarch64__)
+    const float32x4_t gainVec = vdupq_n_f32(gainFactor);
+    for (; i + 8 <= samples; i += 8) {
+        const int16x8_t pcm = vld1q_s16(buffer + i);
+        const int32x4_t lo = vmovl_s16(vget_low_s16(pcm));
+        const int32x4_t hi = vmovl_s16(vget_high_s16(pcm));
+        const int32x4_t loScaled = vcvtnq_s32_f32(vmulq_f32(vcvtq_f32_s32(lo), gainVec));
+        const int32x4_t hiScaled = vcvtnq_s32_f32(vmulq_f32(vcvtq_f32_s32(hi), gainVec));
+        vst1q_s16(buffer + i, vcombine_s16(vqmovn_s32(loScaled), vqmovn_s32(hiScaled)));
+    }
+#endif
+
+    for (; i < samples; ++i) {
+        // gain amplification with clipping to 16-bit boundaries
+        buffer[i] =
+            qBound<int16_t>(std::numeric_limits<int16_t>::min(), qRound(buffer[i] * gainFactor),
+                            std::numeric_limits<int16_t>::max());
+    }
+}
+
+/**
+ * @brief Sums the squares of 16-bit PCM samples in single precision.
+ *
+ * Used for RMS volume measurement; the caller normalizes the result.
+ *
+ * @param buffer the samples to measure.
+ * @param samples number of samples in the buffer.
+ * @return the sum of the squared raw amplitudes.
+ */
+float AudioKernels::sumOfSquares(const int16_t* buffer, uint32_t samples)
+{
+    float sum = 0.0f;
+    uint32_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 8 <= samples; i += 8) {
+        const __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + i));
+        const __m128i negMask = _mm_cmpgt_epi16(zero, pcm);
+        const __m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(pcm, negMask));
+        const __m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(pcm, negMask));
+        acc = _mm_add_ps(acc, _mm_mul_ps(lo, lo));
+        acc = _mm_add_ps(acc, _mm_mul_ps(hi, hi));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__aarch64__)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 8 <= samples; i += 8) {
+        const int16x8_t pcm = vld1q_s16(buffer + i);
+        const float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(pcm)));
+        const float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(pcm)));
+        acc = vmlaq_f32(acc, lo, lo);
+        acc = vmlaq_f32(acc, hi, hi);
+    }
+    sum = vaddvq_f32(acc);
+#endif
+
+    for (; i < samples; ++i) {
+        const float sample = buffer[i];
+        sum += sample * sample;
+    }
+
+    return sum;
+}
+
+/**
+ * @brief Number of output frames a rate conversion produces.
+ * @param inFrames frames per channel in the input.
+ * @param inRate sample rate of the input.
+ * @param outRate sample rate of the output.
+ * @return frames per channel resampleLinear will write.
+ */
+uint32_t AudioKernels::resampledFrameCount(uint32_t inFrames, uint32_t inRate, uint32_t outRate)
+{
+    return static_cast<uint32_t>(static_cast<uint64_t>(inFrames) * outRate / inRate);
+}
+
+/**
+ * @brief Resamples interleaved 16-bit PCM by linear interpolation.
+ *
+ * The phase accumulator runs in 32.32 fixed point so long buffers don't
+ * drift; the interpolation itself happens in single precision like the
+ * other kernels. The vector paths cover the mono case, which is what call
+ * audio is - sample pairs are gathered scalar (neither SSE2 nor the NEON
+ * baseline has a usable gather) and the widen/interpolate/narrow arithmetic
+ * runs eight outputs per iteration. Stereo and tails take the scalar loop.
+ *
+ * Linear interpolation is deliberate: the streams this feeds already went
+ * through a lossy voice codec, so a windowed-sinc stage would burn cycles
+ * polishing quantization noise.
+ *
+ * @param in input samples, inFrames * channels of them.
+ * @param inFrames frames per channel in the input.
+ * @param out output buffer with room for outFrames * channels samples.
+ * @param outFrames frames per channel to produce, see resampledFrameCount().
+ * @param channels interleaved channel count, 1 or 2.
+ */
+void AudioKernels::resampleLinear(const int16_t* in, uint32_t inFrames, int16_t* out,
+                                  uint32_t outFrames, unsigned channels)
+{
+    if (inFrames == 0 || outFrames == 0) {
+        return;
+    }
+
+    if (inFrames == 1) {
+        // nothing to interpolate with, hold the single frame
+        for (uint32_t f = 0; f < outFrames; ++f) {
+            for (unsigned c = 0; c < channels; ++c) {
+                out[f * channels + c] = in[c];
+            }
+        }
+        return;
+    }
+
+    // scaling by (inFrames - 1) keeps every interpolation pair inside the
+    // input, so the gathers below never read past the last frame
+    const uint64_t step = (static_cast<uint64_t>(inFrames - 1) << 32) / outFrames;
+    uint64_t pos = 0;
+    uint32_t i = 0;
+
+#if defined(__SSE2__)
+    if (channels == 1) {
+        for (; i + 8 <= outFrames; i += 8) {
+            alignas(16) int16_t s0[8];
+            alignas(16) int16_t s1[8];
+            alignas(16) float frac[8];
+            for (int lane = 0; lane < 8; ++lane) {
+                const uint32_t idx = static_cast<uint32_t>(pos >> 32);
+                s0[lane] = in[idx];
+                s1[lane] = in[idx + 1];
+                frac[lane] = static_cast<uint32_t>(pos & 0xFFFFFFFFu) * (1.0f / 4294967296.0f);
+                pos += step;
+            }
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i v0 = _mm_load_si128(reinterpret_cast<const __m128i*>(s0));
+            const __m128i v1 = _mm_load_si128(reinterpret_cast<const __m128i*>(s1));
+            const __m128i neg0 = _mm_cmpgt_epi16(zero, v0);
+            const __m128i neg1 = _mm_cmpgt_epi16(zero, v1);
+            const __m128 lo0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(v0, neg0));
+            const __m128 hi0 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(v0, neg0));
+            const __m128 lo1 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(v1, neg1));
+            const __m128 hi1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(v1, neg1));
+            const __m128 fracLo = _mm_load_ps(frac);
+            const __m128 fracHi = _mm_load_ps(frac + 4);
+            // s0 + (s1 - s0) * frac, rounded back to 16 bit by the pack
+            const __m128i outLo =
+                _mm_cvtps_epi32(_mm_add_ps(lo0, _mm_mul_ps(_mm_sub_ps(lo1, lo0), fracLo)));
+            const __m128i outHi =
+                _mm_cvtps_epi32(_mm_add_ps(hi0, _mm_mul_ps(_mm_sub_ps(hi1, hi0), fracHi)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(outLo, outHi));
+        }
+    }
+#elif defined(__aarch64__)
+    if (channels == 1) {
+        for (; i + 8 <= outFrames; i += 8) {
+            alignas(16) int16_t s0[8];
+            alignas(16) int16_t s1[8];
+            alignas(16) float frac[8];
+            for (int lane = 0; lane < 8; ++lane) {
+                const uint32_t idx = static_cast<uint32_t>(pos >> 32);
+                s0[lane] = in[idx];
+                s1[lane] = in[idx + 1];
+                frac[lane] = static_cast<uint32_t>(pos & 0xFFFFFFFFu) * (1.0f / 4294967296.0f);
+                pos += step;
+            }
+            const int16x8_t v0 = vld1q_s16(s0);
+            const int16x8_t v1 = vld1q_s16(s1);
+            const float32x4_t lo0 = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v0)));
+            const float32x4_t hi0 = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v0)));
+            const float32x4_t lo1 = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v1)));
+            const float32x4_t hi1 = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v1)));
+            const int32x4_t outLo =
+                vcvtnq_s32_f32(vmlaq_f32(lo0, vsubq_f32(lo1, lo0), vld1q_f32(frac)));
+            const int32x4_t outHi =
+                vcvtnq_s32_f32(vmlaq_f32(hi0, vsubq_f32(hi1, hi0), vld1q_f32(frac + 4)));
+            vst1q_s16(out + i, vcombine_s16(vqmovn_s32(outLo), vqmovn_s32(outHi)));
+        }
+    }
+#endif
+
+    for (; i < outFrames; ++i) {
+        const uint32_t idx = static_cast<uint32_t>(pos >> 32);
+        const float frac = static_cast<uint32_t>(pos & 0xFFFFFFFFu) * (1.0f / 4294967296.0f);
+        for (unsigned c = 0; c < channels; ++c) {
+            const float s0 = in[idx * channels + c];
+            const float s1 = in[(idx + 1) * channels + c];
+            out[i * channels + c] = static_cast<int16_t>(qRound(s0 + (s1 - s0) * frac));
+        }
+        pos += step;
+    }
+}
@@ -0,0 +1,38 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIOKERNELS_H
+#define AUDIOKERNELS_H
+
+#include <cstdint>
+
+/**
+ * Per-sample kernels on the audio hot path. Vectorized (SSE2 on x86,
+ * NEON on AArch64) where the target supports it; the scalar loop doubles
+ * as tail handling and as the fallback for everything else.
+ */
+namespace AudioKernels {
+void applyGain(int16_t* buffer, uint32_t samples, float gainFactor);
+float sumOfSquares(const int16_t* buffer, uint32_t samples);
+uint32_t resampledFrameCount(uint32_t inFrames, uint32_t inRate, uint32_t outRate);
+void resampleLinear(const int16_t* in, uint32_t inFrames, int16_t* out, uint32_t outFrames,
+                    unsigned channels);
+}
+
+#endif // AUDIOKERNELS_H
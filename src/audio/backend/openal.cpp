@@ -18,7 +18,9 @@
 */
 
 #include "openal.h"
+#include "src/audio/backend/audiokernels.h"
 #include "src/persistence/settings.h"
+#include "src/util/workerpool.h"
 
 #include <QDebug>
 #include <QFile>
@@ -30,18 +32,6 @@
 
 #include <cassert>
 
-namespace {
-void applyGain(int16_t* buffer, uint32_t bufferSize, qreal gainFactor)
-{
-    for (quint32 i = 0; i < bufferSize; ++i) {
-        // gain amplification with clipping to 16-bit boundaries
-        buffer[i] =
-            qBound<int16_t>(std::numeric_limits<int16_t>::min(), qRound(buffer[i] * gainFactor),
-                            std::numeric_limits<int16_t>::max());
-    }
-}
-} // namespace
-
 /**
  * @class OpenAL
  * @brief Provides the OpenAL audio backend
@@ -55,6 +45,8 @@ void applyGain(int16_t* buffer, uint32_t bufferSize, qreal gainFactor)
 
 static const unsigned int BUFFER_COUNT = 16;
 static const uint32_t AUDIO_CHANNELS = 2;
+// while the input gate is closed, let one frame per 500 ms through anyway
+static const uint32_t GATE_KEEPALIVE_FRAMES = 500 / AUDIO_FRAME_DURATION;
 
 OpenAL::OpenAL()
     : audioThread{new QThread}
@@ -80,9 +72,8 @@ OpenAL::OpenAL()
     captureTimer.setInterval(AUDIO_FRAME_DURATION / 2);
     captureTimer.setSingleShot(false);
     captureTimer.moveToThread(audioThread);
-    // TODO for Qt 5.6+: use qOverload
-    connect(audioThread, &QThread::started, &captureTimer,
-            static_cast<void (QTimer::*)(void)>(&QTimer::start));
+    // only runs while a capture device is open (see initInput/cleanupInput);
+    // without one there is nothing to poll for at frame rate
 
     cleanupTimer.setInterval(1000);
     cleanupTimer.setSingleShot(false);
@@ -91,7 +82,7 @@ OpenAL::OpenAL()
     connect(audioThread, &QThread::started, &cleanupTimer,
             static_cast<void (QTimer::*)(void)>(&QTimer::start));
 
-    audioThread->start();
+    audioThread->start(WorkerPool::threadPriority(WorkerPool::Priority::Realtime));
 }
 
 OpenAL::~OpenAL()
@@ -218,8 +209,10 @@ void OpenAL::reinitInput(const QString& inDevDesc)
 {
     QMutexLocker locker(&audioLock);
 
+    QMutexLocker srcLocker(&sourcesLock);
     const auto bakSources = sources;
     sources.clear();
+    srcLocker.unlock();
 
     cleanupInput();
     initInput(inDevDesc);
@@ -308,6 +301,8 @@ void OpenAL::destroySink(AlSink& sink)
         qWarning() << "Trying to delete invalid audio source" << sid;
     }
 
+    jitterStates.erase(sid);
+
     if (sinks.empty() && soundSinks.empty()) {
         cleanupOutput();
     }
@@ -332,7 +327,10 @@ std::unique_ptr<IAudioSource> OpenAL::makeSource()
         return {};
     }
 
-    sources.insert(source);
+    {
+        QMutexLocker srcLocker(&sourcesLock);
+        sources.insert(source);
+    }
 
     qDebug() << "Subscribed to audio input device [" << sources.size() << "subscriptions ]";
 
@@ -348,6 +346,7 @@ void OpenAL::destroySource(AlSource& source)
 {
     QMutexLocker locker(&audioLock);
 
+    QMutexLocker srcLocker(&sourcesLock);
     const auto s = sources.find(&source);
     if (s == sources.end()) {
         qWarning() << "Destroyed non-existant source";
@@ -355,6 +354,7 @@ void OpenAL::destroySource(AlSource& source)
     }
 
     sources.erase(s);
+    srcLocker.unlock();
 
     qDebug() << "Unsubscribed from audio input device [" << sources.size() << "subscriptions left ]";
 
@@ -417,12 +417,18 @@ bool OpenAL::initInput(const QString& deviceName, uint32_t channels)
     }
 
     inputBuffer = new int16_t[AUDIO_FRAME_SAMPLE_COUNT_TOTAL];
+    // discard anything still queued from a previously open device
+    captureRingRead.store(captureRingWrite.load(std::memory_order_relaxed),
+                          std::memory_order_release);
     setInputGain(Settings::getInstance().getAudioInGainDecibel());
     setInputThreshold(Settings::getInstance().getAudioThreshold());
 
     qDebug() << "Opened audio input" << deviceName;
     alcCaptureStart(alInDev);
 
+    // timers can only be touched from their own thread
+    QMetaObject::invokeMethod(&captureTimer, "start");
+
     return true;
 }
 
@@ -468,45 +474,64 @@ bool OpenAL::initOutput(const QString& deviceName)
 }
 
 /**
- * @brief Play a 48kHz mono 16bit PCM sound
+ * @brief Returns the pre-staged OpenAL buffer for a notification sound.
+ * @return Buffer id on success, 0 else.
+ *
+ * The PCM data is read from the resource once per process and the buffer is
+ * uploaded once per output context, so replaying a notification costs no
+ * I/O and no buffer upload. Must be called with audioLock held.
  */
-void OpenAL::playMono16Sound(AlSink& sink, const IAudioSink::Sound& sound)
+ALuint OpenAL::getSoundBuffer(const IAudioSink::Sound& sound)
 {
-    const uint sourceId = sink.getSourceId();
-    QFile sndFile(IAudioSink::getSound(sound));
-    if (!sndFile.exists()) {
-        qDebug() << "Trying to open non existent sound file";
-        return;
+    const int key = static_cast<int>(sound);
+    const auto bufIt = soundBufferCache.find(key);
+    if (bufIt != soundBufferCache.end()) {
+        return bufIt->second;
+    }
+
+    auto pcmIt = soundPcmCache.find(key);
+    if (pcmIt == soundPcmCache.end()) {
+        QFile sndFile(IAudioSink::getSound(sound));
+        if (!sndFile.exists()) {
+            qDebug() << "Trying to open non existent sound file";
+            return 0;
+        }
+
+        sndFile.open(QIODevice::ReadOnly);
+        pcmIt = soundPcmCache.emplace(key, sndFile.readAll()).first;
     }
 
-    sndFile.open(QIODevice::ReadOnly);
-    const QByteArray data{sndFile.readAll()};
+    const QByteArray& data = pcmIt->second;
     if (data.isEmpty()) {
         qDebug() << "Sound file contained no data";
-        return;
+        return 0;
     }
 
-    QMutexLocker locker(&audioLock);
+    ALuint bufid = 0;
+    alGenBuffers(1, &bufid);
+    alBufferData(bufid, AL_FORMAT_MONO16, data.constData(), data.size(), AUDIO_SAMPLE_RATE);
+    soundBufferCache.emplace(key, bufid);
+    return bufid;
+}
 
-    // interrupt possibly playing sound, we don't buffer here
-    alSourceStop(sourceId);
+/**
+ * @brief Play a 48kHz mono 16bit PCM sound
+ */
+void OpenAL::playMono16Sound(AlSink& sink, const IAudioSink::Sound& sound)
+{
+    const uint sourceId = sink.getSourceId();
 
-    ALint processed = 0;
-    alGetSourcei(sourceId, AL_BUFFERS_PROCESSED, &processed);
-    alSourcei(sourceId, AL_LOOPING, AL_FALSE);
+    QMutexLocker locker(&audioLock);
 
-    ALuint bufid;
-    if (processed == 0) {
-        // create new buffer
-        alGenBuffers(1, &bufid);
-    } else {
-        // we only reserve space for one buffer
-        assert(processed == 1);
-        // unqueue all processed buffers
-        alSourceUnqueueBuffers(sourceId, processed, &bufid);
+    const ALuint bufid = getSoundBuffer(sound);
+    if (bufid == 0) {
+        return;
     }
 
-    alBufferData(bufid, AL_FORMAT_MONO16, data.constData(), data.size(), AUDIO_SAMPLE_RATE);
+    // interrupt possibly playing sound; the shared buffer is attached
+    // statically, so there is no queue to maintain
+    alSourceStop(sourceId);
+    alSourcei(sourceId, AL_LOOPING, AL_FALSE);
     alSourcei(sourceId, AL_BUFFER, bufid);
     alSourcePlay(sourceId);
     soundSinks.insert(&sink);
@@ -561,17 +586,85 @@ void OpenAL::playAudioBuffer(uint sourceId, const int16_t* data, int samples, un
         alDeleteBuffers(processed - 1, bufids + 1);
     }
 
+    // Queue everything at the device rate. Converting here replaces the
+    // per-source scalar resampler OpenAL would otherwise run on every
+    // mixed stream with one shared vector stage, which is what keeps a
+    // group call full of 24k/16k streams off the audio thread's back.
+    if (sampleRate != static_cast<int>(AUDIO_SAMPLE_RATE)) {
+        const uint32_t outFrames =
+            AudioKernels::resampledFrameCount(samples, sampleRate, AUDIO_SAMPLE_RATE);
+        if (resampleBuffer.size() < outFrames * channels) {
+            resampleBuffer.resize(outFrames * channels);
+        }
+        AudioKernels::resampleLinear(data, samples, resampleBuffer.data(), outFrames, channels);
+        data = resampleBuffer.data();
+        samples = outFrames;
+    }
+
     alBufferData(bufids[0], (channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16, data,
-                 samples * 2 * channels, sampleRate);
+                 samples * 2 * channels, AUDIO_SAMPLE_RATE);
     alSourceQueueBuffers(sourceId, 1, bufids);
 
+    JitterState& jitter = jitterStates[sourceId];
+    if (jitter.arrivalTimer.isValid()) {
+        // EWMA of the inter-arrival time and its variance (alpha = 1/16);
+        // the target depth covers the mean plus two standard deviations.
+        const double interval = jitter.arrivalTimer.restart();
+        jitter.meanIntervalMs += (interval - jitter.meanIntervalMs) / 16.0;
+        const double deviation = interval - jitter.meanIntervalMs;
+        jitter.varIntervalMs += (deviation * deviation - jitter.varIntervalMs) / 16.0;
+        const double depthMs = jitter.meanIntervalMs + 2.0 * std::sqrt(jitter.varIntervalMs);
+        jitter.targetDepth =
+            qBound<uint32_t>(1, static_cast<uint32_t>(std::ceil(depthMs / AUDIO_FRAME_DURATION)),
+                             BUFFER_COUNT / 2);
+    } else {
+        jitter.arrivalTimer.start();
+    }
+
     ALint state;
     alGetSourcei(sourceId, AL_SOURCE_STATE, &state);
     if (state != AL_PLAYING) {
-        alSourcePlay(sourceId);
+        if (!jitter.prebuffering) {
+            // the queue drained while we were playing, wait for the target
+            // depth to rebuild before restarting instead of stuttering along
+            ++jitter.underruns;
+            jitter.prebuffering = true;
+        }
+
+        alGetSourcei(sourceId, AL_BUFFERS_QUEUED, &queued);
+        if (static_cast<uint32_t>(queued) >= jitter.targetDepth) {
+            alSourcePlay(sourceId);
+            jitter.prebuffering = false;
+        }
     }
 }
 
+/**
+ * @brief Current target depth of a sink's adaptive jitter buffer.
+ * @param sourceId The id of the source backing the sink.
+ * @return Target queue depth in frames, 0 if the source is unknown.
+ */
+uint32_t OpenAL::getJitterTargetDepth(uint sourceId) const
+{
+    QMutexLocker locker(&audioLock);
+
+    const auto it = jitterStates.find(sourceId);
+    return it != jitterStates.end() ? it->second.targetDepth : 0;
+}
+
+/**
+ * @brief Number of times a sink's queue drained while playing.
+ * @param sourceId The id of the source backing the sink.
+ * @return Underrun count, 0 if the source is unknown.
+ */
+uint64_t OpenAL::getJitterUnderruns(uint sourceId) const
+{
+    QMutexLocker locker(&audioLock);
+
+    const auto it = jitterStates.find(sourceId);
+    return it != jitterStates.end() ? it->second.underruns : 0;
+}
+
 /**
  * @brief Close active audio input device.
  */
@@ -581,6 +674,8 @@ void OpenAL::cleanupInput()
         return;
 
     qDebug() << "Closing audio input";
+    // timers can only be touched from their own thread
+    QMetaObject::invokeMethod(&captureTimer, "stop");
     alcCaptureStop(alInDev);
     if (alcCaptureCloseDevice(alInDev) == ALC_TRUE) {
         alInDev = nullptr;
@@ -599,6 +694,12 @@ void OpenAL::cleanupOutput()
     outputInitialized = false;
 
     if (alOutDev) {
+        // the pre-staged notification buffers belong to this context
+        for (const auto& entry : soundBufferCache) {
+            alDeleteBuffers(1, &entry.second);
+        }
+        soundBufferCache.clear();
+
         if (!alcMakeContextCurrent(nullptr)) {
             qWarning("Failed to clear audio context.");
         }
@@ -616,22 +717,20 @@ void OpenAL::cleanupOutput()
 }
 
 /**
- * @brief Called by doCapture to calculate volume of the audio buffer
+ * @brief Called by doInput to calculate volume of the audio buffer
  *
- * @param[in] buf   the current audio buffer
+ * @param[in] buffer   the current audio buffer
  *
  * @return normalized volume between 0-1
  */
-float OpenAL::getVolume()
+float OpenAL::getVolume(const int16_t* buffer)
 {
     const quint32 samples = AUDIO_FRAME_SAMPLE_COUNT_TOTAL;
     const float rootTwo = 1.414213562; // sqrt(2), but sqrt is not constexpr
     // calculate volume as the root mean squared of amplitudes in the sample
-    float sumOfSquares = 0;
-    for (quint32 i = 0; i < samples; i++) {
-        float sample = static_cast<float>(inputBuffer[i]) / std::numeric_limits<int16_t>::max();
-        sumOfSquares += std::pow(sample, 2);
-    }
+    const float maxAmplitude = std::numeric_limits<int16_t>::max();
+    const float sumOfSquares =
+        AudioKernels::sumOfSquares(buffer, samples) / (maxAmplitude * maxAmplitude);
     const float rms = std::sqrt(sumOfSquares / samples);
     // our calculated normalized volume could possibly be above 1 because our RMS assumes a sinusoidal wave
     const float normalizedVolume = std::min(rms * rootTwo, 1.0f);
@@ -648,39 +747,91 @@ void OpenAL::stopActive()
 
 /**
  * @brief handles recording of audio frames
+ *
+ * Producer side of the capture ring: drains everything the device captured
+ * into ring slots while holding audioLock. Emission to the sources, and
+ * with it the encoding cost, happens in dispatchCapturedFrames() without
+ * the lock, so capture timing stays independent of the consumers.
  */
 void OpenAL::doInput()
 {
     ALint curSamples = 0;
     alcGetIntegerv(alInDev, ALC_CAPTURE_SAMPLES, sizeof(curSamples), &curSamples);
-    if (curSamples < static_cast<ALint>(AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL)) {
-        return;
+
+    while (curSamples >= static_cast<ALint>(AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL)) {
+        const uint32_t write = captureRingWrite.load(std::memory_order_relaxed);
+        const uint32_t read = captureRingRead.load(std::memory_order_acquire);
+
+        if (write - read >= CAPTURE_RING_FRAMES) {
+            // the dispatch side can't keep up; drop the frame rather than
+            // stall, the device's own ring would overwrite itself anyway
+            captureSamples(alInDev, inputBuffer, AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL);
+            const quint64 overruns = ++captureOverruns;
+            if (overruns % 64 == 0) {
+                qWarning() << "Capture ring overrun," << overruns << "frames dropped so far";
+            }
+        } else {
+            CaptureFrame& slot = captureRing[write % CAPTURE_RING_FRAMES];
+            captureSamples(alInDev, slot.pcm, AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL);
+            AudioKernels::applyGain(slot.pcm, AUDIO_FRAME_SAMPLE_COUNT_TOTAL,
+                                    static_cast<float>(gainFactor));
+            slot.volume = getVolume(slot.pcm);
+            captureRingWrite.store(write + 1, std::memory_order_release);
+        }
+
+        curSamples -= AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL;
     }
+}
 
-    captureSamples(alInDev, inputBuffer, AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL);
+/**
+ * @brief Consumer side of the capture ring, emits the queued frames.
+ *
+ * Runs on the audio thread without audioLock held: however long the
+ * encoders take in the frameAvailable handlers, capture and playback are
+ * free to take the lock in the meantime.
+ */
+void OpenAL::dispatchCapturedFrames()
+{
+    uint32_t read = captureRingRead.load(std::memory_order_relaxed);
+
+    while (read != captureRingWrite.load(std::memory_order_acquire)) {
+        const CaptureFrame& slot = captureRing[read % CAPTURE_RING_FRAMES];
+
+        float volume = slot.volume;
+        bool keepalive = false;
+        if (volume >= inputThreshold) {
+            isActive = true;
+            gatedFrames = 0;
+            emit startActive(voiceHold);
+        } else if (!isActive) {
+            volume = 0;
+            // Gated silence is neither encoded nor sent, but a stream that
+            // goes completely quiet looks dead on the receiving side. Pass
+            // the captured frame through occasionally; it keeps the streams
+            // alive and carries the room's ambience as comfort noise.
+            if (++gatedFrames >= GATE_KEEPALIVE_FRAMES) {
+                gatedFrames = 0;
+                keepalive = true;
+            }
+        }
 
-    applyGain(inputBuffer, AUDIO_FRAME_SAMPLE_COUNT_TOTAL, gainFactor);
+        QMutexLocker locker(&sourcesLock);
 
-    float volume = getVolume();
-    if (volume >= inputThreshold) {
-        isActive = true;
-        emit startActive(voiceHold);
-    } else if (!isActive) {
-        volume = 0;
-    }
+        // NOTE(sudden6): this loop probably doesn't scale too well with many sources
+        for (auto source : sources) {
+            emit source->volumeAvailable(volume);
+        }
 
-    // NOTE(sudden6): this loop probably doesn't scale too well with many sources
-    for (auto source : sources) {
-        emit source->volumeAvailable(volume);
-    }
-    if (!isActive) {
-        return;
-    }
+        if (isActive || keepalive) {
+            // NOTE(sudden6): this loop probably doesn't scale too well with many sources
+            for (auto source : sources) {
+                emit source->frameAvailable(slot.pcm, AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL,
+                                            channels, AUDIO_SAMPLE_RATE);
+            }
+        }
 
-    // NOTE(sudden6): this loop probably doesn't scale too well with many sources
-    for (auto source : sources) {
-        emit source->frameAvailable(inputBuffer, AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL, channels,
-                                    AUDIO_SAMPLE_RATE);
+        captureRingRead.store(read + 1, std::memory_order_release);
+        ++read;
     }
 }
 
@@ -702,6 +853,10 @@ void OpenAL::doAudio()
     if (alInDev && !sources.empty()) {
         doInput();
     }
+
+    // Emit to the consumers without the lock held
+    lock.unlock();
+    dispatchCapturedFrames();
 }
 
 void OpenAL::captureSamples(ALCdevice* device, int16_t* buffer, ALCsizei samples)
@@ -25,16 +25,21 @@
 #include "src/audio/backend/alsink.h"
 #include "src/audio/backend/alsource.h"
 
+#include <array>
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include <atomic>
 #include <cmath>
 
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QObject>
 #include <QTimer>
 
+#include <unordered_map>
+
 #include <cassert>
 
 #include <AL/al.h>
@@ -100,6 +105,10 @@ public:
 
     void playAudioBuffer(uint sourceId, const int16_t* data, int samples, unsigned channels,
                          int sampleRate);
+
+    uint32_t getJitterTargetDepth(uint sourceId) const;
+    uint64_t getJitterUnderruns(uint sourceId) const;
+
 signals:
     void startActive(qreal msec);
 
@@ -128,8 +137,10 @@ private:
 
     void cleanupBuffers(uint sourceId);
     void cleanupSound();
+    ALuint getSoundBuffer(const IAudioSink::Sound& sound);
+    void dispatchCapturedFrames();
 
-    float getVolume();
+    float getVolume(const int16_t* buffer);
 
 protected:
     QThread* audioThread;
@@ -146,6 +157,11 @@ protected:
 
     bool outputInitialized = false;
 
+    // decoded notification sounds and their pre-staged OpenAL buffers; the
+    // buffers belong to the output context and are dropped with it
+    std::unordered_map<int, QByteArray> soundPcmCache;
+    std::unordered_map<int, ALuint> soundBufferCache;
+
     // Qt containers need copy operators, so use stdlib containers
     std::unordered_set<AlSink*> sinks;
     std::unordered_set<AlSink*> soundSinks;
@@ -159,10 +175,49 @@ protected:
     qreal inputThreshold = 0;
     qreal voiceHold = 250;
     bool isActive = false;
+    // frames swallowed by the input gate since the last keepalive
+    uint32_t gatedFrames = 0;
     QTimer voiceTimer;
     const qreal minInThreshold = 0.0;
     const qreal maxInThreshold = 0.4;
     int16_t* inputBuffer = nullptr;
+
+    // Wait-free SPSC ring between the capture side (producer, runs under
+    // audioLock) and the dispatch side (consumer, runs without it), so time
+    // spent encoding in the frameAvailable handlers can no longer block
+    // playback or delay the next capture. Slots are sized for the worst
+    // case (stereo) so reopening the input never reallocates them.
+    struct CaptureFrame
+    {
+        int16_t pcm[AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL * 2];
+        float volume;
+    };
+    static constexpr uint32_t CAPTURE_RING_FRAMES = 8;
+    std::array<CaptureFrame, CAPTURE_RING_FRAMES> captureRing;
+    std::atomic<uint32_t> captureRingWrite{0};
+    std::atomic<uint32_t> captureRingRead{0};
+    std::atomic<quint64> captureOverruns{0};
+    // guards the sources set during dispatch, which runs outside audioLock
+    mutable QMutex sourcesLock;
+
+    // scratch space for rate conversion in playAudioBuffer, grown to the
+    // largest frame seen and then reused; guarded by audioLock
+    std::vector<int16_t> resampleBuffer;
+
+    // Per-source adaptive jitter buffering for incoming call audio. The
+    // target depth follows the inter-arrival variance of the stream, so a
+    // jittery link prebuffers more after an underrun while a quiet one
+    // plays almost immediately.
+    struct JitterState
+    {
+        QElapsedTimer arrivalTimer;
+        double meanIntervalMs = AUDIO_FRAME_DURATION;
+        double varIntervalMs = 0.0;
+        uint32_t targetDepth = 1;
+        bool prebuffering = true;
+        uint64_t underruns = 0;
+    };
+    std::unordered_map<uint, JitterState> jitterStates;
 };
 
 #endif // OPENAL_H
@@ -63,6 +63,11 @@
  * @fn void IAudioSink::stopLoop()
  * @brief stops looping the sound played with playMono16Sound(...)
  *
+ * @fn uint32_t IAudioSink::getJitterTargetDepth()
+ * @brief current target depth of the sink's adaptive jitter buffer, in frames
+ *
+ * @fn uint64_t IAudioSink::getJitterUnderruns()
+ * @brief number of times this sink's queue drained while playing
  */
 
 class IAudioSink : public QObject
@@ -103,6 +108,9 @@ public:
     virtual void startLoop() = 0;
     virtual void stopLoop() = 0;
 
+    virtual uint32_t getJitterTargetDepth() const = 0;
+    virtual uint64_t getJitterUnderruns() const = 0;
+
     virtual operator bool() const = 0;
 
 signals:
@@ -0,0 +1,127 @@
+/*
+    Copyright © 2014-2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "animationclock.h"
+#include "chatlinecontent.h"
+
+#include "src/util/idlemode.h"
+
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QWidget>
+
+/**
+ * @class AnimationClock
+ * @brief One shared frame clock for all animated chat content.
+ *
+ * Spinners and notification icons used to run a private 30Hz QTimer each,
+ * which kept qTox waking up at frame rate even when every animation sat in a
+ * hidden or minimized chat. The clock drives all of them from a single timer,
+ * only ticks items whose view is actually on screen, and drops to a slow poll
+ * while nothing is, so concurrently animating items also collapse into one
+ * repaint pass per frame.
+ */
+
+namespace {
+const int frameIntervalMs = 1000 / 30;
+const int idleIntervalMs = 500;
+}
+
+AnimationClock::AnimationClock()
+{
+    timer.setInterval(frameIntervalMs);
+    timer.setSingleShot(false);
+    connect(&timer, &QTimer::timeout, this, &AnimationClock::onTimeout);
+
+    // nobody watches an away user's screen; stop the clock outright instead
+    // of polling, and pick the frames back up when they return
+    connect(&IdleMode::getInstance(), &IdleMode::idleChanged, this, [this](bool idle) {
+        suspended = idle;
+        if (suspended) {
+            timer.stop();
+        } else if (!subscribers.isEmpty()) {
+            timer.setInterval(frameIntervalMs);
+            timer.start();
+        }
+    });
+}
+
+AnimationClock& AnimationClock::getInstance()
+{
+    static AnimationClock instance;
+    return instance;
+}
+
+void AnimationClock::subscribe(ChatLineContent* item)
+{
+    if (subscribers.contains(item))
+        return;
+
+    subscribers.append(item);
+
+    if (!suspended && !timer.isActive()) {
+        timer.setInterval(frameIntervalMs);
+        timer.start();
+    }
+}
+
+void AnimationClock::unsubscribe(ChatLineContent* item)
+{
+    subscribers.removeOne(item);
+
+    if (subscribers.isEmpty())
+        timer.stop();
+}
+
+/**
+ * @brief Whether the item can currently be seen at all, i.e. it belongs to a
+ * scene shown by a view that is neither hidden (background tab) nor part of a
+ * minimized window.
+ */
+bool AnimationClock::isOnScreen(ChatLineContent* item)
+{
+    QGraphicsScene* scene = item->scene();
+    if (!scene)
+        return false;
+
+    for (QGraphicsView* view : scene->views()) {
+        if (view->isVisible() && !view->window()->isMinimized())
+            return true;
+    }
+
+    return false;
+}
+
+void AnimationClock::onTimeout()
+{
+    bool anyOnScreen = false;
+
+    for (ChatLineContent* item : subscribers) {
+        if (isOnScreen(item)) {
+            anyOnScreen = true;
+            item->animationTick();
+        }
+    }
+
+    // while every animating item is off screen there is nothing to advance;
+    // poll slowly instead of waking up at frame rate
+    const int interval = anyOnScreen ? frameIntervalMs : idleIntervalMs;
+    if (timer.interval() != interval)
+        timer.setInterval(interval);
+}
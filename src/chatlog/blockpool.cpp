@@ -0,0 +1,97 @@
+/*
+    Copyright © 2014-2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "blockpool.h"
+
+#include <algorithm>
+#include <new>
+
+namespace {
+// blocks must be able to hold a free-list pointer and keep every slot
+// suitably aligned for any object placed in it
+size_t paddedBlockSize(size_t requested)
+{
+    const size_t align = alignof(std::max_align_t);
+    const size_t minSize = std::max(requested, sizeof(void*));
+    return (minSize + align - 1) / align * align;
+}
+} // namespace
+
+/**
+ * @class BlockPool
+ * @brief Fixed-size block pool for the chat view's many small per-line objects.
+ *
+ * Building a visual message allocates a handful of small objects (the line,
+ * its text contents, the timestamp), and loading or evicting a history page
+ * repeats that thousands of times. Blocks are carved out of large slabs and
+ * recycled through a free list, so page churn reuses the same memory instead
+ * of fragmenting the general-purpose heap. Requests larger than the block
+ * size fall through to the global allocator.
+ *
+ * Not thread safe; meant to back GUI-thread object churn only.
+ */
+
+BlockPool::BlockPool(size_t blockSize, size_t blocksPerSlab)
+    : blockSize(paddedBlockSize(blockSize))
+    , blocksPerSlab(blocksPerSlab)
+{
+}
+
+BlockPool::~BlockPool()
+{
+    for (char* slab : slabs)
+        ::operator delete(slab);
+}
+
+void* BlockPool::allocate(size_t size)
+{
+    if (size > blockSize)
+        return ::operator new(size);
+
+    if (!freeList) {
+        char* slab = static_cast<char*>(::operator new(blockSize * blocksPerSlab));
+        slabs.push_back(slab);
+
+        // thread the fresh slab onto the free list
+        for (size_t i = 0; i < blocksPerSlab; ++i) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + i * blockSize);
+            block->next = freeList;
+            freeList = block;
+        }
+    }
+
+    FreeBlock* block = freeList;
+    freeList = block->next;
+    return block;
+}
+
+void BlockPool::deallocate(void* p, size_t size) noexcept
+{
+    if (!p)
+        return;
+
+    if (size > blockSize) {
+        ::operator delete(p);
+        return;
+    }
+
+    FreeBlock* block = static_cast<FreeBlock*>(p);
+    block->next = freeList;
+    freeList = block;
+}
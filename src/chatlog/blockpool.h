@@ -0,0 +1,50 @@
+/*
+    Copyright © 2014-2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BLOCKPOOL_H
+#define BLOCKPOOL_H
+
+#include <cstddef>
+#include <vector>
+
+class BlockPool
+{
+public:
+    explicit BlockPool(size_t blockSize, size_t blocksPerSlab = 256);
+    ~BlockPool();
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    void* allocate(size_t size);
+    void deallocate(void* p, size_t size) noexcept;
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    const size_t blockSize;
+    const size_t blocksPerSlab;
+    FreeBlock* freeList = nullptr;
+    std::vector<char*> slabs;
+};
+
+#endif // BLOCKPOOL_H
@@ -18,11 +18,32 @@
 */
 
 #include "chatline.h"
+#include "blockpool.h"
 #include "chatlinecontent.h"
 
 #include <QDebug>
 #include <QGraphicsScene>
 
+namespace {
+BlockPool& linePool()
+{
+    // deliberately leaked: lines can still be torn down during static
+    // destruction, after a static pool would already have been destroyed
+    static BlockPool* pool = new BlockPool(512);
+    return *pool;
+}
+} // namespace
+
+void* ChatLine::operator new(size_t size)
+{
+    return linePool().allocate(size);
+}
+
+void ChatLine::operator delete(void* p, size_t size) noexcept
+{
+    linePool().deallocate(p, size);
+}
+
 ChatLine::ChatLine()
 {
 }
@@ -91,8 +112,10 @@ void ChatLine::addToScene(QGraphicsScene* scene)
     if (!scene)
         return;
 
-    for (ChatLineContent* c : content)
-        scene->addItem(c);
+    for (ChatLineContent* c : content) {
+        if (c->scene() != scene)
+            scene->addItem(c);
+    }
 }
 
 void ChatLine::setVisible(bool visible)
@@ -244,6 +267,47 @@ void ChatLine::layout(qreal w, QPointF scenePos)
     updateBBox();
 }
 
+/**
+ * @brief Estimates this line's height after a layout at the given width,
+ * without touching the content items' documents.
+ *
+ * Distributes the width across the columns exactly like layout() and asks
+ * each content item for its estimate at its effective column width.
+ */
+qreal ChatLine::estimateHeight(qreal w) const
+{
+    if (!content.size())
+        return 0.0;
+
+    qreal fixedWidth = (content.size() - 1) * columnSpacing;
+    qreal varWidth = 0.0; // used for normalisation
+
+    for (int i = 0; i < format.size(); ++i) {
+        if (format[i].policy == ColumnFormat::FixedSize)
+            fixedWidth += format[i].size;
+        else
+            varWidth += format[i].size;
+    }
+
+    if (varWidth == 0.0)
+        varWidth = 1.0;
+
+    qreal leftover = qMax(0.0, w - fixedWidth);
+
+    qreal height = 0.0;
+    for (int i = 0; i < content.size(); ++i) {
+        qreal columnWidth;
+        if (format[i].policy == ColumnFormat::FixedSize)
+            columnWidth = format[i].size;
+        else
+            columnWidth = format[i].size / varWidth * leftover;
+
+        height = qMax(height, content[i]->estimateHeight(columnWidth));
+    }
+
+    return height;
+}
+
 void ChatLine::moveBy(qreal deltaY)
 {
     // reposition only
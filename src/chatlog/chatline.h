@@ -20,10 +20,11 @@
 #ifndef CHATLINE_H
 #define CHATLINE_H
 
+#include "src/util/intrusiveptr.h"
+
 #include <QPointF>
 #include <QRectF>
 #include <QVector>
-#include <memory>
 
 class ChatLog;
 class ChatLineContent;
@@ -63,18 +64,27 @@ struct ColumnFormat
 
 using ColumnFormats = QVector<ColumnFormat>;
 
-class ChatLine
+// The refcount lives inside the line: handles are copied constantly across
+// visibleLines, selection state and signal payloads, all on the GUI thread,
+// where shared_ptr's separate control block and atomic counts only cost
+class ChatLine : public IntrusiveRefCounted
 {
 public:
-    using Ptr = std::shared_ptr<ChatLine>;
+    using Ptr = IntrusivePtr<ChatLine>;
 
     ChatLine();
     virtual ~ChatLine();
 
+    // lines churn heavily as history pages load and get evicted, so their
+    // storage comes from a recycling block pool instead of the general heap
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size) noexcept;
+
     QRectF sceneBoundingRect() const;
 
     void replaceContent(int col, ChatLineContent* lineContent);
     void layout(qreal width, QPointF scenePos);
+    qreal estimateHeight(qreal width) const;
     void moveBy(qreal deltaY);
     void removeFromScene();
     void addToScene(QGraphicsScene* scene);
@@ -18,6 +18,26 @@
 */
 
 #include "chatlinecontent.h"
+#include "blockpool.h"
+
+namespace {
+BlockPool& contentPool()
+{
+    // deliberately leaked, for the same reason as the ChatLine pool
+    static BlockPool* pool = new BlockPool(512);
+    return *pool;
+}
+} // namespace
+
+void* ChatLineContent::operator new(size_t size)
+{
+    return contentPool().allocate(size);
+}
+
+void ChatLineContent::operator delete(void* p, size_t size) noexcept
+{
+    contentPool().deallocate(p, size);
+}
 
 void ChatLineContent::setIndex(int r, int c)
 {
@@ -35,6 +55,17 @@ int ChatLineContent::getRow() const
     return row;
 }
 
+/**
+ * @brief Cheap guess of this content's height at the given width, without
+ * performing a layout. Fixed-size content is already exact; wrapping content
+ * overrides this with a metrics-based heuristic.
+ */
+qreal ChatLineContent::estimateHeight(qreal width) const
+{
+    Q_UNUSED(width);
+    return boundingRect().height();
+}
+
 int ChatLineContent::type() const
 {
     return GraphicsItemType::ChatLineContentType;
@@ -92,6 +123,14 @@ void ChatLineContent::reloadTheme()
 {
 }
 
+/**
+ * @brief Advances one animation frame. Called by AnimationClock while this
+ * item is subscribed to it and on screen.
+ */
+void ChatLineContent::animationTick()
+{
+}
+
 QString ChatLineContent::getText() const
 {
     return QString();
@@ -22,6 +22,8 @@
 
 #include <QGraphicsItem>
 
+#include <cstddef>
+
 class ChatLine;
 
 class ChatLineContent : public QObject, public QGraphicsItem
@@ -35,10 +37,16 @@ public:
         ChatLineContentType = QGraphicsItem::UserType + 1,
     };
 
+    // content items are created and destroyed in bulk alongside their lines,
+    // so they share the same pooled-storage scheme as ChatLine
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size) noexcept;
+
     int getColumn() const;
     int getRow() const;
 
     virtual void setWidth(qreal width) = 0;
+    virtual qreal estimateHeight(qreal width) const;
     virtual int type() const final;
 
     virtual void selectionMouseMove(QPointF scenePos);
@@ -60,6 +68,7 @@ public:
 
     virtual void visibilityChanged(bool visible);
     virtual void reloadTheme();
+    virtual void animationTick();
 
 private:
     friend class ChatLine;
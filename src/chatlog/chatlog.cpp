@@ -22,6 +22,9 @@
 #include "chatlinecontentproxy.h"
 #include "chatmessage.h"
 #include "content/filetransferwidget.h"
+#include "documentcache.h"
+#include "pixmapcache.h"
+#include "src/persistence/settings.h"
 #include "src/widget/translator.h"
 #include "src/widget/style.h"
 
@@ -29,10 +32,16 @@
 #include <QApplication>
 #include <QClipboard>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 #include <QMouseEvent>
+#include <QOpenGLWidget>
+#include <QPainter>
 #include <QScrollBar>
+#include <QSet>
 #include <QShortcut>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
 
 /**
  * @var ChatLog::repNameAfter
@@ -68,6 +77,16 @@ ChatLog::ChatLog(const bool canRemove, QWidget* parent)
     setContextMenuPolicy(Qt::CustomContextMenu);
     setBackgroundBrush(QBrush(Style::getColor(Style::GroundBase), Qt::SolidPattern));
 
+    if (Settings::getInstance().getUseOpenGLChatView()) {
+        // Opt-in GPU compositing. Qt transparently falls back to a software
+        // rasterizer if no usable GL context is available, so this is safe to
+        // enable on machines without acceleration. GL repaints the whole
+        // viewport anyway, so minimal updates would only add bookkeeping.
+        setViewport(new QOpenGLWidget(this));
+        setViewportUpdateMode(FullViewportUpdate);
+        qDebug() << "ChatLog: using OpenGL viewport";
+    }
+
     // The selection rect for multi-line selection
     selGraphItem = scene->addRect(0, 0, 0, 0, selectionRectColor.darker(120), selectionRectColor);
     selGraphItem->setZValue(-1.0); // behind all other items
@@ -91,12 +110,25 @@ ChatLog::ChatLog(const bool canRemove, QWidget* parent)
     connect(selectAllAction, &QAction::triggered, this, [this]() { selectAll(); });
     addAction(selectAllAction);
 
+    // Opt-in frame profiler, cheap enough for support staff to switch on in
+    // the field; the shortcut writes the current figures to the debug log
+    debugOverlay = qEnvironmentVariableIsSet("QTOX_CHATLOG_DEBUG");
+    if (debugOverlay) {
+        fpsClock.start();
+        dumpStatsAction = new QAction(this);
+        dumpStatsAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_F12));
+        connect(dumpStatsAction, &QAction::triggered, this, [this]() { dumpDebugStats(); });
+        addAction(dumpStatsAction);
+        qDebug() << "ChatLog: debug overlay enabled";
+    }
+
     // This timer is used to scroll the view while the user is
     // moving the mouse past the top/bottom edge of the widget while selecting.
+    // Only runs while such a drag is in progress - as a free-running 30Hz
+    // timer it was the single biggest idle wakeup source per open chat.
     selectionTimer = new QTimer(this);
     selectionTimer->setInterval(1000 / 30);
     selectionTimer->setSingleShot(false);
-    selectionTimer->start();
     connect(selectionTimer, &QTimer::timeout, this, &ChatLog::onSelectionTimerTimeout);
 
     // Background worker
@@ -172,6 +204,10 @@ void ChatLog::layout(int start, int end, qreal width)
         return;
     }
 
+    QElapsedTimer layoutTimer;
+    if (debugOverlay)
+        layoutTimer.start();
+
     qreal h = 0.0;
 
     // Line at start-1 is considered to have the correct position. All following lines are
@@ -188,6 +224,9 @@ void ChatLog::layout(int start, int end, qreal width)
         l->layout(width, QPointF(0.0, h));
         h += l->sceneBoundingRect().height() + lineSpacing;
     }
+
+    if (debugOverlay)
+        lastLayoutUs = layoutTimer.nsecsElapsed() / 1000;
 }
 
 void ChatLog::mousePressEvent(QMouseEvent* ev)
@@ -218,6 +257,7 @@ void ChatLog::mouseReleaseEvent(QMouseEvent* ev)
     QGraphicsView::mouseReleaseEvent(ev);
 
     selectionScrollDir = NoDirection;
+    selectionTimer->stop();
 
     multiClickTimer->start();
 }
@@ -237,6 +277,9 @@ void ChatLog::mouseMoveEvent(QMouseEvent* ev)
         else
             selectionScrollDir = NoDirection;
 
+        if (selectionScrollDir != NoDirection && !selectionTimer->isActive())
+            selectionTimer->start();
+
         // select
         if (selectionMode == None
             && (clickPos - ev->pos()).manhattanLength() > QApplication::startDragDistance()) {
@@ -369,11 +412,18 @@ void ChatLog::insertChatlineAtBottom(ChatLine::Ptr l)
 
     bool stickToBtm = stickToBottom();
 
-    // insert
+    // insert; the scene attach is deferred to checkVisibility() below
     l->setRow(lines.size());
-    l->addToScene(scene);
     lines.append(l);
 
+    // a hidden view (e.g. a background ContentDialog tab) defers all layout
+    // work until the next showEvent()
+    if (!isVisible()) {
+        if (suspendedFirstRow < 0)
+            suspendedFirstRow = l->getRow();
+        return;
+    }
+
     // partial refresh
     layout(lines.last()->getRow(), lines.size(), useableWidth());
     updateSceneRect();
@@ -395,13 +445,24 @@ void ChatLog::insertChatlineAtBottom(const QList<ChatLine::Ptr>& newLines)
         removeFirsts(DEF_NUM_MSG_TO_LOAD);
     }
 
+    const int firstNewRow = lines.size();
+
+    // scene attach is deferred until the lines scroll near the viewport
     for (ChatLine::Ptr l : newLines) {
         l->setRow(lines.size());
-        l->addToScene(scene);
         l->visibilityChanged(false);
         lines.append(l);
     }
 
+    // hidden views catch up in showEvent() instead of reflowing per message
+    if (!isVisible()) {
+        if (numRemove > 0)
+            suspendedFullReflow = true; // the trim shifted the saved row
+        else if (suspendedFirstRow < 0)
+            suspendedFirstRow = firstNewRow;
+        return;
+    }
+
     layout(lines.last()->getRow(), lines.size(), useableWidth());
 
     if (visibleLines.size() > 1) {
@@ -426,19 +487,20 @@ void ChatLog::insertChatlinesOnTop(const QList<ChatLine::Ptr>& newLines)
     if (newLines.isEmpty())
         return;
 
-    QGraphicsScene::ItemIndexMethod oldIndexMeth = scene->itemIndexMethod();
-    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
-
     // alloc space for old and new lines
     QVector<ChatLine::Ptr> combLines;
     combLines.reserve(newLines.size() + lines.size());
 
-    // add the new lines
+    // lay the new lines out relative to each other; they are above the
+    // viewport, so their graphics items only enter the scene once
+    // checkVisibility() sees them approach it
     int i = 0;
+    qreal blockHeight = 0.0;
     for (ChatLine::Ptr l : newLines) {
-        l->addToScene(scene);
         l->visibilityChanged(false);
         l->setRow(i++);
+        l->layout(useableWidth(), QPointF(0.0, blockHeight));
+        blockHeight += l->sceneBoundingRect().height() + lineSpacing;
         combLines.push_back(l);
     }
 
@@ -446,7 +508,17 @@ void ChatLog::insertChatlinesOnTop(const QList<ChatLine::Ptr>& newLines)
         removeLasts(DEF_NUM_MSG_TO_LOAD);
     }
 
-    // add the old lines
+    // Anchored prepend: the old lines keep their positions and the new block
+    // is shifted above them as a whole, extending the scene upwards. This
+    // keeps the cost proportional to the page being added rather than
+    // reflowing the entire transcript. A later resize reflow normalizes the
+    // coordinates back to a zero-based origin.
+    const qreal oldTop = lines.isEmpty() ? 0.0 : lines.first()->sceneBoundingRect().top();
+    for (ChatLine::Ptr l : newLines) {
+        l->moveBy(oldTop - blockHeight);
+    }
+
+    // add the old lines; only their row numbers change
     for (ChatLine::Ptr l : lines) {
         l->setRow(i++);
         combLines.push_back(l);
@@ -454,15 +526,18 @@ void ChatLog::insertChatlinesOnTop(const QList<ChatLine::Ptr>& newLines)
 
     lines = combLines;
 
-    scene->setItemIndexMethod(oldIndexMeth);
+    // the viewport content didn't move in scene coordinates, only the scene
+    // rect grew upwards, so shift the scrollbar to keep the view in place
+    const qreal oldSceneTop = sceneRect().top();
+    updateSceneRect();
+    verticalScrollBar()->setValue(verticalScrollBar()->value()
+                                  + qRound(oldSceneTop - sceneRect().top()));
 
-    // redo layout
-    if (visibleLines.size() > 1) {
-        startResizeWorker(visibleLines[1]);
-    } else {
-        startResizeWorker();
-    }
+    checkVisibility();
+    isScroll = true;
 
+    // loaders wait on this to know the prepended page is in place
+    emit workerTimeoutFinished();
 }
 
 bool ChatLog::stickToBottom() const
@@ -483,6 +558,14 @@ void ChatLog::startResizeWorker(ChatLine::Ptr anchorLine)
         return;
     }
 
+    // Lay the viewport out first, anchored where it currently sits, so the
+    // new width shows up on screen immediately. The worker restarts from the
+    // top afterwards and reflows everything sequentially; the anchor scroll
+    // at the end absorbs any drift this causes above the viewport.
+    if (!visibleLines.empty()) {
+        layout(visibleLines.first()->getRow(), visibleLines.last()->getRow(), useableWidth());
+    }
+
     // (re)start the worker
     if (!workerTimer->isActive()) {
         // these values must not be reevaluated while the worker is running
@@ -506,12 +589,133 @@ void ChatLog::startResizeWorker(ChatLine::Ptr anchorLine)
     if (txt > 500000)
         setScene(busyScene);
 
+    // Height-estimation index: a font-metrics guess for every line at the new
+    // width, accumulated from the back so any suffix of unlaid lines can be
+    // priced in O(1). The scene rect (and with it scroll geometry) is accurate
+    // right away; the worker replaces the estimates with measured heights as
+    // it progresses.
+    workerEstimatedTail.resize(lines.size() + 1);
+    workerEstimatedTail[lines.size()] = 0.0;
+    for (int i = lines.size() - 1; i >= 0; --i)
+        workerEstimatedTail[i] =
+            workerEstimatedTail[i + 1] + lines[i]->estimateHeight(useableWidth()) + lineSpacing;
+
+    setSceneRect(QRectF(-margins.left(), -margins.top(), useableWidth(),
+                        workerEstimatedTail[0] + margins.top() + margins.bottom()));
+
     workerLastIndex = 0;
     workerTimer->start();
 
     verticalScrollBar()->hide();
 }
 
+void ChatLog::paintEvent(QPaintEvent* ev)
+{
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+
+    QGraphicsView::paintEvent(ev);
+
+    // average paint time is dumped periodically so the raster and GL
+    // viewports can be compared per platform from the debug log
+    const qint64 frameUs = frameTimer.nsecsElapsed() / 1000;
+    paintTimeUs += frameUs;
+    if (++paintedFrames >= 100) {
+        qDebug() << "ChatLog: average paint time" << paintTimeUs / paintedFrames << "us over"
+                 << paintedFrames << "frames";
+        paintTimeUs = 0;
+        paintedFrames = 0;
+    }
+
+    if (debugOverlay) {
+        lastPaintUs = frameUs;
+        ++overlayFrames;
+        if (fpsClock.elapsed() >= 1000) {
+            overlayFps = static_cast<int>(overlayFrames * 1000 / fpsClock.elapsed());
+            overlayFrames = 0;
+            fpsClock.restart();
+        }
+        paintDebugOverlay();
+    }
+}
+
+/**
+ * @brief Collects the profiler figures shown by the overlay.
+ * @return One formatted line per figure.
+ */
+QStringList ChatLog::debugStats() const
+{
+    const DocumentCache& documents = DocumentCache::getInstance();
+    const PixmapCache& pixmaps = PixmapCache::getInstance();
+    const auto hitPercent = [](quint64 hits, quint64 misses) {
+        const quint64 lookups = hits + misses;
+        return lookups ? hits * 100 / lookups : 100;
+    };
+
+    QStringList stats;
+    stats << QString("paint %1 us (avg %2)")
+                 .arg(lastPaintUs)
+                 .arg(paintedFrames ? paintTimeUs / paintedFrames : lastPaintUs);
+    stats << QString("layout %1 us").arg(lastLayoutUs);
+    stats << QString("%1 fps").arg(overlayFps);
+    stats << QString("lines %1 visible, %2 attached, %3 total")
+                 .arg(visibleLines.size())
+                 .arg(attachedLines.size())
+                 .arg(lines.size());
+    stats << QString("documents %1% hits of %2 lookups")
+                 .arg(hitPercent(documents.hits(), documents.misses()))
+                 .arg(documents.hits() + documents.misses());
+    stats << QString("pixmaps %1% hits of %2 lookups")
+                 .arg(hitPercent(pixmaps.hits(), pixmaps.misses()))
+                 .arg(pixmaps.hits() + pixmaps.misses());
+    return stats;
+}
+
+/**
+ * @brief Draws the profiler figures into the top right viewport corner.
+ * @note Runs inside paintEvent(), after the scene has been painted. Kept
+ * deliberately plain - the overlay itself must not show up in the numbers.
+ */
+void ChatLog::paintDebugOverlay()
+{
+    const QStringList stats = debugStats();
+
+    QPainter painter(viewport());
+    QFont overlayFont = painter.font();
+    overlayFont.setPointSize(8);
+    painter.setFont(overlayFont);
+
+    const QFontMetrics metrics(overlayFont);
+    int textWidth = 0;
+    for (const QString& line : stats)
+        textWidth = qMax(textWidth, metrics.boundingRect(line).width());
+
+    const int pad = 4;
+    const QRect box(viewport()->width() - textWidth - 2 * pad - 2, 2, textWidth + 2 * pad,
+                    stats.size() * metrics.height() + 2 * pad);
+    painter.fillRect(box, QColor(0, 0, 0, 160));
+    painter.setPen(Qt::white);
+
+    int y = box.top() + pad + metrics.ascent();
+    for (const QString& line : stats) {
+        painter.drawText(box.left() + pad, y, line);
+        y += metrics.height();
+    }
+}
+
+/**
+ * @brief Writes the current profiler figures to the debug log.
+ *
+ * Bound to Ctrl+Shift+F12 while the overlay is enabled, so users can attach
+ * hard numbers to a "scrolling feels bad" report.
+ */
+void ChatLog::dumpDebugStats()
+{
+    qDebug() << "ChatLog: profiler dump";
+    for (const QString& line : debugStats())
+        qDebug().noquote() << "   " << line;
+}
+
 void ChatLog::mouseDoubleClickEvent(QMouseEvent* ev)
 {
     QPointF scenePos = mapToScene(ev->pos());
@@ -547,27 +751,44 @@ QString ChatLog::getSelectedText() const
     if (selectionMode == Precise) {
         return lines[selClickedRow]->content[selClickedCol]->getSelectedText();
     } else if (selectionMode == Multi) {
-        // build a nicely formatted message
-        QString out;
+        // join() preallocates the result from a total-size pass, so even a
+        // select-all over a long log is a single allocation instead of
+        // repeatedly growing the string
+        return getSelectedRows().join(QLatin1Char('\n'));
+    }
+
+    return QString();
+}
+
+/**
+ * @brief Formats each selected row into its "[time] author: message" piece.
+ *
+ * Kept separate from the final join so callers can snapshot the selection
+ * cheaply (the pieces are implicitly shared) and assemble it elsewhere.
+ */
+QStringList ChatLog::getSelectedRows() const
+{
+    QStringList rows;
 
-        for (int i = selFirstRow; i <= selLastRow; ++i) {
-            if (lines[i]->content[1]->getText().isEmpty())
-                continue;
+    if (selectionMode != Multi)
+        return rows;
 
-            QString timestamp = lines[i]->content[2]->getText().isEmpty()
-                                    ? tr("pending")
-                                    : lines[i]->content[2]->getText();
-            QString author = lines[i]->content[0]->getText();
-            QString msg = lines[i]->content[1]->getText();
+    rows.reserve(selLastRow - selFirstRow + 1);
 
-            out +=
-                QString(out.isEmpty() ? "[%2] %1: %3" : "\n[%2] %1: %3").arg(author, timestamp, msg);
-        }
+    for (int i = selFirstRow; i <= selLastRow; ++i) {
+        if (lines[i]->content[1]->getText().isEmpty())
+            continue;
+
+        QString timestamp = lines[i]->content[2]->getText().isEmpty()
+                                ? tr("pending")
+                                : lines[i]->content[2]->getText();
+        QString author = lines[i]->content[0]->getText();
+        QString msg = lines[i]->content[1]->getText();
 
-        return out;
+        rows += QString("[%2] %1: %3").arg(author, timestamp, msg);
     }
 
-    return QString();
+    return rows;
 }
 
 bool ChatLog::isEmpty() const
@@ -620,6 +841,10 @@ void ChatLog::clear()
 {
     clearSelection();
 
+    // the saved suspension state refers to rows that are about to go away
+    suspendedFirstRow = -1;
+    suspendedFullReflow = false;
+
     QVector<ChatLine::Ptr> savedLines;
 
     for (ChatLine::Ptr l : lines) {
@@ -631,6 +856,7 @@ void ChatLog::clear()
 
     lines.clear();
     visibleLines.clear();
+    attachedLines.clear();
     for (ChatLine::Ptr l : savedLines)
         insertChatlineAtBottom(l);
 
@@ -639,11 +865,44 @@ void ChatLog::clear()
 
 void ChatLog::copySelectedText(bool toSelectionBuffer) const
 {
-    QString text = getSelectedText();
+    // characters; multi-selections above this are joined off the GUI thread
+    static const int asyncCopyThreshold = 512 * 1024;
+
     QClipboard* clipboard = QApplication::clipboard();
+    if (!clipboard)
+        return;
 
-    if (clipboard && !text.isNull())
-        clipboard->setText(text, toSelectionBuffer ? QClipboard::Selection : QClipboard::Clipboard);
+    const QClipboard::Mode mode = toSelectionBuffer ? QClipboard::Selection : QClipboard::Clipboard;
+
+    if (selectionMode == Multi) {
+        const QStringList rows = getSelectedRows();
+
+        int totalLength = 0;
+        for (const QString& row : rows)
+            totalLength += row.size();
+
+        if (totalLength >= asyncCopyThreshold) {
+            // the row snapshot is cheap, the megabyte-scale join is not; run
+            // it on a worker thread and hand the result to the clipboard from
+            // the GUI thread once it is ready
+            auto* watcher = new QFutureWatcher<QString>();
+            connect(watcher, &QFutureWatcher<QString>::finished, watcher, [watcher, mode] {
+                if (QClipboard* c = QApplication::clipboard())
+                    c->setText(watcher->result(), mode);
+                watcher->deleteLater();
+            });
+            watcher->setFuture(
+                QtConcurrent::run([rows] { return rows.join(QLatin1Char('\n')); }));
+            return;
+        }
+
+        clipboard->setText(rows.join(QLatin1Char('\n')), mode);
+        return;
+    }
+
+    QString text = getSelectedText();
+    if (!text.isNull())
+        clipboard->setText(text, mode);
 }
 
 void ChatLog::setBusyNotification(ChatLine::Ptr notification)
@@ -683,7 +942,10 @@ void ChatLog::scrollToLine(ChatLine::Ptr line)
         workerStb = false;
     } else {
         updateSceneRect();
-        verticalScrollBar()->setValue(line->sceneBoundingRect().top()); // NOTE: start here
+        // scrollbar values are relative to the scene rect's top, which is no
+        // longer necessarily zero after an anchored prepend
+        verticalScrollBar()->setValue(
+            qRound(line->sceneBoundingRect().top() - sceneRect().top()));
     }
 }
 
@@ -758,15 +1020,68 @@ int ChatLog::getNumRemove() const
 
 void ChatLog::forceRelayout()
 {
+    if (!isVisible()) {
+        suspendedFullReflow = true;
+        return;
+    }
+
     startResizeWorker();
 }
 
+/**
+ * @brief Keeps only the lines around the viewport attached to the scene
+ *
+ * Lines within one viewport height above and below the visible rect keep
+ * their graphics items in the scene; everything else is detached. The line
+ * records themselves stay in `lines`, so layout, hit-testing and selection
+ * (which all work off the line store, not the scene) are unaffected, while
+ * the scene's item count is bounded by screen size instead of history size.
+ */
+void ChatLog::updateSceneMembership()
+{
+    const QRect visibleRect = getVisibleRect();
+    const qreal margin = visibleRect.height();
+
+    auto attachLower = std::lower_bound(lines.cbegin(), lines.cend(), visibleRect.top() - margin,
+                                        ChatLine::lessThanBSRectBottom);
+    auto attachUpper = std::lower_bound(attachLower, lines.cend(), visibleRect.bottom() + margin,
+                                        ChatLine::lessThanBSRectTop);
+
+    // diff the old and new ranges through hash sets; the contains/removeOne
+    // pass this replaces was quadratic in the number of attached lines
+    QList<ChatLine::Ptr> newAttachedLines;
+    QSet<ChatLine*> nowAttached;
+    for (auto itr = attachLower; itr != attachUpper; ++itr) {
+        newAttachedLines.append(*itr);
+        nowAttached.insert(itr->get());
+    }
+
+    QSet<ChatLine*> wasAttached;
+    for (const ChatLine::Ptr& line : attachedLines)
+        wasAttached.insert(line.get());
+
+    for (auto itr = attachLower; itr != attachUpper; ++itr) {
+        if (!wasAttached.contains(itr->get()))
+            (*itr)->addToScene(scene);
+    }
+
+    // these lines left the margin zone, release their graphics items
+    for (const ChatLine::Ptr& line : attachedLines) {
+        if (!nowAttached.contains(line.get()))
+            line->removeFromScene();
+    }
+
+    attachedLines = newAttachedLines;
+}
+
 void ChatLog::checkVisibility(bool causedWheelEvent)
 {
     if (lines.empty()) {
         return;
     }
 
+    updateSceneMembership();
+
     // find first visible line
     auto lowerBound = std::lower_bound(lines.cbegin(), lines.cend(), getVisibleRect().top(),
                                        ChatLine::lessThanBSRectBottom);
@@ -775,26 +1090,34 @@ void ChatLog::checkVisibility(bool causedWheelEvent)
     auto upperBound = std::lower_bound(lowerBound, lines.cend(), getVisibleRect().bottom(),
                                        ChatLine::lessThanBSRectTop);
 
-    // set visibilty
+    // set visibilty; same set-based diff as updateSceneMembership(), so a
+    // scroll tick costs O(log n) for the bounds plus the visible count
     QList<ChatLine::Ptr> newVisibleLines;
+    QSet<ChatLine*> nowVisible;
     for (auto itr = lowerBound; itr != upperBound; ++itr) {
         newVisibleLines.append(*itr);
+        nowVisible.insert(itr->get());
+    }
 
-        if (!visibleLines.contains(*itr))
-            (*itr)->visibilityChanged(true);
+    QSet<ChatLine*> wasVisible;
+    for (const ChatLine::Ptr& line : visibleLines)
+        wasVisible.insert(line.get());
 
-        visibleLines.removeOne(*itr);
+    for (auto itr = lowerBound; itr != upperBound; ++itr) {
+        if (!wasVisible.contains(itr->get()))
+            (*itr)->visibilityChanged(true);
     }
 
     // these lines are no longer visible
-    for (ChatLine::Ptr line : visibleLines)
-        line->visibilityChanged(false);
+    for (const ChatLine::Ptr& line : visibleLines) {
+        if (!nowVisible.contains(line.get()))
+            line->visibilityChanged(false);
+    }
 
+    // `lines` is ordered by row, so the range copy already is too; no
+    // re-sort needed
     visibleLines = newVisibleLines;
 
-    // enforce order
-    std::sort(visibleLines.begin(), visibleLines.end(), ChatLine::lessThanRowIndex);
-
     // if (!visibleLines.empty())
     //  qDebug() << "visible from " << visibleLines.first()->getRow() << "to " <<
     //  visibleLines.last()->getRow() << " total " << visibleLines.size();
@@ -823,7 +1146,11 @@ void ChatLog::resizeEvent(QResizeEvent* ev)
     bool stb = stickToBottom();
 
     if (ev->size().width() != ev->oldSize().width()) {
-        startResizeWorker();
+        if (isVisible()) {
+            startResizeWorker();
+        } else {
+            suspendedFullReflow = true;
+        }
         stb = false; // let the resize worker handle it
     }
 
@@ -888,13 +1215,15 @@ ChatLine::Ptr ChatLog::findLineByPosY(qreal yPos) const
 
 QRectF ChatLog::calculateSceneRect() const
 {
+    // lines prepended since the last full reflow sit above y = 0
+    qreal top = (lines.empty() ? 0.0 : lines.first()->sceneBoundingRect().top());
     qreal bottom = (lines.empty() ? 0.0 : lines.last()->sceneBoundingRect().bottom());
 
     if (typingNotification.get() != nullptr)
         bottom += typingNotification->sceneBoundingRect().height() + lineSpacing;
 
-    return QRectF(-margins.left(), -margins.top(), useableWidth(),
-                  bottom + margins.bottom() + margins.top());
+    return QRectF(-margins.left(), top - margins.top(), useableWidth(),
+                  bottom - top + margins.bottom() + margins.top());
 }
 
 void ChatLog::onSelectionTimerTimeout()
@@ -902,6 +1231,11 @@ void ChatLog::onSelectionTimerTimeout()
     const int scrollSpeed = 10;
 
     switch (selectionScrollDir) {
+    case NoDirection:
+        // drag moved back inside the viewport; stop ticking until it
+        // crosses an edge again
+        selectionTimer->stop();
+        break;
     case Up:
         verticalScrollBar()->setValue(verticalScrollBar()->value() - scrollSpeed);
         break;
@@ -915,12 +1249,34 @@ void ChatLog::onSelectionTimerTimeout()
 
 void ChatLog::onWorkerTimeout()
 {
-    // Fairly arbitrary but
-    // large values will make the UI unresponsive
-    const int stepSize = 50;
+    // pause mid-reflow when the view goes hidden; showEvent() restarts it
+    if (!isVisible()) {
+        workerTimer->stop();
+        suspendedFullReflow = true;
+        return;
+    }
 
-    layout(workerLastIndex, workerLastIndex + stepSize, useableWidth());
-    workerLastIndex += stepSize;
+    // Lay out against a frame-time budget rather than a fixed line count, so
+    // a tick stays short whether the lines are trivial or full of markup
+    const int chunkSize = 25;
+    const qint64 frameBudgetMs = 8;
+
+    QElapsedTimer budget;
+    budget.start();
+
+    do {
+        layout(workerLastIndex, workerLastIndex + chunkSize, useableWidth());
+        workerLastIndex += chunkSize;
+    } while (workerLastIndex < lines.size() && budget.elapsed() < frameBudgetMs);
+
+    // not done: swap measured heights in for the estimates laid out this tick
+    if (workerLastIndex < lines.size()) {
+        setSceneRect(QRectF(-margins.left(), -margins.top(), useableWidth(),
+                            lines[workerLastIndex - 1]->sceneBoundingRect().bottom()
+                                + workerEstimatedTail[workerLastIndex] + margins.top()
+                                + margins.bottom()));
+        return;
+    }
 
     // done?
     if (workerLastIndex >= lines.size()) {
@@ -943,6 +1299,7 @@ void ChatLog::onWorkerTimeout()
 
         // don't keep a Ptr to the anchor line
         workerAnchorLine = ChatLine::Ptr();
+        workerEstimatedTail.clear();
 
         // hidden during busy screen
         verticalScrollBar()->show();
@@ -984,9 +1341,26 @@ void ChatLog::handleMultiClickEvent()
 
 void ChatLog::showEvent(QShowEvent*)
 {
-    // Empty.
-    // The default implementation calls centerOn - for some reason - causing
-    // the scrollbar to move.
+    // No call into the default implementation: it calls centerOn - for some
+    // reason - causing the scrollbar to move.
+
+    // Catch up on the layout work skipped while the view was hidden.
+    if (suspendedFullReflow) {
+        suspendedFullReflow = false;
+        suspendedFirstRow = -1;
+        startResizeWorker();
+    } else if (suspendedFirstRow >= 0) {
+        const bool stickToBtm = stickToBottom();
+        layout(suspendedFirstRow, lines.size(), useableWidth());
+        suspendedFirstRow = -1;
+        updateSceneRect();
+
+        if (stickToBtm)
+            scrollToBottom();
+
+        checkVisibility();
+        updateTypingNotification();
+    }
 }
 
 void ChatLog::focusInEvent(QFocusEvent* ev)
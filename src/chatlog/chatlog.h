@@ -21,8 +21,10 @@
 #define CHATLOG_H
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QGraphicsView>
 #include <QMargins>
+#include <QStringList>
 
 #include "chatline.h"
 #include "chatmessage.h"
@@ -103,10 +105,12 @@ protected:
 
     void reposition(int start, int end, qreal deltaY);
     void updateSceneRect();
+    void updateSceneMembership();
     void checkVisibility(bool causedWheelEvent = false);
     void scrollToBottom();
     void startResizeWorker(ChatLine::Ptr anchorLine = nullptr);
 
+    virtual void paintEvent(QPaintEvent* ev) final override;
     virtual void mouseDoubleClickEvent(QMouseEvent* ev) final override;
     virtual void mousePressEvent(QMouseEvent* ev) final override;
     virtual void mouseReleaseEvent(QMouseEvent* ev) final override;
@@ -128,6 +132,10 @@ private:
     void retranslateUi();
     bool isActiveFileTransfer(ChatLine::Ptr l);
     void handleMultiClickEvent();
+    QStringList getSelectedRows() const;
+    QStringList debugStats() const;
+    void paintDebugOverlay();
+    void dumpDebugStats();
 
 private:
     enum SelectionMode
@@ -150,6 +158,10 @@ private:
     QGraphicsScene* busyScene = nullptr;
     QVector<ChatLine::Ptr> lines;
     QList<ChatLine::Ptr> visibleLines;
+    // Lines whose graphics items currently live in the scene, i.e. the
+    // viewport plus margins; everything else is detached to keep the scene
+    // bounded by screen size rather than history size
+    QList<ChatLine::Ptr> attachedLines;
     ChatLine::Ptr typingNotification;
     ChatLine::Ptr busyNotification;
 
@@ -175,14 +187,39 @@ private:
     int workerLastIndex = 0;
     bool workerStb = false;
     ChatLine::Ptr workerAnchorLine;
+    // estimated height of every still-unlaid suffix of lines, indexed by row;
+    // lets each worker tick correct the provisional scene rect in O(1)
+    QVector<qreal> workerEstimatedTail;
 
     // layout
     QMargins margins = QMargins(10, 10, 10, 10);
     qreal lineSpacing = 5.0f;
 
+    // rolling paint-time figure, to compare raster and GL viewports
+    qint64 paintTimeUs = 0;
+    int paintedFrames = 0;
+
+    // Opt-in frame profiler (set QTOX_CHATLOG_DEBUG): paint and layout times,
+    // visible-line count and cache hit rates drawn over the viewport, plus a
+    // shortcut dumping the same figures to the log. For diagnosing "scrolling
+    // feels bad" reports on production installs without a special build.
+    bool debugOverlay = false;
+    QAction* dumpStatsAction = nullptr;
+    qint64 lastPaintUs = 0;
+    qint64 lastLayoutUs = 0;
+    QElapsedTimer fpsClock;
+    int overlayFrames = 0;
+    int overlayFps = 0;
+
     int numRemove{0};
     const int maxMessages{300};
     bool canRemove;
+
+    // Suspension state of a hidden view: layout skipped while not visible is
+    // replayed in showEvent(), either from the first row appended in the
+    // meantime or as a full reflow
+    int suspendedFirstRow = -1;
+    bool suspendedFullReflow = false;
 };
 
 #endif // CHATLOG_H
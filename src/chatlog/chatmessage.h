@@ -29,7 +29,7 @@ class QGraphicsScene;
 class ChatMessage : public ChatLine
 {
 public:
-    using Ptr = std::shared_ptr<ChatMessage>;
+    using Ptr = IntrusivePtr<ChatMessage>;
 
     enum SystemMessageType
     {
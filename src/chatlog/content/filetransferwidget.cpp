@@ -22,6 +22,9 @@
 
 #include "src/core/core.h"
 #include "src/core/corefile.h"
+#include "src/nexus.h"
+#include "src/persistence/history.h"
+#include "src/persistence/profile.h"
 #include "src/persistence/settings.h"
 #include "src/widget/gui.h"
 #include "src/widget/style.h"
@@ -35,14 +38,36 @@
 #include <QDesktopWidget>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QMouseEvent>
 #include <QPainter>
+#include <QTimer>
 #include <QVariantAnimation>
 
 #include <cassert>
 #include <math.h>
 
+namespace {
+constexpr int progressRefreshIntervalMs = 100; // ~10Hz
+
+/**
+ * @brief Shared repaint beat for all transfer widgets.
+ *
+ * CoreFile emits fileTransferInfo at chunk cadence; with several concurrent
+ * transfers, repainting per signal keeps the GUI thread busy re-rendering
+ * progress bars. All widgets with fresh progress redraw on this one timer
+ * instead, which only runs while at least one transfer is transmitting.
+ */
+QTimer& progressTicker()
+{
+    static QTimer ticker;
+    return ticker;
+}
+
+int progressTickerUsers = 0;
+} // namespace
+
 
 // The leftButton is used to accept, pause, or resume a file transfer, as well as to open a
 // received file.
@@ -102,6 +127,7 @@ FileTransferWidget::FileTransferWidget(QWidget* parent, ToxFile file)
 
 FileTransferWidget::~FileTransferWidget()
 {
+    unsubscribeFromProgressTicker();
     delete ui;
 }
 
@@ -121,9 +147,59 @@ bool FileTransferWidget::tryRemoveFile(const QString& filepath)
 
 void FileTransferWidget::onFileTransferUpdate(ToxFile file)
 {
+    if (file.status == ToxFile::TRANSMITTING && lastStatus == ToxFile::TRANSMITTING) {
+        // keep the sampler fed at chunk cadence, but let the shared ticker
+        // decide when the widget actually redraws
+        if (fileProgress.needsUpdate()) {
+            fileProgress.addSample(file);
+        }
+        fileInfo = file;
+        coalescedUpdatePending = true;
+        subscribeToProgressTicker();
+        return;
+    }
+
+    // status transitions repaint immediately
     updateWidget(file);
 }
 
+void FileTransferWidget::onProgressTick()
+{
+    if (!coalescedUpdatePending) {
+        // transfer stalled since the last beat; nothing new to draw
+        return;
+    }
+
+    coalescedUpdatePending = false;
+    updateWidget(fileInfo);
+}
+
+void FileTransferWidget::subscribeToProgressTicker()
+{
+    if (tickerSubscribed) {
+        return;
+    }
+
+    tickerSubscribed = true;
+    connect(&progressTicker(), &QTimer::timeout, this, &FileTransferWidget::onProgressTick);
+    if (progressTickerUsers++ == 0) {
+        progressTicker().start(progressRefreshIntervalMs);
+    }
+}
+
+void FileTransferWidget::unsubscribeFromProgressTicker()
+{
+    if (!tickerSubscribed) {
+        return;
+    }
+
+    tickerSubscribed = false;
+    disconnect(&progressTicker(), &QTimer::timeout, this, &FileTransferWidget::onProgressTick);
+    if (--progressTickerUsers == 0) {
+        progressTicker().stop();
+    }
+}
+
 bool FileTransferWidget::isActive() const
 {
     return active;
@@ -135,8 +211,22 @@ void FileTransferWidget::acceptTransfer(const QString& filepath)
         return;
     }
 
+    // If the chosen path already holds the partial file of an earlier
+    // attempt, resume from the persisted progress instead of wiping it
+    uint64_t startPos = 0;
+    const QFileInfo existing(filepath);
+    if (existing.exists() && existing.size() > 0) {
+        if (History* history = Nexus::getProfile()->getHistory()) {
+            const quint64 completedBytes = history->getFileCompletedBytes(fileInfo.resumeFileId);
+            if (completedBytes > 0 && completedBytes <= static_cast<quint64>(existing.size())
+                && completedBytes < fileInfo.filesize) {
+                startPos = completedBytes;
+            }
+        }
+    }
+
     // test if writable
-    if (!tryRemoveFile(filepath)) {
+    if (startPos == 0 && !tryRemoveFile(filepath)) {
         GUI::showWarning(tr("Location not writable", "Title of permissions popup"),
                          tr("You do not have permission to write that location. Choose another, or "
                             "cancel the save dialog.",
@@ -146,7 +236,7 @@ void FileTransferWidget::acceptTransfer(const QString& filepath)
 
     // everything ok!
     CoreFile* coreFile = Core::getInstance()->getCoreFile();
-    coreFile->acceptFileRecvRequest(fileInfo.friendId, fileInfo.fileNum, filepath);
+    coreFile->acceptFileRecvRequest(fileInfo.friendId, fileInfo.fileNum, filepath, startPos);
 }
 
 void FileTransferWidget::setBackgroundColor(const QColor& c, bool whiteFont)
@@ -339,11 +429,8 @@ void FileTransferWidget::updateFileProgress(ToxFile const& file)
         fileProgress.resetSpeed();
         break;
     case ToxFile::TRANSMITTING: {
-        if (!fileProgress.needsUpdate()) {
-            break;
-        }
-
-        fileProgress.addSample(file);
+        // sampling happens in onFileTransferUpdate; here we only draw the
+        // latest sampled state
         auto speed = fileProgress.getSpeed();
         auto progress = fileProgress.getProgress();
         auto remainingTime = fileProgress.getTimeLeftSeconds();
@@ -388,6 +475,7 @@ void FileTransferWidget::updateSignals(ToxFile const& file)
     case ToxFile::BROKEN:
     case ToxFile::FINISHED:
         active = false;
+        unsubscribeFromProgressTicker();
         disconnect(Core::getInstance()->getCoreFile(), nullptr, this, nullptr);
         break;
     case ToxFile::INITIALIZING:
@@ -660,9 +748,6 @@ void FileTransferWidget::updateWidget(ToxFile const& file)
 
     fileInfo = file;
 
-    // If we repainted on every packet our gui would be *very* slow
-    bool bTransmitNeedsUpdate = fileProgress.needsUpdate();
-
     updatePreview(file);
     updateFileProgress(file);
     updateWidgetText(file);
@@ -672,14 +757,7 @@ void FileTransferWidget::updateWidget(ToxFile const& file)
 
     lastStatus = file.status;
 
-    // trigger repaint
-    switch (file.status) {
-    case ToxFile::TRANSMITTING:
-        if (!bTransmitNeedsUpdate) {
-            break;
-        }
-    // fallthrough
-    default:
-        update();
-    }
+    // trigger repaint; chunk-cadence updates are already coalesced onto the
+    // shared ticker before they get here
+    update();
 }
@@ -68,6 +68,7 @@ private slots:
     void onLeftButtonClicked();
     void onRightButtonClicked();
     void onPreviewButtonClicked();
+    void onProgressTick();
 
 private:
     static QPixmap scaleCropIntoSquare(const QPixmap& source, int targetSize);
@@ -76,6 +77,8 @@ private:
     static bool tryRemoveFile(const QString &filepath);
 
     void updateWidget(ToxFile const& file);
+    void subscribeToProgressTicker();
+    void unsubscribeFromProgressTicker();
 
 private:
     Ui::FileTransferWidget* ui;
@@ -88,6 +91,8 @@ private:
     QColor buttonBackgroundColor;
 
     bool active;
+    bool coalescedUpdatePending = false;
+    bool tickerSubscribed = false;
     ToxFile::FileStatus lastStatus = ToxFile::INITIALIZING;
 
     enum class ExifOrientation
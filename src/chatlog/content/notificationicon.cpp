@@ -18,25 +18,24 @@
 */
 
 #include "notificationicon.h"
+#include "../animationclock.h"
 #include "../pixmapcache.h"
 #include "src/widget/style.h"
 
 #include <QGraphicsScene>
 #include <QPainter>
-#include <QTimer>
 
 NotificationIcon::NotificationIcon(QSize Size)
     : size(Size)
 {
     pmap = PixmapCache::getInstance().get(Style::getImagePath("chatArea/typing.svg"), size);
 
-    updateTimer = new QTimer(this);
-    updateTimer->setInterval(1000 / 30);
-    updateTimer->setSingleShot(false);
-
-    updateTimer->start();
+    AnimationClock::getInstance().subscribe(this);
+}
 
-    connect(updateTimer, &QTimer::timeout, this, &NotificationIcon::updateGradient);
+NotificationIcon::~NotificationIcon()
+{
+    AnimationClock::getInstance().unsubscribe(this);
 }
 
 QRectF NotificationIcon::boundingRect() const
@@ -68,7 +67,7 @@ qreal NotificationIcon::getAscent() const
     return 3.0;
 }
 
-void NotificationIcon::updateGradient()
+void NotificationIcon::animationTick()
 {
     alpha += 0.01;
 
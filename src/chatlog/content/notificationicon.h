@@ -25,28 +25,24 @@
 #include <QLinearGradient>
 #include <QPixmap>
 
-class QTimer;
-
 class NotificationIcon : public ChatLineContent
 {
     Q_OBJECT
 public:
     explicit NotificationIcon(QSize size);
+    virtual ~NotificationIcon();
 
     virtual QRectF boundingRect() const override;
     virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
                        QWidget* widget) override;
     virtual void setWidth(qreal width) override;
     virtual qreal getAscent() const override;
-
-private slots:
-    void updateGradient();
+    virtual void animationTick() override;
 
 private:
     QSize size;
     QPixmap pmap;
     QLinearGradient grad;
-    QTimer* updateTimer = nullptr;
 
     qreal dotWidth = 0.2;
     qreal alpha = 0.0;
@@ -18,6 +18,7 @@
 */
 
 #include "spinner.h"
+#include "../animationclock.h"
 #include "../pixmapcache.h"
 
 #include <QDebug>
@@ -32,9 +33,6 @@ Spinner::Spinner(const QString& img, QSize Size, qreal speed)
 {
     pmap = PixmapCache::getInstance().get(img, size);
 
-    timer.setInterval(1000 / 30); // 30Hz
-    timer.setSingleShot(false);
-
     blendAnimation = new QVariantAnimation(this);
     blendAnimation->setStartValue(0.0);
     blendAnimation->setEndValue(1.0);
@@ -43,8 +41,11 @@ Spinner::Spinner(const QString& img, QSize Size, qreal speed)
     blendAnimation->start(QAbstractAnimation::DeleteWhenStopped);
     connect(blendAnimation, &QVariantAnimation::valueChanged, this,
             [this](const QVariant& val) { alpha = val.toDouble(); });
+}
 
-    QObject::connect(&timer, &QTimer::timeout, this, &Spinner::timeout);
+Spinner::~Spinner()
+{
+    AnimationClock::getInstance().unsubscribe(this);
 }
 
 QRectF Spinner::boundingRect() const
@@ -76,9 +77,9 @@ void Spinner::setWidth(qreal width)
 void Spinner::visibilityChanged(bool visible)
 {
     if (visible)
-        timer.start();
+        AnimationClock::getInstance().subscribe(this);
     else
-        timer.stop();
+        AnimationClock::getInstance().unsubscribe(this);
 }
 
 qreal Spinner::getAscent() const
@@ -86,8 +87,10 @@ qreal Spinner::getAscent() const
     return 0.0;
 }
 
-void Spinner::timeout()
+void Spinner::animationTick()
 {
+    // the rotation angle is derived from the wall clock in paint(), so a
+    // frame only needs the stale area repainted
     if (scene())
         scene()->invalidate(sceneBoundingRect());
 }
@@ -24,7 +24,6 @@
 
 #include <QObject>
 #include <QPixmap>
-#include <QTimer>
 
 class QVariantAnimation;
 
@@ -33,6 +32,7 @@ class Spinner : public ChatLineContent
     Q_OBJECT
 public:
     Spinner(const QString& img, QSize size, qreal speed);
+    virtual ~Spinner();
 
     virtual QRectF boundingRect() const override;
     virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
@@ -40,15 +40,12 @@ public:
     virtual void setWidth(qreal width) override;
     virtual void visibilityChanged(bool visible) override;
     virtual qreal getAscent() const override;
-
-private slots:
-    void timeout();
+    virtual void animationTick() override;
 
 private:
     QSize size;
     QPixmap pmap;
     qreal rotSpeed;
-    QTimer timer;
     qreal alpha = 0.0;
     QVariantAnimation* blendAnimation;
 };
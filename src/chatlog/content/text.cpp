@@ -22,6 +22,7 @@
 
 #include <QAbstractTextDocumentLayout>
 #include <QApplication>
+#include <QCache>
 #include <QDebug>
 #include <QDesktopServices>
 #include <QFontMetrics>
@@ -30,6 +31,7 @@
 #include <QPalette>
 #include <QTextBlock>
 #include <QTextFragment>
+#include <QtMath>
 
 Text::Text(const QString& txt, const QFont& font, bool enableElide, const QString& rwText,
            const TextType& type, const QColor& custom)
@@ -49,7 +51,7 @@ Text::Text(const QString& txt, const QFont& font, bool enableElide, const QStrin
 Text::~Text()
 {
     if (doc)
-        DocumentCache::getInstance().push(doc);
+        freeResources();
 }
 
 void Text::setText(const QString& txt)
@@ -101,12 +103,47 @@ void Text::deselectText()
 
 void Text::setWidth(qreal w)
 {
+    // unchanged width with clean geometry means the last shaping result is
+    // still valid; don't rebuild the document just to recompute it
+    if (!dirty && w == width && !size.isEmpty())
+        return;
+
     width = w;
     dirty = true;
 
     regenerate();
 }
 
+/**
+ * @brief Estimates the laid-out height at the given width from font metrics
+ * and a wrapped-length heuristic, without building a text document.
+ *
+ * If this text was already laid out at (roughly) the requested width, the
+ * measured height is returned instead, so estimates converge to exact values
+ * as real layouts complete.
+ */
+qreal Text::estimateHeight(qreal w) const
+{
+    if (!size.isEmpty() && qAbs(w - width) < 1.0)
+        return size.height();
+
+    const QFontMetricsF metrics(defFont);
+    const qreal charsPerLine = qMax(1.0, w / qMax<qreal>(1.0, metrics.averageCharWidth()));
+    const QString& plain = rawText.isEmpty() ? text : rawText;
+
+    int wrappedLines = 0;
+    int paragraphStart = 0;
+    for (int i = 0; i <= plain.size(); ++i) {
+        if (i == plain.size() || plain[i] == QLatin1Char('\n')) {
+            const int len = i - paragraphStart;
+            wrappedLines += qMax(1, qCeil(len / charsPerLine));
+            paragraphStart = i + 1;
+        }
+    }
+
+    return wrappedLines * metrics.lineSpacing();
+}
+
 void Text::selectionMouseMove(QPointF scenePos)
 {
     if (!doc)
@@ -320,30 +357,71 @@ QString Text::getLinkAt(QPointF scenePos) const
     return cursor.charFormat().anchorHref();
 }
 
+namespace {
+// result of shaping a text at one width: everything layout needs to position
+// the line without the document itself
+struct ShapedGeometry
+{
+    QSizeF size;
+    qreal ascent;
+};
+} // namespace
+
 void Text::regenerate()
 {
+    // line-break results per (document key, width bucket), retained across
+    // relayouts; entries are small, so the cache is simply count-bounded
+    static QCache<QString, ShapedGeometry> shapedCache{8192};
+
+    const QString shapedKey =
+        elide ? QString() : docKey() + QLatin1Char('\n') + QString::number(qRound(width));
+
+    bool contentCached = false;
     if (!doc) {
-        doc = DocumentCache::getInstance().pop();
+        // an off-screen relayout only needs the geometry; if this text was
+        // already shaped at this width, skip rebuilding the document entirely
+        if (!elide && !keepInMemory) {
+            if (const ShapedGeometry* shaped = shapedCache.object(shapedKey)) {
+                if (size != shaped->size)
+                    prepareGeometryChange();
+
+                size = shaped->size;
+                ascent = shaped->ascent;
+                dirty = false;
+                return;
+            }
+        }
+        // elided text depends on the current width, so only full documents
+        // are worth keeping formatted
+        if (!elide) {
+            doc = DocumentCache::getInstance().popFormatted(docKey());
+            contentCached = doc != nullptr;
+        }
+        if (!doc) {
+            doc = DocumentCache::getInstance().pop();
+        }
         dirty = true;
     }
 
     if (dirty) {
-        doc->setDefaultFont(defFont);
+        if (!contentCached) {
+            doc->setDefaultFont(defFont);
 
-        if (elide) {
-            QFontMetrics metrics = QFontMetrics(defFont);
-            QString elidedText = metrics.elidedText(text, Qt::ElideRight, qRound(width));
+            if (elide) {
+                QFontMetrics metrics = QFontMetrics(defFont);
+                QString elidedText = metrics.elidedText(text, Qt::ElideRight, qRound(width));
 
-            doc->setPlainText(elidedText);
-        } else {
-            doc->setDefaultStyleSheet(defStyleSheet);
-            doc->setHtml(text);
-        }
+                doc->setPlainText(elidedText);
+            } else {
+                doc->setDefaultStyleSheet(defStyleSheet);
+                doc->setHtml(text);
+            }
 
-        // wrap mode
-        QTextOption opt;
-        opt.setWrapMode(elide ? QTextOption::NoWrap : QTextOption::WrapAtWordBoundaryOrAnywhere);
-        doc->setDefaultTextOption(opt);
+            // wrap mode
+            QTextOption opt;
+            opt.setWrapMode(elide ? QTextOption::NoWrap : QTextOption::WrapAtWordBoundaryOrAnywhere);
+            doc->setDefaultTextOption(opt);
+        }
 
         // width
         doc->setTextWidth(width);
@@ -360,6 +438,11 @@ void Text::regenerate()
         // get the new width and height
         size = idealSize();
 
+        // remember the shaping result so later relayouts at this width can
+        // reuse it without touching a document
+        if (!elide)
+            shapedCache.insert(shapedKey, new ShapedGeometry{size, ascent});
+
         dirty = false;
     }
 
@@ -374,7 +457,13 @@ void Text::regenerate()
 
 void Text::freeResources()
 {
-    DocumentCache::getInstance().push(doc);
+    if (elide || dirty) {
+        DocumentCache::getInstance().push(doc);
+    } else {
+        // hand the still-formatted document back so an unchanged message can
+        // skip the HTML parse next time it scrolls into view
+        DocumentCache::getInstance().pushFormatted(doc, docKey());
+    }
     doc = nullptr;
 }
 
@@ -488,3 +577,15 @@ QColor Text::textColor() const
 
     return c;
 }
+
+/**
+ * @brief Key the formatted document is cached under.
+ *
+ * Covers everything baked into the document besides the text width: the
+ * source text, the font and the stylesheet derived from it.
+ */
+QString Text::docKey() const
+{
+    return defFont.key() + QLatin1Char('\n') + QString::number(qHash(defStyleSheet))
+           + QLatin1Char('\n') + text;
+}
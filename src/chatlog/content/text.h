@@ -50,6 +50,7 @@ public:
     void deselectText();
 
     virtual void setWidth(qreal width) final;
+    virtual qreal estimateHeight(qreal width) const final;
 
     virtual void selectionMouseMove(QPointF scenePos) final;
     virtual void selectionStarted(QPointF scenePos) final;
@@ -95,6 +96,7 @@ protected:
 private:
     void selectText(QTextCursor& cursor, const std::pair<int, int>& point);
     QColor textColor() const;
+    QString docKey() const;
 
     QString text;
     QString rawText;
@@ -19,9 +19,34 @@
 
 #include "documentcache.h"
 #include "customtextdocument.h"
+#include "src/util/memoryregistry.h"
+
+namespace {
+// Blank documents kept around for reuse
+constexpr int MAX_POOLED_DOCUMENTS = 32;
+// Ceiling for formatted documents, costed in characters of source content,
+// which tracks document memory far better than an entry count would
+constexpr int MAX_FORMATTED_COST = 2 * 1024 * 1024;
+}
+
+DocumentCache::DocumentCache()
+    : formattedDocuments{MAX_FORMATTED_COST}
+{
+    // cost is in characters of source content; UTF-16 makes that two bytes each
+    MemoryRegistry::registerSampler("chatlog documents",
+                                    [this]() {
+                                        return QString("%1 pooled, %2 formatted holding ~%3")
+                                            .arg(documents.size())
+                                            .arg(formattedDocuments.count())
+                                            .arg(MemoryRegistry::formatBytes(
+                                                quint64(formattedDocuments.totalCost()) * 2));
+                                    },
+                                    this);
+}
 
 DocumentCache::~DocumentCache()
 {
+    MemoryRegistry::unregister(this);
     while (!documents.isEmpty())
         delete documents.pop();
 }
@@ -34,12 +59,48 @@ QTextDocument* DocumentCache::pop()
     return documents.pop();
 }
 
+/**
+ * @brief Takes a document that already holds the given formatted content
+ * @param contentKey key the content was stored under by pushFormatted()
+ * @return Document with the content applied, or nullptr on a cache miss
+ */
+QTextDocument* DocumentCache::popFormatted(const QString& contentKey)
+{
+    QTextDocument* doc = formattedDocuments.take(contentKey);
+    if (doc)
+        ++hitCount;
+    else
+        ++missCount;
+    return doc;
+}
+
 void DocumentCache::push(QTextDocument* doc)
 {
-    if (doc) {
-        doc->clear();
-        documents.push(doc);
+    if (!doc)
+        return;
+
+    if (documents.size() >= MAX_POOLED_DOCUMENTS) {
+        delete doc;
+        return;
     }
+
+    doc->clear();
+    documents.push(doc);
+}
+
+/**
+ * @brief Stores a document without clearing it, keyed by its content
+ *
+ * Least recently used documents are evicted once the configured cost ceiling
+ * is reached; oversized entries are deleted outright.
+ */
+void DocumentCache::pushFormatted(QTextDocument* doc, const QString& contentKey)
+{
+    if (!doc)
+        return;
+
+    // QCache takes ownership, deleting the document if it doesn't fit
+    formattedDocuments.insert(contentKey, doc, qMax(1, contentKey.size()));
 }
 
 /**
@@ -20,7 +20,9 @@
 #ifndef DOCUMENTCACHE_H
 #define DOCUMENTCACHE_H
 
+#include <QCache>
 #include <QStack>
+#include <QString>
 
 class QTextDocument;
 
@@ -30,16 +32,33 @@ public:
     static DocumentCache& getInstance();
 
     QTextDocument* pop();
+    QTextDocument* popFormatted(const QString& contentKey);
     void push(QTextDocument* doc);
+    void pushFormatted(QTextDocument* doc, const QString& contentKey);
+
+    // formatted-cache hit/miss counters for the chat view's debug overlay
+    quint64 hits() const
+    {
+        return hitCount;
+    }
+    quint64 misses() const
+    {
+        return missCount;
+    }
 
 private:
-    DocumentCache() = default;
+    DocumentCache();
     ~DocumentCache();
     DocumentCache(DocumentCache&) = delete;
     DocumentCache& operator=(const DocumentCache&) = delete;
 
 private:
     QStack<QTextDocument*> documents;
+    // Documents that still hold their formatted content, keyed by it, so
+    // regenerating an unchanged message skips the HTML parse entirely
+    QCache<QString, QTextDocument> formattedDocuments;
+    quint64 hitCount = 0;
+    quint64 missCount = 0;
 };
 
 #endif // DOCUMENTCACHE_H
@@ -19,19 +19,70 @@
 
 #include "pixmapcache.h"
 
+#include "src/util/memoryregistry.h"
+
+#include <QIcon>
+
+namespace {
+// Cache ceiling in bytes of decoded pixmap data
+constexpr int MAX_PIXMAP_BYTES = 32 * 1024 * 1024;
+}
+
+PixmapCache::PixmapCache()
+    : cache{MAX_PIXMAP_BYTES}
+{
+    MemoryRegistry::registerSampler("chatlog pixmaps",
+                                    [this]() {
+                                        return QString("%1 of %2, %3 entries")
+                                            .arg(MemoryRegistry::formatBytes(cache.totalCost()))
+                                            .arg(MemoryRegistry::formatBytes(MAX_PIXMAP_BYTES))
+                                            .arg(cache.count());
+                                    },
+                                    this);
+}
+
+QString PixmapCache::keyFor(const QString& filename, QSize size)
+{
+    return filename + QLatin1Char('@') + QString::number(size.width()) + QLatin1Char('x')
+           + QString::number(size.height());
+}
+
+int PixmapCache::costFor(const QPixmap& pixmap)
+{
+    return qMax(1, pixmap.width() * pixmap.height() * pixmap.depth() / 8);
+}
+
 QPixmap PixmapCache::get(const QString& filename, QSize size)
 {
-    auto itr = cache.find(filename);
+    const QString key = keyFor(filename, size);
+    if (QPixmap* cached = cache.object(key)) {
+        ++hitCount;
+        return *cached;
+    }
+    ++missCount;
 
-    if (itr == cache.end()) {
-        QIcon icon;
-        icon.addFile(filename);
+    QIcon icon;
+    icon.addFile(filename);
+    QPixmap rendered = icon.pixmap(size);
 
-        cache.insert(filename, icon);
-        return icon.pixmap(size);
+    // QPixmap is implicitly shared, the cached copy costs no extra memory
+    cache.insert(key, new QPixmap(rendered), costFor(rendered));
+    return rendered;
+}
+
+/**
+ * @brief Decodes a pixmap into the cache ahead of its first use
+ *
+ * Call this for images expected to be requested shortly, e.g. for lines about
+ * to scroll into view, so the decode doesn't happen during painting.
+ */
+void PixmapCache::prefetch(const QString& filename, QSize size)
+{
+    if (cache.contains(keyFor(filename, size))) {
+        return;
     }
 
-    return itr.value().pixmap(size);
+    get(filename, size);
 }
 
 /**
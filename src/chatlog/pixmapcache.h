@@ -20,25 +20,42 @@
 #ifndef ICONCACHE_H
 #define ICONCACHE_H
 
-#include <QHash>
-#include <QIcon>
+#include <QCache>
 #include <QPixmap>
+#include <QSize>
+#include <QString>
 
 class PixmapCache
 {
 public:
     QPixmap get(const QString& filename, QSize size);
+    void prefetch(const QString& filename, QSize size);
     static PixmapCache& getInstance();
 
-protected:
-    PixmapCache()
+    // hit/miss counters for the chat view's debug overlay
+    quint64 hits() const
+    {
+        return hitCount;
+    }
+    quint64 misses() const
     {
+        return missCount;
     }
+
+protected:
+    PixmapCache();
     PixmapCache(PixmapCache&) = delete;
     PixmapCache& operator=(const PixmapCache&) = delete;
 
 private:
-    QHash<QString, QIcon> cache;
+    static QString keyFor(const QString& filename, QSize size);
+    static int costFor(const QPixmap& pixmap);
+
+    // Rendered pixmaps keyed by (filename, size), costed in bytes so the
+    // cache is bounded by memory rather than entry count
+    QCache<QString, QPixmap> cache;
+    quint64 hitCount = 0;
+    quint64 missCount = 0;
 };
 
 #endif // ICONCACHE_H
@@ -19,6 +19,7 @@
 
 #include "textformatter.h"
 
+#include <QCache>
 #include <QRegularExpression>
 #include <QVector>
 
@@ -198,10 +199,23 @@ QString highlight(const QString& message, const QVector<QRegularExpression>& pat
  * @param message Where search for URLs
  * @return Copy of message with highlighted URLs
  */
+// Formatting results are deterministic in their inputs and the same history
+// messages are recreated every time a window is paged back in, so recent
+// results are remembered instead of re-running the regex batteries. Costed in
+// characters, roughly a megabyte per cache.
+static constexpr int FORMAT_CACHE_MAX_COST = 512 * 1024;
+
 QString highlightURI(const QString& message)
 {
+    static QCache<QString, QString> cache{FORMAT_CACHE_MAX_COST};
+    if (const QString* cached = cache.object(message)) {
+        return *cached;
+    }
+
     QString result = highlight(message, URI_WORD_PATTERNS, HREF_WRAPPER);
     result = highlight(result, WWW_WORD_PATTERN, WWW_WRAPPER);
+
+    cache.insert(message, new QString(result), qMax(1, result.size()));
     return result;
 }
 
@@ -233,6 +247,13 @@ static bool isTagIntersection(const QString& str)
  */
 QString applyMarkdown(const QString& message, bool showFormattingSymbols)
 {
+    static QCache<QString, QString> cache{FORMAT_CACHE_MAX_COST};
+    const QString cacheKey =
+        (showFormattingSymbols ? QLatin1Char('1') : QLatin1Char('0')) + message;
+    if (const QString* cached = cache.object(cacheKey)) {
+        return *cached;
+    }
+
     QString result = message;
     for (const QPair<QRegularExpression, QString>& pair : REGEX_TO_WRAPPER) {
         QRegularExpressionMatchIterator iter = pair.first.globalMatch(result);
@@ -251,5 +272,7 @@ QString applyMarkdown(const QString& message, bool showFormattingSymbols)
             offset += wrappedText.length() - length;
         }
     }
+
+    cache.insert(cacheKey, new QString(result), qMax(1, result.size()));
     return result;
 }
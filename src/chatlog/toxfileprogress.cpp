@@ -21,60 +21,79 @@
 
 #include "src/core/toxfile.h"
 
-bool ToxFileProgress::needsUpdate() const
-{
-    QTime now = QTime::currentTime();
-    qint64 dt = lastTick.msecsTo(now); // ms
+#include <cmath>
 
-    if (dt < 1000) {
-        return false;
-    }
+namespace {
+// sample at most once a second; the ring then covers the last ~8 seconds
+constexpr qint64 samplePeriodMs = 1000;
+
+// smoothing time constant for the exponentially weighted speed: a rate
+// change needs on the order of 15s to dominate the estimate, which keeps
+// the ETA of a multi-hour transfer from flapping on every burst
+constexpr double speedSmoothingTauMs = 15 * 1000.0;
+} // namespace
 
-    return true;
+ToxFileProgress::ToxFileProgress()
+{
+    clock.start();
 }
 
-void ToxFileProgress::addSample(ToxFile const& file)
+bool ToxFileProgress::needsUpdate() const
 {
-    QTime now = QTime::currentTime();
-    qint64 dt = lastTick.msecsTo(now); // ms
+    return clock.elapsed() - lastSampleMs >= samplePeriodMs;
+}
 
-    if (dt < 1000) {
+void ToxFileProgress::addSample(ToxFile const& file)
+{
+    const qint64 nowMs = clock.elapsed();
+    if (nowMs - lastSampleMs < samplePeriodMs) {
         return;
     }
 
-    // ETA, speed
-    qreal deltaSecs = dt / 1000.0;
-
-    // (can't use ::abs or ::max on unsigned types substraction, they'd just overflow)
-    quint64 deltaBytes = file.bytesSent > lastBytesSent ? file.bytesSent - lastBytesSent
-                                                        : lastBytesSent - file.bytesSent;
-    qreal bytesPerSec = static_cast<int>(static_cast<qreal>(deltaBytes) / deltaSecs);
-
-    // Update member variables
-    meanIndex = meanIndex % TRANSFER_ROLLING_AVG_COUNT;
-    meanData[meanIndex++] = bytesPerSec;
+    // raw speed over the whole ring window; O(1) since only the oldest
+    // sample and the current position matter
+    if (sampleCount > 0) {
+        const Sample& oldest =
+            samples[(head + SAMPLE_RING_SIZE - sampleCount) % SAMPLE_RING_SIZE];
+        const qint64 windowMs = nowMs - oldest.timestampMs;
+        if (windowMs > 0) {
+            // a restarted transfer can report fewer bytes than before
+            const double deltaBytes = file.bytesSent >= oldest.bytesSent
+                                          ? static_cast<double>(file.bytesSent - oldest.bytesSent)
+                                          : 0.0;
+            const double rawSpeed = deltaBytes * 1000.0 / static_cast<double>(windowMs);
+
+            if (speedBytesPerSecond == 0.0) {
+                // seed the estimate instead of ramping up from zero
+                speedBytesPerSecond = rawSpeed;
+            } else {
+                const double alpha =
+                    1.0 - std::exp(-static_cast<double>(nowMs - lastSampleMs) / speedSmoothingTauMs);
+                speedBytesPerSecond += alpha * (rawSpeed - speedBytesPerSecond);
+            }
+        }
+    }
 
-    double meanBytesPerSec = 0.0;
-    for (size_t i = 0; i < TRANSFER_ROLLING_AVG_COUNT; ++i) {
-        meanBytesPerSec += meanData[i];
+    samples[head] = {file.bytesSent, nowMs};
+    head = (head + 1) % SAMPLE_RING_SIZE;
+    if (sampleCount < SAMPLE_RING_SIZE) {
+        ++sampleCount;
     }
-    meanBytesPerSec /= static_cast<qreal>(TRANSFER_ROLLING_AVG_COUNT);
 
-    lastTick = now;
+    lastSampleMs = nowMs;
 
     progress = static_cast<double>(file.bytesSent) / static_cast<double>(file.filesize);
-    speedBytesPerSecond = meanBytesPerSec;
-    timeLeftSeconds = (file.filesize - file.bytesSent) / getSpeed();
-
-    lastBytesSent = file.bytesSent;
+    timeLeftSeconds = speedBytesPerSecond > 0.0
+                          ? static_cast<double>(file.filesize - file.bytesSent) / speedBytesPerSecond
+                          : 0.0;
 }
 
 void ToxFileProgress::resetSpeed()
 {
-    meanIndex = 0;
-    for (auto& item : meanData) {
-        item = 0;
-    }
+    head = 0;
+    sampleCount = 0;
+    speedBytesPerSecond = 0.0;
+    timeLeftSeconds = 0.0;
 }
 
 double ToxFileProgress::getProgress() const
@@ -20,13 +20,17 @@
 #ifndef TOXFILEPROGRESS_H
 #define TOXFILEPROGRESS_H
 
-#include <QTime>
+#include <QElapsedTimer>
+
+#include <cstdint>
 
 struct ToxFile;
 
 class ToxFileProgress
 {
 public:
+    ToxFileProgress();
+
     bool needsUpdate() const;
     void addSample(ToxFile const& file);
     void resetSpeed();
@@ -36,17 +40,24 @@ public:
     double getTimeLeftSeconds() const;
 
 private:
-    uint64_t lastBytesSent = 0;
+    struct Sample
+    {
+        uint64_t bytesSent;
+        qint64 timestampMs;
+    };
 
-    static const uint8_t TRANSFER_ROLLING_AVG_COUNT = 4;
-    uint8_t meanIndex = 0;
-    double meanData[TRANSFER_ROLLING_AVG_COUNT] = {0.0};
+    static const uint8_t SAMPLE_RING_SIZE = 8;
+    Sample samples[SAMPLE_RING_SIZE];
+    uint8_t head = 0; // next slot to overwrite
+    uint8_t sampleCount = 0;
 
-    QTime lastTick = QTime::currentTime();
+    QElapsedTimer clock;
+    qint64 lastSampleMs = 0;
 
-    double speedBytesPerSecond;
-    double timeLeftSeconds;
-    double progress;
+    // the widget may draw before the first sample lands
+    double speedBytesPerSecond = 0.0;
+    double timeLeftSeconds = 0.0;
+    double progress = 0.0;
 };
 
 
@@ -29,6 +29,7 @@
 ContactId::ContactId()
     : id()
 {
+    idHash = qHash(id);
 }
 
 /**
@@ -38,6 +39,7 @@ ContactId::ContactId()
 ContactId::ContactId(const QByteArray& rawId)
 {
     id = QByteArray(rawId);
+    idHash = qHash(id);
 }
 
 /**
@@ -47,7 +49,9 @@ ContactId::ContactId(const QByteArray& rawId)
  */
 bool ContactId::operator==(const ContactId& other) const
 {
-    return id == other.id;
+    // differing hashes reject a mismatch without touching the key bytes,
+    // which is the common case when probing a hash bucket
+    return idHash == other.idHash && id == other.id;
 }
 
 /**
@@ -94,12 +98,21 @@ const uint8_t* ContactId::getData() const
 }
 
 /**
- * @brief Get a copy of the id
- * @return Copied id bytes
+ * @brief Get the id bytes
+ * @return Reference to the id bytes; implicitly shared if callers keep a copy
  */
-QByteArray ContactId::getByteArray() const
+const QByteArray& ContactId::getByteArray() const
 {
-    return QByteArray(id); // TODO: Is a copy really necessary?
+    return id;
+}
+
+/**
+ * @brief Get the hash precomputed at construction.
+ * @return Hash of the id bytes, as qHash(QByteArray) would produce.
+ */
+uint ContactId::getHash() const
+{
+    return idHash;
 }
 
 /**
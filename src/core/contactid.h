@@ -36,20 +36,24 @@ public:
     bool operator!=(const ContactId& other) const;
     bool operator<(const ContactId& other) const;
     QString toString() const;
-    QByteArray getByteArray() const;
+    const QByteArray& getByteArray() const;
     const uint8_t* getData() const;
     bool isEmpty() const;
+    uint getHash() const;
     virtual int getSize() const = 0;
 
 protected:
     ContactId();
     explicit ContactId(const QByteArray& rawId);
     QByteArray id;
+    // ids are immutable after construction, so the hash is computed once
+    // here instead of walking the 32 key bytes on every QHash lookup
+    uint idHash = 0;
 };
 
 inline uint qHash(const ContactId& id)
 {
-    return qHash(id.getByteArray());
+    return id.getHash();
 }
 
 using ContactIdPtr = std::shared_ptr<const ContactId>;
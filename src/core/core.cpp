@@ -21,6 +21,7 @@
 #include "core.h"
 #include "corefile.h"
 #include "src/core/coreav.h"
+#include "src/core/coretimingstats.h"
 #include "src/core/dhtserver.h"
 #include "src/core/icoresettings.h"
 #include "src/core/toxlogger.h"
@@ -32,8 +33,10 @@
 #include "src/nexus.h"
 #include "src/persistence/profile.h"
 #include "src/util/strongtype.h"
+#include "src/util/tracepoints.h"
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QRegularExpression>
 #include <QString>
 #include <QStringBuilder>
@@ -125,12 +128,28 @@ Core::Core(QThread* coreThread)
     : tox(nullptr)
     , av(nullptr)
     , toxTimer{new QTimer{this}}
+    , statusBatchTimer{new QTimer{this}}
     , coreThread(coreThread)
 {
     assert(toxTimer);
     toxTimer->setSingleShot(true);
     connect(toxTimer, &QTimer::timeout, this, &Core::process);
     connect(coreThread, &QThread::finished, toxTimer, &QTimer::stop);
+
+    // short enough to feel immediate, long enough to swallow the burst of
+    // connection callbacks after a reconnect
+    statusBatchTimer->setSingleShot(true);
+    statusBatchTimer->setInterval(50);
+    connect(statusBatchTimer, &QTimer::timeout, this, &Core::flushFriendStatusChanges);
+    // the timer must be started from the thread it lives on, but callbacks
+    // may run on the CoreFile iteration thread, so route through a signal
+    // with the timer as context
+    connect(this, &Core::statusBatchRequested, statusBatchTimer, [this] {
+        if (!statusBatchTimer->isActive()) {
+            statusBatchTimer->start();
+        }
+    });
+    connect(coreThread, &QThread::finished, statusBatchTimer, &QTimer::stop);
 }
 
 Core::~Core()
@@ -289,7 +308,7 @@ ToxCorePtr Core::makeToxCore(const QByteArray& savedata, const ICoreSettings* co
     }
 
     // create CoreFile
-    core->file = CoreFile::makeCoreFile(core.get(), core->tox.get(), core->coreLoopLock);
+    core->file = CoreFile::makeCoreFile(core.get(), core->tox.get(), core->coreLoopLock, settings);
     if (!core->file) {
         qCritical() << "CoreFile failed to start";
         if (err) {
@@ -387,8 +406,15 @@ void Core::process()
 
     ASSERT_CORE_THREAD;
 
+    QTOX_TRACE(core_process);
+
+    CoreTimingProbe processProbe{CoreTimingStats::ProcessIteration};
+
     static int tolerance = CORE_DISCONNECT_TOLERANCE;
-    tox_iterate(tox.get(), this);
+    {
+        CoreTimingProbe iterateProbe{CoreTimingStats::ToxIterate};
+        tox_iterate(tox.get(), this);
+    }
 
 #ifdef DEBUG
     // we want to see the debug messages immediately
@@ -403,11 +429,34 @@ void Core::process()
         tolerance = 3 * CORE_DISCONNECT_TOLERANCE;
     }
 
-    unsigned sleeptime =
-        qMin(tox_iteration_interval(tox.get()), getCoreFile()->corefileIterationInterval());
+    // periodically surface the timing histograms so core-thread stalls show
+    // up in logs from the field without anyone attaching a profiler
+    static QElapsedTimer timingDump;
+    if (!timingDump.isValid()) {
+        timingDump.start();
+    } else if (timingDump.elapsed() >= 5 * 60 * 1000) {
+        for (const QString& line : CoreTimingStats::snapshot()) {
+            qDebug() << "Core timing:" << line;
+        }
+        timingDump.restart();
+    }
+
+    // file transfers are pumped by CoreFile's own iteration thread, so this
+    // loop only has to wake up at the cadence messaging needs
+    unsigned sleeptime = tox_iteration_interval(tox.get());
     toxTimer->start(sleeptime);
 }
 
+namespace {
+// toxcore queries every seeded node concurrently, so racing several beats
+// gambling on two; more than this mostly churns the DHT close list
+constexpr int maxBootstrapNodes = 6;
+// the round of nodes the current connect attempt was seeded from, credited
+// in checkConnection() once the DHT connection comes up
+QList<DhtServer> lastBootstrapRound;
+QElapsedTimer bootstrapElapsed;
+} // namespace
+
 bool Core::checkConnection()
 {
     ASSERT_CORE_THREAD;
@@ -415,6 +464,10 @@ bool Core::checkConnection()
     bool toxConnected = tox_self_get_connection_status(tox.get()) != TOX_CONNECTION_NONE;
     if (toxConnected && !isConnected) {
         qDebug() << "Connected to the DHT";
+        if (!lastBootstrapRound.isEmpty() && bootstrapElapsed.isValid()) {
+            BootstrapNodeUpdater::reportConnectTime(lastBootstrapRound, bootstrapElapsed.elapsed());
+            lastBootstrapRound.clear();
+        }
         emit connected();
     } else if (!toxConnected && isConnected) {
         qDebug() << "Disconnected from the DHT";
@@ -432,7 +485,8 @@ void Core::bootstrapDht()
 {
     ASSERT_CORE_THREAD;
 
-    QList<DhtServer> bootstrapNodes = BootstrapNodeUpdater::loadDefaultBootstrapNodes();
+    QList<DhtServer> bootstrapNodes =
+        BootstrapNodeUpdater::rankNodes(BootstrapNodeUpdater::loadDefaultBootstrapNodes());
 
     int listSize = bootstrapNodes.size();
     if (!listSize) {
@@ -440,11 +494,10 @@ void Core::bootstrapDht()
         return;
     }
 
-    int i = 0;
-    static int j = qrand() % listSize;
-    // i think the more we bootstrap, the more we jitter because the more we overwrite nodes
-    while (i < 2) {
-        const DhtServer& dhtServer = bootstrapNodes[j % listSize];
+    lastBootstrapRound.clear();
+    const int attempts = qMin(maxBootstrapNodes, listSize);
+    for (int i = 0; i < attempts; ++i) {
+        const DhtServer& dhtServer = bootstrapNodes[i];
         QString dhtServerAddress = dhtServer.address.toLatin1();
         QString port = QString::number(dhtServer.port);
         QString name = dhtServer.name;
@@ -464,47 +517,54 @@ void Core::bootstrapDht()
             qDebug() << "Error adding TCP relay from " + dhtServer.name;
         }
 
-        ++j;
-        ++i;
+        lastBootstrapRound.append(dhtServer);
     }
+    bootstrapElapsed.start();
 }
 
 void Core::onFriendRequest(Tox*, const uint8_t* cFriendPk, const uint8_t* cMessage,
                            size_t cMessageSize, void* core)
 {
+    CoreTimingProbe probe{CoreTimingStats::FriendRequestCb};
     ToxPk friendPk(cFriendPk);
-    QString requestMessage = ToxString(cMessage, cMessageSize).getQString();
+    QString requestMessage = ToxStringView(cMessage, cMessageSize).getQString();
     emit static_cast<Core*>(core)->friendRequestReceived(friendPk, requestMessage);
 }
 
 void Core::onFriendMessage(Tox*, uint32_t friendId, Tox_Message_Type type, const uint8_t* cMessage,
                            size_t cMessageSize, void* core)
 {
+    CoreTimingProbe probe{CoreTimingStats::FriendMessageCb};
+    QTOX_TRACE2(friend_message, friendId, cMessageSize);
     bool isAction = (type == TOX_MESSAGE_TYPE_ACTION);
-    QString msg = ToxString(cMessage, cMessageSize).getQString();
+    QString msg = ToxStringView(cMessage, cMessageSize).getQString();
     emit static_cast<Core*>(core)->friendMessageReceived(friendId, msg, isAction);
 }
 
 void Core::onFriendNameChange(Tox*, uint32_t friendId, const uint8_t* cName, size_t cNameSize, void* core)
 {
-    QString newName = ToxString(cName, cNameSize).getQString();
+    CoreTimingProbe probe{CoreTimingStats::FriendNameCb};
+    QString newName = ToxStringView(cName, cNameSize).getQString();
     emit static_cast<Core*>(core)->friendUsernameChanged(friendId, newName);
 }
 
 void Core::onFriendTypingChange(Tox*, uint32_t friendId, bool isTyping, void* core)
 {
+    CoreTimingProbe probe{CoreTimingStats::FriendTypingCb};
     emit static_cast<Core*>(core)->friendTypingChanged(friendId, isTyping);
 }
 
 void Core::onStatusMessageChanged(Tox*, uint32_t friendId, const uint8_t* cMessage,
                                   size_t cMessageSize, void* core)
 {
-    QString message = ToxString(cMessage, cMessageSize).getQString();
+    CoreTimingProbe probe{CoreTimingStats::StatusMessageCb};
+    QString message = ToxStringView(cMessage, cMessageSize).getQString();
     emit static_cast<Core*>(core)->friendStatusMessageChanged(friendId, message);
 }
 
 void Core::onUserStatusChanged(Tox*, uint32_t friendId, Tox_User_Status userstatus, void* core)
 {
+    CoreTimingProbe probe{CoreTimingStats::UserStatusCb};
     Status::Status status;
     switch (userstatus) {
     case TOX_USER_STATUS_AWAY:
@@ -520,25 +580,66 @@ void Core::onUserStatusChanged(Tox*, uint32_t friendId, Tox_User_Status userstat
         break;
     }
 
-    emit static_cast<Core*>(core)->friendStatusChanged(friendId, status);
+    static_cast<Core*>(core)->queueFriendStatusChange(friendId, status);
 }
 
 void Core::onConnectionStatusChanged(Tox*, uint32_t friendId, Tox_Connection status, void* vCore)
 {
+    CoreTimingProbe probe{CoreTimingStats::ConnectionStatusCb};
     Core* core = static_cast<Core*>(vCore);
     Status::Status friendStatus =
         status != TOX_CONNECTION_NONE ? Status::Status::Online : Status::Status::Offline;
     // Ignore Online because it will be emited from onUserStatusChanged
     bool isOffline = friendStatus == Status::Status::Offline;
     if (isOffline) {
-        emit core->friendStatusChanged(friendId, friendStatus);
+        core->queueFriendStatusChange(friendId, friendStatus);
         core->checkLastOnline(friendId);
     }
 }
 
+/**
+ * @brief Records a friend status change for the next coalesced flush.
+ *
+ * Callbacks arrive in bursts while the DHT settles, one per friend; queueing
+ * them behind a short timer lets the GUI process the whole batch in a single
+ * event instead of relayouting the friend list once per signal. Called with
+ * the core lock held, from either iteration thread.
+ */
+void Core::queueFriendStatusChange(uint32_t friendId, Status::Status status)
+{
+    pendingFriendStatuses[friendId] = status;
+    emit statusBatchRequested();
+}
+
+/**
+ * @brief Emits the queued status changes, deduplicated to each friend's final state.
+ *
+ * The granular friendStatusChanged signal is still emitted per friend for
+ * consumers that track single friends; list-wide consumers should use the
+ * batched friendsStatusesChanged instead.
+ */
+void Core::flushFriendStatusChanges()
+{
+    QVector<QPair<uint32_t, Status::Status>> batch;
+    {
+        QMutexLocker ml{&coreLoopLock};
+        batch.reserve(pendingFriendStatuses.size());
+        for (auto it = pendingFriendStatuses.cbegin(); it != pendingFriendStatuses.cend(); ++it) {
+            batch.append({it.key(), it.value()});
+        }
+        pendingFriendStatuses.clear();
+    }
+
+    for (const auto& change : batch) {
+        emit friendStatusChanged(change.first, change.second);
+    }
+    emit friendsStatusesChanged(batch);
+}
+
 void Core::onGroupInvite(Tox* tox, uint32_t friendId, Tox_Conference_Type type,
                          const uint8_t* cookie, size_t length, void* vCore)
 {
+    CoreTimingProbe probe{CoreTimingStats::GroupInviteCb};
     Core* core = static_cast<Core*>(vCore);
     const QByteArray data(reinterpret_cast<const char*>(cookie), length);
     const GroupInvite inviteInfo(friendId, type, data);
@@ -561,14 +662,17 @@ void Core::onGroupInvite(Tox* tox, uint32_t friendId, Tox_Conference_Type type,
 void Core::onGroupMessage(Tox*, uint32_t groupId, uint32_t peerId, Tox_Message_Type type,
                           const uint8_t* cMessage, size_t length, void* vCore)
 {
+    CoreTimingProbe probe{CoreTimingStats::GroupMessageCb};
+    QTOX_TRACE3(group_message, groupId, peerId, length);
     Core* core = static_cast<Core*>(vCore);
     bool isAction = type == TOX_MESSAGE_TYPE_ACTION;
-    QString message = ToxString(cMessage, length).getQString();
+    QString message = ToxStringView(cMessage, length).getQString();
     emit core->groupMessageReceived(groupId, peerId, message, isAction);
 }
 
 void Core::onGroupPeerListChange(Tox*, uint32_t groupId, void* vCore)
 {
+    CoreTimingProbe probe{CoreTimingStats::GroupPeerListCb};
     const auto core = static_cast<Core*>(vCore);
     qDebug() << QString("Group %1 peerlist changed").arg(groupId);
     emit core->groupPeerlistChanged(groupId);
@@ -577,7 +681,8 @@ void Core::onGroupPeerListChange(Tox*, uint32_t groupId, void* vCore)
 void Core::onGroupPeerNameChange(Tox*, uint32_t groupId, uint32_t peerId, const uint8_t* name,
                                  size_t length, void* vCore)
 {
-    const auto newName = ToxString(name, length).getQString();
+    CoreTimingProbe probe{CoreTimingStats::GroupPeerNameCb};
+    const auto newName = ToxStringView(name, length).getQString();
     qDebug() << QString("Group %1, Peer %2, name changed to %3").arg(groupId).arg(peerId).arg(newName);
     auto* core = static_cast<Core*>(vCore);
     auto peerPk = core->getGroupPeerPk(groupId, peerId);
@@ -587,13 +692,15 @@ void Core::onGroupPeerNameChange(Tox*, uint32_t groupId, uint32_t peerId, const
 void Core::onGroupTitleChange(Tox*, uint32_t groupId, uint32_t peerId, const uint8_t* cTitle,
                               size_t length, void* vCore)
 {
+    CoreTimingProbe probe{CoreTimingStats::GroupTitleCb};
     Core* core = static_cast<Core*>(vCore);
     QString author = core->getGroupPeerName(groupId, peerId);
-    emit core->groupTitleChanged(groupId, author, ToxString(cTitle, length).getQString());
+    emit core->groupTitleChanged(groupId, author, ToxStringView(cTitle, length).getQString());
 }
 
 void Core::onReadReceiptCallback(Tox*, uint32_t friendId, uint32_t receipt, void* core)
 {
+    CoreTimingProbe probe{CoreTimingStats::ReadReceiptCb};
     emit static_cast<Core*>(core)->receiptRecieved(friendId, ReceiptNum{receipt});
 }
 
@@ -983,13 +1090,12 @@ QByteArray Core::getToxSaveData()
 }
 
 // Declared to avoid code duplication
-#define GET_FRIEND_PROPERTY(property, function, checkSize)                     \
+#define GET_FRIEND_PROPERTY(property, function, target, checkSize)             \
     const size_t property##Size = function##_size(tox.get(), ids[i], nullptr); \
     if ((!checkSize || property##Size) && property##Size != SIZE_MAX) {        \
         uint8_t* prop = new uint8_t[property##Size];                           \
         if (function(tox.get(), ids[i], prop, nullptr)) {                      \
-            QString propStr = ToxString(prop, property##Size).getQString();    \
-            emit friend##property##Changed(ids[i], propStr);                   \
+            target = ToxString(prop, property##Size).getQString();             \
         }                                                                      \
                                                                                \
         delete[] prop;                                                         \
@@ -1004,6 +1110,13 @@ void Core::loadFriends()
         return;
     }
 
+    // Extract everything in one pass into a contiguous snapshot and emit it
+    // as a single payload. Emitting friendAdded plus a signal per property
+    // per friend queued thousands of GUI events on large profiles before
+    // the window could settle.
+    QVector<CoreFriendInfo> friends;
+    friends.reserve(static_cast<int>(friendCount));
+
     uint32_t* ids = new uint32_t[friendCount];
     tox_self_get_friend_list(tox.get(), ids);
     uint8_t friendPk[TOX_PUBLIC_KEY_SIZE] = {0x00};
@@ -1012,12 +1125,22 @@ void Core::loadFriends()
             continue;
         }
 
-        emit friendAdded(ids[i], ToxPk(friendPk));
-        GET_FRIEND_PROPERTY(Username, tox_friend_get_name, true);
-        GET_FRIEND_PROPERTY(StatusMessage, tox_friend_get_status_message, false);
-        checkLastOnline(ids[i]);
+        CoreFriendInfo info;
+        info.friendId = ids[i];
+        info.friendPk = ToxPk(friendPk);
+        GET_FRIEND_PROPERTY(Username, tox_friend_get_name, info.username, true);
+        GET_FRIEND_PROPERTY(StatusMessage, tox_friend_get_status_message, info.statusMessage, false);
+
+        const uint64_t lastOnline = tox_friend_get_last_online(tox.get(), ids[i], nullptr);
+        if (lastOnline != std::numeric_limits<uint64_t>::max()) {
+            info.lastSeen = QDateTime::fromTime_t(lastOnline);
+        }
+
+        friends += info;
     }
     delete[] ids;
+
+    emit friendsLoaded(friends);
 }
 
 void Core::loadGroups()
@@ -35,10 +35,12 @@
 #include "src/model/status.h"
 #include <tox/tox.h>
 
+#include <QDateTime>
 #include <QMutex>
 #include <QObject>
 #include <QThread>
 #include <QTimer>
+#include <QVector>
 
 #include <functional>
 #include <memory>
@@ -53,6 +55,19 @@ class Core;
 
 using ToxCorePtr = std::unique_ptr<Core>;
 
+// One friend's data extracted from toxcore in bulk at profile load,
+// delivered as a single friendsLoaded payload instead of a signal per
+// friend and per property
+struct CoreFriendInfo
+{
+    uint32_t friendId;
+    ToxPk friendPk;
+    QString username;
+    QString statusMessage;
+    // invalid when toxcore never saw the friend online
+    QDateTime lastSeen;
+};
+
 class Core : public QObject,
              public ICoreFriendMessageSender,
              public ICoreIdHandler,
@@ -163,8 +178,15 @@ signals:
 
     void friendMessageReceived(uint32_t friendId, const QString& message, bool isAction);
     void friendAdded(uint32_t friendId, const ToxPk& friendPk);
+    // the whole friend list in one payload, emitted once at profile load;
+    // friendAdded still covers friends added while running
+    void friendsLoaded(const QVector<CoreFriendInfo>& friends);
 
     void friendStatusChanged(uint32_t friendId, Status::Status status);
+    // one coalesced batch per flush tick, deduplicated per friend; consumers
+    // that walk the whole friend list should prefer this over the granular
+    // signal so a reconnect burst is handled in a single pass
+    void friendsStatusesChanged(const QVector<QPair<uint32_t, Status::Status>>& statuses);
     void friendStatusMessageChanged(uint32_t friendId, const QString& message);
     void friendUsernameChanged(uint32_t friendId, const QString& username);
     void friendTypingChanged(uint32_t friendId, bool isTyping);
@@ -188,9 +210,16 @@ signals:
 
     void failedToRemoveFriend(uint32_t friendId);
 
+    // internal: asks the status batch timer, which lives on the core thread,
+    // to schedule a flush no matter which iteration thread queued the change
+    void statusBatchRequested();
+
 private:
     Core(QThread* coreThread);
 
+    // re-emits recorded events through our signals, see coreeventlog.h
+    friend class CoreEventReplayer;
+
     static void onFriendRequest(Tox* tox, const uint8_t* cUserId, const uint8_t* cMessage,
                                 size_t cMessageSize, void* core);
     static void onFriendMessage(Tox* tox, uint32_t friendId, Tox_Message_Type type,
@@ -227,6 +256,7 @@ private:
     void bootstrapDht();
 
     void checkLastOnline(uint32_t friendId);
+    void queueFriendStatusChange(uint32_t friendId, Status::Status status);
 
     QString getFriendRequestErrorMessage(const ToxId& friendId, const QString& message) const;
     static void registerCallbacks(Tox* tox);
@@ -234,6 +264,7 @@ private:
 private slots:
     void process();
     void onStarted();
+    void flushFriendStatusChanges();
 
 private:
     struct ToxDeleter
@@ -250,6 +281,11 @@ private:
     std::unique_ptr<CoreFile> file;
     std::unique_ptr<CoreAV> av;
     QTimer* toxTimer = nullptr;
+    // status changes are coalesced per flush tick so a reconnect after
+    // downtime doesn't deliver one GUI event per friend; guarded by the core
+    // lock since callbacks can fire from either iteration thread
+    QHash<uint32_t, Status::Status> pendingFriendStatuses;
+    QTimer* statusBatchTimer = nullptr;
     // recursive, since we might call our own functions
     mutable QMutex coreLoopLock{QMutex::Recursive};
 
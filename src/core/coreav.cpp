@@ -23,10 +23,12 @@
 #include "src/model/friend.h"
 #include "src/model/group.h"
 #include "src/persistence/settings.h"
+#include "src/util/tracepoints.h"
 #include "src/video/corevideosource.h"
 #include "src/video/videoframe.h"
 #include <QCoreApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QThread>
 #include <QTimer>
 #include <QtConcurrent/QtConcurrentRun>
@@ -68,18 +70,6 @@
  * deadlock.
  */
 
-/**
- * @brief Maps friend IDs to ToxFriendCall.
- * @note Need to use STL container here, because Qt containers need a copy constructor.
- */
-std::map<uint32_t, CoreAV::ToxFriendCallPtr> CoreAV::calls;
-
-/**
- * @brief Maps group IDs to ToxGroupCalls.
- * @note Need to use STL container here, because Qt containers need a copy constructor.
- */
-std::map<int, CoreAV::ToxGroupCallPtr> CoreAV::groupCalls;
-
 CoreAV::CoreAV(std::unique_ptr<ToxAV, ToxAVDeleter> toxav)
     : audio{nullptr}
     , toxav{std::move(toxav)}
@@ -164,8 +154,13 @@ IAudioControl* CoreAV::getAudio()
 
 CoreAV::~CoreAV()
 {
-    for (const auto& call : calls) {
-        cancelCall(call.first);
+    // Collect the numbers first, cancelCall() erases from the table
+    std::vector<uint32_t> activeCalls;
+    calls.forEach([&activeCalls](uint32_t friendNum, ToxFriendCall&) {
+        activeCalls.push_back(friendNum);
+    });
+    for (const uint32_t friendNum : activeCalls) {
+        cancelCall(friendNum);
     }
 
     coreavThread->exit(0);
@@ -186,7 +181,37 @@ void CoreAV::start()
 void CoreAV::process()
 {
     toxav_iterate(toxav.get());
-    iterateTimer->start(toxav_iteration_interval(toxav.get()));
+    if (calls.empty() && groupCalls.empty()) {
+        // Nothing to pump, park the loop at a slow poll. wakeIteration()
+        // snaps us back to a tight cadence the moment a call is set up.
+        iterateTimer->start(IDLE_ITERATION_INTERVAL_MS);
+    } else {
+        iterateTimer->start(toxav_iteration_interval(toxav.get()));
+    }
+
+    if (!statsTimer.isValid()) {
+        statsTimer.start();
+    } else if (statsTimer.elapsed() >= STATS_INTERVAL_MS) {
+        statsTimer.restart();
+        calls.forEach([this](uint32_t friendNum, ToxFriendCall& call) {
+            emit callStatsReady(friendNum, call.sampleStats());
+        });
+    }
+}
+
+/**
+ * @brief Re-arms the iteration timer for an immediate pass.
+ *
+ * While idle the loop only polls every IDLE_ITERATION_INTERVAL_MS, so call
+ * setup would otherwise wait out the rest of that long tick. process() then
+ * keeps the tight toxav_iteration_interval() cadence as long as a call exists.
+ */
+void CoreAV::wakeIteration()
+{
+    // Timers can only be touched from their own thread
+    if (QThread::currentThread() != coreavThread.get())
+        return (void)QMetaObject::invokeMethod(this, "wakeIteration", Qt::QueuedConnection);
+    iterateTimer->start(0);
 }
 
 /**
@@ -206,7 +231,7 @@ bool CoreAV::anyActiveCalls() const
  */
 bool CoreAV::isCallStarted(const Friend* f) const
 {
-    return f && (calls.find(f->getId()) != calls.end());
+    return f && calls.contains(f->getId());
 }
 
 /**
@@ -216,7 +241,7 @@ bool CoreAV::isCallStarted(const Friend* f) const
  */
 bool CoreAV::isCallStarted(const Group* g) const
 {
-    return g && (groupCalls.find(g->getId()) != groupCalls.end());
+    return g && groupCalls.contains(g->getId());
 }
 
 /**
@@ -226,11 +251,11 @@ bool CoreAV::isCallStarted(const Group* g) const
  */
 bool CoreAV::isCallActive(const Friend* f) const
 {
-    auto it = calls.find(f->getId());
-    if (it == calls.end()) {
+    ToxFriendCall* call = calls.find(f->getId());
+    if (!call) {
         return false;
     }
-    return isCallStarted(f) && it->second->isActive();
+    return isCallStarted(f) && call->isActive();
 }
 
 /**
@@ -240,90 +265,96 @@ bool CoreAV::isCallActive(const Friend* f) const
  */
 bool CoreAV::isCallActive(const Group* g) const
 {
-    auto it = groupCalls.find(g->getId());
-    if (it == groupCalls.end()) {
+    ToxGroupCall* call = groupCalls.find(g->getId());
+    if (!call) {
         return false;
     }
-    return isCallStarted(g) && it->second->isActive();
+    return isCallStarted(g) && call->isActive();
 }
 
 bool CoreAV::isCallVideoEnabled(const Friend* f) const
 {
-    auto it = calls.find(f->getId());
-    return isCallStarted(f) && it->second->getVideoEnabled();
+    ToxFriendCall* call = calls.find(f->getId());
+    return isCallStarted(f) && call->getVideoEnabled();
 }
 
-bool CoreAV::answerCall(uint32_t friendNum, bool video)
+/**
+ * @brief Answers an incoming call, asynchronously.
+ *
+ * Returns as soon as the request is queued to the AV thread; the outcome
+ * comes back as avStart or avCallFailed. This used to block the caller on a
+ * BlockingQueuedConnection until toxav finished negotiating, so a busy AV
+ * thread made the answer button feel stuck and could outlast the ring.
+ */
+void CoreAV::answerCall(uint32_t friendNum, bool video)
 {
     if (QThread::currentThread() != coreavThread.get()) {
-        if (threadSwitchLock.test_and_set(std::memory_order_acquire)) {
-            qDebug() << "CoreAV::answerCall: Backed off of thread-switch lock";
-            return false;
-        }
-
-        bool ret;
-        QMetaObject::invokeMethod(this, "answerCall", Qt::BlockingQueuedConnection,
-                                  Q_RETURN_ARG(bool, ret), Q_ARG(uint32_t, friendNum),
-                                  Q_ARG(bool, video));
-
-        threadSwitchLock.clear(std::memory_order_release);
-        return ret;
+        QMetaObject::invokeMethod(this, "answerCall", Qt::QueuedConnection,
+                                  Q_ARG(uint32_t, friendNum), Q_ARG(bool, video));
+        return;
     }
 
     qDebug() << QString("answering call %1").arg(friendNum);
-    auto it = calls.find(friendNum);
-    assert(it != calls.end());
+    ToxFriendCall* call = calls.find(friendNum);
+    assert(call != nullptr);
     TOXAV_ERR_ANSWER err;
 
     const uint32_t videoBitrate = video ? VIDEO_DEFAULT_BITRATE : 0;
     if (toxav_answer(toxav.get(), friendNum, Settings::getInstance().getAudioBitrate(),
                      videoBitrate, &err)) {
-        it->second->setActive(true);
-        return true;
+        call->setActive(true);
+        call->setVideoBitrate(videoBitrate);
+        wakeIteration();
+        // answering generates no state callback, so the accepted-call
+        // notification is on us
+        emit avStart(friendNum, call->getVideoEnabled());
     } else {
         qWarning() << "Failed to answer call with error" << err;
         toxav_call_control(toxav.get(), friendNum, TOXAV_CALL_CONTROL_CANCEL, nullptr);
-        calls.erase(it);
-        return false;
+        calls.erase(friendNum);
+        emit avCallFailed(friendNum);
     }
 }
 
-bool CoreAV::startCall(uint32_t friendNum, bool video)
+/**
+ * @brief Starts a call with a friend, asynchronously.
+ *
+ * Returns as soon as the request is queued to the AV thread; the UI shows
+ * the outgoing-call state right away and reverts it on avCallFailed. Ringing
+ * and acceptance are reported through avStart by the state callback as
+ * before. Device initialization happens on the AV thread, off the caller.
+ */
+void CoreAV::startCall(uint32_t friendNum, bool video)
 {
     if (QThread::currentThread() != coreavThread.get()) {
-        if (threadSwitchLock.test_and_set(std::memory_order_acquire)) {
-            qDebug() << "CoreAV::startCall: Backed off of thread-switch lock";
-            return false;
-        }
-
-        bool ret;
-        QMetaObject::invokeMethod(this, "startCall", Qt::BlockingQueuedConnection,
-                                  Q_RETURN_ARG(bool, ret), Q_ARG(uint32_t, friendNum),
-                                  Q_ARG(bool, video));
-
-        threadSwitchLock.clear(std::memory_order_release);
-        return ret;
+        QMetaObject::invokeMethod(this, "startCall", Qt::QueuedConnection,
+                                  Q_ARG(uint32_t, friendNum), Q_ARG(bool, video));
+        return;
     }
 
     qDebug() << QString("Starting call with %1").arg(friendNum);
-    auto it = calls.find(friendNum);
-    if (it != calls.end()) {
+    if (calls.contains(friendNum)) {
         qWarning() << QString("Can't start call with %1, we're already in this call!").arg(friendNum);
-        return false;
+        emit avCallFailed(friendNum);
+        return;
     }
 
     uint32_t videoBitrate = video ? VIDEO_DEFAULT_BITRATE : 0;
     if (!toxav_call(toxav.get(), friendNum, Settings::getInstance().getAudioBitrate(), videoBitrate,
-                    nullptr))
-        return false;
+                    nullptr)) {
+        emit avCallFailed(friendNum);
+        return;
+    }
 
     // Audio backend must be set before making a call
     assert(audio != nullptr);
     ToxFriendCallPtr call = ToxFriendCallPtr(new ToxFriendCall(friendNum, video, *this, *audio));
     assert(call != nullptr);
-    auto ret = calls.emplace(friendNum, std::move(call));
-    ret.first->second->startTimeout(friendNum);
-    return true;
+    ToxFriendCall* inserted = call.get();
+    calls.insert(friendNum, std::move(call));
+    inserted->startTimeout(friendNum);
+    inserted->setVideoBitrate(videoBitrate);
+    wakeIteration();
 }
 
 bool CoreAV::cancelCall(uint32_t friendNum)
@@ -382,18 +413,20 @@ void CoreAV::timeoutCall(uint32_t friendNum)
 bool CoreAV::sendCallAudio(uint32_t callId, const int16_t* pcm, size_t samples, uint8_t chans,
                            uint32_t rate) const
 {
-    auto it = calls.find(callId);
-    if (it == calls.end()) {
+    ToxFriendCall* callPtr = calls.find(callId);
+    if (!callPtr) {
         return false;
     }
 
-    ToxFriendCall const& call = *it->second;
+    ToxFriendCall& call = *callPtr;
 
     if (call.getMuteMic() || !call.isActive()
         || !(call.getState() & TOXAV_FRIEND_CALL_STATE_ACCEPTING_A)) {
         return true;
     }
 
+    QTOX_TRACE2(av_send_audio, callId, samples);
+
     // TOXAV_ERR_SEND_FRAME_SYNC means toxav failed to lock, retry 5 times in this case
     TOXAV_ERR_SEND_FRAME err;
     int retries = 0;
@@ -409,6 +442,8 @@ bool CoreAV::sendCallAudio(uint32_t callId, const int16_t* pcm, size_t samples,
     } while (err == TOXAV_ERR_SEND_FRAME_SYNC && retries < 5);
     if (err == TOXAV_ERR_SEND_FRAME_SYNC) {
         qDebug() << "toxav_audio_send_frame error: Lock busy, dropping frame";
+    } else if (err == TOXAV_ERR_SEND_FRAME_OK) {
+        call.accountSentAudioFrame();
     }
 
     return true;
@@ -418,12 +453,12 @@ void CoreAV::sendCallVideo(uint32_t callId, std::shared_ptr<VideoFrame> vframe)
 {
     // We might be running in the FFmpeg thread and holding the CameraSource lock
     // So be careful not to deadlock with anything while toxav locks in toxav_video_send_frame
-    auto it = calls.find(callId);
-    if (it == calls.end()) {
+    ToxFriendCall* callPtr = calls.find(callId);
+    if (!callPtr) {
         return;
     }
 
-    ToxFriendCall& call = *it->second;
+    ToxFriendCall& call = *callPtr;
 
     if (!call.getVideoEnabled() || !call.isActive()
         || !(call.getState() & TOXAV_FRIEND_CALL_STATE_ACCEPTING_V)) {
@@ -432,16 +467,35 @@ void CoreAV::sendCallVideo(uint32_t callId, std::shared_ptr<VideoFrame> vframe)
 
     if (call.getNullVideoBitrate()) {
         qDebug() << "Restarting video stream to friend" << callId;
-        toxav_video_set_bit_rate(toxav.get(), callId, VIDEO_DEFAULT_BITRATE, nullptr);
+        // resume at the rate the bitrate controller last settled on, not at
+        // full blast on a link that may still be congested
+        const uint32_t restartBitrate =
+            call.getVideoBitrate() ? call.getVideoBitrate() : VIDEO_DEFAULT_BITRATE;
+        toxav_video_set_bit_rate(toxav.get(), callId, restartBitrate, nullptr);
         call.setNullVideoBitrate(false);
     }
 
-    ToxYUVFrame frame = vframe->toToxYUVFrame();
+    QElapsedTimer encodeTimer;
+    encodeTimer.start();
+
+    // When encoding blows the real-time budget, feed toxav a downscaled
+    // frame; VP8 cost is roughly proportional to the pixel count. The
+    // divisor comes from the call's own accounting below.
+    QSize sendSize = vframe->getSourceDimensions().size();
+    const int divisor = call.getVideoSendDivisor();
+    if (divisor > 1) {
+        // YUV420 needs even dimensions
+        sendSize = QSize((sendSize.width() / divisor) & ~1, (sendSize.height() / divisor) & ~1);
+    }
+
+    ToxYUVFrame frame = vframe->toToxYUVFrame(divisor > 1 ? sendSize : QSize{});
 
     if (!frame) {
         return;
     }
 
+    QTOX_TRACE3(av_send_video, callId, frame.width, frame.height);
+
     // TOXAV_ERR_SEND_FRAME_SYNC means toxav failed to lock, retry 5 times in this case
     // We don't want to be dropping iframes because of some lock held by toxav_iterate
     TOXAV_ERR_SEND_FRAME err;
@@ -459,7 +513,11 @@ void CoreAV::sendCallVideo(uint32_t callId, std::shared_ptr<VideoFrame> vframe)
     } while (err == TOXAV_ERR_SEND_FRAME_SYNC && retries < 5);
     if (err == TOXAV_ERR_SEND_FRAME_SYNC) {
         qDebug() << "toxav_video_send_frame error: Lock busy, dropping frame";
+    } else if (err == TOXAV_ERR_SEND_FRAME_OK) {
+        call.accountSentVideoFrame();
     }
+
+    call.accountVideoEncode(encodeTimer.nsecsElapsed());
 }
 
 /**
@@ -468,10 +526,9 @@ void CoreAV::sendCallVideo(uint32_t callId, std::shared_ptr<VideoFrame> vframe)
  */
 void CoreAV::toggleMuteCallInput(const Friend* f)
 {
-    auto it = calls.find(f->getId());
-    if (f && (it != calls.end())) {
-        ToxCall& call = *it->second;
-        call.setMuteMic(!call.getMuteMic());
+    ToxFriendCall* call = calls.find(f->getId());
+    if (f && call) {
+        call->setMuteMic(!call->getMuteMic());
     }
 }
 
@@ -481,10 +538,9 @@ void CoreAV::toggleMuteCallInput(const Friend* f)
  */
 void CoreAV::toggleMuteCallOutput(const Friend* f)
 {
-    auto it = calls.find(f->getId());
-    if (f && (it != calls.end())) {
-        ToxCall& call = *it->second;
-        call.setMuteVol(!call.getMuteVol());
+    ToxFriendCall* call = calls.find(f->getId());
+    if (f && call) {
+        call->setMuteVol(!call->getMuteVol());
     }
 }
 
@@ -517,12 +573,12 @@ void CoreAV::groupCallCallback(void* tox, uint32_t group, uint32_t peer, const i
 
     CoreAV* cav = c->getAv();
 
-    auto it = cav->groupCalls.find(group);
-    if (it == cav->groupCalls.end()) {
+    ToxGroupCall* callPtr = cav->groupCalls.find(group);
+    if (!callPtr) {
         return;
     }
 
-    ToxGroupCall& call = *it->second;
+    ToxGroupCall& call = *callPtr;
 
     if (call.getMuteVol() || !call.isActive()) {
         return;
@@ -538,11 +594,11 @@ void CoreAV::groupCallCallback(void* tox, uint32_t group, uint32_t peer, const i
  */
 void CoreAV::invalidateGroupCallPeerSource(int group, ToxPk peerPk)
 {
-    auto it = groupCalls.find(group);
-    if (it == groupCalls.end()) {
+    ToxGroupCall* call = groupCalls.find(group);
+    if (!call) {
         return;
     }
-    it->second->removePeer(peerPk);
+    call->removePeer(peerPk);
 }
 
 /**
@@ -552,14 +608,14 @@ void CoreAV::invalidateGroupCallPeerSource(int group, ToxPk peerPk)
  */
 VideoSource* CoreAV::getVideoSourceFromCall(int friendNum) const
 {
-    auto it = calls.find(friendNum);
-    if (it == calls.end()) {
+    ToxFriendCall* call = calls.find(friendNum);
+    if (!call) {
         qWarning() << "CoreAV::getVideoSourceFromCall: No such call, did it die before we finished "
                       "answering?";
         return nullptr;
     }
 
-    return it->second->getVideoSource();
+    return call->getVideoSource();
 }
 
 /**
@@ -575,12 +631,13 @@ void CoreAV::joinGroupCall(int groupId)
     assert(audio != nullptr);
     ToxGroupCallPtr groupcall = ToxGroupCallPtr(new ToxGroupCall{groupId, *this, *audio});
     assert(groupcall != nullptr);
-    auto ret = groupCalls.emplace(groupId, std::move(groupcall));
-    if (ret.second == false) {
+    ToxGroupCall* inserted = groupcall.get();
+    if (!groupCalls.insert(groupId, std::move(groupcall))) {
         qWarning() << "This group call already exists, not joining!";
         return;
     }
-    ret.first->second->setActive(true);
+    inserted->setActive(true);
+    wakeIteration();
 }
 
 /**
@@ -598,12 +655,12 @@ void CoreAV::leaveGroupCall(int groupId)
 bool CoreAV::sendGroupCallAudio(int groupId, const int16_t* pcm, size_t samples, uint8_t chans,
                                 uint32_t rate) const
 {
-    std::map<int, ToxGroupCallPtr>::const_iterator it = groupCalls.find(groupId);
-    if (it == groupCalls.end()) {
+    ToxGroupCall* call = groupCalls.find(groupId);
+    if (!call) {
         return false;
     }
 
-    if (!it->second->isActive() || it->second->getMuteMic()) {
+    if (!call->isActive() || call->getMuteMic()) {
         return true;
     }
 
@@ -620,9 +677,9 @@ bool CoreAV::sendGroupCallAudio(int groupId, const int16_t* pcm, size_t samples,
  */
 void CoreAV::muteCallInput(const Group* g, bool mute)
 {
-    auto it = groupCalls.find(g->getId());
-    if (g && (it != groupCalls.end())) {
-        it->second->setMuteMic(mute);
+    ToxGroupCall* call = groupCalls.find(g->getId());
+    if (g && call) {
+        call->setMuteMic(mute);
     }
 }
 
@@ -633,9 +690,9 @@ void CoreAV::muteCallInput(const Group* g, bool mute)
  */
 void CoreAV::muteCallOutput(const Group* g, bool mute)
 {
-    auto it = groupCalls.find(g->getId());
-    if (g && (it != groupCalls.end())) {
-        it->second->setMuteVol(mute);
+    ToxGroupCall* call = groupCalls.find(g->getId());
+    if (g && call) {
+        call->setMuteVol(mute);
     }
 }
 
@@ -651,8 +708,8 @@ bool CoreAV::isGroupCallInputMuted(const Group* g) const
     }
 
     const uint32_t groupId = g->getId();
-    auto it = groupCalls.find(groupId);
-    return (it != groupCalls.end()) && it->second->getMuteMic();
+    ToxGroupCall* call = groupCalls.find(groupId);
+    return call && call->getMuteMic();
 }
 
 /**
@@ -667,8 +724,8 @@ bool CoreAV::isGroupCallOutputMuted(const Group* g) const
     }
 
     const uint32_t groupId = g->getId();
-    auto it = groupCalls.find(groupId);
-    return (it != groupCalls.end()) && it->second->getMuteVol();
+    ToxGroupCall* call = groupCalls.find(groupId);
+    return call && call->getMuteVol();
 }
 
 /**
@@ -682,8 +739,8 @@ bool CoreAV::isCallInputMuted(const Friend* f) const
         return false;
     }
     const uint32_t friendId = f->getId();
-    auto it = calls.find(friendId);
-    return (it != calls.end()) && it->second->getMuteMic();
+    ToxFriendCall* call = calls.find(friendId);
+    return call && call->getMuteMic();
 }
 
 /**
@@ -697,8 +754,8 @@ bool CoreAV::isCallOutputMuted(const Friend* f) const
         return false;
     }
     const uint32_t friendId = f->getId();
-    auto it = calls.find(friendId);
-    return (it != calls.end()) && it->second->getMuteVol();
+    ToxFriendCall* call = calls.find(friendId);
+    return call && call->getMuteVol();
 }
 
 /**
@@ -709,11 +766,10 @@ void CoreAV::sendNoVideo()
 {
     // We don't change the audio bitrate, but we signal that we're not sending video anymore
     qDebug() << "CoreAV: Signaling end of video sending";
-    for (auto& kv : calls) {
-        ToxFriendCall& call = *kv.second;
-        toxav_video_set_bit_rate(toxav.get(), kv.first, 0, nullptr);
+    calls.forEach([this](uint32_t friendNum, ToxFriendCall& call) {
+        toxav_video_set_bit_rate(toxav.get(), friendNum, 0, nullptr);
         call.setNullVideoBitrate(true);
-    }
+    });
 }
 
 void CoreAV::callCallback(ToxAV* toxav, uint32_t friendNum, bool audio, bool video, void* vSelf)
@@ -742,8 +798,8 @@ void CoreAV::callCallback(ToxAV* toxav, uint32_t friendNum, bool audio, bool vid
     ToxFriendCallPtr call = ToxFriendCallPtr(new ToxFriendCall{friendNum, video, *self, *self->audio});
     assert(call != nullptr);
 
-    auto it = self->calls.emplace(friendNum, std::move(call));
-    if (it.second == false) {
+    ToxFriendCall* inserted = call.get();
+    if (!self->calls.insert(friendNum, std::move(call))) {
         /// Hanging up from a callback is supposed to be UB,
         /// but since currently the toxav callbacks are fired from the toxcore thread,
         /// we'll always reach this point through a non-blocking queud connection, so not in the
@@ -760,7 +816,7 @@ void CoreAV::callCallback(ToxAV* toxav, uint32_t friendNum, bool audio, bool vid
         state |= TOXAV_FRIEND_CALL_STATE_SENDING_A | TOXAV_FRIEND_CALL_STATE_ACCEPTING_A;
     if (video)
         state |= TOXAV_FRIEND_CALL_STATE_SENDING_V | TOXAV_FRIEND_CALL_STATE_ACCEPTING_V;
-    it.first->second->setState(static_cast<TOXAV_FRIEND_CALL_STATE>(state));
+    inserted->setState(static_cast<TOXAV_FRIEND_CALL_STATE>(state));
     // note: changed to self->
 
     emit reinterpret_cast<CoreAV*>(self)->avInvite(friendNum, video);
@@ -788,24 +844,22 @@ void CoreAV::stateCallback(ToxAV* toxav, uint32_t friendNum, uint32_t state, voi
         return;
     }
 
-    auto it = self->calls.find(friendNum);
-    if (it == self->calls.end()) {
+    ToxFriendCall* callPtr = self->calls.find(friendNum);
+    if (!callPtr) {
         qWarning() << QString("stateCallback called, but call %1 is already dead").arg(friendNum);
         self->threadSwitchLock.clear(std::memory_order_release);
         return;
     }
 
-    ToxFriendCall& call = *it->second;
+    ToxFriendCall& call = *callPtr;
 
     if (state & TOXAV_FRIEND_CALL_STATE_ERROR) {
         qWarning() << "Call with friend" << friendNum << "died of unnatural causes!";
-        calls.erase(friendNum);
-        // why not self->
+        self->calls.erase(friendNum);
         emit self->avEnd(friendNum, true);
     } else if (state & TOXAV_FRIEND_CALL_STATE_FINISHED) {
         qDebug() << "Call with friend" << friendNum << "finished quietly";
-        calls.erase(friendNum);
-        // why not self->
+        self->calls.erase(friendNum);
         emit self->avEnd(friendNum);
     } else {
         // If our state was null, we started the call and were still ringing
@@ -878,19 +932,40 @@ void CoreAV::videoBitrateCallback(ToxAV* toxav, uint32_t friendNum, uint32_t rat
                                                Q_ARG(uint32_t, rate), Q_ARG(void*, vSelf));
     }
 
-    qDebug() << "Recommended video bitrate with" << friendNum << " is now " << rate << ", ignoring it";
+    ToxFriendCall* callPtr = self->calls.find(friendNum);
+    if (!callPtr) {
+        return;
+    }
+
+    ToxFriendCall& call = *callPtr;
+    const uint32_t newRate = call.onRecommendedVideoBitrate(rate);
+    if (newRate == 0) {
+        return;
+    }
+
+    TOXAV_ERR_BIT_RATE_SET err;
+    if (!toxav_video_set_bit_rate(toxav, friendNum, newRate, &err)) {
+        qWarning() << "Failed to adapt video bitrate with" << friendNum << ", error" << err;
+        return;
+    }
+
+    qDebug() << "Video bitrate with" << friendNum << "adapted to" << newRate << "(recommended"
+             << rate << ")";
+    emit self->videoBitrateChanged(friendNum, newRate);
 }
 
 void CoreAV::audioFrameCallback(ToxAV*, uint32_t friendNum, const int16_t* pcm, size_t sampleCount,
                                 uint8_t channels, uint32_t samplingRate, void* vSelf)
 {
     CoreAV* self = static_cast<CoreAV*>(vSelf);
-    auto it = calls.find(friendNum);
-    if (it == self->calls.end()) {
+    QTOX_TRACE2(av_recv_audio, friendNum, sampleCount);
+    ToxFriendCall* callPtr = self->calls.find(friendNum);
+    if (!callPtr) {
         return;
     }
 
-    ToxFriendCall& call = *it->second;
+    ToxFriendCall& call = *callPtr;
+    call.accountReceivedAudioFrame();
 
     if (call.getMuteVol()) {
         return;
@@ -901,14 +976,18 @@ void CoreAV::audioFrameCallback(ToxAV*, uint32_t friendNum, const int16_t* pcm,
 
 void CoreAV::videoFrameCallback(ToxAV*, uint32_t friendNum, uint16_t w, uint16_t h,
                                 const uint8_t* y, const uint8_t* u, const uint8_t* v,
-                                int32_t ystride, int32_t ustride, int32_t vstride, void*)
+                                int32_t ystride, int32_t ustride, int32_t vstride, void* vSelf)
 {
-    auto it = calls.find(friendNum);
-    if (it == calls.end()) {
+    CoreAV* self = static_cast<CoreAV*>(vSelf);
+    QTOX_TRACE3(av_recv_video, friendNum, w, h);
+    ToxFriendCall* call = self->calls.find(friendNum);
+    if (!call) {
         return;
     }
 
-    CoreVideoSource* videoSource = it->second->getVideoSource();
+    call->accountReceivedVideoFrame();
+
+    CoreVideoSource* videoSource = call->getVideoSource();
     if (!videoSource) {
         return;
     }
@@ -22,6 +22,7 @@
 #define COREAV_H
 
 #include "src/core/toxcall.h"
+#include <QElapsedTimer>
 #include <QObject>
 #include <atomic>
 #include <memory>
@@ -84,8 +85,8 @@ public:
     void invalidateGroupCallPeerSource(int group, ToxPk peerPk);
 
 public slots:
-    bool startCall(uint32_t friendNum, bool video);
-    bool answerCall(uint32_t friendNum, bool video);
+    void startCall(uint32_t friendNum, bool video);
+    void answerCall(uint32_t friendNum, bool video);
     bool cancelCall(uint32_t friendNum);
     void timeoutCall(uint32_t friendNum);
     void start();
@@ -94,8 +95,16 @@ signals:
     void avInvite(uint32_t friendId, bool video);
     void avStart(uint32_t friendId, bool video);
     void avEnd(uint32_t friendId, bool error = false);
+    // a startCall/answerCall request queued earlier could not be carried
+    // out; the UI reverts whatever it showed in anticipation
+    void avCallFailed(uint32_t friendId);
+    // stats hook for the adaptive bitrate controller, in kbit/s
+    void videoBitrateChanged(uint32_t friendId, uint32_t bitrate);
+    // one sample of a call's live quality counters, emitted per second
+    void callStatsReady(uint32_t friendId, const CallStats& stats);
 
 private slots:
+    void wakeIteration();
     static void callCallback(ToxAV* toxAV, uint32_t friendNum, bool audio, bool video, void* self);
     static void stateCallback(ToxAV*, uint32_t friendNum, uint32_t state, void* self);
     static void bitrateCallback(ToxAV* toxAV, uint32_t friendNum, uint32_t arate, uint32_t vrate,
@@ -125,6 +134,10 @@ private:
 
 private:
     static constexpr uint32_t VIDEO_DEFAULT_BITRATE = 2500;
+    static constexpr int STATS_INTERVAL_MS = 1000;
+    // Iteration cadence while no call is up. We can't stop iterating outright,
+    // incoming call invites are only delivered from inside toxav_iterate().
+    static constexpr int IDLE_ITERATION_INTERVAL_MS = 500;
 
 private:
     // atomic because potentially accessed by different threads
@@ -133,10 +146,14 @@ private:
     std::unique_ptr<QThread> coreavThread;
     QTimer* iterateTimer = nullptr;
     using ToxFriendCallPtr = std::unique_ptr<ToxFriendCall>;
-    static std::map<uint32_t, ToxFriendCallPtr> calls;
     using ToxGroupCallPtr = std::unique_ptr<ToxGroupCall>;
-    static std::map<int, ToxGroupCallPtr> groupCalls;
+    // Per-instance so several cores can coexist in one process; indexed flat
+    // by the toxcore friend/conference number, probed on every frame callback
+    CallSlotTable<uint32_t, ToxFriendCallPtr> calls;
+    CallSlotTable<int, ToxGroupCallPtr> groupCalls;
     std::atomic_flag threadSwitchLock;
+    // paces callStatsReady emissions from process()
+    QElapsedTimer statsTimer;
 };
 
 #endif // COREAV_H
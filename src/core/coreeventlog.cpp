@@ -0,0 +1,336 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "coreeventlog.h"
+
+#include "core.h"
+#include "corefile.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QTimer>
+
+/**
+ * @file coreeventlog.cpp
+ *
+ * Log format, all fields big-endian via QDataStream:
+ *   quint32 magic, quint16 version, qint64 capture start (unix ms), then per
+ *   event: quint8 type, qint64 offset from session start in ms, followed by
+ *   the type's arguments. Versioned so the format can grow fields; a replayer
+ *   refuses logs with a version it doesn't know.
+ */
+
+namespace {
+constexpr quint32 LOG_MAGIC = 0x51544556; // "QTEV"
+constexpr quint16 LOG_VERSION = 1;
+
+enum EventType : quint8
+{
+    FriendMessage = 0,
+    GroupMessage = 1,
+    FriendStatus = 2,
+    FriendStatusMessage = 3,
+    FriendTyping = 4,
+    FileTransferProgress = 5,
+};
+} // namespace
+
+/**
+ * @brief Attaches a recorder to the core when QTOX_EVENT_RECORD names a file.
+ *
+ * The recorder is parented to the core so it stops with the session.
+ */
+void CoreEventRecorder::install(Core& core)
+{
+    const QByteArray path = qgetenv("QTOX_EVENT_RECORD");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    new CoreEventRecorder(core, QString::fromLocal8Bit(path));
+}
+
+CoreEventRecorder::CoreEventRecorder(Core& core, const QString& path)
+    : QObject(&core)
+{
+    logFile.setFileName(path);
+    if (!logFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Event recorder: failed to open" << path << ", not recording";
+        return;
+    }
+
+    stream.setDevice(&logFile);
+    stream << LOG_MAGIC << LOG_VERSION << QDateTime::currentMSecsSinceEpoch();
+    sessionClock.start();
+
+    // Direct connections, so events are logged with their emission-time
+    // ordering and timing rather than after an event loop round trip
+    connect(&core, &Core::friendMessageReceived, this, &CoreEventRecorder::onFriendMessage,
+            Qt::DirectConnection);
+    connect(&core, &Core::groupMessageReceived, this, &CoreEventRecorder::onGroupMessage,
+            Qt::DirectConnection);
+    connect(&core, &Core::friendStatusChanged, this, &CoreEventRecorder::onFriendStatusChanged,
+            Qt::DirectConnection);
+    connect(&core, &Core::friendStatusMessageChanged, this,
+            &CoreEventRecorder::onFriendStatusMessageChanged, Qt::DirectConnection);
+    connect(&core, &Core::friendTypingChanged, this, &CoreEventRecorder::onFriendTypingChanged,
+            Qt::DirectConnection);
+    connect(core.getCoreFile(), &CoreFile::fileTransferInfo, this,
+            &CoreEventRecorder::onFileTransferInfo, Qt::DirectConnection);
+
+    qDebug() << "Event recorder: capturing core events to" << path;
+}
+
+/**
+ * @brief Writes the per-event header and returns the stream for the arguments.
+ * @note Callers must hold writeLock across the whole event write.
+ */
+QDataStream& CoreEventRecorder::beginEvent(quint8 type)
+{
+    stream << type << static_cast<qint64>(sessionClock.elapsed());
+    return stream;
+}
+
+void CoreEventRecorder::onFriendMessage(uint32_t friendId, const QString& message, bool isAction)
+{
+    QMutexLocker locker{&writeLock};
+    if (!logFile.isOpen()) {
+        return;
+    }
+    beginEvent(FriendMessage) << static_cast<quint32>(friendId) << message
+                              << static_cast<quint8>(isAction);
+}
+
+void CoreEventRecorder::onGroupMessage(int groupId, int peerId, const QString& message, bool isAction)
+{
+    QMutexLocker locker{&writeLock};
+    if (!logFile.isOpen()) {
+        return;
+    }
+    beginEvent(GroupMessage) << static_cast<quint32>(groupId) << static_cast<qint32>(peerId)
+                             << message << static_cast<quint8>(isAction);
+}
+
+void CoreEventRecorder::onFriendStatusChanged(uint32_t friendId, Status::Status status)
+{
+    QMutexLocker locker{&writeLock};
+    if (!logFile.isOpen()) {
+        return;
+    }
+    beginEvent(FriendStatus) << static_cast<quint32>(friendId) << static_cast<quint8>(status);
+}
+
+void CoreEventRecorder::onFriendStatusMessageChanged(uint32_t friendId, const QString& message)
+{
+    QMutexLocker locker{&writeLock};
+    if (!logFile.isOpen()) {
+        return;
+    }
+    beginEvent(FriendStatusMessage) << static_cast<quint32>(friendId) << message;
+}
+
+void CoreEventRecorder::onFriendTypingChanged(uint32_t friendId, bool isTyping)
+{
+    QMutexLocker locker{&writeLock};
+    if (!logFile.isOpen()) {
+        return;
+    }
+    beginEvent(FriendTyping) << static_cast<quint32>(friendId) << static_cast<quint8>(isTyping);
+}
+
+void CoreEventRecorder::onFileTransferInfo(ToxFile file)
+{
+    QMutexLocker locker{&writeLock};
+    if (!logFile.isOpen()) {
+        return;
+    }
+    beginEvent(FileTransferProgress)
+        << static_cast<quint32>(file.friendId) << static_cast<qint32>(file.fileNum) << file.fileName
+        << static_cast<quint8>(file.status) << static_cast<quint8>(file.direction)
+        << static_cast<quint64>(file.bytesSent) << static_cast<quint64>(file.filesize);
+}
+
+/**
+ * @brief Attaches a replay driver when QTOX_EVENT_REPLAY names a recorded log.
+ *
+ * QTOX_EVENT_REPLAY_SPEED scales the recorded timing; unset or 1 replays in
+ * real time, 0 fires all events back to back.
+ */
+void CoreEventReplayer::install(Core& core)
+{
+    const QByteArray path = qgetenv("QTOX_EVENT_REPLAY");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    double speed = 1.0;
+    const QByteArray speedVar = qgetenv("QTOX_EVENT_REPLAY_SPEED");
+    if (!speedVar.isEmpty()) {
+        bool ok = false;
+        const double parsed = speedVar.toDouble(&ok);
+        if (ok && parsed >= 0.0) {
+            speed = parsed;
+        } else {
+            qWarning() << "Event replay: invalid QTOX_EVENT_REPLAY_SPEED" << speedVar
+                       << ", using 1";
+        }
+    }
+
+    new CoreEventReplayer(core, QString::fromLocal8Bit(path), speed);
+}
+
+CoreEventReplayer::CoreEventReplayer(Core& core, const QString& path, double speed)
+    : QObject(&core)
+    , core(core)
+    , fireTimer(new QTimer(this))
+    , speed(speed)
+{
+    logFile.setFileName(path);
+    if (!logFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "Event replay: failed to open" << path << ", not replaying";
+        return;
+    }
+
+    stream.setDevice(&logFile);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64 captureStart = 0;
+    stream >> magic >> version >> captureStart;
+    if (magic != LOG_MAGIC || version != LOG_VERSION) {
+        qWarning() << "Event replay:" << path << "is not a version" << LOG_VERSION << "event log";
+        logFile.close();
+        return;
+    }
+
+    fireTimer->setSingleShot(true);
+    fireTimer->setTimerType(Qt::PreciseTimer);
+    connect(fireTimer, &QTimer::timeout, this, &CoreEventReplayer::fireEvent);
+
+    // Wait for the session to come up before driving load into it, so the
+    // GUI-side consumers of these signals exist
+    connect(&core, &Core::avReady, this, [this]() {
+        qDebug() << "Event replay: starting, speed" << this->speed;
+        replayClock.start();
+        if (readNextEvent()) {
+            scheduleNextEvent();
+        }
+    });
+}
+
+/**
+ * @brief Decodes the next event from the log into the pending fields.
+ * @return False when the log is exhausted or malformed.
+ */
+bool CoreEventReplayer::readNextEvent()
+{
+    if (stream.atEnd()) {
+        qDebug() << "Event replay: finished," << replayedEvents << "events replayed in"
+                 << replayClock.elapsed() << "ms";
+        logFile.close();
+        return false;
+    }
+
+    stream >> pendingType >> pendingAtMs;
+
+    switch (pendingType) {
+    case FriendMessage:
+        stream >> pendingIdA >> pendingText >> pendingFlag;
+        break;
+    case GroupMessage:
+        stream >> pendingIdA >> pendingIdB >> pendingText >> pendingFlag;
+        break;
+    case FriendStatus:
+        stream >> pendingIdA >> pendingFlag;
+        break;
+    case FriendStatusMessage:
+        stream >> pendingIdA >> pendingText;
+        break;
+    case FriendTyping:
+        stream >> pendingIdA >> pendingFlag;
+        break;
+    case FileTransferProgress:
+        stream >> pendingIdA >> pendingIdB >> pendingText >> pendingFlag >> pendingFlag2
+            >> pendingBytes >> pendingSize;
+        break;
+    default:
+        qWarning() << "Event replay: unknown event type" << pendingType << ", stopping";
+        logFile.close();
+        return false;
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "Event replay: truncated log, stopping after" << replayedEvents << "events";
+        logFile.close();
+        return false;
+    }
+
+    return true;
+}
+
+void CoreEventReplayer::scheduleNextEvent()
+{
+    const qint64 dueMs = speed > 0.0 ? static_cast<qint64>(pendingAtMs / speed) : 0;
+    const qint64 delayMs = dueMs - replayClock.elapsed();
+    fireTimer->start(static_cast<int>(qMax<qint64>(delayMs, 0)));
+}
+
+/**
+ * @brief Re-emits the pending event through the live signal paths.
+ */
+void CoreEventReplayer::fireEvent()
+{
+    switch (pendingType) {
+    case FriendMessage:
+        emit core.friendMessageReceived(pendingIdA, pendingText, pendingFlag != 0);
+        break;
+    case GroupMessage:
+        emit core.groupMessageReceived(static_cast<int>(pendingIdA), pendingIdB, pendingText,
+                                       pendingFlag != 0);
+        break;
+    case FriendStatus:
+        emit core.friendStatusChanged(pendingIdA, static_cast<Status::Status>(pendingFlag));
+        break;
+    case FriendStatusMessage:
+        emit core.friendStatusMessageChanged(pendingIdA, pendingText);
+        break;
+    case FriendTyping:
+        emit core.friendTypingChanged(pendingIdA, pendingFlag != 0);
+        break;
+    case FileTransferProgress: {
+        ToxFile file;
+        file.fileKind = 0;
+        file.fileNum = static_cast<uint32_t>(pendingIdB);
+        file.friendId = pendingIdA;
+        file.fileName = pendingText;
+        file.bytesSent = pendingBytes;
+        file.filesize = pendingSize;
+        file.status = static_cast<ToxFile::FileStatus>(pendingFlag);
+        file.direction = static_cast<ToxFile::FileDirection>(pendingFlag2 != 0);
+        emit core.getCoreFile()->fileTransferInfo(file);
+        break;
+    }
+    default:
+        break;
+    }
+
+    ++replayedEvents;
+    if (readNextEvent()) {
+        scheduleNextEvent();
+    }
+}
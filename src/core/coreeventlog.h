@@ -0,0 +1,118 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COREEVENTLOG_H
+#define COREEVENTLOG_H
+
+#include "src/core/toxfile.h"
+#include "src/model/status.h"
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+
+class Core;
+class QTimer;
+
+/**
+ * @brief Records the timestamped toxcore event stream entering Core.
+ *
+ * Enabled with QTOX_EVENT_RECORD=<file>. Taps the Core and CoreFile signals
+ * fed by the toxcore callbacks (messages, status flaps, file transfer
+ * progress) and appends each event with its offset from session start to a
+ * compact binary log, so a field-reported load pattern can be captured and
+ * shipped alongside a bug report.
+ */
+class CoreEventRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    static void install(Core& core);
+
+private:
+    CoreEventRecorder(Core& core, const QString& path);
+
+private slots:
+    void onFriendMessage(uint32_t friendId, const QString& message, bool isAction);
+    void onGroupMessage(int groupId, int peerId, const QString& message, bool isAction);
+    void onFriendStatusChanged(uint32_t friendId, Status::Status status);
+    void onFriendStatusMessageChanged(uint32_t friendId, const QString& message);
+    void onFriendTypingChanged(uint32_t friendId, bool isTyping);
+    void onFileTransferInfo(ToxFile file);
+
+private:
+    QDataStream& beginEvent(quint8 type);
+
+    QFile logFile;
+    QDataStream stream;
+    QElapsedTimer sessionClock;
+    // the tapped signals fire from the core thread and the GUI thread
+    QMutex writeLock;
+};
+
+/**
+ * @brief Replays a recorded event log through the live Core signal paths.
+ *
+ * Enabled with QTOX_EVENT_REPLAY=<file>; QTOX_EVENT_REPLAY_SPEED scales the
+ * recorded timing (2 replays twice as fast, 0 fires everything back to back).
+ * Events are re-emitted through the same Core and CoreFile signals the
+ * original toxcore callbacks fed, so the dispatcher, history and UI layers
+ * see a deterministic reproduction of the recorded load for profiling.
+ */
+class CoreEventReplayer : public QObject
+{
+    Q_OBJECT
+public:
+    static void install(Core& core);
+
+private:
+    CoreEventReplayer(Core& core, const QString& path, double speed);
+
+    bool readNextEvent();
+    void scheduleNextEvent();
+
+private slots:
+    void fireEvent();
+
+private:
+    Core& core;
+    QFile logFile;
+    QDataStream stream;
+    QTimer* fireTimer;
+    QElapsedTimer replayClock;
+    double speed;
+
+    // The next decoded event, pending until its due time. The fields are a
+    // union of what the event types carry; each type uses the ones it needs.
+    quint8 pendingType = 0;
+    qint64 pendingAtMs = 0;
+    quint32 pendingIdA = 0;
+    qint32 pendingIdB = 0;
+    QString pendingText;
+    quint8 pendingFlag = 0;
+    quint8 pendingFlag2 = 0;
+    quint64 pendingBytes = 0;
+    quint64 pendingSize = 0;
+
+    quint64 replayedEvents = 0;
+};
+
+#endif // COREEVENTLOG_H
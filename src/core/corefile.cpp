@@ -22,13 +22,16 @@
 #include "core.h"
 #include "toxfile.h"
 #include "toxstring.h"
+#include "icoresettings.h"
 #include "src/persistence/settings.h"
 #include "src/model/status.h"
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QMutexLocker>
 #include <QRegularExpression>
 #include <QThread>
+#include <QTimer>
 #include <cassert>
 #include <memory>
 
@@ -37,21 +40,92 @@
  * @brief Manages the file transfer service of toxcore
  */
 
-CoreFilePtr CoreFile::makeCoreFile(Core *core, Tox *tox, QMutex &coreLoopLock)
+namespace {
+// Sleep at most 1000ms if we have no FT, 10 for user FTs
+// There is no real difference between 10ms sleep and 50ms sleep when it
+// comes to CPU usage – just keep the CPU usage low when there are no file
+// transfers, and speed things up when there is an ongoing file transfer.
+constexpr unsigned fileInterval = 10, idleInterval = 1000;
+}
+
+CoreFilePtr CoreFile::makeCoreFile(Core *core, Tox *tox, QMutex &coreLoopLock,
+                                   const ICoreSettings *settings)
 {
     assert(core != nullptr);
     assert(tox != nullptr);
+    assert(settings != nullptr);
     connectCallbacks(*tox);
-    CoreFilePtr result = CoreFilePtr{new CoreFile{tox, coreLoopLock}};
+    CoreFilePtr result = CoreFilePtr{new CoreFile{core, tox, coreLoopLock, settings}};
     connect(core, &Core::friendStatusChanged, result.get(), &CoreFile::onConnectionStatusChanged);
+    result->startIterationThread();
 
     return result;
 }
 
-CoreFile::CoreFile(Tox *core, QMutex &coreLoopLock)
-    : tox{core}
+CoreFile::CoreFile(Core *core, Tox *tox, QMutex &coreLoopLock, const ICoreSettings *settings)
+    : core{core}
+    , tox{tox}
     , coreLoopLock{&coreLoopLock}
+    , settings{settings}
+{
+    budgetTimer.start();
+}
+
+CoreFile::~CoreFile()
+{
+    if (iterationThread) {
+        iterationThread->exit(0);
+        iterationThread->wait();
+    }
+}
+
+/**
+ * @brief Moves file-transfer pumping onto its own thread.
+ *
+ * While a transfer is transmitting, that thread calls tox_iterate() at the
+ * fast file cadence, serialized against Core's loop by the core lock, so
+ * bulk transfers can run hot without raising the wakeup frequency of the
+ * messaging loop itself.
+ */
+void CoreFile::startIterationThread()
+{
+    iterationThread = std::unique_ptr<QThread>(new QThread{});
+    iterationThread->setObjectName(QStringLiteral("qTox CoreFile"));
+
+    iterationTimer = new QTimer{this};
+    iterationTimer->setSingleShot(true);
+    iterationTimer->setInterval(idleInterval);
+    connect(iterationTimer, &QTimer::timeout, this, &CoreFile::onFileIterationTimeout);
+    connect(iterationThread.get(), &QThread::started, iterationTimer,
+            [this] { iterationTimer->start(); });
+    connect(iterationThread.get(), &QThread::finished, iterationTimer, &QTimer::stop);
+
+    // the timer slot and the status-change slot now both run on the file
+    // thread; every CoreFile entry point already takes the core lock, so the
+    // discipline stays the same as for direct calls from the GUI
+    moveToThread(iterationThread.get());
+    iterationThread->start();
+}
+
+void CoreFile::onFileIterationTimeout()
 {
+    unsigned interval;
+
+    {
+        QMutexLocker ml{coreLoopLock};
+
+        interval = corefileIterationInterval();
+
+        // only pump toxcore from here while a transfer actually needs the
+        // fast cadence; when idle, iteration is left to Core::process()
+        if (interval == fileInterval) {
+            tox_iterate(tox, core);
+        }
+
+        serviceChunkRequests();
+    }
+
+    iterationTimer->start(interval);
 }
 
 /**
@@ -62,14 +136,6 @@ CoreFile::CoreFile(Tox *core, QMutex &coreLoopLock)
  */
 unsigned CoreFile::corefileIterationInterval()
 {
-    /*
-       Sleep at most 1000ms if we have no FT, 10 for user FTs
-       There is no real difference between 10ms sleep and 50ms sleep when it
-       comes to CPU usage – just keep the CPU usage low when there are no file
-       transfers, and speed things up when there is an ongoing file transfer.
-    */
-    constexpr unsigned fileInterval = 10, idleInterval = 1000;
-
     for (ToxFile& file : fileMap) {
         if (file.status == ToxFile::TRANSMITTING) {
             return fileInterval;
@@ -78,6 +144,24 @@ unsigned CoreFile::corefileIterationInterval()
     return idleInterval;
 }
 
+/**
+ * @brief Whether any user-visible (non-avatar) transfer is transmitting.
+ *
+ * Used by background traffic like avatar broadcasts to yield the link to
+ * transfers the user actually started.
+ */
+bool CoreFile::hasActiveUserTransfers()
+{
+    QMutexLocker{coreLoopLock};
+
+    for (ToxFile& file : fileMap) {
+        if (file.status == ToxFile::TRANSMITTING && file.fileKind != TOX_FILE_KIND_AVATAR) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void CoreFile::connectCallbacks(Tox &tox)
 {
     // be careful not to to reconnect already used callbacks here
@@ -87,7 +171,14 @@ void CoreFile::connectCallbacks(Tox &tox)
     tox_callback_file_recv_control(&tox, CoreFile::onFileControlCallback);
 }
 
-void CoreFile::sendAvatarFile(uint32_t friendId, const QByteArray& data)
+/**
+ * @brief Offers our avatar to a friend, identified by its precomputed digest.
+ *
+ * The caller provides the hash so broadcasting one avatar to hundreds of
+ * friends does not re-run the cryptographic hash on the core thread per
+ * friend.
+ */
+void CoreFile::sendAvatarFile(uint32_t friendId, const QByteArray& data, const QByteArray& dataHash)
 {
     QMutexLocker{coreLoopLock};
 
@@ -97,11 +188,10 @@ void CoreFile::sendAvatarFile(uint32_t friendId, const QByteArray& data)
     size_t nameLength = 0;
     if (!data.isEmpty()) {
         static_assert(TOX_HASH_LENGTH <= TOX_FILE_ID_LENGTH, "TOX_HASH_LENGTH > TOX_FILE_ID_LENGTH!");
-        uint8_t avatarHash[TOX_HASH_LENGTH];
-        tox_hash(avatarHash, (uint8_t*)data.data(), data.size());
+        assert(dataHash.size() == TOX_HASH_LENGTH);
         filesize = data.size();
-        file_id = avatarHash;
-        file_name = avatarHash;
+        file_id = (uint8_t*)dataHash.data();
+        file_name = (uint8_t*)dataHash.data();
         nameLength = TOX_HASH_LENGTH;
     }
     Tox_Err_File_Send error;
@@ -189,6 +279,9 @@ void CoreFile::pauseResumeFile(uint32_t friendId, uint32_t fileId)
 
     if (file->pauseStatus.paused()) {
         file->status = ToxFile::PAUSED;
+        if (file->direction == ToxFile::RECEIVING) {
+            file->flushWriteBuffer();
+        }
         emit fileTransferPaused(*file);
     } else {
         file->status = ToxFile::TRANSMITTING;
@@ -250,7 +343,8 @@ void CoreFile::rejectFileRecvRequest(uint32_t friendId, uint32_t fileId)
     removeFile(friendId, fileId);
 }
 
-void CoreFile::acceptFileRecvRequest(uint32_t friendId, uint32_t fileId, QString path)
+void CoreFile::acceptFileRecvRequest(uint32_t friendId, uint32_t fileId, QString path,
+                                     uint64_t startPos)
 {
     QMutexLocker{coreLoopLock};
 
@@ -264,6 +358,21 @@ void CoreFile::acceptFileRecvRequest(uint32_t friendId, uint32_t fileId, QString
         qWarning() << "acceptFileRecvRequest: Unable to open file";
         return;
     }
+    file->preallocate();
+    if (startPos > 0 && static_cast<quint64>(file->file->size()) >= startPos
+        && startPos < file->filesize) {
+        // resume-at-offset: ask the sender to skip the region we already
+        // hold on disk; the file hash will only cover the resumed suffix
+        TOX_ERR_FILE_SEEK seekErr;
+        tox_file_seek(tox, friendId, fileId, startPos, &seekErr);
+        if (seekErr == TOX_ERR_FILE_SEEK_OK) {
+            file->file->seek(startPos);
+            file->bytesSent = startPos;
+        } else {
+            qWarning() << "acceptFileRecvRequest: Seek to resume offset failed, restarting transfer";
+            file->file->seek(0);
+        }
+    }
     file->status = ToxFile::TRANSMITTING;
     emit fileTransferAccepted(*file);
     tox_file_control(tox, file->friendId, file->fileNum, TOX_FILE_CONTROL_RESUME, nullptr);
@@ -301,6 +410,9 @@ void CoreFile::removeFile(uint32_t friendId, uint32_t fileId)
         qWarning() << "removeFile: No such file in queue";
         return;
     }
+    dropQueuedRequests(friendId, fileId);
+    fileMap[key].flushWriteBuffer();
+    fileMap[key].unmapWindow();
     fileMap[key].file->close();
     fileMap.remove(key);
 }
@@ -412,6 +524,9 @@ void CoreFile::onFileControlCallback(Tox*, uint32_t friendId, uint32_t fileId,
         qDebug() << "onFileControlCallback: Received pause for file " << friendId << ":" << fileId;
         file->pauseStatus.remotePause();
         file->status = ToxFile::PAUSED;
+        if (file->direction == ToxFile::RECEIVING) {
+            file->flushWriteBuffer();
+        }
         emit coreFile->fileTransferRemotePausedUnpaused(*file, true);
     } else if (control == TOX_FILE_CONTROL_RESUME) {
         if (file->direction == ToxFile::SENDING && file->fileKind == TOX_FILE_KIND_AVATAR)
@@ -449,34 +564,173 @@ void CoreFile::onFileDataCallback(Tox* tox, uint32_t friendId, uint32_t fileId,
         return;
     }
 
-    std::unique_ptr<uint8_t[]> data(new uint8_t[length]);
-    int64_t nread;
-
     if (file->fileKind == TOX_FILE_KIND_AVATAR) {
+        // Avatars are tiny and gate the peer's avatar exchange, so they are
+        // served straight from the callback instead of going through the
+        // bulk scheduler
+        std::unique_ptr<uint8_t[]> data(new uint8_t[length]);
         QByteArray chunk = file->avatarData.mid(pos, length);
-        nread = chunk.size();
+        int64_t nread = chunk.size();
         memcpy(data.get(), chunk.data(), nread);
-    } else {
-        file->file->seek(pos);
-        nread = file->file->read((char*)data.get(), length);
-        if (nread <= 0) {
-            qWarning("onFileDataCallback: Failed to read from file");
-            file->status = ToxFile::CANCELED;
-            emit coreFile->fileTransferCancelled(*file);
-            tox_file_send_chunk(tox, friendId, fileId, pos, nullptr, 0, nullptr);
-            coreFile->removeFile(friendId, fileId);
+        if (!tox_file_send_chunk(tox, friendId, fileId, pos, data.get(), nread, nullptr)) {
+            qWarning("onFileDataCallback: Failed to send data chunk");
+        }
+        return;
+    }
+
+    // Bulk data is deferred to the scheduler, which serves friends
+    // round-robin under the configured bandwidth ceiling so one peer's
+    // transfers can't starve everyone else's
+    coreFile->queueChunkRequest(friendId, fileId, pos, length);
+}
+
+void CoreFile::queueChunkRequest(uint32_t friendId, uint32_t fileId, uint64_t pos, size_t length)
+{
+    if (!pendingChunkRequests.contains(friendId)) {
+        chunkRequestOrder.append(friendId);
+    }
+    pendingChunkRequests[friendId].enqueue({friendId, fileId, pos, length});
+}
+
+/**
+ * @brief Serves deferred chunk requests fairly across friends.
+ *
+ * Runs on every file iteration tick, under the core lock. Friends are
+ * visited round-robin, one chunk per friend per pass, so a friend pushing
+ * five large files gets the same share of the link as one sending a single
+ * file. The configured ceiling is enforced with a token bucket whose burst
+ * is capped at a quarter second of budget.
+ */
+void CoreFile::serviceChunkRequests()
+{
+    if (chunkRequestOrder.isEmpty()) {
+        return;
+    }
+
+    const quint64 bytesPerSec = quint64{settings->getMaxFileTransferBandwidth()} * 1024;
+    const qint64 elapsedMs = budgetTimer.restart();
+    if (bytesPerSec != 0) {
+        // never cap the burst below a chunk or tiny ceilings would stall
+        const quint64 maxBurst = qMax(bytesPerSec / 4, quint64{16 * 1024});
+        bandwidthBudget = qMin(bandwidthBudget + bytesPerSec * elapsedMs / 1000, maxBurst);
+    }
+
+    while (!chunkRequestOrder.isEmpty()) {
+        bool sentAny = false;
+        for (int i = 0; i < chunkRequestOrder.size();) {
+            QQueue<PendingChunkRequest>& queue = pendingChunkRequests[chunkRequestOrder[i]];
+            const PendingChunkRequest request = queue.head();
+
+            if (bytesPerSec != 0 && request.length > bandwidthBudget) {
+                // out of budget until the next refill
+                return;
+            }
+            if (!sendQueuedChunk(request)) {
+                // toxcore's send queue is full, retry on the next tick
+                return;
+            }
+            if (bytesPerSec != 0) {
+                bandwidthBudget -= request.length;
+            }
+
+            queue.dequeue();
+            sentAny = true;
+            if (queue.isEmpty()) {
+                pendingChunkRequests.remove(chunkRequestOrder[i]);
+                chunkRequestOrder.removeAt(i);
+            } else {
+                ++i;
+            }
+        }
+        if (!sentAny) {
             return;
         }
-        file->bytesSent += length;
-        file->hashGenerator->addData((const char*)data.get(), length);
+    }
+}
+
+/**
+ * @brief Sends one deferred chunk.
+ * @return False only if toxcore's send queue is full and the request should
+ * be retried; true when the request is consumed, successfully or not.
+ */
+bool CoreFile::sendQueuedChunk(const PendingChunkRequest& request)
+{
+    ToxFile* file = findFile(request.friendId, request.fileId);
+    if (!file) {
+        // the transfer was cancelled or finished since the request was queued
+        return true;
+    }
+    if (file->status != ToxFile::TRANSMITTING) {
+        // paused or broken since the request was queued; toxcore re-requests
+        // outstanding chunks once the transfer resumes
+        return true;
+    }
+
+    TOX_ERR_FILE_SEND_CHUNK error;
+
+    // Zero-copy fast path: hand toxcore a pointer straight into the mapped
+    // file instead of seeking and reading into a staging buffer
+    const uint8_t* mapped = file->mappedChunk(request.pos, request.length);
+    if (mapped) {
+        if (!tox_file_send_chunk(tox, request.friendId, request.fileId, request.pos, mapped,
+                                 request.length, &error)) {
+            if (error == TOX_ERR_FILE_SEND_CHUNK_SENDQ) {
+                return false;
+            }
+            qWarning("sendQueuedChunk: Failed to send data chunk");
+            return true;
+        }
+        file->bytesSent += request.length;
+        file->hashGenerator->addData((const char*)mapped, request.length);
+        emit fileTransferInfo(*file);
+        return true;
+    }
+
+    std::unique_ptr<uint8_t[]> data(new uint8_t[request.length]);
+    file->file->seek(request.pos);
+    int64_t nread = file->file->read((char*)data.get(), request.length);
+    if (nread <= 0) {
+        qWarning("sendQueuedChunk: Failed to read from file");
+        file->status = ToxFile::CANCELED;
+        emit fileTransferCancelled(*file);
+        tox_file_send_chunk(tox, request.friendId, request.fileId, request.pos, nullptr, 0, nullptr);
+        removeFile(request.friendId, request.fileId);
+        return true;
     }
 
-    if (!tox_file_send_chunk(tox, friendId, fileId, pos, data.get(), nread, nullptr)) {
-        qWarning("onFileDataCallback: Failed to send data chunk");
+    if (!tox_file_send_chunk(tox, request.friendId, request.fileId, request.pos, data.get(), nread,
+                             &error)) {
+        if (error == TOX_ERR_FILE_SEND_CHUNK_SENDQ) {
+            return false;
+        }
+        qWarning("sendQueuedChunk: Failed to send data chunk");
+        return true;
+    }
+    file->bytesSent += request.length;
+    file->hashGenerator->addData((const char*)data.get(), request.length);
+    emit fileTransferInfo(*file);
+    return true;
+}
+
+/**
+ * @brief Forgets queued chunk requests of a transfer that is going away.
+ */
+void CoreFile::dropQueuedRequests(uint32_t friendId, uint32_t fileId)
+{
+    auto it = pendingChunkRequests.find(friendId);
+    if (it == pendingChunkRequests.end()) {
         return;
     }
-    if (file->fileKind != TOX_FILE_KIND_AVATAR) {
-        emit coreFile->fileTransferInfo(*file);
+
+    QQueue<PendingChunkRequest>& queue = *it;
+    for (int i = queue.size() - 1; i >= 0; --i) {
+        if (queue[i].fileId == fileId) {
+            queue.removeAt(i);
+        }
+    }
+    if (queue.isEmpty()) {
+        pendingChunkRequests.erase(it);
+        chunkRequestOrder.removeAll(friendId);
     }
 }
 
@@ -513,6 +767,8 @@ void CoreFile::onFileRecvChunkCallback(Tox* tox, uint32_t friendId, uint32_t fil
                 emit core->friendAvatarChanged(core->getFriendPublicKey(friendId), file->avatarData);
             }
         } else {
+            // hand the finished signals a fully written file
+            file->flushWriteBuffer();
             emit coreFile->fileTransferFinished(*file);
             emit coreFile->fileDownloadFinished(file->filePath);
         }
@@ -523,7 +779,7 @@ void CoreFile::onFileRecvChunkCallback(Tox* tox, uint32_t friendId, uint32_t fil
     if (file->fileKind == TOX_FILE_KIND_AVATAR) {
         file->avatarData.append((char*)data, length);
     } else {
-        file->file->write((char*)data, length);
+        file->bufferWrite((const char*)data, length);
     }
     file->bytesSent += length;
     file->hashGenerator->addData((const char*)data, length);
@@ -548,6 +804,9 @@ void CoreFile::onConnectionStatusChanged(uint32_t friendId, Status::Status state
         if (key >> 32 != friendId)
             continue;
         fileMap[key].status = status;
+        if (isOffline && fileMap[key].direction == ToxFile::RECEIVING) {
+            fileMap[key].flushWriteBuffer();
+        }
         emit fileTransferBrokenUnbroken(fileMap[key], isOffline);
     }
 }
@@ -28,9 +28,12 @@
 #include "src/core/toxpk.h"
 #include "src/model/status.h"
 
+#include <QElapsedTimer>
 #include <QHash>
+#include <QList>
 #include <QMutex>
 #include <QObject>
+#include <QQueue>
 #include <QString>
 
 #include <cstddef>
@@ -39,28 +42,35 @@
 
 struct Tox;
 class CoreFile;
+class ICoreSettings;
 
 using CoreFilePtr = std::unique_ptr<CoreFile>;
 
+class QThread;
+class QTimer;
+
 class CoreFile : public QObject
 {
     Q_OBJECT
 
 public:
     void handleAvatarOffer(uint32_t friendId, uint32_t fileId, bool accept);
-    static CoreFilePtr makeCoreFile(Core* core, Tox* tox, QMutex& coreLoopLock);
+    static CoreFilePtr makeCoreFile(Core* core, Tox* tox, QMutex& coreLoopLock,
+                                    const ICoreSettings* settings);
 
     void sendFile(uint32_t friendId, QString filename, QString filePath,
                          long long filesize);
-    void sendAvatarFile(uint32_t friendId, const QByteArray& data);
+    void sendAvatarFile(uint32_t friendId, const QByteArray& data, const QByteArray& dataHash);
     void pauseResumeFile(uint32_t friendId, uint32_t fileId);
     void cancelFileSend(uint32_t friendId, uint32_t fileId);
 
     void cancelFileRecv(uint32_t friendId, uint32_t fileId);
     void rejectFileRecvRequest(uint32_t friendId, uint32_t fileId);
-    void acceptFileRecvRequest(uint32_t friendId, uint32_t fileId, QString path);
+    void acceptFileRecvRequest(uint32_t friendId, uint32_t fileId, QString path,
+                               uint64_t startPos = 0);
 
     unsigned corefileIterationInterval();
+    bool hasActiveUserTransfers();
 
 signals:
     void fileSendStarted(ToxFile file);
@@ -77,8 +87,30 @@ signals:
     void fileNameChanged(const ToxPk& friendPk);
     void fileSendFailed(uint32_t friendId, const QString& fname);
 
+public:
+    ~CoreFile();
+
 private:
-    CoreFile(Tox* core, QMutex& coreLoopLock);
+    CoreFile(Core* core, Tox* tox, QMutex& coreLoopLock, const ICoreSettings* settings);
+
+    // re-emits recorded events through our signals, see coreeventlog.h
+    friend class CoreEventReplayer;
+
+    // a chunk request toxcore issued that we deferred instead of serving
+    // straight from the callback
+    struct PendingChunkRequest
+    {
+        uint32_t friendId;
+        uint32_t fileId;
+        uint64_t pos;
+        size_t length;
+    };
+
+    void startIterationThread();
+    void queueChunkRequest(uint32_t friendId, uint32_t fileId, uint64_t pos, size_t length);
+    void serviceChunkRequests();
+    bool sendQueuedChunk(const PendingChunkRequest& request);
+    void dropQueuedRequests(uint32_t friendId, uint32_t fileId);
 
     ToxFile* findFile(uint32_t friendId, uint32_t fileId);
     void addFile(uint32_t friendId, uint32_t fileId, const ToxFile& file);
@@ -103,11 +135,26 @@ private:
 
 private slots:
     void onConnectionStatusChanged(uint32_t friendId, Status::Status state);
+    void onFileIterationTimeout();
 
 private:
     QHash<uint64_t, ToxFile> fileMap;
+    Core* core;
     Tox* tox;
     QMutex* coreLoopLock = nullptr;
+    const ICoreSettings* settings = nullptr;
+
+    // bulk chunk requests wait here and are served round-robin per friend
+    // under the configured bandwidth ceiling; avatars bypass the queues
+    QHash<uint32_t, QQueue<PendingChunkRequest>> pendingChunkRequests;
+    QList<uint32_t> chunkRequestOrder;
+    quint64 bandwidthBudget = 0;
+    QElapsedTimer budgetTimer;
+
+    // file transfers are pumped from their own thread so their fast iteration
+    // cadence never dictates how often Core's messaging loop wakes up
+    std::unique_ptr<QThread> iterationThread;
+    QTimer* iterationTimer = nullptr;
 };
 
 #endif // COREFILE_H
@@ -0,0 +1,152 @@
+/*
+    Copyright © 2020 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "coretimingstats.h"
+
+/**
+ * @class CoreTimingStats
+ * @brief Always-on timing histograms for the core thread's hot path.
+ *
+ * When the core thread gets sluggish in the field we can't attach a profiler,
+ * so each toxcore callback and every Core::process() iteration records its
+ * duration here. Recording is a couple of atomic increments into fixed
+ * power-of-two buckets; the cost is negligible next to tox_iterate itself.
+ * snapshot() renders the histograms for log dumps or a future debug view.
+ */
+
+namespace {
+// bucket n counts durations in [2^n, 2^(n+1)) microseconds; the top bucket
+// is open-ended, so anything from ~32ms upwards lands there and sticks out
+constexpr int bucketCount = 16;
+
+struct Histogram
+{
+    std::atomic<quint64> buckets[bucketCount];
+    std::atomic<quint64> totalNsecs;
+    std::atomic<quint64> count;
+};
+
+Histogram histograms[CoreTimingStats::MetricCount];
+
+const char* metricName(CoreTimingStats::Metric metric)
+{
+    switch (metric) {
+    case CoreTimingStats::ProcessIteration:
+        return "process";
+    case CoreTimingStats::ToxIterate:
+        return "tox_iterate";
+    case CoreTimingStats::FriendRequestCb:
+        return "friend_request";
+    case CoreTimingStats::FriendMessageCb:
+        return "friend_message";
+    case CoreTimingStats::FriendNameCb:
+        return "friend_name";
+    case CoreTimingStats::FriendTypingCb:
+        return "friend_typing";
+    case CoreTimingStats::StatusMessageCb:
+        return "status_message";
+    case CoreTimingStats::UserStatusCb:
+        return "user_status";
+    case CoreTimingStats::ConnectionStatusCb:
+        return "connection_status";
+    case CoreTimingStats::ReadReceiptCb:
+        return "read_receipt";
+    case CoreTimingStats::GroupInviteCb:
+        return "group_invite";
+    case CoreTimingStats::GroupMessageCb:
+        return "group_message";
+    case CoreTimingStats::GroupPeerListCb:
+        return "group_peer_list";
+    case CoreTimingStats::GroupPeerNameCb:
+        return "group_peer_name";
+    case CoreTimingStats::GroupTitleCb:
+        return "group_title";
+    default:
+        return "unknown";
+    }
+}
+} // namespace
+
+/**
+ * @brief Adds one measured duration to a metric's histogram.
+ * @param metric Which histogram to record into.
+ * @param nsecs Duration in nanoseconds, as QElapsedTimer::nsecsElapsed() returns.
+ *
+ * Safe to call from any thread; callbacks fire on both the Core and CoreFile
+ * iteration threads.
+ */
+void CoreTimingStats::record(Metric metric, qint64 nsecs)
+{
+    const quint64 usecs = static_cast<quint64>(nsecs < 0 ? 0 : nsecs) / 1000;
+    int bucket = 0;
+    while (bucket < bucketCount - 1 && (usecs >> (bucket + 1)) != 0) {
+        ++bucket;
+    }
+
+    Histogram& h = histograms[metric];
+    h.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    h.totalNsecs.fetch_add(static_cast<quint64>(nsecs), std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Renders every non-empty histogram as one line per metric.
+ * @return Lines of the form "name: n=…, avg=…us, buckets=[…]".
+ *
+ * The snapshot is not atomic across metrics, which is fine for a diagnostic
+ * dump; individual counters are read consistently.
+ */
+QStringList CoreTimingStats::snapshot()
+{
+    QStringList lines;
+    for (int m = 0; m < MetricCount; ++m) {
+        const Histogram& h = histograms[m];
+        const quint64 count = h.count.load(std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+
+        QStringList bucketCounts;
+        for (int b = 0; b < bucketCount; ++b) {
+            bucketCounts.append(
+                QString::number(h.buckets[b].load(std::memory_order_relaxed)));
+        }
+        const quint64 avgUsecs = h.totalNsecs.load(std::memory_order_relaxed) / count / 1000;
+        lines.append(QString("%1: n=%2, avg=%3us, buckets=[%4]")
+                         .arg(metricName(static_cast<Metric>(m)))
+                         .arg(count)
+                         .arg(avgUsecs)
+                         .arg(bucketCounts.join(',')));
+    }
+    return lines;
+}
+
+/**
+ * @brief Clears all histograms, e.g. after a dump.
+ */
+void CoreTimingStats::reset()
+{
+    for (Histogram& h : histograms) {
+        for (std::atomic<quint64>& bucket : h.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        h.totalNsecs.store(0, std::memory_order_relaxed);
+        h.count.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,80 @@
+/*
+    Copyright © 2020 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CORETIMINGSTATS_H
+#define CORETIMINGSTATS_H
+
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include <atomic>
+
+class CoreTimingStats
+{
+public:
+    enum Metric
+    {
+        ProcessIteration,
+        ToxIterate,
+        FriendRequestCb,
+        FriendMessageCb,
+        FriendNameCb,
+        FriendTypingCb,
+        StatusMessageCb,
+        UserStatusCb,
+        ConnectionStatusCb,
+        ReadReceiptCb,
+        GroupInviteCb,
+        GroupMessageCb,
+        GroupPeerListCb,
+        GroupPeerNameCb,
+        GroupTitleCb,
+        MetricCount
+    };
+
+    CoreTimingStats() = delete;
+
+    static void record(Metric metric, qint64 nsecs);
+    static QStringList snapshot();
+    static void reset();
+};
+
+/**
+ * @brief Records the lifetime of a scope into a CoreTimingStats histogram.
+ */
+class CoreTimingProbe
+{
+public:
+    explicit CoreTimingProbe(CoreTimingStats::Metric metric)
+        : metric{metric}
+    {
+        timer.start();
+    }
+
+    ~CoreTimingProbe()
+    {
+        CoreTimingStats::record(metric, timer.nsecsElapsed());
+    }
+
+private:
+    CoreTimingStats::Metric metric;
+    QElapsedTimer timer;
+};
+
+#endif // CORETIMINGSTATS_H
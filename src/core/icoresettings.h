@@ -26,6 +26,8 @@
 #include <QNetworkProxy>
 #include <QString>
 
+#include <cstdint>
+
 class ICoreSettings {
 public:
     enum class ProxyType
@@ -56,12 +58,17 @@ public:
 
     virtual QNetworkProxy getProxy() const = 0;
 
+    // global file transfer ceiling in KiB/s, 0 means unlimited
+    virtual uint32_t getMaxFileTransferBandwidth() const = 0;
+    virtual void setMaxFileTransferBandwidth(uint32_t kibPerSec) = 0;
+
     DECLARE_SIGNAL(enableIPv6Changed, bool enabled);
     DECLARE_SIGNAL(forceTCPChanged, bool enabled);
     DECLARE_SIGNAL(enableLanDiscoveryChanged, bool enabled);
     DECLARE_SIGNAL(proxyTypeChanged, ICoreSettings::ProxyType type);
     DECLARE_SIGNAL(proxyAddressChanged, const QString& address);
     DECLARE_SIGNAL(proxyPortChanged, quint16 port);
+    DECLARE_SIGNAL(maxFileTransferBandwidthChanged, uint32_t kibPerSec);
 };
 
 #endif // I_CORE_SETTINGS_H
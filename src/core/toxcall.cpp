@@ -23,9 +23,12 @@
 #include "src/persistence/settings.h"
 #include "src/video/camerasource.h"
 #include "src/video/corevideosource.h"
+#include <QThread>
 #include <QTimer>
 #include <QtConcurrent/QtConcurrent>
 
+#include <algorithm>
+
 /**
  * @var uint32_t ToxCall::callId
  * @brief Could be a friendNum or groupNum, must uniquely identify the call. Do not modify!
@@ -162,6 +165,164 @@ ToxFriendCall::ToxFriendCall(uint32_t FriendNum, bool VideoEnabled, CoreAV& av,
     }
 }
 
+/**
+ * @brief Accounts the cost of preparing and submitting one outgoing video frame.
+ * @param nsecs Time spent converting the frame and inside toxav_video_send_frame.
+ *
+ * toxav only accepts raw YUV420 input for its internal VP8 encoder, so the
+ * only way to shed encoder load is to feed it fewer pixels. When the average
+ * per-frame cost over the accounting window blows the real-time budget, the
+ * send divisor doubles (halving each dimension, quartering the pixel count);
+ * once there is ample headroom it steps back up. The running figures are
+ * logged per call so the effect can be quantified from the field.
+ */
+void ToxFriendCall::accountVideoEncode(qint64 nsecs)
+{
+    // check roughly every four seconds of 30fps video
+    constexpr quint32 accountingWindowFrames = 120;
+    // well under the 33ms a 30fps stream allows, leaving room for capture
+    // and conversion on the same cores
+    constexpr quint64 encodeBudgetNs = 20 * 1000 * 1000;
+
+    encodeTimeNs += static_cast<quint64>(nsecs);
+    ++encodedFrames;
+    windowTimeNs += static_cast<quint64>(nsecs);
+    ++windowFrames;
+
+    if (windowFrames < accountingWindowFrames) {
+        return;
+    }
+
+    const quint64 avgNs = windowTimeNs / windowFrames;
+    if (avgNs > encodeBudgetNs && videoSendDivisor < 4) {
+        videoSendDivisor *= 2;
+        qDebug() << "Call" << friendId << "video encode over budget, downscaling input by"
+                 << videoSendDivisor;
+    } else if (avgNs < encodeBudgetNs / 6 && videoSendDivisor > 1) {
+        videoSendDivisor /= 2;
+        qDebug() << "Call" << friendId << "video encode has headroom, downscale divisor now"
+                 << videoSendDivisor;
+    }
+
+    qDebug() << "Call" << friendId << "avg video encode" << avgNs / 1000 << "us over the last"
+             << windowFrames << "frames," << encodedFrames << "total, divisor"
+             << videoSendDivisor;
+
+    windowTimeNs = 0;
+    windowFrames = 0;
+}
+
+int ToxFriendCall::getVideoSendDivisor() const
+{
+    return videoSendDivisor;
+}
+
+/**
+ * @brief Sets the current outgoing video bitrate, which also becomes the ceiling.
+ * @param bitrate the bitrate the call was set up with, in kbit/s, or 0 when
+ * not sending video.
+ */
+void ToxFriendCall::setVideoBitrate(uint32_t bitrate)
+{
+    videoBitrate = bitrate;
+    videoBitrateCeiling = bitrate;
+    bitrateRaiseStreak = 0;
+}
+
+uint32_t ToxFriendCall::getVideoBitrate() const
+{
+    return videoBitrate;
+}
+
+/**
+ * @brief Feeds one of toxav's bitrate recommendations into the call's controller.
+ * @param recommended the bitrate toxav suggests based on the loss and RTT it
+ * measures on the link, in kbit/s.
+ * @return the new bitrate to apply, or 0 to keep the current one.
+ *
+ * Drops are applied immediately, since they mean the link is congested right
+ * now. Raises only happen after several consecutive recommendations above the
+ * current rate, and then only halfway towards them, so one good moment on a
+ * flaky link doesn't bounce the quality up just to stutter again; the rate
+ * never exceeds what the call was set up with.
+ */
+uint32_t ToxFriendCall::onRecommendedVideoBitrate(uint32_t recommended)
+{
+    // below this, VP8 produces nothing watchable; better to hold the rate
+    // and let the encoder drop frames
+    constexpr uint32_t minVideoBitrate = 32;
+    // recommendations arrive roughly once a second under load
+    constexpr uint32_t raiseStreakLength = 5;
+
+    if (videoBitrate == 0) {
+        // not sending video, nothing to control
+        return 0;
+    }
+
+    if (recommended < videoBitrate) {
+        bitrateRaiseStreak = 0;
+        videoBitrate = qMax(recommended, minVideoBitrate);
+        return videoBitrate;
+    }
+
+    if (recommended > videoBitrate && videoBitrate < videoBitrateCeiling) {
+        if (++bitrateRaiseStreak < raiseStreakLength) {
+            return 0;
+        }
+
+        bitrateRaiseStreak = 0;
+        videoBitrate = qMin((videoBitrate + recommended) / 2, videoBitrateCeiling);
+        return videoBitrate;
+    }
+
+    bitrateRaiseStreak = 0;
+    return 0;
+}
+
+void ToxFriendCall::accountSentAudioFrame()
+{
+    sentAudioFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ToxFriendCall::accountSentVideoFrame()
+{
+    sentVideoFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ToxFriendCall::accountReceivedAudioFrame()
+{
+    receivedAudioFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ToxFriendCall::accountReceivedVideoFrame()
+{
+    receivedVideoFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Takes one stats sample and resets the interval counters.
+ * @return the counters accumulated since the previous sample, together with
+ * the controller and sink state at this moment.
+ */
+CallStats ToxFriendCall::sampleStats()
+{
+    CallStats stats;
+    stats.sentAudioFrames = sentAudioFrames.exchange(0, std::memory_order_relaxed);
+    stats.sentVideoFrames = sentVideoFrames.exchange(0, std::memory_order_relaxed);
+    stats.receivedAudioFrames = receivedAudioFrames.exchange(0, std::memory_order_relaxed);
+    stats.receivedVideoFrames = receivedVideoFrames.exchange(0, std::memory_order_relaxed);
+    stats.videoBitrateKbit = videoBitrate;
+    stats.videoSendDivisor = videoSendDivisor;
+    if (encodedFrames > 0) {
+        stats.avgVideoEncodeMs = encodeTimeNs / (encodedFrames * 1e6);
+    }
+    if (sink) {
+        stats.jitterTargetDepth = sink->getJitterTargetDepth();
+        stats.audioUnderruns = sink->getJitterUnderruns();
+    }
+    return stats;
+}
+
 ToxFriendCall::~ToxFriendCall()
 {
     QObject::disconnect(audioSinkInvalid);
@@ -248,10 +409,18 @@ ToxGroupCall::ToxGroupCall(int GroupNum, CoreAV& av, IAudioControl& audio)
 
     audioSrcInvalid = QObject::connect(audioSource.get(), &IAudioSource::invalidated,
                                        [this]() { this->onAudioSourceInvalidated(); });
+
+    dispatcher = std::unique_ptr<GroupAudioDispatcher>(new GroupAudioDispatcher(*this));
+    playbackThread = std::unique_ptr<QThread>(new QThread());
+    playbackThread->setObjectName("qTox Group Playback");
+    dispatcher->moveToThread(playbackThread.get());
+    playbackThread->start();
 }
 
 ToxGroupCall::~ToxGroupCall()
 {
+    playbackThread->exit();
+    playbackThread->wait();
     // disconnect all Qt connections
     clearPeers();
 }
@@ -281,6 +450,8 @@ void ToxGroupCall::onAudioSinkInvalidated(ToxPk peerId)
 
 void ToxGroupCall::removePeer(ToxPk peerId)
 {
+    QMutexLocker locker{&peersLock};
+
     const auto& source = peers.find(peerId);
     if (source == peers.cend()) {
         qDebug() << "Peer:" << peerId.toString() << "does not have a source, can't remove";
@@ -294,6 +465,8 @@ void ToxGroupCall::removePeer(ToxPk peerId)
 
 void ToxGroupCall::addPeer(ToxPk peerId)
 {
+    QMutexLocker locker{&peersLock};
+
     std::unique_ptr<IAudioSink> newSink = audio.makeSink();
     QMetaObject::Connection con =
         QObject::connect(newSink.get(), &IAudioSink::invalidated,
@@ -305,12 +478,16 @@ void ToxGroupCall::addPeer(ToxPk peerId)
 
 bool ToxGroupCall::havePeer(ToxPk peerId)
 {
+    QMutexLocker locker{&peersLock};
+
     const auto& source = peers.find(peerId);
     return source != peers.cend();
 }
 
 void ToxGroupCall::clearPeers()
 {
+    QMutexLocker locker{&peersLock};
+
     peers.clear();
     for (auto con : sinkInvalid) {
         QObject::disconnect(con.second);
@@ -319,14 +496,80 @@ void ToxGroupCall::clearPeers()
     sinkInvalid.clear();
 }
 
+/**
+ * @brief Hands one peer's decoded audio to the playback worker.
+ *
+ * Called from the toxav callback thread. The frame is copied into the ring
+ * and the worker is woken with a queued invocation, so the callback never
+ * waits on the audio device lock no matter how many peers are speaking.
+ */
 void ToxGroupCall::playAudioBuffer(const ToxPk& peer, const int16_t* data, int samples,
                                    unsigned channels, int sampleRate)
 {
-    if (!havePeer(peer)) {
-        addPeer(peer);
+    if (samples <= 0 || samples > PeerAudioFrame::MAX_FRAME_SAMPLES || channels < 1
+        || channels > 2) {
+        return;
     }
-    const auto& source = peers.find(peer);
-    if (source->second) {
-        source->second->playAudioBuffer(data, samples, channels, sampleRate);
+
+    const uint32_t write = peerFrameWrite.load(std::memory_order_relaxed);
+    const uint32_t read = peerFrameRead.load(std::memory_order_acquire);
+    if (write - read >= PEER_FRAME_RING_SIZE) {
+        const quint64 dropped = droppedPeerFrames.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (dropped % 64 == 0) {
+            qDebug() << "Group" << groupId << "playback can't keep up," << dropped
+                     << "frames dropped";
+        }
+        return;
+    }
+
+    PeerAudioFrame& slot = peerFrameRing[write % PEER_FRAME_RING_SIZE];
+    slot.peer = peer;
+    std::copy(data, data + samples * channels, slot.pcm);
+    slot.samples = samples;
+    slot.channels = channels;
+    slot.sampleRate = sampleRate;
+    peerFrameWrite.store(write + 1, std::memory_order_release);
+
+    bool expected = false;
+    if (dispatchQueued.compare_exchange_strong(expected, true)) {
+        QMetaObject::invokeMethod(dispatcher.get(), "dispatchPeerFrames", Qt::QueuedConnection);
     }
 }
+
+/**
+ * @brief Drains the peer frame ring into the per-peer sinks.
+ *
+ * Runs on the playback worker thread via GroupAudioDispatcher. Frames are
+ * played straight out of their ring slot; the producer can't overwrite a
+ * slot until the read index has moved past it.
+ */
+void ToxGroupCall::playPendingPeerFrames()
+{
+    // clear before draining, so a frame arriving mid-drain queues us again
+    dispatchQueued.store(false, std::memory_order_relaxed);
+
+    uint32_t read = peerFrameRead.load(std::memory_order_relaxed);
+    while (read != peerFrameWrite.load(std::memory_order_acquire)) {
+        const PeerAudioFrame& frame = peerFrameRing[read % PEER_FRAME_RING_SIZE];
+
+        {
+            QMutexLocker locker{&peersLock};
+            if (!havePeer(frame.peer)) {
+                addPeer(frame.peer);
+            }
+            const auto& source = peers.find(frame.peer);
+            if (source->second) {
+                source->second->playAudioBuffer(frame.pcm, frame.samples, frame.channels,
+                                                frame.sampleRate);
+            }
+        }
+
+        ++read;
+        peerFrameRead.store(read, std::memory_order_release);
+    }
+}
+
+void GroupAudioDispatcher::dispatchPeerFrames()
+{
+    call.playPendingPeerFrames();
+}
@@ -28,15 +28,115 @@
 
 #include <QMap>
 #include <QMetaObject>
+#include <QMutex>
 #include <QtGlobal>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
+class QThread;
 class QTimer;
 class AudioFilterer;
 class CoreVideoSource;
 class CoreAV;
+class ToxGroupCall;
+
+/**
+ * @brief Flat call table indexed directly by the toxcore call number.
+ *
+ * Call counts are tiny, but the lookup runs in every audio and video frame
+ * callback, so the table is a plain slot vector: finding a call is a bounds
+ * check and two loads instead of a node-based map traversal. Friend and
+ * conference numbers are small dense indices, so the vector stays short and
+ * cache-resident.
+ */
+template <typename NumT, typename CallPtrT>
+class CallSlotTable
+{
+public:
+    typename CallPtrT::element_type* find(NumT num) const
+    {
+        const size_t idx = static_cast<size_t>(num);
+        if (idx >= slots.size()) {
+            return nullptr;
+        }
+        return slots[idx].get();
+    }
+
+    bool contains(NumT num) const
+    {
+        const size_t idx = static_cast<size_t>(num);
+        return idx < slots.size() && slots[idx] != nullptr;
+    }
+
+    /**
+     * @brief Takes ownership of the call unless the slot is already taken.
+     * @return True if the call was inserted.
+     */
+    bool insert(NumT num, CallPtrT call)
+    {
+        const size_t idx = static_cast<size_t>(num);
+        if (idx >= slots.size()) {
+            slots.resize(idx + 1);
+        }
+        if (slots[idx]) {
+            return false;
+        }
+        slots[idx] = std::move(call);
+        ++count;
+        return true;
+    }
+
+    void erase(NumT num)
+    {
+        const size_t idx = static_cast<size_t>(num);
+        if (idx < slots.size() && slots[idx]) {
+            slots[idx].reset();
+            --count;
+        }
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    template <typename F>
+    void forEach(F&& f)
+    {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (slots[i]) {
+                f(static_cast<NumT>(i), *slots[i]);
+            }
+        }
+    }
+
+private:
+    std::vector<CallPtrT> slots;
+    size_t count = 0;
+};
+
+/**
+ * @brief Drains a group call's pending peer audio on the playback worker
+ *        thread, so the toxav callback never waits on the audio device lock.
+ */
+class GroupAudioDispatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GroupAudioDispatcher(ToxGroupCall& call)
+        : call(call)
+    {}
+
+private slots:
+    void dispatchPeerFrames();
+
+private:
+    ToxGroupCall& call;
+};
 
 class ToxCall
 {
@@ -86,6 +186,25 @@ protected:
     QMetaObject::Connection audioSrcInvalid;
 };
 
+/**
+ * @brief One sample of a call's live quality counters.
+ *
+ * Frame counts are per stats interval, so with the one second interval
+ * CoreAV emits at they double as rates.
+ */
+struct CallStats
+{
+    quint32 sentAudioFrames = 0;
+    quint32 sentVideoFrames = 0;
+    quint32 receivedAudioFrames = 0;
+    quint32 receivedVideoFrames = 0;
+    quint32 videoBitrateKbit = 0;
+    int videoSendDivisor = 1;
+    double avgVideoEncodeMs = 0.0;
+    quint32 jitterTargetDepth = 0;
+    quint64 audioUnderruns = 0;
+};
+
 class ToxFriendCall : public ToxCall
 {
 public:
@@ -103,6 +222,19 @@ public:
 
     void playAudioBuffer(const int16_t* data, int samples, unsigned channels, int sampleRate) const;
 
+    void accountVideoEncode(qint64 nsecs);
+    int getVideoSendDivisor() const;
+
+    void setVideoBitrate(uint32_t bitrate);
+    uint32_t getVideoBitrate() const;
+    uint32_t onRecommendedVideoBitrate(uint32_t recommended);
+
+    void accountSentAudioFrame();
+    void accountSentVideoFrame();
+    void accountReceivedAudioFrame();
+    void accountReceivedVideoFrame();
+    CallStats sampleStats();
+
 protected:
     std::unique_ptr<QTimer> timeoutTimer;
 
@@ -116,6 +248,24 @@ private:
     static constexpr int CALL_TIMEOUT = 45000;
     std::unique_ptr<IAudioSink> sink = nullptr;
     uint32_t friendId;
+    // per-call CPU accounting for the outgoing video path; drives the
+    // adaptive downscale divisor CoreAV::sendCallVideo applies to its input
+    quint64 encodeTimeNs = 0;
+    quint64 encodedFrames = 0;
+    quint64 windowTimeNs = 0;
+    quint32 windowFrames = 0;
+    int videoSendDivisor = 1;
+    // adaptive bitrate state, fed by toxav's loss/RTT-based recommendations;
+    // the rate the call was set up with acts as the ceiling
+    uint32_t videoBitrate = 0;
+    uint32_t videoBitrateCeiling = 0;
+    uint32_t bitrateRaiseStreak = 0;
+    // interval counters for the live stats surface, reset on every sample;
+    // bumped from the audio, video and toxav callback threads
+    std::atomic<quint32> sentAudioFrames{0};
+    std::atomic<quint32> sentVideoFrames{0};
+    std::atomic<quint32> receivedAudioFrames{0};
+    std::atomic<quint32> receivedVideoFrames{0};
 };
 
 class ToxGroupCall : public ToxCall
@@ -136,13 +286,47 @@ private:
     void addPeer(ToxPk peerId);
     bool havePeer(ToxPk peerId);
     void clearPeers();
+    void playPendingPeerFrames();
 
     std::map<ToxPk, std::unique_ptr<IAudioSink>> peers;
     std::map<ToxPk, QMetaObject::Connection> sinkInvalid;
+    // guards peers and sinkInvalid, which the playback worker reads while
+    // the GUI thread may add or remove peers
+    QMutex peersLock{QMutex::Recursive};
     int groupId;
 
+    // One decoded frame from a single peer, in flight between the toxav
+    // callback thread and the playback worker.
+    struct PeerAudioFrame
+    {
+        // opus maximum of 120 ms at 48 kHz per channel, worst case stereo
+        static constexpr int MAX_FRAME_SAMPLES = 5760;
+        ToxPk peer;
+        int16_t pcm[MAX_FRAME_SAMPLES * 2];
+        int samples;
+        unsigned channels;
+        int sampleRate;
+    };
+    static constexpr uint32_t PEER_FRAME_RING_SIZE = 16;
+
+    // Wait-free SPSC ring between the toxav callback (producer) and the
+    // playback worker (consumer); sized for a burst of frames from every
+    // speaking peer in one network tick.
+    std::array<PeerAudioFrame, PEER_FRAME_RING_SIZE> peerFrameRing;
+    std::atomic<uint32_t> peerFrameWrite{0};
+    std::atomic<uint32_t> peerFrameRead{0};
+    std::atomic_bool dispatchQueued{false};
+    std::atomic<quint64> droppedPeerFrames{0};
+
+    std::unique_ptr<GroupAudioDispatcher> dispatcher;
+    std::unique_ptr<QThread> playbackThread;
+
     void onAudioSourceInvalidated();
     void onAudioSinkInvalidated(ToxPk peerId);
+
+    friend class GroupAudioDispatcher;
 };
 
+Q_DECLARE_METATYPE(CallStats);
+
 #endif // TOXCALL_H
@@ -22,8 +22,24 @@
 #include <QRegularExpression>
 #include <tox/tox.h>
 
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
 #define TOX_HEX_ID_LENGTH 2 * TOX_ADDRESS_SIZE
 
+namespace {
+// mapping the whole of a multi-gigabyte file would exhaust address space on
+// 32-bit builds, so the send path slides a window of this size instead
+constexpr quint64 mapWindowSize = 64 * 1024 * 1024;
+
+// received chunks are a kilobyte or so each; coalescing them into writes of
+// this size keeps network filesystems from fragmenting the target file
+constexpr int writeCoalesceSize = 1024 * 1024;
+constexpr int writeAlignment = 4096;
+}
+
 /**
  * @file corestructs.h
  * @brief Some headers use Core structs but don't need to include all of core.h
@@ -72,3 +88,111 @@ bool ToxFile::open(bool write)
 {
     return write ? file->open(QIODevice::ReadWrite) : file->open(QIODevice::ReadOnly);
 }
+
+/**
+ * @brief Returns a pointer to the requested chunk inside a mapped window of the file.
+ *
+ * Slides the window forward as the transfer progresses, so sequential sends
+ * touch the page cache directly instead of issuing a seek and read syscall
+ * per chunk. Returns nullptr if the chunk can't be mapped (e.g. a filesystem
+ * without mmap support); callers must then fall back to read().
+ */
+const uint8_t* ToxFile::mappedChunk(quint64 pos, size_t length)
+{
+    if (mapFailed) {
+        return nullptr;
+    }
+
+    if (!mappedWindow || pos < mappedOffset || pos + length > mappedOffset + mappedLength) {
+        unmapWindow();
+
+        const quint64 fileSize = file->size();
+        if (pos >= fileSize || fileSize - pos < length) {
+            return nullptr;
+        }
+
+        const quint64 windowLength = qMin(mapWindowSize, fileSize - pos);
+        mappedWindow = file->map(pos, windowLength);
+        if (!mappedWindow) {
+            // don't retry a map that the filesystem refuses once per chunk
+            mapFailed = true;
+            return nullptr;
+        }
+        mappedOffset = pos;
+        mappedLength = windowLength;
+#ifdef Q_OS_UNIX
+        // transfers walk the file front to back, so ask the kernel to read
+        // ahead aggressively and drop pages behind us
+        posix_madvise(mappedWindow, mappedLength, POSIX_MADV_SEQUENTIAL);
+        posix_madvise(mappedWindow, mappedLength, POSIX_MADV_WILLNEED);
+#endif
+    }
+
+    return mappedWindow + (pos - mappedOffset);
+}
+
+/**
+ * @brief Releases the current mapped window, if any.
+ */
+void ToxFile::unmapWindow()
+{
+    if (mappedWindow) {
+        file->unmap(mappedWindow);
+        mappedWindow = nullptr;
+        mappedOffset = 0;
+        mappedLength = 0;
+    }
+}
+
+/**
+ * @brief Reserves disk space for the advertised transfer size up front.
+ *
+ * Growing the file chunk by chunk lets the filesystem scatter its blocks;
+ * reserving the full size at accept time keeps the received file contiguous.
+ */
+void ToxFile::preallocate()
+{
+    if (!filesize) {
+        return;
+    }
+#ifdef Q_OS_UNIX
+    if (posix_fallocate(file->handle(), 0, filesize) == 0) {
+        return;
+    }
+#endif
+    // best effort: at least set the logical size so sparse-aware filesystems
+    // can place the file in one go
+    file->resize(filesize);
+    file->seek(0);
+}
+
+/**
+ * @brief Queues received data behind the coalescing buffer.
+ *
+ * The buffer is flushed in aligned blocks once it grows past the coalescing
+ * threshold; the unaligned tail stays buffered until the next flush point.
+ */
+void ToxFile::bufferWrite(const char* data, size_t length)
+{
+    writeBuffer.append(data, length);
+    if (writeBuffer.size() >= writeCoalesceSize) {
+        const int aligned = writeBuffer.size() & ~(writeAlignment - 1);
+        file->write(writeBuffer.constData(), aligned);
+        writeBuffer.remove(0, aligned);
+    }
+}
+
+/**
+ * @brief Writes out whatever the coalescing buffer still holds.
+ *
+ * Must be called before anyone else looks at the file on disk: on finish, on
+ * pause (so toxfilepause.h semantics still see consistent bytes), and before
+ * the transfer is removed.
+ */
+void ToxFile::flushWriteBuffer()
+{
+    if (!writeBuffer.isEmpty()) {
+        file->write(writeBuffer);
+        writeBuffer.clear();
+    }
+}
@@ -60,6 +60,11 @@ struct ToxFile
 
     void setFilePath(QString path);
     bool open(bool write);
+    const uint8_t* mappedChunk(quint64 pos, size_t length);
+    void unmapWindow();
+    void preallocate();
+    void bufferWrite(const char* data, size_t length);
+    void flushWriteBuffer();
 
     uint8_t fileKind;
     uint32_t fileNum;
@@ -75,6 +80,14 @@ struct ToxFile
     QByteArray resumeFileId;
     std::shared_ptr<QCryptographicHash> hashGenerator = std::make_shared<QCryptographicHash>(QCryptographicHash::Sha256);
     ToxFilePause pauseStatus;
+    // sliding mapped window over the sent file; owned by the fileMap entry,
+    // copies handed to signals must not touch it
+    uchar* mappedWindow = nullptr;
+    quint64 mappedOffset = 0;
+    quint64 mappedLength = 0;
+    bool mapFailed = false;
+    // received chunks are coalesced here and flushed in large aligned writes
+    QByteArray writeBuffer;
 };
 
 #endif // CORESTRUCTS_H
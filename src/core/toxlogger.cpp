@@ -26,9 +26,48 @@
 #include <QString>
 #include <QStringBuilder>
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+/**
+ * @namespace ToxLogger
+ *
+ * Toxcore invokes the log callback from inside tox_iterate, so anything slow
+ * here shows up directly in core thread timings. Messages are therefore
+ * copied into a bounded lock-free ring and formatted by a dedicated writer
+ * thread; when the ring fills up under a log storm, messages are dropped and
+ * counted rather than stalling the producer.
+ */
+
 namespace ToxLogger {
 namespace {
 
+constexpr size_t queueSize = 1024; // power of two, required by the masking below
+constexpr size_t queueMask = queueSize - 1;
+
+// entries are fixed-size so enqueueing never allocates
+struct LogEntry
+{
+    std::atomic<size_t> seq;
+    Tox_Log_Level level;
+    uint32_t line;
+    char file[64];
+    char func[64];
+    char message[256];
+};
+
+void copyBounded(char* dst, size_t dstSize, const char* src)
+{
+    if (!src) {
+        dst[0] = '\0';
+        return;
+    }
+    std::strncpy(dst, src, dstSize - 1);
+    dst[dstSize - 1] = '\0';
+}
+
 QByteArray cleanPath(const char *file)
 {
     // for privacy, make the path relative to the c-toxcore source directory
@@ -38,33 +77,154 @@ QByteArray cleanPath(const char *file)
     return cleanedPath;
 }
 
-}  // namespace
+bool traceEnabled()
+{
+    // trace volume is enormous, so it stays opt-in even though the
+    // asynchronous sink makes it cheap for the core thread
+    static const bool enabled = qEnvironmentVariableIsSet("QTOX_TOXCORE_TRACE");
+    return enabled;
+}
 
-/**
- * @brief Log message handler for toxcore log messages
- * @note See tox.h for the parameter definitions
- */
-void onLogMessage(Tox *tox, Tox_Log_Level level, const char *file, uint32_t line,
-                  const char *func, const char *message, void *user_data)
+void emitEntry(const LogEntry& entry)
 {
-    const QByteArray cleanedPath = cleanPath(file);
+    const QByteArray cleanedPath = cleanPath(entry.file);
 
-    switch (level) {
+    switch (entry.level) {
     case TOX_LOG_LEVEL_TRACE:
-        return; // trace level generates too much noise to enable by default
     case TOX_LOG_LEVEL_DEBUG:
-        QMessageLogger(cleanedPath.data(), line, func).debug() << message;
+        QMessageLogger(cleanedPath.data(), entry.line, entry.func).debug() << entry.message;
         break;
     case TOX_LOG_LEVEL_INFO:
-        QMessageLogger(cleanedPath.data(), line, func).info() << message;
+        QMessageLogger(cleanedPath.data(), entry.line, entry.func).info() << entry.message;
         break;
     case TOX_LOG_LEVEL_WARNING:
-        QMessageLogger(cleanedPath.data(), line, func).warning() << message;
+        QMessageLogger(cleanedPath.data(), entry.line, entry.func).warning() << entry.message;
         break;
     case TOX_LOG_LEVEL_ERROR:
-        QMessageLogger(cleanedPath.data(), line, func).critical() << message;
+        QMessageLogger(cleanedPath.data(), entry.line, entry.func).critical() << entry.message;
         break;
     }
 }
 
+/**
+ * @brief Bounded multi-producer single-consumer log queue with a writer thread.
+ *
+ * Producers claim a slot by CAS on the enqueue position and publish it by
+ * bumping the slot's sequence number; they never take a lock and never block.
+ * The writer thread drains the ring every few milliseconds and reports how
+ * many messages were dropped since its last pass.
+ */
+class LogSink
+{
+public:
+    LogSink()
+    {
+        for (size_t i = 0; i < queueSize; ++i) {
+            queue[i].seq.store(i, std::memory_order_relaxed);
+        }
+        writer = std::thread([this] { run(); });
+    }
+
+    ~LogSink()
+    {
+        running.store(false, std::memory_order_release);
+        writer.join();
+        drain(); // flush what was enqueued during shutdown
+    }
+
+    void enqueue(Tox_Log_Level level, const char* file, uint32_t line, const char* func,
+                 const char* message)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        LogEntry* cell;
+        while (true) {
+            cell = &queue[pos & queueMask];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                // ring full: dropping a line beats stalling tox_iterate
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->level = level;
+        cell->line = line;
+        copyBounded(cell->file, sizeof(cell->file), file);
+        copyBounded(cell->func, sizeof(cell->func), func);
+        copyBounded(cell->message, sizeof(cell->message), message);
+        cell->seq.store(pos + 1, std::memory_order_release);
+    }
+
+private:
+    void run()
+    {
+        while (running.load(std::memory_order_acquire)) {
+            drain();
+            std::this_thread::sleep_for(std::chrono::milliseconds(25));
+        }
+    }
+
+    void drain()
+    {
+        while (true) {
+            LogEntry& cell = queue[dequeuePos & queueMask];
+            const size_t seq = cell.seq.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(dequeuePos + 1) < 0) {
+                break; // empty
+            }
+            emitEntry(cell);
+            cell.seq.store(dequeuePos + queueSize, std::memory_order_release);
+            ++dequeuePos;
+        }
+
+        const uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+        if (droppedNow != droppedReported) {
+            qWarning() << "Dropped" << (droppedNow - droppedReported)
+                       << "toxcore log messages under load";
+            droppedReported = droppedNow;
+        }
+    }
+
+    LogEntry queue[queueSize];
+    std::atomic<size_t> enqueuePos{0};
+    size_t dequeuePos = 0;
+    std::atomic<uint64_t> dropped{0};
+    uint64_t droppedReported = 0;
+    std::atomic<bool> running{true};
+    std::thread writer;
+};
+
+LogSink& sink()
+{
+    static LogSink instance;
+    return instance;
+}
+
+}  // namespace
+
+/**
+ * @brief Log message handler for toxcore log messages
+ * @note See tox.h for the parameter definitions
+ *
+ * Hands the message to the asynchronous sink; formatting and output happen on
+ * the writer thread. Trace level is only forwarded when QTOX_TOXCORE_TRACE is
+ * set in the environment.
+ */
+void onLogMessage(Tox *tox, Tox_Log_Level level, const char *file, uint32_t line,
+                  const char *func, const char *message, void *user_data)
+{
+    if (level == TOX_LOG_LEVEL_TRACE && !traceEnabled()) {
+        return;
+    }
+
+    sink().enqueue(level, file, line, func, message);
+}
+
 }  // namespace ToxLogger
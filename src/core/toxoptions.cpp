@@ -65,6 +65,10 @@ ToxOptions::operator Tox_Options*()
  * @brief Initializes a ToxOptions instance
  * @param savedata Previously saved Tox data
  * @return ToxOptions instance initialized to create Tox instance
+ *
+ * @note tox_options_set_savedata_data stores a pointer, not a copy: savedata
+ * must stay alive and unmoved until tox_new has run. Profile relies on this
+ * to hand a memory-mapped save file to toxcore without intermediate copies.
  */
 std::unique_ptr<ToxOptions> ToxOptions::makeToxOptions(const QByteArray& savedata,
                                                        const ICoreSettings* s)
@@ -94,3 +94,61 @@ QByteArray ToxString::getBytes() const
 {
     return QByteArray(string);
 }
+
+/**
+ * @class ToxStringView
+ * @brief Non-owning view over text in the c-toxcore representation.
+ *
+ * Borrows the buffer handed to a toxcore callback instead of copying it into
+ * a QByteArray first; conversion happens only when the text actually crosses
+ * into Qt-owned storage via getQString() or getBytes(). The view must not
+ * outlive the buffer, so it is meant for use within a callback's scope.
+ */
+
+/**
+ * @brief Creates a view over the representation used by c-toxcore.
+ * @param text Pointer to the beginning of the text.
+ * @param length Number of bytes to read from the beginning.
+ */
+ToxStringView::ToxStringView(const uint8_t* text, size_t length)
+    : text(text)
+    , length(length)
+{
+    assert(length <= INT_MAX);
+}
+
+/**
+ * @brief Returns a pointer to the beginning of the viewed data.
+ * @return Pointer to the beginning of the viewed data.
+ */
+const uint8_t* ToxStringView::data() const
+{
+    return text;
+}
+
+/**
+ * @brief Get the number of bytes in the view.
+ * @return Number of bytes in the view.
+ */
+size_t ToxStringView::size() const
+{
+    return length;
+}
+
+/**
+ * @brief Converts the viewed UTF-8 text directly to a QString.
+ * @return Text of the view as QString, in Qt-owned storage.
+ */
+QString ToxStringView::getQString() const
+{
+    return QString::fromUtf8(reinterpret_cast<const char*>(text), length);
+}
+
+/**
+ * @brief Copies the viewed bytes into Qt-owned storage.
+ * @return Text of the view as QByteArray.
+ */
+QByteArray ToxStringView::getBytes() const
+{
+    return QByteArray(reinterpret_cast<const char*>(text), length);
+}
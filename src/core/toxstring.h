@@ -40,4 +40,19 @@ public:
 private:
     QByteArray string;
 };
+
+class ToxStringView
+{
+public:
+    ToxStringView(const uint8_t* text, size_t length);
+
+    const uint8_t* data() const;
+    size_t size() const;
+    QString getQString() const;
+    QByteArray getBytes() const;
+
+private:
+    const uint8_t* text;
+    size_t length;
+};
 #endif // TOXSTRING_H
@@ -21,6 +21,7 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QThread>
+#include <QVector>
 #include <ctime>
 #include <random>
 #include <unistd.h>
@@ -59,7 +60,8 @@ IPC::IPC(uint32_t profileId)
     std::uniform_int_distribution<uint64_t> distribution;
     globalId = distribution(randEngine);
     qDebug() << "Our global IPC ID is " << globalId;
-    if (globalMemory.create(sizeof(IPCMemory))) {
+    const bool createdMemory = globalMemory.create(sizeof(IPCMemory));
+    if (createdMemory) {
         if (globalMemory.lock()) {
             IPCMemory* mem = global();
             memset(mem, 0, sizeof(IPCMemory));
@@ -77,16 +79,50 @@ IPC::IPC(uint32_t profileId)
         return; // We won't be able to do any IPC without being attached, let's get outta here
     }
 
+    // Senders release the semaphore after posting, so events are handled the
+    // moment they exist instead of up to a poll period later; the timer only
+    // remains as a slow fallback for garbage collection and for taking over
+    // ownership from a crashed instance. The semaphore is per-instance, keyed
+    // by our random globalId: a single shared one would hand a sender's (or
+    // our destructor's) wake-up token to whichever instance's waiter got
+    // there first. Create resets the count, ids are never reused.
+    eventSemaphore.reset(
+        new QSystemSemaphore(eventSemaphoreName(globalId), 0, QSystemSemaphore::Create));
+    eventWaitThread = std::thread([this] {
+        while (eventSemaphore->acquire()) {
+            if (stopEventWait) {
+                break;
+            }
+            QMetaObject::invokeMethod(this, "processEvents", Qt::QueuedConnection);
+        }
+    });
+
     processEvents();
 }
 
 IPC::~IPC()
 {
+    if (eventWaitThread.joinable()) {
+        stopEventWait = true;
+        // our own semaphore, so this token can only reach our waiter thread
+        eventSemaphore->release();
+        eventWaitThread.join();
+    }
+
     if (!globalMemory.lock()) {
         qWarning() << "Failed to lock in ~IPC";
         return;
     }
 
+    IPCMemory* mem = global();
+    if (mem) {
+        for (IPCInstance& entry : mem->instances) {
+            if (entry.instanceId == globalId) {
+                entry.instanceId = 0;
+                entry.lastSeen = 0;
+            }
+        }
+    }
     if (isCurrentOwnerNoLock()) {
         global()->globalId = 0;
     }
@@ -136,7 +172,25 @@ time_t IPC::postEvent(const QString& name, const QByteArray& data, uint32_t dest
         qDebug() << "postEvent " << name << "to" << dest;
     }
 
+    QVector<uint64_t> listeners;
+    for (const IPCInstance& entry : mem->instances) {
+        if (entry.instanceId && entry.instanceId != globalId) {
+            listeners += entry.instanceId;
+        }
+    }
+
     globalMemory.unlock();
+
+    if (result != 0) {
+        // wake every attached instance right away; fetchEvent() on the
+        // receiving side decides whether the event concerns it, so nobody
+        // can steal the wake-up meant for the actual destination
+        for (const uint64_t listener : listeners) {
+            QSystemSemaphore peerSemaphore(eventSemaphoreName(listener), 0,
+                                           QSystemSemaphore::Open);
+            peerSemaphore.release();
+        }
+    }
     return result;
 }
 
@@ -194,7 +248,9 @@ bool IPC::waitUntilAccepted(time_t postTime, int32_t timeout /*=-1*/)
         }
 
         qApp->processEvents();
-        QThread::msleep(0);
+        // the receiver is woken by the semaphore, acceptance only takes a
+        // few milliseconds; no need to spin at full speed while we wait
+        QThread::msleep(10);
     }
     return result;
 }
@@ -258,6 +314,7 @@ void IPC::processEvents()
     }
 
     IPCMemory* mem = global();
+    touchInstanceTableNoLock(mem);
 
     if (mem->globalId == globalId) {
         // We're the owner, let's process those events
@@ -303,6 +360,48 @@ void IPC::processEvents()
     timer.start();
 }
 
+/**
+ * @brief Keeps our entry in the shared instance table fresh.
+ * @note Only called when global memory IS LOCKED.
+ *
+ * Registers this instance on first call, refreshes its lastSeen afterwards
+ * and reclaims entries whose owner stopped refreshing (crashed or killed).
+ * Senders walk this table to know which per-instance semaphores to release.
+ */
+void IPC::touchInstanceTableNoLock(IPCMemory* mem)
+{
+    const time_t now = time(nullptr);
+    IPCInstance* self = nullptr;
+    IPCInstance* freeSlot = nullptr;
+    for (IPCInstance& entry : mem->instances) {
+        if (entry.instanceId == globalId) {
+            self = &entry;
+        } else if (entry.instanceId && difftime(now, entry.lastSeen) > INSTANCE_TIMEOUT_S) {
+            entry.instanceId = 0;
+            entry.lastSeen = 0;
+        }
+        if (!entry.instanceId && !freeSlot) {
+            freeSlot = &entry;
+        }
+    }
+
+    if (!self) {
+        self = freeSlot;
+    }
+    if (self) {
+        self->instanceId = globalId;
+        self->lastSeen = now;
+    } else {
+        // with the table full we'd only be woken by the fallback timer
+        qWarning() << "IPC instance table is full, relying on polling";
+    }
+}
+
+QString IPC::eventSemaphoreName(uint64_t instanceId)
+{
+    return QStringLiteral("qtox-" IPC_PROTOCOL_VERSION "-event-%1").arg(instanceId, 0, 16);
+}
+
 /**
  * @brief Only called when global memory IS LOCKED.
  * @return true if owner, false if not owner or if error
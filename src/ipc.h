@@ -24,23 +24,31 @@
 #include <QMap>
 #include <QObject>
 #include <QSharedMemory>
+#include <QSystemSemaphore>
 #include <QTimer>
+#include <atomic>
 #include <ctime>
 #include <functional>
+#include <memory>
+#include <thread>
 
 using IPCEventHandler = std::function<bool(const QByteArray&)>;
 
-#define IPC_PROTOCOL_VERSION "2"
+#define IPC_PROTOCOL_VERSION "3"
 
 class IPC : public QObject
 {
     Q_OBJECT
 
 protected:
-    static const int EVENT_TIMER_MS = 1000;
+    // slow fallback only; posted events wake us through the semaphore
+    static const int EVENT_TIMER_MS = 5000;
     static const int EVENT_GC_TIMEOUT = 5;
     static const int EVENT_QUEUE_SIZE = 32;
     static const int OWNERSHIP_TIMEOUT_S = 5;
+    static const int INSTANCE_TABLE_SIZE = 8;
+    // three missed fallback ticks and an instance entry counts as crashed
+    static const int INSTANCE_TIMEOUT_S = 15;
 
 public:
     IPC(uint32_t profileId);
@@ -59,11 +67,21 @@ public:
         bool global;
     };
 
+    // One attached instance, so senders know whose semaphores to release.
+    // lastSeen is refreshed every processEvents() tick; entries that stop
+    // refreshing belonged to a crashed instance and get reclaimed.
+    struct IPCInstance
+    {
+        uint64_t instanceId;
+        time_t lastSeen;
+    };
+
     struct IPCMemory
     {
         uint64_t globalId;
         time_t lastEvent;
         time_t lastProcessed;
+        IPCInstance instances[IPC::INSTANCE_TABLE_SIZE];
         IPCEvent events[IPC::EVENT_QUEUE_SIZE];
     };
 
@@ -77,18 +95,28 @@ public:
 public slots:
     void setProfileId(uint32_t profileId);
 
+private slots:
+    void processEvents();
+
 private:
     IPCMemory* global();
     bool runEventHandler(IPCEventHandler handler, const QByteArray& arg);
     IPCEvent* fetchEvent();
-    void processEvents();
     bool isCurrentOwnerNoLock();
+    void touchInstanceTableNoLock(IPCMemory* mem);
+    static QString eventSemaphoreName(uint64_t instanceId);
 
 private:
     QTimer timer;
     uint64_t globalId;
     uint32_t profileId;
     QSharedMemory globalMemory;
+    // this instance's own wake-up semaphore, keyed by globalId; senders
+    // release one token on every attached instance's semaphore, so a wake
+    // can never be consumed by the wrong instance's waiter thread
+    std::unique_ptr<QSystemSemaphore> eventSemaphore;
+    std::thread eventWaitThread;
+    std::atomic_bool stopEventWait{false};
     QMap<QString, IPCEventHandler> eventHandlers;
 };
 
@@ -24,8 +24,11 @@
 #include "src/persistence/profile.h"
 #include "src/persistence/settings.h"
 #include "src/persistence/toxsave.h"
+#include "src/util/startupprofiler.h"
+#include "src/util/workerpool.h"
 #include "src/video/camerasource.h"
 #include "src/widget/loginscreen.h"
+#include "src/widget/tool/stallwatchdog.h"
 #include "src/widget/translator.h"
 #include "widget/widget.h"
 #include <QApplication>
@@ -41,6 +44,7 @@
 #include <ctime>
 #include <sodium.h>
 #include <stdio.h>
+#include <string.h>
 
 #if defined(Q_OS_OSX)
 #include "platform/install_osx.h"
@@ -161,6 +165,15 @@ int main(int argc, char* argv[])
 
     qInstallMessageHandler(logMessageHandler);
 
+    // Scan the raw arguments so the phases that run before QCommandLineParser
+    // (fonts, settings, translation) are covered too
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--profile-startup") == 0) {
+            StartupProfiler::enable();
+            break;
+        }
+    }
+
     // initialize random number generator
     qsrand(time(nullptr));
 
@@ -180,12 +193,21 @@ int main(int argc, char* argv[])
 #endif
     a->setApplicationVersion("\nGit commit: " + QString(GIT_VERSION));
 
+    // Watch the GUI thread for event-loop stalls from the start, so freezes
+    // during login and profile load are caught too
+    StallWatchdog::getInstance();
+
+    // Size the shared worker pool before any subsystem schedules onto it
+    WorkerPool::init();
+
     // Install Unicode 6.1 supporting font
     // Keep this as close to the beginning of `main()` as possible, otherwise
     // on systems that have poor support for Unicode qTox will look bad.
+    StartupProfiler::startPhase("fonts");
     if (QFontDatabase::addApplicationFont("://font/DejaVuSans.ttf") == -1) {
         qWarning() << "Couldn't load font";
     }
+    StartupProfiler::endPhase("fonts");
 
 
 #if defined(Q_OS_OSX)
@@ -195,9 +217,13 @@ int main(int argc, char* argv[])
 #endif
 
     qsrand(time(nullptr));
+    StartupProfiler::startPhase("settings");
     Settings& settings = Settings::getInstance();
+    StartupProfiler::endPhase("settings");
+    StartupProfiler::startPhase("translation");
     QString locale = settings.getTranslation();
     Translator::translate(locale);
+    StartupProfiler::endPhase("translation");
 
     // Process arguments
     QCommandLineParser parser;
@@ -214,10 +240,14 @@ int main(int argc, char* argv[])
         QCommandLineOption(QStringList() << "l"
                                          << "login",
                            QObject::tr("Starts new instance and opens the login screen.")));
+    parser.addOption(QCommandLineOption("profile-startup",
+                                        QObject::tr("Prints startup phase timings as JSON.")));
     parser.process(*a);
 
     uint32_t profileId = settings.getCurrentProfileId();
+    StartupProfiler::startPhase("ipc");
     IPC ipc(profileId);
+    StartupProfiler::endPhase("ipc");
     if (!ipc.isAttached()) {
         qCritical() << "Can't init IPC";
         return EXIT_FAILURE;
@@ -341,10 +371,14 @@ int main(int argc, char* argv[])
     // TODO (kriby): Shift responsibility of linking views to model objects from nexus
     // Further: generate view instances separately (loginScreen, mainGUI, audio)
     if (autoLogin && Profile::exists(profileName) && !Profile::isEncrypted(profileName)) {
+        StartupProfiler::startPhase("bootstrap");
+        nexus.startEarlyInitStages();
         Profile* profile = Profile::loadProfile(profileName, QString(), settings);
         settings.updateProfileData(profile);
         nexus.bootstrapWithProfile(profile);
+        StartupProfiler::endPhase("bootstrap");
     } else {
+        // the login screen waits on the user, so its time isn't a phase
         int returnval = nexus.showLogin(profileName);
         if (returnval != 0) {
             return returnval;
@@ -364,6 +398,8 @@ int main(int argc, char* argv[])
 
     QObject::connect(a.get(), &QApplication::aboutToQuit, cleanup);
 
+    StartupProfiler::report();
+
     // Run
     int errorcode = a->exec();
 
@@ -19,9 +19,21 @@
 
 #include "chathistory.h"
 #include "src/persistence/settings.h"
+#include "src/util/asynctask.h"
 #include "src/widget/form/chatform.h"
 
 namespace {
+constexpr size_t DEF_PREFETCH_WINDOW = 100;
+constexpr size_t MAX_PREFETCH_WINDOW = 800;
+// Loads closer together than this mean we aren't keeping up with scrolling
+constexpr qint64 RAPID_LOAD_INTERVAL_MS = 1500;
+// In-flight transfer progress is checkpointed to history at this granularity
+constexpr quint64 FILE_PROGRESS_CHECKPOINT = 16 * 1024 * 1024;
+// Per-conversation cap on items held in memory; past it the oldest items are
+// evicted down to the low-water mark, to be re-fetched from the db on demand
+constexpr size_t MAX_RESIDENT_ITEMS = 2000;
+constexpr size_t RESIDENT_ITEMS_LOW_WATER = 1500;
+
 /**
  * @brief Determines if the given idx needs to be loaded from history
  * @param[in] idx index to check
@@ -93,6 +105,7 @@ ChatHistory::ChatHistory(Friend& f_, History* history_, const ICoreIdHandler& co
     , sessionChatLog(getInitialChatLogIdx(history, f), coreIdHandler)
     , settings(settings_)
     , coreIdHandler(coreIdHandler)
+    , prefetchWindowSize(DEF_PREFETCH_WINDOW)
 {
     connect(&messageDispatcher, &IMessageDispatcher::messageSent, this, &ChatHistory::onMessageSent);
     connect(&messageDispatcher, &IMessageDispatcher::messageComplete, this,
@@ -183,6 +196,66 @@ SearchResult ChatHistory::searchBackward(SearchPos startIdx, const QString& phra
     return sessionChatLog.searchBackward(startIdx, phrase, parameter);
 }
 
+/**
+ * @brief Runs a search without blocking the GUI thread on the database.
+ *
+ * The loaded window is searched synchronously since it is in memory anyway.
+ * Only when a backward search has to fall back to the on-disk history does
+ * the phrase lookup move to a worker thread, on its own pooled read
+ * connection. A search started while one is in flight supersedes it, so
+ * retyping the query in SearchForm never stacks up stale lookups.
+ */
+void ChatHistory::startSearch(SearchPos startIdx, const QString& phrase,
+                              const ParameterSearch& parameter, SearchDirection direction)
+{
+    ++searchGeneration;
+
+    if (direction == SearchDirection::Down) {
+        emit searchFinished(searchForward(startIdx, phrase, parameter), direction);
+        return;
+    }
+
+    auto res = sessionChatLog.searchBackward(startIdx, phrase, parameter);
+    if (res.found || !canUseHistory()) {
+        emit searchFinished(res, direction);
+        return;
+    }
+
+    auto earliestMessage = findFirstMessage(sessionChatLog);
+    auto earliestMessageDate =
+        (earliestMessage == ChatLogIdx(-1))
+            ? QDateTime::currentDateTime()
+            : sessionChatLog.at(earliestMessage).getContentAsMessage().message.timestamp;
+
+    auto historyPtr = history;
+    auto friendPk = f.getPublicKey().toString();
+    auto generation = searchGeneration;
+    AsyncTask::runThen(this,
+                       [historyPtr, friendPk, earliestMessageDate, phrase, parameter] {
+                           return historyPtr->getDateWhereFindPhrase(friendPk, earliestMessageDate,
+                                                                     phrase, parameter);
+                       },
+                       [this, generation, startIdx, phrase, parameter](const QDateTime& date) {
+                           // a newer search superseded this lookup while it was running
+                           if (generation != searchGeneration) {
+                               return;
+                           }
+
+                           auto loadIdx =
+                               history->getNumMessagesForFriendBeforeDate(f.getPublicKey(), date);
+                           loadHistoryIntoSessionChatLog(ChatLogIdx(loadIdx));
+
+                           // Reset search pos to the message we just loaded to avoid a
+                           // double search
+                           auto newStartIdx = startIdx;
+                           newStartIdx.logIdx = ChatLogIdx(loadIdx);
+                           newStartIdx.numMatches = 0;
+                           emit searchFinished(sessionChatLog.searchBackward(newStartIdx, phrase,
+                                                                             parameter),
+                                               SearchDirection::Up);
+                       });
+}
+
 ChatLogIdx ChatHistory::getFirstIdx() const
 {
     if (canUseHistory()) {
@@ -247,18 +320,37 @@ void ChatHistory::onFileUpdated(const ToxPk& sender, const ToxFile& file)
         case ToxFile::FINISHED:
         case ToxFile::BROKEN: {
             const bool isSuccess = file.status == ToxFile::FINISHED;
+            if (file.status == ToxFile::BROKEN) {
+                // keep the exact progress of a dying transfer so it can be
+                // resumed at this offset after a restart
+                history->setFileCompletedBytes(file.resumeFileId, file.bytesSent);
+            }
             history->setFileFinished(file.resumeFileId, isSuccess, file.filePath,
                                      file.hashGenerator->result());
+            lastPersistedFileProgress.remove(file.resumeFileId);
             break;
         }
         case ToxFile::PAUSED:
-        case ToxFile::TRANSMITTING:
+            history->setFileCompletedBytes(file.resumeFileId, file.bytesSent);
+            break;
+        case ToxFile::TRANSMITTING: {
+            // checkpoint in-flight progress now and then; a db write per
+            // chunk would be far too hot
+            quint64& persisted = lastPersistedFileProgress[file.resumeFileId];
+            if (file.bytesSent >= persisted + FILE_PROGRESS_CHECKPOINT) {
+                history->setFileCompletedBytes(file.resumeFileId, file.bytesSent);
+                persisted = file.bytesSent;
+            }
+            break;
+        }
         default:
             break;
         }
     }
 
     sessionChatLog.onFileUpdated(sender, file);
+
+    evictStaleItems();
 }
 
 void ChatHistory::onFileTransferRemotePausedUnpaused(const ToxPk& sender, const ToxFile& file,
@@ -269,6 +361,9 @@ void ChatHistory::onFileTransferRemotePausedUnpaused(const ToxPk& sender, const
 
 void ChatHistory::onFileTransferBrokenUnbroken(const ToxPk& sender, const ToxFile& file, bool broken)
 {
+    if (broken && canUseHistory()) {
+        history->setFileCompletedBytes(file.resumeFileId, file.bytesSent);
+    }
     sessionChatLog.onFileTransferBrokenUnbroken(sender, file, broken);
 }
 
@@ -286,6 +381,8 @@ void ChatHistory::onMessageReceived(const ToxPk& sender, const Message& message)
     }
 
     sessionChatLog.onMessageReceived(sender, message);
+
+    evictStaleItems();
 }
 
 void ChatHistory::onMessageSent(DispatchedMessageId id, const Message& message)
@@ -308,6 +405,8 @@ void ChatHistory::onMessageSent(DispatchedMessageId id, const Message& message)
     }
 
     sessionChatLog.onMessageSent(id, message);
+
+    evictStaleItems();
 }
 
 void ChatHistory::onMessageComplete(DispatchedMessageId id)
@@ -330,6 +429,10 @@ void ChatHistory::ensureIdxInSessionChatLog(ChatLogIdx idx) const
 {
     if (needsLoadFromHistory(idx, sessionChatLog)) {
         loadHistoryIntoSessionChatLog(idx);
+    } else if (idx.get() < sessionChatLog.getFirstIdx().get() + prefetchWindowSize / 2) {
+        // The viewport is approaching the top of what's loaded, pull the next
+        // window in the background before the edge is hit
+        prefetchPreviousWindow();
     }
 }
 /**
@@ -348,6 +451,16 @@ void ChatHistory::loadHistoryIntoSessionChatLog(ChatLogIdx start) const
         return;
     }
 
+    // Synchronous loads arriving in quick succession mean the user is paging
+    // through history faster than we fetch it, so grow the window we look
+    // ahead by; a pause in scrolling shrinks it back to the default
+    if (lastLoadTimer.isValid() && lastLoadTimer.elapsed() < RAPID_LOAD_INTERVAL_MS) {
+        prefetchWindowSize = qMin(prefetchWindowSize * 2, MAX_PREFETCH_WINDOW);
+    } else {
+        prefetchWindowSize = DEF_PREFETCH_WINDOW;
+    }
+    lastLoadTimer.restart();
+
     auto end = sessionChatLog.getFirstIdx();
 
     // We know that both history and us have a start index of 0 so the type
@@ -356,6 +469,22 @@ void ChatHistory::loadHistoryIntoSessionChatLog(ChatLogIdx start) const
     auto messages = history->getMessagesForFriend(f.getPublicKey(), start.get(), end.get());
 
     assert(messages.size() == end.get() - start.get());
+    insertLoadedMessages(start, messages);
+
+    prefetchPreviousWindow();
+}
+
+/**
+ * @brief Inserts already fetched history messages ending at the session chat
+ * log's first index
+ * @param[in] start index of the first message
+ * @param[in] messages fetched rows, contiguous up to the first loaded index
+ * @note Marked const for the same reason as loadHistoryIntoSessionChatLog
+ */
+void ChatHistory::insertLoadedMessages(ChatLogIdx start,
+                                       const QList<History::HistMessage>& messages) const
+{
+    auto end = sessionChatLog.getFirstIdx();
     ChatLogIdx nextIdx = start;
 
     for (const auto& message : messages) {
@@ -406,6 +535,50 @@ void ChatHistory::loadHistoryIntoSessionChatLog(ChatLogIdx start) const
     assert(nextIdx == end);
 }
 
+/**
+ * @brief Fetches the window above the loaded history in the background.
+ *
+ * The fetch runs on a pooled read connection off the GUI thread, so scrolling
+ * doesn't stall at the page boundary; the rows are spliced into the session
+ * chat log once the future completes.
+ * @note Marked const for the same reason as loadHistoryIntoSessionChatLog
+ */
+void ChatHistory::prefetchPreviousWindow() const
+{
+    if (prefetchInFlight) {
+        return;
+    }
+
+    const auto end = sessionChatLog.getFirstIdx();
+    if (end.get() == 0) {
+        return;
+    }
+
+    const auto start =
+        end.get() < prefetchWindowSize ? ChatLogIdx(0) : ChatLogIdx(end.get() - prefetchWindowSize);
+
+    prefetchInFlight = true;
+
+    auto historyPtr = history;
+    auto friendPk = f.getPublicKey();
+    AsyncTask::runThen(this,
+                       [historyPtr, friendPk, start, end] {
+                           return historyPtr->getMessagesForFriend(friendPk, start.get(), end.get());
+                       },
+                       [this, start, end](const QList<History::HistMessage>& messages) {
+                           prefetchInFlight = false;
+
+                           // A synchronous load may have overtaken us while the fetch
+                           // ran; only splice the block in if it still sits directly
+                           // above the loaded window
+                           if (sessionChatLog.getFirstIdx() != end) {
+                               return;
+                           }
+
+                           insertLoadedMessages(start, messages);
+                       });
+}
+
 /**
  * @brief Sends any unsent messages in history to the underlying message dispatcher
  * @param[in] messageDispatcher
@@ -440,6 +613,26 @@ void ChatHistory::dispatchUnsentMessages(IMessageDispatcher& messageDispatcher)
     }
 }
 
+/**
+ * @brief Keeps the resident session window capped; evicted items reload from
+ * the db the next time an index below the loaded window is requested.
+ *
+ * Only run on the append paths, so paging upward through old history never
+ * fights eviction. Week-long sessions in busy chats stay at the cap instead
+ * of accumulating every message ever seen.
+ */
+void ChatHistory::evictStaleItems()
+{
+    if (sessionChatLog.size() <= MAX_RESIDENT_ITEMS) {
+        return;
+    }
+
+    // trim a chunk down to the low-water mark rather than one item per
+    // message from here on out
+    const auto next = sessionChatLog.getNextIdx();
+    sessionChatLog.evictBefore(ChatLogIdx(next.get() - RESIDENT_ITEMS_LOW_WATER));
+}
+
 void ChatHistory::handleDispatchedMessage(DispatchedMessageId dispatchId, RowId historyId)
 {
     auto completedMessageIt = completedMessages.find(dispatchId);
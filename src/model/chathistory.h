@@ -24,6 +24,7 @@
 #include "sessionchatlog.h"
 #include "src/persistence/history.h"
 
+#include <QElapsedTimer>
 #include <QSet>
 
 class Settings;
@@ -39,6 +40,8 @@ public:
                                const ParameterSearch& parameter) const override;
     SearchResult searchBackward(SearchPos startIdx, const QString& phrase,
                                 const ParameterSearch& parameter) const override;
+    void startSearch(SearchPos startIdx, const QString& phrase,
+                     const ParameterSearch& parameter, SearchDirection direction) override;
     ChatLogIdx getFirstIdx() const override;
     ChatLogIdx getNextIdx() const override;
     std::vector<DateChatLogIdxPair> getDateIdxs(const QDate& startDate, size_t maxDates) const override;
@@ -57,7 +60,10 @@ private slots:
 private:
     void ensureIdxInSessionChatLog(ChatLogIdx idx) const;
     void loadHistoryIntoSessionChatLog(ChatLogIdx start) const;
+    void insertLoadedMessages(ChatLogIdx start, const QList<History::HistMessage>& messages) const;
+    void prefetchPreviousWindow() const;
     void dispatchUnsentMessages(IMessageDispatcher& messageDispatcher);
+    void evictStaleItems();
     void handleDispatchedMessage(DispatchedMessageId dispatchId, RowId historyId);
     void completeMessage(DispatchedMessageId id);
     bool canUseHistory() const;
@@ -75,6 +81,20 @@ private:
     // If a message is inserted into history before it gets a completion
     // callback it will end up in this map
     QMap<DispatchedMessageId, RowId> dispatchedMessageRowIdMap;
+
+    // Window size grows while the user pages through history faster than we
+    // load it and shrinks back once scrolling pauses
+    mutable size_t prefetchWindowSize;
+    mutable QElapsedTimer lastLoadTimer;
+    mutable bool prefetchInFlight = false;
+
+    // Deep-history phrase lookups run on a worker thread; bumping the
+    // generation abandons the result of a lookup that is already underway
+    uint64_t searchGeneration = 0;
+
+    // Last completed-bytes watermark written to history per transfer, so
+    // in-flight progress is checkpointed without a db write per chunk
+    QHash<QString, quint64> lastPersistedFileProgress;
 };
 
 #endif /*CHAT_HISTORY_H*/
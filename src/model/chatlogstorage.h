@@ -0,0 +1,160 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHAT_LOG_STORAGE_H
+#define CHAT_LOG_STORAGE_H
+
+#include "src/model/chatlogitem.h"
+#include "src/model/ichatlog.h"
+
+#include <deque>
+#include <memory>
+
+/**
+ * @brief Flat, index-keyed storage for a chat log's items.
+ *
+ * Chat log indices are dense: history loads extend the range downwards in
+ * contiguous blocks and live messages append at the top, so a deque of slots
+ * plus the index of the first slot gives O(1) lookup and cache-friendly
+ * iteration where a std::map walked a node per item. The rare interior hole
+ * (an unsent message re-dispatched on load sits at the top instead of at its
+ * history position) is an empty slot; lookups on it just miss, like a
+ * missing map key did.
+ *
+ * The first and last slots are always occupied; only interior slots can be
+ * holes.
+ */
+class ChatLogStorage
+{
+public:
+    bool empty() const
+    {
+        return slots.empty();
+    }
+
+    /**
+     * @brief Number of stored items, holes excluded.
+     */
+    std::size_t size() const
+    {
+        return storedCount;
+    }
+
+    /**
+     * @brief Lowest stored index. Only valid when not empty.
+     */
+    ChatLogIdx firstIdx() const
+    {
+        return offset;
+    }
+
+    /**
+     * @brief Highest stored index. Only valid when not empty.
+     */
+    ChatLogIdx lastIdx() const
+    {
+        return ChatLogIdx(offset.get() + slots.size() - 1);
+    }
+
+    /**
+     * @brief One past the highest stored index; the end of iteration.
+     */
+    ChatLogIdx endIdx() const
+    {
+        return ChatLogIdx(offset.get() + slots.size());
+    }
+
+    ChatLogItem* find(ChatLogIdx idx)
+    {
+        if (slots.empty() || idx < offset || idx >= endIdx()) {
+            return nullptr;
+        }
+        return slots[idx.get() - offset.get()].get();
+    }
+
+    const ChatLogItem* find(ChatLogIdx idx) const
+    {
+        if (slots.empty() || idx < offset || idx >= endIdx()) {
+            return nullptr;
+        }
+        return slots[idx.get() - offset.get()].get();
+    }
+
+    /**
+     * @brief Drops every slot below newFirst; the range shrinks from the
+     * bottom. A no-op if newFirst is at or below the current first index.
+     */
+    void trimFront(ChatLogIdx newFirst)
+    {
+        while (!slots.empty() && offset < newFirst) {
+            if (slots.front()) {
+                --storedCount;
+            }
+            slots.pop_front();
+            ++offset;
+        }
+
+        // restore the front-occupied invariant
+        while (!slots.empty() && !slots.front()) {
+            slots.pop_front();
+            ++offset;
+        }
+    }
+
+    void emplace(ChatLogIdx idx, ChatLogItem item)
+    {
+        auto ptr = std::unique_ptr<ChatLogItem>(new ChatLogItem(std::move(item)));
+
+        if (slots.empty()) {
+            offset = idx;
+            slots.push_back(std::move(ptr));
+            ++storedCount;
+            return;
+        }
+
+        if (idx < offset) {
+            for (auto gap = offset.get() - idx.get(); gap > 1; --gap) {
+                slots.push_front(nullptr);
+            }
+            slots.push_front(std::move(ptr));
+            offset = idx;
+            ++storedCount;
+        } else if (idx >= endIdx()) {
+            for (auto gap = idx.get() - endIdx().get(); gap > 0; --gap) {
+                slots.push_back(nullptr);
+            }
+            slots.push_back(std::move(ptr));
+            ++storedCount;
+        } else {
+            auto& slot = slots[idx.get() - offset.get()];
+            if (!slot) {
+                ++storedCount;
+            }
+            slot = std::move(ptr);
+        }
+    }
+
+private:
+    // one slot per index in [offset, offset + slots.size()); nullptr = hole
+    std::deque<std::unique_ptr<ChatLogItem>> slots;
+    ChatLogIdx offset{0};
+    std::size_t storedCount = 0;
+};
+
+#endif /* CHAT_LOG_STORAGE_H */
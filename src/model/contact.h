@@ -37,7 +37,9 @@ public:
     virtual void setEventFlag(bool flag) = 0;
     virtual bool getEventFlag() const = 0;
 
-    virtual bool useHistory() const = 0; // TODO: remove after added history in group chat
+    // every contact type persists history now; kept virtual so a future
+    // ephemeral chat type can still opt out of the load-history UI
+    virtual bool useHistory() const = 0;
 
 signals:
     void displayedNameChanged(const QString& newName);
@@ -60,6 +60,7 @@ FriendMessageDispatcher::sendMessage(bool isAction, const QString& content)
 {
     const auto firstId = nextMessageId;
     auto lastId = nextMessageId;
+    QVector<QPair<DispatchedMessageId, Message>> batch;
     for (const auto& message : processor.processOutgoingMessage(isAction, content)) {
         auto messageId = nextMessageId++;
         lastId = messageId;
@@ -80,7 +81,9 @@ FriendMessageDispatcher::sendMessage(bool isAction, const QString& content)
         }
 
         emit this->messageSent(messageId, message);
+        batch.append({messageId, message});
     }
+    emit this->messagesSent(batch);
     return std::make_pair(firstId, lastId);
 }
 
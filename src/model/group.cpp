@@ -91,31 +91,40 @@ void Group::regeneratePeerList()
     // username, using just their ToxPk, then shortly after emit another peerNameChanged signal.
     // This can cause double-updated to UI and chatlog, but is unavoidable given the API of toxcore.
     QStringList peers = groupQuery.getGroupPeerNames(toxGroupNum);
-    const auto oldPeerNames = peerDisplayNames;
-    peerDisplayNames.clear();
     const int nPeers = peers.size();
+
+    QHash<ToxPk, QString> updatedNames;
+    updatedNames.reserve(nPeers);
     for (int i = 0; i < nPeers; ++i) {
         const auto pk = groupQuery.getGroupPeerPk(toxGroupNum, i);
         if (pk == idHandler.getSelfPublicKey()) {
-            peerDisplayNames[pk] = idHandler.getUsername();
+            updatedNames.insert(pk, idHandler.getUsername());
         } else {
-            peerDisplayNames[pk] = FriendList::decideNickname(pk, peers[i]);
-        }
-    }
-    for (const auto& pk : oldPeerNames.keys()) {
-        if (!peerDisplayNames.contains(pk)) {
-            emit userLeft(pk, oldPeerNames.value(pk));
-            stopAudioOfDepartedPeers(pk);
+            updatedNames.insert(pk, FriendList::decideNickname(pk, peers[i]));
         }
     }
-    for (const auto& pk : peerDisplayNames.keys()) {
-        if (!oldPeerNames.contains(pk)) {
-            emit userJoined(pk, peerDisplayNames.value(pk));
+
+    const auto oldPeerNames = peerDisplayNames;
+    peerDisplayNames = updatedNames;
+
+    // Diff the registries and emit only the deltas; consumers apply them
+    // incrementally, so a single join or leave in a large group costs them
+    // one update rather than a rebuild. Slots run against the new registry.
+    for (auto it = oldPeerNames.cbegin(); it != oldPeerNames.cend(); ++it) {
+        if (!updatedNames.contains(it.key())) {
+            ++peerListRevision;
+            emit userLeft(it.key(), it.value());
+            stopAudioOfDepartedPeers(it.key());
         }
     }
-    for (const auto& pk : peerDisplayNames.keys()) {
-        if (oldPeerNames.contains(pk) && oldPeerNames.value(pk) != peerDisplayNames.value(pk)) {
-            emit peerNameChanged(pk, oldPeerNames.value(pk), peerDisplayNames.value(pk));
+    for (auto it = updatedNames.cbegin(); it != updatedNames.cend(); ++it) {
+        const auto old = oldPeerNames.constFind(it.key());
+        if (old == oldPeerNames.cend()) {
+            ++peerListRevision;
+            emit userJoined(it.key(), it.value());
+        } else if (old.value() != it.value()) {
+            ++peerListRevision;
+            emit peerNameChanged(it.key(), old.value(), it.value());
         }
     }
     if (oldPeerNames.size() != nPeers) {
@@ -131,6 +140,7 @@ void Group::updateUsername(ToxPk pk, const QString newName)
         // there could be no actual change even if their username changed due to an alias being set
         const auto oldName = peerDisplayNames[pk];
         peerDisplayNames[pk] = displayName;
+        ++peerListRevision;
         emit peerNameChanged(pk, oldName, displayName);
     }
 }
@@ -159,11 +169,23 @@ int Group::getPeersCount() const
  * @brief Gets the PKs and names of all peers
  * @return PKs and names of all peers, including our own PK and name
  */
-const QMap<ToxPk, QString>& Group::getPeerList() const
+const QHash<ToxPk, QString>& Group::getPeerList() const
 {
     return peerDisplayNames;
 }
 
+/**
+ * @brief Monotonic counter bumped on every peer join, leave or rename
+ * @return Current revision of the peer registry
+ *
+ * Consumers that cache state derived from the peer list can remember the
+ * revision they built against and skip rebuilding while it has not moved.
+ */
+uint64_t Group::getPeerListRevision() const
+{
+    return peerListRevision;
+}
+
 void Group::setEventFlag(bool f)
 {
     hasNewMessages = f;
@@ -207,7 +229,7 @@ QString Group::getSelfName() const
 
 bool Group::useHistory() const
 {
-    return false;
+    return true;
 }
 
 void Group::stopAudioOfDepartedPeers(const ToxPk& peerPk)
@@ -28,7 +28,7 @@
 #include "src/core/icoreidhandler.h"
 #include "src/core/toxpk.h"
 
-#include <QMap>
+#include <QHash>
 #include <QObject>
 #include <QStringList>
 
@@ -43,7 +43,8 @@ public:
     const GroupId& getPersistentId() const override;
     int getPeersCount() const;
     void regeneratePeerList();
-    const QMap<ToxPk, QString>& getPeerList() const;
+    const QHash<ToxPk, QString>& getPeerList() const;
+    uint64_t getPeerListRevision() const;
     bool peerHasNickname(ToxPk pk);
 
     void setEventFlag(bool f) override;
@@ -79,7 +80,8 @@ private:
     ICoreIdHandler& idHandler;
     QString selfName;
     QString title;
-    QMap<ToxPk, QString> peerDisplayNames;
+    QHash<ToxPk, QString> peerDisplayNames;
+    uint64_t peerListRevision = 0;
     bool hasNewMessages;
     bool userWasMentioned;
     int toxGroupNum;
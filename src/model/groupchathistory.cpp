@@ -0,0 +1,473 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "groupchathistory.h"
+#include "group.h"
+#include "src/persistence/settings.h"
+#include "src/util/asynctask.h"
+#include "src/widget/form/chatform.h"
+
+namespace {
+constexpr size_t DEF_PREFETCH_WINDOW = 100;
+constexpr size_t MAX_PREFETCH_WINDOW = 800;
+// Loads closer together than this mean we aren't keeping up with scrolling
+constexpr qint64 RAPID_LOAD_INTERVAL_MS = 1500;
+// Per-conversation cap on items held in memory; group channels churn even
+// harder than 1:1 chats, so the eviction matters more here, not less
+constexpr size_t MAX_RESIDENT_ITEMS = 2000;
+constexpr size_t RESIDENT_ITEMS_LOW_WATER = 1500;
+
+/**
+ * @brief Determines if the given idx needs to be loaded from history
+ */
+bool needsLoadFromHistory(ChatLogIdx idx, const SessionChatLog& sessionChatLog)
+{
+    return idx < sessionChatLog.getFirstIdx();
+}
+
+/**
+ * @brief Gets the initial chat log index for a sessionChatLog with 0 items
+ * loaded from history, to keep history indexes in sync with chat log indexes
+ */
+ChatLogIdx getInitialChatLogIdx(History* history, Group& g)
+{
+    if (!history) {
+        return ChatLogIdx(0);
+    }
+
+    return ChatLogIdx(history->getNumMessagesForFriend(g.getPersistentId()));
+}
+
+/**
+ * @brief Finds the first item in sessionChatLog that contains a message
+ */
+ChatLogIdx findFirstMessage(const SessionChatLog& sessionChatLog)
+{
+    auto it = sessionChatLog.getFirstIdx();
+    while (it < sessionChatLog.getNextIdx()) {
+        if (sessionChatLog.at(it).getContentType() == ChatLogItem::ContentType::message) {
+            return it;
+        }
+        it++;
+    }
+    return ChatLogIdx(-1);
+}
+
+/**
+ * @brief Strips the legacy action prefix from content if present
+ * @return True if it was an action
+ */
+bool handleActionPrefix(QString& content)
+{
+    // Same legacy encoding as 1:1 history: actions are stored with the
+    // prefix baked into the body and parsed back out on load
+    auto isAction = content.startsWith(ChatForm::ACTION_PREFIX, Qt::CaseInsensitive);
+    if (isAction) {
+        content.remove(0, ChatForm::ACTION_PREFIX.size());
+    }
+
+    return isAction;
+}
+} // namespace
+
+GroupChatHistory::GroupChatHistory(Group& g_, History* history_,
+                                   const ICoreIdHandler& coreIdHandler,
+                                   const Settings& settings_,
+                                   IMessageDispatcher& messageDispatcher)
+    : g(g_)
+    , history(history_)
+    , sessionChatLog(getInitialChatLogIdx(history_, g_), coreIdHandler)
+    , settings(settings_)
+    , coreIdHandler(coreIdHandler)
+    , prefetchWindowSize(DEF_PREFETCH_WINDOW)
+{
+    // Unlike ChatHistory there is no unsent-message redispatch to sequence
+    // around, so all three dispatcher signals hook up right away
+    connect(&messageDispatcher, &IMessageDispatcher::messageSent, this,
+            &GroupChatHistory::onMessageSent);
+    connect(&messageDispatcher, &IMessageDispatcher::messageComplete, this,
+            &GroupChatHistory::onMessageComplete);
+    connect(&messageDispatcher, &IMessageDispatcher::messageReceived, this,
+            &GroupChatHistory::onMessageReceived);
+
+    constexpr auto defaultNumMessagesToLoad = 100;
+    auto firstChatLogIdx = sessionChatLog.getFirstIdx().get() < defaultNumMessagesToLoad
+                               ? ChatLogIdx(0)
+                               : sessionChatLog.getFirstIdx() - defaultNumMessagesToLoad;
+
+    if (canUseHistory()) {
+        loadHistoryIntoSessionChatLog(firstChatLogIdx);
+    }
+
+    // We don't manage any of the item updates ourselves, we just forward along
+    // the underlying sessionChatLog's updates
+    connect(&sessionChatLog, &IChatLog::itemUpdated, this, &IChatLog::itemUpdated);
+}
+
+const ChatLogItem& GroupChatHistory::at(ChatLogIdx idx) const
+{
+    if (canUseHistory()) {
+        ensureIdxInSessionChatLog(idx);
+    }
+
+    return sessionChatLog.at(idx);
+}
+
+SearchResult GroupChatHistory::searchForward(SearchPos startIdx, const QString& phrase,
+                                             const ParameterSearch& parameter) const
+{
+    if (startIdx.logIdx >= getNextIdx()) {
+        SearchResult res;
+        res.found = false;
+        return res;
+    }
+
+    if (canUseHistory()) {
+        ensureIdxInSessionChatLog(startIdx.logIdx);
+    }
+
+    return sessionChatLog.searchForward(startIdx, phrase, parameter);
+}
+
+SearchResult GroupChatHistory::searchBackward(SearchPos startIdx, const QString& phrase,
+                                              const ParameterSearch& parameter) const
+{
+    auto res = sessionChatLog.searchBackward(startIdx, phrase, parameter);
+
+    if (res.found || !canUseHistory()) {
+        return res;
+    }
+
+    auto earliestMessage = findFirstMessage(sessionChatLog);
+
+    auto earliestMessageDate =
+        (earliestMessage == ChatLogIdx(-1))
+            ? QDateTime::currentDateTime()
+            : sessionChatLog.at(earliestMessage).getContentAsMessage().message.timestamp;
+
+    // The db-side phrase queries are keyed by the chat's id string, so the
+    // group id slots straight in where ChatHistory passes the friend key
+    auto dateWherePhraseFound =
+        history->getDateWhereFindPhrase(g.getPersistentId().toString(), earliestMessageDate,
+                                        phrase, parameter);
+
+    auto loadIdx = history->getNumMessagesForFriendBeforeDate(g.getPersistentId(),
+                                                              dateWherePhraseFound);
+    loadHistoryIntoSessionChatLog(ChatLogIdx(loadIdx));
+
+    // Reset search pos to the message we just loaded to avoid a double search
+    startIdx.logIdx = ChatLogIdx(loadIdx);
+    startIdx.numMatches = 0;
+    return sessionChatLog.searchBackward(startIdx, phrase, parameter);
+}
+
+/**
+ * @brief Runs a search without blocking the GUI thread on the database.
+ *
+ * Same scheme as ChatHistory::startSearch: the loaded window is searched
+ * synchronously, only the fall-back phrase lookup over on-disk history moves
+ * to a worker thread, and a newer search supersedes one in flight.
+ */
+void GroupChatHistory::startSearch(SearchPos startIdx, const QString& phrase,
+                                   const ParameterSearch& parameter, SearchDirection direction)
+{
+    ++searchGeneration;
+
+    if (direction == SearchDirection::Down) {
+        emit searchFinished(searchForward(startIdx, phrase, parameter), direction);
+        return;
+    }
+
+    auto res = sessionChatLog.searchBackward(startIdx, phrase, parameter);
+    if (res.found || !canUseHistory()) {
+        emit searchFinished(res, direction);
+        return;
+    }
+
+    auto earliestMessage = findFirstMessage(sessionChatLog);
+    auto earliestMessageDate =
+        (earliestMessage == ChatLogIdx(-1))
+            ? QDateTime::currentDateTime()
+            : sessionChatLog.at(earliestMessage).getContentAsMessage().message.timestamp;
+
+    auto historyPtr = history;
+    auto groupPk = g.getPersistentId().toString();
+    auto generation = searchGeneration;
+    AsyncTask::runThen(this,
+                       [historyPtr, groupPk, earliestMessageDate, phrase, parameter] {
+                           return historyPtr->getDateWhereFindPhrase(groupPk, earliestMessageDate,
+                                                                     phrase, parameter);
+                       },
+                       [this, generation, startIdx, phrase, parameter](const QDateTime& date) {
+                           // a newer search superseded this lookup while it was running
+                           if (generation != searchGeneration) {
+                               return;
+                           }
+
+                           auto loadIdx =
+                               history->getNumMessagesForFriendBeforeDate(g.getPersistentId(),
+                                                                          date);
+                           loadHistoryIntoSessionChatLog(ChatLogIdx(loadIdx));
+
+                           // Reset search pos to the message we just loaded to
+                           // avoid a double search
+                           auto newStartIdx = startIdx;
+                           newStartIdx.logIdx = ChatLogIdx(loadIdx);
+                           newStartIdx.numMatches = 0;
+                           emit searchFinished(sessionChatLog.searchBackward(newStartIdx, phrase,
+                                                                             parameter),
+                                               SearchDirection::Up);
+                       });
+}
+
+ChatLogIdx GroupChatHistory::getFirstIdx() const
+{
+    if (canUseHistory()) {
+        return ChatLogIdx(0);
+    } else {
+        return sessionChatLog.getFirstIdx();
+    }
+}
+
+ChatLogIdx GroupChatHistory::getNextIdx() const
+{
+    return sessionChatLog.getNextIdx();
+}
+
+std::vector<IChatLog::DateChatLogIdxPair> GroupChatHistory::getDateIdxs(const QDate& startDate,
+                                                                        size_t maxDates) const
+{
+    if (canUseHistory()) {
+        auto counts = history->getNumMessagesForFriendBeforeDateBoundaries(g.getPersistentId(),
+                                                                           startDate, maxDates);
+
+        std::vector<IChatLog::DateChatLogIdxPair> ret;
+        std::transform(counts.begin(), counts.end(), std::back_inserter(ret),
+                       [&](const History::DateIdx& historyDateIdx) {
+                           DateChatLogIdxPair pair;
+                           pair.date = historyDateIdx.date;
+                           pair.idx.get() = historyDateIdx.numMessagesIn;
+                           return pair;
+                       });
+
+        return ret;
+    } else {
+        return sessionChatLog.getDateIdxs(startDate, maxDates);
+    }
+}
+
+std::size_t GroupChatHistory::size() const
+{
+    if (canUseHistory()) {
+        return history->getNumMessagesForFriend(g.getPersistentId());
+    }
+
+    return sessionChatLog.size();
+}
+
+void GroupChatHistory::onMessageReceived(const ToxPk& sender, const Message& message)
+{
+    if (canUseHistory()) {
+        auto groupPk = g.getPersistentId().toString();
+        auto content = message.content;
+        if (message.isAction) {
+            content = ChatForm::ACTION_PREFIX + content;
+        }
+
+        // Unlike 1:1 chats the sender isn't the chat itself; the sender's
+        // own key and current nick go in so attribution survives restarts
+        history->addNewMessage(groupPk, content, sender.toString(), message.timestamp, true,
+                               g.resolveToxId(sender));
+    }
+
+    sessionChatLog.onMessageReceived(sender, message);
+
+    evictStaleItems();
+}
+
+void GroupChatHistory::onMessageSent(DispatchedMessageId id, const Message& message)
+{
+    if (canUseHistory()) {
+        auto selfPk = coreIdHandler.getSelfPublicKey().toString();
+        auto groupPk = g.getPersistentId().toString();
+
+        auto content = message.content;
+        if (message.isAction) {
+            content = ChatForm::ACTION_PREFIX + content;
+        }
+
+        // Group sends have no delivery receipt to wait for, so the row is
+        // stored as sent and never enters the faux-offline queue
+        history->addNewMessage(groupPk, content, selfPk, message.timestamp, true,
+                               coreIdHandler.getUsername());
+    }
+
+    sessionChatLog.onMessageSent(id, message);
+
+    evictStaleItems();
+}
+
+void GroupChatHistory::onMessageComplete(DispatchedMessageId id)
+{
+    sessionChatLog.onMessageComplete(id);
+}
+
+/**
+ * @brief Forces the given index and all future indexes to be in the chatlog
+ * @note Marked const for the same reason as ChatHistory: the items don't
+ * change, they're just pulled into ram
+ */
+void GroupChatHistory::ensureIdxInSessionChatLog(ChatLogIdx idx) const
+{
+    if (needsLoadFromHistory(idx, sessionChatLog)) {
+        loadHistoryIntoSessionChatLog(idx);
+    } else if (idx.get() < sessionChatLog.getFirstIdx().get() + prefetchWindowSize / 2) {
+        // The viewport is approaching the top of what's loaded, pull the next
+        // window in the background before the edge is hit
+        prefetchPreviousWindow();
+    }
+}
+
+/**
+ * @brief Loads the given index up to the first loaded message into the
+ * session chat log
+ */
+void GroupChatHistory::loadHistoryIntoSessionChatLog(ChatLogIdx start) const
+{
+    if (!needsLoadFromHistory(start, sessionChatLog)) {
+        return;
+    }
+
+    // Synchronous loads arriving in quick succession mean the user is paging
+    // through history faster than we fetch it, grow the look-ahead window
+    if (lastLoadTimer.isValid() && lastLoadTimer.elapsed() < RAPID_LOAD_INTERVAL_MS) {
+        prefetchWindowSize = qMin(prefetchWindowSize * 2, MAX_PREFETCH_WINDOW);
+    } else {
+        prefetchWindowSize = DEF_PREFETCH_WINDOW;
+    }
+    lastLoadTimer.restart();
+
+    auto end = sessionChatLog.getFirstIdx();
+
+    // We know that both history and us have a start index of 0 so the type
+    // conversion should be safe
+    assert(getFirstIdx() == ChatLogIdx(0));
+    auto messages = history->getMessagesForFriend(g.getPersistentId(), start.get(), end.get());
+
+    assert(messages.size() == end.get() - start.get());
+    insertLoadedMessages(start, messages);
+
+    prefetchPreviousWindow();
+}
+
+/**
+ * @brief Inserts already fetched history messages ending at the session chat
+ * log's first index
+ */
+void GroupChatHistory::insertLoadedMessages(ChatLogIdx start,
+                                            const QList<History::HistMessage>& messages) const
+{
+    auto end = sessionChatLog.getFirstIdx();
+    ChatLogIdx nextIdx = start;
+
+    for (const auto& message : messages) {
+        auto currentIdx = nextIdx++;
+        auto sender = ToxId(message.sender).getPublicKey();
+
+        // Group chats transfer no files, but if a row ever carries one,
+        // drawing it beats dropping it
+        if (message.content.getType() == HistMessageContentType::file) {
+            const auto date = message.timestamp;
+            const auto file = message.content.asFile();
+            const auto chatLogFile = ChatLogFile{date, file};
+            sessionChatLog.insertFileAtIdx(currentIdx, sender, message.dispName, chatLogFile);
+            continue;
+        }
+
+        auto messageContent = message.content.asMessage();
+        auto isAction = handleActionPrefix(messageContent);
+
+        // Everything in group history was complete when it was stored, so
+        // there is no dispatch bookkeeping to reconcile on load
+        auto processedMessage = Message{isAction, messageContent, message.timestamp};
+        sessionChatLog.insertMessageAtIdx(currentIdx, sender, message.dispName,
+                                          ChatLogMessage{true, processedMessage});
+    }
+
+    assert(nextIdx == end);
+}
+
+/**
+ * @brief Fetches the window above the loaded history in the background, same
+ * as ChatHistory::prefetchPreviousWindow
+ */
+void GroupChatHistory::prefetchPreviousWindow() const
+{
+    if (prefetchInFlight) {
+        return;
+    }
+
+    const auto end = sessionChatLog.getFirstIdx();
+    if (end.get() == 0) {
+        return;
+    }
+
+    const auto start =
+        end.get() < prefetchWindowSize ? ChatLogIdx(0) : ChatLogIdx(end.get() - prefetchWindowSize);
+
+    prefetchInFlight = true;
+
+    auto historyPtr = history;
+    auto groupId = g.getPersistentId();
+    AsyncTask::runThen(this,
+                       [historyPtr, groupId, start, end] {
+                           return historyPtr->getMessagesForFriend(groupId, start.get(), end.get());
+                       },
+                       [this, start, end](const QList<History::HistMessage>& messages) {
+                           prefetchInFlight = false;
+
+                           // A synchronous load may have overtaken us while the
+                           // fetch ran; only splice the block in if it still
+                           // sits directly above the loaded window
+                           if (sessionChatLog.getFirstIdx() != end) {
+                               return;
+                           }
+
+                           insertLoadedMessages(start, messages);
+                       });
+}
+
+/**
+ * @brief Keeps the resident session window capped, see
+ * ChatHistory::evictStaleItems
+ */
+void GroupChatHistory::evictStaleItems()
+{
+    if (sessionChatLog.size() <= MAX_RESIDENT_ITEMS) {
+        return;
+    }
+
+    const auto next = sessionChatLog.getNextIdx();
+    sessionChatLog.evictBefore(ChatLogIdx(next.get() - RESIDENT_ITEMS_LOW_WATER));
+}
+
+bool GroupChatHistory::canUseHistory() const
+{
+    return history && settings.getEnableLogging();
+}
@@ -0,0 +1,91 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GROUP_CHAT_HISTORY_H
+#define GROUP_CHAT_HISTORY_H
+
+#include "ichatlog.h"
+#include "sessionchatlog.h"
+#include "src/persistence/history.h"
+
+#include <QElapsedTimer>
+
+class Group;
+class Settings;
+
+/**
+ * History-backed chat log for group conversations, the group counterpart of
+ * ChatHistory. Rows live in the same tables as 1:1 history - the group's
+ * GroupId string takes the place of the friend key in the peers table, and
+ * each message's sender is attributed through its own peer and alias rows -
+ * so the indexing, day counters and paginated loading all apply unchanged.
+ *
+ * Compared to ChatHistory there is no file transfer handling (groups have
+ * none) and no unsent-message redispatch: group sends are fire-and-forget,
+ * so rows are stored as sent and skip the faux-offline queue.
+ */
+class GroupChatHistory : public IChatLog
+{
+    Q_OBJECT
+public:
+    GroupChatHistory(Group& g_, History* history_, const ICoreIdHandler& coreIdHandler,
+                     const Settings& settings, IMessageDispatcher& messageDispatcher);
+    const ChatLogItem& at(ChatLogIdx idx) const override;
+    SearchResult searchForward(SearchPos startIdx, const QString& phrase,
+                               const ParameterSearch& parameter) const override;
+    SearchResult searchBackward(SearchPos startIdx, const QString& phrase,
+                                const ParameterSearch& parameter) const override;
+    void startSearch(SearchPos startIdx, const QString& phrase,
+                     const ParameterSearch& parameter, SearchDirection direction) override;
+    ChatLogIdx getFirstIdx() const override;
+    ChatLogIdx getNextIdx() const override;
+    std::vector<DateChatLogIdxPair> getDateIdxs(const QDate& startDate, size_t maxDates) const override;
+    std::size_t size() const override;
+
+private slots:
+    void onMessageReceived(const ToxPk& sender, const Message& message);
+    void onMessageSent(DispatchedMessageId id, const Message& message);
+    void onMessageComplete(DispatchedMessageId id);
+
+private:
+    void ensureIdxInSessionChatLog(ChatLogIdx idx) const;
+    void loadHistoryIntoSessionChatLog(ChatLogIdx start) const;
+    void insertLoadedMessages(ChatLogIdx start, const QList<History::HistMessage>& messages) const;
+    void prefetchPreviousWindow() const;
+    void evictStaleItems();
+    bool canUseHistory() const;
+
+    Group& g;
+    History* history;
+    mutable SessionChatLog sessionChatLog;
+    const Settings& settings;
+    const ICoreIdHandler& coreIdHandler;
+
+    // Same adaptive paging state as ChatHistory: the window grows while the
+    // user outpaces loading and shrinks back once scrolling pauses
+    mutable size_t prefetchWindowSize;
+    mutable QElapsedTimer lastLoadTimer;
+    mutable bool prefetchInFlight = false;
+
+    // Bumping the generation abandons a deep-history phrase lookup that is
+    // already running on the worker thread
+    uint64_t searchGeneration = 0;
+};
+
+#endif /*GROUP_CHAT_HISTORY_H*/
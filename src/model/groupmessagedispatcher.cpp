@@ -41,7 +41,13 @@ GroupMessageDispatcher::sendMessage(bool isAction, QString const& content)
     const auto firstMessageId = nextMessageId;
     auto lastMessageId = firstMessageId;
 
-    for (auto const& message : processor.processOutgoingMessage(isAction, content)) {
+    // split the content and hand the whole burst to toxcore first; fanning
+    // out to consumers afterwards keeps a slow chat view from sitting between
+    // consecutive sends of a multi-part message
+    const auto messages = processor.processOutgoingMessage(isAction, content);
+    QVector<QPair<DispatchedMessageId, Message>> batch;
+    batch.reserve(messages.size());
+    for (auto const& message : messages) {
         auto messageId = nextMessageId++;
         lastMessageId = messageId;
         if (group.getPeersCount() != 1) {
@@ -51,16 +57,20 @@ GroupMessageDispatcher::sendMessage(bool isAction, QString const& content)
                 messageSender.sendGroupMessage(group.getId(), message.content);
             }
         }
+        batch.append({messageId, message});
+    }
 
-        // Emit both signals since we do not have receipts for groups
-        //
-        // NOTE: We could in theory keep track of our sent message and wait for
-        // toxcore to send it back to us to indicate a completed message, but
-        // this isn't necessarily the design of toxcore and associating the
-        // received message back would be difficult.
-        emit this->messageSent(messageId, message);
-        emit this->messageComplete(messageId);
+    // Emit both signals since we do not have receipts for groups
+    //
+    // NOTE: We could in theory keep track of our sent message and wait for
+    // toxcore to send it back to us to indicate a completed message, but
+    // this isn't necessarily the design of toxcore and associating the
+    // received message back would be difficult.
+    for (auto const& entry : batch) {
+        emit this->messageSent(entry.first, entry.second);
+        emit this->messageComplete(entry.first);
     }
+    emit this->messagesSent(batch);
 
     return std::make_pair(firstMessageId, lastMessageId);
 }
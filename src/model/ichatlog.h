@@ -113,6 +113,23 @@ public:
     virtual SearchResult searchBackward(SearchPos startIdx, const QString& phrase,
                                         const ParameterSearch& parameter) const = 0;
 
+    /**
+     * @brief Starts a search whose result is delivered through searchFinished()
+     *
+     * The base implementation just searches synchronously before emitting.
+     * Chat logs backed by slow storage override this to run the expensive
+     * part off the GUI thread; in that case only the most recently started
+     * search is reported, so retyping the query cancels the one in flight.
+     */
+    virtual void startSearch(SearchPos startIdx, const QString& phrase,
+                             const ParameterSearch& parameter, SearchDirection direction)
+    {
+        const SearchResult result = direction == SearchDirection::Up
+                                        ? searchBackward(startIdx, phrase, parameter)
+                                        : searchForward(startIdx, phrase, parameter);
+        emit searchFinished(result, direction);
+    }
+
     /**
      * @brief The underlying chat log instance may not want to start at 0
      * @return Current first valid index to call at() with
@@ -142,6 +159,7 @@ public:
 
 signals:
     void itemUpdated(ChatLogIdx idx);
+    void searchFinished(SearchResult result, SearchDirection direction);
 };
 
 #endif /*ICHAT_LOG_H*/
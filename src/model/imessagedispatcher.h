@@ -24,7 +24,9 @@
 #include "src/model/message.h"
 
 #include <QObject>
+#include <QPair>
 #include <QString>
+#include <QVector>
 
 #include <cstdint>
 
@@ -58,6 +60,15 @@ signals:
      */
     void messageSent(DispatchedMessageId id, const Message& message);
 
+    /**
+     * @brief Emitted once per sendMessage call with every message of the burst
+     *
+     * Each message is still delivered through the granular messageSent signal;
+     * consumers that refresh a whole view should connect here instead and do
+     * so once per batch.
+     */
+    void messagesSent(const QVector<QPair<DispatchedMessageId, Message>>& messages);
+
     /**
      * @brief Emitted when a receiver report is received from the associated chat
      * @param id Id of message that is completed
@@ -0,0 +1,172 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inboundmsgqueue.h"
+
+#include "src/util/memoryregistry.h"
+
+#include <QDebug>
+
+/**
+ * @class InboundMsgQueue
+ * @brief Bounded handoff queue between toxcore message callbacks and the
+ * per-friend dispatchers.
+ *
+ * Without it, every received message is one queued slot invocation on the
+ * main thread, so a flooding peer balloons the event queue and the UI
+ * freezes behind it. Enqueueing here is cheap; messages are then drained in
+ * budgeted batches from a zero-interval timer, which lets paint and input
+ * events interleave with message processing. The visible chat's queue is
+ * drained first so the conversation on screen stays live under load.
+ *
+ * Each friend's queue is capped. When a queue overflows, the oldest
+ * messages are shed through messageShed instead of messageReady; the owner
+ * is expected to persist those straight to history, so nothing is lost but
+ * the flood never reaches the chat view.
+ */
+
+namespace {
+// Messages dispatched per drain pass before yielding back to the event loop
+constexpr int DRAIN_BUDGET = 32;
+// Per-friend depth cap; overflow is shed to history
+constexpr int PER_FRIEND_CAP = 256;
+} // namespace
+
+InboundMsgQueue::InboundMsgQueue(QObject* parent)
+    : QObject(parent)
+{
+    drainTimer.setSingleShot(true);
+    drainTimer.setInterval(0);
+    connect(&drainTimer, &QTimer::timeout, this, &InboundMsgQueue::drain);
+
+    MemoryRegistry::registerSampler(QStringLiteral("inbound message queue"),
+                                    [this]() {
+                                        return QString("%1 queued (peak %2), %3 shed to history")
+                                            .arg(totalDepth)
+                                            .arg(maxDepth)
+                                            .arg(shedTotal);
+                                    },
+                                    this);
+}
+
+InboundMsgQueue::~InboundMsgQueue()
+{
+    MemoryRegistry::unregister(this);
+}
+
+void InboundMsgQueue::enqueue(const ToxPk& friendPk, bool isAction, const QString& content)
+{
+    QQueue<QueuedMessage>& queue = queues[friendPk];
+    queue.enqueue({isAction, content});
+    ++totalDepth;
+    maxDepth = qMax(maxDepth, totalDepth);
+
+    // shed the oldest overflow so what eventually reaches the view is recent
+    while (queue.size() > PER_FRIEND_CAP) {
+        const QueuedMessage shed = queue.dequeue();
+        --totalDepth;
+        ++shedTotal;
+        if (shedTotal % PER_FRIEND_CAP == 1) {
+            qWarning() << "Inbound queue for" << friendPk.toString()
+                       << "overflowed; shedding messages to history";
+        }
+        emit messageShed(friendPk, shed.isAction, shed.content);
+    }
+
+    if (!drainTimer.isActive()) {
+        drainTimer.start();
+    }
+}
+
+/**
+ * @brief Marks the friend whose chat is on screen; their queue drains first.
+ */
+void InboundMsgQueue::setVisibleFriend(const ToxPk& friendPk)
+{
+    visibleFriend = friendPk;
+}
+
+void InboundMsgQueue::clearVisibleFriend()
+{
+    visibleFriend = ToxPk{};
+}
+
+size_t InboundMsgQueue::depth() const
+{
+    return totalDepth;
+}
+
+size_t InboundMsgQueue::peakDepth() const
+{
+    return maxDepth;
+}
+
+quint64 InboundMsgQueue::shedCount() const
+{
+    return shedTotal;
+}
+
+/**
+ * @brief Dispatches up to budget messages from one friend's queue.
+ * @return Number of messages dispatched.
+ */
+int InboundMsgQueue::drainFriend(const ToxPk& friendPk, int budget)
+{
+    auto it = queues.find(friendPk);
+    if (it == queues.end()) {
+        return 0;
+    }
+
+    QVector<QueuedMessage> batch;
+    while (batch.size() < budget && !it->isEmpty()) {
+        batch.append(it->dequeue());
+    }
+    totalDepth -= batch.size();
+    if (it->isEmpty()) {
+        queues.erase(it);
+    }
+
+    // emitted only after the container surgery is done: a handler may
+    // re-enter enqueue(), which can rehash and invalidate iterators
+    for (const QueuedMessage& message : batch) {
+        emit messageReady(friendPk, message.isAction, message.content);
+    }
+    return batch.size();
+}
+
+void InboundMsgQueue::drain()
+{
+    int budget = DRAIN_BUDGET;
+
+    // visible chat first, then whoever else is waiting
+    budget -= drainFriend(visibleFriend, budget);
+
+    const QList<ToxPk> waiting = queues.keys();
+    for (const ToxPk& friendPk : waiting) {
+        if (budget <= 0) {
+            break;
+        }
+        budget -= drainFriend(friendPk, budget);
+    }
+
+    // anything left waits for the next event loop pass, after paint/input
+    if (totalDepth > 0) {
+        drainTimer.start();
+    }
+}
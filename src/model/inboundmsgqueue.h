@@ -0,0 +1,70 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INBOUND_MSG_QUEUE_H
+#define INBOUND_MSG_QUEUE_H
+
+#include "src/core/toxpk.h"
+
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QTimer>
+
+class InboundMsgQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit InboundMsgQueue(QObject* parent = nullptr);
+    ~InboundMsgQueue();
+
+    void enqueue(const ToxPk& friendPk, bool isAction, const QString& content);
+    void setVisibleFriend(const ToxPk& friendPk);
+    void clearVisibleFriend();
+
+    size_t depth() const;
+    size_t peakDepth() const;
+    quint64 shedCount() const;
+
+signals:
+    void messageReady(const ToxPk& friendPk, bool isAction, const QString& content);
+    void messageShed(const ToxPk& friendPk, bool isAction, const QString& content);
+
+private slots:
+    void drain();
+
+private:
+    struct QueuedMessage
+    {
+        bool isAction;
+        QString content;
+    };
+
+    int drainFriend(const ToxPk& friendPk, int budget);
+
+    QHash<ToxPk, QQueue<QueuedMessage>> queues;
+    ToxPk visibleFriend;
+    QTimer drainTimer;
+    size_t totalDepth = 0;
+    size_t maxDepth = 0;
+    quint64 shedTotal = 0;
+};
+
+#endif /* INBOUND_MSG_QUEUE_H */
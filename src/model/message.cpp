@@ -21,14 +21,69 @@
 #include "friend.h"
 #include "src/core/core.h"
 
+#include <QRegularExpression>
+
+namespace {
+// Word characters for the boundary checks around a mention; Unicode-aware so
+// non-ASCII nicknames get sane mention edges
+bool isWordChar(QChar c)
+{
+    return c.isLetterOrNumber() || c.isMark() || c == QLatin1Char('_');
+}
+} // namespace
+
 void MessageProcessor::SharedParams::onUserNameSet(const QString& username)
 {
     QString sanename = username;
     sanename.remove(QRegularExpression("[\\t\\n\\v\\f\\r\\x0000]"));
-    nameMention = QRegularExpression("\\b" + QRegularExpression::escape(username) + "\\b",
-                                     QRegularExpression::CaseInsensitiveOption);
-    sanitizedNameMention = QRegularExpression("\\b" + QRegularExpression::escape(sanename) + "\\b",
-                                              QRegularExpression::CaseInsensitiveOption);
+
+    // Compile the needles once per name change; each message is then one
+    // scan per distinct variant instead of a fresh regex evaluation
+    mentionNeedles.clear();
+    mentionNeedles.push_back(username.toCaseFolded());
+    const QString sanitized = sanename.toCaseFolded();
+    if (sanitized != mentionNeedles.front()) {
+        mentionNeedles.push_back(sanitized);
+    }
+}
+
+/**
+ * @brief Finds the first self mention in content with a linear scan
+ * @param[in] content message text to scan
+ * @param[out] mention filled with the match position when found
+ * @return True if a mention was found
+ *
+ * A match of the exact username anywhere in the message wins over the
+ * sanitized variant, matching the order the per-variant regexes ran in.
+ */
+bool MessageProcessor::SharedParams::findSelfMention(const QString& content,
+                                                     MessageMetadata& mention) const
+{
+    const QString folded = content.toCaseFolded();
+
+    for (const auto& needle : mentionNeedles) {
+        if (needle.isEmpty()) {
+            continue;
+        }
+
+        int from = 0;
+        while ((from = folded.indexOf(needle, from)) != -1) {
+            const int end = from + needle.size();
+            // a boundary is a word/non-word transition, as with the old \b
+            const bool boundaryBefore =
+                isWordChar(needle.at(0)) != (from > 0 && isWordChar(folded.at(from - 1)));
+            const bool boundaryAfter = isWordChar(needle.at(needle.size() - 1))
+                                       != (end < folded.size() && isWordChar(folded.at(end)));
+            if (boundaryBefore && boundaryAfter) {
+                mention = {MessageMetadataType::selfMention, static_cast<size_t>(from),
+                           static_cast<size_t>(end)};
+                return true;
+            }
+            ++from;
+        }
+    }
+
+    return false;
 }
 
 MessageProcessor::MessageProcessor(const MessageProcessor::SharedParams& sharedParams)
@@ -71,22 +126,9 @@ Message MessageProcessor::processIncomingMessage(bool isAction, QString const& m
     ret.timestamp = timestamp;
 
     if (detectingMentions) {
-        auto nameMention = sharedParams.GetNameMention();
-        auto sanitizedNameMention = sharedParams.GetSanitizedNameMention();
-
-        for (auto const& mention : {nameMention, sanitizedNameMention}) {
-            auto matchIt = mention.globalMatch(ret.content);
-            if (!matchIt.hasNext()) {
-                continue;
-            }
-
-            auto match = matchIt.next();
-
-            auto pos = static_cast<size_t>(match.capturedStart());
-            auto length = static_cast<size_t>(match.capturedLength());
-
-            ret.metadata.push_back({MessageMetadataType::selfMention, pos, pos + length});
-            break;
+        MessageMetadata mention{MessageMetadataType::selfMention, 0, 0};
+        if (sharedParams.findSelfMention(ret.content, mention)) {
+            ret.metadata.push_back(mention);
         }
     }
 
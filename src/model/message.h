@@ -21,7 +21,6 @@
 #define MESSAGE_H
 
 #include <QDateTime>
-#include <QRegularExpression>
 #include <QString>
 
 #include <vector>
@@ -67,19 +66,15 @@ public:
     {
 
     public:
-        QRegularExpression GetNameMention() const
-        {
-            return nameMention;
-        }
-        QRegularExpression GetSanitizedNameMention() const
-        {
-            return sanitizedNameMention;
-        }
         void onUserNameSet(const QString& username);
+        bool findSelfMention(const QString& content, MessageMetadata& mention) const;
 
     private:
-        QRegularExpression nameMention;
-        QRegularExpression sanitizedNameMention;
+        // Case-folded needles compiled from the username and its sanitized
+        // variant, so mention detection is a linear scan per message instead
+        // of a regex battery. The variants are usually identical and dedupe
+        // to a single needle.
+        std::vector<QString> mentionNeedles;
     };
 
     MessageProcessor(const SharedParams& sharedParams);
@@ -0,0 +1,111 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "parkedmessagerecorder.h"
+
+#include "src/core/core.h"
+#include "src/persistence/history.h"
+#include "src/persistence/profile.h"
+#include "src/persistence/settings.h"
+#include "src/widget/form/chatform.h"
+
+#include <QDateTime>
+
+/**
+ * @class ParkedMessageRecorder
+ * @brief Persists messages received by a parked profile.
+ *
+ * A parked profile's Core thread keeps iterating, so toxcore acknowledges
+ * incoming messages as delivered the moment they arrive; with the GUI-side
+ * dispatchers torn down, nothing else would record them and they would be
+ * lost while peers see them as read. This headless stand-in writes them
+ * straight to the profile's History - in the same format the dispatchers
+ * use, so unread counters and day counters are bumped too - and the rebuilt
+ * chat logs pick them up when the profile is resumed.
+ */
+ParkedMessageRecorder::ParkedMessageRecorder(Profile& profile, QObject* parent)
+    : QObject(parent)
+    , profile(profile)
+{
+    Core* core = profile.getCore();
+    connect(core, &Core::friendMessageReceived, this,
+            &ParkedMessageRecorder::onFriendMessageReceived);
+    connect(core, &Core::groupMessageReceived, this,
+            &ParkedMessageRecorder::onGroupMessageReceived);
+}
+
+void ParkedMessageRecorder::onFriendMessageReceived(uint32_t friendId, const QString& message,
+                                                    bool isAction)
+{
+    History* history = profile.getHistory();
+    if (!history) {
+        return;
+    }
+
+    Core* core = profile.getCore();
+    const QString friendPk = core->getFriendPublicKey(friendId).toString();
+    QString dispName = core->getFriendUsername(friendId);
+    if (dispName.isEmpty()) {
+        dispName = friendPk;
+    }
+
+    // Same storage format as ChatHistory::onMessageReceived()
+    QString content = message;
+    if (isAction) {
+        content = ChatForm::ACTION_PREFIX + content;
+    }
+
+    history->addNewMessage(friendPk, content, friendPk, QDateTime::currentDateTime(), true,
+                           dispName);
+}
+
+void ParkedMessageRecorder::onGroupMessageReceived(int groupnumber, int peernumber,
+                                                   const QString& message, bool isAction)
+{
+    History* history = profile.getHistory();
+    if (!history) {
+        return;
+    }
+
+    Core* core = profile.getCore();
+    const ToxPk sender = core->getGroupPeerPk(groupnumber, peernumber);
+    if (sender == core->getSelfPublicKey()) {
+        // our own messages echo back from the conference; there is no send
+        // path while parked, so nothing of ours needs storing here
+        return;
+    }
+
+    // mirror GroupMessageDispatcher's blacklist filtering
+    if (Settings::getInstance().getBlackList().contains(sender.toString())) {
+        return;
+    }
+
+    QString dispName = core->getGroupPeerName(groupnumber, peernumber);
+    if (dispName.isEmpty()) {
+        dispName = sender.toString();
+    }
+
+    QString content = message;
+    if (isAction) {
+        content = ChatForm::ACTION_PREFIX + content;
+    }
+
+    history->addNewMessage(core->getGroupPersistentId(groupnumber).toString(), content,
+                           sender.toString(), QDateTime::currentDateTime(), true, dispName);
+}
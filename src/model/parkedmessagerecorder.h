@@ -0,0 +1,45 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PARKEDMESSAGERECORDER_H
+#define PARKEDMESSAGERECORDER_H
+
+#include <QObject>
+#include <QString>
+
+#include <cstdint>
+
+class Profile;
+
+class ParkedMessageRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ParkedMessageRecorder(Profile& profile, QObject* parent = nullptr);
+
+private slots:
+    void onFriendMessageReceived(uint32_t friendId, const QString& message, bool isAction);
+    void onGroupMessageReceived(int groupnumber, int peernumber, const QString& message,
+                                bool isAction);
+
+private:
+    Profile& profile;
+};
+
+#endif // PARKEDMESSAGERECORDER_H
@@ -60,6 +60,7 @@ public:
 
 signals:
     void idChanged(const ToxId& id);
+    void rekeyProgressChanged(int percent);
     void usernameChanged(const QString& username);
     void statusMessageChanged(const QString& message);
 };
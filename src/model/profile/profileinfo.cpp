@@ -49,6 +49,7 @@ ProfileInfo::ProfileInfo(Core* core, Profile* profile)
     connect(core, &Core::idSet, this, &ProfileInfo::idChanged);
     connect(core, &Core::usernameSet, this, &ProfileInfo::usernameChanged);
     connect(core, &Core::statusMessageSet, this, &ProfileInfo::statusMessageChanged);
+    connect(profile, &Profile::rekeyProgressChanged, this, &ProfileInfo::rekeyProgressChanged);
 }
 
 /**
@@ -227,7 +228,7 @@ QStringList ProfileInfo::removeProfile()
 void ProfileInfo::logout()
 {
     // TODO(kriby): Refactor all of these invokeMethod calls with connect() properly when possible
-    Settings::getInstance().saveGlobal();
+    Settings::getInstance().scheduleSaveGlobal();
     QMetaObject::invokeMethod(&Nexus::getInstance(), "showLogin",
                               Q_ARG(QString, Settings::getInstance().getCurrentProfile()));
 }
@@ -19,6 +19,7 @@
 
 #include "sessionchatlog.h"
 #include "src/friendlist.h"
+#include "src/util/memoryregistry.h"
 
 #include <QDebug>
 #include <QtGlobal>
@@ -27,26 +28,15 @@
 namespace {
 
 /**
- * lower_bound needs two way comparisons. This adaptor allows us to compare
- * between a Message and QDateTime in both directions
+ * @brief The date an item sorts under; file transfers get an invalid date,
+ * matching how they were treated when this was a map lower_bound adaptor
  */
-struct MessageDateAdaptor
+QDate itemDate(const ChatLogItem& item)
 {
-    static const QDateTime invalidDateTime;
-    MessageDateAdaptor(const std::pair<const ChatLogIdx, ChatLogItem>& item)
-        : timestamp(item.second.getContentType() == ChatLogItem::ContentType::message
-                        ? item.second.getContentAsMessage().message.timestamp
-                        : invalidDateTime)
-    {}
-
-    MessageDateAdaptor(const QDateTime& timestamp)
-        : timestamp(timestamp)
-    {}
-
-    const QDateTime& timestamp;
-};
-
-const QDateTime MessageDateAdaptor::invalidDateTime;
+    return item.getContentType() == ChatLogItem::ContentType::message
+               ? item.getContentAsMessage().message.timestamp.date()
+               : QDate();
+}
 
 /**
  * @brief The search types all can be represented as some regular expression. This function
@@ -93,19 +83,51 @@ bool toxFileIsComplete(ToxFile::FileStatus status)
     }
 }
 
-std::map<ChatLogIdx, ChatLogItem>::const_iterator
-firstItemAfterDate(QDate date, const std::map<ChatLogIdx, ChatLogItem>& items)
+/**
+ * @brief Index of the first item on or after the given date, or endIdx() if
+ * there is none.
+ *
+ * A binary search over the flat index range; a probe landing on a hole scans
+ * forward to the next stored item before comparing.
+ */
+ChatLogIdx firstItemAfterDate(QDate date, const ChatLogStorage& items)
 {
-    return std::lower_bound(items.begin(), items.end(), QDateTime(date),
-                            [](const MessageDateAdaptor& a, MessageDateAdaptor const& b) {
-                                return a.timestamp.date() < b.timestamp.date();
-                            });
+    auto lo = items.firstIdx().get();
+    auto hi = items.endIdx().get();
+
+    while (lo < hi) {
+        const auto mid = lo + (hi - lo) / 2;
+
+        auto probe = mid;
+        const ChatLogItem* item = nullptr;
+        while (probe < hi && (item = items.find(ChatLogIdx(probe))) == nullptr) {
+            ++probe;
+        }
+
+        if (item == nullptr) {
+            // nothing but holes between mid and hi
+            hi = mid;
+        } else if (itemDate(*item) < date) {
+            lo = probe + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // the lower bound itself may sit on a hole
+    while (lo < items.endIdx().get() && items.find(ChatLogIdx(lo)) == nullptr) {
+        ++lo;
+    }
+
+    return ChatLogIdx(lo);
 }
 } // namespace
 
 SessionChatLog::SessionChatLog(const ICoreIdHandler& coreIdHandler)
     : coreIdHandler(coreIdHandler)
-{}
+{
+    registerMemorySampler();
+}
 
 /**
  * @brief Alternate constructor that allows for an initial index to be set
@@ -113,18 +135,35 @@ SessionChatLog::SessionChatLog(const ICoreIdHandler& coreIdHandler)
 SessionChatLog::SessionChatLog(ChatLogIdx initialIdx, const ICoreIdHandler& coreIdHandler)
     : coreIdHandler(coreIdHandler)
     , nextIdx(initialIdx)
-{}
+{
+    registerMemorySampler();
+}
+
+SessionChatLog::~SessionChatLog()
+{
+    MemoryRegistry::unregister(this);
+}
 
-SessionChatLog::~SessionChatLog() = default;
+void SessionChatLog::registerMemorySampler()
+{
+    // one entry per open chat; the items map is what grows over a long session
+    MemoryRegistry::registerSampler("session chat log",
+                                    [this]() {
+                                        return QString("%1 items, %2 undelivered")
+                                            .arg(items.size())
+                                            .arg(outgoingMessages.size());
+                                    },
+                                    this);
+}
 
 const ChatLogItem& SessionChatLog::at(ChatLogIdx idx) const
 {
-    auto item = items.find(idx);
-    if (item == items.end()) {
+    const ChatLogItem* item = items.find(idx);
+    if (item == nullptr) {
         std::terminate();
     }
 
-    return item->second;
+    return *item;
 }
 
 SearchResult SessionChatLog::searchForward(SearchPos startPos, const QString& phrase,
@@ -140,9 +179,15 @@ SearchResult SessionChatLog::searchForward(SearchPos startPos, const QString& ph
 
     auto regexp = getRegexpForPhrase(phrase, parameter.filter);
 
-    for (auto it = items.find(currentPos.logIdx); it != items.end(); ++it) {
-        const auto& key = it->first;
-        const auto& item = it->second;
+    // as with the old map find(), a start index that isn't loaded means
+    // there is nothing to walk
+    const bool haveStart = items.find(currentPos.logIdx) != nullptr;
+    for (auto key = currentPos.logIdx; haveStart && key < items.endIdx(); ++key) {
+        const ChatLogItem* itemPtr = items.find(key);
+        if (itemPtr == nullptr) {
+            continue;
+        }
+        const auto& item = *itemPtr;
 
         if (item.getContentType() != ChatLogItem::ContentType::message) {
             continue;
@@ -185,26 +230,26 @@ SearchResult SessionChatLog::searchBackward(SearchPos startPos, const QString& p
 {
     auto currentPos = startPos;
     auto regexp = getRegexpForPhrase(phrase, parameter.filter);
-    auto startIt = items.find(currentPos.logIdx);
-
-    // If we don't have it we'll start at the end
-    if (startIt == items.end()) {
-        if (items.empty()) {
-            SearchResult ret;
-            ret.found = false;
-            return ret;
-        }
-        startIt = std::prev(items.end());
-        startPos.numMatches = 0;
+
+    if (items.empty()) {
+        SearchResult ret;
+        ret.found = false;
+        return ret;
     }
 
-    // Off by 1 due to reverse_iterator api
-    auto rStartIt = std::reverse_iterator<decltype(startIt)>(std::next(startIt));
-    auto rEnd = std::reverse_iterator<decltype(startIt)>(items.begin());
+    // If we don't have the start index we'll start at the end
+    auto startIdx = currentPos.logIdx;
+    if (items.find(startIdx) == nullptr) {
+        startIdx = items.lastIdx();
+    }
 
-    for (auto it = rStartIt; it != rEnd; ++it) {
-        const auto& key = it->first;
-        const auto& item = it->second;
+    for (auto i = startIdx.get() + 1; i-- > items.firstIdx().get();) {
+        const auto key = ChatLogIdx(i);
+        const ChatLogItem* itemPtr = items.find(key);
+        if (itemPtr == nullptr) {
+            continue;
+        }
+        const auto& item = *itemPtr;
 
         if (item.getContentType() != ChatLogItem::ContentType::message) {
             continue;
@@ -253,7 +298,7 @@ ChatLogIdx SessionChatLog::getFirstIdx() const
         return nextIdx;
     }
 
-    return items.begin()->first;
+    return items.firstIdx();
 }
 
 ChatLogIdx SessionChatLog::getNextIdx() const
@@ -268,15 +313,15 @@ std::vector<IChatLog::DateChatLogIdxPair> SessionChatLog::getDateIdxs(const QDat
     auto dateIt = startDate;
 
     while (true) {
-        auto it = firstItemAfterDate(dateIt, items);
+        auto idx = firstItemAfterDate(dateIt, items);
 
-        if (it == items.end()) {
+        if (idx == items.endIdx()) {
             break;
         }
 
         DateChatLogIdxPair pair;
         pair.date = dateIt;
-        pair.idx = it->first;
+        pair.idx = idx;
 
         ret.push_back(std::move(pair));
 
@@ -317,6 +362,30 @@ void SessionChatLog::insertFileAtIdx(ChatLogIdx idx, ToxPk sender, QString sende
     items.emplace(idx, std::move(item));
 }
 
+/**
+ * @brief Drops items below newFirst from memory.
+ *
+ * The caller is responsible for being able to bring them back on demand, the
+ * way ChatHistory re-fetches from the db whenever an index below the first
+ * loaded one is requested. Undelivered outgoing messages and items with a
+ * running file transfer are never evicted, since their in-memory state can't
+ * be reconstructed; eviction stops below the oldest of them.
+ */
+void SessionChatLog::evictBefore(ChatLogIdx newFirst)
+{
+    auto keepFrom = newFirst;
+
+    for (const auto& idx : outgoingMessages) {
+        keepFrom = qMin(keepFrom, idx);
+    }
+
+    for (const auto& transfer : currentFileTransfers) {
+        keepFrom = qMin(keepFrom, transfer.idx);
+    }
+
+    items.trimFront(keepFrom);
+}
+
 /**
  * @brief Inserts message data into the chatlog buffer
  * @note Owner of SessionChatLog is in charge of attaching this to the appropriate IMessageDispatcher
@@ -365,16 +434,16 @@ void SessionChatLog::onMessageComplete(DispatchedMessageId id)
     }
 
     const auto& chatLogIdx = *chatLogIdxIt;
-    auto messageIt = items.find(chatLogIdx);
+    ChatLogItem* messageItem = items.find(chatLogIdx);
 
-    if (messageIt == items.end()) {
+    if (messageItem == nullptr) {
         qWarning() << "Failed to look up message in chat log";
         return;
     }
 
-    messageIt->second.getContentAsMessage().isComplete = true;
+    messageItem->getContentAsMessage().isComplete = true;
 
-    emit this->itemUpdated(messageIt->first);
+    emit this->itemUpdated(chatLogIdx);
 }
 
 /**
@@ -403,7 +472,7 @@ void SessionChatLog::onFileUpdated(const ToxPk& sender, const ToxFile& file)
         messageIdx = fileIt->idx;
         fileIt->file = file;
 
-        items.at(messageIdx).getContentAsFile().file = file;
+        items.find(messageIdx)->getContentAsFile().file = file;
     } else {
         // This may be a file unbroken message that we don't handle ATM
         return;
@@ -20,6 +20,7 @@
 #ifndef SESSION_CHAT_LOG_H
 #define SESSION_CHAT_LOG_H
 
+#include "chatlogstorage.h"
 #include "ichatlog.h"
 #include "imessagedispatcher.h"
 
@@ -49,6 +50,7 @@ public:
 
     void insertMessageAtIdx(ChatLogIdx idx, ToxPk sender, QString senderName, ChatLogMessage message);
     void insertFileAtIdx(ChatLogIdx idx, ToxPk sender, QString senderName, ChatLogFile file);
+    void evictBefore(ChatLogIdx newFirst);
 
 public slots:
     void onMessageReceived(const ToxPk& sender, const Message& message);
@@ -59,12 +61,15 @@ public slots:
     void onFileTransferRemotePausedUnpaused(const ToxPk& sender, const ToxFile& file, bool paused);
     void onFileTransferBrokenUnbroken(const ToxPk& sender, const ToxFile& file, bool broken);
 
+private:
+    void registerMemorySampler();
+
 private:
     const ICoreIdHandler& coreIdHandler;
 
     ChatLogIdx nextIdx = ChatLogIdx(0);
 
-    std::map<ChatLogIdx, ChatLogItem> items;
+    ChatLogStorage items;
 
     struct CurrentFileTransfer
     {
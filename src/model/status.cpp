@@ -21,6 +21,7 @@
 
 #include <QString>
 #include <QPixmap>
+#include <QPixmapCache>
 #include <QDebug>
 #include <QObject>
 
@@ -75,4 +76,24 @@ namespace Status
             return ":/img/status/" + statusSuffix + eventSuffix + ".svg";
         }
     }
+
+    /**
+     * @brief Returns the rendered status glyph, rasterizing it at most once
+     *
+     * Every roster row, tab and tray path used to rasterize the SVG again on
+     * each repaint; a status storm across a big roster made that add up. The
+     * rendered pixmaps are shared process-wide through QPixmapCache, keyed by
+     * the asset path.
+     */
+    QPixmap getIconPixmap(Status status, bool event)
+    {
+        const QString path = getIconPath(status, event);
+        QPixmap pixmap;
+        if (!QPixmapCache::find(path, &pixmap)) {
+            pixmap = QPixmap(path);
+            QPixmapCache::insert(path, pixmap);
+        }
+
+        return pixmap;
+    }
 } // namespace Status
@@ -36,6 +36,7 @@ namespace Status
     };
 
     QString getIconPath(Status status, bool event = false);
+    QPixmap getIconPixmap(Status status, bool event = false);
     QString getTitle(Status status);
     QString getAssetSuffix(Status status);
 }
@@ -22,19 +22,39 @@
 #include "src/core/core.h"
 #include "src/core/corefile.h"
 #include "src/model/status.h"
+#include "src/util/asynctask.h"
+#include <QCoreApplication>
 #include <QDebug>
+#include <QMutexLocker>
 #include <QObject>
+#include <QTimer>
 
 /**
  * @class AvatarBroadcaster
  *
  * Takes care of broadcasting avatar changes to our friends in a smart way
- * Cache a copy of our current avatar and friends who have received it
- * so we don't spam avatar transfers to a friend who already has it.
+ * Sends are queued and spread over time so a network flap with hundreds of
+ * friends coming online at once doesn't start hundreds of simultaneous
+ * avatar transfers, a cache of the hash each friend last received avoids
+ * resends, and the queue yields to the user's own file transfers.
  */
 
+QByteArray AvatarBroadcaster::pendingAvatarData;
 QByteArray AvatarBroadcaster::avatarData;
-QMap<uint32_t, bool> AvatarBroadcaster::friendsSentTo;
+QByteArray AvatarBroadcaster::avatarHash;
+QHash<QByteArray, QByteArray> AvatarBroadcaster::hashCache;
+uint64_t AvatarBroadcaster::hashGeneration = 0;
+QMap<uint32_t, QByteArray> AvatarBroadcaster::friendsSentHash;
+QList<uint32_t> AvatarBroadcaster::broadcastQueue;
+QMutex AvatarBroadcaster::queueLock;
+
+namespace {
+// one avatar transfer started per tick keeps the broadcast from competing
+// with itself or with real traffic
+constexpr int broadcastIntervalMs = 250;
+
+QTimer* broadcastTimer = nullptr;
+}
 
 static QMetaObject::Connection autoBroadcastConn;
 static auto autoBroadcast = [](uint32_t friendId, Status::Status) {
@@ -44,33 +64,133 @@ static auto autoBroadcast = [](uint32_t friendId, Status::Status) {
 /**
  * @brief Set our current avatar.
  * @param data Byte array on avater.
+ *
+ * The avatar digest is computed on a worker thread (or taken from the
+ * session hash cache); broadcasts queue up once it is ready, so neither the
+ * GUI nor the core thread ever runs the cryptographic hash.
  */
 void AvatarBroadcaster::setAvatar(QByteArray data)
 {
-    if (avatarData == data)
+    uint64_t generation;
+    {
+        QMutexLocker locker{&queueLock};
+        if (pendingAvatarData == data)
+            return;
+
+        pendingAvatarData = data;
+        generation = ++hashGeneration;
+
+        const auto cached = hashCache.constFind(data);
+        if (cached != hashCache.cend()) {
+            // data and hash are only ever published as a pair, so a queued
+            // broadcast can never send fresh data under a stale digest
+            avatarData = data;
+            avatarHash = cached.value();
+            generation = 0;
+        }
+    }
+
+    if (generation == 0) {
+        broadcastToAllFriends();
         return;
+    }
 
-    avatarData = data;
-    friendsSentTo.clear();
+    AsyncTask::runThen(QCoreApplication::instance(),
+                       [data] {
+                           uint8_t hash[TOX_HASH_LENGTH];
+                           tox_hash(hash, (uint8_t*)data.data(), data.size());
+                           return QByteArray(reinterpret_cast<const char*>(hash), TOX_HASH_LENGTH);
+                       },
+                       [data, generation](const QByteArray& hash) {
+                           {
+                               QMutexLocker locker{&queueLock};
+                               // a newer avatar may have superseded this digest
+                               if (generation != hashGeneration)
+                                   return;
+                               avatarData = data;
+                               avatarHash = hash;
+                               hashCache[data] = hash;
+                           }
+                           broadcastToAllFriends();
+                       });
+}
 
+void AvatarBroadcaster::broadcastToAllFriends()
+{
     QVector<uint32_t> friends = Core::getInstance()->getFriendList();
     for (uint32_t friendId : friends)
         sendAvatarTo(friendId);
 }
 
 /**
- * @brief Send our current avatar to this friend, if not already sent
+ * @brief Queue our current avatar for sending to this friend, if not already current there
  * @param friendId Id of friend to send avatar.
  */
 void AvatarBroadcaster::sendAvatarTo(uint32_t friendId)
 {
-    if (friendsSentTo.contains(friendId) && friendsSentTo[friendId])
-        return;
     if (!Core::getInstance()->isFriendOnline(friendId))
         return;
+
+    {
+        QMutexLocker locker{&queueLock};
+        if (friendsSentHash.contains(friendId) && friendsSentHash[friendId] == avatarHash)
+            return;
+        if (broadcastQueue.contains(friendId))
+            return;
+        broadcastQueue.append(friendId);
+
+        // the timer lives on the main thread; queue the start since this can
+        // be called from the core thread via the status-change connection
+        if (!broadcastTimer) {
+            broadcastTimer = new QTimer();
+            broadcastTimer->moveToThread(QCoreApplication::instance()->thread());
+            broadcastTimer->setInterval(broadcastIntervalMs);
+            QObject::connect(broadcastTimer, &QTimer::timeout,
+                             [] { AvatarBroadcaster::processBroadcastQueue(); });
+        }
+    }
+    QMetaObject::invokeMethod(broadcastTimer, "start", Qt::QueuedConnection);
+}
+
+/**
+ * @brief Starts at most one queued avatar transfer per timer tick.
+ *
+ * Skips the tick entirely while the user has a transfer of their own
+ * transmitting; avatars are the lowest-priority traffic there is.
+ */
+void AvatarBroadcaster::processBroadcastQueue()
+{
     CoreFile* coreFile = Core::getInstance()->getCoreFile();
-    coreFile->sendAvatarFile(friendId, avatarData);
-    friendsSentTo[friendId] = true;
+    if (coreFile->hasActiveUserTransfers())
+        return;
+
+    uint32_t friendId;
+    QByteArray data;
+    QByteArray hash;
+    {
+        QMutexLocker locker{&queueLock};
+        while (true) {
+            if (broadcastQueue.isEmpty()) {
+                broadcastTimer->stop();
+                return;
+            }
+            friendId = broadcastQueue.takeFirst();
+            // the friend may have gone offline or received this avatar by
+            // other means while queued
+            if (friendsSentHash.contains(friendId) && friendsSentHash[friendId] == avatarHash)
+                continue;
+            if (!Core::getInstance()->isFriendOnline(friendId))
+                continue;
+            break;
+        }
+        data = avatarData;
+        hash = avatarHash;
+        friendsSentHash[friendId] = avatarHash;
+        if (broadcastQueue.isEmpty())
+            broadcastTimer->stop();
+    }
+
+    coreFile->sendAvatarFile(friendId, data, hash);
 }
 
 /**
@@ -22,7 +22,12 @@
 #define AVATARBROADCASTER_H
 
 #include <QByteArray>
+#include <QHash>
+#include <QList>
 #include <QMap>
+#include <QMutex>
+
+#include <cstdint>
 
 class AvatarBroadcaster
 {
@@ -35,8 +40,25 @@ public:
     static void enableAutoBroadcast(bool state = true);
 
 private:
+    static void processBroadcastQueue();
+    static void broadcastToAllFriends();
+
+    // avatarData and avatarHash are published together once the digest is
+    // ready; pendingAvatarData holds the newest requested avatar meanwhile
+    static QByteArray pendingAvatarData;
     static QByteArray avatarData;
-    static QMap<uint32_t, bool> friendsSentTo;
+    static QByteArray avatarHash;
+    // digests of avatars hashed this session, keyed by content; switching
+    // back to a recent avatar skips the worker-thread hash entirely
+    static QHash<QByteArray, QByteArray> hashCache;
+    // bumped per setAvatar call so a digest computed for a superseded
+    // avatar is discarded instead of broadcast
+    static uint64_t hashGeneration;
+    // hash each friend last received from us; matches mean the friend's
+    // cached copy is already current and the send can be skipped
+    static QMap<uint32_t, QByteArray> friendsSentHash;
+    static QList<uint32_t> broadcastQueue;
+    static QMutex queueLock;
 };
 
 #endif // AVATARBROADCASTER_H
@@ -19,14 +19,24 @@
 
 #include "bootstrapnodeupdater.h"
 
+#include "src/persistence/settings.h"
+
+#include <QDateTime>
 #include <QDirIterator>
 #include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QRegularExpression>
+#include <QSaveFile>
+#include <QSettings>
+#include <QTimer>
+
+#include <algorithm>
 
 namespace {
 const QUrl NodeListAddress{"https://nodes.tox.chat/json"};
@@ -34,6 +44,37 @@ const QLatin1Literal jsonNodeArrayName{"nodes"};
 const QLatin1Literal emptyAddress{"-"};
 const QRegularExpression ToxPkRegEx(QString("(^|\\s)[A-Fa-f0-9]{%1}($|\\s)").arg(64));
 const QLatin1Literal builtinNodesFile{":/conf/nodes.json"};
+
+// nodes without recorded history rank here (ms), after historically fast
+// nodes but ahead of historically slow ones, so new entries still get tried
+constexpr qint64 unrankedConnectTime = 5000;
+
+QString nodeCachePath()
+{
+    return Settings::getInstance().getSettingsDirPath() + QStringLiteral("bootstrapNodes.ini");
+}
+
+QString nodeCacheKey(const DhtServer& node)
+{
+    return QStringLiteral("%1_%2").arg(node.address).arg(node.port);
+}
+
+// the builtin list is a resource and the downloaded one only changes from
+// the background refresh, so parse once; the lock doubles as the join point
+// when a prewarm on another thread is still parsing
+QMutex defaultNodesLock;
+bool defaultNodesParsed = false;
+QList<DhtServer> defaultNodesCache;
+
+// refresh cadence; the first check after startup is delayed so the fetch
+// never competes with profile load and bootstrap
+constexpr qint64 refreshIntervalMs = 24 * 60 * 60 * 1000;
+constexpr int firstRefreshDelayMs = 2 * 60 * 1000;
+
+QString downloadedNodesPath()
+{
+    return Settings::getInstance().getSettingsDirPath() + QStringLiteral("bootstrapNodes.json");
+}
 } // namespace
 
 namespace NodeFields {
@@ -56,25 +97,86 @@ const QStringList neededFields{status_udp, status_tcp, ipv4, ipv6, public_key, p
 BootstrapNodeUpdater::BootstrapNodeUpdater(const QNetworkProxy& proxy, QObject* parent)
     : QObject{parent}
     , proxy{proxy}
-{}
-
-void BootstrapNodeUpdater::requestBootstrapNodes()
 {
     nam.setProxy(proxy);
     connect(&nam, &QNetworkAccessManager::finished, this, &BootstrapNodeUpdater::onRequestComplete);
+}
 
+void BootstrapNodeUpdater::requestBootstrapNodes()
+{
     QNetworkRequest request{NodeListAddress};
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
 
+    // revalidate instead of re-downloading when the server list is unchanged
+    QSettings meta{nodeCachePath(), QSettings::IniFormat};
+    meta.beginGroup("NodeListMeta");
+    const QByteArray etag = meta.value("etag").toByteArray();
+    if (!etag.isEmpty() && QFile::exists(downloadedNodesPath())) {
+        request.setRawHeader("If-None-Match", etag);
+    }
+
     nam.get(request);
 }
 
+/**
+ * @brief Keeps the on-disk node list fresh without touching the startup path.
+ *
+ * The first check runs a couple of minutes after startup and only if the
+ * last successful check is older than the refresh interval; afterwards the
+ * list is revalidated once a day. By the time Core wants to bootstrap, the
+ * freshest known list is already on disk from a previous run.
+ */
+void BootstrapNodeUpdater::scheduleBackgroundRefresh()
+{
+    if (refreshTimer) {
+        return;
+    }
+
+    refreshTimer = new QTimer{this};
+    refreshTimer->setInterval(refreshIntervalMs);
+    connect(refreshTimer, &QTimer::timeout, this, &BootstrapNodeUpdater::refreshIfStale);
+    refreshTimer->start();
+
+    QTimer::singleShot(firstRefreshDelayMs, this, &BootstrapNodeUpdater::refreshIfStale);
+}
+
+void BootstrapNodeUpdater::refreshIfStale()
+{
+    QSettings meta{nodeCachePath(), QSettings::IniFormat};
+    meta.beginGroup("NodeListMeta");
+    const qint64 lastChecked = meta.value("lastChecked", 0).toLongLong();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (lastChecked != 0 && now - lastChecked < refreshIntervalMs) {
+        return;
+    }
+
+    requestBootstrapNodes();
+}
+
 /**
  * @brief Loads the list of built in boostrap nodes
  * @return List of bootstrapnodes on success, empty list on error
  */
 QList<DhtServer> BootstrapNodeUpdater::loadDefaultBootstrapNodes()
 {
+    QMutexLocker locker{&defaultNodesLock};
+    if (defaultNodesParsed) {
+        return defaultNodesCache;
+    }
+
+    // a list downloaded by the background refresh beats the builtin one
+    QFile downloaded{downloadedNodesPath()};
+    if (downloaded.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        const QJsonDocument d = QJsonDocument::fromJson(downloaded.readAll());
+        const QList<DhtServer> nodes = jsonToNodeList(d);
+        if (!nodes.isEmpty()) {
+            defaultNodesCache = nodes;
+            defaultNodesParsed = true;
+            return defaultNodesCache;
+        }
+        qWarning() << "Downloaded bootstrap node list is unusable, falling back to builtin";
+    }
+
     QFile nodesFile{builtinNodesFile};
     if (!nodesFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
         qWarning() << "Couldn't read bootstrap nodes";
@@ -89,19 +191,77 @@ QList<DhtServer> BootstrapNodeUpdater::loadDefaultBootstrapNodes()
         return {};
     }
 
-    return jsonToNodeList(d);
+    defaultNodesCache = jsonToNodeList(d);
+    defaultNodesParsed = true;
+    return defaultNodesCache;
+}
+
+/**
+ * @brief Orders nodes by their historical time-to-connect, fastest first.
+ *
+ * Nodes are shuffled before the sort so entries without history are tried in
+ * a different order every startup; the ranking keeps adapting instead of
+ * freezing on whatever worked once.
+ */
+QList<DhtServer> BootstrapNodeUpdater::rankNodes(QList<DhtServer> nodes)
+{
+    QSettings cache{nodeCachePath(), QSettings::IniFormat};
+    cache.beginGroup("ConnectTimes");
+
+    for (int i = nodes.size() - 1; i > 0; --i) {
+        qSwap(nodes[i], nodes[qrand() % (i + 1)]);
+    }
+    std::stable_sort(nodes.begin(), nodes.end(), [&cache](const DhtServer& a, const DhtServer& b) {
+        return cache.value(nodeCacheKey(a), unrankedConnectTime).toLongLong()
+               < cache.value(nodeCacheKey(b), unrankedConnectTime).toLongLong();
+    });
+    return nodes;
+}
+
+/**
+ * @brief Credits a successful connect to the nodes that were bootstrapped from.
+ *
+ * toxcore doesn't tell us which of the seeded nodes answered first, so the
+ * whole round shares the measured time-to-connect, smoothed so one lucky or
+ * congested connect doesn't dominate the ranking.
+ */
+void BootstrapNodeUpdater::reportConnectTime(const QList<DhtServer>& attempted, qint64 elapsedMs)
+{
+    QSettings cache{nodeCachePath(), QSettings::IniFormat};
+    cache.beginGroup("ConnectTimes");
+
+    for (const DhtServer& node : attempted) {
+        const QString key = nodeCacheKey(node);
+        const qint64 old = cache.value(key, elapsedMs).toLongLong();
+        cache.setValue(key, (3 * old + elapsedMs) / 4);
+    }
 }
 
 void BootstrapNodeUpdater::onRequestComplete(QNetworkReply* reply)
 {
+    reply->deleteLater();
+
+    QSettings meta{nodeCachePath(), QSettings::IniFormat};
+    meta.beginGroup("NodeListMeta");
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 304) {
+        // unchanged on the server, nothing to parse or write
+        meta.setValue("lastChecked", QDateTime::currentMSecsSinceEpoch());
+        emit availableBootstrapNodes(loadDefaultBootstrapNodes());
+        return;
+    }
+
     if (reply->error() != QNetworkReply::NoError) {
         nam.clearAccessCache();
         emit availableBootstrapNodes({});
         return;
     }
 
+    const QByteArray body = reply->readAll();
+
     // parse the reply JSON
-    QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
+    QJsonDocument jsonDocument = QJsonDocument::fromJson(body);
     if (jsonDocument.isNull()) {
         emit availableBootstrapNodes({});
         return;
@@ -109,6 +269,26 @@ void BootstrapNodeUpdater::onRequestComplete(QNetworkReply* reply)
 
     QList<DhtServer> result = jsonToNodeList(jsonDocument);
 
+    // persist only usable lists, and only when the content actually changed
+    if (!result.isEmpty()) {
+        QFile current{downloadedNodesPath()};
+        const bool changed = !current.open(QIODevice::ReadOnly) || current.readAll() != body;
+        if (changed) {
+            QSaveFile file{downloadedNodesPath()};
+            if (file.open(QIODevice::WriteOnly)) {
+                file.write(body);
+                file.commit();
+            }
+
+            QMutexLocker locker{&defaultNodesLock};
+            defaultNodesCache = result;
+            defaultNodesParsed = true;
+        }
+
+        meta.setValue("etag", reply->rawHeader("ETag"));
+        meta.setValue("lastChecked", QDateTime::currentMSecsSinceEpoch());
+    }
+
     emit availableBootstrapNodes(result);
 }
 
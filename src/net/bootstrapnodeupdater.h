@@ -10,19 +10,25 @@
 
 class QNetworkReply;
 
+class QTimer;
+
 class BootstrapNodeUpdater : public QObject
 {
     Q_OBJECT
 public:
     explicit BootstrapNodeUpdater(const QNetworkProxy& proxy, QObject* parent = nullptr);
     void requestBootstrapNodes();
+    void scheduleBackgroundRefresh();
     static QList<DhtServer> loadDefaultBootstrapNodes();
+    static QList<DhtServer> rankNodes(QList<DhtServer> nodes);
+    static void reportConnectTime(const QList<DhtServer>& attempted, qint64 elapsedMs);
 
 signals:
     void availableBootstrapNodes(QList<DhtServer> nodes);
 
 private slots:
     void onRequestComplete(QNetworkReply* reply);
+    void refreshIfStale();
 
 private:
     static QList<DhtServer> jsonToNodeList(const QJsonDocument& nodeList);
@@ -31,6 +37,7 @@ private:
 private:
     QNetworkProxy proxy;
     QNetworkAccessManager nam;
+    QTimer* refreshTimer = nullptr;
 };
 
 #endif // BOOTSTRAPNODEUPDATER_H
@@ -0,0 +1,91 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "toxmelookup.h"
+
+#include "src/net/toxme.h"
+#include "src/util/asynctask.h"
+
+#include <QDateTime>
+
+/**
+ * @class ToxmeLookupService
+ *
+ * Resolves Toxme addresses to Tox IDs without blocking the caller.
+ * Toxme::lookup itself is a synchronous HTTPS round-trip; this wrapper runs
+ * each lookup on the thread pool, so several addresses submitted in a row
+ * (e.g. a contact list import) resolve in parallel instead of serializing.
+ * Successful resolutions are kept in a short-lived cache, and pending
+ * results can be dropped when the input they were issued for changes.
+ *
+ * Must be used from a single thread; results are delivered on the thread
+ * owning the service.
+ */
+
+namespace {
+// published names rarely move between servers, so a resolution from a few
+// minutes ago is still good enough to skip the round-trip
+constexpr qint64 cacheTtlMs = 10 * 60 * 1000;
+} // namespace
+
+ToxmeLookupService::ToxmeLookupService(QObject* parent)
+    : QObject(parent)
+{
+}
+
+/**
+ * @brief Resolves an address, from cache if possible, and hands the result to done.
+ * @param address Toxme address, e.g. user@toxme.io.
+ * @param done Called on this object's thread with the resolved ID, which is
+ *             invalid if the lookup failed. Not called if the service is
+ *             destroyed or cancelPending is called before the result lands.
+ */
+void ToxmeLookupService::lookup(const QString& address, const std::function<void(const ToxId&)>& done)
+{
+    const auto cached = cache.constFind(address);
+    if (cached != cache.cend()
+        && QDateTime::currentMSecsSinceEpoch() - cached->resolvedAt < cacheTtlMs) {
+        done(cached->id);
+        return;
+    }
+
+    const uint64_t requestGeneration = generation;
+    AsyncTask::runThen(this, [address] { return Toxme::lookup(address); },
+                       [this, address, done, requestGeneration](const ToxId& id) {
+                           if (requestGeneration != generation) {
+                               // input changed while we were resolving; stale result
+                               return;
+                           }
+                           if (id.isValid()) {
+                               cache[address] = {id, QDateTime::currentMSecsSinceEpoch()};
+                           }
+                           done(id);
+                       });
+}
+
+/**
+ * @brief Drops the continuations of all lookups currently in flight.
+ *
+ * The network requests themselves run to completion on the pool, but their
+ * results are discarded instead of being delivered.
+ */
+void ToxmeLookupService::cancelPending()
+{
+    ++generation;
+}
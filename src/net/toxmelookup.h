@@ -0,0 +1,52 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TOXMELOOKUP_H
+#define TOXMELOOKUP_H
+
+#include "src/core/toxid.h"
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+#include <cstdint>
+#include <functional>
+
+class ToxmeLookupService : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ToxmeLookupService(QObject* parent = nullptr);
+
+    void lookup(const QString& address, const std::function<void(const ToxId&)>& done);
+    void cancelPending();
+
+private:
+    struct CacheEntry
+    {
+        ToxId id;
+        qint64 resolvedAt;
+    };
+
+    QHash<QString, CacheEntry> cache;
+    uint64_t generation = 0;
+};
+
+#endif // TOXMELOOKUP_H
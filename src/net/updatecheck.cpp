@@ -36,6 +36,20 @@
 #include <QTimer>
 #include <cassert>
 
+#include <QSettings>
+
+namespace {
+constexpr int checkIntervalMs = 1000 * 60 * 60 * 24; // 1 day
+constexpr int checkJitterMs = 1000 * 60 * 60;        // +- 1 hour
+
+// spread the daily checks of the installed base over a two hour window
+// instead of having every client re-check on its own fixed 24h beat
+int jitteredIntervalMs()
+{
+    return checkIntervalMs + qrand() % (2 * checkJitterMs) - checkJitterMs;
+}
+} // namespace
+
 #ifndef APPIMAGE_UPDATER_BRIDGE_ENABLED
 namespace {
 const QString versionUrl{QStringLiteral("https://api.github.com/repos/qTox/qTox/releases/latest")};
@@ -48,7 +62,7 @@ using AppImageUpdaterBridge::AppImageUpdaterDialog;
 UpdateCheck::UpdateCheck(const Settings& settings)
     : settings(settings)
 {
-    updateTimer.start(1000 * 60 * 60 * 24 /* 1 day */);
+    updateTimer.start(jitteredIntervalMs());
     connect(&updateTimer, &QTimer::timeout, this, &UpdateCheck::checkForUpdate);
 #ifndef APPIMAGE_UPDATER_BRIDGE_ENABLED
     connect(&manager, &QNetworkAccessManager::finished, this, &UpdateCheck::handleResponse);
@@ -73,8 +87,24 @@ void UpdateCheck::checkForUpdate()
         return;
     }
 #ifndef APPIMAGE_UPDATER_BRIDGE_ENABLED
+    // re-jitter every cycle so the fleet doesn't re-synchronize over time
+    updateTimer.setInterval(jitteredIntervalMs());
+
     manager.setProxy(settings.getProxy());
     QNetworkRequest request{versionUrl};
+
+    // revalidate the cached release metadata instead of re-downloading it
+    QSettings cache{settings.getAppCacheDirPath() + QStringLiteral("updatecheck.ini"),
+                    QSettings::IniFormat};
+    const QByteArray etag = cache.value("etag").toByteArray();
+    if (!etag.isEmpty()) {
+        request.setRawHeader("If-None-Match", etag);
+    }
+    const QByteArray lastModified = cache.value("lastModified").toByteArray();
+    if (!lastModified.isEmpty()) {
+        request.setRawHeader("If-Modified-Since", lastModified);
+    }
+
     manager.get(request);
 #else
     revisioner.clear();
@@ -96,6 +126,23 @@ void UpdateCheck::initUpdate()
 #endif
 
 #ifndef APPIMAGE_UPDATER_BRIDGE_ENABLED
+/**
+ * @brief Compares a release tag against the running build and emits the verdict.
+ */
+void UpdateCheck::announceVersion(const QString& latestVersion, const QUrl& link)
+{
+    // capture tag name to avoid showing update available on dev builds which include hash as part of describe
+    QRegularExpression versionFormat{QStringLiteral("v[0-9]+.[0-9]+.[0-9]+")};
+    QString curVer = versionFormat.match(GIT_DESCRIBE).captured(0);
+    if (latestVersion != curVer) {
+        qInfo() << "Update available to version" << latestVersion;
+        emit updateAvailable(latestVersion, link);
+    } else {
+        qInfo() << "qTox is up to date";
+        emit upToDate();
+    }
+}
+
 void UpdateCheck::handleResponse(QNetworkReply* reply)
 {
     assert(reply != nullptr);
@@ -104,6 +151,23 @@ void UpdateCheck::handleResponse(QNetworkReply* reply)
         return;
     }
 
+    QSettings cache{settings.getAppCacheDirPath() + QStringLiteral("updatecheck.ini"),
+                    QSettings::IniFormat};
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 304) {
+        // metadata unchanged on the server; answer from the cached copy
+        const QString latestVersion = cache.value("tagName").toString();
+        const QUrl link{cache.value("htmlUrl").toString()};
+        reply->deleteLater();
+        if (latestVersion.isEmpty()) {
+            emit updateCheckFailed();
+            return;
+        }
+        announceVersion(latestVersion, link);
+        return;
+    }
+
     if (reply->error() != QNetworkReply::NoError) {
         qWarning() << "Failed to check for update:" << reply->error();
         emit updateCheckFailed();
@@ -122,17 +186,14 @@ void UpdateCheck::handleResponse(QNetworkReply* reply)
         return;
     }
 
-    // capture tag name to avoid showing update available on dev builds which include hash as part of describe
-    QRegularExpression versionFormat{QStringLiteral("v[0-9]+.[0-9]+.[0-9]+")};
-    QString curVer = versionFormat.match(GIT_DESCRIBE).captured(0);
-    if (latestVersion != curVer) {
-        qInfo() << "Update available to version" << latestVersion;
-        QUrl link{mainMap["html_url"].toString()};
-        emit updateAvailable(latestVersion, link);
-    } else {
-        qInfo() << "qTox is up to date";
-        emit upToDate();
-    }
+    const QUrl link{mainMap["html_url"].toString()};
+
+    cache.setValue("etag", reply->rawHeader("ETag"));
+    cache.setValue("lastModified", reply->rawHeader("Last-Modified"));
+    cache.setValue("tagName", latestVersion);
+    cache.setValue("htmlUrl", link.toString());
+
+    announceVersion(latestVersion, link);
     reply->deleteLater();
 }
 #else
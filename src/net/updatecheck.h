@@ -40,6 +40,11 @@ public:
     UpdateCheck(const Settings& settings);
     void checkForUpdate();
 
+#ifndef APPIMAGE_UPDATER_BRIDGE_ENABLED
+private:
+    void announceVersion(const QString& latestVersion, const QUrl& link);
+#endif
+
 signals:
 #ifndef APPIMAGE_UPDATER_BRIDGE_ENABLED
     void updateAvailable(QString latestVersion, QUrl link);
@@ -23,16 +23,23 @@
 #include "src/core/core.h"
 #include "src/core/coreav.h"
 #include "src/model/groupinvite.h"
+#include "src/model/parkedmessagerecorder.h"
 #include "src/model/status.h"
+#include "src/net/bootstrapnodeupdater.h"
 #include "src/persistence/profile.h"
+#include "src/persistence/smileypack.h"
+#include "src/util/startupprofiler.h"
 #include "src/widget/widget.h"
+#include "video/cameradevice.h"
 #include "video/camerasource.h"
 #include "widget/gui.h"
 #include "widget/loginscreen.h"
 #include <QApplication>
 #include <QDebug>
 #include <QDesktopWidget>
+#include <QElapsedTimer>
 #include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
 #include <cassert>
 #include <src/audio/audio.h>
 #include <vpx/vpx_image.h>
@@ -68,6 +75,14 @@ Nexus::~Nexus()
     widget = nullptr;
     delete profile;
     profile = nullptr;
+    for (ParkedMessageRecorder* recorder : parkedRecorders) {
+        delete recorder;
+    }
+    parkedRecorders.clear();
+    for (Profile* parked : parkedProfiles) {
+        delete parked;
+    }
+    parkedProfiles.clear();
     emit saveGlobal();
 #ifdef Q_OS_MAC
     delete globalMenuBar;
@@ -86,6 +101,9 @@ void Nexus::start()
 
     // Setup the environment
     qRegisterMetaType<Status::Status>("Status::Status");
+    qRegisterMetaType<QVector<CoreFriendInfo>>("QVector<CoreFriendInfo>");
+    qRegisterMetaType<QVector<QPair<uint32_t, Status::Status>>>(
+        "QVector<QPair<uint32_t,Status::Status>>");
     qRegisterMetaType<vpx_image>("vpx_image");
     qRegisterMetaType<uint8_t>("uint8_t");
     qRegisterMetaType<uint16_t>("uint16_t");
@@ -106,6 +124,7 @@ void Nexus::start()
     qRegisterMetaType<GroupInvite>("GroupInvite");
     qRegisterMetaType<ReceiptNum>("ReceiptNum");
     qRegisterMetaType<RowId>("RowId");
+    qRegisterMetaType<CallStats>("CallStats");
 
     qApp->setQuitOnLastWindowClosed(false);
 
@@ -143,6 +162,30 @@ void Nexus::start()
     showMainGUI();
 }
 
+/**
+ * @brief Parks the active profile and returns to the login screen.
+ *
+ * Unlike a logout, the profile stays loaded and its Core thread keeps
+ * iterating, so the identity remains online; entering its name on the login
+ * screen resumes it instantly without key derivation or a toxcore restart.
+ * Multiple identities can be parked at once, sharing this process's thread
+ * pool, pixmap and smiley caches instead of each paying for a full instance.
+ * Since toxcore acknowledges incoming messages as soon as they arrive, a
+ * ParkedMessageRecorder stands in for the torn-down dispatchers and persists
+ * everything received while parked.
+ */
+void Nexus::switchProfile()
+{
+    if (profile) {
+        const QString name = profile->getName();
+        parkedProfiles[name] = profile;
+        parkedRecorders[name] = new ParkedMessageRecorder(*profile, this);
+        profile = nullptr;
+    }
+
+    showLogin();
+}
+
 /**
  * @brief Hides the main GUI, delete the profile, and shows the login screen
  */
@@ -173,9 +216,19 @@ void Nexus::bootstrapWithProfile(Profile* p)
     profile = p;
 
     if (profile) {
-        audioControl = std::unique_ptr<IAudioControl>(Audio::makeAudio(*settings));
-        assert(audioControl != nullptr);
+        // the audio backend and node list updater are per-process, resumed
+        // and freshly loaded profiles alike share them
+        if (!audioControl) {
+            audioControl = std::unique_ptr<IAudioControl>(Audio::makeAudio(*settings));
+            assert(audioControl != nullptr);
+        }
         profile->getCore()->getAv()->setAudio(*audioControl);
+        if (!nodeListUpdater) {
+            // keeps the on-disk bootstrap node list fresh; first check is
+            // delayed well past startup
+            nodeListUpdater.reset(new BootstrapNodeUpdater(settings->getProxy(), this));
+            nodeListUpdater->scheduleBackgroundRefresh();
+        }
         start();
     }
 }
@@ -219,10 +272,19 @@ void Nexus::showMainGUI()
     assert(profile);
 
     // Create GUI
+    QElapsedTimer startupPhase;
+    startupPhase.start();
+    StartupProfiler::startPhase("showMainGUI.createWidget");
     widget = new Widget(*audioControl);
+    StartupProfiler::endPhase("showMainGUI.createWidget");
+    qDebug() << "Created main widget in" << startupPhase.elapsed() << "ms";
 
     // Start GUI
+    startupPhase.restart();
+    StartupProfiler::startPhase("showMainGUI.initWidget");
     widget->init();
+    StartupProfiler::endPhase("showMainGUI.initWidget");
+    qDebug() << "Initialized main GUI in" << startupPhase.elapsed() << "ms";
     GUI::getInstance();
 
     // Zetok protection
@@ -290,8 +352,65 @@ Profile* Nexus::getProfile()
  * @param name New username
  * @param pass New password
  */
+/**
+ * @brief Declares one named startup stage and runs it on the thread pool.
+ * @param name Stage name, used by later stages to declare their dependencies.
+ * @param deps Stages that must finish first; they must be declared earlier.
+ *
+ * Stages with all dependencies met run concurrently, so the time from login
+ * to a usable window tends toward the longest single stage instead of the
+ * sum of all of them.
+ */
+void Nexus::addInitStage(const QString& name, const QStringList& deps,
+                         const std::function<void()>& work)
+{
+    QVector<QFuture<void>> depFutures;
+    for (const QString& dep : deps) {
+        assert(initStages.contains(dep));
+        depFutures.append(initStages[dep]);
+    }
+
+    initStages[name] = QtConcurrent::run([depFutures, work]() mutable {
+        for (QFuture<void>& dep : depFutures) {
+            dep.waitForFinished();
+        }
+        work();
+    });
+}
+
+/**
+ * @brief Kicks the profile-independent startup work before the profile loads.
+ *
+ * The profile load (key derivation, toxcore init, database open) is a strict
+ * sequence on this thread; everything that doesn't depend on it overlaps
+ * with it here instead of running lazily on first use later.
+ */
+void Nexus::startEarlyInitStages()
+{
+    if (!initStages.isEmpty()) {
+        return;
+    }
+
+    // the singleton must live on the GUI thread; constructing it only kicks
+    // its own background load, so this is cheap to do inline
+    SmileyPack::getInstance();
+
+    addInitStage(QStringLiteral("nodeList"), {}, [] {
+        // parse and cache the builtin node json now, so the Core thread's
+        // first bootstrap round picks up the cached list instead of parsing
+        BootstrapNodeUpdater::loadDefaultBootstrapNodes();
+    });
+
+    addInitStage(QStringLiteral("cameraProbe"), {}, [] {
+        // registers the avdevice input formats and enumerates devices once,
+        // so the first call or AV settings page doesn't pay for the probe
+        CameraDevice::getDeviceList();
+    });
+}
+
 void Nexus::onCreateNewProfile(const QString& name, const QString& pass)
 {
+    startEarlyInitStages();
     setProfile(Profile::createProfile(name, pass, *settings));
 }
 
@@ -300,6 +419,16 @@ void Nexus::onCreateNewProfile(const QString& name, const QString& pass)
  */
 void Nexus::onLoadProfile(const QString& name, const QString& pass)
 {
+    // A parked profile is still loaded and online, resume it as-is; the
+    // rebuilt chat logs take over from the recorder and load what it stored
+    Profile* parked = parkedProfiles.take(name);
+    if (parked) {
+        delete parkedRecorders.take(name);
+        setProfile(parked);
+        return;
+    }
+
+    startEarlyInitStages();
     setProfile(Profile::loadProfile(name, pass, *settings));
 }
 /**
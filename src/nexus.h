@@ -21,10 +21,17 @@
 #ifndef NEXUS_H
 #define NEXUS_H
 
+#include <QFuture>
+#include <QHash>
 #include <QObject>
+#include <QStringList>
+
+#include <functional>
 
 #include "src/audio/iaudiocontrol.h"
 
+class BootstrapNodeUpdater;
+class ParkedMessageRecorder;
 class Widget;
 class Profile;
 class Settings;
@@ -46,6 +53,7 @@ class Nexus : public QObject
 public:
     void start();
     void showMainGUI();
+    void startEarlyInitStages();
     void setSettings(Settings* settings);
     static Nexus& getInstance();
     static void destroyInstance();
@@ -89,19 +97,32 @@ public slots:
     void onCreateNewProfile(const QString& name, const QString& pass);
     void onLoadProfile(const QString& name, const QString& pass);
     int showLogin(const QString& profileName = QString());
+    void switchProfile();
     void bootstrapWithProfile(Profile *p);
 
 private:
     explicit Nexus(QObject* parent = nullptr);
     void connectLoginScreen(const LoginScreen& loginScreen);
     void setProfile(Profile* p);
+    void addInitStage(const QString& name, const QStringList& deps,
+                      const std::function<void()>& work);
     ~Nexus();
 
 private:
     Profile* profile;
+    // Profiles parked by switchProfile(), keyed by profile name. Their Core
+    // threads keep running (the identity stays online) while another profile
+    // owns the GUI; activating one again skips the whole load sequence.
+    QHash<QString, Profile*> parkedProfiles;
+    // One recorder per parked profile, persisting what its Core receives
+    // while no GUI-side dispatchers exist for it
+    QHash<QString, ParkedMessageRecorder*> parkedRecorders;
     Settings* settings;
     Widget* widget;
     std::unique_ptr<IAudioControl> audioControl;
+    std::unique_ptr<BootstrapNodeUpdater> nodeListUpdater;
+    // startup stages by name, so later stages can declare what they wait on
+    QHash<QString, QFuture<void>> initStages;
 };
 
 #endif // NEXUS_H
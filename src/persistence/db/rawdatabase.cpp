@@ -19,15 +19,77 @@
 
 #include "rawdatabase.h"
 
+#include "src/util/tracepoints.h"
+#include "src/util/workerpool.h"
+
 #include <cassert>
 #include <tox/toxencryptsave.h>
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
 #include <QMetaObject>
 #include <QMutexLocker>
 
+namespace {
+/**
+ * Context for the sqlite progress handler installed while a rekey export
+ * runs. Progress is estimated from the size of the temporary export file
+ * relative to the source database.
+ */
+struct RekeyProgressWatch
+{
+    QString tmpPath;
+    qint64 sourceSize;
+    const std::function<void(int)>* report;
+    QElapsedTimer throttle;
+    int lastPercent;
+};
+
+// invoked every few thousand VM opcodes while sqlcipher_export copies rows
+int rekeyProgressHandler(void* vwatch)
+{
+    auto* watch = static_cast<RekeyProgressWatch*>(vwatch);
+    if (watch->throttle.elapsed() < 200) {
+        return 0;
+    }
+    watch->throttle.restart();
+
+    const qint64 written = QFileInfo(watch->tmpPath).size();
+    const int percent =
+        watch->sourceSize > 0
+            ? static_cast<int>(qMin(qint64(99), written * 100 / watch->sourceSize))
+            : 0;
+    if (percent > watch->lastPercent) {
+        watch->lastPercent = percent;
+        (*watch->report)(percent);
+    }
+    return 0;
+}
+
+// Queries slower than this get logged with their anonymized SQL; override
+// with QTOX_DB_SLOW_QUERY_MS, 0 disables the log entirely
+int slowQueryThresholdMs()
+{
+    static const int thresholdMs = []() {
+        bool ok = false;
+        const int value = qEnvironmentVariableIntValue("QTOX_DB_SLOW_QUERY_MS", &ok);
+        return ok ? value : 250;
+    }();
+    return thresholdMs;
+}
+
+// with QTOX_DB_EXPLAIN set, slow queries also get their execution plan logged
+bool explainSlowQueries()
+{
+    static const bool enabled = qEnvironmentVariableIsSet("QTOX_DB_EXPLAIN");
+    return enabled;
+}
+} // namespace
+
 
 /**
  * @class RawDatabase
@@ -90,9 +152,11 @@ RawDatabase::RawDatabase(const QString& path, const QString& password, const QBy
     , currentSalt{salt} // we need the salt later if a new password should be set
     , currentHexKey{deriveKey(password, salt)}
 {
+    monotonicClock.start();
     workerThread->setObjectName("qTox Database");
     moveToThread(workerThread.get());
-    workerThread->start();
+    // chat view loads wait on these queries, but they must not crowd out AV
+    workerThread->start(WorkerPool::threadPriority(WorkerPool::Priority::Interactive));
 
     // first try with the new salt
     if (open(path, currentHexKey)) {
@@ -174,15 +238,39 @@ bool RawDatabase::open(const QString& path, const QString& hexKey)
         return false;
     }
 
+    if (sqlite3_create_function(sqlite, "decompress", 1, SQLITE_UTF8, nullptr, &RawDatabase::decompressText, nullptr, nullptr)) {
+        qWarning() << "Failed to create function decompress";
+        close();
+        return false;
+    }
+
+    cipherVersion = 0;
     if (!hexKey.isEmpty()) {
         if (!openEncryptedDatabaseAtLatestVersion(hexKey)) {
             close();
             return false;
         }
     }
+
+    if (!enableWal()) {
+        qWarning() << "Failed to enable write-ahead logging, continuing with rollback journal";
+    }
     return true;
 }
 
+/**
+ * @brief Switches the database to WAL journaling.
+ *
+ * WAL lets the worker thread commit without blocking readers and makes group
+ * commits much cheaper than the default rollback journal, since a commit only
+ * appends to the log instead of rewriting pages in place.
+ */
+bool RawDatabase::enableWal()
+{
+    return execNow("PRAGMA journal_mode = WAL;"
+                   "PRAGMA synchronous = NORMAL;");
+}
+
 bool RawDatabase::openEncryptedDatabaseAtLatestVersion(const QString& hexKey)
 {
     // old qTox database are saved with SQLCipher 3.x defaults. New qTox (and for a period during 1.16.3 master) are stored
@@ -195,14 +283,20 @@ bool RawDatabase::openEncryptedDatabaseAtLatestVersion(const QString& hexKey)
     if (setCipherParameters(4)) {
         if (testUsable()) {
             qInfo() << "Opened database with SQLCipher 4.x parameters";
+            cipherVersion = 4;
             return true;
         } else {
-            return updateSavedCipherParameters(hexKey);
+            if (updateSavedCipherParameters(hexKey)) {
+                cipherVersion = 4;
+                return true;
+            }
+            return false;
         }
     } else {
         // setKey again to clear old bad cipher settings
         if (setKey(hexKey) && setCipherParameters(3) && testUsable()) {
             qInfo() << "Opened database with SQLCipher 3.x parameters";
+            cipherVersion = 3;
             return true;
         } else {
             qCritical() << "Failed to open database with SQLCipher 3.x parameters";
@@ -253,7 +347,13 @@ bool RawDatabase::updateSavedCipherParameters(const QString& hexKey)
     return true;
 }
 
-bool RawDatabase::setCipherParameters(int majorVersion, const QString& database)
+/**
+ * @brief Builds the PRAGMA statements selecting a SQLCipher compatibility level.
+ * @param majorVersion SQLCipher major version whose defaults should be applied.
+ * @param database Optional name of an attached database to apply them to.
+ * @return PRAGMA statements, or a null string for unsupported versions.
+ */
+QString RawDatabase::cipherParamsStatements(int majorVersion, const QString& database)
 {
     QString prefix;
     if (!database.isNull()) {
@@ -279,11 +379,20 @@ bool RawDatabase::setCipherParameters(int majorVersion, const QString& database)
         }
         default: {
             qCritical() << __FUNCTION__ << "called with unsupported SQLCipher major version" << majorVersion;
-            return false;
+            return {};
         }
     }
-    qDebug() << "Setting SQLCipher 4.x parameters";
-    return execNow(defaultParams.replace("database.", prefix));
+    return defaultParams.replace("database.", prefix);
+}
+
+bool RawDatabase::setCipherParameters(int majorVersion, const QString& database)
+{
+    const QString defaultParams = cipherParamsStatements(majorVersion, database);
+    if (defaultParams.isNull()) {
+        return false;
+    }
+    qDebug() << "Setting SQLCipher parameters for major version" << majorVersion;
+    return execNow(defaultParams);
 }
 
 bool RawDatabase::setKey(const QString& hexKey)
@@ -319,6 +428,11 @@ void RawDatabase::close()
     // We assume we're in the ctor or dtor, so we just need to finish processing our transactions
     process();
 
+    // Cached statements keep the connection busy, release them before closing
+    statementCache.clear();
+
+    closeReadConnections();
+
     if (sqlite3_close(sqlite) == SQLITE_OK)
         sqlite = nullptr;
     else
@@ -374,6 +488,7 @@ bool RawDatabase::execNow(const QVector<RawDatabase::Query>& statements)
     trans.queries = statements;
     trans.done = &done;
     trans.success = &success;
+    trans.queuedAtMs = monotonicClock.elapsed();
     {
         QMutexLocker locker{&transactionsMutex};
         pendingTransactions.enqueue(trans);
@@ -388,6 +503,57 @@ bool RawDatabase::execNow(const QVector<RawDatabase::Query>& statements)
     return success.load(std::memory_order_acquire);
 }
 
+/**
+ * @brief Executes a read-only SQL transaction synchronously on a pooled connection.
+ * @param statement Statement to execute.
+ * @return Whether the transaction was successful.
+ */
+bool RawDatabase::execNowRead(const QString& statement)
+{
+    return execNowRead(Query{statement});
+}
+
+/**
+ * @brief Executes a read-only SQL transaction synchronously on a pooled connection.
+ * @param statement Statement to execute.
+ * @return Whether the transaction was successful.
+ */
+bool RawDatabase::execNowRead(const RawDatabase::Query& statement)
+{
+    return execNowRead(QVector<Query>{statement});
+}
+
+/**
+ * @brief Executes a read-only SQL transaction synchronously on a pooled connection.
+ * @param statements List of statements to execute.
+ * @return Whether the transaction was successful.
+ *
+ * With WAL enabled, reads run on read-only connections directly on the calling
+ * thread, so they never queue behind pending write transactions on the worker.
+ * The statements must not modify the database. Falls back to the worker thread
+ * when no read connection can be opened. Note that reads going through the
+ * pool see the last committed state, not writes still queued via execLater;
+ * callers needing read-your-writes should sync or use execNow instead.
+ */
+bool RawDatabase::execNowRead(const QVector<RawDatabase::Query>& statements)
+{
+    if (!sqlite) {
+        qWarning() << "Trying to exec, but the database is not open";
+        return false;
+    }
+
+    sqlite3* conn = acquireReadConnection();
+    if (!conn) {
+        return execNow(statements);
+    }
+
+    Transaction trans;
+    trans.queries = statements;
+    const bool success = executeTransactionOn(conn, trans, false, false);
+    releaseReadConnection(conn);
+    return success;
+}
+
 /**
  * @brief Executes a SQL transaction asynchronously.
  * @param statement Statement to execute.
@@ -411,12 +577,16 @@ void RawDatabase::execLater(const QVector<RawDatabase::Query>& statements)
 
     Transaction trans;
     trans.queries = statements;
+    trans.queuedAtMs = monotonicClock.elapsed();
     {
         QMutexLocker locker{&transactionsMutex};
         pendingTransactions.enqueue(trans);
     }
 
-    QMetaObject::invokeMethod(this, "process", Qt::QueuedConnection);
+    if (flushInterval.load(std::memory_order_relaxed) > 0)
+        QMetaObject::invokeMethod(this, "scheduleFlush", Qt::QueuedConnection);
+    else
+        QMetaObject::invokeMethod(this, "process", Qt::QueuedConnection);
 }
 
 /**
@@ -427,6 +597,212 @@ void RawDatabase::sync()
     QMetaObject::invokeMethod(this, "process", Qt::BlockingQueuedConnection);
 }
 
+/**
+ * @brief Requests a flush of all pending transactions without blocking.
+ * @param completionCallback Invoked on the worker thread once everything
+ * queued before this call has been committed.
+ */
+void RawDatabase::syncAsync(const std::function<void()>& completionCallback)
+{
+    // The marker rides the queue behind whatever is already pending
+    Transaction trans;
+    trans.syncCallback = completionCallback;
+    trans.queuedAtMs = monotonicClock.elapsed();
+    {
+        QMutexLocker locker{&transactionsMutex};
+        pendingTransactions.enqueue(trans);
+    }
+
+    QMetaObject::invokeMethod(this, "process", Qt::QueuedConnection);
+}
+
+/**
+ * @brief Waits for pending transactions with an upper bound on the wait.
+ * @param timeoutMs Maximum time to wait, negative waits forever.
+ * @return True if the queue drained in time, false on timeout.
+ *
+ * Suitable for shutdown paths on the GUI thread: on timeout the pending
+ * transactions are not lost, the worker still commits them before the
+ * database closes.
+ */
+bool RawDatabase::syncWait(int timeoutMs)
+{
+    // Shared so a late completion after timeout doesn't touch a dead flag
+    auto flushed = std::make_shared<std::atomic_bool>(false);
+    syncAsync([flushed] { flushed->store(true, std::memory_order_release); });
+
+    QElapsedTimer timer;
+    timer.start();
+    while (!flushed->load(std::memory_order_acquire)) {
+        if (timeoutMs >= 0 && timer.elapsed() >= timeoutMs) {
+            qWarning() << "Timed out waiting for the database queue to drain";
+            return false;
+        }
+        QThread::msleep(10);
+    }
+    return true;
+}
+
+/**
+ * @brief Sets the maximum delay before queued asynchronous transactions hit disk.
+ * @param ms Flush interval in milliseconds, 0 flushes on every execLater.
+ *
+ * A non-zero interval lets bursts of execLater calls accumulate so they are
+ * committed as a single group instead of one commit per call. execNow and
+ * sync are not delayed and still flush everything that is queued.
+ */
+void RawDatabase::setFlushInterval(int ms)
+{
+    flushInterval.store(ms, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Arms the flush timer so pending transactions are committed as a batch.
+ */
+void RawDatabase::scheduleFlush()
+{
+    assert(QThread::currentThread() == workerThread.get());
+
+    if (!flushTimer) {
+        flushTimer = new QTimer(this);
+        flushTimer->setSingleShot(true);
+        connect(flushTimer, &QTimer::timeout, this, &RawDatabase::process);
+    }
+
+    if (!flushTimer->isActive())
+        flushTimer->start(flushInterval.load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Reads the database size and fragmentation metrics.
+ * @return Page count, freelist length and page size of the database.
+ */
+RawDatabase::Stats RawDatabase::getStats()
+{
+    Stats stats;
+    execNow(QVector<Query>{
+        Query{"PRAGMA page_count;",
+              [&](const QVector<QVariant>& row) { stats.pageCount = row[0].toLongLong(); }},
+        Query{"PRAGMA freelist_count;",
+              [&](const QVector<QVariant>& row) { stats.freelistCount = row[0].toLongLong(); }},
+        Query{"PRAGMA page_size;",
+              [&](const QVector<QVariant>& row) { stats.pageSize = row[0].toLongLong(); }}});
+    return stats;
+}
+
+/**
+ * @brief Reads the queue and latency counters kept for the debug surface.
+ *
+ * Safe to call from any thread; the counters are plain snapshots and cost
+ * no database work.
+ */
+RawDatabase::QueueStats RawDatabase::getQueueStats()
+{
+    QueueStats stats;
+    stats.transactionsProcessed = transactionsProcessed.load(std::memory_order_relaxed);
+    stats.slowQueries = slowQueryCount.load(std::memory_order_relaxed);
+    stats.maxQueryMs = maxQueryMs.load(std::memory_order_relaxed);
+    stats.maxQueueLatencyMs = maxQueueLatencyMs.load(std::memory_order_relaxed);
+    {
+        QMutexLocker locker{&transactionsMutex};
+        stats.queueDepth = pendingTransactions.size();
+    }
+    return stats;
+}
+
+/**
+ * @brief Starts periodic background maintenance of the database.
+ * @param intervalMs Interval between maintenance attempts.
+ *
+ * Each round runs on the worker thread and is skipped entirely when
+ * transactions are pending, so maintenance only uses idle periods.
+ */
+void RawDatabase::scheduleMaintenance(int intervalMs)
+{
+    QMetaObject::invokeMethod(this, "startMaintenanceTimer", Qt::QueuedConnection,
+                              Q_ARG(int, intervalMs));
+}
+
+void RawDatabase::startMaintenanceTimer(int intervalMs)
+{
+    assert(QThread::currentThread() == workerThread.get());
+
+    if (!maintenanceTimer) {
+        maintenanceTimer = new QTimer(this);
+        connect(maintenanceTimer, &QTimer::timeout, this, &RawDatabase::runMaintenance);
+    }
+    maintenanceTimer->start(intervalMs);
+}
+
+/**
+ * @brief Runs one maintenance round: stats refresh and space reclamation.
+ *
+ * PRAGMA optimize re-analyzes whichever tables need it. A full VACUUM only
+ * runs once a quarter of the file consists of freelist pages, since it
+ * rewrites the whole database.
+ */
+void RawDatabase::runMaintenance()
+{
+    assert(QThread::currentThread() == workerThread.get());
+
+    if (!sqlite)
+        return;
+
+    {
+        QMutexLocker locker{&transactionsMutex};
+        if (!pendingTransactions.isEmpty())
+            return;
+    }
+
+    const Stats stats = getStats();
+    qDebug() << "Database maintenance:" << stats.pageCount << "pages,"
+             << stats.freelistCount << "on the freelist";
+
+    execNow("PRAGMA optimize;");
+
+    static constexpr int64_t MIN_VACUUM_PAGES = 1024;
+    if (stats.freelistCount >= MIN_VACUUM_PAGES && stats.freelistCount * 4 >= stats.pageCount) {
+        qDebug() << "Reclaiming" << stats.freelistCount * stats.pageSize << "bytes with VACUUM";
+        execNow("VACUUM;");
+    }
+}
+
+/**
+ * @brief Changes the database password without blocking the calling thread.
+ * @param password If password is empty, the database will be decrypted.
+ * @param completionCallback Invoked on the worker thread with the result.
+ * @param progressCallback Invoked on the worker thread with a 0-100 percent
+ * estimate while the re-encryption export runs.
+ *
+ * The caller's event loop keeps running while the worker re-encrypts, so
+ * the UI can repaint and report progress during multi-minute rekeys of
+ * large databases.
+ */
+void RawDatabase::setPasswordAsync(const QString& password,
+                                   const std::function<void(bool)>& completionCallback,
+                                   const std::function<void(int)>& progressCallback)
+{
+    Q_ASSERT(QThread::currentThread() != workerThread.get());
+
+    // at most one password change is in flight; the UI disables itself
+    // around the operation, so these members can't be clobbered mid-run
+    asyncRekeyDone = completionCallback;
+    rekeyProgressCallback = progressCallback;
+    QMetaObject::invokeMethod(this, "runAsyncPasswordChange", Qt::QueuedConnection,
+                              Q_ARG(const QString&, password));
+}
+
+void RawDatabase::runAsyncPasswordChange(const QString& password)
+{
+    const bool success = setPassword(password);
+    rekeyProgressCallback = {};
+    if (asyncRekeyDone) {
+        const auto done = asyncRekeyDone;
+        asyncRekeyDone = {};
+        done(success);
+    }
+}
+
 /**
  * @brief Changes the database password, encrypting or decrypting if necessary.
  * @param password If password is empty, the database will be decrypted.
@@ -456,31 +832,46 @@ bool RawDatabase::setPassword(const QString& password)
         QFile::remove(path + ".tmp");
     }
 
+    if (password.isEmpty() && currentHexKey.isEmpty()) {
+        return true;
+    }
+
+    RekeyProgressWatch watch{path + ".tmp", QFileInfo(path).size(), &rekeyProgressCallback, {}, 0};
+    if (rekeyProgressCallback) {
+        watch.throttle.start();
+        sqlite3_progress_handler(sqlite, 5000, rekeyProgressHandler, &watch);
+    }
+
+    // All transitions run through an export to a temporary database followed
+    // by an atomic swap, instead of an in-place PRAGMA rekey: the old
+    // database stays intact until the new one is complete, so a crash
+    // mid-rekey loses nothing, and open() already recovers a finished export
+    // that didn't get renamed.
+    bool success;
     if (!password.isEmpty()) {
         QString newHexKey = deriveKey(password, currentSalt);
-        if (!currentHexKey.isEmpty()) {
-            if (!execNow("PRAGMA rekey = \"x'" + newHexKey + "'\"")) {
-                qWarning() << "Failed to change encryption key";
-                close();
-                return false;
-            }
-        } else {
-            if (!encryptDatabase(newHexKey)) {
-                close();
-                return false;
-            }
+        success = encryptDatabase(newHexKey);
+        if (success) {
             currentHexKey = newHexKey;
         }
     } else {
-        if (currentHexKey.isEmpty())
-            return true;
+        success = decryptDatabase();
+    }
 
-        if (!decryptDatabase()) {
-            close();
-            return false;
+    // the swap reopened the database on success; only a failed export can
+    // leave the old connection (and its progress handler) behind
+    if (!success) {
+        if (sqlite) {
+            sqlite3_progress_handler(sqlite, 0, nullptr, nullptr);
         }
+        close();
+        return false;
     }
-    return true;
+
+    if (rekeyProgressCallback && success) {
+        rekeyProgressCallback(100);
+    }
+    return success;
 }
 
 bool RawDatabase::encryptDatabase(const QString& newHexKey)
@@ -619,6 +1010,30 @@ struct PassKeyDeleter
     }
 };
 
+namespace {
+QMutex keyCacheMutex;
+QHash<QByteArray, QString> derivedKeyCache;
+
+/**
+ * @brief Cache id for a (password, salt) pair that doesn't retain the password.
+ */
+QByteArray keyCacheId(const QByteArray& passData, const QByteArray& salt)
+{
+    return QCryptographicHash::hash(passData + salt, QCryptographicHash::Sha256);
+}
+} // namespace
+
+/**
+ * @brief Forgets all session-cached derived database keys.
+ *
+ * Call on logout so keys derived for this session don't outlive the profile.
+ */
+void RawDatabase::wipeKeyCache()
+{
+    QMutexLocker locker{&keyCacheMutex};
+    derivedKeyCache.clear();
+}
+
 /**
  * @brief Derives a 256bit key from the password and returns it hex-encoded
  * @param password Password to decrypt database
@@ -636,10 +1051,25 @@ QString RawDatabase::deriveKey(const QString& password)
 
     static const uint8_t expandConstant[TOX_PASS_SALT_LENGTH + 1] =
         "L'ignorance est le pire des maux";
+
+    const QByteArray cacheId =
+        keyCacheId(passData, QByteArray(reinterpret_cast<const char*>(expandConstant),
+                                        TOX_PASS_SALT_LENGTH));
+    {
+        QMutexLocker locker{&keyCacheMutex};
+        const auto cached = derivedKeyCache.constFind(cacheId);
+        if (cached != derivedKeyCache.constEnd())
+            return *cached;
+    }
+
     const std::unique_ptr<Tox_Pass_Key, PassKeyDeleter> key(tox_pass_key_derive_with_salt(
         reinterpret_cast<const uint8_t*>(passData.data()),
         static_cast<std::size_t>(passData.size()), expandConstant, nullptr));
-    return QByteArray(reinterpret_cast<char*>(key.get()) + 32, 32).toHex();
+    const QString hexKey = QByteArray(reinterpret_cast<char*>(key.get()) + 32, 32).toHex();
+
+    QMutexLocker locker{&keyCacheMutex};
+    derivedKeyCache[cacheId] = hexKey;
+    return hexKey;
 }
 
 /**
@@ -663,17 +1093,36 @@ QString RawDatabase::deriveKey(const QString& password, const QByteArray& salt)
 
     static_assert(TOX_PASS_KEY_LENGTH >= 32, "toxcore must provide 256bit or longer keys");
 
+    // The KDF dominates profile open latency, so within a session each
+    // (password, salt) pair is only ever derived once
+    const QByteArray cacheId = keyCacheId(passData, salt);
+    {
+        QMutexLocker locker{&keyCacheMutex};
+        const auto cached = derivedKeyCache.constFind(cacheId);
+        if (cached != derivedKeyCache.constEnd())
+            return *cached;
+    }
+
     const std::unique_ptr<Tox_Pass_Key, PassKeyDeleter> key(tox_pass_key_derive_with_salt(
         reinterpret_cast<const uint8_t*>(passData.data()),
         static_cast<std::size_t>(passData.size()),
         reinterpret_cast<const uint8_t*>(salt.constData()), nullptr));
-    return QByteArray(reinterpret_cast<char*>(key.get()) + 32, 32).toHex();
+    const QString hexKey = QByteArray(reinterpret_cast<char*>(key.get()) + 32, 32).toHex();
+
+    QMutexLocker locker{&keyCacheMutex};
+    derivedKeyCache[cacheId] = hexKey;
+    return hexKey;
 }
 
 /**
  * @brief Implements the actual processing of pending transactions.
  * Unqueues, compiles, binds and executes queries, then notifies of results
  *
+ * Consecutive fire-and-forget transactions are coalesced into a single group
+ * commit, so a storm of execLater calls pays for one fsync instead of one per
+ * transaction. Transactions whose result is observed through execNow are
+ * committed on their own so failures stay attributable to their caller.
+ *
  * @warning MUST only be called from the worker thread
  */
 void RawDatabase::process()
@@ -685,28 +1134,184 @@ void RawDatabase::process()
 
     forever
     {
-        // Fetch the next transaction
-        Transaction trans;
+        // Fetch the next batch of transactions to commit as a group
+        QVector<Transaction> batch;
         {
             QMutexLocker locker{&transactionsMutex};
             if (pendingTransactions.isEmpty())
                 return;
-            trans = pendingTransactions.dequeue();
+            batch.append(pendingTransactions.dequeue());
+            while (batch.first().success == nullptr && !pendingTransactions.isEmpty()
+                   && pendingTransactions.head().success == nullptr)
+                batch.append(pendingTransactions.dequeue());
+        }
+
+        QTOX_TRACE1(db_batch, batch.size());
+
+        // how long the batch sat behind earlier work is the clearest signal
+        // of the worker falling behind, so track the worst case
+        const qint64 dequeuedAtMs = monotonicClock.elapsed();
+        for (const Transaction& trans : batch) {
+            if (trans.queuedAtMs >= 0) {
+                const qint64 waitedMs = dequeuedAtMs - trans.queuedAtMs;
+                if (waitedMs > maxQueueLatencyMs.load(std::memory_order_relaxed))
+                    maxQueueLatencyMs.store(waitedMs, std::memory_order_relaxed);
+            }
+        }
+        transactionsProcessed.fetch_add(batch.size(), std::memory_order_relaxed);
+
+        const bool grouped = batch.size() > 1 && openGroupCommit();
+        bool groupSuccess = true;
+        for (Transaction& trans : batch) {
+            bool success;
+            if (grouped && openSavepoint()) {
+                // Each grouped transaction gets its own savepoint, so one
+                // failing doesn't discard the writes of the others - their
+                // callers already got their insert ids and a full rollback
+                // would leave the model layer pointing at rows that never
+                // committed
+                success = executeTransaction(trans, false);
+                closeSavepoint(success);
+            } else {
+                success = executeTransaction(trans, !grouped);
+                // Without a savepoint a failure can only be undone by
+                // rolling back the whole group
+                groupSuccess &= success;
+            }
+
+            // Grouped transactions have no observers, so signaling only
+            // happens on the individual path
+            if (trans.success != nullptr)
+                trans.success->store(success, std::memory_order_release);
+            if (trans.done != nullptr)
+                trans.done->store(true, std::memory_order_release);
         }
 
-        // In case we exit early, prepare to signal errors
-        if (trans.success != nullptr)
-            trans.success->store(false, std::memory_order_release);
+        if (grouped)
+            closeGroupCommit(groupSuccess);
 
-        // Add transaction commands if necessary
-        if (trans.queries.size() > 1) {
-            trans.queries.prepend({"BEGIN;"});
-            trans.queries.append({"COMMIT;"});
+        // Completion callbacks only fire once their batch has fully committed
+        for (Transaction& trans : batch) {
+            if (trans.syncCallback)
+                trans.syncCallback();
         }
+    }
+}
+
+/**
+ * @brief Opens an explicit transaction spanning multiple queued transactions.
+ * @return True if the group commit could be started.
+ */
+bool RawDatabase::openGroupCommit()
+{
+    if (sqlite3_exec(sqlite, "BEGIN;", nullptr, nullptr, nullptr) == SQLITE_OK)
+        return true;
+
+    qWarning() << "Failed to start group commit, falling back to individual commits";
+    return false;
+}
 
-        // Compile queries
+/**
+ * @brief Finishes a group commit, rolling back if any grouped transaction failed.
+ */
+void RawDatabase::closeGroupCommit(bool commit)
+{
+    const char* cmd = commit ? "COMMIT;" : "ROLLBACK;";
+    if (sqlite3_exec(sqlite, cmd, nullptr, nullptr, nullptr) != SQLITE_OK) {
+        qWarning() << "Failed to close group commit:" << sqlite3_errmsg(sqlite);
+        sqlite3_exec(sqlite, "ROLLBACK;", nullptr, nullptr, nullptr);
+    }
+}
+
+/**
+ * @brief Opens a savepoint around one transaction of an open group commit.
+ * @return True if the savepoint could be started.
+ */
+bool RawDatabase::openSavepoint()
+{
+    if (sqlite3_exec(sqlite, "SAVEPOINT grouped_trans;", nullptr, nullptr, nullptr) == SQLITE_OK)
+        return true;
+
+    qWarning() << "Failed to open savepoint:" << sqlite3_errmsg(sqlite);
+    return false;
+}
+
+/**
+ * @brief Closes a savepoint, undoing just its own transaction on failure.
+ */
+void RawDatabase::closeSavepoint(bool commit)
+{
+    if (!commit
+        && sqlite3_exec(sqlite, "ROLLBACK TO grouped_trans;", nullptr, nullptr, nullptr)
+               != SQLITE_OK) {
+        qWarning() << "Failed to roll back savepoint:" << sqlite3_errmsg(sqlite);
+    }
+
+    if (sqlite3_exec(sqlite, "RELEASE grouped_trans;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        qWarning() << "Failed to release savepoint:" << sqlite3_errmsg(sqlite);
+    }
+}
+
+/**
+ * @brief Compiles, binds and executes the queries of a single transaction.
+ * @param trans Transaction to execute.
+ * @param wrapInTransaction Whether multi-query transactions need their own
+ * BEGIN/COMMIT, false when an enclosing group commit is already open.
+ * @return Whether all queries executed successfully.
+ */
+bool RawDatabase::executeTransaction(Transaction& trans, bool wrapInTransaction)
+{
+    return executeTransactionOn(sqlite, trans, wrapInTransaction, true);
+}
+
+/**
+ * @brief Compiles, binds and executes a transaction on a given connection.
+ * @param conn Connection to execute on, either the worker connection or a
+ * pooled read-only one.
+ * @param cacheStatements Whether compiled statements may go through the
+ * prepared-statement cache. Must be false off the worker thread, the cache is
+ * not thread-safe and its statements belong to the worker connection.
+ * @return Whether all queries executed successfully.
+ */
+bool RawDatabase::executeTransactionOn(sqlite3* conn, Transaction& trans, bool wrapInTransaction,
+                                       bool cacheStatements)
+{
+    bool transactionSuccess = false;
+
+    // Add transaction commands if necessary
+    if (wrapInTransaction && trans.queries.size() > 1) {
+        trans.queries.prepend({"BEGIN;"});
+        trans.queries.append({"COMMIT;"});
+    }
+
+    {
+        // Compile queries, reusing cached statements for hot SQL when possible
         for (Query& query : trans.queries) {
             assert(query.statements.isEmpty());
+            if (cacheStatements && takeFromStatementCache(query)) {
+                // Bind our params to the reused statements
+                int curParam = 0;
+                for (sqlite3_stmt* stmt : query.statements) {
+                    int nParams = sqlite3_bind_parameter_count(stmt);
+                    if (query.blobs.size() < curParam + nParams) {
+                        qWarning() << "Not enough parameters to bind to query "
+                                   << anonymizeQuery(query.query);
+                        goto cleanupStatements;
+                    }
+                    for (int i = 0; i < nParams; ++i) {
+                        const QByteArray& blob = query.blobs[curParam + i];
+                        if (sqlite3_bind_blob(stmt, i + 1, blob.data(), blob.size(), SQLITE_STATIC)
+                            != SQLITE_OK) {
+                            qWarning() << "Failed to bind param" << curParam + i << "to query"
+                                       << anonymizeQuery(query.query);
+                            goto cleanupStatements;
+                        }
+                    }
+                    curParam += nParams;
+                }
+                continue;
+            }
+
             // sqlite3_prepare_v2 only compiles one statement at a time in the query,
             // we need to loop over them all
             int curParam = 0;
@@ -715,7 +1320,7 @@ void RawDatabase::process()
                 // Compile the next statement
                 sqlite3_stmt* stmt;
                 int r;
-                if ((r = sqlite3_prepare_v2(sqlite, compileTail,
+                if ((r = sqlite3_prepare_v2(conn, compileTail,
                                             query.query.size()
                                                 - static_cast<int>(compileTail - query.query.data()),
                                             &stmt, &compileTail))
@@ -748,6 +1353,8 @@ void RawDatabase::process()
 
         // Execute each statement of each query of our transaction
         for (Query& query : trans.queries) {
+            QElapsedTimer queryTimer;
+            queryTimer.start();
             for (sqlite3_stmt* stmt : query.statements) {
                 int column_count = sqlite3_column_count(stmt);
                 int result;
@@ -784,25 +1391,218 @@ void RawDatabase::process()
                 }
             }
 
+            recordQueryTime(conn, query, queryTimer.elapsed());
+
             if (query.insertCallback)
-                query.insertCallback(RowId{sqlite3_last_insert_rowid(sqlite)});
+                query.insertCallback(RowId{sqlite3_last_insert_rowid(conn)});
         }
 
-        if (trans.success != nullptr)
-            trans.success->store(true, std::memory_order_release);
+        transactionSuccess = true;
 
-    // Free our statements
+    // Recycle our statements into the cache, or free them on failure
     cleanupStatements:
-        for (Query& query : trans.queries) {
-            for (sqlite3_stmt* stmt : query.statements)
-                sqlite3_finalize(stmt);
-            query.statements.clear();
+        for (Query& query : trans.queries)
+            returnToStatementCache(query, transactionSuccess && cacheStatements);
+    }
+
+    return transactionSuccess;
+}
+
+/**
+ * @brief Updates the timing counters for an executed query and logs offenders.
+ *
+ * Queries over the slow threshold are logged anonymized, together with the
+ * current queue depth - a slow statement with a deep queue behind it is the
+ * signature of every "database thread fell behind" report we get.
+ */
+void RawDatabase::recordQueryTime(sqlite3* conn, const Query& query, qint64 elapsedMs)
+{
+    if (elapsedMs > maxQueryMs.load(std::memory_order_relaxed))
+        maxQueryMs.store(elapsedMs, std::memory_order_relaxed);
+
+    const int thresholdMs = slowQueryThresholdMs();
+    if (thresholdMs <= 0 || elapsedMs < thresholdMs)
+        return;
+
+    slowQueryCount.fetch_add(1, std::memory_order_relaxed);
+
+    int queueDepth;
+    {
+        QMutexLocker locker{&transactionsMutex};
+        queueDepth = pendingTransactions.size();
+    }
+    qWarning() << "Slow query:" << elapsedMs << "ms with" << queueDepth
+               << "transactions queued behind it:" << anonymizeQuery(query.query);
+
+    if (explainSlowQueries())
+        logQueryPlan(conn, query.query);
+}
+
+/**
+ * @brief Logs sqlite's EXPLAIN QUERY PLAN output for a slow query.
+ *
+ * Only the first statement of the query text gets explained, and parameters
+ * stay unbound - the chosen plan does not depend on their values.
+ */
+void RawDatabase::logQueryPlan(sqlite3* conn, const QByteArray& queryText)
+{
+    const QByteArray explainText = QByteArrayLiteral("EXPLAIN QUERY PLAN ") + queryText;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(conn, explainText.data(), explainText.size(), &stmt, nullptr)
+        != SQLITE_OK) {
+        return;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        qWarning().noquote() << "  plan:"
+                             << QString::fromUtf8(reinterpret_cast<const char*>(
+                                    sqlite3_column_text(stmt, 3)));
+    }
+    sqlite3_finalize(stmt);
+}
+
+/**
+ * @brief Tries to satisfy a query's statements from the prepared-statement cache.
+ * @param query Query to fill, its statements must be empty.
+ * @return True if cached statements were found for the query's SQL text.
+ */
+bool RawDatabase::takeFromStatementCache(Query& query)
+{
+    CachedStatements* cached = statementCache.take(query.query);
+    if (!cached)
+        return false;
+
+    query.statements = cached->statements;
+    cached->statements.clear();
+    delete cached;
+    return true;
+}
+
+/**
+ * @brief Puts a query's compiled statements back into the cache for reuse.
+ * @param query Executed query whose statements should be recycled.
+ * @param reusable False if execution failed, in which case the statements are
+ * finalized instead of cached.
+ */
+void RawDatabase::returnToStatementCache(Query& query, bool reusable)
+{
+    if (query.statements.isEmpty())
+        return;
+
+    if (!reusable) {
+        for (sqlite3_stmt* stmt : query.statements)
+            sqlite3_finalize(stmt);
+        query.statements.clear();
+        return;
+    }
+
+    for (sqlite3_stmt* stmt : query.statements) {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+
+    // The cache takes ownership and finalizes on eviction
+    statementCache.insert(query.query, new CachedStatements{query.statements});
+    query.statements.clear();
+}
+
+/**
+ * @brief Takes an idle read-only connection from the pool, opening one if needed.
+ * @return Connection to execute on, or nullptr if none could be opened.
+ */
+sqlite3* RawDatabase::acquireReadConnection()
+{
+    {
+        QMutexLocker locker{&readPoolMutex};
+        if (!idleReadConnections.isEmpty())
+            return idleReadConnections.takeLast();
+
+        static constexpr int MAX_READ_CONNECTIONS = 4;
+        if (openedReadConnections >= MAX_READ_CONNECTIONS)
+            return nullptr;
+        ++openedReadConnections;
+    }
+
+    sqlite3* conn = openReadConnection();
+    if (!conn) {
+        QMutexLocker locker{&readPoolMutex};
+        --openedReadConnections;
+    }
+    return conn;
+}
+
+/**
+ * @brief Returns a read connection to the pool for reuse.
+ */
+void RawDatabase::releaseReadConnection(sqlite3* conn)
+{
+    QMutexLocker locker{&readPoolMutex};
+    idleReadConnections.append(conn);
+}
+
+/**
+ * @brief Opens a read-only connection to the current database file.
+ * @return New connection, or nullptr on failure.
+ */
+sqlite3* RawDatabase::openReadConnection()
+{
+    sqlite3* conn;
+    if (sqlite3_open_v2(path.toUtf8().data(), &conn, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX,
+                        nullptr)
+        != SQLITE_OK) {
+        qWarning() << "Failed to open read connection to" << path << "with error:"
+                   << sqlite3_errmsg(conn);
+        sqlite3_close(conn);
+        return nullptr;
+    }
+
+    // Search queries may run through the pool, so it needs the same extensions
+    if (sqlite3_create_function(conn, "regexp", 2, SQLITE_UTF8, nullptr,
+                                &RawDatabase::regexpInsensitive, nullptr, nullptr)
+        || sqlite3_create_function(conn, "regexpsensitive", 2, SQLITE_UTF8, nullptr,
+                                   &RawDatabase::regexpSensitive, nullptr, nullptr)
+        || sqlite3_create_function(conn, "decompress", 1, SQLITE_UTF8, nullptr,
+                                   &RawDatabase::decompressText, nullptr, nullptr)) {
+        qWarning() << "Failed to create SQL functions on read connection";
+        sqlite3_close(conn);
+        return nullptr;
+    }
+
+    if (!currentHexKey.isEmpty()) {
+        const QByteArray keyStatement =
+            ("PRAGMA key = \"x'" + currentHexKey + "'\";"
+             + cipherParamsStatements(cipherVersion))
+                .toUtf8();
+        if (sqlite3_exec(conn, keyStatement.data(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+            qWarning() << "Failed to key read connection:" << sqlite3_errmsg(conn);
+            sqlite3_close(conn);
+            return nullptr;
         }
+    }
 
-        // Signal transaction results
-        if (trans.done != nullptr)
-            trans.done->store(true, std::memory_order_release);
+    if (sqlite3_exec(conn, "SELECT count(*) FROM sqlite_master;", nullptr, nullptr, nullptr)
+        != SQLITE_OK) {
+        qWarning() << "Read connection is not usable:" << sqlite3_errmsg(conn);
+        sqlite3_close(conn);
+        return nullptr;
     }
+
+    return conn;
+}
+
+/**
+ * @brief Closes all pooled read connections.
+ *
+ * Must not race with in-flight reads, callers of close() already guarantee
+ * that by tearing down the profile before closing the database.
+ */
+void RawDatabase::closeReadConnections()
+{
+    QMutexLocker locker{&readPoolMutex};
+    for (sqlite3* conn : idleReadConnections)
+        sqlite3_close(conn);
+    openedReadConnections -= idleReadConnections.size();
+    idleReadConnections.clear();
 }
 
 /**
@@ -867,6 +1667,30 @@ void RawDatabase::regexpSensitive(sqlite3_context* ctx, int argc, sqlite3_value*
     regexp(ctx, argc, argv, QRegularExpression::UseUnicodePropertiesOption);
 }
 
+/**
+ * @brief SQL function returning a stored text column as plain text.
+ *
+ * Message bodies may be stored zlib-compressed behind a 0xFF marker byte
+ * (see History); plain values pass through untouched, so the function is
+ * safe to wrap around any mix of old and new rows.
+ * @param ctx the context in which an SQL function executes
+ * @param argc number of arguments
+ * @param argv arguments
+ */
+void RawDatabase::decompressText(sqlite3_context* ctx, int argc, sqlite3_value** argv)
+{
+    Q_UNUSED(argc);
+    const int size = sqlite3_value_bytes(argv[0]);
+    const auto* data = static_cast<const unsigned char*>(sqlite3_value_blob(argv[0]));
+    if (size < 1 || !data || data[0] != 0xFF) {
+        sqlite3_result_value(ctx, argv[0]);
+        return;
+    }
+
+    const QByteArray plain = qUncompress(data + 1, size - 1);
+    sqlite3_result_text(ctx, plain.constData(), plain.size(), SQLITE_TRANSIENT);
+}
+
 void RawDatabase::regexp(sqlite3_context* ctx, int argc, sqlite3_value** argv, const QRegularExpression::PatternOptions cs)
 {
     QRegularExpression regex;
@@ -21,11 +21,14 @@
 #define RAWDATABASE_H
 
 #include <QByteArray>
+#include <QCache>
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QPair>
 #include <QQueue>
 #include <QString>
 #include <QThread>
+#include <QTimer>
 #include <QVariant>
 #include <QVector>
 #include <QRegularExpression>
@@ -81,6 +84,25 @@ public:
         friend class RawDatabase;
     };
 
+public:
+    /// Database health metrics, see getStats()
+    struct Stats
+    {
+        int64_t pageCount = 0;
+        int64_t freelistCount = 0;
+        int64_t pageSize = 0;
+    };
+
+    /// Queue and latency counters for the debug surface, see getQueueStats()
+    struct QueueStats
+    {
+        uint64_t transactionsProcessed = 0;
+        uint64_t slowQueries = 0;
+        int64_t maxQueryMs = 0;
+        int64_t maxQueueLatencyMs = 0;
+        int queueDepth = 0;
+    };
+
 public:
     RawDatabase(const QString& path, const QString& password, const QByteArray& salt);
     ~RawDatabase();
@@ -90,11 +112,28 @@ public:
     bool execNow(const Query& statement);
     bool execNow(const QVector<Query>& statements);
 
+    bool execNowRead(const QString& statement);
+    bool execNowRead(const Query& statement);
+    bool execNowRead(const QVector<Query>& statements);
+
     void execLater(const QString& statement);
     void execLater(const Query& statement);
     void execLater(const QVector<Query>& statements);
 
     void sync();
+    void syncAsync(const std::function<void()>& completionCallback = {});
+    void setPasswordAsync(const QString& password,
+                          const std::function<void(bool)>& completionCallback,
+                          const std::function<void(int)>& progressCallback = {});
+    bool syncWait(int timeoutMs);
+
+    void setFlushInterval(int ms);
+
+    Stats getStats();
+    QueueStats getQueueStats();
+    void scheduleMaintenance(int intervalMs);
+
+    static void wipeKeyCache();
 
 public slots:
     bool setPassword(const QString& password);
@@ -103,11 +142,17 @@ public slots:
 
 protected slots:
     bool open(const QString& path, const QString& hexKey = {});
+    void runAsyncPasswordChange(const QString& password);
     void close();
     void process();
+    void scheduleFlush();
+    void startMaintenanceTimer(int intervalMs);
+    void runMaintenance();
 
 private:
     QString anonymizeQuery(const QByteArray& query);
+    bool enableWal();
+    static QString cipherParamsStatements(int majorVersion, const QString& database = {});
     bool openEncryptedDatabaseAtLatestVersion(const QString& hexKey);
     bool updateSavedCipherParameters(const QString& hexKey);
     bool setCipherParameters(int majorVersion, const QString& database = {});
@@ -124,6 +169,7 @@ protected:
     static QVariant extractData(sqlite3_stmt* stmt, int col);
     static void regexpInsensitive(sqlite3_context* ctx, int argc, sqlite3_value** argv);
     static void regexpSensitive(sqlite3_context* ctx, int argc, sqlite3_value** argv);
+    static void decompressText(sqlite3_context* ctx, int argc, sqlite3_value** argv);
 
 private:
     static void regexp(sqlite3_context* ctx, int argc, sqlite3_value** argv, const QRegularExpression::PatternOptions cs);
@@ -133,8 +179,47 @@ private:
         QVector<Query> queries;
         std::atomic_bool* success = nullptr;
         std::atomic_bool* done = nullptr;
+        /// Invoked on the worker thread once everything queued before it committed
+        std::function<void()> syncCallback;
+        /// When the transaction entered the queue, for the latency counters
+        qint64 queuedAtMs = -1;
+    };
+
+    /**
+     * @brief Compiled statements of a query, finalized on destruction.
+     *
+     * Used as QCache payload, so evicting an entry releases its statements.
+     */
+    struct CachedStatements
+    {
+        explicit CachedStatements(QVector<sqlite3_stmt*> statements)
+            : statements{statements}
+        {
+        }
+        ~CachedStatements()
+        {
+            for (sqlite3_stmt* stmt : statements)
+                sqlite3_finalize(stmt);
+        }
+        QVector<sqlite3_stmt*> statements;
     };
 
+    bool executeTransaction(Transaction& trans, bool wrapInTransaction);
+    bool executeTransactionOn(sqlite3* conn, Transaction& trans, bool wrapInTransaction,
+                              bool cacheStatements);
+    bool openGroupCommit();
+    void closeGroupCommit(bool commit);
+    bool openSavepoint();
+    void closeSavepoint(bool commit);
+    bool takeFromStatementCache(Query& query);
+    void returnToStatementCache(Query& query, bool reusable);
+    void logQueryPlan(sqlite3* conn, const QByteArray& queryText);
+    void recordQueryTime(sqlite3* conn, const Query& query, qint64 elapsedMs);
+    sqlite3* acquireReadConnection();
+    void releaseReadConnection(sqlite3* conn);
+    sqlite3* openReadConnection();
+    void closeReadConnections();
+
 private:
     sqlite3* sqlite;
     std::unique_ptr<QThread> workerThread;
@@ -143,6 +228,25 @@ private:
     QString path;
     QByteArray currentSalt;
     QString currentHexKey;
+    QTimer* flushTimer = nullptr;
+    QTimer* maintenanceTimer = nullptr;
+    std::atomic_int flushInterval{0};
+    QCache<QByteArray, CachedStatements> statementCache{64};
+    // callbacks of the in-flight setPasswordAsync call, invoked on the
+    // worker thread; at most one password change runs at a time
+    std::function<void(bool)> asyncRekeyDone;
+    std::function<void(int)> rekeyProgressCallback;
+    QMutex readPoolMutex;
+    QVector<sqlite3*> idleReadConnections;
+    int openedReadConnections = 0;
+    int cipherVersion = 0;
+    // observability counters, written wherever transactions execute and
+    // read from the debug surface via getQueueStats()
+    QElapsedTimer monotonicClock;
+    std::atomic<uint64_t> transactionsProcessed{0};
+    std::atomic<uint64_t> slowQueryCount{0};
+    std::atomic<int64_t> maxQueryMs{0};
+    std::atomic<int64_t> maxQueueLatencyMs{0};
 };
 
 #endif // RAWDATABASE_H
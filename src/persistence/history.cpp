@@ -18,15 +18,22 @@
 */
 
 #include <QDebug>
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QCoreApplication>
+#include <QRegularExpression>
+#include <QTimer>
 #include <cassert>
 
 #include "history.h"
 #include "profile.h"
 #include "settings.h"
+#include "src/util/memoryregistry.h"
 #include "db/rawdatabase.h"
 
 namespace {
-static constexpr int SCHEMA_VERSION = 1;
+static constexpr int SCHEMA_VERSION = 7;
 
 void generateCurrentSchema(QVector<RawDatabase::Query>& queries)
 {
@@ -59,8 +66,30 @@ void generateCurrentSchema(QVector<RawDatabase::Query>& queries)
         "file_hash BLOB NOT NULL, "
         "file_size INTEGER NOT NULL, "
         "direction INTEGER NOT NULL, "
-        "file_state INTEGER NOT NULL);"
-        "CREATE TABLE faux_offline_pending (id INTEGER PRIMARY KEY);"));
+        "file_state INTEGER NOT NULL, "
+        "completed_bytes INTEGER NOT NULL DEFAULT 0, "
+        "timestamp INTEGER NOT NULL DEFAULT 0);"
+        "CREATE TABLE faux_offline_pending (id INTEGER PRIMARY KEY);"
+        "CREATE TABLE message_urls "
+        "(id INTEGER PRIMARY KEY, "
+        "chat_id INTEGER NOT NULL, "
+        "history_id INTEGER NOT NULL, "
+        "timestamp INTEGER NOT NULL, "
+        "url TEXT NOT NULL);"
+        "CREATE TABLE chat_read_state "
+        "(chat_id INTEGER PRIMARY KEY, "
+        "last_read_id INTEGER NOT NULL DEFAULT 0, "
+        "unread_count INTEGER NOT NULL DEFAULT 0);"
+        "CREATE TABLE chat_day_counts "
+        "(chat_id INTEGER NOT NULL, "
+        "day INTEGER NOT NULL, "
+        "count INTEGER NOT NULL DEFAULT 0, "
+        "PRIMARY KEY (chat_id, day));"
+        "CREATE INDEX chat_id_idx ON history (chat_id, id);"
+        "CREATE INDEX message_urls_chat_idx ON message_urls (chat_id, timestamp, url);"
+        "CREATE INDEX file_transfers_chat_idx ON file_transfers (chat_id, id);"
+        "CREATE INDEX file_transfers_browser_idx ON file_transfers "
+        "(timestamp, chat_id, file_size, direction, file_state, file_name, file_path);"));
 }
 
 bool isNewDb(std::shared_ptr<RawDatabase> db)
@@ -94,10 +123,111 @@ void dbSchema0to1(std::shared_ptr<RawDatabase> db, QVector<RawDatabase::Query>&
         RawDatabase::Query(QStringLiteral("ALTER TABLE history ADD file_id INTEGER;"));
 }
 
+void dbSchema1to2(QVector<RawDatabase::Query>& queries)
+{
+    // Covering index so a conversation's row window can be resolved on the
+    // index alone, without walking the whole table or its joins
+    queries +=
+        RawDatabase::Query(QStringLiteral("CREATE INDEX chat_id_idx ON history (chat_id, id);"));
+}
+
+void dbSchema2to3(QVector<RawDatabase::Query>& queries)
+{
+    // Durable record of how far a transfer got, so an interrupted multi-GB
+    // transfer can resume at its last completed offset after a restart
+    queries += RawDatabase::Query(QStringLiteral(
+        "ALTER TABLE file_transfers ADD COLUMN completed_bytes INTEGER NOT NULL DEFAULT 0;"));
+}
+
+void dbSchema3to4(QVector<RawDatabase::Query>& queries)
+{
+    // Side table and indexes feeding the per-chat media/links gallery. URL
+    // rows are extracted at insert time; the covering index answers gallery
+    // queries without touching message bodies. Pre-existing messages are
+    // deliberately not mined retroactively - that would be exactly the full
+    // scan the index exists to avoid.
+    queries += RawDatabase::Query(QStringLiteral(
+        "CREATE TABLE message_urls "
+        "(id INTEGER PRIMARY KEY, "
+        "chat_id INTEGER NOT NULL, "
+        "history_id INTEGER NOT NULL, "
+        "timestamp INTEGER NOT NULL, "
+        "url TEXT NOT NULL);"
+        "CREATE INDEX message_urls_chat_idx ON message_urls (chat_id, timestamp, url);"
+        "CREATE INDEX file_transfers_chat_idx ON file_transfers (chat_id, id);"));
+}
+
+void dbSchema4to5(QVector<RawDatabase::Query>& queries)
+{
+    // Materialized unread bookkeeping, one row per conversation. Counters
+    // are bumped in the same transaction as the message insert and zeroed
+    // when a chat is read, so roster badges survive a restart without
+    // recounting recent history per conversation.
+    queries += RawDatabase::Query(QStringLiteral(
+        "CREATE TABLE chat_read_state "
+        "(chat_id INTEGER PRIMARY KEY, "
+        "last_read_id INTEGER NOT NULL DEFAULT 0, "
+        "unread_count INTEGER NOT NULL DEFAULT 0);"));
+}
+
+void dbSchema5to6(QVector<RawDatabase::Query>& queries)
+{
+    // Per-(chat, day) message counters, bumped in the same transaction as
+    // each insert. The calendar jump used to answer "how many messages came
+    // before this date" by aggregating over the chat's entire history;
+    // summing these rows instead touches one row per day of conversation.
+    // The backfill is a single pass over the message table, but unlike a
+    // rewrite its writes are bounded by the number of distinct days, and
+    // running it inside the versioned upgrade - before any schema-6 insert
+    // can bump a counter - rules out double counting.
+    queries += RawDatabase::Query(QStringLiteral(
+        "CREATE TABLE chat_day_counts "
+        "(chat_id INTEGER NOT NULL, "
+        "day INTEGER NOT NULL, "
+        "count INTEGER NOT NULL DEFAULT 0, "
+        "PRIMARY KEY (chat_id, day));"));
+    queries += RawDatabase::Query(QStringLiteral(
+        "INSERT INTO chat_day_counts (chat_id, day, count) "
+        "SELECT chat_id, timestamp / 1000 / 60 / 60 / 24, COUNT(id) "
+        "FROM history "
+        "GROUP BY chat_id, timestamp / 1000 / 60 / 60 / 24;"));
+}
+
+void dbSchema6to7(QVector<RawDatabase::Query>& queries)
+{
+    // Denormalized transfer timestamp plus a covering index for the global
+    // file history browser. A transfer's date previously lived only on its
+    // history row, so listing files meant joining the message table; with the
+    // copy here the browser's query reads nothing but this index. The index
+    // duplicates the name and path blobs, which is what buys the no-table-
+    // touch plan - transfers are orders of magnitude rarer than messages, so
+    // both the duplication and the monolithic backfill are cheap. The
+    // transient history(file_id) index keeps the backfill from scanning the
+    // message table once per transfer; history rows are never looked up by
+    // file_id outside this migration, so it is dropped again.
+    queries += RawDatabase::Query(QStringLiteral(
+        "ALTER TABLE file_transfers ADD COLUMN timestamp INTEGER NOT NULL DEFAULT 0;"));
+    queries += RawDatabase::Query(QStringLiteral(
+        "CREATE INDEX history_file_id_backfill_idx ON history (file_id, timestamp);"));
+    queries += RawDatabase::Query(QStringLiteral(
+        "UPDATE file_transfers SET timestamp = COALESCE("
+        "(SELECT timestamp FROM history WHERE history.file_id = file_transfers.id), 0);"));
+    queries += RawDatabase::Query(QStringLiteral(
+        "DROP INDEX history_file_id_backfill_idx;"));
+    queries += RawDatabase::Query(QStringLiteral(
+        "CREATE INDEX file_transfers_browser_idx ON file_transfers "
+        "(timestamp, chat_id, file_size, direction, file_state, file_name, file_path);"));
+}
+
 /**
 * @brief Upgrade the db schema
 * @note On future alterations of the database all you have to do is bump the SCHEMA_VERSION
 * variable and add another case to the switch statement below. Make sure to fall through on each case.
+* @note Upgrades that rewrite the message table must not run as one monolithic
+* transaction - on multi-gigabyte profiles that is a minutes-long frozen login
+* and a full restart after any crash. Use runChunkedMigration for those: it
+* commits in bounded chunks with a persistent checkpoint, reports progress and
+* resumes where it left off.
 */
 void dbSchemaUpgrade(std::shared_ptr<RawDatabase> db)
 {
@@ -139,10 +269,24 @@ void dbSchemaUpgrade(std::shared_ptr<RawDatabase> db)
             dbSchema0to1(db, queries);
         }
         // fallthrough
-    // case 1:
-    //    dbSchema1to2(queries);
-    //    //fallthrough
-    // etc.
+    case 1:
+        dbSchema1to2(queries);
+        // fallthrough
+    case 2:
+        dbSchema2to3(queries);
+        // fallthrough
+    case 3:
+        dbSchema3to4(queries);
+        // fallthrough
+    case 4:
+        dbSchema4to5(queries);
+        // fallthrough
+    case 5:
+        dbSchema5to6(queries);
+        // fallthrough
+    case 6:
+        dbSchema6to7(queries);
+        // fallthrough
     default:
         queries += RawDatabase::Query(QStringLiteral("PRAGMA user_version = %1;").arg(SCHEMA_VERSION));
         db->execLater(queries);
@@ -150,6 +294,196 @@ void dbSchemaUpgrade(std::shared_ptr<RawDatabase> db)
                 << "->" << SCHEMA_VERSION << ")";
     }
 }
+
+/**
+ * @brief Builds the History::aliases cache key for an owner/display name pair.
+ */
+QString aliasCacheKey(int64_t ownerId, const QString& dispName)
+{
+    return QString::number(ownerId) + QLatin1Char('\n') + dispName;
+}
+
+// Conversations with at least this many rows get their own partition table
+// when QTOX_HISTORY_PARTITION is set
+constexpr int64_t PARTITION_THRESHOLD_ROWS = 100000;
+
+// The chat_day_counts table buckets timestamps into epoch days with this
+// divisor; it has to match the SQL-side "timestamp / 1000 / 60 / 60 / 24"
+constexpr int64_t MS_PER_DAY = 24 * 60 * 60 * 1000;
+
+/**
+ * @brief Name of the per-conversation partition table for a chat's peer row id.
+ */
+QString partitionTableName(int64_t chatId)
+{
+    return QStringLiteral("history_part_%1").arg(chatId);
+}
+
+/**
+ * @brief Pulls the http/https URLs out of a message body for the link index.
+ *
+ * Trailing sentence punctuation is stripped - "see https://example.com." is
+ * an URL followed by a full stop, not an URL ending in one.
+ */
+QStringList extractUrls(const QString& message)
+{
+    static const QRegularExpression urlRegex(QStringLiteral("\\bhttps?://[^\\s<>\"]+"),
+                                             QRegularExpression::CaseInsensitiveOption);
+
+    QStringList urls;
+    QRegularExpressionMatchIterator it = urlRegex.globalMatch(message);
+    while (it.hasNext()) {
+        QString url = it.next().captured();
+        while (!url.isEmpty() && QStringLiteral(".,;:!?)]}'").contains(url.right(1))) {
+            url.chop(1);
+        }
+        if (!url.isEmpty() && !urls.contains(url)) {
+            urls += url;
+        }
+    }
+    return urls;
+}
+
+// First byte of a compressed message body. 0xFF never occurs in valid
+// UTF-8, so plain text can never be mistaken for a compressed row and the
+// two representations may coexist in the same table indefinitely.
+constexpr char COMPRESSED_BODY_MARKER = '\xFF';
+
+// message body compression is opt-in while it proves itself
+bool compressionEnabled()
+{
+    static const bool enabled = qEnvironmentVariableIsSet("QTOX_HISTORY_COMPRESS");
+    return enabled;
+}
+
+/**
+ * @brief Encodes a message body for storage, compressed when that shrinks it.
+ *
+ * Short or already-dense text grows under deflate; those bodies stay plain,
+ * the marker byte tells the two apart on the way out.
+ */
+QByteArray compressBody(const QString& message)
+{
+    const QByteArray plain = message.toUtf8();
+    if (!compressionEnabled()) {
+        return plain;
+    }
+
+    QByteArray packed = qCompress(plain, 9);
+    packed.prepend(COMPRESSED_BODY_MARKER);
+    return packed.size() < plain.size() ? packed : plain;
+}
+
+/**
+ * @brief Decodes a stored message body, compressed or plain.
+ */
+QString decompressBody(const QByteArray& raw)
+{
+    if (raw.isEmpty() || raw.at(0) != COMPRESSED_BODY_MARKER) {
+        return QString::fromUtf8(raw);
+    }
+
+    return QString::fromUtf8(
+        qUncompress(reinterpret_cast<const uchar*>(raw.constData()) + 1, raw.size() - 1));
+}
+
+/**
+ * @brief Cuts a result-list snippet around the first occurrence of a phrase.
+ */
+QString cutSnippet(const QString& body, const QString& phrase)
+{
+    constexpr int snippetLength = 120;
+    if (body.size() <= snippetLength) {
+        return body;
+    }
+
+    const int pos = body.indexOf(phrase, 0, Qt::CaseInsensitive);
+    const int start = qMax(0, (pos < 0 ? 0 : pos) - snippetLength / 3);
+    QString snippet = body.mid(start, snippetLength);
+    if (start > 0) {
+        snippet.prepend(QStringLiteral("…"));
+    }
+    if (start + snippetLength < body.size()) {
+        snippet.append(QStringLiteral("…"));
+    }
+    return snippet;
+}
+
+// Progress callback for long-running migrations: (rows done, rows total)
+using MigrationProgressFn = std::function<void(int64_t, int64_t)>;
+
+// Rows per migration chunk; bounds each transaction and with it the longest
+// stall a migration can inflict between two progress reports
+constexpr int64_t MIGRATION_CHUNK_ROWS = 5000;
+
+/**
+ * @brief Runs a whole-table transformation in bounded, resumable chunks.
+ * @param db Database to operate on.
+ * @param name Unique migration name, keys the persistent checkpoint.
+ * @param makeChunk Produces the queries transforming the rows in [fromId, toId).
+ * @param progress Invoked after every committed chunk.
+ * @return false if a chunk failed; chunks already committed stay applied.
+ *
+ * Each chunk commits atomically with its checkpoint, so a crash or power
+ * loss mid-migration resumes at the last completed chunk on the next
+ * startup instead of rolling a monolithic transaction back and starting
+ * over. The checkpoint row is kept after completion - it records that
+ * everything below it is done, which makes re-running a finished migration
+ * a no-op.
+ */
+bool runChunkedMigration(std::shared_ptr<RawDatabase> db, const QString& name,
+                         const std::function<QVector<RawDatabase::Query>(int64_t, int64_t)>& makeChunk,
+                         const MigrationProgressFn& progress)
+{
+    if (!db->execNow("CREATE TABLE IF NOT EXISTS migration_state "
+                     "(name TEXT PRIMARY KEY, next_id INTEGER NOT NULL);")) {
+        return false;
+    }
+
+    int64_t nextId = 0;
+    if (!db->execNow(RawDatabase::Query(
+            QStringLiteral("SELECT next_id FROM migration_state WHERE name='%1';").arg(name),
+            [&nextId](const QVector<QVariant>& row) { nextId = row[0].toLongLong(); }))) {
+        return false;
+    }
+
+    int64_t maxId = 0;
+    if (!db->execNow(RawDatabase::Query(
+            QStringLiteral("SELECT COALESCE(MAX(id), 0) FROM history;"),
+            [&maxId](const QVector<QVariant>& row) { maxId = row[0].toLongLong(); }))) {
+        return false;
+    }
+
+    if (nextId > maxId) {
+        // finished in an earlier run
+        return true;
+    }
+
+    qDebug() << "Running migration" << name << "from row" << nextId << "of" << maxId;
+
+    while (nextId <= maxId) {
+        const int64_t endId = nextId + MIGRATION_CHUNK_ROWS;
+        QVector<RawDatabase::Query> chunk = makeChunk(nextId, endId);
+        // the checkpoint commits in the same transaction as the chunk's work
+        chunk += RawDatabase::Query(
+            QStringLiteral("INSERT OR REPLACE INTO migration_state (name, next_id) "
+                           "VALUES ('%1', %2);")
+                .arg(name)
+                .arg(endId));
+        if (!db->execNow(chunk)) {
+            qWarning() << "Migration" << name << "failed at row" << nextId
+                       << "- it will resume there on the next startup";
+            return false;
+        }
+        nextId = endId;
+        if (progress) {
+            progress(qMin(nextId, maxId), maxId);
+        }
+    }
+
+    qDebug() << "Migration" << name << "finished";
+    return true;
+}
 } // namespace
 
 /**
@@ -159,6 +493,11 @@ void dbSchemaUpgrade(std::shared_ptr<RawDatabase> db)
  * @var QHash<QString, int64_t> History::peers
  * @brief Maps friend public keys to unique IDs by index.
  * Caches mappings to speed up message saving.
+ *
+ * @var QHash<QString, int64_t> History::aliases
+ * @brief Maps "<owner id>\n<display name>" keys to alias row IDs.
+ * Caches mappings so steady-state message inserts skip the alias lookup
+ * subquery entirely.
  */
 
 static constexpr int NUM_MESSAGES_DEFAULT =
@@ -192,24 +531,197 @@ History::History(std::shared_ptr<RawDatabase> db)
     connect(this, &History::fileInsertionReady, this, &History::onFileInsertionReady);
     connect(this, &History::fileInserted, this, &History::onFileInserted);
 
+    fts5Enabled = initFtsIndex();
+
+    // Long-lived profiles accumulate fragmentation from deletions, reclaim
+    // space and refresh planner stats during idle periods
+    static constexpr int MAINTENANCE_INTERVAL_MS = 6 * 60 * 60 * 1000;
+    db->scheduleMaintenance(MAINTENANCE_INTERVAL_MS);
+
     // Cache our current peers
     db->execLater(RawDatabase::Query{"SELECT public_key, id FROM peers;",
                                      [this](const QVector<QVariant>& row) {
                                          peers[row[0].toString()] = row[1].toInt();
                                      }});
+
+    // Cache the known alias rows so message inserts can reference them directly
+    db->execLater(RawDatabase::Query{
+        "SELECT owner, display_name, id FROM aliases;", [this](const QVector<QVariant>& row) {
+            const QString dispName = QString::fromUtf8(row[1].toByteArray());
+            aliases[aliasCacheKey(row[0].toLongLong(), dispName)] = row[2].toLongLong();
+        }});
+
+    partitioningEnabled = qEnvironmentVariableIsSet("QTOX_HISTORY_PARTITION");
+    if (partitioningEnabled) {
+        initPartitions();
+    }
+
+    // Shrink pre-existing bodies in the background, well after login settled.
+    // The receiver-context overload cancels the shot if we die first.
+    if (compressionEnabled()) {
+        static constexpr int COMPRESS_DELAY_MS = 10 * 1000;
+        QTimer::singleShot(COMPRESS_DELAY_MS, this, [this]() { compressExistingRows(); });
+    }
+
+    MemoryRegistry::registerSampler("history caches",
+                                    [this]() {
+                                        return QString("%1 peers, %2 aliases, %3 file infos, "
+                                                       "%4 queued messages")
+                                            .arg(peers.size())
+                                            .arg(aliases.size())
+                                            .arg(fileInfos.size())
+                                            .arg(queuedMessageQueries.size());
+                                    },
+                                    this);
 }
 
 History::~History()
 {
+    MemoryRegistry::unregister(this);
+
     if (!isValid()) {
         return;
     }
 
+    // Messages still sitting in the batch queue have to make it to disk
+    flushQueuedMessages();
+
     // We could have execLater requests pending with a lambda attached,
     // so clear the pending transactions first
     db->sync();
 }
 
+/**
+ * @brief Sets up the optional FTS5 full-text index over message bodies.
+ *
+ * The index is a sidecar of the history table rather than part of the
+ * versioned schema, since not every SQLCipher build ships the FTS5 module.
+ * When the module is missing we keep working and search falls back to the
+ * regexp table scans. Rows inserted before the index existed (or by an older
+ * qTox) are backfilled in resumable chunks via runChunkedMigration.
+ *
+ * @return True if the index is available and maintained.
+ */
+bool History::initFtsIndex()
+{
+    if (!db->execNow("CREATE VIRTUAL TABLE IF NOT EXISTS message_fts "
+                     "USING fts5(message, content='history', content_rowid='id');")) {
+        qWarning() << "FTS5 is unavailable, phrase search will use full table scans";
+        return false;
+    }
+
+    // Backfilling the index used to be one monolithic INSERT..SELECT over the
+    // whole message table, a minutes-long wall on multi-gigabyte profiles.
+    // Chunking bounds every transaction, the checkpoint lets an interrupted
+    // backfill resume where it stopped, and pumping events between chunks
+    // keeps the login UI painting meanwhile.
+    int lastPercent = -1;
+    runChunkedMigration(db, QStringLiteral("fts_backfill"),
+                        [](int64_t fromId, int64_t toId) {
+                            QVector<RawDatabase::Query> queries;
+                            queries += RawDatabase::Query(
+                                QStringLiteral("INSERT INTO message_fts (rowid, message) "
+                                               "SELECT id, DECOMPRESS(message) FROM history "
+                                               "WHERE id >= %1 AND id < %2 "
+                                               "AND id NOT IN (SELECT rowid FROM message_fts);")
+                                    .arg(fromId)
+                                    .arg(toId));
+                            return queries;
+                        },
+                        [&lastPercent](int64_t done, int64_t total) {
+                            const int percent = static_cast<int>(done * 100 / total);
+                            if (percent != lastPercent) {
+                                lastPercent = percent;
+                                qDebug() << "FTS backfill" << percent << "%";
+                            }
+                            // same trick as the rekey path: keep repainting
+                            // while the worker grinds through the chunks
+                            QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+                        });
+    return true;
+}
+
+/**
+ * @brief Compresses pre-existing message bodies in the background.
+ *
+ * New inserts compress on the way in (see compressBody), this sweep brings
+ * the rows written before compression was enabled down to the same format.
+ * Runs as a chunked, resumable migration; rows that are already compressed
+ * or wouldn't shrink are left alone, so re-runs converge to a no-op.
+ */
+void History::compressExistingRows()
+{
+    runChunkedMigration(db, QStringLiteral("compress_bodies"),
+                        [this](int64_t fromId, int64_t toId) {
+                            QVector<RawDatabase::Query> queries;
+                            db->execNowRead(RawDatabase::Query(
+                                QStringLiteral("SELECT id, message FROM history "
+                                               "WHERE id >= %1 AND id < %2 "
+                                               "AND file_id IS NULL;")
+                                    .arg(fromId)
+                                    .arg(toId),
+                                [&queries](const QVector<QVariant>& row) {
+                                    const QByteArray raw = row[1].toByteArray();
+                                    if (!raw.isEmpty() && raw.at(0) == COMPRESSED_BODY_MARKER) {
+                                        return;
+                                    }
+                                    const QByteArray packed =
+                                        compressBody(QString::fromUtf8(raw));
+                                    if (packed.isEmpty() || packed.at(0) != COMPRESSED_BODY_MARKER) {
+                                        // body doesn't shrink, keep it plain
+                                        return;
+                                    }
+                                    queries += RawDatabase::Query(
+                                        QStringLiteral("UPDATE history SET message = ? "
+                                                       "WHERE id = %1;")
+                                            .arg(row[0].toLongLong()),
+                                        {packed});
+                                }));
+                            return queries;
+                        },
+                        MigrationProgressFn());
+}
+
+/**
+ * @brief Sets up per-conversation partition tables for oversized chats.
+ *
+ * Opt-in via QTOX_HISTORY_PARTITION. A partition table holds just the
+ * (id, timestamp) pairs of one conversation, giving the page-seek and count
+ * queries a B-tree containing only that chat's rows instead of walking the
+ * shared chat index that a pathological conversation dominates. The tables
+ * are a sidecar of the history table, not part of the versioned schema;
+ * creation and backfill are idempotent and re-run at startup.
+ */
+void History::initPartitions()
+{
+    db->execLater(RawDatabase::Query{
+        "SELECT chat_id, COUNT(id) FROM history GROUP BY chat_id;",
+        [this](const QVector<QVariant>& row) {
+            const int64_t chatId = row[0].toLongLong();
+            if (row[1].toLongLong() >= PARTITION_THRESHOLD_ROWS) {
+                createPartition(chatId);
+            }
+        }});
+}
+
+/**
+ * @brief Creates and backfills the partition table of one conversation.
+ */
+void History::createPartition(int64_t chatId)
+{
+    const QString table = partitionTableName(chatId);
+    db->execLater(QVector<RawDatabase::Query>{
+        RawDatabase::Query{QStringLiteral("CREATE TABLE IF NOT EXISTS %1 "
+                                          "(id INTEGER PRIMARY KEY, timestamp INTEGER NOT NULL);")
+                               .arg(table)},
+        RawDatabase::Query{QStringLiteral("INSERT OR IGNORE INTO %1 (id, timestamp) "
+                                          "SELECT id, timestamp FROM history WHERE chat_id=%2;")
+                               .arg(table)
+                               .arg(chatId)}});
+    partitionedChats.insert(chatId);
+    qDebug() << "Partitioned history of chat" << chatId;
+}
+
 /**
  * @brief Checks if the database was opened successfully
  * @return True if database if opened, false otherwise.
@@ -238,12 +750,30 @@ void History::eraseHistory()
         return;
     }
 
-    db->execNow("DELETE FROM faux_offline_pending;"
-                "DELETE FROM history;"
-                "DELETE FROM aliases;"
-                "DELETE FROM peers;"
-                "DELETE FROM file_transfers;"
-                "VACUUM;");
+    if (fts5Enabled) {
+        db->execNow("INSERT INTO message_fts (message_fts) VALUES ('delete-all');");
+    }
+
+    QString dropPartitions;
+    for (const qint64 chatId : partitionedChats) {
+        dropPartitions += QStringLiteral("DROP TABLE IF EXISTS %1;").arg(partitionTableName(chatId));
+    }
+
+    db->execNow(dropPartitions
+                + "DELETE FROM faux_offline_pending;"
+                  "DELETE FROM history;"
+                  "DELETE FROM aliases;"
+                  "DELETE FROM peers;"
+                  "DELETE FROM file_transfers;"
+                  "DELETE FROM message_urls;"
+                  "DELETE FROM chat_read_state;"
+                  "DELETE FROM chat_day_counts;"
+                  "VACUUM;");
+
+    // The cached rows are gone, new messages have to re-insert them
+    peers.clear();
+    aliases.clear();
+    partitionedChats.clear();
 }
 
 /**
@@ -262,7 +792,27 @@ void History::removeFriendHistory(const QString& friendPk)
 
     int64_t id = peers[friendPk];
 
-    QString queryText = QString("DELETE FROM faux_offline_pending "
+    // The index rows have to go while the content rows still exist. With an
+    // external-content table a plain DELETE makes FTS5 re-read the content
+    // rows to find the tokens to unindex - and on compressed profiles those
+    // are blobs, not the plaintext that was indexed, which would corrupt the
+    // index. The explicit 'delete' command takes the indexed values from us,
+    // so hand it the same DECOMPRESS output the insert path indexed.
+    QString ftsCleanup;
+    if (fts5Enabled) {
+        ftsCleanup = QString("INSERT INTO message_fts (message_fts, rowid, message) "
+                             "SELECT 'delete', id, DECOMPRESS(message) FROM history "
+                             "WHERE chat_id=%1; ")
+                         .arg(id);
+    }
+
+    QString partitionCleanup;
+    if (partitionedChats.contains(id)) {
+        partitionCleanup = QStringLiteral("DROP TABLE IF EXISTS %1; ").arg(partitionTableName(id));
+    }
+
+    QString queryText = ftsCleanup + partitionCleanup
+                        + QString("DELETE FROM faux_offline_pending "
                                 "WHERE faux_offline_pending.id IN ( "
                                 "    SELECT faux_offline_pending.id FROM faux_offline_pending "
                                 "    LEFT JOIN history ON faux_offline_pending.id = history.id "
@@ -272,11 +822,25 @@ void History::removeFriendHistory(const QString& friendPk)
                                 "DELETE FROM aliases WHERE owner=%1; "
                                 "DELETE FROM peers WHERE id=%1; "
                                 "DELETE FROM file_transfers WHERE chat_id=%1;"
+                                "DELETE FROM message_urls WHERE chat_id=%1;"
+                                "DELETE FROM chat_read_state WHERE chat_id=%1;"
+                                "DELETE FROM chat_day_counts WHERE chat_id=%1;"
                                 "VACUUM;")
                             .arg(id);
 
     if (db->execNow(queryText)) {
         peers.remove(friendPk);
+        partitionedChats.remove(id);
+
+        // Drop the removed owner's alias rows from the cache as well
+        const QString aliasPrefix = QString::number(id) + QLatin1Char('\n');
+        for (auto aliasIt = aliases.begin(); aliasIt != aliases.end();) {
+            if (aliasIt.key().startsWith(aliasPrefix)) {
+                aliasIt = aliases.erase(aliasIt);
+            } else {
+                ++aliasIt;
+            }
+        }
     } else {
         qWarning() << "Failed to remove friend's history";
     }
@@ -335,32 +899,91 @@ History::generateNewMessageQueries(const QString& friendPk, const QString& messa
                                           .arg(senderId)};
     }
 
-    queries += RawDatabase::Query(
-        QString("INSERT OR IGNORE INTO aliases (owner, display_name) VALUES (%1, ?);").arg(senderId),
-        {dispName.toUtf8()});
+    // Get the db id of the sender's alias for this display name; the cache key
+    // includes the name, so a renamed sender misses and gets a fresh alias row
+    const QString aliasKey = aliasCacheKey(senderId, dispName);
+    int64_t aliasId;
+    if (aliases.contains(aliasKey)) {
+        aliasId = aliases[aliasKey];
+    } else {
+        if (aliases.isEmpty()) {
+            aliasId = 0;
+        } else {
+            aliasId = *std::max_element(aliases.begin(), aliases.end()) + 1;
+        }
 
-    // If the alias already existed, the insert will ignore the conflict and last_insert_rowid()
-    // will return garbage,
-    // so we have to check changes() and manually fetch the row ID in this case
-    queries +=
-        RawDatabase::Query(QString(
-                               "INSERT INTO history (timestamp, chat_id, message, sender_alias) "
-                               "VALUES (%1, %2, ?, ("
-                               "  CASE WHEN changes() IS 0 THEN ("
-                               "    SELECT id FROM aliases WHERE owner=%3 AND display_name=?)"
-                               "  ELSE last_insert_rowid() END"
-                               "));")
-                               .arg(time.toMSecsSinceEpoch())
-                               .arg(peerId)
-                               .arg(senderId),
-                           {message.toUtf8(), dispName.toUtf8()}, insertIdCallback);
+        aliases[aliasKey] = aliasId;
+        queries += RawDatabase::Query(
+            QString("INSERT INTO aliases (id, owner, display_name) VALUES (%1, %2, ?);")
+                .arg(aliasId)
+                .arg(senderId),
+            {dispName.toUtf8()});
+    }
+
+    queries += RawDatabase::Query(QString("INSERT INTO history (timestamp, chat_id, message, "
+                                          "sender_alias) VALUES (%1, %2, ?, %3);")
+                                      .arg(time.toMSecsSinceEpoch())
+                                      .arg(peerId)
+                                      .arg(aliasId),
+                                  {compressBody(message)}, insertIdCallback);
+
+    if (partitionedChats.contains(peerId)) {
+        // Mirror the row into the chat's partition table. Inserting with an
+        // explicit rowid keeps last_insert_rowid() pointing at the same value
+        // for the queries below.
+        queries += RawDatabase::Query(
+            QStringLiteral("INSERT INTO %1 (id, timestamp) VALUES (last_insert_rowid(), %2);")
+                .arg(partitionTableName(peerId))
+                .arg(time.toMSecsSinceEpoch()));
+    }
 
     if (!isSent) {
+        // The faux_offline_pending row reuses the history id as its rowid,
+        // so last_insert_rowid() still refers to the history row afterwards
         queries += RawDatabase::Query{"INSERT INTO faux_offline_pending (id) VALUES ("
                                       "    last_insert_rowid()"
                                       ");"};
     }
 
+    if (fts5Enabled) {
+        queries += RawDatabase::Query("INSERT INTO message_fts (rowid, message) VALUES ("
+                                      "    last_insert_rowid(), ?"
+                                      ");",
+                                      {message.toUtf8()});
+    }
+
+    // Incoming messages bump the conversation's materialized unread counter
+    // in the same transaction as the row itself; outgoing ones are read by
+    // definition. The two-statement upsert is portable to old SQLCipher.
+    if (sender == friendPk) {
+        queries += RawDatabase::Query(
+            QStringLiteral("INSERT OR IGNORE INTO chat_read_state (chat_id) VALUES (%1);"
+                           "UPDATE chat_read_state SET unread_count = unread_count + 1 "
+                           "WHERE chat_id = %1;")
+                .arg(peerId));
+    }
+
+    // Every message also bumps its (chat, day) counter, which is what lets
+    // the calendar jump resolve a date without aggregating over the chat
+    queries += RawDatabase::Query(
+        QStringLiteral("INSERT OR IGNORE INTO chat_day_counts (chat_id, day) VALUES (%1, %2);"
+                       "UPDATE chat_day_counts SET count = count + 1 "
+                       "WHERE chat_id = %1 AND day = %2;")
+            .arg(peerId)
+            .arg(time.toMSecsSinceEpoch() / MS_PER_DAY));
+
+    // These go last: inserting a message_urls row moves last_insert_rowid()
+    // off the history row, which every statement above depends on. Inside
+    // this transaction MAX(id) still names the row that was just inserted.
+    for (const QString& url : extractUrls(message)) {
+        queries += RawDatabase::Query(
+            QStringLiteral("INSERT INTO message_urls (chat_id, history_id, timestamp, url) "
+                           "VALUES (%1, (SELECT MAX(id) FROM history), %2, ?);")
+                .arg(peerId)
+                .arg(time.toMSecsSinceEpoch()),
+            {url.toUtf8()});
+    }
+
     return queries;
 }
 
@@ -377,12 +1000,14 @@ void History::onFileInsertionReady(FileDbInsertionData data)
     queries +=
         RawDatabase::Query(QStringLiteral(
                                "INSERT INTO file_transfers (chat_id, file_restart_id, "
-                               "file_path, file_name, file_hash, file_size, direction, file_state) "
-                               "VALUES (%1, ?, ?, ?, ?, %2, %3, %4);")
+                               "file_path, file_name, file_hash, file_size, direction, "
+                               "file_state, timestamp) "
+                               "VALUES (%1, ?, ?, ?, ?, %2, %3, %4, %5);")
                                .arg(peerId)
                                .arg(data.size)
                                .arg(static_cast<int>(data.direction))
-                               .arg(ToxFile::CANCELED),
+                               .arg(ToxFile::CANCELED)
+                               .arg(data.timestamp),
                            {data.fileId.toUtf8(), data.filePath.toUtf8(), data.fileName.toUtf8(), QByteArray()},
                            [weakThis, fileId](RowId id) {
                                auto pThis = weakThis.lock();
@@ -465,6 +1090,7 @@ void History::addNewFileMessage(const QString& friendPk, const QString& fileId,
     insertionData.filePath = filePath;
     insertionData.size = size;
     insertionData.direction = direction;
+    insertionData.timestamp = time.toMSecsSinceEpoch();
 
     auto insertFileTransferFn = [weakThis, insertionData](RowId messageId) {
         auto insertionDataRw = std::move(insertionData);
@@ -505,6 +1131,54 @@ void History::addNewMessage(const QString& friendPk, const QString& message, con
                                             insertIdCallback));
 }
 
+/**
+ * @brief Queues a chat message for a batched database insert.
+ *
+ * Unlike addNewMessage, which issues one transaction per message, queued
+ * messages accumulate and are written as a single multi-row transaction on
+ * flush, which is considerably cheaper during message storms and imports.
+ * Insert callbacks fire once the batch executes.
+ *
+ * @see flushQueuedMessages
+ */
+void History::queueNewMessage(const QString& friendPk, const QString& message, const QString& sender,
+                              const QDateTime& time, bool isSent, QString dispName,
+                              const std::function<void(RowId)>& insertIdCallback)
+{
+    if (!Settings::getInstance().getEnableLogging()) {
+        qWarning() << "Blocked a message from being added to database while history is disabled";
+        return;
+    }
+    if (!isValid()) {
+        return;
+    }
+
+    queuedMessageQueries += generateNewMessageQueries(friendPk, message, sender, time, isSent,
+                                                      dispName, insertIdCallback);
+
+    // Don't let a runaway burst grow the batch (and its memory) unboundedly
+    static constexpr int MAX_QUEUED_QUERIES = 256;
+    if (queuedMessageQueries.size() >= MAX_QUEUED_QUERIES) {
+        flushQueuedMessages();
+    }
+}
+
+/**
+ * @brief Writes all queued messages as one transaction.
+ *
+ * Latency-sensitive callers (e.g. before reading recent history back) should
+ * call this as soon as their burst ends.
+ */
+void History::flushQueuedMessages()
+{
+    if (queuedMessageQueries.isEmpty()) {
+        return;
+    }
+
+    db->execLater(queuedMessageQueries);
+    queuedMessageQueries.clear();
+}
+
 void History::setFileFinished(const QString& fileId, bool success, const QString& filePath,
                               const QByteArray& fileHash)
 {
@@ -521,23 +1195,104 @@ void History::setFileFinished(const QString& fileId, bool success, const QString
     fileInfos.remove(fileId);
 }
 
-size_t History::getNumMessagesForFriend(const ToxPk& friendPk)
+/**
+ * @brief Records how many contiguous bytes of a transfer have completed.
+ *
+ * qTox transfers are strictly sequential (an out-of-order chunk aborts the
+ * transfer), so this single watermark is an exact record of the completed
+ * region. Keyed by the 32-byte resume file id, which survives restarts.
+ */
+void History::setFileCompletedBytes(const QString& fileId, quint64 completedBytes)
+{
+    if (!isValid()) {
+        return;
+    }
+
+    db->execLater(RawDatabase::Query(QStringLiteral("UPDATE file_transfers "
+                                                    "SET completed_bytes = %1 "
+                                                    "WHERE file_restart_id = ?;")
+                                         .arg(completedBytes),
+                                     {fileId.toUtf8()}));
+}
+
+/**
+ * @brief Fetches the persisted completed-bytes watermark of a transfer.
+ * @return Completed bytes, or 0 if the transfer is unknown.
+ */
+quint64 History::getFileCompletedBytes(const QString& fileId)
 {
-    return getNumMessagesForFriendBeforeDate(friendPk, QDateTime());
+    if (!isValid()) {
+        return 0;
+    }
+
+    quint64 completedBytes = 0;
+    // the Query blob overload has no row callback, so inline the key as a
+    // blob literal instead
+    QString queryText = QStringLiteral("SELECT completed_bytes FROM file_transfers "
+                                       "WHERE file_restart_id = x'%1' "
+                                       "ORDER BY id DESC LIMIT 1;")
+                            .arg(QString::fromUtf8(fileId.toUtf8().toHex()));
+    db->execNow(RawDatabase::Query(queryText, [&](const QVector<QVariant>& row) {
+        completedBytes = row[0].toULongLong();
+    }));
+    return completedBytes;
 }
 
-size_t History::getNumMessagesForFriendBeforeDate(const ToxPk& friendPk, const QDateTime& date)
+size_t History::getNumMessagesForFriend(const ContactId& chatId)
 {
-    QString queryText = QString("SELECT COUNT(history.id) "
-                                "FROM history "
-                                "JOIN peers chat ON chat_id = chat.id "
-                                "WHERE chat.public_key='%1'")
-                            .arg(friendPk.toString());
+    return getNumMessagesForFriendBeforeDate(chatId, QDateTime());
+}
 
+size_t History::getNumMessagesForFriendBeforeDate(const ContactId& chatId, const QDateTime& date)
+{
+    // The peers cache fills asynchronously right after login, so fall back to
+    // resolving the chat id in-query (a point lookup on the unique key) when
+    // the row isn't cached yet
+    const QString pkString = chatId.toString();
+    const bool cached = peers.contains(pkString);
+    const QString chatIdExpr =
+        cached ? QString::number(peers[pkString])
+               : QString("(SELECT id FROM peers WHERE public_key='%1')").arg(pkString);
+
+    // Whole days resolve against the maintained per-(chat, day) counters -
+    // one row per day of conversation instead of one per message. Only a
+    // cutoff that falls inside a day counts that day's head from the rows.
+    QString queryText;
     if (date.isNull()) {
-        queryText += ";";
+        queryText = QString("SELECT COALESCE(SUM(count), 0) FROM chat_day_counts "
+                            "WHERE chat_id=%1;")
+                        .arg(chatIdExpr);
     } else {
-        queryText += QString(" AND timestamp < %1;").arg(date.toMSecsSinceEpoch());
+        const int64_t cutoff = date.toMSecsSinceEpoch();
+        const int64_t cutoffDay = cutoff / MS_PER_DAY;
+        const QString wholeDays =
+            QString("SELECT COALESCE(SUM(count), 0) FROM chat_day_counts "
+                    "WHERE chat_id=%1 AND day < %2")
+                .arg(chatIdExpr)
+                .arg(cutoffDay);
+
+        if (cutoff % MS_PER_DAY == 0) {
+            // midnight cutoff - the common case, LoadHistoryDialog's
+            // calendar always lands here
+            queryText = wholeDays + ";";
+        } else {
+            QString cutDay;
+            if (cached && partitionedChats.contains(peers[pkString])) {
+                // The chat's partition table holds exactly its rows
+                cutDay = QString("SELECT COUNT(id) FROM %1 "
+                                 "WHERE timestamp >= %2 AND timestamp < %3")
+                             .arg(partitionTableName(peers[pkString]))
+                             .arg(cutoffDay * MS_PER_DAY)
+                             .arg(cutoff);
+            } else {
+                cutDay = QString("SELECT COUNT(id) FROM history "
+                                 "WHERE chat_id=%1 AND timestamp >= %2 AND timestamp < %3")
+                             .arg(chatIdExpr)
+                             .arg(cutoffDay * MS_PER_DAY)
+                             .arg(cutoff);
+            }
+            queryText = QString("SELECT (%1) + (%2);").arg(wholeDays).arg(cutDay);
+        }
     }
 
     size_t numMessages = 0;
@@ -545,16 +1300,37 @@ size_t History::getNumMessagesForFriendBeforeDate(const ToxPk& friendPk, const Q
         numMessages = row[0].toLongLong();
     };
 
-    db->execNow({queryText, rowCallback});
+    db->execNowRead({queryText, rowCallback});
 
     return numMessages;
 }
 
-QList<History::HistMessage> History::getMessagesForFriend(const ToxPk& friendPk, size_t firstIdx,
+QList<History::HistMessage> History::getMessagesForFriend(const ContactId& chatId, size_t firstIdx,
                                                           size_t lastIdx)
 {
     QList<HistMessage> messages;
 
+    // The inner query resolves the page's row ids over the (chat_id, id)
+    // covering index alone — or over the chat's partition table when it has
+    // one — so seeking to the window never evaluates the joins; only the rows
+    // of the page itself are joined and materialized
+    const QString pkString = chatId.toString();
+    QString seekQuery;
+    if (peers.contains(pkString) && partitionedChats.contains(peers[pkString])) {
+        seekQuery = QString("SELECT id FROM %1 ORDER BY id LIMIT %2 OFFSET %3 ")
+                        .arg(partitionTableName(peers[pkString]))
+                        .arg(lastIdx - firstIdx)
+                        .arg(firstIdx);
+    } else {
+        seekQuery = QString("SELECT history.id FROM history "
+                            "JOIN peers chat ON history.chat_id = chat.id "
+                            "WHERE chat.public_key='%1' "
+                            "ORDER BY history.id LIMIT %2 OFFSET %3 ")
+                        .arg(pkString)
+                        .arg(lastIdx - firstIdx)
+                        .arg(firstIdx);
+    }
+
     // Don't forget to update the rowCallback if you change the selected columns!
     QString queryText =
         QString("SELECT history.id, faux_offline_pending.id, timestamp, "
@@ -568,11 +1344,9 @@ QList<History::HistMessage> History::getMessagesForFriend(const ToxPk& friendPk,
                 "JOIN aliases ON sender_alias = aliases.id "
                 "JOIN peers sender ON aliases.owner = sender.id "
                 "LEFT JOIN file_transfers ON history.file_id = file_transfers.id "
-                "WHERE chat.public_key='%1' "
-                "LIMIT %2 OFFSET %3;")
-            .arg(friendPk.toString())
-            .arg(lastIdx - firstIdx)
-            .arg(firstIdx);
+                "WHERE history.id IN ( %1 ) "
+                "ORDER BY history.id;")
+            .arg(seekQuery);
 
     auto rowCallback = [&messages](const QVector<QVariant>& row) {
         // dispName and message could have null bytes, QString::fromUtf8
@@ -584,8 +1358,10 @@ QList<History::HistMessage> History::getMessagesForFriend(const ToxPk& friendPk,
         auto display_name = QString::fromUtf8(row[4].toByteArray().replace('\0', ""));
         auto sender_key = row[5].toString();
         if (row[7].isNull()) {
-            messages += {id,           isOfflineMessage, timestamp,        friend_key,
-                         display_name, sender_key,       row[6].toString()};
+            messages += {id,           isOfflineMessage,
+                         timestamp,    friend_key,
+                         display_name, sender_key,
+                         decompressBody(row[6].toByteArray())};
         } else {
             ToxFile file;
             file.fileKind = TOX_FILE_KIND_DATA;
@@ -600,7 +1376,7 @@ QList<History::HistMessage> History::getMessagesForFriend(const ToxPk& friendPk,
         }
     };
 
-    db->execNow({queryText, rowCallback});
+    db->execNowRead({queryText, rowCallback});
 
     return messages;
 }
@@ -628,16 +1404,113 @@ QList<History::HistMessage> History::getUnsentMessagesForFriend(const ToxPk& fri
         auto display_name = QString::fromUtf8(row[4].toByteArray().replace('\0', ""));
         auto sender_key = row[5].toString();
         if (row[6].isNull()) {
-            ret += {id,           isOfflineMessage, timestamp,        friend_key,
-                    display_name, sender_key,       row[6].toString()};
+            ret += {id,           isOfflineMessage,
+                    timestamp,    friend_key,
+                    display_name, sender_key,
+                    decompressBody(row[6].toByteArray())};
         }
     };
 
-    db->execNow({queryText, rowCallback});
+    db->execNowRead({queryText, rowCallback});
 
     return ret;
 }
 
+/**
+ * @brief Formats one history entry as a tab-separated text line
+ */
+static QByteArray exportMessageAsText(const History::HistMessage& message)
+{
+    const QString content = message.content.getType() == HistMessageContentType::file
+                                ? QStringLiteral("[file: %1]").arg(message.content.asFile().fileName)
+                                : message.content.asMessage();
+    return QString(message.timestamp.toString("yyyy-MM-dd\thh:mm:ss") + '\t' + message.dispName
+                   + '\t' + content + '\n')
+        .toUtf8();
+}
+
+/**
+ * @brief Formats one history entry as a compact JSON object
+ */
+static QByteArray exportMessageAsJson(const History::HistMessage& message)
+{
+    QJsonObject entry;
+    entry["timestamp"] = message.timestamp.toString(Qt::ISODateWithMs);
+    entry["sender"] = message.sender;
+    entry["display_name"] = message.dispName;
+    entry["sent"] = message.isSent;
+    if (message.content.getType() == HistMessageContentType::file) {
+        const ToxFile& file = message.content.asFile();
+        QJsonObject fileEntry;
+        fileEntry["name"] = file.fileName;
+        fileEntry["size"] = static_cast<qint64>(file.filesize);
+        entry["file"] = fileEntry;
+    } else {
+        entry["message"] = message.content.asMessage();
+    }
+    return QJsonDocument(entry).toJson(QJsonDocument::Compact);
+}
+
+/**
+ * @brief Streams a friend's whole chat history to an open device.
+ *
+ * The history is cursored through in fixed-size chunks and each chunk is
+ * written out before the next one is read, so memory use stays flat no matter
+ * how large the log is.
+ *
+ * @param friendPk Friend public key
+ * @param device Open, writable device receiving the formatted log
+ * @param format Output format
+ * @param progressCallback Invoked after every chunk, return false to abort
+ * @return True if the whole history was written, false on write error or abort
+ */
+bool History::exportHistory(const ToxPk& friendPk, QIODevice& device, ExportFormat format,
+                            const ExportProgressFn& progressCallback)
+{
+    static constexpr size_t EXPORT_CHUNK_SIZE = 1024;
+
+    const size_t total = getNumMessagesForFriend(friendPk);
+
+    if (format == ExportFormat::Json && device.write("[") == -1) {
+        return false;
+    }
+
+    size_t exported = 0;
+    while (exported < total) {
+        const size_t lastIdx = qMin(exported + EXPORT_CHUNK_SIZE, total);
+        const QList<HistMessage> chunk = getMessagesForFriend(friendPk, exported, lastIdx);
+        if (chunk.isEmpty()) {
+            // the log shrank while we were exporting, don't spin on an empty window
+            break;
+        }
+
+        QByteArray buffer;
+        for (int i = 0; i < chunk.size(); ++i) {
+            if (format == ExportFormat::Json) {
+                buffer += (exported == 0 && i == 0) ? "\n" : ",\n";
+                buffer += exportMessageAsJson(chunk[i]);
+            } else {
+                buffer += exportMessageAsText(chunk[i]);
+            }
+        }
+
+        if (device.write(buffer) == -1) {
+            return false;
+        }
+
+        exported += chunk.size();
+        if (progressCallback && !progressCallback(exported, total)) {
+            return false;
+        }
+    }
+
+    if (format == ExportFormat::Json && device.write("\n]\n") == -1) {
+        return false;
+    }
+
+    return true;
+}
+
 /**
  * @brief Search phrase in chat messages
  * @param friendPk Friend public key
@@ -658,26 +1531,28 @@ QDateTime History::getDateWhereFindPhrase(const QString& friendPk, const QDateTi
 
     QString message;
 
+    // bodies may be stored compressed, DECOMPRESS yields the plain text
+    // either way
     switch (parameter.filter) {
     case FilterSearch::Register:
-        message = QStringLiteral("message LIKE '%%1%'").arg(phrase);
+        message = QStringLiteral("DECOMPRESS(message) LIKE '%%1%'").arg(phrase);
         break;
     case FilterSearch::WordsOnly:
-        message = QStringLiteral("message REGEXP '%1'")
+        message = QStringLiteral("DECOMPRESS(message) REGEXP '%1'")
                       .arg(SearchExtraFunctions::generateFilterWordsOnly(phrase).toLower());
         break;
     case FilterSearch::RegisterAndWordsOnly:
-        message = QStringLiteral("REGEXPSENSITIVE(message, '%1')")
+        message = QStringLiteral("REGEXPSENSITIVE(DECOMPRESS(message), '%1')")
                       .arg(SearchExtraFunctions::generateFilterWordsOnly(phrase));
         break;
     case FilterSearch::Regular:
-        message = QStringLiteral("message REGEXP '%1'").arg(phrase);
+        message = QStringLiteral("DECOMPRESS(message) REGEXP '%1'").arg(phrase);
         break;
     case FilterSearch::RegisterAndRegular:
-        message = QStringLiteral("REGEXPSENSITIVE(message '%1')").arg(phrase);
+        message = QStringLiteral("REGEXPSENSITIVE(DECOMPRESS(message) '%1')").arg(phrase);
         break;
     default:
-        message = QStringLiteral("LOWER(message) LIKE '%%1%'").arg(phrase.toLower());
+        message = QStringLiteral("LOWER(DECOMPRESS(message)) LIKE '%%1%'").arg(phrase.toLower());
         break;
     }
 
@@ -710,23 +1585,274 @@ QDateTime History::getDateWhereFindPhrase(const QString& friendPk, const QDateTi
         break;
     }
 
+    // For word-based filters the FTS index can narrow the candidate rows to the
+    // ones actually containing the tokens, the regexp then only runs on those.
+    // Substring filters (LIKE '%...%') can't use the token index.
+    QString ftsFilter;
+    if (fts5Enabled
+        && (parameter.filter == FilterSearch::WordsOnly
+            || parameter.filter == FilterSearch::RegisterAndWordsOnly)) {
+        QString ftsPhrase = phrase;
+        ftsPhrase.replace("\"", "\"\"");
+        ftsFilter = QStringLiteral("AND history.id IN ("
+                                   "    SELECT rowid FROM message_fts WHERE message_fts MATCH '\"%1\"'"
+                                   ") ")
+                        .arg(ftsPhrase);
+    }
+
     QString queryText =
         QStringLiteral("SELECT timestamp "
                        "FROM history "
                        "LEFT JOIN faux_offline_pending ON history.id = faux_offline_pending.id "
                        "JOIN peers chat ON chat_id = chat.id "
                        "WHERE chat.public_key='%1' "
-                       "AND %2 "
-                       "%3")
+                       "%2"
+                       "AND %3 "
+                       "%4")
             .arg(friendPk)
+            .arg(ftsFilter)
             .arg(message)
             .arg(period);
 
-    db->execNow({queryText, rowCallback});
+    db->execNowRead({queryText, rowCallback});
 
     return result;
 }
 
+/**
+ * @brief Searches the given phrase across every conversation at once.
+ * @param phrase Words to look for.
+ * @param maxHits Cap on the number of returned matches.
+ * @return Matches grouped by conversation, newest first within each one.
+ *
+ * Where the FTS5 index is available the candidate rows come straight out of
+ * the token index, so this answers in interactive time even on multi-gigabyte
+ * histories; the result snippet is cut by FTS around the matched tokens.
+ * Without FTS5 it degrades to one case-insensitive substring scan over the
+ * whole message table - slow, but still a single query instead of one search
+ * per conversation.
+ */
+QList<History::GlobalSearchHit> History::globalSearchHistory(QString phrase, size_t maxHits)
+{
+    QList<GlobalSearchHit> hits;
+    if (phrase.isEmpty()) {
+        return hits;
+    }
+
+    // the snippet is cut on our side after decompressing the body, since
+    // stored bodies may be compressed and FTS snippets can't read those
+    auto rowCallback = [&hits, &phrase](const QVector<QVariant>& row) {
+        GlobalSearchHit hit;
+        hit.friendPk = row[0].toString();
+        hit.timestamp = QDateTime::fromMSecsSinceEpoch(row[1].toLongLong());
+        hit.snippet = cutSnippet(decompressBody(row[2].toByteArray()), phrase);
+        hits += hit;
+    };
+
+    QString queryText;
+    if (fts5Enabled) {
+        QString ftsPhrase = phrase;
+        ftsPhrase.replace("\"", "\"\"");
+        ftsPhrase.replace("'", "''");
+        queryText =
+            QStringLiteral("SELECT chat.public_key, history.timestamp, history.message "
+                           "FROM message_fts "
+                           "JOIN history ON history.id = message_fts.rowid "
+                           "JOIN peers chat ON history.chat_id = chat.id "
+                           "WHERE message_fts MATCH '\"%1\"' "
+                           "AND history.file_id IS NULL "
+                           "ORDER BY chat.public_key ASC, history.timestamp DESC "
+                           "LIMIT %2;")
+                .arg(ftsPhrase)
+                .arg(maxHits);
+    } else {
+        QString likePhrase = phrase.toLower();
+        likePhrase.replace("'", "''");
+        queryText =
+            QStringLiteral("SELECT chat.public_key, history.timestamp, history.message "
+                           "FROM history "
+                           "JOIN peers chat ON history.chat_id = chat.id "
+                           "WHERE LOWER(DECOMPRESS(history.message)) LIKE '%%1%' "
+                           "AND history.file_id IS NULL "
+                           "ORDER BY chat.public_key ASC, history.timestamp DESC "
+                           "LIMIT %2;")
+                .arg(likePhrase)
+                .arg(maxHits);
+    }
+
+    db->execNowRead({queryText, rowCallback});
+
+    return hits;
+}
+
+/**
+ * @brief Marks a conversation as read up to its newest message.
+ * @param friendPk Conversation that was just brought on screen.
+ *
+ * Queued inserts are flushed first so the write queue can't reorder a
+ * pending unread bump behind the reset, which would leave a phantom badge.
+ */
+void History::markConversationRead(const ToxPk& friendPk)
+{
+    if (!isValid()) {
+        return;
+    }
+
+    const QString pkString = friendPk.toString();
+    if (!peers.contains(pkString)) {
+        // no history rows yet, so nothing can be unread
+        return;
+    }
+
+    flushQueuedMessages();
+
+    const int64_t id = peers[pkString];
+    db->execLater(
+        RawDatabase::Query(QStringLiteral("INSERT OR IGNORE INTO chat_read_state (chat_id) "
+                                          "VALUES (%1);"
+                                          "UPDATE chat_read_state SET "
+                                          "last_read_id = (SELECT COALESCE(MAX(id), 0) "
+                                          "                FROM history WHERE chat_id = %1), "
+                                          "unread_count = 0 "
+                                          "WHERE chat_id = %1;")
+                               .arg(id)));
+}
+
+/**
+ * @brief Reads every conversation's materialized unread state at once.
+ *
+ * One query over the one-row-per-conversation bookkeeping table; message
+ * content is never touched, so restoring all roster badges at startup costs
+ * the same on a ten-year history as on a fresh profile.
+ */
+QList<History::ReadState> History::getReadStates()
+{
+    QList<ReadState> states;
+    auto rowCallback = [&states](const QVector<QVariant>& row) {
+        ReadState state;
+        state.friendPk = row[0].toString();
+        state.lastReadId = row[1].toLongLong();
+        state.unreadCount = row[2].toInt();
+        states += state;
+    };
+
+    db->execNowRead({QStringLiteral("SELECT peers.public_key, last_read_id, unread_count "
+                                    "FROM chat_read_state "
+                                    "JOIN peers ON peers.id = chat_read_state.chat_id;"),
+                     rowCallback});
+
+    return states;
+}
+
+/**
+ * @brief Lists the URLs posted in a conversation, newest first.
+ * @param friendPk Conversation to list links for.
+ * @param maxNum Cap on the number of returned links.
+ *
+ * Served entirely from the message_urls covering index - message bodies are
+ * never read. Only messages inserted since the index was introduced are in
+ * it; older history is not mined retroactively.
+ */
+QList<History::UrlEntry> History::getUrlsForFriend(const ToxPk& friendPk, size_t maxNum)
+{
+    QList<UrlEntry> urls;
+    auto rowCallback = [&urls](const QVector<QVariant>& row) {
+        UrlEntry entry;
+        entry.timestamp = QDateTime::fromMSecsSinceEpoch(row[0].toLongLong());
+        entry.url = row[1].toString();
+        urls += entry;
+    };
+
+    QString queryText =
+        QStringLiteral("SELECT timestamp, url FROM message_urls "
+                       "WHERE chat_id = (SELECT id FROM peers WHERE public_key='%1') "
+                       "ORDER BY timestamp DESC LIMIT %2;")
+            .arg(friendPk.toString())
+            .arg(maxNum);
+
+    db->execNowRead({queryText, rowCallback});
+
+    return urls;
+}
+
+/**
+ * @brief Lists the file transfers of a conversation, newest first.
+ * @param friendPk Conversation to list transfers for.
+ * @param maxNum Cap on the number of returned transfers.
+ *
+ * Backs the media gallery: the chat's rows are found through the
+ * file_transfers chat index directly, without joining or scanning the
+ * message table at all.
+ */
+QList<ToxFile> History::getFileTransfersForFriend(const ToxPk& friendPk, size_t maxNum)
+{
+    QList<ToxFile> files;
+    auto rowCallback = [&files](const QVector<QVariant>& row) {
+        ToxFile file;
+        file.fileKind = TOX_FILE_KIND_DATA;
+        file.resumeFileId = row[0].toString().toUtf8();
+        file.filePath = row[1].toString();
+        file.fileName = row[2].toString();
+        file.filesize = row[3].toLongLong();
+        file.direction = static_cast<ToxFile::FileDirection>(row[4].toLongLong());
+        file.status = static_cast<ToxFile::FileStatus>(row[5].toInt());
+        files += file;
+    };
+
+    QString queryText =
+        QStringLiteral("SELECT file_restart_id, file_path, file_name, "
+                       "file_size, direction, file_state FROM file_transfers "
+                       "WHERE chat_id = (SELECT id FROM peers WHERE public_key='%1') "
+                       "ORDER BY id DESC LIMIT %2;")
+            .arg(friendPk.toString())
+            .arg(maxNum);
+
+    db->execNowRead({queryText, rowCallback});
+
+    return files;
+}
+
+/**
+ * @brief Lists every file transfer in the database, newest first.
+ *
+ * Backs the global file history browser. The selected columns are exactly the
+ * columns of file_transfers_browser_idx and the ordering is the index's
+ * leading column, so the whole answer is an index-only scan of that index -
+ * no table rows are fetched and no sort step runs, regardless of how large
+ * the profile is. The conversation keys are resolved from a read of the tiny
+ * peers table instead of a join, which would drag the row lookups back in.
+ */
+QList<History::FileHistoryEntry> History::getAllFileTransfers()
+{
+    QHash<int64_t, QString> peerKeys;
+    db->execNowRead({QStringLiteral("SELECT id, public_key FROM peers;"),
+                     [&peerKeys](const QVector<QVariant>& row) {
+                         peerKeys[row[0].toLongLong()] = row[1].toString();
+                     }});
+
+    QList<FileHistoryEntry> entries;
+    auto rowCallback = [&entries, &peerKeys](const QVector<QVariant>& row) {
+        FileHistoryEntry entry;
+        entry.timestamp = QDateTime::fromMSecsSinceEpoch(row[0].toLongLong());
+        entry.chatPk = peerKeys.value(row[1].toLongLong());
+        entry.file.fileKind = TOX_FILE_KIND_DATA;
+        entry.file.filesize = row[2].toLongLong();
+        entry.file.direction = static_cast<ToxFile::FileDirection>(row[3].toLongLong());
+        entry.file.status = static_cast<ToxFile::FileStatus>(row[4].toInt());
+        entry.file.fileName = row[5].toString();
+        entry.file.filePath = row[6].toString();
+        entries += entry;
+    };
+
+    db->execNowRead(
+        {QStringLiteral("SELECT timestamp, chat_id, file_size, direction, file_state, "
+                        "file_name, file_path FROM file_transfers "
+                        "ORDER BY timestamp DESC;"),
+         rowCallback});
+
+    return entries;
+}
+
 /**
  * @brief Gets date boundaries in conversation with friendPk. History doesn't model conversation indexes,
  * but we can count messages between us and friendPk to effectively give us an index. This function
@@ -736,52 +1862,54 @@ QDateTime History::getDateWhereFindPhrase(const QString& friendPk, const QDateTi
  * @param[in] maxNum Maximum number of date boundaries to retrieve
  * @note This API may seem a little strange, why not use QDate from and QDate to? The intent is to
  * have an API that can be used to get the first item after a date (for search) and to get a list
- * of date changes (for loadHistory). We could write two separate queries but the query is fairly
- * intricate compared to our other ones so reducing duplication of it is preferable.
+ * of date changes (for loadHistory), serving both from one code path.
+ * @note Answered entirely from the chat_day_counts table maintained at insert
+ * time - one row per (chat, day) - so large conversations resolve a calendar
+ * date without aggregating over their message rows.
  */
-QList<History::DateIdx> History::getNumMessagesForFriendBeforeDateBoundaries(const ToxPk& friendPk,
+QList<History::DateIdx> History::getNumMessagesForFriendBeforeDateBoundaries(const ContactId& chatId,
                                                                              const QDate& from,
                                                                              size_t maxNum)
 {
-    auto friendPkString = friendPk.toString();
-
-    // No guarantee that this is the most efficient way to do this...
-    // We want to count messages that happened for a friend before a
-    // certain date. We do this by re-joining our table a second time
-    // but this time with the only filter being that our id is less than
-    // the ID of the corresponding row in the table that is grouped by day
-    auto countMessagesForFriend =
-        QString("SELECT COUNT(*) - 1 " // Count - 1 corresponds to 0 indexed message id for friend
-                "FROM history countHistory "            // Import unfiltered table as countHistory
-                "JOIN peers chat ON chat_id = chat.id " // link chat_id to chat.id
-                "WHERE chat.public_key = '%1'"          // filter this conversation
-                "AND countHistory.id <= history.id") // and filter that our unfiltered table history id only has elements up to history.id
-            .arg(friendPkString);
+    // Same cache-miss fallback as getNumMessagesForFriendBeforeDate
+    const QString pkString = chatId.toString();
+    const QString chatIdExpr =
+        peers.contains(pkString)
+            ? QString::number(peers[pkString])
+            : QString("(SELECT id FROM peers WHERE public_key='%1')").arg(pkString);
+    const int64_t fromDay = QDateTime(from).toMSecsSinceEpoch() / MS_PER_DAY;
+
+    // The first requested day's index is the sum of every earlier day's
+    // counter; each following day's index is then a running sum over the
+    // returned rows, so nothing here ever touches the message table
+    int64_t numMessagesBefore = 0;
+    db->execNowRead({QString("SELECT COALESCE(SUM(count), 0) FROM chat_day_counts "
+                             "WHERE chat_id=%1 AND day < %2;")
+                         .arg(chatIdExpr)
+                         .arg(fromDay),
+                     [&numMessagesBefore](const QVector<QVariant>& row) {
+                         numMessagesBefore = row[0].toLongLong();
+                     }});
 
     auto limitString = (maxNum) ? QString("LIMIT %1").arg(maxNum) : QString("");
 
-    auto queryString = QString("SELECT (%1), (timestamp / 1000 / 60 / 60 / 24) AS day "
-                               "FROM history "
-                               "JOIN peers chat ON chat_id = chat.id "
-                               "WHERE chat.public_key = '%2' "
-                               "AND timestamp >= %3 "
-                               "GROUP by day "
-                               "%4;")
-                           .arg(countMessagesForFriend)
-                           .arg(friendPkString)
-                           .arg(QDateTime(from).toMSecsSinceEpoch())
+    auto queryString = QString("SELECT day, count FROM chat_day_counts "
+                               "WHERE chat_id=%1 AND day >= %2 "
+                               "ORDER BY day %3;")
+                           .arg(chatIdExpr)
+                           .arg(fromDay)
                            .arg(limitString);
 
     QList<DateIdx> dateIdxs;
-    auto rowCallback = [&dateIdxs](const QVector<QVariant>& row) {
+    auto rowCallback = [&dateIdxs, &numMessagesBefore](const QVector<QVariant>& row) {
         DateIdx dateIdx;
-        dateIdx.numMessagesIn = row[0].toLongLong();
-        dateIdx.date =
-            QDateTime::fromMSecsSinceEpoch(row[1].toLongLong() * 24 * 60 * 60 * 1000).date();
+        dateIdx.numMessagesIn = numMessagesBefore;
+        dateIdx.date = QDateTime::fromMSecsSinceEpoch(row[0].toLongLong() * MS_PER_DAY).date();
         dateIdxs.append(dateIdx);
+        numMessagesBefore += row[1].toLongLong();
     };
 
-    db->execNow({queryString, rowCallback});
+    db->execNowRead({queryString, rowCallback});
 
     return dateIdxs;
 }
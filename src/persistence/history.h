@@ -23,10 +23,12 @@
 #include <QDateTime>
 #include <QHash>
 #include <QPointer>
+#include <QSet>
 #include <QVector>
 
 #include <cassert>
 #include <cstdint>
+#include <new>
 #include <tox/toxencryptsave.h>
 
 #include "src/core/toxfile.h"
@@ -36,6 +38,7 @@
 
 class Profile;
 class HistoryKeeper;
+class QIODevice;
 
 enum class HistMessageContentType
 {
@@ -47,14 +50,59 @@ class HistMessageContent
 {
 public:
     HistMessageContent(QString message)
-        : data(std::make_shared<QString>(std::move(message)))
-        , type(HistMessageContentType::message)
-    {}
+        : type(HistMessageContentType::message)
+    {
+        new (&content.message) QString(std::move(message));
+    }
 
     HistMessageContent(ToxFile file)
-        : data(std::make_shared<ToxFile>(std::move(file)))
-        , type(HistMessageContentType::file)
-    {}
+        : type(HistMessageContentType::file)
+    {
+        new (&content.file) ToxFile(std::move(file));
+    }
+
+    HistMessageContent(const HistMessageContent& other)
+        : type(other.type)
+    {
+        if (type == HistMessageContentType::message) {
+            new (&content.message) QString(other.content.message);
+        } else {
+            new (&content.file) ToxFile(other.content.file);
+        }
+    }
+
+    HistMessageContent(HistMessageContent&& other) noexcept
+        : type(other.type)
+    {
+        if (type == HistMessageContentType::message) {
+            new (&content.message) QString(std::move(other.content.message));
+        } else {
+            new (&content.file) ToxFile(std::move(other.content.file));
+        }
+    }
+
+    HistMessageContent& operator=(const HistMessageContent& other)
+    {
+        if (this != &other) {
+            destroy();
+            new (this) HistMessageContent(other);
+        }
+        return *this;
+    }
+
+    HistMessageContent& operator=(HistMessageContent&& other) noexcept
+    {
+        if (this != &other) {
+            destroy();
+            new (this) HistMessageContent(std::move(other));
+        }
+        return *this;
+    }
+
+    ~HistMessageContent()
+    {
+        destroy();
+    }
 
     HistMessageContentType getType() const
     {
@@ -64,30 +112,46 @@ public:
     QString& asMessage()
     {
         assert(type == HistMessageContentType::message);
-        return *static_cast<QString*>(data.get());
+        return content.message;
     }
 
     ToxFile& asFile()
     {
         assert(type == HistMessageContentType::file);
-        return *static_cast<ToxFile*>(data.get());
+        return content.file;
     }
 
     const QString& asMessage() const
     {
         assert(type == HistMessageContentType::message);
-        return *static_cast<QString*>(data.get());
+        return content.message;
     }
 
     const ToxFile& asFile() const
     {
         assert(type == HistMessageContentType::file);
-        return *static_cast<ToxFile*>(data.get());
+        return content.file;
     }
 
 private:
-    // Not really shared but shared_ptr has support for shared_ptr<void>
-    std::shared_ptr<void> data;
+    void destroy()
+    {
+        if (type == HistMessageContentType::message) {
+            content.message.~QString();
+        } else {
+            content.file.~ToxFile();
+        }
+    }
+
+    // Tagged union keeping the payload inline, so loading a page of history
+    // doesn't perform an extra heap allocation per row
+    union Content
+    {
+        Content() {}
+        ~Content() {}
+        QString message;
+        ToxFile file;
+    } content;
     HistMessageContentType type;
 };
 
@@ -102,6 +166,7 @@ struct FileDbInsertionData
     QString filePath;
     int64_t size;
     int direction;
+    int64_t timestamp;
 };
 Q_DECLARE_METATYPE(FileDbInsertionData);
 
@@ -149,6 +214,49 @@ public:
         size_t numMessagesIn;
     };
 
+    // Materialized unread bookkeeping of one conversation
+    struct ReadState
+    {
+        QString friendPk;
+        int64_t lastReadId;
+        int unreadCount;
+    };
+
+    // One entry of a conversation's link gallery
+    struct UrlEntry
+    {
+        QDateTime timestamp;
+        QString url;
+    };
+
+    // One row of the global file history browser: a transfer plus the
+    // conversation it belongs to and when it happened
+    struct FileHistoryEntry
+    {
+        QDateTime timestamp;
+        QString chatPk;
+        ToxFile file;
+    };
+
+    // One global search match. friendPk and timestamp are enough for the
+    // per-chat search machinery to jump to the message in context; snippet
+    // is the text to show in the result list.
+    struct GlobalSearchHit
+    {
+        QString friendPk;
+        QDateTime timestamp;
+        QString snippet;
+    };
+
+    enum class ExportFormat
+    {
+        PlainText,
+        Json
+    };
+
+    /// Invoked after each exported chunk with (exported, total), return false to abort
+    using ExportProgressFn = std::function<bool(size_t, size_t)>;
+
 public:
     explicit History(std::shared_ptr<RawDatabase> db);
     ~History();
@@ -163,18 +271,36 @@ public:
                        const QDateTime& time, bool isSent, QString dispName,
                        const std::function<void(RowId)>& insertIdCallback = {});
 
+    void queueNewMessage(const QString& friendPk, const QString& message, const QString& sender,
+                         const QDateTime& time, bool isSent, QString dispName,
+                         const std::function<void(RowId)>& insertIdCallback = {});
+    void flushQueuedMessages();
+
     void addNewFileMessage(const QString& friendPk, const QString& fileId,
                            const QString& fileName, const QString& filePath, int64_t size,
                            const QString& sender, const QDateTime& time, QString const& dispName);
 
     void setFileFinished(const QString& fileId, bool success, const QString& filePath, const QByteArray& fileHash);
-    size_t getNumMessagesForFriend(const ToxPk& friendPk);
-    size_t getNumMessagesForFriendBeforeDate(const ToxPk& friendPk, const QDateTime& date);
-    QList<HistMessage> getMessagesForFriend(const ToxPk& friendPk, size_t firstIdx, size_t lastIdx);
+    void setFileCompletedBytes(const QString& fileId, quint64 completedBytes);
+    quint64 getFileCompletedBytes(const QString& fileId);
+    // The "ForFriend" family is keyed by the chat's ContactId, so group
+    // conversations (keyed by GroupId) share the storage, indexing and
+    // pagination that 1:1 chats use
+    size_t getNumMessagesForFriend(const ContactId& chatId);
+    size_t getNumMessagesForFriendBeforeDate(const ContactId& chatId, const QDateTime& date);
+    QList<HistMessage> getMessagesForFriend(const ContactId& chatId, size_t firstIdx, size_t lastIdx);
     QList<HistMessage> getUnsentMessagesForFriend(const ToxPk& friendPk);
+    bool exportHistory(const ToxPk& friendPk, QIODevice& device, ExportFormat format,
+                       const ExportProgressFn& progressCallback = {});
     QDateTime getDateWhereFindPhrase(const QString& friendPk, const QDateTime& from, QString phrase,
                                      const ParameterSearch& parameter);
-    QList<DateIdx> getNumMessagesForFriendBeforeDateBoundaries(const ToxPk& friendPk,
+    QList<GlobalSearchHit> globalSearchHistory(QString phrase, size_t maxHits = 100);
+    void markConversationRead(const ToxPk& friendPk);
+    QList<ReadState> getReadStates();
+    QList<UrlEntry> getUrlsForFriend(const ToxPk& friendPk, size_t maxNum = 100);
+    QList<ToxFile> getFileTransfersForFriend(const ToxPk& friendPk, size_t maxNum = 100);
+    QList<FileHistoryEntry> getAllFileTransfers();
+    QList<DateIdx> getNumMessagesForFriendBeforeDateBoundaries(const ContactId& chatId,
                                                                const QDate& from, size_t maxNum);
 
     void markAsSent(RowId messageId);
@@ -196,10 +322,28 @@ private slots:
 private:
     static RawDatabase::Query generateFileFinished(RowId fileId, bool success,
                                                    const QString& filePath, const QByteArray& fileHash);
+    bool initFtsIndex();
+    void compressExistingRows();
+    void initPartitions();
+    void createPartition(int64_t chatId);
     std::shared_ptr<RawDatabase> db;
+    bool fts5Enabled = false;
+    QVector<RawDatabase::Query> queuedMessageQueries;
 
 
     QHash<QString, int64_t> peers;
+
+    // Write-through cache of alias rows, keyed by "<owner id>\n<display name>".
+    // Keying on the display name makes rename invalidation automatic: a
+    // renamed sender simply misses and gets a fresh alias row.
+    QHash<QString, int64_t> aliases;
+
+    // Opt-in partitioning for oversized conversations (QTOX_HISTORY_PARTITION):
+    // chats in this set have a per-conversation rowid table serving the
+    // seek and count paths, so one pathological chat stops taxing the shared
+    // chat index. See initPartitions().
+    bool partitioningEnabled = false;
+    QSet<qint64> partitionedChats;
     struct FileInfo
     {
         bool finished = false;
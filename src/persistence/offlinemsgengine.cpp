@@ -28,12 +28,30 @@
 #include <QCoreApplication>
 #include <chrono>
 
+namespace {
+// must cover the resend batch size, which puts up to 100 receipts in
+// flight back to back; power of two keeps the slot index a simple mask
+constexpr int receiptWindowSize = 128;
+} // namespace
+
 OfflineMsgEngine::OfflineMsgEngine(Friend* frnd, ICoreFriendMessageSender* messageSender)
     : mutex(QMutex::Recursive)
     , f(frnd)
     , messageSender(messageSender)
+    , receiptWindow(receiptWindowSize)
 {}
 
+/**
+* @brief Maps a receipt number onto its ring slot.
+*
+* Receipts are sequential, so consecutive in-flight messages occupy distinct
+* slots until more than receiptWindowSize are outstanding at once.
+*/
+OfflineMsgEngine::ReceiptSlot& OfflineMsgEngine::slotFor(ReceiptNum receipt)
+{
+    return receiptWindow[receipt.get() % receiptWindowSize];
+}
+
 /**
 * @brief Notification that the message is now delivered.
 *
@@ -42,12 +60,40 @@ OfflineMsgEngine::OfflineMsgEngine(Friend* frnd, ICoreFriendMessageSender* messa
 void OfflineMsgEngine::onReceiptReceived(ReceiptNum receipt)
 {
     QMutexLocker ml(&mutex);
-    if (receivedReceipts.contains(receipt)) {
+    ReceiptSlot& slot = slotFor(receipt);
+    if (slot.state != ReceiptSlot::State::Empty && slot.receipt == receipt.get()) {
+        if (slot.state == ReceiptSlot::State::AwaitingMessage) {
+            qWarning() << "Receievd duplicate receipt" << receipt.get() << "from friend"
+                       << f->getId();
+            return;
+        }
+        CompletionFn completionFn = std::move(slot.message.completionFn);
+        slot = ReceiptSlot{};
+        completionFn();
+        return;
+    }
+
+    const auto spilledIt = spilledMessages.find(receipt);
+    if (spilledIt != spilledMessages.end()) {
+        CompletionFn completionFn = std::move(spilledIt->completionFn);
+        spilledMessages.erase(spilledIt);
+        completionFn();
+        return;
+    }
+
+    if (slot.state == ReceiptSlot::State::Empty) {
+        // receipt raced ahead of addSentMessage, park it in the slot
+        slot.state = ReceiptSlot::State::AwaitingMessage;
+        slot.receipt = receipt.get();
+        return;
+    }
+
+    // the slot is held by another in-flight receipt
+    if (spilledReceipts.contains(receipt)) {
         qWarning() << "Receievd duplicate receipt" << receipt.get() << "from friend" << f->getId();
         return;
     }
-    receivedReceipts.append(receipt);
-    checkForCompleteMessages(receipt);
+    spilledReceipts.insert(receipt);
 }
 
 /**
@@ -79,13 +125,36 @@ void OfflineMsgEngine::addSentMessage(ReceiptNum receipt, Message const& message
                                       CompletionFn completionCallback)
 {
     QMutexLocker ml(&mutex);
-    assert(!sentMessages.contains(receipt));
-    sentMessages.insert(receipt, {message, std::chrono::steady_clock::now(), completionCallback});
-    checkForCompleteMessages(receipt);
+    ReceiptSlot& slot = slotFor(receipt);
+    if (slot.state == ReceiptSlot::State::AwaitingMessage && slot.receipt == receipt.get()) {
+        // the receipt already came in, the message is complete on arrival
+        slot = ReceiptSlot{};
+        completionCallback();
+        return;
+    }
+
+    if (spilledReceipts.remove(receipt)) {
+        completionCallback();
+        return;
+    }
+
+    if (slot.state == ReceiptSlot::State::Empty) {
+        slot.state = ReceiptSlot::State::AwaitingReceipt;
+        slot.receipt = receipt.get();
+        slot.message = OfflineMessage{message, std::chrono::steady_clock::now(), completionCallback};
+        return;
+    }
+
+    assert(!spilledMessages.contains(receipt));
+    spilledMessages.insert(receipt, {message, std::chrono::steady_clock::now(), completionCallback});
 }
 
 /**
 * @brief Deliver all messages, used when a friend comes online.
+*
+* Messages are re-dispatched in authorship order, but rate-limited: only a
+* bounded batch is handed to the core per tick, so a deep backlog after an
+* outage doesn't flood the core thread in one go.
 */
 void OfflineMsgEngine::deliverOfflineMsgs()
 {
@@ -95,18 +164,62 @@ void OfflineMsgEngine::deliverOfflineMsgs()
         return;
     }
 
-    if (sentMessages.empty() && unsentMessages.empty()) {
+    if (!resendQueue.empty()) {
+        // A re-dispatch is already draining, newly queued messages ride along
+        return;
+    }
+
+    resendQueue = unsentMessages;
+    for (ReceiptSlot& slot : receiptWindow) {
+        if (slot.state == ReceiptSlot::State::AwaitingReceipt) {
+            resendQueue.append(slot.message);
+        }
+        // stale early receipts don't survive a reconnect either
+        slot = ReceiptSlot{};
+    }
+    for (const OfflineMessage& message : spilledMessages) {
+        resendQueue.append(message);
+    }
+    spilledReceipts.clear();
+    spilledMessages.clear();
+    unsentMessages.clear();
+
+    if (resendQueue.isEmpty()) {
         return;
     }
 
-    QVector<OfflineMessage> messages = sentMessages.values().toVector() + unsentMessages;
     // order messages by authorship time to resend in same order as they were written
-    std::sort(messages.begin(), messages.end(), [](const OfflineMessage& lhs, const OfflineMessage& rhs) {
-        return lhs.authorshipTime < rhs.authorshipTime;
-    });
-    removeAllMessages();
+    std::sort(resendQueue.begin(), resendQueue.end(),
+              [](const OfflineMessage& lhs, const OfflineMessage& rhs) {
+                  return lhs.authorshipTime < rhs.authorshipTime;
+              });
+
+    processResendQueue();
+}
 
-    for (const auto& message : messages) {
+/**
+* @brief Sends one batch from the resend queue, rescheduling itself while
+* messages remain.
+*/
+void OfflineMsgEngine::processResendQueue()
+{
+    QMutexLocker ml(&mutex);
+
+    if (!f->isOnline()) {
+        // Give the remainder back, the next reconnect re-dispatches it
+        for (const auto& message : resendQueue) {
+            unsentMessages.append(message);
+        }
+        resendQueue.clear();
+        return;
+    }
+
+    static constexpr int MAX_RESEND_BATCH = 100;
+    static constexpr int RESEND_INTERVAL_MS = 50;
+
+    const int batchSize = qMin(resendQueue.size(), MAX_RESEND_BATCH);
+    for (int i = 0; i < batchSize; ++i) {
+        const auto& message = resendQueue[i];
         QString messageText = message.message.content;
         ReceiptNum receipt;
         bool messageSent{false};
@@ -122,6 +235,11 @@ void OfflineMsgEngine::deliverOfflineMsgs()
             addUnsentMessage(message.message, message.completionFn);
         }
     }
+    resendQueue.remove(0, batchSize);
+
+    if (!resendQueue.isEmpty()) {
+        QTimer::singleShot(RESEND_INTERVAL_MS, this, SLOT(processResendQueue()));
+    }
 }
 
 /**
@@ -130,24 +248,9 @@ void OfflineMsgEngine::deliverOfflineMsgs()
 void OfflineMsgEngine::removeAllMessages()
 {
     QMutexLocker ml(&mutex);
-    receivedReceipts.clear();
-    sentMessages.clear();
+    receiptWindow.fill(ReceiptSlot{});
+    spilledReceipts.clear();
+    spilledMessages.clear();
     unsentMessages.clear();
-}
-
-void OfflineMsgEngine::completeMessage(QMap<ReceiptNum, OfflineMessage>::iterator msgIt)
-{
-    msgIt->completionFn();
-    sentMessages.erase(msgIt);
-    receivedReceipts.removeOne(msgIt.key());
-}
-
-void OfflineMsgEngine::checkForCompleteMessages(ReceiptNum receipt)
-{
-    auto msgIt = sentMessages.find(receipt);
-    const bool receiptReceived = receivedReceipts.contains(receipt);
-    if (!receiptReceived || msgIt == sentMessages.end()) {
-        return;
-    }
-    completeMessage(msgIt);
+    resendQueue.clear();
 }
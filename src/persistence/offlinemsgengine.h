@@ -25,7 +25,7 @@
 #include "src/model/message.h"
 #include "src/persistence/db/rawdatabase.h"
 #include <QDateTime>
-#include <QMap>
+#include <QHash>
 #include <QMutex>
 #include <QObject>
 #include <QSet>
@@ -57,18 +57,37 @@ private:
         CompletionFn completionFn;
     };
 
+    // toxcore assigns receipts sequentially per friend and they come back
+    // approximately in order, so in-flight bookkeeping lives in a fixed ring
+    // indexed by receipt number; the hash/set spill below only kicks in when
+    // more messages than the window holds are in flight at once
+    struct ReceiptSlot
+    {
+        enum class State
+        {
+            Empty,
+            AwaitingReceipt, // message registered, receipt outstanding
+            AwaitingMessage, // receipt arrived before addSentMessage
+        };
+        State state = State::Empty;
+        uint32_t receipt = 0;
+        OfflineMessage message;
+    };
+
 private slots:
-    void completeMessage(QMap<ReceiptNum, OfflineMessage>::iterator msgIt);
+    void processResendQueue();
 
 private:
-    void checkForCompleteMessages(ReceiptNum receipt);
+    ReceiptSlot& slotFor(ReceiptNum receipt);
 
     QMutex mutex;
     const Friend* f;
     ICoreFriendMessageSender* messageSender;
-    QVector<ReceiptNum> receivedReceipts;
-    QMap<ReceiptNum, OfflineMessage> sentMessages;
+    QVector<ReceiptSlot> receiptWindow;
+    QSet<ReceiptNum> spilledReceipts;
+    QHash<ReceiptNum, OfflineMessage> spilledMessages;
     QVector<OfflineMessage> unsentMessages;
+    QVector<OfflineMessage> resendQueue;
 };
 
 #endif // OFFLINEMSGENGINE_H
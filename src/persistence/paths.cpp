@@ -71,6 +71,12 @@ const QLatin1Literal TCSToxFileFolder{"~/.config/tox/"};
  * @endcode
  *
  * All qTox or Tox specific directories should be looked up through this module.
+ *
+ * Every location is resolved once, when the object is constructed, so the
+ * getters are plain member reads instead of re-probing the filesystem on
+ * every call. A Paths object is an immutable snapshot: when the portable
+ * mode changes, build a new one through makePaths() instead of mutating the
+ * old snapshot.
  */
 
 /**
@@ -119,7 +125,79 @@ Paths* Paths::makePaths(Portable mode)
 Paths::Paths(const QString& basePath, bool portable)
     : basePath{basePath}
     , portable{portable}
-{}
+{
+    loadSnapshot();
+}
+
+/**
+ * @brief Resolves every directory location into the snapshot members.
+ */
+void Paths::loadSnapshot()
+{
+    // global settings file
+    if (portable) {
+        // we assume a writeable path for portable mode
+        globalSettingsPath = basePath % QDir::separator() % globalSettingsFile;
+    } else {
+        const QString path = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+        if (path.isEmpty()) {
+            qDebug() << "Can't find writable location for settings file";
+        } else {
+            globalSettingsPath = path % QDir::separator() % globalSettingsFile;
+        }
+    }
+
+    profilesDir = basePath % QDir::separator() % profileFolder % QDir::separator();
+
+    // Tox save directory
+    if (portable) {
+        toxSaveDir = basePath % QDir::separator() % profileFolder % QDir::separator();
+    } else {
+        // GenericDataLocation would be a better solution, but we keep this code for backward
+        // compatibility
+
+// workaround for https://bugreports.qt-project.org/browse/QTBUG-38845
+#ifdef Q_OS_WIN
+        // TODO(sudden6): this doesn't really follow the Tox Client Standard and probably
+        // breaks when %APPDATA% is changed
+        toxSaveDir = QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
+                                     + QDir::separator() + "AppData" + QDir::separator() + "Roaming"
+                                     + QDir::separator() + "tox")
+                     + QDir::separator();
+#elif defined(Q_OS_OSX)
+        toxSaveDir = QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
+                                     + QDir::separator() + "Library" + QDir::separator()
+                                     + "Application Support" + QDir::separator() + "Tox")
+                     + QDir::separator();
+#else
+        // TODO(sudden6): This does not respect the XDG_* environment variables and also
+        // stores user data in a config location
+        toxSaveDir = QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation)
+                                     + QDir::separator() + "tox")
+                     + QDir::separator();
+#endif
+    }
+
+    // follow the layout in
+    // https://tox.gitbooks.io/tox-client-standard/content/data_storage/export_format.html
+    if (toxSaveDir.isEmpty()) {
+        qDebug() << "Can't find location for avatars directory";
+    } else {
+        avatarsDir = toxSaveDir % avatarsFolder % QDir::separator();
+    }
+
+    transfersDir = basePath % QDir::separator() % transfersFolder % QDir::separator();
+    screenshotsDir = basePath % QDir::separator() % screenshotsFolder % QDir::separator();
+
+    if (!portable) {
+        themeDirs += QStandardPaths::locate(QStandardPaths::AppDataLocation, themeFolder,
+                                            QStandardPaths::LocateDirectory);
+    }
+
+    // look for themes beside the qTox binary with lowest priority
+    const QString curPath = qApp->applicationDirPath();
+    themeDirs += curPath % QDir::separator() % themeFolder % QDir::separator();
+}
 
 /**
  * @brief Check if qTox is running in portable mode.
@@ -136,21 +214,7 @@ bool Paths::isPortable() const
  */
 QString Paths::getGlobalSettingsPath() const
 {
-    QString path;
-
-    if (portable) {
-        path = basePath;
-    } else {
-        path = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
-        if (path.isEmpty()) {
-            qDebug() << "Can't find writable location for settings file";
-            return {};
-        }
-    }
-
-    // we assume a writeable path for portable mode
-
-    return path % QDir::separator() % globalSettingsFile;
+    return globalSettingsPath;
 }
 
 /**
@@ -159,7 +223,7 @@ QString Paths::getGlobalSettingsPath() const
  */
 QString Paths::getProfilesDir() const
 {
-    return basePath % QDir::separator() % profileFolder % QDir::separator();
+    return profilesDir;
 }
 
 /**
@@ -169,33 +233,7 @@ QString Paths::getProfilesDir() const
  */
 QString Paths::getToxSaveDir() const
 {
-    if (isPortable()) {
-        return basePath % QDir::separator() % profileFolder % QDir::separator();
-    }
-
-        // GenericDataLocation would be a better solution, but we keep this code for backward
-        // compatibility
-
-// workaround for https://bugreports.qt-project.org/browse/QTBUG-38845
-#ifdef Q_OS_WIN
-    // TODO(sudden6): this doesn't really follow the Tox Client Standard and probably
-    // breaks when %APPDATA% is changed
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
-                           + QDir::separator() + "AppData" + QDir::separator() + "Roaming"
-                           + QDir::separator() + "tox")
-           + QDir::separator();
-#elif defined(Q_OS_OSX)
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
-                           + QDir::separator() + "Library" + QDir::separator()
-                           + "Application Support" + QDir::separator() + "Tox")
-           + QDir::separator();
-#else
-    // TODO(sudden6): This does not respect the XDG_* environment variables and also
-    // stores user data in a config location
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation)
-                           + QDir::separator() + "tox")
-           + QDir::separator();
-#endif
+    return toxSaveDir;
 }
 
 /**
@@ -205,15 +243,7 @@ QString Paths::getToxSaveDir() const
  */
 QString Paths::getAvatarsDir() const
 {
-    // follow the layout in
-    // https://tox.gitbooks.io/tox-client-standard/content/data_storage/export_format.html
-    QString path = getToxSaveDir();
-    if (path.isEmpty()) {
-        qDebug() << "Can't find location for avatars directory";
-        return {};
-    }
-
-    return path % avatarsFolder % QDir::separator();
+    return avatarsDir;
 }
 
 /**
@@ -222,7 +252,7 @@ QString Paths::getAvatarsDir() const
  */
 QString Paths::getScreenshotsDir() const
 {
-    return basePath % QDir::separator() % screenshotsFolder % QDir::separator();
+    return screenshotsDir;
 }
 
 /**
@@ -231,7 +261,7 @@ QString Paths::getScreenshotsDir() const
  */
 QString Paths::getTransfersDir() const
 {
-    return basePath % QDir::separator() % transfersFolder % QDir::separator();
+    return transfersDir;
 }
 
 /**
@@ -241,16 +271,5 @@ QString Paths::getTransfersDir() const
  */
 QStringList Paths::getThemeDirs() const
 {
-    QStringList themeFolders{};
-
-    if (!isPortable()) {
-        themeFolders += QStandardPaths::locate(QStandardPaths::AppDataLocation, themeFolder,
-                                               QStandardPaths::LocateDirectory);
-    }
-
-    // look for themes beside the qTox binary with lowest priority
-    const QString curPath = qApp->applicationDirPath();
-    themeFolders += curPath % QDir::separator() % themeFolder % QDir::separator();
-
-    return themeFolders;
+    return themeDirs;
 }
@@ -45,10 +45,20 @@ public:
 
 private:
     Paths(const QString &basePath, bool portable);
+    void loadSnapshot();
 
 private:
     QString basePath{};
     bool portable = false;
+
+    // resolved once at construction; a Paths object is an immutable snapshot
+    QString globalSettingsPath;
+    QString profilesDir;
+    QString toxSaveDir;
+    QString avatarsDir;
+    QString transfersDir;
+    QString screenshotsDir;
+    QStringList themeDirs;
 };
 
 #endif // PATHS_H
@@ -18,13 +18,19 @@
 */
 
 #include <QBuffer>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QObject>
 #include <QSaveFile>
 #include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
 
+#include <atomic>
 #include <cassert>
 #include <sodium.h>
 
@@ -33,14 +39,29 @@
 #include "settings.h"
 #include "src/core/core.h"
 #include "src/core/coreav.h"
+#include "src/core/coreeventlog.h"
 #include "src/core/corefile.h"
 #include "src/net/avatarbroadcaster.h"
 #include "src/nexus.h"
+#include "src/util/asynctask.h"
+#include "src/util/startupprofiler.h"
 #include "src/widget/gui.h"
 #include "src/widget/tool/identicon.h"
 #include "src/widget/widget.h"
 
 namespace {
+// long enough to swallow a burst of saveRequest signals, short enough that
+// a crash loses next to nothing
+constexpr int saveDebounceIntervalMs = 1000;
+
+// LRU budget for full-size decoded avatars, in kilobytes of pixel data
+constexpr int avatarCacheBudgetKb = 24 * 1024;
+
+int pixmapCostKb(const QPixmap& pic)
+{
+    return pic.width() * pic.height() * pic.depth() / 8 / 1024 + 1;
+}
+
 enum class LoadToxDataError
 {
     OK = 0,
@@ -67,35 +88,52 @@ enum class CreateToxDataError
  * @param password The password to use to unlock the tox file.
  * @param filePath The path to the tox save file.
  * @param data A QByteArray reference where data will be stored.
+ * @param mappedFile Receives the QFile keeping a memory-mapped save alive.
  * @param error A LoadToxDataError enum value indicating operation result.
  * @return Pointer to the tox encryption key.
+ *
+ * Unencrypted saves are memory-mapped and handed to toxcore as-is: data is a
+ * raw view into the mapping, which stays valid for as long as the caller
+ * holds mappedFile - it has to outlive tox_new, which is where toxcore
+ * copies the state out. Encrypted saves decrypt straight from the mapping
+ * into the single plaintext buffer, so neither path reads the file into an
+ * intermediate heap copy first.
  */
 std::unique_ptr<ToxEncrypt> loadToxData(const QString& password, const QString& filePath,
-                                        QByteArray& data, LoadToxDataError& error)
+                                        QByteArray& data, std::unique_ptr<QFile>& mappedFile,
+                                        LoadToxDataError& error)
 {
     std::unique_ptr<ToxEncrypt> tmpKey = nullptr;
     qint64 fileSize = 0;
+    uchar* mapped = nullptr;
 
-    QFile saveFile(filePath);
+    std::unique_ptr<QFile> saveFile(new QFile(filePath));
     qDebug() << "Loading tox save " << filePath;
 
-    if (!saveFile.exists()) {
+    if (!saveFile->exists()) {
         error = LoadToxDataError::FILE_NOT_FOUND;
         goto fail;
     }
 
-    if (!saveFile.open(QIODevice::ReadOnly)) {
+    if (!saveFile->open(QIODevice::ReadOnly)) {
         error = LoadToxDataError::COULD_NOT_READ_FILE;
         goto fail;
     }
 
-    fileSize = saveFile.size();
+    fileSize = saveFile->size();
     if (fileSize <= 0) {
         error = LoadToxDataError::FILE_IS_EMPTY;
         goto fail;
     }
 
-    data = saveFile.readAll();
+    mapped = saveFile->map(0, fileSize);
+    if (mapped) {
+        data = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), fileSize);
+    } else {
+        // some filesystems can't map, fall back to the old full read
+        data = saveFile->readAll();
+    }
+
     if (ToxEncrypt::isEncrypted(data)) {
         if (password.isEmpty()) {
             error = LoadToxDataError::ENCRYPTED_NO_PASSWORD;
@@ -108,18 +146,29 @@ std::unique_ptr<ToxEncrypt> loadToxData(const QString& password, const QString&
             goto fail;
         }
 
+        // allocates only the plaintext buffer; the ciphertext is read out of
+        // the mapping (or the fallback buffer) directly
         data = tmpKey->decrypt(data);
         if (data.isEmpty()) {
             error = LoadToxDataError::DECRYPTION_FAILED;
             goto fail;
         }
+    } else if (mapped) {
+        // data is a view into the mapping, keep it alive for the caller.
+        // close() doesn't unmap, only destroying the QFile does.
+        saveFile->close();
+        mappedFile = std::move(saveFile);
+        error = LoadToxDataError::OK;
+        return std::move(tmpKey);
     }
 
-    saveFile.close();
+    saveFile->close();
     error = LoadToxDataError::OK;
     return std::move(tmpKey);
 fail:
-    saveFile.close();
+    // data may be a view into the mapping that dies with saveFile
+    data = QByteArray();
+    saveFile->close();
     return nullptr;
 }
 
@@ -267,6 +316,10 @@ void Profile::initCore(const QByteArray& toxsave, const ICoreSettings& s, bool i
         onSaveToxSave();
     }
 
+    // optional capture/replay of the core event stream, see coreeventlog.h
+    CoreEventRecorder::install(*core);
+    CoreEventReplayer::install(*core);
+
     // save tox file when Core requests it
     connect(core.get(), &Core::saveRequest, this, &Profile::onSaveToxSave);
     // react to avatar changes
@@ -281,7 +334,12 @@ Profile::Profile(const QString& name, const QString& password, std::unique_ptr<T
     , passkey{std::move(passkey)}
     , isRemoved{false}
     , encrypted{this->passkey != nullptr}
-{}
+{
+    avatarCache.setMaxCost(avatarCacheBudgetKb);
+    saveDebounceTimer.setSingleShot(true);
+    saveDebounceTimer.setInterval(saveDebounceIntervalMs);
+    connect(&saveDebounceTimer, &QTimer::timeout, this, &Profile::flushToxSave);
+}
 
 /**
  * @brief Locks and loads an existing profile and creates the associate Core* instance.
@@ -305,18 +363,28 @@ Profile* Profile::loadProfile(const QString& name, const QString& password, cons
 
     LoadToxDataError error;
     QByteArray toxsave = QByteArray();
+    // An unencrypted save comes back as a view into this mapping; it has to
+    // stay alive until initCore is done, where tox_new copies the state out
+    std::unique_ptr<QFile> mappedToxSave;
     QString path = settings.getSettingsDirPath() + name + ".tox";
-    std::unique_ptr<ToxEncrypt> tmpKey = loadToxData(password, path, toxsave, error);
+    StartupProfiler::startPhase("loadProfile.toxData");
+    std::unique_ptr<ToxEncrypt> tmpKey = loadToxData(password, path, toxsave, mappedToxSave, error);
+    StartupProfiler::endPhase("loadProfile.toxData");
 
     if (logLoadToxDataError(error, path)) {
         ProfileLocker::unlock();
         return nullptr;
     }
 
+    StartupProfiler::startPhase("loadProfile.initCore");
     Profile* p = new Profile(name, password, std::move(tmpKey));
 
     p->initCore(toxsave, settings, /*isNewProfile*/ false);
+    StartupProfiler::endPhase("loadProfile.initCore");
+
+    StartupProfiler::startPhase("loadProfile.database");
     p->loadDatabase(password);
+    StartupProfiler::endPhase("loadProfile.database");
 
     return p;
 }
@@ -353,12 +421,16 @@ Profile::~Profile()
         return;
     }
 
-    onSaveToxSave();
+    flushToxSave();
+    saveFuture.waitForFinished();
     Settings::getInstance().savePersonal(this);
     Settings::getInstance().sync();
     ProfileLocker::assertLock();
     assert(ProfileLocker::getCurLockName() == name);
     ProfileLocker::unlock();
+
+    // Derived database keys are session state, they don't outlive the profile
+    RawDatabase::wipeKeyCache();
 }
 
 /**
@@ -386,9 +458,30 @@ QStringList Profile::getFilesByExt(QString extension)
  * @warning NOT thread-safe.
  */
 const QStringList Profile::getAllProfileNames()
+{
+    return registerProfiles(scanProfileNames());
+}
+
+/**
+ * @brief Lists the profile names on disk without importing anything.
+ *
+ * Has no side effects, so it is safe to run from a worker thread; the login
+ * screen uses that to scan slow (e.g. network) home directories without
+ * blocking its first paint.
+ */
+QStringList Profile::scanProfileNames()
+{
+    return getFilesByExt("tox");
+}
+
+/**
+ * @brief Imports the given profiles if needed and updates the profile list.
+ * @warning NOT thread-safe; creates personal settings for profiles missing them.
+ */
+const QStringList Profile::registerProfiles(const QStringList& toxfiles)
 {
     profiles.clear();
-    QStringList toxfiles = getFilesByExt("tox"), inifiles = getFilesByExt("ini");
+    QStringList inifiles = getFilesByExt("ini");
     for (const QString& toxfile : toxfiles) {
         if (!inifiles.contains(toxfile)) {
             Settings::getInstance().createPersonal(toxfile);
@@ -416,32 +509,85 @@ QString Profile::getName() const
 void Profile::startCore()
 {
     // kriby: code duplication belongs in initCore, but cannot yet due to Core/Profile coupling
-    connect(core.get(), &Core::requestSent, this, &Profile::onRequestSent);
+    // unique: startCore() runs again when a parked profile is reactivated
+    connect(core.get(), &Core::requestSent, this, &Profile::onRequestSent, Qt::UniqueConnection);
     emit coreChanged(*core);
 
     core->start();
 
     const ToxId& selfId = core->getSelfId();
     const ToxPk& selfPk = selfId.getPublicKey();
-    const QByteArray data = loadAvatarData(selfPk);
-    if (data.isEmpty()) {
-        qDebug() << "Self avatar not found, will broadcast empty avatar to friends";
-    }
-    // TODO(sudden6): moved here, because it crashes in the constructor
-    // reason: Core::getInstance() returns nullptr, because it's not yet initialized
-    // solution: kill Core::getInstance
-    setAvatar(data);
+    // the avatar file read (and decryption on encrypted profiles) happens off
+    // the GUI thread; setAvatar() runs back here once the data is in
+    AsyncTask::runThen(this, [this, selfPk] { return loadAvatarData(selfPk); },
+                       [this](const QByteArray& data) {
+                           if (data.isEmpty()) {
+                               qDebug() << "Self avatar not found, will broadcast empty avatar "
+                                           "to friends";
+                           }
+                           // TODO(sudden6): moved here, because it crashes in the constructor
+                           // reason: Core::getInstance() returns nullptr, because it's not yet
+                           // initialized
+                           // solution: kill Core::getInstance
+                           setAvatar(data);
+                       });
 }
 
 /**
- * @brief Saves the profile's .tox save, encrypted if needed.
+ * @brief Schedules a save of the profile's .tox file.
  * @warning Invalid on deleted profiles.
+ *
+ * Core raises saveRequest for every small state change (friend added, status
+ * text, ...); debouncing collapses a burst into a single deferred write.
  */
 void Profile::onSaveToxSave()
 {
+    if (!saveDebounceTimer.isActive()) {
+        saveDebounceTimer.start();
+    }
+}
+
+/**
+ * @brief Serializes the profile now and hands the write to a worker thread.
+ *
+ * The write is skipped entirely when the serialized state hasn't changed
+ * since the last save, which the debounced requests can't know up front.
+ */
+void Profile::flushToxSave()
+{
+    if (isRemoved) {
+        // a queued save may still fire after the profile files are deleted
+        return;
+    }
+
+    saveDebounceTimer.stop();
+
     QByteArray data = core->getToxSaveData();
     assert(data.size());
-    saveToxSave(data);
+
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+    if (hash == lastSavedHash) {
+        return;
+    }
+    lastSavedHash = hash;
+
+    // keep writes to the save file strictly ordered; after a full debounce
+    // period the previous write is all but guaranteed done already
+    saveFuture.waitForFinished();
+    saveFuture = QtConcurrent::run([this, data] {
+        if (!saveToxSave(data)) {
+            QMetaObject::invokeMethod(this, "onToxSaveFailed", Qt::QueuedConnection);
+        }
+    });
+}
+
+/**
+ * @brief Forgets the last saved hash after a failed write, so the next flush
+ * retries even if the state didn't change in between.
+ */
+void Profile::onToxSaveFailed()
+{
+    lastSavedHash.clear();
 }
 
 // TODO(sudden6): handle this better maybe?
@@ -523,6 +669,129 @@ QString Profile::avatarPath(const ToxPk& owner, bool forceUnencrypted)
     return Settings::getInstance().getSettingsDirPath() + "avatars/" + hash.toHex().toUpper() + ".png";
 }
 
+/**
+ * @brief Name of the content-addressed blob that holds this avatar.
+ *
+ * Like avatarPath(), the name is a generichash keyed on our public key
+ * rather than a bare content hash, so the files of an encrypted profile
+ * don't reveal which well-known image they contain.
+ */
+QString Profile::avatarBlobName(const QByteArray& avatar)
+{
+    constexpr int hashSize = TOX_PUBLIC_KEY_SIZE;
+    const QByteArray pubkeyData = core->getSelfId().getPublicKey().getByteArray();
+    QByteArray hash(hashSize, 0);
+    crypto_generichash((uint8_t*)hash.data(), hashSize, (uint8_t*)avatar.data(), avatar.size(),
+                       (uint8_t*)pubkeyData.data(), pubkeyData.size());
+    return QString::fromLatin1(hash.toHex().toUpper());
+}
+
+QString Profile::avatarBlobPath(const QString& blobName)
+{
+    return Settings::getInstance().getSettingsDirPath() + "avatars/blobs/" + blobName + ".png";
+}
+
+QString Profile::avatarRefPath(const ToxPk& owner)
+{
+    return avatarPath(owner) + ".ref";
+}
+
+/**
+ * @brief Reads which blob a contact's avatar ref points at.
+ * @return Blob name, or an empty string if the contact has no ref.
+ */
+QString Profile::readAvatarRef(const ToxPk& owner)
+{
+    QFile file(avatarRefPath(owner));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    QByteArray ref = file.readAll();
+    if (encrypted && !ref.isEmpty()) {
+        ref = passkey->decrypt(ref);
+    }
+    return QString::fromLatin1(ref);
+}
+
+void Profile::writeAvatarRef(const ToxPk& owner, const QString& blobName)
+{
+    QByteArray ref = blobName.toLatin1();
+    if (encrypted) {
+        // encryption is randomized, so two contacts sharing a blob still
+        // get distinct ref files on disk
+        ref = passkey->encrypt(ref);
+    }
+
+    QSaveFile file(avatarRefPath(owner));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Couldn't save avatar ref for" << owner.toString();
+        return;
+    }
+    file.write(ref);
+    file.commit();
+}
+
+/**
+ * @brief Counts how many contacts reference each avatar blob.
+ *
+ * Scans the ref files once per session; saves and removals keep the
+ * counts current from then on.
+ */
+void Profile::ensureAvatarBlobRefsLoaded()
+{
+    if (avatarBlobRefsLoaded) {
+        return;
+    }
+    avatarBlobRefsLoaded = true;
+
+    const QDir dir(Settings::getInstance().getSettingsDirPath() + "avatars");
+    for (const QFileInfo& info : dir.entryInfoList({"*.ref"}, QDir::Files)) {
+        QFile file(info.absoluteFilePath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        QByteArray ref = file.readAll();
+        if (encrypted && !ref.isEmpty()) {
+            ref = passkey->decrypt(ref);
+        }
+        if (!ref.isEmpty()) {
+            ++avatarBlobRefs[QString::fromLatin1(ref)];
+        }
+    }
+}
+
+/**
+ * @brief Drops one reference to a blob, deleting it when unreferenced.
+ */
+void Profile::releaseAvatarBlob(const QString& blobName)
+{
+    if (blobName.isEmpty()) {
+        return;
+    }
+
+    ensureAvatarBlobRefsLoaded();
+    if (--avatarBlobRefs[blobName] <= 0) {
+        avatarBlobRefs.remove(blobName);
+        QFile::remove(avatarBlobPath(blobName));
+    }
+}
+
+/**
+ * @brief Wipes every ref and blob file, e.g. before rewriting the store
+ * under a new encryption key.
+ */
+void Profile::resetAvatarStore()
+{
+    const QString avatarsDir = Settings::getInstance().getSettingsDirPath() + "avatars/";
+    for (const QFileInfo& info : QDir(avatarsDir).entryInfoList({"*.ref"}, QDir::Files)) {
+        QFile::remove(info.absoluteFilePath());
+    }
+    QDir(avatarsDir + "blobs").removeRecursively();
+    avatarBlobRefs.clear();
+    avatarBlobRefsLoaded = true;
+}
+
 /**
  * @brief Get our avatar from cache.
  * @return Avatar as QPixmap.
@@ -539,6 +808,11 @@ QPixmap Profile::loadAvatar()
  */
 QPixmap Profile::loadAvatar(const ToxPk& owner)
 {
+    const QByteArray ownerKey = owner.getByteArray();
+    if (const QPixmap* cached = avatarCache.object(ownerKey)) {
+        return *cached;
+    }
+
     QPixmap pic;
     if (Settings::getInstance().getShowIdenticons()) {
 
@@ -553,9 +827,121 @@ QPixmap Profile::loadAvatar(const ToxPk& owner)
         pic.loadFromData(loadAvatarData(owner));
     }
 
+    avatarCache.insert(ownerKey, new QPixmap(pic), pixmapCostKb(pic));
+    return pic;
+}
+
+/**
+ * @brief Get a contact's avatar pre-scaled to the size it is drawn at.
+ * @param owner Friend PK to load avatar.
+ * @param size Target size, e.g. the 40x40 of the friend list rows.
+ * @return Scaled avatar as QPixmap.
+ *
+ * Scaled variants are cached per owner and size, so list rows and chat
+ * headers don't decode and rescale the full-resolution image on every use.
+ */
+QPixmap Profile::loadAvatarThumbnail(const ToxPk& owner, const QSize& size)
+{
+    const QString key = owner.toString()
+                        + QStringLiteral("@%1x%2").arg(size.width()).arg(size.height());
+    const auto cached = avatarThumbnailCache.constFind(key);
+    if (cached != avatarThumbnailCache.constEnd()) {
+        return *cached;
+    }
+
+    QPixmap pic = loadAvatar(owner);
+    if (!pic.isNull() && (pic.width() > size.width() || pic.height() > size.height())) {
+        pic = pic.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    avatarThumbnailCache[key] = pic;
     return pic;
 }
 
+/**
+ * @brief Queues a contact for background avatar decoding.
+ * @param owner Friend PK whose avatar (or identicon) to pre-render.
+ *
+ * Roster construction calls this once per contact; the queued batch is
+ * decoded on the thread pool shortly after, so by the time the rows are
+ * first painted the cache is already warm. For avatar-less contacts this
+ * covers the hash-derived identicon render, which is the common case in
+ * anonymous deployments.
+ */
+void Profile::prewarmAvatar(const ToxPk& owner)
+{
+    if (avatarCache.contains(owner.getByteArray())) {
+        return;
+    }
+
+    pendingAvatarPrewarm.append(owner);
+    if (pendingAvatarPrewarm.size() == 1) {
+        // let the rest of the roster queue up before kicking the batch
+        QTimer::singleShot(100, this, [this] { flushAvatarPrewarm(); });
+    }
+}
+
+/**
+ * @brief Decodes the queued batch off the GUI thread and seeds the cache.
+ */
+void Profile::flushAvatarPrewarm()
+{
+    QVector<ToxPk> owners;
+    owners.swap(pendingAvatarPrewarm);
+    if (owners.isEmpty()) {
+        return;
+    }
+
+    const bool useIdenticons = Settings::getInstance().getShowIdenticons();
+    AsyncTask::runThen(this,
+                       [this, owners, useIdenticons] {
+                           QVector<QPair<QByteArray, QImage>> decoded;
+                           decoded.reserve(owners.size());
+                           for (const ToxPk& owner : owners) {
+                               const QByteArray avatarData = loadAvatarData(owner);
+                               QImage img;
+                               if (avatarData.isEmpty()) {
+                                   if (useIdenticons) {
+                                       img = Identicon(owner.getByteArray()).toImage(16);
+                                   }
+                               } else {
+                                   img = QImage::fromData(avatarData);
+                               }
+                               decoded.append(qMakePair(owner.getByteArray(), img));
+                           }
+                           return decoded;
+                       },
+                       [this](const QVector<QPair<QByteArray, QImage>>& decoded) {
+                           for (const auto& entry : decoded) {
+                               if (entry.second.isNull()
+                                   || avatarCache.contains(entry.first)) {
+                                   continue;
+                               }
+                               const QPixmap pic = QPixmap::fromImage(entry.second);
+                               avatarCache.insert(entry.first, new QPixmap(pic),
+                                                  pixmapCostKb(pic));
+                           }
+                       });
+}
+
+/**
+ * @brief Drops the cached decoded avatar and thumbnails of a contact.
+ * @param owner Friend PK whose cache entries to drop.
+ */
+void Profile::invalidateAvatarCache(const ToxPk& owner)
+{
+    avatarCache.remove(owner.getByteArray());
+
+    const QString prefix = owner.toString() + QLatin1Char('@');
+    for (auto it = avatarThumbnailCache.begin(); it != avatarThumbnailCache.end();) {
+        if (it.key().startsWith(prefix)) {
+            it = avatarThumbnailCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 /**
  * @brief Get a contact's avatar from cache.
  * @param owner Friend PK to load avatar.
@@ -563,6 +949,23 @@ QPixmap Profile::loadAvatar(const ToxPk& owner)
  */
 QByteArray Profile::loadAvatarData(const ToxPk& owner)
 {
+    const QString blobName = readAvatarRef(owner);
+    if (!blobName.isEmpty()) {
+        QFile blob(avatarBlobPath(blobName));
+        if (blob.open(QIODevice::ReadOnly)) {
+            QByteArray pic = blob.readAll();
+            if (encrypted && !pic.isEmpty()) {
+                pic = passkey->decrypt(pic);
+                if (pic.isEmpty()) {
+                    qWarning() << "Failed to decrypt avatar blob" << blobName;
+                }
+            }
+            return pic;
+        }
+    }
+
+    // files written before the content-addressed store kept one avatar
+    // copy per owner
     QString path = avatarPath(owner);
     bool avatarEncrypted = encrypted;
     // If the encrypted avatar isn't found, try loading the unencrypted one for the same ID
@@ -668,6 +1071,12 @@ void Profile::setFriendAvatar(const ToxPk& owner, QByteArray pic)
     }
     friendAvatarChanged(owner, pixmap);
     saveAvatar(owner, avatarData);
+
+    if (!pic.isEmpty()) {
+        // Seed the cache so the next loadAvatar() hands out the very pixmap
+        // the widgets just received, instead of re-decoding a new copy.
+        avatarCache.insert(owner.getByteArray(), new QPixmap(pixmap), pixmapCostKb(pixmap));
+    }
 }
 
 /**
@@ -693,25 +1102,49 @@ void Profile::onRequestSent(const ToxPk& friendPk, const QString& message)
  * @brief Save an avatar to cache.
  * @param pic Picture to save.
  * @param owner PK of avatar owner.
+ *
+ * Avatars are stored content-addressed: contacts sharing an identical
+ * image share one blob on disk, and re-saving an unchanged avatar writes
+ * nothing.
  */
 void Profile::saveAvatar(const ToxPk& owner, const QByteArray& avatar)
 {
-    const bool needEncrypt = encrypted && !avatar.isEmpty();
-    const QByteArray& pic = needEncrypt ? passkey->encrypt(avatar) : avatar;
+    invalidateAvatarCache(owner);
 
-    QString path = avatarPath(owner);
     QDir(Settings::getInstance().getSettingsDirPath()).mkdir("avatars");
-    if (pic.isEmpty()) {
-        QFile::remove(path);
-    } else {
-        QSaveFile file(path);
+    // any pre-store single-file copy for this owner is superseded
+    QFile::remove(avatarPath(owner));
+
+    ensureAvatarBlobRefsLoaded();
+    const QString oldBlob = readAvatarRef(owner);
+
+    if (avatar.isEmpty()) {
+        QFile::remove(avatarRefPath(owner));
+        releaseAvatarBlob(oldBlob);
+        return;
+    }
+
+    const QString blobName = avatarBlobName(avatar);
+    if (blobName == oldBlob && QFile::exists(avatarBlobPath(blobName))) {
+        // unchanged content, nothing to write
+        return;
+    }
+
+    QDir(Settings::getInstance().getSettingsDirPath() + "avatars").mkdir("blobs");
+    if (!QFile::exists(avatarBlobPath(blobName))) {
+        const QByteArray pic = encrypted ? passkey->encrypt(avatar) : avatar;
+        QSaveFile file(avatarBlobPath(blobName));
         if (!file.open(QIODevice::WriteOnly)) {
-            qWarning() << "Tox avatar " << path << " couldn't be saved";
+            qWarning() << "Tox avatar blob " << avatarBlobPath(blobName) << " couldn't be saved";
             return;
         }
         file.write(pic);
         file.commit();
     }
+
+    writeAvatarRef(owner, blobName);
+    ++avatarBlobRefs[blobName];
+    releaseAvatarBlob(oldBlob);
 }
 
 /**
@@ -768,6 +1201,8 @@ History* Profile::getHistory()
  */
 void Profile::removeAvatar(const ToxPk& owner)
 {
+    releaseAvatarBlob(readAvatarRef(owner));
+    QFile::remove(avatarRefPath(owner));
     QFile::remove(avatarPath(owner));
     if (owner == core->getSelfId().getPublicKey()) {
         setAvatar({});
@@ -912,6 +1347,7 @@ void Profile::restartCore()
         const QByteArray& savedata = core->getToxSaveData();
 
         // save to disk just in case
+        saveFuture.waitForFinished();
         if (saveToxSave(savedata)) {
             qDebug() << "Restarting Core";
             const bool isNewProfile{false};
@@ -942,6 +1378,21 @@ void Profile::restartCore()
  */
 QString Profile::setPassword(const QString& newPassword)
 {
+    // a background save may still be encrypting with the current passkey
+    saveFuture.waitForFinished();
+
+    // decrypt the avatars while the old passkey is still in place; once it
+    // is swapped the files on disk can no longer be read
+    QVector<QPair<ToxPk, QByteArray>> avatars;
+    const ToxPk selfPk = core->getSelfId().getPublicKey();
+    avatars.append({selfPk, loadAvatarData(selfPk)});
+    QVector<uint32_t> friendList = core->getFriendList();
+    QVectorIterator<uint32_t> i(friendList);
+    while (i.hasNext()) {
+        const ToxPk friendPublicKey = core->getFriendPublicKey(i.next());
+        avatars.append({friendPublicKey, loadAvatarData(friendPublicKey)});
+    }
+
     if (newPassword.isEmpty()) {
         // remove password
         encrypted = false;
@@ -958,14 +1409,29 @@ QString Profile::setPassword(const QString& newPassword)
         encrypted = true;
     }
 
-    // apply new encryption
-    onSaveToxSave();
+    // apply new encryption, immediately so the old key is gone from disk;
+    // the plaintext state is unchanged, so the hash check must not skip this
+    lastSavedHash.clear();
+    flushToxSave();
 
     bool dbSuccess = false;
 
     // TODO: ensure the database and the tox save file use the same password
     if (database) {
-        dbSuccess = database->setPassword(newPassword);
+        // the worker re-encrypts while we keep pumping the event loop, so
+        // the UI repaints and shows progress instead of freezing for the
+        // duration; user input is kept out by the caller's modal dialog
+        std::atomic_bool done{false};
+        database->setPasswordAsync(newPassword,
+                                   [&](bool success) {
+                                       dbSuccess = success;
+                                       done.store(true, std::memory_order_release);
+                                   },
+                                   [this](int percent) { emit rekeyProgressChanged(percent); });
+        while (!done.load(std::memory_order_acquire)) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+            QThread::msleep(10);
+        }
     }
 
     QString error{};
@@ -974,14 +1440,11 @@ QString Profile::setPassword(const QString& newPassword)
                    "password.");
     }
 
-    QByteArray avatar = loadAvatarData(core->getSelfId().getPublicKey());
-    saveAvatar(core->getSelfId().getPublicKey(), avatar);
-
-    QVector<uint32_t> friendList = core->getFriendList();
-    QVectorIterator<uint32_t> i(friendList);
-    while (i.hasNext()) {
-        const ToxPk friendPublicKey = core->getFriendPublicKey(i.next());
-        saveAvatar(friendPublicKey, loadAvatarData(friendPublicKey));
+    // the old blobs and refs are unreadable under the new key; rewriting
+    // from the captured plaintexts re-encrypts each unique blob once
+    resetAvatarStore();
+    for (const auto& avatar : avatars) {
+        saveAvatar(avatar.first, avatar.second);
     }
     return error;
 }
@@ -28,9 +28,12 @@
 #include "src/persistence/history.h"
 
 #include <QByteArray>
+#include <QCache>
+#include <QFuture>
 #include <QObject>
 #include <QPixmap>
 #include <QString>
+#include <QTimer>
 #include <QVector>
 #include <memory>
 
@@ -57,6 +60,8 @@ public:
 
     QPixmap loadAvatar();
     QPixmap loadAvatar(const ToxPk& owner);
+    QPixmap loadAvatarThumbnail(const ToxPk& owner, const QSize& size);
+    void prewarmAvatar(const ToxPk& owner);
     QByteArray loadAvatarData(const ToxPk& owner);
     void setAvatar(QByteArray pic);
     void setFriendAvatar(const ToxPk& owner, QByteArray pic);
@@ -71,6 +76,8 @@ public:
     bool rename(QString newName);
 
     static const QStringList getAllProfileNames();
+    static QStringList scanProfileNames();
+    static const QStringList registerProfiles(const QStringList& toxfiles);
 
     static bool exists(QString name);
     static bool isEncrypted(QString name);
@@ -88,6 +95,9 @@ signals:
     void failedToStart();
     void badProxy();
     void coreChanged(Core& core);
+    // 0-100 estimate while the history database re-encrypts during a
+    // password change; emitted from the database worker thread
+    void rekeyProgressChanged(int percent);
 
 public slots:
     void onRequestSent(const ToxPk& friendPk, const QString& message);
@@ -97,6 +107,8 @@ private slots:
     void saveAvatar(const ToxPk& owner, const QByteArray& avatar);
     void removeAvatar(const ToxPk& owner);
     void onSaveToxSave();
+    void flushToxSave();
+    void onToxSaveFailed();
     // TODO(sudden6): use ToxPk instead of friendId
     void onAvatarOfferReceived(uint32_t friendId, uint32_t fileId, const QByteArray& avatarHash);
 
@@ -104,6 +116,16 @@ private:
     Profile(const QString& name, const QString& password, std::unique_ptr<ToxEncrypt> passkey);
     static QStringList getFilesByExt(QString extension);
     QString avatarPath(const ToxPk& owner, bool forceUnencrypted = false);
+    QString avatarBlobName(const QByteArray& avatar);
+    QString avatarBlobPath(const QString& blobName);
+    QString avatarRefPath(const ToxPk& owner);
+    QString readAvatarRef(const ToxPk& owner);
+    void writeAvatarRef(const ToxPk& owner, const QString& blobName);
+    void ensureAvatarBlobRefsLoaded();
+    void releaseAvatarBlob(const QString& blobName);
+    void resetAvatarStore();
+    void flushAvatarPrewarm();
+    void invalidateAvatarCache(const ToxPk& owner);
     bool saveToxSave(QByteArray data);
     void initCore(const QByteArray& toxsave, const ICoreSettings& s, bool isNewProfile);
 
@@ -115,6 +137,24 @@ private:
     std::shared_ptr<History> history;
     bool isRemoved;
     bool encrypted = false;
+    // collapses the bursts of saveRequest signals into one deferred write
+    QTimer saveDebounceTimer;
+    // hash of the last save data written, so a flush that finds the state
+    // unchanged doesn't rewrite the whole file
+    QByteArray lastSavedHash;
+    QFuture<void> saveFuture;
+    // Decoded avatars and their pre-scaled variants, so the widget layer
+    // doesn't re-decode the same PNGs for every list row and header. The
+    // full-size cache is LRU-bounded so a huge roster can't pin every
+    // decoded image in memory at once.
+    QCache<QByteArray, QPixmap> avatarCache;
+    QHash<QString, QPixmap> avatarThumbnailCache;
+    // contacts queued for background avatar decoding / identicon rendering
+    QVector<ToxPk> pendingAvatarPrewarm;
+    // content-addressed avatar store bookkeeping: blob name -> number of
+    // contacts referencing it, loaded lazily from the ref files on disk
+    QHash<QString, int> avatarBlobRefs;
+    bool avatarBlobRefsLoaded = false;
     static QStringList profiles;
 };
 
@@ -100,6 +100,36 @@ void Settings::destroyInstance()
     settings = nullptr;
 }
 
+/**
+ * @brief Current snapshot of the hot settings, fetched without locking.
+ *
+ * The snapshot is immutable; a reader holding it mid-operation keeps seeing
+ * a consistent set of values even if a writer republishes meanwhile.
+ */
+std::shared_ptr<const Settings::HotSettings> Settings::hotSnapshot() const
+{
+    return std::atomic_load(&hotSettings);
+}
+
+/**
+ * @brief Rebuilds and atomically republishes the hot settings snapshot.
+ *
+ * Must be called with bigLock held after any snapshotted field changes.
+ * In-flight readers keep the old snapshot alive until they drop it.
+ */
+void Settings::republishHotSettings()
+{
+    auto snap = std::make_shared<HotSettings>();
+    snap->enableLogging = enableLogging;
+    snap->audioInDevEnabled = audioInDevEnabled;
+    snap->audioOutDevEnabled = audioOutDevEnabled;
+    snap->audioInGainDecibel = audioInGainDecibel;
+    snap->audioThreshold = audioThreshold;
+    snap->outVolume = outVolume;
+    snap->blackList = blackList;
+    std::atomic_store(&hotSettings, std::shared_ptr<const HotSettings>(std::move(snap)));
+}
+
 void Settings::loadGlobal()
 {
     QMutexLocker locker{&bigLock};
@@ -111,6 +141,11 @@ void Settings::loadGlobal()
 
     makeToxPortable = Settings::isToxPortable();
 
+    // drop locations resolved before the portable flag was known
+    settingsDirPathCache.clear();
+    appDataDirPathCache.clear();
+    appCacheDirPathCache.clear();
+
     QDir dir(getSettingsDirPath());
     QString filePath = dir.filePath(globalSettingsFile);
 
@@ -165,6 +200,8 @@ void Settings::loadGlobal()
         enableIPv6 = s.value("enableIPv6", true).toBool();
         forceTCP = s.value("forceTCP", false).toBool();
         enableLanDiscovery = s.value("enableLanDiscovery", true).toBool();
+        useOpenGLChatView = s.value("useOpenGLChatView", false).toBool();
+        maxFileTransferBandwidth = s.value("maxFileTransferBandwidth", 0).toUInt();
     }
     s.endGroup();
 
@@ -220,6 +257,8 @@ void Settings::loadGlobal()
     s.beginGroup("Chat");
     {
         chatMessageFont = s.value("chatMessageFont", Style::getFont(Style::Big)).value<QFont>();
+        pastedImageFormat = s.value("pastedImageFormat", QStringLiteral("png")).toString();
+        pastedImageQuality = s.value("pastedImageQuality", -1).toInt();
     }
     s.endGroup();
 
@@ -259,9 +298,12 @@ void Settings::loadGlobal()
         screenRegion = s.value("screenRegion", QRect()).toRect();
         screenGrabbed = s.value("screenGrabbed", false).toBool();
         camVideoFPS = static_cast<quint16>(s.value("camVideoFPS", 0).toUInt());
+        hardwareDecoding = s.value("hardwareDecoding", false).toBool();
     }
     s.endGroup();
 
+    republishHotSettings();
+
     loaded = true;
 }
 
@@ -318,6 +360,8 @@ void Settings::loadPersonal(QString profileName, const ToxEncrypt* passKey)
     }
     ps.endGroup();
 
+    republishHotSettings();
+
     ps.beginGroup("Friends");
     {
         int size = ps.beginReadArray("Friend");
@@ -470,6 +514,8 @@ void Settings::saveGlobal()
         s.setValue("enableIPv6", enableIPv6);
         s.setValue("forceTCP", forceTCP);
         s.setValue("enableLanDiscovery", enableLanDiscovery);
+        s.setValue("useOpenGLChatView", useOpenGLChatView);
+        s.setValue("maxFileTransferBandwidth", maxFileTransferBandwidth);
         s.setValue("dbSyncType", static_cast<int>(dbSyncType));
     }
     s.endGroup();
@@ -514,6 +560,8 @@ void Settings::saveGlobal()
     s.beginGroup("Chat");
     {
         s.setValue("chatMessageFont", chatMessageFont);
+        s.setValue("pastedImageFormat", pastedImageFormat);
+        s.setValue("pastedImageQuality", pastedImageQuality);
     }
     s.endGroup();
 
@@ -548,12 +596,54 @@ void Settings::saveGlobal()
         s.setValue("videoDev", videoDev);
         s.setValue("camVideoRes", camVideoRes);
         s.setValue("camVideoFPS", camVideoFPS);
+        s.setValue("hardwareDecoding", hardwareDecoding);
         s.setValue("screenRegion", screenRegion);
         s.setValue("screenGrabbed", screenGrabbed);
     }
     s.endGroup();
 }
 
+/**
+ * @brief Schedules a debounced asynchronous save of the global settings.
+ *
+ * Rapid triggers coalesce into a single write: the first call arms a short
+ * one-shot timer on the settings thread and further calls before it fires are
+ * free. Use this instead of saveGlobal for anything driven by UI events.
+ */
+void Settings::scheduleSaveGlobal()
+{
+    if (QThread::currentThread() != settingsThread)
+        return (void)QMetaObject::invokeMethod(&getInstance(), "scheduleSaveGlobal");
+
+    static constexpr int SAVE_DEBOUNCE_MS = 1000;
+    if (!globalSaveTimer) {
+        globalSaveTimer = new QTimer(this);
+        globalSaveTimer->setSingleShot(true);
+        connect(globalSaveTimer, &QTimer::timeout, this, &Settings::saveGlobal);
+    }
+    if (!globalSaveTimer->isActive())
+        globalSaveTimer->start(SAVE_DEBOUNCE_MS);
+}
+
+/**
+ * @brief Schedules a debounced asynchronous save of the current profile.
+ * @see scheduleSaveGlobal
+ */
+void Settings::scheduleSavePersonal()
+{
+    if (QThread::currentThread() != settingsThread)
+        return (void)QMetaObject::invokeMethod(&getInstance(), "scheduleSavePersonal");
+
+    static constexpr int SAVE_DEBOUNCE_MS = 1000;
+    if (!personalSaveTimer) {
+        personalSaveTimer = new QTimer(this);
+        personalSaveTimer->setSingleShot(true);
+        connect(personalSaveTimer, &QTimer::timeout, this, [this]() { savePersonal(); });
+    }
+    if (!personalSaveTimer->isActive())
+        personalSaveTimer->start(SAVE_DEBOUNCE_MS);
+}
+
 /**
  * @brief Asynchronous, saves the current profile.
  */
@@ -691,25 +781,35 @@ uint32_t Settings::makeProfileId(const QString& profile)
 QString Settings::getSettingsDirPath() const
 {
     QMutexLocker locker{&bigLock};
-    if (makeToxPortable)
-        return qApp->applicationDirPath() + QDir::separator();
+    if (!settingsDirPathCache.isEmpty()) {
+        return settingsDirPathCache;
+    }
+
+    if (makeToxPortable) {
+        settingsDirPathCache = qApp->applicationDirPath() + QDir::separator();
+        return settingsDirPathCache;
+    }
 
 // workaround for https://bugreports.qt-project.org/browse/QTBUG-38845
 #ifdef Q_OS_WIN
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
-                           + QDir::separator() + "AppData" + QDir::separator() + "Roaming"
-                           + QDir::separator() + "tox")
-           + QDir::separator();
+    settingsDirPathCache =
+        QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
+                        + QDir::separator() + "AppData" + QDir::separator() + "Roaming"
+                        + QDir::separator() + "tox")
+        + QDir::separator();
 #elif defined(Q_OS_OSX)
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
-                           + QDir::separator() + "Library" + QDir::separator()
-                           + "Application Support" + QDir::separator() + "Tox")
-           + QDir::separator();
+    settingsDirPathCache =
+        QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
+                        + QDir::separator() + "Library" + QDir::separator()
+                        + "Application Support" + QDir::separator() + "Tox")
+        + QDir::separator();
 #else
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation)
-                           + QDir::separator() + "tox")
-           + QDir::separator();
+    settingsDirPathCache =
+        QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation)
+                        + QDir::separator() + "tox")
+        + QDir::separator();
 #endif
+    return settingsDirPathCache;
 }
 
 /**
@@ -719,29 +819,39 @@ QString Settings::getSettingsDirPath() const
 QString Settings::getAppDataDirPath() const
 {
     QMutexLocker locker{&bigLock};
-    if (makeToxPortable)
-        return qApp->applicationDirPath() + QDir::separator();
+    if (!appDataDirPathCache.isEmpty()) {
+        return appDataDirPathCache;
+    }
+
+    if (makeToxPortable) {
+        appDataDirPathCache = qApp->applicationDirPath() + QDir::separator();
+        return appDataDirPathCache;
+    }
 
 // workaround for https://bugreports.qt-project.org/browse/QTBUG-38845
 #ifdef Q_OS_WIN
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
-                           + QDir::separator() + "AppData" + QDir::separator() + "Roaming"
-                           + QDir::separator() + "tox")
-           + QDir::separator();
+    appDataDirPathCache =
+        QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
+                        + QDir::separator() + "AppData" + QDir::separator() + "Roaming"
+                        + QDir::separator() + "tox")
+        + QDir::separator();
 #elif defined(Q_OS_OSX)
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
-                           + QDir::separator() + "Library" + QDir::separator()
-                           + "Application Support" + QDir::separator() + "Tox")
-           + QDir::separator();
+    appDataDirPathCache =
+        QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
+                        + QDir::separator() + "Library" + QDir::separator()
+                        + "Application Support" + QDir::separator() + "Tox")
+        + QDir::separator();
 #else
     /*
      * TODO: Change QStandardPaths::DataLocation to AppDataLocation when upgrate Qt to 5.4+
      * For now we need support Qt 5.3, so we use deprecated DataLocation
      * BTW, it's not a big deal since for linux AppDataLocation and DataLocation are equal
      */
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::DataLocation))
-           + QDir::separator();
+    appDataDirPathCache =
+        QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::DataLocation))
+        + QDir::separator();
 #endif
+    return appDataDirPathCache;
 }
 
 /**
@@ -751,24 +861,34 @@ QString Settings::getAppDataDirPath() const
 QString Settings::getAppCacheDirPath() const
 {
     QMutexLocker locker{&bigLock};
-    if (makeToxPortable)
-        return qApp->applicationDirPath() + QDir::separator();
+    if (!appCacheDirPathCache.isEmpty()) {
+        return appCacheDirPathCache;
+    }
+
+    if (makeToxPortable) {
+        appCacheDirPathCache = qApp->applicationDirPath() + QDir::separator();
+        return appCacheDirPathCache;
+    }
 
 // workaround for https://bugreports.qt-project.org/browse/QTBUG-38845
 #ifdef Q_OS_WIN
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
-                           + QDir::separator() + "AppData" + QDir::separator() + "Roaming"
-                           + QDir::separator() + "tox")
-           + QDir::separator();
+    appCacheDirPathCache =
+        QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
+                        + QDir::separator() + "AppData" + QDir::separator() + "Roaming"
+                        + QDir::separator() + "tox")
+        + QDir::separator();
 #elif defined(Q_OS_OSX)
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
-                           + QDir::separator() + "Library" + QDir::separator()
-                           + "Application Support" + QDir::separator() + "Tox")
-           + QDir::separator();
+    appCacheDirPathCache =
+        QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)
+                        + QDir::separator() + "Library" + QDir::separator()
+                        + "Application Support" + QDir::separator() + "Tox")
+        + QDir::separator();
 #else
-    return QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
-           + QDir::separator();
+    appCacheDirPathCache =
+        QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+        + QDir::separator();
 #endif
+    return appCacheDirPathCache;
 }
 
 bool Settings::getEnableTestSound() const
@@ -816,12 +936,37 @@ void Settings::setMakeToxPortable(bool newValue)
     if (newValue != makeToxPortable) {
         QFile(getSettingsDirPath() + globalSettingsFile).remove();
         makeToxPortable = newValue;
+
+        // the cached locations are derived from the portable flag
+        settingsDirPathCache.clear();
+        appDataDirPathCache.clear();
+        appCacheDirPathCache.clear();
+
         saveGlobal();
 
         emit makeToxPortableChanged(makeToxPortable);
     }
 }
 
+bool Settings::getUseOpenGLChatView() const
+{
+    QMutexLocker locker{&bigLock};
+    return useOpenGLChatView;
+}
+
+/**
+ * @brief Enables the GPU-composited chat view, applied to newly created chats.
+ */
+void Settings::setUseOpenGLChatView(bool enabled)
+{
+    QMutexLocker locker{&bigLock};
+
+    if (enabled != useOpenGLChatView) {
+        useOpenGLChatView = enabled;
+        emit useOpenGLChatViewChanged(useOpenGLChatView);
+    }
+}
+
 bool Settings::getAutorun() const
 {
     QMutexLocker locker{&bigLock};
@@ -1282,6 +1427,22 @@ void Settings::setProxyPort(quint16 port)
     }
 }
 
+uint32_t Settings::getMaxFileTransferBandwidth() const
+{
+    QMutexLocker locker{&bigLock};
+    return maxFileTransferBandwidth;
+}
+
+void Settings::setMaxFileTransferBandwidth(uint32_t kibPerSec)
+{
+    QMutexLocker locker{&bigLock};
+
+    if (kibPerSec != maxFileTransferBandwidth) {
+        maxFileTransferBandwidth = kibPerSec;
+        emit maxFileTransferBandwidthChanged(maxFileTransferBandwidth);
+    }
+}
+
 QString Settings::getCurrentProfile() const
 {
     QMutexLocker locker{&bigLock};
@@ -1308,8 +1469,7 @@ void Settings::setCurrentProfile(const QString& profile)
 
 bool Settings::getEnableLogging() const
 {
-    QMutexLocker locker{&bigLock};
-    return enableLogging;
+    return hotSnapshot()->enableLogging;
 }
 
 void Settings::setEnableLogging(bool newValue)
@@ -1318,6 +1478,7 @@ void Settings::setEnableLogging(bool newValue)
 
     if (newValue != enableLogging) {
         enableLogging = newValue;
+        republishHotSettings();
         emit enableLoggingChanged(enableLogging);
     }
 }
@@ -1487,6 +1648,38 @@ void Settings::setChatMessageFont(const QFont& font)
     }
 }
 
+QString Settings::getPastedImageFormat() const
+{
+    QMutexLocker locker(&bigLock);
+    return pastedImageFormat;
+}
+
+void Settings::setPastedImageFormat(const QString& format)
+{
+    QMutexLocker locker(&bigLock);
+
+    if (format != pastedImageFormat) {
+        pastedImageFormat = format;
+        emit pastedImageFormatChanged(pastedImageFormat);
+    }
+}
+
+int Settings::getPastedImageQuality() const
+{
+    QMutexLocker locker(&bigLock);
+    return pastedImageQuality;
+}
+
+void Settings::setPastedImageQuality(int quality)
+{
+    QMutexLocker locker(&bigLock);
+
+    if (quality != pastedImageQuality) {
+        pastedImageQuality = quality;
+        emit pastedImageQualityChanged(pastedImageQuality);
+    }
+}
+
 void Settings::setWidgetData(const QString& uniqueName, const QByteArray& data)
 {
     QMutexLocker locker{&bigLock};
@@ -1776,8 +1969,7 @@ void Settings::setTypingNotification(bool enabled)
 
 QStringList Settings::getBlackList() const
 {
-    QMutexLocker locker{&bigLock};
-    return blackList;
+    return hotSnapshot()->blackList;
 }
 
 void Settings::setBlackList(const QStringList& blist)
@@ -1786,6 +1978,7 @@ void Settings::setBlackList(const QStringList& blist)
 
     if (blist != blackList) {
         blackList = blist;
+        republishHotSettings();
         emit blackListChanged(blackList);
     }
 }
@@ -1808,8 +2001,7 @@ void Settings::setInDev(const QString& deviceSpecifier)
 
 bool Settings::getAudioInDevEnabled() const
 {
-    QMutexLocker locker(&bigLock);
-    return audioInDevEnabled;
+    return hotSnapshot()->audioInDevEnabled;
 }
 
 void Settings::setAudioInDevEnabled(bool enabled)
@@ -1818,14 +2010,14 @@ void Settings::setAudioInDevEnabled(bool enabled)
 
     if (enabled != audioInDevEnabled) {
         audioInDevEnabled = enabled;
+        republishHotSettings();
         emit audioInDevEnabledChanged(enabled);
     }
 }
 
 qreal Settings::getAudioInGainDecibel() const
 {
-    QMutexLocker locker{&bigLock};
-    return audioInGainDecibel;
+    return hotSnapshot()->audioInGainDecibel;
 }
 
 void Settings::setAudioInGainDecibel(qreal dB)
@@ -1834,14 +2026,14 @@ void Settings::setAudioInGainDecibel(qreal dB)
 
     if (dB < audioInGainDecibel || dB > audioInGainDecibel) {
         audioInGainDecibel = dB;
+        republishHotSettings();
         emit audioInGainDecibelChanged(audioInGainDecibel);
     }
 }
 
 qreal Settings::getAudioThreshold() const
 {
-    QMutexLocker locker{&bigLock};
-    return audioThreshold;
+    return hotSnapshot()->audioThreshold;
 }
 
 void Settings::setAudioThreshold(qreal percent)
@@ -1850,6 +2042,7 @@ void Settings::setAudioThreshold(qreal percent)
 
     if (percent < audioThreshold || percent > audioThreshold) {
         audioThreshold = percent;
+        republishHotSettings();
         emit audioThresholdChanged(audioThreshold);
     }
 }
@@ -1888,8 +2081,7 @@ void Settings::setOutDev(const QString& deviceSpecifier)
 
 bool Settings::getAudioOutDevEnabled() const
 {
-    QMutexLocker locker(&bigLock);
-    return audioOutDevEnabled;
+    return hotSnapshot()->audioOutDevEnabled;
 }
 
 void Settings::setAudioOutDevEnabled(bool enabled)
@@ -1898,14 +2090,14 @@ void Settings::setAudioOutDevEnabled(bool enabled)
 
     if (enabled != audioOutDevEnabled) {
         audioOutDevEnabled = enabled;
+        republishHotSettings();
         emit audioOutDevEnabledChanged(audioOutDevEnabled);
     }
 }
 
 int Settings::getOutVolume() const
 {
-    QMutexLocker locker{&bigLock};
-    return outVolume;
+    return hotSnapshot()->outVolume;
 }
 
 void Settings::setOutVolume(int volume)
@@ -1914,6 +2106,7 @@ void Settings::setOutVolume(int volume)
 
     if (volume != outVolume) {
         outVolume = volume;
+        republishHotSettings();
         emit outVolumeChanged(outVolume);
     }
 }
@@ -2014,6 +2207,22 @@ void Settings::setCamVideoFPS(float newValue)
     }
 }
 
+bool Settings::getHardwareDecoding() const
+{
+    QMutexLocker locker{&bigLock};
+    return hardwareDecoding;
+}
+
+void Settings::setHardwareDecoding(bool enabled)
+{
+    QMutexLocker locker{&bigLock};
+
+    if (enabled != hardwareDecoding) {
+        hardwareDecoding = enabled;
+        emit hardwareDecodingChanged(hardwareDecoding);
+    }
+}
+
 QString Settings::getFriendAddress(const QString& publicKey) const
 {
     QMutexLocker locker{&bigLock};
@@ -2410,6 +2619,17 @@ void Settings::sync()
     }
 
     QMutexLocker locker{&bigLock};
+
+    // Scheduled-but-unfired debounced saves must hit disk before we report done
+    if (globalSaveTimer && globalSaveTimer->isActive()) {
+        globalSaveTimer->stop();
+        saveGlobal();
+    }
+    if (personalSaveTimer && personalSaveTimer->isActive()) {
+        personalSaveTimer->stop();
+        savePersonal();
+    }
+
     qApp->processEvents();
 }
 
@@ -34,10 +34,13 @@
 #include <QFont>
 #include <QHash>
 #include <QMutex>
+#include <QTimer>
 #include <QNetworkProxy>
 #include <QObject>
 #include <QPixmap>
 
+#include <memory>
+
 class Profile;
 
 namespace Db {
@@ -168,6 +171,8 @@ public:
 
 public slots:
     void saveGlobal();
+    void scheduleSaveGlobal();
+    void scheduleSavePersonal();
     void sync();
     void setAutoLogin(bool state);
     void updateProfileData(Profile* profile);
@@ -184,6 +189,7 @@ signals:
     void desktopNotifyChanged(bool enabled);
     void showWindowChanged(bool enabled);
     void makeToxPortableChanged(bool enabled);
+    void useOpenGLChatViewChanged(bool enabled);
     void busySoundChanged(bool enabled);
     void notifySoundChanged(bool enabled);
     void notifyHideChanged(bool enabled);
@@ -226,6 +232,8 @@ signals:
     void dontGroupWindowsChanged(bool enabled);
     void groupchatPositionChanged(bool enabled);
     void chatMessageFontChanged(const QFont& font);
+    void pastedImageFormatChanged(const QString& format);
+    void pastedImageQualityChanged(int quality);
     void stylePreferenceChanged(StyleType type);
     void timestampFormatChanged(const QString& format);
     void dateFormatChanged(const QString& format);
@@ -290,6 +298,9 @@ public:
     void setAutoSaveEnabled(bool newValue);
     bool getAutoSaveEnabled() const;
 
+    bool getUseOpenGLChatView() const;
+    void setUseOpenGLChatView(bool enabled);
+
     // ICoreSettings
     bool getEnableIPv6() const override;
     void setEnableIPv6(bool enabled) override;
@@ -311,12 +322,16 @@ public:
 
     QNetworkProxy getProxy() const override;
 
+    uint32_t getMaxFileTransferBandwidth() const override;
+    void setMaxFileTransferBandwidth(uint32_t kibPerSec) override;
+
     SIGNAL_IMPL(Settings, enableIPv6Changed, bool enabled)
     SIGNAL_IMPL(Settings, forceTCPChanged, bool enabled)
     SIGNAL_IMPL(Settings, enableLanDiscoveryChanged, bool enabled)
     SIGNAL_IMPL(Settings, proxyTypeChanged, ICoreSettings::ProxyType type)
     SIGNAL_IMPL(Settings, proxyAddressChanged, const QString& address)
     SIGNAL_IMPL(Settings, proxyPortChanged, quint16 port)
+    SIGNAL_IMPL(Settings, maxFileTransferBandwidthChanged, uint32_t kibPerSec)
 
     bool getEnableLogging() const;
     void setEnableLogging(bool newValue);
@@ -417,11 +432,15 @@ public:
     float getCamVideoFPS() const override;
     void setCamVideoFPS(float newValue) override;
 
+    bool getHardwareDecoding() const override;
+    void setHardwareDecoding(bool enabled) override;
+
     SIGNAL_IMPL(Settings, videoDevChanged, const QString& device)
     SIGNAL_IMPL(Settings, screenRegionChanged, const QRect& region)
     SIGNAL_IMPL(Settings, screenGrabbedChanged, bool enabled)
     SIGNAL_IMPL(Settings, camVideoResChanged, const QRect& region)
     SIGNAL_IMPL(Settings, camVideoFPSChanged, unsigned short fps)
+    SIGNAL_IMPL(Settings, hardwareDecodingChanged, bool enabled)
 
     bool isAnimationEnabled() const;
     void setAnimationEnabled(bool newValue);
@@ -463,6 +482,12 @@ public:
     const QFont& getChatMessageFont() const;
     void setChatMessageFont(const QFont& font);
 
+    QString getPastedImageFormat() const;
+    void setPastedImageFormat(const QString& format);
+
+    int getPastedImageQuality() const;
+    void setPastedImageQuality(int quality);
+
     const QString& getTimestampFormat() const;
     void setTimestampFormat(const QString& format);
 
@@ -613,6 +638,12 @@ private:
     bool enableIPv6;
     QString translation;
     bool makeToxPortable;
+    // directory getters run from hot paths; the resolved locations are
+    // cached here and reset when the portable mode changes
+    mutable QString settingsDirPathCache;
+    mutable QString appDataDirPathCache;
+    mutable QString appCacheDirPathCache;
+    bool useOpenGLChatView;
     bool autostartInTray;
     bool closeToTray;
     bool minimizeToTray;
@@ -630,6 +661,7 @@ private:
 
     bool forceTCP;
     bool enableLanDiscovery;
+    uint32_t maxFileTransferBandwidth;
 
     ICoreSettings::ProxyType proxyType;
     QString proxyAddr;
@@ -671,6 +703,10 @@ private:
 
     // ChatView
     QFont chatMessageFont;
+    // encoder used for images pasted into the chat; quality -1 keeps the
+    // format's default setting
+    QString pastedImageFormat;
+    int pastedImageQuality;
     StyleType stylePreference;
     int firstColumnHandlePos;
     int secondColumnHandlePosFromRight;
@@ -702,6 +738,7 @@ private:
     QRect screenRegion;
     bool screenGrabbed;
     float camVideoFPS;
+    bool hardwareDecoding;
 
     struct friendProp
     {
@@ -725,12 +762,34 @@ private:
         bool expanded;
     };
 
+    // Settings read on per-frame and per-message paths across threads.
+    // Writers rebuild and republish the snapshot under bigLock; readers
+    // fetch the current one atomically and never take the lock.
+    struct HotSettings
+    {
+        bool enableLogging = true;
+        bool audioInDevEnabled = true;
+        bool audioOutDevEnabled = true;
+        qreal audioInGainDecibel = 0;
+        qreal audioThreshold = 0;
+        int outVolume = 100;
+        QStringList blackList;
+    };
+
+    std::shared_ptr<const HotSettings> hotSnapshot() const;
+    void republishHotSettings();
+
+    std::shared_ptr<const HotSettings> hotSettings = std::make_shared<HotSettings>();
+
     QHash<QByteArray, friendProp> friendLst;
 
     QVector<circleProp> circleLst;
 
     int themeColor;
 
+    QTimer* globalSaveTimer{nullptr};
+    QTimer* personalSaveTimer{nullptr};
+
     static QMutex bigLock;
     static Settings* settings;
     static const QString globalSettingsFile;
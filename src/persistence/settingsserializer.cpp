@@ -23,8 +23,12 @@
 #include "src/core/toxencrypt.h"
 #include "src/persistence/profile.h"
 
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QSaveFile>
 #include <cassert>
 #include <memory>
@@ -301,6 +305,16 @@ void SettingsSerializer::save()
         }
     }
 
+    // Saves are triggered far more often than values actually change (e.g. by
+    // window geometry updates), and every write costs a whole-file fsync plus
+    // a fresh encryption pass. Skip the write when the content is unchanged.
+    if (!contentChanged(path, data)) {
+        f.cancelWriting();
+        return;
+    }
+
+    const QByteArray plainData = data;
+
     // Encrypt
     if (passKey) {
         data = passKey->encrypt(data);
@@ -311,12 +325,47 @@ void SettingsSerializer::save()
     // check if everything got written
     if (f.flush()) {
         f.commit();
+        rememberContent(path, plainData);
     } else {
         f.cancelWriting();
         qCritical() << "Failed to write, can't save!";
     }
 }
 
+namespace {
+QMutex savedHashesMutex;
+QHash<QString, QByteArray>& savedHashes()
+{
+    static QHash<QString, QByteArray> hashes;
+    return hashes;
+}
+} // namespace
+
+/**
+ * @brief Checks whether serialized settings differ from the last known disk state.
+ * @param path Settings file the data is destined for.
+ * @param data Serialized plaintext settings.
+ * @return False if the last load or save of this file had identical content.
+ */
+bool SettingsSerializer::contentChanged(const QString& path, const QByteArray& data)
+{
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+    QMutexLocker locker{&savedHashesMutex};
+    return savedHashes().value(path) != hash;
+}
+
+/**
+ * @brief Records the plaintext content now represented by the file on disk.
+ * @param path Settings file that was loaded or saved.
+ * @param data Serialized plaintext settings.
+ */
+void SettingsSerializer::rememberContent(const QString& path, const QByteArray& data)
+{
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+    QMutexLocker locker{&savedHashesMutex};
+    savedHashes()[path] = hash;
+}
+
 void SettingsSerializer::readSerialized()
 {
     QFile f(path);
@@ -348,6 +397,10 @@ void SettingsSerializer::readSerialized()
         qWarning() << "Bad magic!";
         return;
     }
+
+    // Prime the change tracking so an unchanged save after load is a no-op
+    rememberContent(path, data);
+
     data = data.mid(4);
 
     QDataStream stream(&data, QIODevice::ReadOnly);
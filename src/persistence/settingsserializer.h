@@ -101,6 +101,8 @@ private:
     void removeValue(const QString& key);
     void removeGroup(int group);
     void writePackedVariant(QDataStream& dataStream, const QVariant& v);
+    static bool contentChanged(const QString& path, const QByteArray& data);
+    static void rememberContent(const QString& path, const QByteArray& data);
 
 private:
     QString path;
@@ -19,15 +19,21 @@
 
 #include "smileypack.h"
 #include "src/persistence/settings.h"
+#include "src/util/resourcebundle.h"
+#include "src/util/workerpool.h"
 
+#include <QDataStream>
 #include <QDir>
 #include <QDomElement>
-#include <QRegularExpression>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QPainter>
+#include <QSaveFile>
 #include <QStandardPaths>
-#include <QStringBuilder>
-#include <QtConcurrent/QtConcurrentRun>
 #include <QTimer>
 
+#include <cmath>
+
 #if defined(Q_OS_FREEBSD)
 #include <locale.h>
 #endif
@@ -60,6 +66,24 @@ static const QString RICH_TEXT_PATTERN = QStringLiteral("<img title=\"%1\" src=\
 
 static const QString EMOTICONS_FILE_NAME = QStringLiteral("emoticons.xml");
 
+namespace {
+// on-disk decoded glyph atlas
+const quint32 AtlasCacheMagic = 0x71534d41; // "qSMA"
+const quint16 AtlasCacheVersion = 1;
+
+QString atlasCachePath()
+{
+    return Settings::getInstance().getAppCacheDirPath() + QStringLiteral("smileys.atlas");
+}
+
+// glyphs are baked at the size the chat draws them; the size is part of the
+// cache token, so changing it rebuilds the atlas
+int glyphSize()
+{
+    return qMax(8, Settings::getInstance().getEmojiFontPointSize());
+}
+} // namespace
+
 static constexpr int CLEANUP_TIMEOUT = 5 * 60 * 1000; // 5 minutes
 
 /**
@@ -109,7 +133,8 @@ SmileyPack::SmileyPack()
     : cleanupTimer{new QTimer(this)}
 {
     loadingMutex.lock();
-    QtConcurrent::run(this, &SmileyPack::load, Settings::getInstance().getSmileyPack());
+    const QString pack = Settings::getInstance().getSmileyPack();
+    WorkerPool::run(WorkerPool::Priority::Background, [this, pack] { load(pack); });
     connect(&Settings::getInstance(), &Settings::smileyPackChanged, this,
             &SmileyPack::onSmileyPackChanged);
     connect(cleanupTimer, &QTimer::timeout, this, &SmileyPack::cleanupIconsCache);
@@ -165,6 +190,12 @@ QList<QPair<QString, QString>> SmileyPack::listSmileyPacks(const QStringList& pa
             path.replace(0, 1, homePath);
         }
 
+        if (path.startsWith(QLatin1String(":/smileys"))) {
+            // listing wants every shipped pack visible, so mount both bundles
+            ResourceBundle::ensureRegistered(QStringLiteral("smileys_emojione"));
+            ResourceBundle::ensureRegistered(QStringLiteral("smileys_classic"));
+        }
+
         QDir dir(path);
         if (!dir.exists()) {
             continue;
@@ -195,6 +226,14 @@ QList<QPair<QString, QString>> SmileyPack::listSmileyPacks(const QStringList& pa
  */
 bool SmileyPack::load(const QString& filename)
 {
+    if (filename.startsWith(QLatin1String(":/smileys/"))) {
+        // shipped packs live in standalone bundles; mount only the one this
+        // pack (and its relative image references) actually needs
+        const bool emojione = filename.contains(QLatin1String("emojione"));
+        ResourceBundle::ensureRegistered(emojione ? QStringLiteral("smileys_emojione")
+                                                  : QStringLiteral("smileys_classic"));
+    }
+
     QFile xmlFile(filename);
     if (!xmlFile.exists() || !xmlFile.open(QIODevice::ReadOnly)) {
         loadingMutex.unlock();
@@ -245,36 +284,195 @@ bool SmileyPack::load(const QString& filename)
         emoticons.append(emoticonList);
     }
 
-    constructRegex();
+    buildTrie();
+
+    const QFileInfo xmlInfo(filename);
+    const QString cacheToken = filename + QLatin1Char('|')
+                               + QString::number(xmlInfo.lastModified().toMSecsSinceEpoch())
+                               + QLatin1Char('|') + QString::number(glyphSize())
+                               + QLatin1Char('|') + QStringLiteral(GIT_VERSION);
+    if (!loadAtlas(cacheToken)) {
+        buildAtlas(cacheToken);
+    }
 
     loadingMutex.unlock();
     return true;
 }
 
 /**
- * @brief Creates the regex for replacing emoticons with the path to their pictures
+ * @brief Maps the atlas cache file and serves glyphs out of it.
+ * @param cacheToken Token the cached atlas must match to be used.
+ * @return False if there is no usable cache for this pack, true otherwise.
+ *
+ * On a match the pixel data stays in the mapped file; warm starts fault in
+ * one file instead of decoding hundreds of small images.
  */
-void SmileyPack::constructRegex()
+bool SmileyPack::loadAtlas(const QString& cacheToken)
 {
-    QString allPattern = QStringLiteral("(");
+    atlasRects.clear();
+    atlasImage = QImage{};
+    atlasFile.reset();
 
-    // construct one big regex that matches on every emoticon
-    for (const QString& emote : emoticonToPath.keys()) {
-        if (emote.toUcs4().length() == 1) {
-            // UTF-8 emoji
-            allPattern = allPattern % emote;
-        } else {
-            // patterns like ":)" or ":smile:", don't match inside a word or else will hit punctuation and html tags
-            allPattern = allPattern % QStringLiteral(R"((?<=^|\s))") % QRegularExpression::escape(emote) % QStringLiteral(R"((?=$|\s))");
+    std::unique_ptr<QFile> file{new QFile(atlasCachePath())};
+    if (!file->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream{file.get()};
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    QString token;
+    stream >> magic >> version >> token;
+    if (stream.status() != QDataStream::Ok || magic != AtlasCacheMagic
+        || version != AtlasCacheVersion || token != cacheToken) {
+        return false;
+    }
+
+    quint32 width = 0;
+    quint32 height = 0;
+    quint32 glyphCount = 0;
+    stream >> width >> height >> glyphCount;
+
+    QHash<QString, QRect> rects;
+    for (quint32 i = 0; i < glyphCount; ++i) {
+        QString glyphPath;
+        qint32 x, y, w, h;
+        stream >> glyphPath >> x >> y >> w >> h;
+        rects.insert(glyphPath, QRect(x, y, w, h));
+    }
+
+    quint64 dataSize = 0;
+    stream >> dataSize;
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    // pixel rows start on an 8 byte boundary, see buildAtlas()
+    const qint64 offset = (file->pos() + 7) & ~qint64(7);
+    if (dataSize != quint64(width) * height * 4
+        || offset + qint64(dataSize) > file->size()) {
+        return false;
+    }
+
+    // a missing glyph means the pack changed under an unchanged token
+    for (const QString& glyphPath : emoticonToPath) {
+        if (!rects.contains(glyphPath)) {
+            return false;
         }
-        allPattern = allPattern % QStringLiteral("|");
     }
 
-    allPattern[allPattern.size() - 1] = QChar(')');
+    uchar* mapped = file->map(0, file->size());
+    if (!mapped) {
+        return false;
+    }
 
-    // compile and optimize regex
-    smilify.setPattern(allPattern);
-    smilify.optimize();
+    atlasImage = QImage(mapped + offset, width, height, width * 4,
+                        QImage::Format_ARGB32_Premultiplied);
+    atlasRects = rects;
+    atlasFile = std::move(file);
+    return true;
+}
+
+/**
+ * @brief Decodes every glyph of the pack once and persists the result.
+ * @param cacheToken Token identifying the pack content and glyph size.
+ */
+void SmileyPack::buildAtlas(const QString& cacheToken)
+{
+    QStringList glyphPaths = emoticonToPath.values();
+    glyphPaths.removeDuplicates();
+    glyphPaths.sort();
+    if (glyphPaths.isEmpty()) {
+        return;
+    }
+
+    const int cell = glyphSize();
+    const int columns = qMax(1, qRound(std::ceil(std::sqrt(double(glyphPaths.size())))));
+    const int rows = (glyphPaths.size() + columns - 1) / columns;
+
+    QImage atlas(columns * cell, rows * cell, QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+
+    QHash<QString, QRect> rects;
+    QPainter painter(&atlas);
+    int placed = 0;
+    for (const QString& glyphPath : glyphPaths) {
+        // QImageReader probes the content, so the extension-less paths some
+        // packs use still decode; svg glyphs rasterize at the target size
+        QImageReader reader(glyphPath);
+        reader.setScaledSize(QSize(cell, cell));
+        const QImage glyph = reader.read();
+        if (glyph.isNull()) {
+            continue;
+        }
+
+        const QRect rect((placed % columns) * cell, (placed / columns) * cell, cell, cell);
+        painter.drawImage(rect, glyph);
+        rects.insert(glyphPath, rect);
+        ++placed;
+    }
+    painter.end();
+
+    atlasImage = atlas;
+    atlasRects = rects;
+    atlasFile.reset();
+
+    QDir{}.mkpath(Settings::getInstance().getAppCacheDirPath());
+    QSaveFile file(atlasCachePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Couldn't write smiley atlas cache";
+        return;
+    }
+
+    QDataStream stream{&file};
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << AtlasCacheMagic << AtlasCacheVersion << cacheToken;
+    stream << quint32(atlas.width()) << quint32(atlas.height()) << quint32(rects.size());
+    for (auto it = rects.cbegin(); it != rects.cend(); ++it) {
+        stream << it.key() << qint32(it->x()) << qint32(it->y()) << qint32(it->width())
+               << qint32(it->height());
+    }
+    stream << quint64(atlas.width()) * atlas.height() * 4;
+
+    // align the pixel rows so the mapped image starts on an 8 byte boundary
+    while (file.pos() % 8 != 0) {
+        stream << quint8(0);
+    }
+    file.write(reinterpret_cast<const char*>(atlas.constBits()),
+               qint64(atlas.width()) * atlas.height() * 4);
+    file.commit();
+}
+
+/**
+ * @brief Builds the trie used to find emoticons in messages
+ *
+ * One trie walk per message position replaces the old alternation regex, so a
+ * message is scanned in a single pass no matter how many emoticons the pack has.
+ */
+void SmileyPack::buildTrie()
+{
+    matchTrie.clear();
+    matchTrie.append(TrieNode{});
+
+    for (auto it = emoticonToPath.begin(); it != emoticonToPath.end(); ++it) {
+        const QString& emote = it.key();
+        int node = 0;
+        for (const QChar c : emote) {
+            int next = matchTrie[node].children.value(c, -1);
+            if (next == -1) {
+                next = matchTrie.size();
+                matchTrie[node].children.insert(c, next);
+                matchTrie.append(TrieNode{});
+            }
+            node = next;
+        }
+        matchTrie[node].matchLength = emote.size();
+        // patterns like ":)" or ":smile:" don't match inside a word or else will hit
+        // punctuation and html tags, single UTF-8 emoji match anywhere
+        matchTrie[node].needsBoundary = emote.toUcs4().length() != 1;
+    }
 }
 
 /**
@@ -285,18 +483,48 @@ void SmileyPack::constructRegex()
 QString SmileyPack::smileyfied(const QString& msg)
 {
     QMutexLocker locker(&loadingMutex);
-    QString result(msg);
-
-    int replaceDiff = 0;
-    QRegularExpressionMatchIterator iter = smilify.globalMatch(result);
-    while (iter.hasNext()) {
-        QRegularExpressionMatch match = iter.next();
-        int startPos = match.capturedStart();
-        int keyLength = match.capturedLength();
-        QString imgRichText = getAsRichText(match.captured());
-        result.replace(startPos + replaceDiff, keyLength, imgRichText);
-        replaceDiff += imgRichText.length() - keyLength;
+    if (matchTrie.isEmpty()) {
+        return msg;
+    }
+
+    QString result;
+    result.reserve(msg.size());
+
+    int pos = 0;
+    while (pos < msg.size()) {
+        // walk the trie as deep as the text allows, remembering the longest valid match
+        int node = 0;
+        int matchLength = 0;
+        for (int i = pos; i < msg.size(); ++i) {
+            node = matchTrie[node].children.value(msg[i], -1);
+            if (node == -1) {
+                break;
+            }
+
+            const TrieNode& candidate = matchTrie[node];
+            if (candidate.matchLength == 0) {
+                continue;
+            }
+
+            const int end = pos + candidate.matchLength;
+            if (candidate.needsBoundary
+                && ((pos != 0 && !msg[pos - 1].isSpace())
+                    || (end != msg.size() && !msg[end].isSpace()))) {
+                continue;
+            }
+
+            matchLength = candidate.matchLength;
+        }
+
+        if (matchLength > 0) {
+            result += getAsRichText(msg.mid(pos, matchLength));
+            pos += matchLength;
+        } else {
+            result += msg[pos];
+            ++pos;
+        }
     }
+
     return result;
 }
 
@@ -327,7 +555,15 @@ std::shared_ptr<QIcon> SmileyPack::getAsIcon(const QString& emoticon) const
     }
 
     const QString& iconPath = iconPathIt.value();
-    auto icon = std::make_shared<QIcon>(iconPath);
+    std::shared_ptr<QIcon> icon;
+    const auto rectIt = atlasRects.constFind(iconPath);
+    if (rectIt != atlasRects.cend() && !atlasImage.isNull()) {
+        // a view into the atlas; only the touched pages of the cache file
+        // actually fault in
+        icon = std::make_shared<QIcon>(QPixmap::fromImage(atlasImage.copy(*rectIt)));
+    } else {
+        icon = std::make_shared<QIcon>(iconPath);
+    }
     cachedIcon[emoticon] = icon;
     return icon;
 }
@@ -335,5 +571,6 @@ std::shared_ptr<QIcon> SmileyPack::getAsIcon(const QString& emoticon) const
 void SmileyPack::onSmileyPackChanged()
 {
     loadingMutex.lock();
-    QtConcurrent::run(this, &SmileyPack::load, Settings::getInstance().getSmileyPack());
+    const QString pack = Settings::getInstance().getSmileyPack();
+    WorkerPool::run(WorkerPool::Priority::Background, [this, pack] { load(pack); });
 }
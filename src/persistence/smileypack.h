@@ -20,13 +20,17 @@
 #ifndef SMILEYPACK_H
 #define SMILEYPACK_H
 
+#include <QHash>
 #include <QIcon>
+#include <QImage>
 #include <QMap>
 #include <QMutex>
-#include <QRegularExpression>
+#include <QRect>
+#include <QVector>
 
 #include <memory>
 
+class QFile;
 class QTimer;
 
 class SmileyPack : public QObject
@@ -52,15 +56,32 @@ private:
     SmileyPack& operator=(const SmileyPack&) = delete;
     ~SmileyPack() override;
 
+    /**
+     * @brief Node of the emoticon matching trie, see buildTrie()
+     */
+    struct TrieNode
+    {
+        QHash<QChar, int> children;
+        int matchLength = 0; ///< >0 if an emoticon ends on this node
+        bool needsBoundary = false;
+    };
+
     bool load(const QString& filename);
-    void constructRegex();
+    void buildTrie();
+    bool loadAtlas(const QString& cacheToken);
+    void buildAtlas(const QString& cacheToken);
 
     mutable std::map<QString, std::shared_ptr<QIcon>> cachedIcon;
     QHash<QString, QString> emoticonToPath;
+    // every decoded glyph of the pack, baked side by side into one image;
+    // served straight from the mapped cache file on warm starts
+    QHash<QString, QRect> atlasRects;
+    QImage atlasImage;
+    std::unique_ptr<QFile> atlasFile;
     QList<QStringList> emoticons;
     QString path;
     QTimer* cleanupTimer;
-    QRegularExpression smilify;
+    QVector<TrieNode> matchTrie;
     mutable QMutex loadingMutex;
 };
 
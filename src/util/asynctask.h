@@ -0,0 +1,63 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ASYNC_TASK_H
+#define ASYNC_TASK_H
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <utility>
+
+/**
+ * @brief Minimal continuation helper for work that must not block the GUI.
+ *
+ * runThen() runs the task on the global thread pool and delivers its return
+ * value to the continuation on the context object's thread, through its event
+ * loop. That gives the two guarantees composing over raw QtConcurrent or
+ * RawDatabase::execLater callbacks by hand keeps getting wrong:
+ *
+ *  - thread affinity: the continuation always runs on the context's thread,
+ *    never on the pool thread that produced the value;
+ *  - lifetime: if the context is destroyed while the task is in flight, the
+ *    continuation is dropped instead of running against a dead object.
+ *
+ * Chain tasks by calling runThen() again from inside a continuation. The task
+ * must only touch state that is safe from a pool thread (RawDatabase and
+ * History queries are; widget state is not).
+ */
+namespace AsyncTask
+{
+template <typename TaskFn, typename DoneFn>
+void runThen(const QObject* context, TaskFn task, DoneFn done)
+{
+    using Result = decltype(task());
+
+    // Not parented to context: the watcher may outlive it and cleans itself
+    // up once the pool thread finishes either way
+    auto watcher = new QFutureWatcher<Result>();
+    QObject::connect(watcher, &QFutureWatcher<Result>::finished, context,
+                     [watcher, done]() { done(watcher->result()); });
+    QObject::connect(watcher, &QFutureWatcher<Result>::finished, watcher, &QObject::deleteLater);
+    watcher->setFuture(QtConcurrent::run(std::move(task)));
+}
+} // namespace AsyncTask
+
+#endif /* ASYNC_TASK_H */
@@ -0,0 +1,163 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "coarsetimerservice.h"
+
+#include "idlemode.h"
+
+#include <algorithm>
+
+/**
+ * @class CoarseTimerService
+ * @brief Shared deadline scheduler for non-latency-critical periodic work.
+ *
+ * Every independent QTimer is its own wakeup source; a dozen of them keep
+ * an idle process stuttering awake, which power-constrained machines
+ * notice. Subscribers hand their interval and callback to this service
+ * instead: all deadlines snap to a common grid, so work due around the
+ * same time shares one wakeup, and a single one-shot timer is armed for
+ * the earliest deadline only.
+ *
+ * By contract subscribers tolerate grid-sized jitter - anything that needs
+ * precise timing (animation, call audio) has no business here. GUI thread
+ * only, like the timers it replaces.
+ */
+
+namespace {
+// all deadlines snap to this grid; it bounds both the added jitter and the
+// maximum wakeup rate the service can cause
+constexpr qint64 GRID_MS = 250;
+
+// while the user is idle every subscriber period is multiplied by this;
+// coarse-tolerant work by definition survives running a few times slower
+constexpr qint64 IDLE_STRETCH = 4;
+
+qint64 snapToGrid(qint64 ms)
+{
+    return (ms + GRID_MS - 1) / GRID_MS * GRID_MS;
+}
+} // namespace
+
+CoarseTimerService::CoarseTimerService()
+{
+    timer.setSingleShot(true);
+    // the OS may defer the wakeup even further, which subscribers tolerate
+    timer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&timer, &QTimer::timeout, this, &CoarseTimerService::onTimeout);
+    clock.start();
+
+    connect(&IdleMode::getInstance(), &IdleMode::idleChanged, this,
+            &CoarseTimerService::onIdleChanged);
+}
+
+/**
+ * @brief Returns the singleton instance.
+ */
+CoarseTimerService& CoarseTimerService::getInstance()
+{
+    static CoarseTimerService instance;
+    return instance;
+}
+
+/**
+ * @brief Registers a periodic callback.
+ * @param owner Object the callback belongs to; its destruction unsubscribes.
+ * @param intervalMs Requested period, rounded up to the service grid.
+ * @param callback Invoked on the GUI thread when the period elapsed.
+ */
+void CoarseTimerService::subscribe(QObject* owner, int intervalMs,
+                                   const std::function<void()>& callback)
+{
+    Entry entry;
+    entry.owner = owner;
+    entry.intervalMs = qMax<qint64>(intervalMs, GRID_MS);
+    entry.dueMs = snapToGrid(clock.elapsed() + entry.intervalMs * stretch);
+    entry.callback = callback;
+    entries.push_back(entry);
+
+    connect(owner, &QObject::destroyed, this, [this, owner]() { unsubscribe(owner); });
+
+    reschedule();
+}
+
+/**
+ * @brief Drops all of an owner's callbacks.
+ */
+void CoarseTimerService::unsubscribe(QObject* owner)
+{
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [owner](const Entry& e) { return e.owner == owner; }),
+                  entries.end());
+    reschedule();
+}
+
+/**
+ * @brief Stretches or restores every pending deadline when idle mode flips.
+ *
+ * Deadlines are recomputed from now rather than scaled in place, so leaving
+ * idle mode never fires a backlog of stretched work all at once.
+ */
+void CoarseTimerService::onIdleChanged(bool idle)
+{
+    stretch = idle ? IDLE_STRETCH : 1;
+
+    for (Entry& entry : entries)
+        entry.dueMs = snapToGrid(clock.elapsed() + entry.intervalMs * stretch);
+
+    reschedule();
+}
+
+void CoarseTimerService::onTimeout()
+{
+    // deadlines within half a grid step count as due, rather than spending
+    // an extra wakeup on them a moment later
+    const qint64 now = clock.elapsed() + GRID_MS / 2;
+
+    // collect first: a callback may subscribe or unsubscribe, which would
+    // invalidate iteration over the entries
+    std::vector<std::function<void()>> due;
+    for (Entry& entry : entries) {
+        if (entry.dueMs <= now) {
+            entry.dueMs = snapToGrid(clock.elapsed() + entry.intervalMs * stretch);
+            due.push_back(entry.callback);
+        }
+    }
+
+    for (const std::function<void()>& callback : due)
+        callback();
+
+    reschedule();
+}
+
+/**
+ * @brief Arms the timer for the earliest pending deadline, if any.
+ */
+void CoarseTimerService::reschedule()
+{
+    if (entries.empty()) {
+        timer.stop();
+        return;
+    }
+
+    qint64 nextDue = entries.front().dueMs;
+    for (const Entry& entry : entries)
+        nextDue = qMin(nextDue, entry.dueMs);
+
+    timer.start(qMax<qint64>(nextDue - clock.elapsed(), 0));
+}
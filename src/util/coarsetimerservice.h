@@ -0,0 +1,61 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COARSETIMERSERVICE_H
+#define COARSETIMERSERVICE_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+#include <functional>
+#include <vector>
+
+class CoarseTimerService : public QObject
+{
+    Q_OBJECT
+public:
+    static CoarseTimerService& getInstance();
+
+    void subscribe(QObject* owner, int intervalMs, const std::function<void()>& callback);
+    void unsubscribe(QObject* owner);
+
+private slots:
+    void onTimeout();
+    void onIdleChanged(bool idle);
+
+private:
+    CoarseTimerService();
+    void reschedule();
+
+    struct Entry
+    {
+        QObject* owner;
+        qint64 intervalMs;
+        qint64 dueMs;
+        std::function<void()> callback;
+    };
+
+    QTimer timer;
+    QElapsedTimer clock;
+    std::vector<Entry> entries;
+    qint64 stretch = 1;
+};
+
+#endif // COARSETIMERSERVICE_H
@@ -0,0 +1,99 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "idlemode.h"
+
+#ifdef QTOX_PLATFORM_EXT
+#include "src/platform/timer.h"
+#endif
+
+/**
+ * @class IdleMode
+ * @brief Process-wide idle flag that background work keys off.
+ *
+ * The auto-away check in Widget flips this flag once the user has been away
+ * from the keyboard long enough; subscribers such as the animation clock and
+ * the coarse timer service downshift while it is set. A coordinated flag
+ * beats each subsystem guessing on its own: everything slows down together
+ * and everything comes back together.
+ *
+ * While idle, a one second very coarse poll of the platform idle counter is
+ * the only wakeup this class adds. It exists so work snaps back the moment
+ * the user touches the machine again, instead of whenever the next stretched
+ * timer happens to fire.
+ */
+
+namespace {
+// input this recent counts as the user being back at the keyboard
+constexpr uint32_t ACTIVITY_THRESHOLD_MS = 2000;
+}
+
+IdleMode::IdleMode()
+{
+    wakeWatch.setInterval(1000);
+    wakeWatch.setSingleShot(false);
+    wakeWatch.setTimerType(Qt::VeryCoarseTimer);
+    connect(&wakeWatch, &QTimer::timeout, this, &IdleMode::checkActivity);
+}
+
+/**
+ * @brief Returns the singleton instance.
+ */
+IdleMode& IdleMode::getInstance()
+{
+    static IdleMode instance;
+    return instance;
+}
+
+/**
+ * @brief Flips the idle flag and notifies subscribers on a change.
+ */
+void IdleMode::setIdle(bool idle)
+{
+    if (this->idle == idle)
+        return;
+
+    this->idle = idle;
+
+#ifdef QTOX_PLATFORM_EXT
+    if (idle) {
+        wakeWatch.start();
+    } else {
+        wakeWatch.stop();
+    }
+#endif
+
+    emit idleChanged(idle);
+}
+
+bool IdleMode::isIdle() const
+{
+    return idle;
+}
+
+/**
+ * @brief Leaves idle mode as soon as the platform reports fresh user input.
+ */
+void IdleMode::checkActivity()
+{
+#ifdef QTOX_PLATFORM_EXT
+    if (Platform::getIdleTime() < ACTIVITY_THRESHOLD_MS)
+        setIdle(false);
+#endif
+}
@@ -0,0 +1,51 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef IDLEMODE_H
+#define IDLEMODE_H
+
+#include <QObject>
+#include <QTimer>
+
+class IdleMode : public QObject
+{
+    Q_OBJECT
+public:
+    static IdleMode& getInstance();
+
+    void setIdle(bool idle);
+    bool isIdle() const;
+
+signals:
+    void idleChanged(bool idle);
+
+private slots:
+    void checkActivity();
+
+private:
+    IdleMode();
+    IdleMode(IdleMode&) = delete;
+    IdleMode& operator=(IdleMode&) = delete;
+
+private:
+    bool idle = false;
+    QTimer wakeWatch;
+};
+
+#endif // IDLEMODE_H
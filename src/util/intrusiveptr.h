@@ -0,0 +1,203 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INTRUSIVEPTR_H
+#define INTRUSIVEPTR_H
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+template <typename T>
+class IntrusivePtr;
+
+/**
+ * @brief Base class embedding the reference count for IntrusivePtr.
+ *
+ * Unlike std::shared_ptr there is no separately allocated control block, and
+ * the count is deliberately a plain int rather than an atomic: the handles
+ * this is meant for are confined to a single thread, where atomic traffic on
+ * every copy would be pure cost. Objects must therefore only be shared
+ * through IntrusivePtr from the thread that created them.
+ */
+class IntrusiveRefCounted
+{
+public:
+    IntrusiveRefCounted() = default;
+    // a copied object starts with no handles of its own
+    IntrusiveRefCounted(const IntrusiveRefCounted&)
+    {
+    }
+    IntrusiveRefCounted& operator=(const IntrusiveRefCounted&)
+    {
+        return *this;
+    }
+
+protected:
+    ~IntrusiveRefCounted()
+    {
+        assert(refCount == 0);
+    }
+
+private:
+    template <typename T>
+    friend class IntrusivePtr;
+
+    mutable int refCount = 0;
+};
+
+/**
+ * @brief Shared-ownership handle with the count stored inside the object.
+ *
+ * Drop-in for the std::shared_ptr uses in the chat view: copy, move,
+ * implicit upcast, get/reset and the usual comparisons. No weak references
+ * and no custom deleters, none of the call sites need them.
+ */
+template <typename T>
+class IntrusivePtr
+{
+public:
+    using element_type = T;
+
+    IntrusivePtr() = default;
+
+    IntrusivePtr(std::nullptr_t)
+    {
+    }
+
+    explicit IntrusivePtr(T* p)
+        : ptr{p}
+    {
+        ref();
+    }
+
+    IntrusivePtr(const IntrusivePtr& other)
+        : ptr{other.ptr}
+    {
+        ref();
+    }
+
+    IntrusivePtr(IntrusivePtr&& other) noexcept
+        : ptr{other.ptr}
+    {
+        other.ptr = nullptr;
+    }
+
+    // implicit upcasts, e.g. ChatMessage::Ptr to ChatLine::Ptr
+    template <typename U>
+    IntrusivePtr(const IntrusivePtr<U>& other)
+        : ptr{other.ptr}
+    {
+        ref();
+    }
+
+    template <typename U>
+    IntrusivePtr(IntrusivePtr<U>&& other) noexcept
+        : ptr{other.ptr}
+    {
+        other.ptr = nullptr;
+    }
+
+    ~IntrusivePtr()
+    {
+        deref();
+    }
+
+    // pass-by-value covers both copy and move assignment
+    IntrusivePtr& operator=(IntrusivePtr other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    void reset()
+    {
+        deref();
+        ptr = nullptr;
+    }
+
+    void swap(IntrusivePtr& other) noexcept
+    {
+        std::swap(ptr, other.ptr);
+    }
+
+    T* get() const
+    {
+        return ptr;
+    }
+
+    T& operator*() const
+    {
+        return *ptr;
+    }
+
+    T* operator->() const
+    {
+        return ptr;
+    }
+
+    explicit operator bool() const
+    {
+        return ptr != nullptr;
+    }
+
+private:
+    template <typename U>
+    friend class IntrusivePtr;
+
+    void ref()
+    {
+        if (ptr)
+            ++ptr->refCount;
+    }
+
+    void deref()
+    {
+        if (ptr && --ptr->refCount == 0)
+            delete ptr;
+    }
+
+    T* ptr = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const IntrusivePtr<T>& lhs, const IntrusivePtr<U>& rhs)
+{
+    return lhs.get() == rhs.get();
+}
+
+template <typename T, typename U>
+bool operator!=(const IntrusivePtr<T>& lhs, const IntrusivePtr<U>& rhs)
+{
+    return lhs.get() != rhs.get();
+}
+
+template <typename T>
+bool operator==(const IntrusivePtr<T>& lhs, std::nullptr_t)
+{
+    return lhs.get() == nullptr;
+}
+
+template <typename T>
+bool operator!=(const IntrusivePtr<T>& lhs, std::nullptr_t)
+{
+    return lhs.get() != nullptr;
+}
+
+#endif // INTRUSIVEPTR_H
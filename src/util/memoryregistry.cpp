@@ -0,0 +1,99 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "memoryregistry.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+/**
+ * @class MemoryRegistry
+ *
+ * Central place the caching subsystems report their memory usage into, so
+ * RSS growth can be attributed without attaching a heap profiler. Each
+ * subsystem registers a sampler that describes its current usage in one
+ * line; snapshot() runs them all on demand (advanced settings page, log
+ * dump), so an idle qTox pays nothing.
+ *
+ * Samplers run on the caller's thread and must do their own locking.
+ */
+
+QVector<MemoryRegistry::Entry> MemoryRegistry::entries;
+QMutex MemoryRegistry::lock;
+
+/**
+ * @brief Registers a usage sampler for a subsystem.
+ * @param subsystem Human-readable name, prefixed to the sampler's line.
+ * @param sampler Returns a one-line usage description when invoked.
+ * @param owner Tag to unregister by; usually the reporting object.
+ */
+void MemoryRegistry::registerSampler(const QString& subsystem, const Sampler& sampler, void* owner)
+{
+    QMutexLocker locker{&lock};
+    entries.append(Entry{owner, subsystem, sampler});
+}
+
+void MemoryRegistry::unregister(void* owner)
+{
+    QMutexLocker locker{&lock};
+    for (int i = entries.size() - 1; i >= 0; --i) {
+        if (entries[i].owner == owner) {
+            entries.remove(i);
+        }
+    }
+}
+
+/**
+ * @brief Current usage of every registered subsystem, one line each.
+ */
+QStringList MemoryRegistry::snapshot()
+{
+    QVector<Entry> copy;
+    {
+        // copied so samplers run without the registry lock held; a sampler
+        // whose subsystem registers or unregisters while sampling would
+        // deadlock otherwise
+        QMutexLocker locker{&lock};
+        copy = entries;
+    }
+
+    QStringList lines;
+    for (const Entry& entry : copy) {
+        lines.append(entry.subsystem + ": " + entry.sampler());
+    }
+    return lines;
+}
+
+void MemoryRegistry::dumpToLog()
+{
+    for (const QString& line : snapshot()) {
+        qDebug() << "Memory usage:" << line;
+    }
+}
+
+QString MemoryRegistry::formatBytes(quint64 bytes)
+{
+    if (bytes >= 1024 * 1024) {
+        return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MiB";
+    }
+    if (bytes >= 1024) {
+        return QString::number(bytes / 1024.0, 'f', 1) + " KiB";
+    }
+    return QString::number(bytes) + " B";
+}
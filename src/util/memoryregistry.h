@@ -0,0 +1,52 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MEMORYREGISTRY_H
+#define MEMORYREGISTRY_H
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+class MemoryRegistry
+{
+public:
+    using Sampler = std::function<QString()>;
+
+    static void registerSampler(const QString& subsystem, const Sampler& sampler, void* owner);
+    static void unregister(void* owner);
+    static QStringList snapshot();
+    static void dumpToLog();
+    static QString formatBytes(quint64 bytes);
+
+private:
+    struct Entry
+    {
+        void* owner;
+        QString subsystem;
+        Sampler sampler;
+    };
+
+    static QVector<Entry> entries;
+    static QMutex lock;
+};
+
+#endif // MEMORYREGISTRY_H
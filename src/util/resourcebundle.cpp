@@ -0,0 +1,93 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "resourcebundle.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QResource>
+#include <QSet>
+#include <QStandardPaths>
+
+/**
+ * @namespace ResourceBundle
+ *
+ * The heavyweight asset trees (themes, smiley packs) are compiled into
+ * standalone .rcc files instead of the binary and mounted into the resource
+ * system here the first time something asks for them, so a profile that
+ * only ever uses one theme and one pack never maps the rest.
+ */
+
+namespace {
+QMutex registryLock;
+QSet<QString> registeredBundles;
+
+QString locateBundle(const QString& name)
+{
+    const QString fileName = name + QStringLiteral(".rcc");
+
+    // next to the binary covers builds run in place and portable installs
+    QString candidate = QCoreApplication::applicationDirPath() + QLatin1Char('/') + fileName;
+    if (QFile::exists(candidate)) {
+        return candidate;
+    }
+
+#ifdef Q_OS_OSX
+    candidate = QCoreApplication::applicationDirPath() + QStringLiteral("/../Resources/") + fileName;
+    if (QFile::exists(candidate)) {
+        return candidate;
+    }
+#endif
+
+    // installed bundles land in <datadir>/qtox/
+    return QStandardPaths::locate(QStandardPaths::GenericDataLocation,
+                                  QStringLiteral("qtox/") + fileName);
+}
+} // namespace
+
+namespace ResourceBundle {
+/**
+ * @brief Mounts the named .rcc bundle into the Qt resource system.
+ * @param name Bundle name without the .rcc suffix, e.g. "theme_dark".
+ * @return True if the bundle is (now) registered.
+ *
+ * Registration happens once per bundle and is thread-safe; later calls for
+ * the same name are cheap no-ops.
+ */
+bool ensureRegistered(const QString& name)
+{
+    QMutexLocker locker{&registryLock};
+    if (registeredBundles.contains(name)) {
+        return true;
+    }
+
+    const QString path = locateBundle(name);
+    if (path.isEmpty() || !QResource::registerResource(path)) {
+        qWarning() << "Couldn't register resource bundle" << name;
+        return false;
+    }
+
+    qDebug() << "Registered resource bundle" << path;
+    registeredBundles.insert(name);
+    return true;
+}
+} // namespace ResourceBundle
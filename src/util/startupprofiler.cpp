@@ -0,0 +1,109 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "startupprofiler.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <stdio.h>
+
+/**
+ * @class StartupProfiler
+ *
+ * Records named spans around startup stages when qTox is launched with
+ * --profile-startup, and prints them as one JSON line on stdout once the
+ * event loop is about to start. Disabled it costs a branch per call.
+ * Phases may nest (loadProfile runs inside the bootstrap span); endPhase
+ * closes the most recent open span with the given name.
+ *
+ * All calls happen on the main thread during startup, so no locking.
+ */
+
+bool StartupProfiler::enabled{false};
+QElapsedTimer StartupProfiler::startupTimer;
+QVector<StartupProfiler::Phase> StartupProfiler::phases;
+
+void StartupProfiler::enable()
+{
+    enabled = true;
+    startupTimer.start();
+}
+
+bool StartupProfiler::isEnabled()
+{
+    return enabled;
+}
+
+void StartupProfiler::startPhase(const char* name)
+{
+    if (!enabled) {
+        return;
+    }
+
+    phases.append(Phase{QString::fromLatin1(name), startupTimer.elapsed(), -1});
+}
+
+void StartupProfiler::endPhase(const char* name)
+{
+    if (!enabled) {
+        return;
+    }
+
+    for (int i = phases.size() - 1; i >= 0; --i) {
+        Phase& phase = phases[i];
+        if (phase.durationMs < 0 && phase.name == QLatin1String(name)) {
+            phase.durationMs = startupTimer.elapsed() - phase.startMs;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Prints the recorded spans as compact JSON on stdout.
+ *
+ * stdout rather than the log, so fleet tooling can parse it without
+ * stripping the log message handler's prefixes.
+ */
+void StartupProfiler::report()
+{
+    if (!enabled) {
+        return;
+    }
+
+    QJsonArray spans;
+    for (const Phase& phase : phases) {
+        QJsonObject span;
+        span["name"] = phase.name;
+        span["start_ms"] = phase.startMs;
+        if (phase.durationMs >= 0) {
+            span["duration_ms"] = phase.durationMs;
+        }
+        spans.append(span);
+    }
+
+    QJsonObject root;
+    root["total_ms"] = startupTimer.elapsed();
+    root["phases"] = spans;
+
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Compact);
+    fprintf(stdout, "%s\n", json.constData());
+    fflush(stdout);
+}
@@ -0,0 +1,49 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+class StartupProfiler
+{
+public:
+    static void enable();
+    static bool isEnabled();
+    static void startPhase(const char* name);
+    static void endPhase(const char* name);
+    static void report();
+
+private:
+    struct Phase
+    {
+        QString name;
+        qint64 startMs;
+        qint64 durationMs;
+    };
+
+    static bool enabled;
+    static QElapsedTimer startupTimer;
+    static QVector<Phase> phases;
+};
+
+#endif // STARTUPPROFILER_H
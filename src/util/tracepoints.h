@@ -0,0 +1,49 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QTOX_TRACEPOINTS_H
+#define QTOX_TRACEPOINTS_H
+
+/**
+ * USDT tracepoints for the hot paths, under the "qtox" provider.
+ *
+ * Built with -DTRACEPOINTS=ON these expand to SystemTap/DTrace static
+ * probes: a single nop until a tracer (bpftrace, perf probe, systemtap)
+ * attaches to a live process, so they can stay in release builds and be
+ * used during incidents without restarting qTox. Without the option they
+ * compile to nothing.
+ *
+ * Example:
+ *   bpftrace -e 'usdt:./qtox:qtox:db_batch { @sizes = hist(arg0); }'
+ */
+
+#ifdef ENABLE_TRACEPOINTS
+#include <sys/sdt.h>
+#define QTOX_TRACE(probe) DTRACE_PROBE(qtox, probe)
+#define QTOX_TRACE1(probe, a1) DTRACE_PROBE1(qtox, probe, a1)
+#define QTOX_TRACE2(probe, a1, a2) DTRACE_PROBE2(qtox, probe, a1, a2)
+#define QTOX_TRACE3(probe, a1, a2, a3) DTRACE_PROBE3(qtox, probe, a1, a2, a3)
+#else
+#define QTOX_TRACE(probe)
+#define QTOX_TRACE1(probe, a1)
+#define QTOX_TRACE2(probe, a1, a2)
+#define QTOX_TRACE3(probe, a1, a2, a3)
+#endif
+
+#endif // QTOX_TRACEPOINTS_H
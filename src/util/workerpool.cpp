@@ -0,0 +1,117 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "workerpool.h"
+
+#include <QRunnable>
+#include <QThreadPool>
+
+/**
+ * @class WorkerPool
+ * @brief Central scheduling policy for threads and pooled work.
+ *
+ * qTox keeps its dedicated threads — audio, camera, database — because they
+ * need their own event loops or blocking semantics, but their OS priorities
+ * and all one-shot pooled work are decided here, in one place. That keeps
+ * background work (smiley pack loading, cache warming) from competing with
+ * call processing: the AV threads run above normal priority, pooled
+ * background tasks run below it and behind more urgent tasks in the pool's
+ * queue, and on dual-core machines the pool is capped to a single thread so
+ * a core is always left for the realtime side.
+ */
+
+namespace {
+class Task : public QRunnable
+{
+public:
+    Task(WorkerPool::Priority priority, std::function<void()> task)
+        : priority{priority}
+        , task{std::move(task)}
+    {
+    }
+
+    void run() override
+    {
+        // pool threads are recycled, so the priority is scoped to the task
+        QThread* thread = QThread::currentThread();
+        thread->setPriority(WorkerPool::threadPriority(priority));
+        task();
+        thread->setPriority(QThread::NormalPriority);
+    }
+
+private:
+    WorkerPool::Priority priority;
+    std::function<void()> task;
+};
+
+int queuePriority(WorkerPool::Priority priority)
+{
+    switch (priority) {
+    case WorkerPool::Priority::Realtime:
+        return 2;
+    case WorkerPool::Priority::Interactive:
+        return 1;
+    case WorkerPool::Priority::Background:
+        return 0;
+    }
+    return 0;
+}
+} // namespace
+
+/**
+ * @brief Applies the machine-wide pool sizing policy; call once at startup.
+ */
+void WorkerPool::init()
+{
+    // On the dual-core thin clients a full-size pool means every background
+    // task steals time from a call; leave them one general-purpose thread.
+    // QtConcurrent shares the global pool, so this covers it too.
+    const int ideal = QThread::idealThreadCount();
+    if (ideal > 0 && ideal <= 2) {
+        QThreadPool::globalInstance()->setMaxThreadCount(1);
+    }
+}
+
+/**
+ * @brief Schedules a one-shot task on the shared pool.
+ * @param priority Decides queue order and the thread priority it runs at.
+ * @param task Must not touch GUI state; use AsyncTask for completions.
+ */
+void WorkerPool::run(Priority priority, std::function<void()> task)
+{
+    // QThreadPool takes ownership and deletes the runnable after run()
+    QThreadPool::globalInstance()->start(new Task(priority, std::move(task)),
+                                         queuePriority(priority));
+}
+
+/**
+ * @brief Maps a priority class to the OS priority for a dedicated thread.
+ */
+QThread::Priority WorkerPool::threadPriority(Priority priority)
+{
+    switch (priority) {
+    case Priority::Realtime:
+        return QThread::HighPriority;
+    case Priority::Interactive:
+        return QThread::NormalPriority;
+    case Priority::Background:
+        return QThread::LowPriority;
+    }
+    return QThread::NormalPriority;
+}
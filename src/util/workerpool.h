@@ -0,0 +1,47 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <QThread>
+
+#include <functional>
+
+class WorkerPool
+{
+public:
+    enum class Priority
+    {
+        // call processing: audio and video threads, drops are audible
+        Realtime,
+        // work the user is waiting on, like DB reads behind the chat view
+        Interactive,
+        // maintenance nobody is waiting on: cache warming, cleanup
+        Background
+    };
+
+    WorkerPool() = delete;
+
+    static void init();
+    static void run(Priority priority, std::function<void()> task);
+    static QThread::Priority threadPriority(Priority priority);
+};
+
+#endif /* WORKER_POOL_H */
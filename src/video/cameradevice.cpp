@@ -70,6 +70,8 @@ QHash<QString, CameraDevice*> CameraDevice::openDevices;
 QMutex CameraDevice::openDeviceLock, CameraDevice::iformatLock;
 AVInputFormat* CameraDevice::iformat{nullptr};
 AVInputFormat* CameraDevice::idesktopFormat{nullptr};
+QHash<QString, QVector<VideoMode>> CameraDevice::modeCache;
+QMutex CameraDevice::modeCacheLock;
 
 CameraDevice::CameraDevice(const QString& devName, AVFormatContext* context)
     : devName{devName}
@@ -96,6 +98,9 @@ CameraDevice* CameraDevice::open(QString devName, AVDictionary** options)
     } else if (devName.startsWith("gdigrab#")) {
         devName = devName.mid(8);
         format = idesktopFormat;
+    } else if (devName.startsWith("pipewiregrab#")) {
+        devName = devName.mid(13);
+        format = idesktopFormat;
     } else {
         format = iformat;
     }
@@ -167,7 +172,13 @@ CameraDevice* CameraDevice::open(QString devName, VideoMode mode)
     if (!iformat)
         ;
 #if USING_V4L
-    else if (devName.startsWith("x11grab#")) {
+    else if (devName.startsWith("pipewiregrab#")) {
+        // The portal dialog picks the source and its size, we only ask for a
+        // rate; the grabber keeps the compositor's buffers mapped instead of
+        // copying every frame through the X server
+        av_dict_set(&options, "framerate", framerate.c_str(), 0);
+        av_dict_set_int(&options, "draw_mouse", 1, 0);
+    } else if (devName.startsWith("x11grab#")) {
         QSize screen;
         if (mode.width && mode.height) {
             screen.setWidth(mode.width);
@@ -377,6 +388,32 @@ QVector<QPair<QString, QString>> CameraDevice::getDeviceList()
             devices.push_back(QPair<QString, QString>{
                 "gdigrab#desktop",
                 QObject::tr("Desktop", "Desktop as a camera input for screen sharing")});
+        if (idesktopFormat->name == QString("pipewiregrab"))
+            devices.push_back(QPair<QString, QString>{
+                "pipewiregrab#desktop",
+                QObject::tr("Desktop", "Desktop as a camera input for screen sharing")});
+    }
+
+    // Re-enumeration is the only point where we learn about hotplug, so
+    // drop cached modes of devices that are gone; a re-plugged device may
+    // well come back with a different mode list.
+    {
+        QMutexLocker locker(&modeCacheLock);
+        for (auto it = modeCache.begin(); it != modeCache.end();) {
+            bool present = false;
+            for (const QPair<QString, QString>& device : devices) {
+                if (device.first == it.key()) {
+                    present = true;
+                    break;
+                }
+            }
+
+            if (present) {
+                ++it;
+            } else {
+                it = modeCache.erase(it);
+            }
+        }
     }
 
     return devices;
@@ -412,7 +449,8 @@ QString CameraDevice::getDefaultDeviceName()
  */
 bool CameraDevice::isScreen(const QString& devName)
 {
-    return devName.startsWith("x11grab") || devName.startsWith("gdigrab");
+    return devName.startsWith("x11grab") || devName.startsWith("gdigrab")
+           || devName.startsWith("pipewiregrab");
 }
 
 /**
@@ -441,29 +479,56 @@ QVector<VideoMode> CameraDevice::getScreenModes()
  * @brief Get the list of video modes for a device.
  * @param devName Device name to get nodes from.
  * @return Vector of available modes for the device.
+ *
+ * Screens are answered from the live screen geometry, everything else from
+ * the mode cache; only the first query per device actually probes hardware.
  */
 QVector<VideoMode> CameraDevice::getVideoModes(QString devName)
 {
-    Q_UNUSED(devName);
-
     if (!iformat)
-        ;
-    else if (isScreen(devName))
+        return {};
+
+    if (isScreen(devName))
         return getScreenModes();
+
+    {
+        QMutexLocker locker(&modeCacheLock);
+        const auto it = modeCache.constFind(devName);
+        if (it != modeCache.constEnd())
+            return *it;
+    }
+
+    // probe without holding the lock, a slow device would block the cache;
+    // a concurrent query for the same device just probes twice
+    QVector<VideoMode> modes = probeVideoModes(devName);
+
+    QMutexLocker locker(&modeCacheLock);
+    modeCache.insert(devName, modes);
+    return modes;
+}
+
+/**
+ * @brief Asks the platform backend for a device's modes.
+ * @param devName Device name to probe.
+ * @return Vector of available modes for the device.
+ */
+QVector<VideoMode> CameraDevice::probeVideoModes(const QString& devName)
+{
+    Q_UNUSED(devName);
+
 #ifdef Q_OS_WIN
-    else if (iformat->name == QString("dshow"))
+    if (iformat->name == QString("dshow"))
         return DirectShow::getDeviceModes(devName);
 #endif
 #if USING_V4L
-    else if (iformat->name == QString("video4linux2,v4l2"))
+    if (iformat->name == QString("video4linux2,v4l2"))
         return v4l2::getDeviceModes(devName);
 #endif
 #ifdef Q_OS_OSX
-    else if (iformat->name == QString("avfoundation"))
+    if (iformat->name == QString("avfoundation"))
         return avfoundation::getDeviceModes(devName);
 #endif
-    else
-        qWarning() << "Video mode listing not implemented for input " << iformat->name;
+    qWarning() << "Video mode listing not implemented for input " << iformat->name;
 
     return {};
 }
@@ -512,7 +577,13 @@ bool CameraDevice::getDefaultInputFormat()
 
 // Desktop capture input formats
 #if USING_V4L
-    idesktopFormat = av_find_input_format("x11grab");
+    // Prefer compositor capture through the desktop portal when the linked
+    // FFmpeg ships the PipeWire grabber (not all builds do); it shares the
+    // compositor's buffers instead of pulling full frames through the X
+    // server, and it's the only path that works on Wayland at all
+    idesktopFormat = av_find_input_format("pipewiregrab");
+    if (!idesktopFormat)
+        idesktopFormat = av_find_input_format("x11grab");
 #endif
 #ifdef Q_OS_WIN
     idesktopFormat = av_find_input_format("gdigrab");
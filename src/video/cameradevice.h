@@ -56,6 +56,7 @@ private:
     static bool getDefaultInputFormat();
     static QVector<QPair<QString, QString>> getRawDeviceListGeneric();
     static QVector<VideoMode> getScreenModes();
+    static QVector<VideoMode> probeVideoModes(const QString& devName);
 
 public:
     const QString devName;
@@ -66,6 +67,10 @@ private:
     static QHash<QString, CameraDevice*> openDevices;
     static QMutex openDeviceLock, iformatLock;
     static AVInputFormat *iformat, *idesktopFormat;
+    // probing a device for its modes is slow, so the result is kept per
+    // device until the device drops out of the enumerated list
+    static QHash<QString, QVector<VideoMode>> modeCache;
+    static QMutex modeCacheLock;
 };
 
 #endif // CAMERADEVICE_H
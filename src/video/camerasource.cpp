@@ -22,11 +22,17 @@ extern "C" {
 #include <libavdevice/avdevice.h>
 #include <libavformat/avformat.h>
 #include <libswscale/swscale.h>
+#if LIBAVCODEC_VERSION_INT >= 3747941
+#include <libavutil/hwcontext.h>
+#endif
 }
 #include "cameradevice.h"
 #include "camerasource.h"
 #include "videoframe.h"
 #include "src/persistence/settings.h"
+#include "src/util/workerpool.h"
+#include "src/util/memoryregistry.h"
+#include "src/util/tracepoints.h"
 #include <QDebug>
 #include <QReadLocker>
 #include <QWriteLocker>
@@ -105,7 +111,7 @@ CameraSource::CameraSource()
 {
     qRegisterMetaType<VideoMode>("VideoMode");
     deviceThread->setObjectName("Device thread");
-    deviceThread->start();
+    deviceThread->start(WorkerPool::threadPriority(WorkerPool::Priority::Realtime));
     moveToThread(deviceThread);
 
     subscriptions = 0;
@@ -115,6 +121,9 @@ CameraSource::CameraSource()
     av_register_all();
 #endif
     avdevice_register_all();
+
+    // the tracking maps are static, but this singleton outlives every frame
+    MemoryRegistry::registerSampler("video frames", &VideoFrame::trackingStats, this);
 }
 
 // clang-format on
@@ -154,9 +163,39 @@ void CameraSource::setupDefault()
     setupDevice(deviceName, mode);
 }
 
+namespace {
+/**
+ * @brief True when a requested mode would reproduce the stream the current
+ * mode already delivers, treating unset fields as wildcards.
+ *
+ * The settings preview asks for modes probed from the device, with the pixel
+ * format filled in, while setupDefault() builds its mode from the stored
+ * resolution and FPS alone. Comparing field-for-field calls those different
+ * and restarts the device between them, even though it would be reopened
+ * with the exact same parameters.
+ */
+bool modesCompatible(const VideoMode& requested, const VideoMode& current)
+{
+    if (requested.width != current.width || requested.height != current.height
+        || requested.x != current.x || requested.y != current.y) {
+        return false;
+    }
+
+    if (requested.FPS > 0.0f && current.FPS > 0.0f && !qFuzzyCompare(requested.FPS, current.FPS)) {
+        return false;
+    }
+
+    return requested.pixel_format == 0 || current.pixel_format == 0
+           || requested.pixel_format == current.pixel_format;
+}
+} // namespace
+
 /**
  * @brief Change the device and mode.
  * @note If a device is already open, the source will seamlessly switch to the new device.
+ * @note A request that matches the already-streaming device and mode (with
+ * unset mode fields counting as matches) reuses the live stream instead of
+ * cycling the device, so previewing the call's camera in the settings is free.
  */
 void CameraSource::setupDevice(const QString& DeviceName, const VideoMode& Mode)
 {
@@ -172,7 +211,25 @@ void CameraSource::setupDevice(const QString& DeviceName, const VideoMode& Mode)
         return;
     }
 
+    if (DeviceName == deviceName && device && modesCompatible(Mode, mode)) {
+        // The requested mode only differs in fields one side left unset, so a
+        // close/open cycle would hand back the same stream after a device
+        // re-init and a frame gap in any ongoing call. Keep the stream and
+        // merge the more specific field values into the current mode.
+        if (mode.pixel_format == 0) {
+            mode.pixel_format = Mode.pixel_format;
+        }
+        if (mode.FPS <= 0.0f) {
+            mode.FPS = Mode.FPS;
+        }
+        return;
+    }
+
     if (subscriptions) {
+        // A genuinely different mode needs the cycle: ffmpeg device demuxers
+        // take size, rate and format as open-time options, so there is no
+        // in-place format swap. Subscribers stay attached and the stream
+        // thread stays up across it, only the device itself reopens.
         // To force close, ignoring optimization
         int subs = subscriptions;
         subscriptions = 0;
@@ -183,6 +240,13 @@ void CameraSource::setupDevice(const QString& DeviceName, const VideoMode& Mode)
     deviceName = DeviceName;
     mode = Mode;
     _isNone = (deviceName == "none");
+    screenDevice = CameraDevice::isScreen(deviceName);
+    lastScreenFrameHash = 0;
+    unchangedScreenFrames = 0;
+    decimation = 1;
+    decimationCounter = 0;
+    windowFrames = 0;
+    windowDropped = 0;
 
     if (subscriptions && !_isNone) {
         openDevice();
@@ -196,6 +260,8 @@ bool CameraSource::isNone() const
 
 CameraSource::~CameraSource()
 {
+    MemoryRegistry::unregister(this);
+
     QWriteLocker locker{&streamMutex};
     QWriteLocker locker2{&deviceMutex};
 
@@ -209,6 +275,10 @@ CameraSource::~CameraSource()
     }
 
     // Free all remaining VideoFrame
+    {
+        QMutexLocker pendingLocker{&pendingFrameMutex};
+        pendingFrame.reset();
+    }
     VideoFrame::untrackFrames(id, true);
 
     if (cctx) {
@@ -252,6 +322,91 @@ void CameraSource::unsubscribe()
     }
 }
 
+#if LIBAVCODEC_VERSION_INT >= 3747941
+namespace {
+/**
+ * Tries the stateful V4L2 M2M variant of a decoder (e.g. mjpeg_v4l2m2m).
+ * These hand back ordinary software frames, so they are a drop-in
+ * replacement for the software codec.
+ * @return An opened codec context, or nullptr when unavailable.
+ */
+AVCodecContext* openV4l2m2mDecoder(const AVCodec* swCodec, AVCodecParameters* cparams)
+{
+    const QByteArray name = QByteArray(swCodec->name) + "_v4l2m2m";
+    AVCodec* hwCodec = avcodec_find_decoder_by_name(name.constData());
+    if (!hwCodec) {
+        return nullptr;
+    }
+
+    AVCodecContext* ctx = avcodec_alloc_context3(hwCodec);
+    if (!ctx) {
+        return nullptr;
+    }
+
+    if (avcodec_parameters_to_context(ctx, cparams) < 0
+        || avcodec_open2(ctx, hwCodec, nullptr) < 0) {
+        avcodec_free_context(&ctx);
+        return nullptr;
+    }
+
+    qDebug() << "Opened hardware decoder" << name;
+    return ctx;
+}
+
+AVPixelFormat pickVaapiFormat(AVCodecContext* ctx, const AVPixelFormat* formats)
+{
+    Q_UNUSED(ctx);
+    for (const AVPixelFormat* fmt = formats; *fmt != AV_PIX_FMT_NONE; ++fmt) {
+        if (*fmt == AV_PIX_FMT_VAAPI) {
+            return *fmt;
+        }
+    }
+    // the decoder can't produce VAAPI surfaces for this stream after all
+    return formats[0];
+}
+
+/**
+ * Tries hardware-accelerated decoding through a VAAPI device. Decoded
+ * surfaces live in GPU memory and are downloaded in the stream loop.
+ * @param[out] hwDevice Receives the device reference on success, for the
+ *             caller to release when the camera closes.
+ * @return An opened codec context, or nullptr when unavailable.
+ */
+AVCodecContext* openVaapiDecoder(AVCodec* codec, AVCodecParameters* cparams, AVBufferRef** hwDevice)
+{
+    AVBufferRef* device = nullptr;
+    if (av_hwdevice_ctx_create(&device, AV_HWDEVICE_TYPE_VAAPI, nullptr, nullptr, 0) < 0) {
+        return nullptr;
+    }
+
+    AVCodecContext* ctx = avcodec_alloc_context3(codec);
+    if (!ctx) {
+        av_buffer_unref(&device);
+        return nullptr;
+    }
+
+    if (avcodec_parameters_to_context(ctx, cparams) < 0) {
+        avcodec_free_context(&ctx);
+        av_buffer_unref(&device);
+        return nullptr;
+    }
+
+    ctx->hw_device_ctx = av_buffer_ref(device);
+    ctx->get_format = pickVaapiFormat;
+
+    if (avcodec_open2(ctx, codec, nullptr) < 0) {
+        avcodec_free_context(&ctx);
+        av_buffer_unref(&device);
+        return nullptr;
+    }
+
+    qDebug() << "Opened VAAPI decoder for" << codec->name;
+    *hwDevice = device;
+    return ctx;
+}
+} // namespace
+#endif
+
 /**
  * @brief Opens the video device and starts streaming.
  * @note Callers must own the biglock.
@@ -328,6 +483,11 @@ void CameraSource::openDevice()
         return;
     }
 
+    // Packets may only be dropped before the decoder when frames don't
+    // reference each other, see the decimation check in the stream loop
+    const AVCodecDescriptor* codecDesc = avcodec_descriptor_get(codecId);
+    intraOnlyStream = codecDesc && (codecDesc->props & AV_CODEC_PROP_INTRA_ONLY);
+
 
 #if LIBAVCODEC_VERSION_INT < 3747941
     // Copy context, since we apparently aren't allowed to use the original
@@ -349,6 +509,33 @@ void CameraSource::openDevice()
     }
 #endif
 
+#if LIBAVCODEC_VERSION_INT >= 3747941
+    // Prefer a hardware decoder when enabled in the settings; any failure
+    // along the way falls back to opening the software codec found above
+    bool hwDecoderOpened = false;
+    if (Settings::getInstance().getHardwareDecoding()) {
+        AVCodecContext* hwCtx = openV4l2m2mDecoder(codec, cparams);
+        if (!hwCtx) {
+            hwCtx = openVaapiDecoder(codec, cparams, &hwDeviceCtx);
+        }
+
+        if (hwCtx) {
+            avcodec_free_context(&cctx);
+            cctx = hwCtx;
+            hwDecoderOpened = true;
+        } else {
+            qDebug() << "No usable hardware decoder for" << codec->name
+                     << ", falling back to software decoding";
+        }
+    }
+
+    if (!hwDecoderOpened && avcodec_open2(cctx, codec, nullptr) < 0) {
+        qWarning() << "Can't open codec";
+        avcodec_free_context(&cctx);
+        emit openFailed();
+        return;
+    }
+#else
     // Open codec
     if (avcodec_open2(cctx, codec, nullptr) < 0) {
         qWarning() << "Can't open codec";
@@ -356,6 +543,7 @@ void CameraSource::openDevice()
         emit openFailed();
         return;
     }
+#endif
 
     if (streamFuture.isRunning())
         qDebug() << "The stream thread is already running! Keeping the current one open.";
@@ -388,11 +576,16 @@ void CameraSource::closeDevice()
     qDebug() << "Closing device" << deviceName << "subscriptions:" << subscriptions;
 
     // Free all remaining VideoFrame
+    {
+        QMutexLocker pendingLocker{&pendingFrameMutex};
+        pendingFrame.reset();
+    }
     VideoFrame::untrackFrames(id, true);
 
     // Free our resources and close the device
     videoStreamIndex = -1;
     avcodec_free_context(&cctx);
+    av_buffer_unref(&hwDeviceCtx);
 #if LIBAVCODEC_VERSION_INT < 3747941
     avcodec_close(cctxOrig);
     cctxOrig = nullptr;
@@ -414,6 +607,16 @@ void CameraSource::stream()
             return;
         }
 
+        // Under sustained consumer pressure pushFrame() raises decimation and
+        // only every decimation-th packet gets decoded; the rest are dropped
+        // right here, before any decode or conversion work is spent on them
+        const int curDecimation = decimation.load(std::memory_order_relaxed);
+        if (curDecimation > 1 && intraOnlyStream && packet.stream_index == videoStreamIndex
+            && ++decimationCounter % curDecimation != 0) {
+            av_packet_unref(&packet);
+            return;
+        }
+
 #if LIBAVCODEC_VERSION_INT < 3747941
         AVFrame* frame = av_frame_alloc();
         if (!frame) {
@@ -429,8 +632,13 @@ void CameraSource::stream()
                 return;
             }
 
+            if (screenDevice && !screenFrameChanged(frame)) {
+                av_frame_free(&frame);
+                return;
+            }
+
             VideoFrame* vframe = new VideoFrame(id, frame);
-            emit frameAvailable(vframe->trackFrame());
+            pushFrame(vframe->trackFrame());
         }
 #else
 
@@ -441,8 +649,26 @@ void CameraSource::stream()
         if (readyToRecive) {
             AVFrame* frame = av_frame_alloc();
             if (frame && !avcodec_receive_frame(cctx, frame)) {
-                VideoFrame* vframe = new VideoFrame(id, frame);
-                emit frameAvailable(vframe->trackFrame());
+                if (frame->format == AV_PIX_FMT_VAAPI) {
+                    // the surface lives in GPU memory, VideoFrame needs it here
+                    AVFrame* swFrame = av_frame_alloc();
+                    if (swFrame && av_hwframe_transfer_data(swFrame, frame, 0) == 0) {
+                        av_frame_free(&frame);
+                        frame = swFrame;
+                    } else {
+                        av_frame_free(&swFrame);
+                        av_frame_free(&frame);
+                    }
+                }
+
+                if (frame && screenDevice && !screenFrameChanged(frame)) {
+                    av_frame_free(&frame);
+                }
+
+                if (frame) {
+                    VideoFrame* vframe = new VideoFrame(id, frame);
+                    pushFrame(vframe->trackFrame());
+                }
             } else {
                 av_frame_free(&frame);
             }
@@ -464,3 +690,122 @@ void CameraSource::stream()
         streamLoop();
     }
 }
+
+/**
+ * @brief Cheap damage check for screen capture frames.
+ * @param frame The freshly grabbed frame.
+ * @return True when the frame should be delivered, false to skip it.
+ *
+ * The grabbers hand us the full screen at the configured rate whether or
+ * not a pixel changed, and every delivered frame costs a YUV conversion
+ * and a VP8 encode downstream. A sparse FNV-1a hash over the first plane
+ * recognizes the unchanged case, which dominates when sharing slides. One
+ * frame per interval goes through regardless, so damage a sampled row
+ * misses and receivers joining mid-share are bounded by the refresh.
+ */
+bool CameraSource::screenFrameChanged(const AVFrame* frame)
+{
+    // at typical screen share rates this refreshes roughly every 2s
+    constexpr uint32_t screenRefreshFrames = 60;
+
+    const int stride = frame->linesize[0];
+    const uint8_t* data = frame->data[0];
+    quint64 hash = 14695981039346656037ULL;
+    for (int y = 0; y < frame->height; y += 16) {
+        const uint8_t* row = data + static_cast<ptrdiff_t>(y) * stride;
+        for (int x = 0; x < stride; x += 8) {
+            hash ^= row[x];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    if (hash != lastScreenFrameHash) {
+        lastScreenFrameHash = hash;
+        unchangedScreenFrames = 0;
+        return true;
+    }
+
+    if (++unchangedScreenFrames >= screenRefreshFrames) {
+        unchangedScreenFrames = 0;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Hands a freshly decoded frame over to the delivery queue.
+ *
+ * The queue is one frame deep with a latest-frame-wins policy: if the
+ * subscribers haven't consumed the previous frame yet, it is dropped and
+ * replaced by this one, so slow consumers only ever see the most recent
+ * image instead of video drifting progressively behind real time.
+ *
+ * Drops also feed the load controller: a window with a quarter or more of
+ * its frames dropped halves the decode rate via decimation, and a clean
+ * window raises it again one step at a time, so capture CPU tracks the
+ * rate consumers actually sustain rather than the configured mode.
+ */
+void CameraSource::pushFrame(std::shared_ptr<VideoFrame> frame)
+{
+    QTOX_TRACE2(camera_frame, frame->getSourceDimensions().width(),
+                frame->getSourceDimensions().height());
+
+    // raising the decimation one window too late is fine, collapsing the
+    // rate on a single dropped frame is not
+    constexpr uint32_t pressureWindow = 32;
+    constexpr int maxDecimation = 8;
+
+    {
+        QMutexLocker locker{&pendingFrameMutex};
+        if (pendingFrame) {
+            ++windowDropped;
+            const quint64 dropped = ++droppedFrames;
+            if (dropped % 128 == 0) {
+                qDebug() << "Dropped" << dropped << "frames so far, consumers can't keep up";
+            }
+        }
+
+        pendingFrame = std::move(frame);
+
+        if (++windowFrames >= pressureWindow) {
+            const int current = decimation.load(std::memory_order_relaxed);
+            if (windowDropped * 4 >= windowFrames && current < maxDecimation) {
+                decimation.store(current * 2, std::memory_order_relaxed);
+                qDebug() << "Consumers under pressure, decoding every" << current * 2 << "th frame";
+            } else if (windowDropped == 0 && current > 1) {
+                decimation.store(current / 2, std::memory_order_relaxed);
+            }
+            windowFrames = 0;
+            windowDropped = 0;
+        }
+    }
+
+    bool expected = false;
+    if (deliveryQueued.compare_exchange_strong(expected, true)) {
+        QMetaObject::invokeMethod(this, "deliverFrame", Qt::QueuedConnection);
+    }
+}
+
+/**
+ * @brief Emits the most recent decoded frame to the subscribers.
+ * @note Runs on the device thread, so the decode thread never blocks on
+ * consumers; frames decoded in the meantime overwrite the pending slot.
+ */
+void CameraSource::deliverFrame()
+{
+    // cleared before taking the frame, so a frame pushed while we emit
+    // schedules another delivery rather than getting stuck in the slot
+    deliveryQueued = false;
+
+    std::shared_ptr<VideoFrame> frame;
+    {
+        QMutexLocker locker{&pendingFrameMutex};
+        frame = std::move(pendingFrame);
+        pendingFrame.reset();
+    }
+
+    if (frame) {
+        emit frameAvailable(frame);
+    }
+}
@@ -24,13 +24,17 @@
 #include "src/video/videosource.h"
 #include <QFuture>
 #include <QHash>
+#include <QMutex>
 #include <QReadWriteLock>
 #include <QString>
 #include <QVector>
 #include <atomic>
+#include <memory>
 
 class CameraDevice;
+struct AVBufferRef;
 struct AVCodecContext;
+struct AVFrame;
 
 class CameraSource : public VideoSource
 {
@@ -57,10 +61,13 @@ private:
     CameraSource();
     ~CameraSource();
     void stream();
+    void pushFrame(std::shared_ptr<VideoFrame> frame);
+    bool screenFrameChanged(const AVFrame* frame);
 
 private slots:
     void openDevice();
     void closeDevice();
+    void deliverFrame();
 
 private:
     QFuture<void> streamFuture;
@@ -72,11 +79,40 @@ private:
     AVCodecContext* cctx;
     // TODO: Remove when ffmpeg version will be bumped to the 3.1.0
     AVCodecContext* cctxOrig;
+    // Hardware decode device (VAAPI), or nullptr when decoding in software
+    AVBufferRef* hwDeviceCtx = nullptr;
     int videoStreamIndex;
 
     QReadWriteLock deviceMutex;
     QReadWriteLock streamMutex;
 
+    // One-deep delivery queue between the decode thread and the subscribers;
+    // a frame decoded before the previous one was delivered replaces it, so
+    // slow consumers see the latest image instead of an ever-growing backlog
+    QMutex pendingFrameMutex;
+    std::shared_ptr<VideoFrame> pendingFrame;
+    std::atomic_bool deliveryQueued{false};
+    std::atomic<quint64> droppedFrames{0};
+
+    // Load feedback: when consumers drop a sustained share of the delivered
+    // frames, the stream thread decodes only every decimation-th packet so
+    // decode/convert CPU tracks what actually gets through. Raised and
+    // lowered in pushFrame() under pendingFrameMutex, read lock-free by the
+    // stream thread. Only safe on intra-only streams (no inter prediction).
+    std::atomic_int decimation{1};
+    bool intraOnlyStream = false;
+    uint32_t decimationCounter = 0;
+    uint32_t windowFrames = 0;
+    uint32_t windowDropped = 0;
+
+    // Damage detection for screen capture: the grabber redelivers the full
+    // screen every frame, so unchanged frames are recognized by a sparse
+    // content hash and skipped instead of being converted and encoded.
+    // Touched from the stream thread, reset in setupDevice between streams.
+    bool screenDevice = false;
+    quint64 lastScreenFrameHash = 0;
+    uint32_t unchangedScreenFrames = 0;
+
     std::atomic_bool _isNone;
     std::atomic_int subscriptions;
 
@@ -25,6 +25,8 @@ extern "C" {
 #include "corevideosource.h"
 #include "videoframe.h"
 
+#include <QDebug>
+
 /**
  * @class CoreVideoSource
  * @brief A VideoSource that emits frames received by Core.
@@ -99,7 +101,45 @@ void CoreVideoSource::pushFrame(const vpx_image_t* vpxframe)
     }
 
     vframe = std::make_shared<VideoFrame>(id, avframe, true);
-    emit frameAvailable(vframe);
+
+    {
+        QMutexLocker pendingLocker(&pendingFrameMutex);
+        if (pendingFrame) {
+            // the previous frame was never taken, show the fresher one instead
+            const quint64 lagged = laggedFrames.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (lagged % 128 == 0) {
+                qDebug() << "Subscribers lag behind received video," << lagged
+                         << "frames replaced so far";
+            }
+        }
+        pendingFrame = std::move(vframe);
+    }
+
+    bool expected = false;
+    if (deliveryQueued.compare_exchange_strong(expected, true)) {
+        QMetaObject::invokeMethod(this, "deliverFrame", Qt::QueuedConnection);
+    }
+}
+
+/**
+ * @brief Emits the most recently pushed frame to the subscribers.
+ *
+ * Runs on this source's own thread. The flag is cleared before the slot is
+ * emptied, so a frame pushed while we emit queues another delivery.
+ */
+void CoreVideoSource::deliverFrame()
+{
+    deliveryQueued.store(false);
+
+    std::shared_ptr<VideoFrame> frame;
+    {
+        QMutexLocker locker(&pendingFrameMutex);
+        frame = std::move(pendingFrame);
+    }
+
+    if (frame) {
+        emit frameAvailable(frame);
+    }
 }
 
 void CoreVideoSource::subscribe()
@@ -142,6 +182,10 @@ void CoreVideoSource::stopSource()
 {
     QMutexLocker locker(&biglock);
     stopped = true;
+    {
+        QMutexLocker pendingLocker(&pendingFrameMutex);
+        pendingFrame.reset();
+    }
     emit sourceStopped();
 }
 
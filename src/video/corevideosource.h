@@ -24,8 +24,11 @@
 #include "videosource.h"
 #include <QMutex>
 #include <atomic>
+#include <memory>
 #include <vpx/vpx_image.h>
 
+class VideoFrame;
+
 class CoreVideoSource : public VideoSource
 {
     Q_OBJECT
@@ -34,6 +37,9 @@ public:
     virtual void subscribe() override;
     virtual void unsubscribe() override;
 
+private slots:
+    void deliverFrame();
+
 private:
     CoreVideoSource();
 
@@ -49,6 +55,14 @@ private:
     QMutex biglock;
     std::atomic_bool stopped;
 
+    // single-slot mailbox between the toxav receive callback and the
+    // subscribers; a frame that hasn't been taken yet is replaced by the
+    // next one, so received video can't drift behind delivery
+    QMutex pendingFrameMutex;
+    std::shared_ptr<VideoFrame> pendingFrame;
+    std::atomic_bool deliveryQueued{false};
+    std::atomic<quint64> laggedFrames{0};
+
     friend class CoreAV;
     friend class ToxFriendCall;
 };
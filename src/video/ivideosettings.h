@@ -42,11 +42,16 @@ public:
     virtual float getCamVideoFPS() const = 0;
     virtual void setCamVideoFPS(float newValue) = 0;
 
+    // decode camera streams in hardware (V4L2 M2M or VAAPI) when available
+    virtual bool getHardwareDecoding() const = 0;
+    virtual void setHardwareDecoding(bool enabled) = 0;
+
     DECLARE_SIGNAL(videoDevChanged, const QString& device);
     DECLARE_SIGNAL(screenRegionChanged, const QRect& region);
     DECLARE_SIGNAL(screenGrabbedChanged, bool enabled);
     DECLARE_SIGNAL(camVideoResChanged, const QRect& region);
     DECLARE_SIGNAL(camVideoFPSChanged, unsigned short fps);
+    DECLARE_SIGNAL(hardwareDecodingChanged, bool enabled);
 };
 
 #endif // I_VIDEO_SETTINGS_H
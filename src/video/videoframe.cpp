@@ -19,11 +19,21 @@
 
 #include "videoframe.h"
 
+#include "src/util/memoryregistry.h"
+
 extern "C" {
 #include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
 #include <libswscale/swscale.h>
 }
 
+#include <QElapsedTimer>
+#include <QFutureSynchronizer>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <vector>
+
 /**
  * @struct ToxYUVFrame
  * @brief A simple structure to represent a ToxYUV video frame (corresponds to a frame encoded
@@ -72,14 +82,278 @@ extern "C" {
  * value for a std::unordered_map.
  */
 
+namespace {
+/**
+ * Pool of reusable swscale contexts, shared across all VideoFrame instances.
+ *
+ * Setting up a scaler costs far more than the scale itself at call rates of
+ * one conversion per camera or network frame, so contexts are kept and reused
+ * instead of being rebuilt around every sws_scale call. A context can't be
+ * used concurrently, so acquire hands out exclusive ownership and release
+ * returns it; the pool is keyed on the full conversion tuple, since a
+ * FrameBufferKey only describes one side of a conversion.
+ */
+struct SwsPoolKey
+{
+    int srcWidth;
+    int srcHeight;
+    int srcPixFmt;
+    int dstWidth;
+    int dstHeight;
+    int dstPixFmt;
+    int resizeAlgo;
+
+    bool operator==(const SwsPoolKey& other) const
+    {
+        return srcWidth == other.srcWidth && srcHeight == other.srcHeight
+               && srcPixFmt == other.srcPixFmt && dstWidth == other.dstWidth
+               && dstHeight == other.dstHeight && dstPixFmt == other.dstPixFmt
+               && resizeAlgo == other.resizeAlgo;
+    }
+};
+
+struct SwsPoolEntry
+{
+    SwsPoolKey key;
+    SwsContext* context;
+};
+
+// a handful of resolutions are live at any time (camera, self preview, one
+// per peer); the pool is scanned linearly, so keep it small
+constexpr size_t swsPoolMaxSize = 8;
+
+QMutex swsPoolMutex;
+std::vector<SwsPoolEntry> swsPool;
+
+SwsContext* acquireSwsContext(const SwsPoolKey& key)
+{
+    {
+        QMutexLocker locker{&swsPoolMutex};
+        for (auto it = swsPool.begin(); it != swsPool.end(); ++it) {
+            if (it->key == key) {
+                SwsContext* context = it->context;
+                swsPool.erase(it);
+                return context;
+            }
+        }
+    }
+
+    return sws_getContext(key.srcWidth, key.srcHeight, static_cast<AVPixelFormat>(key.srcPixFmt),
+                          key.dstWidth, key.dstHeight, static_cast<AVPixelFormat>(key.dstPixFmt),
+                          key.resizeAlgo, nullptr, nullptr, nullptr);
+}
+
+void releaseSwsContext(const SwsPoolKey& key, SwsContext* context)
+{
+    {
+        QMutexLocker locker{&swsPoolMutex};
+        if (swsPool.size() < swsPoolMaxSize) {
+            swsPool.push_back({key, context});
+            return;
+        }
+    }
+
+    sws_freeContext(context);
+}
+
+/**
+ * Recycled storage for converted frames, shared across all VideoFrame
+ * instances.
+ *
+ * During a call every conversion allocated and freed a full frame's worth of
+ * aligned memory, a steady multi-MB/s churn through the allocator. Freed
+ * buffers are instead parked here and handed back out to the next conversion
+ * of the same size; at any time only a few distinct sizes are live (one per
+ * stream and target format), so exact-size buckets suffice. av_malloc is kept
+ * as the underlying allocator, so buffers satisfy dataAlignment just like the
+ * av_image_alloc ones they replace.
+ */
+struct FrameBufferPoolEntry
+{
+    int size;
+    uint8_t* data;
+};
+
+constexpr size_t bufferPoolMaxEntries = 16;
+
+QMutex bufferPoolMutex;
+std::vector<FrameBufferPoolEntry> bufferPool;
+// sizes of pool-owned buffers currently handed out, so the free path can
+// tell them apart from buffers the decoder allocated
+std::unordered_map<void*, int> pooledBufferSizes;
+
+uint8_t* acquireFrameBuffer(int size)
+{
+    {
+        QMutexLocker locker{&bufferPoolMutex};
+        for (auto it = bufferPool.begin(); it != bufferPool.end(); ++it) {
+            if (it->size == size) {
+                uint8_t* data = it->data;
+                bufferPool.erase(it);
+                pooledBufferSizes[data] = size;
+                return data;
+            }
+        }
+    }
+
+    uint8_t* data = static_cast<uint8_t*>(av_malloc(size));
+    if (data) {
+        QMutexLocker locker{&bufferPoolMutex};
+        pooledBufferSizes[data] = size;
+    }
+    return data;
+}
+
+bool releaseFrameBuffer(uint8_t* data)
+{
+    QMutexLocker locker{&bufferPoolMutex};
+    const auto it = pooledBufferSizes.find(data);
+    if (it == pooledBufferSizes.end()) {
+        return false;
+    }
+
+    const int size = it->second;
+    pooledBufferSizes.erase(it);
+    if (bufferPool.size() < bufferPoolMaxEntries) {
+        bufferPool.push_back({size, data});
+    } else {
+        av_free(data);
+    }
+    return true;
+}
+
+/**
+ * Returns a frame's storage to the pool, or frees it outright when it didn't
+ * come from the pool (source frames are allocated by the decoder).
+ */
+void freeFrameStorage(AVFrame* frame)
+{
+    if (releaseFrameBuffer(frame->data[0])) {
+        frame->data[0] = nullptr;
+    } else {
+        av_freep(&frame->data[0]);
+    }
+}
+
+/**
+ * Offsets each populated plane pointer of a frame down to the given row,
+ * honouring per-plane chroma subsampling, so a scaler can be fed one
+ * horizontal slice of the image.
+ */
+void offsetSlicePlanes(const AVFrame* frame, int pixFmt, int row, const uint8_t* slice[4])
+{
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(pixFmt));
+    for (int plane = 0; plane < 4; ++plane) {
+        if (!frame->data[plane]) {
+            slice[plane] = nullptr;
+            continue;
+        }
+        const int shift = (plane == 1 || plane == 2) ? desc->log2_chroma_h : 0;
+        slice[plane] = frame->data[plane] + (row >> shift) * frame->linesize[plane];
+    }
+}
+
+// per-resolution conversion timings, surfaced through the log so sliced
+// scaling can be verified to spread across cores in the field
+struct ScaleTimingEntry
+{
+    int width;
+    int height;
+    int slices;
+    quint64 count;
+    quint64 totalNsecs;
+};
+
+QMutex scaleTimingMutex;
+std::vector<ScaleTimingEntry> scaleTimings;
+
+void recordScaleTiming(const QSize& dimensions, qint64 nsecs, int slices)
+{
+    QMutexLocker locker{&scaleTimingMutex};
+    for (ScaleTimingEntry& entry : scaleTimings) {
+        if (entry.width == dimensions.width() && entry.height == dimensions.height()
+            && entry.slices == slices) {
+            ++entry.count;
+            entry.totalNsecs += static_cast<quint64>(nsecs);
+            // roughly twice a minute at 30fps
+            if (entry.count % 1024 == 0) {
+                qDebug() << "VideoFrame: scaling to" << entry.width << "x" << entry.height << "in"
+                         << entry.slices << "slice(s), avg"
+                         << entry.totalNsecs / entry.count / 1000 << "us over" << entry.count
+                         << "frames";
+            }
+            return;
+        }
+    }
+    scaleTimings.push_back({dimensions.width(), dimensions.height(), slices, 1,
+                            static_cast<quint64>(nsecs)});
+}
+
+/**
+ * @brief Maps an AVPixelFormat to the QImage format with the same memory layout.
+ * @return the matching QImage format, or QImage::Format_Invalid when the pixel
+ * data cannot be wrapped in a QImage without conversion.
+ */
+QImage::Format toQImageFormat(const int pixelFormat)
+{
+    // The packed 32-bit aliases resolve to the host's endianness, matching
+    // QImage's native-endian 32-bit formats on either architecture
+    switch (pixelFormat) {
+    case AV_PIX_FMT_RGB24:
+        return QImage::Format_RGB888;
+    case AV_PIX_FMT_RGB32:
+        return QImage::Format_ARGB32;
+    case AV_PIX_FMT_0RGB32:
+        return QImage::Format_RGB32;
+    default:
+        return QImage::Format_Invalid;
+    }
+}
+} // namespace
+
 // Initialize static fields
 VideoFrame::AtomicIDType VideoFrame::frameIDs{0};
 
-std::unordered_map<VideoFrame::IDType, QMutex> VideoFrame::mutexMap{};
-std::unordered_map<VideoFrame::IDType, std::unordered_map<VideoFrame::IDType, std::weak_ptr<VideoFrame>>>
-    VideoFrame::refsMap{};
+std::unordered_map<VideoFrame::IDType, std::shared_ptr<VideoFrame::SourceTracker>>
+    VideoFrame::trackerRegistry{};
 
-QReadWriteLock VideoFrame::refsLock{};
+QReadWriteLock VideoFrame::registryLock{};
+
+/**
+ * @brief Fetches the reference tracker for a source, creating it on first use.
+ *
+ * Frames resolve their tracker once at construction and share ownership of it,
+ * so the registry lock is never taken again on the tracking hot path. A frame
+ * outliving untrackFrames() keeps its detached tracker alive; dropping its
+ * reference from a detached tracker is harmless.
+ *
+ * @param sourceID the ID of the VideoSource to fetch the tracker for.
+ * @return the source's tracker, never null.
+ */
+std::shared_ptr<VideoFrame::SourceTracker> VideoFrame::trackerForSource(IDType sourceID)
+{
+    registryLock.lockForRead();
+
+    auto it = trackerRegistry.find(sourceID);
+    if (it != trackerRegistry.end()) {
+        std::shared_ptr<SourceTracker> ret = it->second;
+        registryLock.unlock();
+        return ret;
+    }
+
+    // We need to add a new source to our registry, obtain write lock
+    registryLock.unlock();
+    registryLock.lockForWrite();
+
+    std::shared_ptr<SourceTracker>& tracker = trackerRegistry[sourceID];
+    if (!tracker) {
+        tracker = std::make_shared<SourceTracker>();
+    }
+
+    std::shared_ptr<SourceTracker> ret = tracker;
+    registryLock.unlock();
+    return ret;
+}
 
 /**
  * @brief Constructs a new instance of a VideoFrame, sourced by a given AVFrame pointer.
@@ -94,6 +368,7 @@ VideoFrame::VideoFrame(IDType sourceID, AVFrame* sourceFrame, QRect dimensions,
                        bool freeSourceFrame)
     : frameID(frameIDs++)
     , sourceID(sourceID)
+    , sourceTracker(trackerForSource(sourceID))
     , sourceDimensions(dimensions)
     , sourceFrameKey(getFrameKey(dimensions.size(), pixFmt, sourceFrame->linesize[0]))
     , freeSourceFrame(freeSourceFrame)
@@ -159,17 +434,9 @@ VideoFrame::~VideoFrame()
     frameLock.unlock();
 
     // Delete tracked reference
-    refsLock.lockForRead();
-
-    if (refsMap.count(sourceID) > 0) {
-        QMutex& sourceMutex = mutexMap[sourceID];
-
-        sourceMutex.lock();
-        refsMap[sourceID].erase(frameID);
-        sourceMutex.unlock();
-    }
-
-    refsLock.unlock();
+    sourceTracker->mutex.lock();
+    sourceTracker->refs.erase(frameID);
+    sourceTracker->mutex.unlock();
 }
 
 /**
@@ -199,25 +466,12 @@ bool VideoFrame::isValid()
  */
 std::shared_ptr<VideoFrame> VideoFrame::trackFrame()
 {
-    // Add frame to tracked reference list
-    refsLock.lockForRead();
-
-    if (refsMap.count(sourceID) == 0) {
-        // We need to add a new source to our reference map, obtain write lock
-        refsLock.unlock();
-        refsLock.lockForWrite();
-    }
-
-    QMutex& sourceMutex = mutexMap[sourceID];
-
-    sourceMutex.lock();
-
+    // Add frame to the source's tracked reference list
     std::shared_ptr<VideoFrame> ret{this};
 
-    refsMap[sourceID][frameID] = ret;
-
-    sourceMutex.unlock();
-    refsLock.unlock();
+    sourceTracker->mutex.lock();
+    sourceTracker->refs[frameID] = ret;
+    sourceTracker->mutex.unlock();
 
     return ret;
 }
@@ -235,37 +489,93 @@ std::shared_ptr<VideoFrame> VideoFrame::trackFrame()
  */
 void VideoFrame::untrackFrames(const VideoFrame::IDType& sourceID, bool releaseFrames)
 {
-    refsLock.lockForWrite();
+    // Detach the source's tracker from the registry first; the registry lock
+    // is held only for the map erase, so frames of other sources are never
+    // stalled by this teardown
+    registryLock.lockForWrite();
 
-    if (refsMap.count(sourceID) == 0) {
+    auto it = trackerRegistry.find(sourceID);
+    if (it == trackerRegistry.end()) {
         // No tracking reference exists for source, simply return
-        refsLock.unlock();
+        registryLock.unlock();
 
         return;
     }
 
-    if (releaseFrames) {
-        QMutex& sourceMutex = mutexMap[sourceID];
+    std::shared_ptr<SourceTracker> tracker = std::move(it->second);
+    trackerRegistry.erase(it);
 
-        sourceMutex.lock();
+    registryLock.unlock();
 
-        for (auto& frameIterator : refsMap[sourceID]) {
-            std::shared_ptr<VideoFrame> frame = frameIterator.second.lock();
+    // Pin the remaining frames before clearing the map, and release them with
+    // no lock held: a frame whose last reference dies here would re-enter the
+    // tracker mutex from its destructor
+    std::vector<std::shared_ptr<VideoFrame>> liveFrames;
 
+    tracker->mutex.lock();
+
+    for (auto& frameIterator : tracker->refs) {
+        std::shared_ptr<VideoFrame> frame = frameIterator.second.lock();
+
+        if (frame) {
+            liveFrames.push_back(std::move(frame));
+        }
+    }
+
+    tracker->refs.clear();
+
+    tracker->mutex.unlock();
+
+    if (releaseFrames) {
+        for (const std::shared_ptr<VideoFrame>& frame : liveFrames) {
+            frame->releaseFrame();
+        }
+    }
+}
+
+/**
+ * @brief One-line summary of the frame tracking maps, for the memory registry.
+ *
+ * The byte figure is an upper-bound estimate from the source dimensions; a
+ * frame may hold several converted buffers, each at most RGB32-sized.
+ */
+QString VideoFrame::trackingStats()
+{
+    // Keeps the sampled frames alive until all locks are dropped, see
+    // untrackFrames() for the re-entrancy hazard
+    std::vector<std::shared_ptr<VideoFrame>> liveFrames;
+
+    registryLock.lockForRead();
+
+    const size_t sources = trackerRegistry.size();
+    size_t refs = 0;
+    size_t alive = 0;
+    quint64 bytes = 0;
+    for (auto& sourceIterator : trackerRegistry) {
+        SourceTracker& tracker = *sourceIterator.second;
+        tracker.mutex.lock();
+        for (auto& frameIterator : tracker.refs) {
+            ++refs;
+            std::shared_ptr<VideoFrame> frame = frameIterator.second.lock();
             if (frame) {
-                frame->releaseFrame();
+                ++alive;
+                const QRect dimensions = frame->getSourceDimensions();
+                bytes += static_cast<quint64>(dimensions.width()) * dimensions.height() * 4;
+                liveFrames.push_back(std::move(frame));
             }
         }
-
-        sourceMutex.unlock();
+        tracker.mutex.unlock();
     }
 
-    refsMap[sourceID].clear();
+    registryLock.unlock();
 
-    mutexMap.erase(sourceID);
-    refsMap.erase(sourceID);
+    liveFrames.clear();
 
-    refsLock.unlock();
+    return QString("%1 live frames of %2 tracked (%3 sources), ~%4")
+        .arg(alive)
+        .arg(refs)
+        .arg(sources)
+        .arg(MemoryRegistry::formatBytes(bytes));
 }
 
 /**
@@ -315,7 +625,8 @@ const AVFrame* VideoFrame::getAVFrame(QSize frameSize, const int pixelFormat, co
  * @brief Converts this VideoFrame to a QImage that shares this VideoFrame's buffer.
  *
  * The VideoFrame will be scaled into the RGB24 pixel format along with the given
- * dimension.
+ * dimension, unless the source is already in a QImage-compatible RGB format at
+ * the requested size, in which case its buffer is wrapped without conversion.
  *
  * @param frameSize the given frame size of QImage to generate. Defaults to source frame size if
  * frameSize is invalid.
@@ -328,6 +639,21 @@ QImage VideoFrame::toQImage(QSize frameSize)
         frameSize = sourceDimensions.size();
     }
 
+    // Zero-copy path: when the source buffer already has a QImage-compatible
+    // RGB layout at the requested size (typical for screen capture), wrap it
+    // directly instead of running a full-frame conversion per paint
+    if (frameSize == sourceDimensions.size()) {
+        const QImage::Format imageFormat = toQImageFormat(sourcePixelFormat);
+
+        if (imageFormat != QImage::Format_Invalid) {
+            QImage wrapped = wrapSourceFrame(frameSize, imageFormat);
+
+            if (!wrapped.isNull()) {
+                return wrapped;
+            }
+        }
+    }
+
     // Converter function (constructs QImage out of AVFrame*)
     const std::function<QImage(AVFrame * const)> converter = [&](AVFrame* const frame) {
         return QImage{*(frame->data), frameSize.width(), frameSize.height(), *(frame->linesize),
@@ -338,6 +664,64 @@ QImage VideoFrame::toQImage(QSize frameSize)
     return toGenericObject(frameSize, AV_PIX_FMT_RGB24, false, converter, QImage{});
 }
 
+/**
+ * @brief Wraps the source frame's buffer in a QImage without copy or conversion.
+ *
+ * Only callable when the source pixel format has a QImage-compatible memory
+ * layout. The returned QImage holds a reference to this VideoFrame through the
+ * tracked-frames machinery, keeping the buffer alive for the image's lifetime
+ * even after all other references are dropped.
+ *
+ * @param frameSize dimensions of the image, must equal the source dimensions.
+ * @param format the QImage format matching the source pixel format.
+ * @return the wrapping QImage, or a null image if this VideoFrame is no longer
+ * valid or is not tracked (untracked frames have externally managed lifetimes,
+ * so wrapping them could leave the image with a dangling buffer).
+ */
+QImage VideoFrame::wrapSourceFrame(const QSize& frameSize, const QImage::Format format)
+{
+    // Obtain the shared reference maintained by trackFrame(); calling
+    // trackFrame() again would create a second owner of this object
+    std::shared_ptr<VideoFrame> ref;
+
+    sourceTracker->mutex.lock();
+
+    const auto refIt = sourceTracker->refs.find(frameID);
+    if (refIt != sourceTracker->refs.end()) {
+        ref = refIt->second.lock();
+    }
+
+    sourceTracker->mutex.unlock();
+
+    if (!ref) {
+        return QImage{};
+    }
+
+    frameLock.lockForRead();
+
+    if (frameBuffer.count(sourceFrameKey) == 0) {
+        frameLock.unlock();
+        return QImage{};
+    }
+
+    AVFrame* frame = frameBuffer[sourceFrameKey];
+
+    // The cleanup function releases the reference once the last copy of the
+    // QImage is destroyed
+    auto holder = new std::shared_ptr<VideoFrame>(std::move(ref));
+    QImage ret{*(frame->data),
+               frameSize.width(),
+               frameSize.height(),
+               *(frame->linesize),
+               format,
+               [](void* frameRef) { delete static_cast<std::shared_ptr<VideoFrame>*>(frameRef); },
+               holder};
+
+    frameLock.unlock();
+
+    return ret;
+}
+
 /**
  * @brief Converts this VideoFrame to a ToxAVFrame that shares this VideoFrame's buffer.
  *
@@ -573,19 +957,28 @@ AVFrame* VideoFrame::generateAVFrame(const QSize& dimensions, const int pixelFor
      * or if the caller doesn't require frame alignment
      */
 
-    int bufSize;
-
     const bool alreadyAligned = dimensions.width() % dataAlignment == 0 && dimensions.height() % dataAlignment == 0;
+    const int align = (!requireAligned || alreadyAligned) ? dataAlignment : 1;
 
-    if (!requireAligned || alreadyAligned) {
-        bufSize = av_image_alloc(ret->data, ret->linesize, dimensions.width(), dimensions.height(),
-                                 static_cast<AVPixelFormat>(pixelFormat), dataAlignment);
-    } else {
-        bufSize = av_image_alloc(ret->data, ret->linesize, dimensions.width(), dimensions.height(),
-                                 static_cast<AVPixelFormat>(pixelFormat), 1);
+    // storage comes from the shared pool instead of a fresh av_image_alloc,
+    // with identical layout and alignment semantics
+    const int bufSize = av_image_get_buffer_size(static_cast<AVPixelFormat>(pixelFormat),
+                                                 dimensions.width(), dimensions.height(), align);
+    if (bufSize < 0) {
+        av_frame_free(&ret);
+        return nullptr;
     }
 
-    if (bufSize < 0) {
+    uint8_t* buffer = acquireFrameBuffer(bufSize);
+    if (!buffer) {
+        av_frame_free(&ret);
+        return nullptr;
+    }
+
+    if (av_image_fill_arrays(ret->data, ret->linesize, buffer, static_cast<AVPixelFormat>(pixelFormat),
+                             dimensions.width(), dimensions.height(), align)
+        < 0) {
+        releaseFrameBuffer(buffer);
         av_frame_free(&ret);
         return nullptr;
     }
@@ -593,14 +986,14 @@ AVFrame* VideoFrame::generateAVFrame(const QSize& dimensions, const int pixelFor
     // Bilinear is better for shrinking, bicubic better for upscaling
     int resizeAlgo = sourceDimensions.width() > dimensions.width() ? SWS_BILINEAR : SWS_BICUBIC;
 
-    SwsContext* swsCtx =
-        sws_getContext(sourceDimensions.width(), sourceDimensions.height(),
-                       static_cast<AVPixelFormat>(sourcePixelFormat), dimensions.width(),
-                       dimensions.height(), static_cast<AVPixelFormat>(pixelFormat), resizeAlgo,
-                       nullptr, nullptr, nullptr);
+    const SwsPoolKey swsKey{sourceDimensions.width(), sourceDimensions.height(),
+                            sourcePixelFormat,        dimensions.width(),
+                            dimensions.height(),      pixelFormat,
+                            resizeAlgo};
+    SwsContext* swsCtx = acquireSwsContext(swsKey);
 
     if (!swsCtx) {
-        av_freep(&ret->data[0]);
+        freeFrameStorage(ret);
 #if LIBAVCODEC_VERSION_INT < 3747941
         av_frame_unref(ret);
 #endif
@@ -610,9 +1003,65 @@ AVFrame* VideoFrame::generateAVFrame(const QSize& dimensions, const int pixelFor
 
     AVFrame* source = frameBuffer[sourceFrameKey];
 
-    sws_scale(swsCtx, source->data, source->linesize, 0, sourceDimensions.height(), ret->data,
-              ret->linesize);
-    sws_freeContext(swsCtx);
+    QElapsedTimer scaleTimer;
+    scaleTimer.start();
+
+    /*
+     * Tall frames (1080p screen shares) take long enough to convert that they
+     * back up the capture thread. When no vertical rescale is involved the
+     * frame is cut into horizontal slices converted in parallel, each slice
+     * with its own exclusive scaler context; slice edges stay on 16-row
+     * boundaries so subsampled chroma planes split cleanly. Vertical rescales
+     * filter across slice boundaries and stay single-threaded.
+     */
+    bool sliced = false;
+    const int maxSlices = qMin(4, QThread::idealThreadCount());
+    const int sliceHeight = maxSlices > 1 ? (sourceDimensions.height() / maxSlices) & ~15 : 0;
+    if (sourceDimensions.height() == dimensions.height() && sourceDimensions.height() >= 720
+        && sliceHeight >= 64) {
+        std::vector<SwsContext*> sliceContexts(maxSlices - 1);
+        bool contextsReady = true;
+        for (SwsContext*& context : sliceContexts) {
+            context = acquireSwsContext(swsKey);
+            contextsReady = contextsReady && context != nullptr;
+        }
+
+        if (contextsReady) {
+            QFutureSynchronizer<void> synchronizer;
+            for (int i = 1; i < maxSlices; ++i) {
+                const int sliceRow = i * sliceHeight;
+                const int sliceRows =
+                    i == maxSlices - 1 ? sourceDimensions.height() - sliceRow : sliceHeight;
+                SwsContext* sliceContext = sliceContexts[i - 1];
+                synchronizer.addFuture(QtConcurrent::run([=] {
+                    const uint8_t* slice[4];
+                    offsetSlicePlanes(source, sourcePixelFormat, sliceRow, slice);
+                    sws_scale(sliceContext, slice, source->linesize, sliceRow, sliceRows,
+                              ret->data, ret->linesize);
+                }));
+            }
+
+            // first slice on the calling thread
+            sws_scale(swsCtx, source->data, source->linesize, 0, sliceHeight, ret->data,
+                      ret->linesize);
+            synchronizer.waitForFinished();
+            sliced = true;
+        }
+
+        for (SwsContext* context : sliceContexts) {
+            if (context) {
+                releaseSwsContext(swsKey, context);
+            }
+        }
+    }
+
+    if (!sliced) {
+        sws_scale(swsCtx, source->data, source->linesize, 0, sourceDimensions.height(), ret->data,
+                  ret->linesize);
+    }
+    releaseSwsContext(swsKey, swsCtx);
+
+    recordScaleTiming(dimensions, scaleTimer.nsecsElapsed(), sliced ? maxSlices : 1);
 
     return ret;
 }
@@ -648,7 +1097,7 @@ AVFrame* VideoFrame::storeAVFrame(AVFrame* frame, const QSize& dimensions, const
         AVFrame* old_ret = frameBuffer[frameKey];
 
         // Free new frame
-        av_freep(&frame->data[0]);
+        freeFrameStorage(frame);
 #if LIBAVCODEC_VERSION_INT < 3747941
         av_frame_unref(frame);
 #endif
@@ -687,7 +1136,7 @@ void VideoFrame::deleteFrameBuffer()
 #endif
             av_frame_free(&frame);
         } else {
-            av_freep(&frame->data[0]);
+            freeFrameStorage(frame);
 #if LIBAVCODEC_VERSION_INT < 3747941
             av_frame_unref(frame);
 #endif
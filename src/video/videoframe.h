@@ -77,6 +77,7 @@ public:
 
     std::shared_ptr<VideoFrame> trackFrame();
     static void untrackFrames(const IDType& sourceID, bool releaseFrames = false);
+    static QString trackingStats();
 
     void releaseFrame();
 
@@ -125,6 +126,8 @@ private:
     static FrameBufferKey getFrameKey(const QSize& frameSize, const int pixFmt,
                                       const bool frameAligned);
 
+    QImage wrapSourceFrame(const QSize& frameSize, const QImage::Format format);
+
     AVFrame* retrieveAVFrame(const QSize& dimensions, const int pixelFormat, const bool requireAligned);
     AVFrame* generateAVFrame(const QSize& dimensions, const int pixelFormat, const bool requireAligned);
     AVFrame* storeAVFrame(AVFrame* frame, const QSize& dimensions, const int pixelFormat);
@@ -135,11 +138,31 @@ private:
     T toGenericObject(const QSize& dimensions, const int pixelFormat, const bool requireAligned,
                       const std::function<T(AVFrame* const)>& objectConstructor, const T& nullObject);
 
+private:
+    /**
+     * @brief Per-source frame reference registry.
+     *
+     * Each VideoSource gets its own mutex and reference map, so frame
+     * tracking for independent sources never contends on a shared lock and
+     * tearing down one source cannot stall frames of another.
+     */
+    struct SourceTracker
+    {
+        QMutex mutex;
+        std::unordered_map<IDType, std::weak_ptr<VideoFrame>> refs;
+    };
+
+    static std::shared_ptr<SourceTracker> trackerForSource(IDType sourceID);
+
 private:
     // ID
     const IDType frameID;
     const IDType sourceID;
 
+    // Resolved once at construction; every subsequent tracking operation only
+    // touches this source's own mutex
+    const std::shared_ptr<SourceTracker> sourceTracker;
+
     // Main framebuffer store
     std::unordered_map<FrameBufferKey, AVFrame*, std::function<decltype(FrameBufferKey::hash)>>
         frameBuffer{3, FrameBufferKey::hash};
@@ -153,12 +176,13 @@ private:
     // Reference store
     static AtomicIDType frameIDs;
 
-    static std::unordered_map<IDType, QMutex> mutexMap;
-    static std::unordered_map<IDType, std::unordered_map<IDType, std::weak_ptr<VideoFrame>>> refsMap;
+    // Registry of per-source trackers; registryLock guards only the registry
+    // map itself, not the frame tracking hot path
+    static std::unordered_map<IDType, std::shared_ptr<SourceTracker>> trackerRegistry;
 
     // Concurrency
     QReadWriteLock frameLock{};
-    static QReadWriteLock refsLock;
+    static QReadWriteLock registryLock;
 };
 
 #endif // VIDEOFRAME_H
@@ -28,7 +28,10 @@
 
 #include <QDebug>
 #include <QLabel>
+#include <QPaintEvent>
 #include <QPainter>
+#include <QScreen>
+#include <QWindow>
 
 /**
  * @var std::atomic_bool VideoSurface::frameLock
@@ -45,6 +48,7 @@ VideoSurface::VideoSurface(const QPixmap& avatar, QWidget* parent, bool expandin
     , source{nullptr}
     , frameLock{false}
     , hasSubscribed{0}
+    , sourceHeld{false}
     , avatar{avatar}
     , ratio{1.0f}
     , expanding{expanding}
@@ -110,10 +114,8 @@ QPixmap VideoSurface::getAvatar() const
 
 void VideoSurface::subscribe()
 {
-    if (source && hasSubscribed++ == 0) {
-        source->subscribe();
-        connect(source, &VideoSource::frameAvailable, this, &VideoSurface::onNewFrameAvailable);
-        connect(source, &VideoSource::sourceStopped, this, &VideoSurface::onSourceStopped);
+    if (source && hasSubscribed++ == 0 && !isHidden()) {
+        acquireSource();
     }
 }
 
@@ -125,18 +127,45 @@ void VideoSurface::unsubscribe()
     if (--hasSubscribed != 0)
         return;
 
-    lock();
-    lastFrame.reset();
-    unlock();
+    releaseSource();
 
     ratio = 1.0f;
     recalulateBounds();
     emit ratioChanged();
     emit boundaryChanged();
+}
+
+/**
+ * @brief Takes the actual VideoSource subscription while the widget can be seen.
+ *
+ * Hidden surfaces hold no subscription at all, so a source with no visible
+ * viewer left can suspend decoding entirely (and CameraSource can close the
+ * device), e.g. when a call window is minimized to tray.
+ */
+void VideoSurface::acquireSource()
+{
+    if (!source || sourceHeld || hasSubscribed == 0)
+        return;
+
+    source->subscribe();
+    connect(source, &VideoSource::frameAvailable, this, &VideoSurface::onNewFrameAvailable);
+    connect(source, &VideoSource::sourceStopped, this, &VideoSurface::onSourceStopped);
+    sourceHeld = true;
+}
+
+void VideoSurface::releaseSource()
+{
+    if (!source || !sourceHeld)
+        return;
 
     disconnect(source, &VideoSource::frameAvailable, this, &VideoSurface::onNewFrameAvailable);
     disconnect(source, &VideoSource::sourceStopped, this, &VideoSurface::onSourceStopped);
     source->unsubscribe();
+    sourceHeld = false;
+
+    lock();
+    lastFrame.reset();
+    unlock();
 }
 
 void VideoSurface::onNewFrameAvailable(const std::shared_ptr<VideoFrame>& newFrame)
@@ -155,9 +184,20 @@ void VideoSurface::onNewFrameAvailable(const std::shared_ptr<VideoFrame>& newFra
         recalulateBounds();
         emit ratioChanged();
         emit boundaryChanged();
+        // recalulateBounds already scheduled a full repaint
+        return;
     }
 
-    update();
+    // Present at most at the display's refresh rate; a faster source only
+    // updates lastFrame, and the extra frames are dropped unpainted
+    if (presentTimer.isValid() && presentTimer.elapsed() < minPresentIntervalMs()) {
+        return;
+    }
+
+    presentTimer.start();
+    // Only the video area changes frame to frame, no need to composite the
+    // black borders around it again
+    update(boundingRect);
 }
 
 void VideoSurface::onSourceStopped()
@@ -167,14 +207,18 @@ void VideoSurface::onSourceStopped()
     update();
 }
 
-void VideoSurface::paintEvent(QPaintEvent*)
+void VideoSurface::paintEvent(QPaintEvent* event)
 {
     lock();
 
     QPainter painter(this);
-    painter.fillRect(painter.viewport(), Qt::black);
+    painter.fillRect(event->rect(), Qt::black);
     if (lastFrame) {
-        QImage frame = lastFrame->toQImage(rect().size());
+        // Convert straight to the displayed size, so the sws stage does the
+        // downscale in one pass and drawImage is a plain blit; converting at
+        // source resolution just to have Qt scale the result down again is
+        // wasted work for the small tiles of a group call
+        QImage frame = lastFrame->toQImage(boundingRect.size());
         if (frame.isNull())
             lastFrame.reset();
         painter.drawImage(boundingRect, frame, frame.rect(), Qt::NoFormatConversion);
@@ -202,9 +246,18 @@ void VideoSurface::resizeEvent(QResizeEvent* event)
 void VideoSurface::showEvent(QShowEvent* e)
 {
     Q_UNUSED(e);
+    acquireSource();
     // emit ratioChanged();
 }
 
+void VideoSurface::hideEvent(QHideEvent* e)
+{
+    Q_UNUSED(e);
+    // Drop the subscription while nothing is shown; ratio and bounds are
+    // kept so the tile has its shape back the moment it reappears
+    releaseSource();
+}
+
 void VideoSurface::recalulateBounds()
 {
     if (expanding) {
@@ -228,6 +281,24 @@ void VideoSurface::recalulateBounds()
     update();
 }
 
+/**
+ * @brief Minimum time between presented frames, from the display's refresh rate.
+ */
+int VideoSurface::minPresentIntervalMs() const
+{
+    qreal refreshRate = 0.0;
+    const QWindow* win = window()->windowHandle();
+    if (win && win->screen()) {
+        refreshRate = win->screen()->refreshRate();
+    }
+
+    if (refreshRate <= 0.0) {
+        refreshRate = 60.0;
+    }
+
+    return static_cast<int>(1000.0 / refreshRate);
+}
+
 void VideoSurface::lock()
 {
     // Fast lock
@@ -21,6 +21,7 @@
 #define SELFCAMVIEW_H
 
 #include "src/video/videosource.h"
+#include <QElapsedTimer>
 #include <QWidget>
 #include <atomic>
 #include <memory>
@@ -52,6 +53,7 @@ protected:
     virtual void paintEvent(QPaintEvent* event) final override;
     virtual void resizeEvent(QResizeEvent* event) final override;
     virtual void showEvent(QShowEvent* event) final override;
+    virtual void hideEvent(QHideEvent* event) final override;
 
 private slots:
     void onNewFrameAvailable(const std::shared_ptr<VideoFrame>& newFrame);
@@ -59,6 +61,9 @@ private slots:
 
 private:
     void recalulateBounds();
+    void acquireSource();
+    void releaseSource();
+    int minPresentIntervalMs() const;
     void lock();
     void unlock();
 
@@ -67,9 +72,15 @@ private:
     std::shared_ptr<VideoFrame> lastFrame;
     std::atomic_bool frameLock;
     uint8_t hasSubscribed;
+    // whether we currently hold a subscription on the source; hidden
+    // surfaces let go of theirs so the source can suspend decoding
+    bool sourceHeld;
     QPixmap avatar;
     float ratio;
     bool expanding;
+    // time of the last scheduled repaint, to throttle presentation to the
+    // display's refresh rate; frames arriving faster are never painted
+    QElapsedTimer presentTimer;
 };
 
 #endif // SELFCAMVIEW_H
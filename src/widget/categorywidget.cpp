@@ -21,6 +21,7 @@
 #include "friendlistlayout.h"
 #include "friendlistwidget.h"
 #include "friendwidget.h"
+#include "src/model/friend.h"
 #include "src/model/status.h"
 #include "src/widget/style.h"
 #include "tool/croppinglabel.h"
@@ -87,6 +88,8 @@ void CategoryWidget::setExpanded(bool isExpanded, bool save)
     }
     expanded = isExpanded;
     setMouseTracking(true);
+    if (isExpanded)
+        buildPendingWidgets();
     listWidget->setVisible(isExpanded);
 
     QString pixmapPath;
@@ -129,6 +132,19 @@ void CategoryWidget::editName()
 
 void CategoryWidget::addFriendWidget(FriendWidget* w, Status::Status s)
 {
+    if (!expanded) {
+        // Defer the sorted insertion until the category is first expanded; a
+        // collapsed circle holding hundreds of contacts would otherwise pay
+        // full layout cost for children nobody can see. The counters still
+        // reflect the deferred children, see updateStatus().
+        Q_UNUSED(s);
+        pendingWidgets.append(w);
+        w->hide();
+        updateStatus();
+        onAddFriendWidget(w);
+        return;
+    }
+
     listLayout->addFriendWidget(w, s);
     updateStatus();
     onAddFriendWidget(w);
@@ -137,21 +153,52 @@ void CategoryWidget::addFriendWidget(FriendWidget* w, Status::Status s)
 
 void CategoryWidget::removeFriendWidget(FriendWidget* w, Status::Status s)
 {
+    if (pendingWidgets.removeOne(w)) {
+        updateStatus();
+        return;
+    }
+
     listLayout->removeFriendWidget(w, s);
     updateStatus();
 }
 
+// Builds the children whose insertion was deferred while the category was
+// collapsed.
+void CategoryWidget::buildPendingWidgets()
+{
+    if (pendingWidgets.isEmpty())
+        return;
+
+    const auto pending = pendingWidgets;
+    pendingWidgets.clear();
+    for (FriendWidget* w : pending) {
+        // The status may have changed while the widget sat deferred, so it is
+        // read fresh rather than remembered from the add.
+        listLayout->addFriendWidget(w, w->getFriend()->getStatus());
+        w->reloadTheme();
+        w->show();
+    }
+
+    updateStatus();
+}
+
 void CategoryWidget::updateStatus()
 {
-    QString online = QString::number(listLayout->friendOnlineCount());
-    QString offline = QString::number(listLayout->friendTotalCount());
+    int onlineCount = listLayout->friendOnlineCount();
+    for (FriendWidget* w : pendingWidgets) {
+        if (w->getFriend()->getStatus() != Status::Status::Offline)
+            ++onlineCount;
+    }
+
+    QString online = QString::number(onlineCount);
+    QString offline = QString::number(listLayout->friendTotalCount() + pendingWidgets.size());
     QString text = online + QStringLiteral(" / ") + offline;
     statusLabel->setText(text);
 }
 
 bool CategoryWidget::hasChatrooms() const
 {
-    return listLayout->hasChatrooms();
+    return !pendingWidgets.isEmpty() || listLayout->hasChatrooms();
 }
 
 void CategoryWidget::search(const QString& searchString, bool updateAll, bool hideOnline,
@@ -166,6 +213,10 @@ void CategoryWidget::search(const QString& searchString, bool updateAll, bool hi
 
 bool CategoryWidget::cycleContacts(bool forward)
 {
+    // Cycling enumerates the layouts directly, so any deferred children have
+    // to exist first.
+    buildPendingWidgets();
+
     if (listLayout->friendTotalCount() == 0) {
         return false;
     }
@@ -197,6 +248,8 @@ bool CategoryWidget::cycleContacts(bool forward)
 
 bool CategoryWidget::cycleContacts(FriendWidget* activeChatroomWidget, bool forward)
 {
+    buildPendingWidgets();
+
     int index = -1;
     QLayout* currentLayout = nullptr;
 
@@ -286,17 +339,22 @@ void CategoryWidget::setContainerAttribute(Qt::WidgetAttribute attribute, bool e
     Style::repolish(container);
 }
 
-QLayout* CategoryWidget::friendOfflineLayout() const
+// The layout accessors hand out the real layouts for enumeration, so the
+// deferred children are built first to keep them complete.
+QLayout* CategoryWidget::friendOfflineLayout()
 {
+    buildPendingWidgets();
     return listLayout->getLayoutOffline();
 }
 
-QLayout* CategoryWidget::friendOnlineLayout() const
+QLayout* CategoryWidget::friendOnlineLayout()
 {
+    buildPendingWidgets();
     return listLayout->getLayoutOnline();
 }
 
 void CategoryWidget::moveFriendWidgets(FriendListWidget* friendList)
 {
+    buildPendingWidgets();
     listLayout->moveFriendWidgets(friendList);
 }
@@ -50,6 +50,9 @@ public:
     void search(const QString& searchString, bool updateAll = false, bool hideOnline = false,
                 bool hideOffline = false);
 
+    QLayout* friendOnlineLayout();
+    QLayout* friendOfflineLayout();
+
 public slots:
     void onCompactChanged(bool compact);
     void moveFriendWidgets(FriendListWidget* friendList);
@@ -60,8 +63,6 @@ protected:
 
     void editName();
     void setContainerAttribute(Qt::WidgetAttribute attribute, bool enabled);
-    QLayout* friendOnlineLayout() const;
-    QLayout* friendOfflineLayout() const;
     void emitChatroomWidget(QLayout* layout, int index);
 
 private:
@@ -75,6 +76,8 @@ private:
     {
     }
 
+    void buildPendingWidgets();
+
     QWidget* listWidget;
     FriendListLayout* listLayout;
     QVBoxLayout* fullLayout;
@@ -84,6 +87,9 @@ private:
     QWidget* container;
     QFrame* lineFrame;
     bool expanded = false;
+    // Children added while collapsed; built into the layout on first
+    // expansion, see buildPendingWidgets().
+    QVector<FriendWidget*> pendingWidgets;
 };
 
 #endif // CATEGORYWIDGET_H
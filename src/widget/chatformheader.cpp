@@ -283,10 +283,10 @@ QSize ChatFormHeader::getAvatarSize() const
 
 void ChatFormHeader::reloadTheme()
 {
-    callButton->setStyleSheet(Style::getStylesheet(STYLE_PATH));
-    videoButton->setStyleSheet(Style::getStylesheet(STYLE_PATH));
-    volButton->setStyleSheet(Style::getStylesheet(STYLE_PATH));
-    micButton->setStyleSheet(Style::getStylesheet(STYLE_PATH));
+    Style::setStylesheet(callButton, STYLE_PATH);
+    Style::setStylesheet(videoButton, STYLE_PATH);
+    Style::setStylesheet(volButton, STYLE_PATH);
+    Style::setStylesheet(micButton, STYLE_PATH);
 }
 
 void ChatFormHeader::addWidget(QWidget* widget, int stretch, Qt::Alignment alignment)
@@ -182,7 +182,7 @@ void CircleWidget::dropEvent(QDropEvent* event)
     CircleWidget* circleWidget = getFromID(circleId);
 
     addFriendWidget(widget, f->getStatus());
-    Settings::getInstance().savePersonal();
+    Settings::getInstance().scheduleSavePersonal();
 
     if (circleWidget != nullptr) {
         circleWidget->updateStatus();
@@ -200,7 +200,7 @@ void CircleWidget::onSetName()
 void CircleWidget::onExpand()
 {
     Settings::getInstance().setCircleExpanded(id, isExpanded());
-    Settings::getInstance().savePersonal();
+    Settings::getInstance().scheduleSavePersonal();
 }
 
 void CircleWidget::onAddFriendWidget(FriendWidget* w)
@@ -392,7 +392,7 @@ void ContentDialog::updateTitleAndStatusIcon()
     }
 
     Status::Status currentStatus = activeChatroomWidget->getFriend()->getStatus();
-    setWindowIcon(QIcon{Status::getIconPath(currentStatus)});
+    setWindowIcon(QIcon{Status::getIconPixmap(currentStatus)});
 }
 
 /**
@@ -69,8 +69,8 @@ ContentLayout::~ContentLayout()
 void ContentLayout::reloadTheme()
 {
 #ifndef Q_OS_MAC
-    mainHead->setStyleSheet(Style::getStylesheet("settings/mainHead.css"));
-    mainContent->setStyleSheet(Style::getStylesheet("window/general.css"));
+    Style::setStylesheet(mainHead, "settings/mainHead.css");
+    Style::setStylesheet(mainContent, "window/general.css");
 #endif
 }
 
@@ -31,6 +31,10 @@
 
 #include <math.h>
 
+static const int maxCols = 8;
+static const int maxRows = 8;
+static const int itemsPerPage = maxRows * maxCols;
+
 EmoticonsWidget::EmoticonsWidget(QWidget* parent)
     : QMenu(parent)
 {
@@ -44,21 +48,9 @@ EmoticonsWidget::EmoticonsWidget(QWidget* parent)
 
     layout.addWidget(pageButtonsContainer);
 
-    const int maxCols = 8;
-    const int maxRows = 8;
-    const int itemsPerPage = maxRows * maxCols;
-
-    const QList<QStringList>& emoticons = SmileyPack::getInstance().getEmoticons();
-    int itemCount = emoticons.size();
+    emoticonSets = SmileyPack::getInstance().getEmoticons();
+    int itemCount = emoticonSets.size();
     int pageCount = ceil(float(itemCount) / float(itemsPerPage));
-    int currPage = 0;
-    int currItem = 0;
-    int row = 0;
-    int col = 0;
-
-    // respect configured emoticon size
-    const int px = Settings::getInstance().getEmojiFontPointSize();
-    const QSize size(px, px);
 
     // create pages
     buttonLayout->addStretch();
@@ -86,8 +78,40 @@ EmoticonsWidget::EmoticonsWidget(QWidget* parent)
     }
     buttonLayout->addStretch();
 
+    // Pages get their buttons on first view; only the first page is built up
+    // front so opening the picker does not scale with the pack size.
+    pageBuilt = QVector<bool>(pageCount, false);
+    connect(&stack, &QStackedWidget::currentChanged, this, &EmoticonsWidget::buildPage);
+    buildPage(0);
+
+    // calculates sizeHint
+    layout.activate();
+}
+
+// Fills one page of the picker with its emoticon buttons. The stacked widget
+// reports the largest page as its size hint, so building the (full) first
+// page eagerly keeps the popup geometry correct while the remaining pages
+// stay empty until flipped to.
+void EmoticonsWidget::buildPage(int index)
+{
+    if (index < 0 || index >= pageBuilt.size() || pageBuilt[index])
+        return;
+
+    pageBuilt[index] = true;
+
+    // respect configured emoticon size
+    const int px = Settings::getInstance().getEmojiFontPointSize();
+    const QSize size(px, px);
+
     SmileyPack& smileyPack = SmileyPack::getInstance();
-    for (const QStringList& set : emoticons) {
+    QGridLayout* pageLayout = qobject_cast<QGridLayout*>(stack.widget(index)->layout());
+
+    const int start = index * itemsPerPage;
+    const int end = qMin(start + itemsPerPage, emoticonSets.size());
+    int row = 0;
+    int col = 0;
+    for (int i = start; i < end; ++i) {
+        const QStringList& set = emoticonSets.at(i);
         QPushButton* button = new QPushButton;
         std::shared_ptr<QIcon> icon = smileyPack.getAsIcon(set[0]);
         emoticonsIcons.append(icon);
@@ -101,27 +125,16 @@ EmoticonsWidget::EmoticonsWidget(QWidget* parent)
 
         connect(button, &QPushButton::clicked, this, &EmoticonsWidget::onSmileyClicked);
 
-        qobject_cast<QGridLayout*>(stack.widget(currPage)->layout())->addWidget(button, row, col);
+        pageLayout->addWidget(button, row, col);
 
         ++col;
-        ++currItem;
 
         // next row
         if (col >= maxCols) {
             col = 0;
             ++row;
         }
-
-        // next page
-        if (currItem >= itemsPerPage) {
-            row = 0;
-            currItem = 0;
-            ++currPage;
-        }
     }
-
-    // calculates sizeHint
-    layout.activate();
 }
 
 void EmoticonsWidget::onSmileyClicked()
@@ -42,6 +42,7 @@ private slots:
     void onSmileyClicked();
     void onPageButtonClicked();
     void PageButtonsUpdate();
+    void buildPage(int index);
 
 protected:
     void mouseReleaseEvent(QMouseEvent* ev) final override;
@@ -53,6 +54,8 @@ private:
     QStackedWidget stack;
     QVBoxLayout layout;
     QList<std::shared_ptr<QIcon>> emoticonsIcons;
+    QList<QStringList> emoticonSets;
+    QVector<bool> pageBuilt;
 
 public:
     QSize sizeHint() const override;
@@ -68,6 +68,13 @@ void FlowLayout::addItem(QLayoutItem* item)
     itemList.append(item);
 }
 
+void FlowLayout::insertWidget(int index, QWidget* widget)
+{
+    addChildWidget(widget);
+    itemList.insert(index, new QWidgetItem(widget));
+    invalidate();
+}
+
 int FlowLayout::horizontalSpacing() const
 {
     if (m_hSpace >= 0)
@@ -20,6 +20,7 @@
 #include "addfriendform.h"
 #include "src/core/core.h"
 #include "src/net/toxme.h"
+#include "src/net/toxmelookup.h"
 #include "src/nexus.h"
 #include "src/persistence/settings.h"
 #include "src/widget/contentlayout.h"
@@ -65,6 +66,7 @@ namespace
 
 AddFriendForm::AddFriendForm()
 {
+    toxmeLookup = new ToxmeLookupService(this);
     tabWidget = new QTabWidget();
     main = new QWidget(tabWidget), head = new QWidget();
     QFont bold;
@@ -197,42 +199,57 @@ void AddFriendForm::onUsernameSet(const QString& username)
     retranslateUi();
 }
 
-void AddFriendForm::addFriend(const QString& idText)
+void AddFriendForm::addFriend(const QString& idText, const QString& message)
 {
-    ToxId friendId(idText);
+    const ToxId friendId(idText);
 
-    if (!friendId.isValid()) {
-        friendId = Toxme::lookup(idText); // Try Toxme
-        if (!friendId.isValid()) {
+    if (friendId.isValid()) {
+        completeFriendAdd(friendId, message);
+        return;
+    }
+
+    // Try Toxme. Lookups resolve off the GUI thread and in parallel with each
+    // other, so importing a contact list doesn't serialize on the network.
+    toxmeLookup->lookup(idText, [this, idText, message](const ToxId& resolved) {
+        if (!resolved.isValid()) {
             GUI::showWarning(tr("Couldn't add friend"),
                              tr("%1 Tox ID is invalid or does not exist", "Toxme error").arg(idText));
             return;
         }
-    }
+        completeFriendAdd(resolved, message);
+    });
+}
 
+void AddFriendForm::completeFriendAdd(const ToxId& friendId, const QString& message)
+{
     deleteFriendRequest(friendId);
     if (friendId == Core::getInstance()->getSelfId()) {
         GUI::showWarning(tr("Couldn't add friend"),
                          //: When trying to add your own Tox ID as friend
                          tr("You can't add yourself as a friend!"));
     } else {
-        emit friendRequested(friendId, getMessage());
+        emit friendRequested(friendId, message);
     }
 }
 
 void AddFriendForm::onSendTriggered()
 {
     const QString id = getToxId(toxId.text());
-    addFriend(id);
 
+    // clear before issuing the lookup: clearing fires onIdChanged, which
+    // would otherwise cancel the resolution we're about to start
     this->toxId.clear();
+    const QString sendMessage = getMessage();
     this->message.clear();
+
+    addFriend(id, sendMessage);
 }
 
 void AddFriendForm::onImportSendClicked()
 {
+    const QString message = getMessage();
     for (const QString& id : contactsToImport) {
-        addFriend(id);
+        addFriend(id, message);
     }
 
     contactsToImport.clear();
@@ -281,6 +298,9 @@ void AddFriendForm::onImportOpenClicked()
 
 void AddFriendForm::onIdChanged(const QString& id)
 {
+    // whatever was being resolved is for an address the user no longer wants
+    toxmeLookup->cancelPending();
+
     const QString strippedId = getToxId(id);
 
     const bool isValidId = checkIsValidId(strippedId);
@@ -335,7 +355,7 @@ void AddFriendForm::onFriendRequestAccepted()
     const Settings::Request request = Settings::getInstance().getFriendRequest(indexFromEnd);
     emit friendRequestAccepted(ToxId(request.address).getPublicKey());
     Settings::getInstance().removeFriendRequest(indexFromEnd);
-    Settings::getInstance().savePersonal();
+    Settings::getInstance().scheduleSavePersonal();
 }
 
 void AddFriendForm::onFriendRequestRejected()
@@ -346,14 +366,14 @@ void AddFriendForm::onFriendRequestRejected()
     removeFriendRequestWidget(friendWidget);
     const int indexFromEnd = requestsLayout->count() - index - 1;
     Settings::getInstance().removeFriendRequest(indexFromEnd);
-    Settings::getInstance().savePersonal();
+    Settings::getInstance().scheduleSavePersonal();
 }
 
 void AddFriendForm::onCurrentChanged(int index)
 {
     if (index == FriendRequest && Settings::getInstance().getUnreadFriendRequests() != 0) {
         Settings::getInstance().clearUnreadFriendRequests();
-        Settings::getInstance().savePersonal();
+        Settings::getInstance().scheduleSavePersonal();
         emit friendRequestsSeen();
     }
 }
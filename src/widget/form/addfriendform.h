@@ -34,6 +34,7 @@
 class QTabWidget;
 
 class ContentLayout;
+class ToxmeLookupService;
 
 class AddFriendForm : public QObject
 {
@@ -75,7 +76,8 @@ private slots:
     void onCurrentChanged(int index);
 
 private:
-    void addFriend(const QString& idText);
+    void addFriend(const QString& idText, const QString& message);
+    void completeFriendAdd(const ToxId& friendId, const QString& message);
     void retranslateUi();
     void addFriendRequestWidget(const QString& friendAddress, const QString& message);
     void removeFriendRequestWidget(QWidget* friendWidget);
@@ -112,6 +114,7 @@ private:
     QList<QPushButton*> acceptButtons;
     QList<QPushButton*> rejectButtons;
     QList<QString> contactsToImport;
+    ToxmeLookupService* toxmeLookup;
 };
 
 #endif // ADDFRIENDFORM_H
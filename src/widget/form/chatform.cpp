@@ -33,6 +33,7 @@
 #include "src/persistence/offlinemsgengine.h"
 #include "src/persistence/profile.h"
 #include "src/persistence/settings.h"
+#include "src/util/asynctask.h"
 #include "src/video/netcamview.h"
 #include "src/widget/chatformheader.h"
 #include "src/widget/form/loadhistorydialog.h"
@@ -149,6 +150,7 @@ ChatForm::ChatForm(Friend* chatFriend, IChatLog& chatLog, IMessageDispatcher& me
     connect(av, &CoreAV::avInvite, this, &ChatForm::onAvInvite);
     connect(av, &CoreAV::avStart, this, &ChatForm::onAvStart);
     connect(av, &CoreAV::avEnd, this, &ChatForm::onAvEnd);
+    connect(av, &CoreAV::avCallFailed, this, &ChatForm::onAvCallFailed);
 
     connect(headWidget, &ChatFormHeader::callTriggered, this, &ChatForm::onCallTriggered);
     connect(headWidget, &ChatFormHeader::videoCallTriggered, this, &ChatForm::onVideoCallTriggered);
@@ -295,7 +297,7 @@ void ChatForm::onAvInvite(uint32_t friendId, bool video)
         CoreAV* coreav = Core::getInstance()->getAv();
         QMetaObject::invokeMethod(coreav, "answerCall", Qt::QueuedConnection,
                                   Q_ARG(uint32_t, friendId), Q_ARG(bool, video));
-        onAvStart(friendId, video);
+        // onAvStart arrives via the avStart signal once the answer went through
     } else {
         headWidget->createCallConfirm(video);
         headWidget->showCallConfirm();
@@ -340,6 +342,23 @@ void ChatForm::onAvEnd(uint32_t friendId, bool error)
     hideNetcam();
 }
 
+void ChatForm::onAvCallFailed(uint32_t friendId)
+{
+    if (friendId != f->getId()) {
+        return;
+    }
+
+    // a queued startCall or answerCall didn't go through, take back
+    // whatever call state the UI showed in anticipation
+    headWidget->removeCallConfirm();
+    addSystemInfoMessage(tr("Call to %1 failed").arg(f->getDisplayedName()), ChatMessage::INFO,
+                         QDateTime::currentDateTime());
+    emit stopNotification();
+    updateCallButtons();
+    stopCounter();
+    hideNetcam();
+}
+
 void ChatForm::showOutgoingCall(bool video)
 {
     headWidget->showOutgoingCall(video);
@@ -356,16 +375,11 @@ void ChatForm::onAnswerCallTriggered(bool video)
     emit stopNotification();
     emit acceptCall(friendId);
 
+    // acknowledge right away; the answer itself runs on the AV thread and
+    // comes back as avStart, or as avCallFailed which reverts this
     updateCallButtons();
     CoreAV* av = Core::getInstance()->getAv();
-    if (!av->answerCall(friendId, video)) {
-        updateCallButtons();
-        stopCounter();
-        hideNetcam();
-        return;
-    }
-
-    onAvStart(friendId, av->isCallVideoEnabled(f));
+    av->answerCall(friendId, video);
 }
 
 void ChatForm::onRejectCallTriggered()
@@ -380,7 +394,9 @@ void ChatForm::onCallTriggered()
     uint32_t friendId = f->getId();
     if (av->isCallStarted(f)) {
         av->cancelCall(friendId);
-    } else if (av->startCall(friendId, false)) {
+    } else {
+        av->startCall(friendId, false);
+        // shown optimistically, avCallFailed takes it back down
         showOutgoingCall(false);
     }
 }
@@ -394,7 +410,9 @@ void ChatForm::onVideoCallTriggered()
         if (av->isCallVideoEnabled(f)) {
             av->cancelCall(friendId);
         }
-    } else if (av->startCall(friendId, true)) {
+    } else {
+        av->startCall(friendId, true);
+        // shown optimistically, avCallFailed takes it back down
         showOutgoingCall(true);
     }
 }
@@ -565,30 +583,51 @@ void ChatForm::doScreenshot()
 
 void ChatForm::sendImage(const QPixmap& pixmap)
 {
-    QDir(Settings::getInstance().getAppDataDirPath()).mkpath("images");
+    // QPixmap is tied to the GUI thread, so detach to a QImage and let the
+    // pool do the encode and file write; a full 4K grab takes long enough
+    // to freeze the editor overlay otherwise
+    const QImage image = pixmap.toImage();
+    const QString format = Settings::getInstance().getPastedImageFormat();
+    const int quality = Settings::getInstance().getPastedImageQuality();
 
-    // use ~ISO 8601 for screenshot timestamp, considering FS limitations
-    // https://en.wikipedia.org/wiki/ISO_8601
-    // Windows has to be supported, thus filename can't have `:` in it :/
-    // Format should be: `qTox_Screenshot_yyyy-MM-dd HH-mm-ss.zzz.png`
-    QString filepath = QString("%1images%2qTox_Image_%3.png")
-                           .arg(Settings::getInstance().getAppDataDirPath())
-                           .arg(QDir::separator())
-                           .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH-mm-ss.zzz"));
-    QFile file(filepath);
+    addSystemInfoMessage(tr("Preparing image to send…"), ChatMessage::INFO,
+                         QDateTime::currentDateTime());
 
-    if (file.open(QFile::ReadWrite)) {
-        pixmap.save(&file, "PNG");
-        qint64 filesize = file.size();
-        file.close();
-        QFileInfo fi(file);
-        CoreFile* coreFile = Core::getInstance()->getCoreFile();
-        coreFile->sendFile(f->getId(), fi.fileName(), fi.filePath(), filesize);
-    } else {
-        QMessageBox::warning(this,
-                             tr("Failed to open temporary file", "Temporary file for screenshot"),
-                             tr("qTox wasn't able to save the screenshot"));
-    }
+    AsyncTask::runThen(this,
+                       [image, format, quality]() -> QString {
+                           QDir(Settings::getInstance().getAppDataDirPath()).mkpath("images");
+
+                           // use ~ISO 8601 for screenshot timestamp, considering FS limitations
+                           // https://en.wikipedia.org/wiki/ISO_8601
+                           // Windows has to be supported, thus filename can't have `:` in it :/
+                           // Format should be: `qTox_Screenshot_yyyy-MM-dd HH-mm-ss.zzz.png`
+                           const QString filepath =
+                               QString("%1images%2qTox_Image_%3.%4")
+                                   .arg(Settings::getInstance().getAppDataDirPath())
+                                   .arg(QDir::separator())
+                                   .arg(QDateTime::currentDateTime().toString(
+                                       "yyyy-MM-dd HH-mm-ss.zzz"))
+                                   .arg(format);
+                           QFile file(filepath);
+                           if (!file.open(QFile::ReadWrite)
+                               || !image.save(&file, format.toUtf8().constData(), quality)) {
+                               return QString{};
+                           }
+                           return filepath;
+                       },
+                       [this](const QString& filepath) {
+                           if (filepath.isEmpty()) {
+                               QMessageBox::warning(this,
+                                                    tr("Failed to open temporary file",
+                                                       "Temporary file for screenshot"),
+                                                    tr("qTox wasn't able to save the screenshot"));
+                               return;
+                           }
+
+                           const QFileInfo fi(filepath);
+                           CoreFile* coreFile = Core::getInstance()->getCoreFile();
+                           coreFile->sendFile(f->getId(), fi.fileName(), fi.filePath(), fi.size());
+                       });
 }
 
 void ChatForm::insertChatMessage(ChatMessage::Ptr msg)
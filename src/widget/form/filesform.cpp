@@ -18,13 +18,78 @@
 */
 
 #include "filesform.h"
+#include "src/chatlog/content/filetransferwidget.h"
+#include "src/core/groupid.h"
+#include "src/core/toxpk.h"
+#include "src/friendlist.h"
+#include "src/grouplist.h"
+#include "src/model/friend.h"
+#include "src/model/group.h"
+#include "src/nexus.h"
+#include "src/persistence/history.h"
+#include "src/persistence/profile.h"
 #include "src/widget/contentlayout.h"
 #include "src/widget/translator.h"
 #include "src/widget/style.h"
 #include "src/widget/widget.h"
 #include <QFileInfo>
+#include <QHeaderView>
+#include <QLineEdit>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <QTableView>
 #include <QWindow>
 
+namespace {
+// Full path of a history row's file, carried on its name item
+constexpr int filePathRole = Qt::UserRole + 1;
+
+enum HistoryColumn
+{
+    colDate = 0,
+    colName,
+    colContact,
+    colSize,
+    colDirection,
+    colStatus,
+};
+
+/**
+ * @brief Display name for the conversation a transfer belongs to.
+ *
+ * The database keys conversations by public key; contacts still on the
+ * roster show their current name, departed ones keep a key prefix so their
+ * files remain findable.
+ */
+QString resolveContactName(const QString& chatPk)
+{
+    const QByteArray raw = QByteArray::fromHex(chatPk.toLatin1());
+    if (raw.length() == 32) {
+        if (Friend* f = FriendList::findFriend(ToxPk(raw))) {
+            return f->getDisplayedName();
+        }
+        if (Group* g = GroupList::findGroup(GroupId(raw))) {
+            return g->getDisplayedName();
+        }
+    }
+    return chatPk.left(12);
+}
+
+QString statusText(ToxFile::FileStatus status)
+{
+    switch (status) {
+    case ToxFile::FINISHED:
+        return FilesForm::tr("Complete");
+    case ToxFile::CANCELED:
+        return FilesForm::tr("Canceled");
+    case ToxFile::BROKEN:
+        return FilesForm::tr("Broken");
+    default:
+        return FilesForm::tr("Incomplete");
+    }
+}
+} // namespace
+
 FilesForm::FilesForm()
     : QObject()
     , doneIcon(Style::getImagePath("fileTransferWidget/fileDone.svg"))
@@ -39,11 +104,42 @@ FilesForm::FilesForm()
     recvd = new QListWidget;
     sent = new QListWidget;
 
+    historyTab = new QWidget;
+    historyFilter = new QLineEdit;
+    historyFilter->setClearButtonEnabled(true);
+    historyView = new QTableView;
+    historyModel = new QStandardItemModel(this);
+    historyProxy = new QSortFilterProxyModel(this);
+
+    // Sorting reads Qt::UserRole, where dates and sizes are stored as
+    // numbers, so clicking those headers doesn't sort their display strings
+    historyProxy->setSourceModel(historyModel);
+    historyProxy->setSortRole(Qt::UserRole);
+    historyProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    historyProxy->setFilterKeyColumn(-1); // match against every column
+
+    historyView->setModel(historyProxy);
+    historyView->setSortingEnabled(true);
+    historyView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    historyView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    historyView->setShowGrid(false);
+    historyView->verticalHeader()->hide();
+    historyView->horizontalHeader()->setStretchLastSection(true);
+    historyView->sortByColumn(colDate, Qt::DescendingOrder);
+
+    QVBoxLayout* historyLayout = new QVBoxLayout(historyTab);
+    historyLayout->addWidget(historyFilter);
+    historyLayout->addWidget(historyView);
+
     main.addTab(recvd, QString());
     main.addTab(sent, QString());
+    main.addTab(historyTab, QString());
 
     connect(sent, &QListWidget::itemActivated, this, &FilesForm::onFileActivated);
     connect(recvd, &QListWidget::itemActivated, this, &FilesForm::onFileActivated);
+    connect(historyFilter, &QLineEdit::textChanged, historyProxy,
+            &QSortFilterProxyModel::setFilterFixedString);
+    connect(historyView, &QTableView::activated, this, &FilesForm::onHistoryFileActivated);
 
     retranslateUi();
     Translator::registerHandler(std::bind(&FilesForm::retranslateUi, this), this);
@@ -54,6 +150,7 @@ FilesForm::~FilesForm()
     Translator::unregister(this);
     delete recvd;
     delete sent;
+    delete historyTab;
     head->deleteLater();
 }
 
@@ -69,12 +166,57 @@ bool FilesForm::isShown() const
 
 void FilesForm::show(ContentLayout* contentLayout)
 {
+    reloadHistory();
     contentLayout->mainContent->layout()->addWidget(&main);
     contentLayout->mainHead->layout()->addWidget(head);
     main.show();
     head->show();
 }
 
+/**
+ * @brief Rebuilds the history tab from the database.
+ *
+ * History answers getAllFileTransfers() with an index-only scan, so this is
+ * cheap even on large profiles; sorting and filtering then run on the
+ * in-memory model through the proxy without touching the database again.
+ */
+void FilesForm::reloadHistory()
+{
+    historyModel->removeRows(0, historyModel->rowCount());
+
+    Profile* profile = Nexus::getProfile();
+    History* history = profile ? profile->getHistory() : nullptr;
+    if (!history) {
+        return;
+    }
+
+    for (const History::FileHistoryEntry& entry : history->getAllFileTransfers()) {
+        auto* date = new QStandardItem(entry.timestamp.toString("yyyy-MM-dd hh:mm"));
+        date->setData(entry.timestamp.toMSecsSinceEpoch(), Qt::UserRole);
+
+        auto* name = new QStandardItem(entry.file.fileName);
+        name->setData(entry.file.fileName, Qt::UserRole);
+        name->setData(entry.file.filePath, filePathRole);
+
+        const QString contactName = resolveContactName(entry.chatPk);
+        auto* contact = new QStandardItem(contactName);
+        contact->setData(contactName, Qt::UserRole);
+
+        auto* size =
+            new QStandardItem(FileTransferWidget::getHumanReadableSize(entry.file.filesize));
+        size->setData(static_cast<qlonglong>(entry.file.filesize), Qt::UserRole);
+
+        auto* direction = new QStandardItem(
+            entry.file.direction == ToxFile::RECEIVING ? tr("Received") : tr("Sent"));
+        direction->setData(direction->text(), Qt::UserRole);
+
+        auto* status = new QStandardItem(statusText(entry.file.status));
+        status->setData(status->text(), Qt::UserRole);
+
+        historyModel->appendRow({date, name, contact, size, direction, status});
+    }
+}
+
 void FilesForm::onFileDownloadComplete(const QString& path)
 {
     QListWidgetItem* tmp = new QListWidgetItem(doneIcon, QFileInfo(path).fileName());
@@ -99,9 +241,23 @@ void FilesForm::onFileActivated(QListWidgetItem* item)
     Widget::confirmExecutableOpen(QFileInfo(item->data(Qt::UserRole).toString()));
 }
 
+void FilesForm::onHistoryFileActivated(const QModelIndex& index)
+{
+    const QModelIndex sourceIndex = historyProxy->mapToSource(index);
+    const QString path =
+        historyModel->item(sourceIndex.row(), colName)->data(filePathRole).toString();
+    if (!path.isEmpty()) {
+        Widget::confirmExecutableOpen(QFileInfo(path));
+    }
+}
+
 void FilesForm::retranslateUi()
 {
     headLabel.setText(tr("Transferred Files", "\"Headline\" of the window"));
     main.setTabText(0, tr("Downloads"));
     main.setTabText(1, tr("Uploads"));
+    main.setTabText(2, tr("History"));
+    historyFilter->setPlaceholderText(tr("Filter by file name or contact…"));
+    historyModel->setHorizontalHeaderLabels({tr("Date"), tr("Name"), tr("Contact"), tr("Size"),
+                                             tr("Direction"), tr("Status")});
 }
@@ -27,7 +27,12 @@
 #include <QVBoxLayout>
 
 class ContentLayout;
+class QLineEdit;
 class QListWidget;
+class QModelIndex;
+class QSortFilterProxyModel;
+class QStandardItemModel;
+class QTableView;
 
 class FilesForm : public QObject
 {
@@ -46,9 +51,11 @@ public slots:
 
 private slots:
     void onFileActivated(QListWidgetItem* item);
+    void onHistoryFileActivated(const QModelIndex& index);
 
 private:
     void retranslateUi();
+    void reloadHistory();
 
 private:
     QWidget* head;
@@ -57,6 +64,14 @@ private:
     QVBoxLayout headLayout;
     QTabWidget main;
     QListWidget *sent, *recvd;
+
+    // All-time transfer browser fed by History: a filter box over a sortable
+    // table, rebuilt from the database each time the window is shown
+    QWidget* historyTab;
+    QLineEdit* historyFilter;
+    QTableView* historyView;
+    QStandardItemModel* historyModel;
+    QSortFilterProxyModel* historyProxy;
 };
 
 #endif // FILESFORM_H
@@ -370,6 +370,7 @@ GenericChatForm::GenericChatForm(const Contact* contact, IChatLog& chatLog,
     connect(searchForm, &SearchForm::searchUp, this, &GenericChatForm::onSearchUp);
     connect(searchForm, &SearchForm::searchDown, this, &GenericChatForm::onSearchDown);
     connect(searchForm, &SearchForm::visibleChanged, this, &GenericChatForm::onSearchTriggered);
+    connect(&chatLog, &IChatLog::searchFinished, this, &GenericChatForm::handleSearchResult);
     connect(this, &GenericChatForm::messageNotFoundShow, searchForm, &SearchForm::showMessageNotFound);
 
     connect(&chatLog, &IChatLog::itemUpdated, this, &GenericChatForm::renderMessage);
@@ -438,20 +439,23 @@ QDateTime GenericChatForm::getFirstTime() const
 void GenericChatForm::reloadTheme()
 {
     const Settings& s = Settings::getInstance();
-    setStyleSheet(Style::getStylesheet("genericChatForm/genericChatForm.css"));
-    msgEdit->setStyleSheet(Style::getStylesheet("msgEdit/msgEdit.css")
-                           + fontToCss(s.getChatMessageFont(), "QTextEdit"));
+    Style::setStylesheet(this, "genericChatForm/genericChatForm.css");
+    const QString msgEditSheet = Style::getStylesheet("msgEdit/msgEdit.css")
+                                 + fontToCss(s.getChatMessageFont(), "QTextEdit");
+    if (msgEdit->styleSheet() != msgEditSheet) {
+        msgEdit->setStyleSheet(msgEditSheet);
+    }
 
-    chatWidget->setStyleSheet(Style::getStylesheet("chatArea/chatArea.css"));
-    headWidget->setStyleSheet(Style::getStylesheet("chatArea/chatHead.css"));
+    Style::setStylesheet(chatWidget, "chatArea/chatArea.css");
+    Style::setStylesheet(headWidget, "chatArea/chatHead.css");
     chatWidget->reloadTheme();
     headWidget->reloadTheme();
     searchForm->reloadTheme();
 
-    emoteButton->setStyleSheet(Style::getStylesheet(STYLE_PATH));
-    fileButton->setStyleSheet(Style::getStylesheet(STYLE_PATH));
-    screenshotButton->setStyleSheet(Style::getStylesheet(STYLE_PATH));
-    sendButton->setStyleSheet(Style::getStylesheet(STYLE_PATH));
+    Style::setStylesheet(emoteButton, STYLE_PATH);
+    Style::setStylesheet(fileButton, STYLE_PATH);
+    Style::setStylesheet(screenshotButton, STYLE_PATH);
+    Style::setStylesheet(sendButton, STYLE_PATH);
 }
 
 void GenericChatForm::setName(const QString& newName)
@@ -770,7 +774,7 @@ void GenericChatForm::onSelectAllClicked()
 
 void GenericChatForm::insertChatMessage(ChatMessage::Ptr msg)
 {
-    chatWidget->insertChatlineAtBottom(std::static_pointer_cast<ChatLine>(msg));
+    chatWidget->insertChatlineAtBottom(msg);
     emit messageInserted();
 }
 
@@ -986,14 +990,12 @@ void GenericChatForm::searchInBegin(const QString& phrase, const ParameterSearch
 
 void GenericChatForm::onSearchUp(const QString& phrase, const ParameterSearch& parameter)
 {
-    auto result = chatLog.searchBackward(searchPos, phrase, parameter);
-    handleSearchResult(result, SearchDirection::Up);
+    chatLog.startSearch(searchPos, phrase, parameter, SearchDirection::Up);
 }
 
 void GenericChatForm::onSearchDown(const QString& phrase, const ParameterSearch& parameter)
 {
-    auto result = chatLog.searchForward(searchPos, phrase, parameter);
-    handleSearchResult(result, SearchDirection::Down);
+    chatLog.startSearch(searchPos, phrase, parameter, SearchDirection::Down);
 }
 
 void GenericChatForm::handleSearchResult(SearchResult result, SearchDirection direction)
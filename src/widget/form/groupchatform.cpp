@@ -163,7 +163,11 @@ void GroupChatForm::onAttachClicked()
 }
 
 /**
- * @brief Updates user names' labels at the top of group chat
+ * @brief Rebuilds all user names' labels at the top of group chat
+ *
+ * Only needed when the whole list may be affected, e.g. the blacklist
+ * changed; single joins, leaves and renames go through the diff helpers
+ * below so the cost tracks the churn, not the group size.
  */
 void GroupChatForm::updateUserNames()
 {
@@ -185,30 +189,8 @@ void GroupChatForm::updateUserNames()
     /* we store the peer labels by their ToxPk, but the namelist layout
      * needs it in alphabetical order, so we first create and store the labels
      * and then sort them by their text and add them to the layout in that order */
-    const auto selfPk = Core::getInstance()->getSelfPublicKey();
     for (const auto& peerPk : peers.keys()) {
-        const QString peerName = peers.value(peerPk);
-        const QString editedName = editName(peerName);
-        QLabel* const label = new QLabel(editedName + QLatin1String(", "));
-        if (editedName != peerName) {
-            label->setToolTip(peerName + " (" + peerPk.toString() + ")");
-        } else if (peerName != peerPk.toString()) {
-            label->setToolTip(peerPk.toString());
-        } // else their name is just their Pk, no tooltip needed
-        label->setTextFormat(Qt::PlainText);
-        label->setContextMenuPolicy(Qt::CustomContextMenu);
-
-        const Settings& s = Settings::getInstance();
-        connect(label, &QLabel::customContextMenuRequested, this, &GroupChatForm::onLabelContextMenuRequested);
-
-        if (peerPk == selfPk) {
-            label->setProperty("peerType", LABEL_PEER_TYPE_OUR);
-        } else if (s.getBlackList().contains(peerPk.toString())) {
-            label->setProperty("peerType", LABEL_PEER_TYPE_MUTED);
-        }
-
-        label->setStyleSheet(Style::getStylesheet(PEER_LABEL_STYLE_SHEET_PATH));
-        peerLabels.insert(peerPk, label);
+        peerLabels.insert(peerPk, createPeerLabel(peerPk, peers.value(peerPk)));
     }
 
     if (netcam != nullptr) {
@@ -223,32 +205,132 @@ void GroupChatForm::updateUserNames()
         return a->text().toLower() < b->text().toLower();
     });
 
-    // remove comma from last sorted label
-    QLabel* const lastLabel = nickLabelList.last();
-    QString labelText = lastLabel->text();
-    labelText.chop(2);
-    lastLabel->setText(labelText);
     for (QLabel* l : nickLabelList) {
         namesListLayout->addWidget(l);
     }
+
+    updatePeerSeparators();
+}
+
+QLabel* GroupChatForm::createPeerLabel(const ToxPk& peerPk, const QString& peerName)
+{
+    const QString editedName = editName(peerName);
+    QLabel* const label = new QLabel(editedName + QLatin1String(", "));
+    if (editedName != peerName) {
+        label->setToolTip(peerName + " (" + peerPk.toString() + ")");
+    } else if (peerName != peerPk.toString()) {
+        label->setToolTip(peerPk.toString());
+    } // else their name is just their Pk, no tooltip needed
+    label->setTextFormat(Qt::PlainText);
+    label->setContextMenuPolicy(Qt::CustomContextMenu);
+
+    connect(label, &QLabel::customContextMenuRequested, this, &GroupChatForm::onLabelContextMenuRequested);
+
+    const Settings& s = Settings::getInstance();
+    if (peerPk == Core::getInstance()->getSelfPublicKey()) {
+        label->setProperty("peerType", LABEL_PEER_TYPE_OUR);
+    } else if (s.getBlackList().contains(peerPk.toString())) {
+        label->setProperty("peerType", LABEL_PEER_TYPE_MUTED);
+    }
+
+    label->setStyleSheet(Style::getStylesheet(PEER_LABEL_STYLE_SHEET_PATH));
+    return label;
+}
+
+/**
+ * @brief Inserts one peer label at its alphabetical position
+ *
+ * A pre-existing label for the peer is replaced, which makes this double as
+ * the rename path.
+ */
+void GroupChatForm::addPeerLabel(const ToxPk& peerPk, const QString& peerName)
+{
+    if (peerLabels.contains(peerPk)) {
+        removePeerLabel(peerPk);
+    }
+
+    QLabel* const label = createPeerLabel(peerPk, peerName);
+
+    const QString key = label->text().toLower();
+    int index = 0;
+    for (; index < namesListLayout->count(); ++index) {
+        QLabel* const other = qobject_cast<QLabel*>(namesListLayout->itemAt(index)->widget());
+        if (other == nullptr)
+            continue;
+
+        // the current last label had its separator chopped; compare as if it
+        // were still there so the order matches a full rebuild
+        QString otherKey = other->text().toLower();
+        if (!otherKey.endsWith(QLatin1String(", ")))
+            otherKey += QLatin1String(", ");
+
+        if (key < otherKey)
+            break;
+    }
+
+    namesListLayout->insertWidget(index, label);
+    peerLabels.insert(peerPk, label);
+    updatePeerSeparators();
+}
+
+void GroupChatForm::removePeerLabel(const ToxPk& peerPk)
+{
+    QLabel* const label = peerLabels.take(peerPk);
+    if (label == nullptr) {
+        return;
+    }
+
+    namesListLayout->removeWidget(label);
+    label->hide();
+    delete label;
+    updatePeerSeparators();
+}
+
+/**
+ * @brief Keeps the ", " separator on every label but the last
+ *
+ * After a diff only the old and the new last label can be out of shape;
+ * the walk is over all labels but setText only fires for those two.
+ */
+void GroupChatForm::updatePeerSeparators()
+{
+    const int count = namesListLayout->count();
+    for (int i = 0; i < count; ++i) {
+        QLabel* const label = qobject_cast<QLabel*>(namesListLayout->itemAt(i)->widget());
+        if (label == nullptr)
+            continue;
+
+        QString text = label->text();
+        const bool hasSeparator = text.endsWith(QLatin1String(", "));
+        if (i == count - 1 && hasSeparator) {
+            text.chop(2);
+            label->setText(text);
+        } else if (i != count - 1 && !hasSeparator) {
+            label->setText(text + QLatin1String(", "));
+        }
+    }
 }
 
 void GroupChatForm::onUserJoined(const ToxPk& user, const QString& name)
 {
     addSystemInfoMessage(tr("%1 has joined the group").arg(name), ChatMessage::INFO, QDateTime::currentDateTime());
-    updateUserNames();
+    addPeerLabel(user, name);
 }
 
 void GroupChatForm::onUserLeft(const ToxPk& user, const QString& name)
 {
     addSystemInfoMessage(tr("%1 has left the group").arg(name), ChatMessage::INFO, QDateTime::currentDateTime());
-    updateUserNames();
+    removePeerLabel(user);
+
+    if (netcam != nullptr) {
+        static_cast<GroupNetCamView*>(netcam)->removePeer(user);
+    }
 }
 
 void GroupChatForm::onPeerNameChanged(const ToxPk& peer, const QString& oldName, const QString& newName)
 {
     addSystemInfoMessage(tr("%1 is now known as %2").arg(oldName, newName), ChatMessage::INFO, QDateTime::currentDateTime());
-    updateUserNames();
+    addPeerLabel(peer, newName);
 }
 
 void GroupChatForm::peerAudioPlaying(ToxPk peerPk)
@@ -68,6 +68,10 @@ private:
     void retranslateUi();
     void updateUserCount(int numPeers);
     void updateUserNames();
+    QLabel* createPeerLabel(const ToxPk& peerPk, const QString& peerName);
+    void addPeerLabel(const ToxPk& peerPk, const QString& peerName);
+    void removePeerLabel(const ToxPk& peerPk);
+    void updatePeerSeparators();
     void leaveGroupCall();
 
 private:
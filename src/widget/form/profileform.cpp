@@ -42,6 +42,7 @@
 #include <QGroupBox>
 #include <QImageReader>
 #include <QInputDialog>
+#include <QProgressDialog>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMap>
@@ -456,7 +457,7 @@ void ProfileForm::onDeletePassClicked()
         return;
     }
 
-    if (!profileInfo->deletePassword()) {
+    if (!changePassword(QString{})) {
         GUI::showInfo(CAN_NOT_CHANGE_PASSWORD.first, CAN_NOT_CHANGE_PASSWORD.second);
     }
 }
@@ -469,12 +470,35 @@ void ProfileForm::onChangePassClicked()
         return;
     }
 
-    QString newPass = dialog->getPassword();
-    if (!profileInfo->setPassword(newPass)) {
+    if (!changePassword(dialog->getPassword())) {
         GUI::showInfo(CAN_NOT_CHANGE_PASSWORD.first, CAN_NOT_CHANGE_PASSWORD.second);
     }
 }
 
+/**
+ * @brief Applies a password change with progress feedback over the rekey.
+ *
+ * Re-encrypting the history database can take minutes on large profiles;
+ * the database worker reports progress while the event loop keeps running
+ * underneath, so the dialog repaints instead of the whole app freezing. The
+ * modal dialog keeps user input out for the duration.
+ */
+bool ProfileForm::changePassword(const QString& newPassword)
+{
+    QProgressDialog progress(tr("Re-encrypting your chat history…"), QString{}, 0, 100, this);
+    progress.setWindowModality(Qt::ApplicationModal);
+    // quick rekeys of small databases shouldn't flash a dialog
+    progress.setMinimumDuration(500);
+
+    const auto conn = connect(profileInfo, &IProfileInfo::rekeyProgressChanged, &progress,
+                              &QProgressDialog::setValue);
+    const bool ok = newPassword.isEmpty() ? profileInfo->deletePassword()
+                                          : profileInfo->setPassword(newPassword);
+    disconnect(conn);
+    progress.setValue(progress.maximum());
+    return ok;
+}
+
 void ProfileForm::retranslateUi()
 {
     bodyUI->retranslateUi(this);
@@ -83,6 +83,7 @@ private slots:
     void onRegisterButtonClicked();
 
 private:
+    bool changePassword(const QString& newPassword);
     void showExistingToxme();
     void retranslateUi();
     void prFileLabelUpdate();
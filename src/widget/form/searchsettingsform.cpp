@@ -95,8 +95,8 @@ ParameterSearch SearchSettingsForm::getParameterSearch()
 
 void SearchSettingsForm::reloadTheme()
 {
-    ui->choiceDateButton->setStyleSheet(Style::getStylesheet(QStringLiteral("chatForm/buttons.css")));
-    ui->startDateLabel->setStyleSheet(Style::getStylesheet(QStringLiteral("chatForm/labels.css")));
+    Style::setStylesheet(ui->choiceDateButton, QStringLiteral("chatForm/buttons.css"));
+    Style::setStylesheet(ui->startDateLabel, QStringLiteral("chatForm/labels.css"));
 }
 
 void SearchSettingsForm::updateStartDateLabel()
@@ -33,8 +33,10 @@
 #include "src/model/status.h"
 #include "src/persistence/profile.h"
 #include "src/persistence/settings.h"
+#include "src/util/memoryregistry.h"
 #include "src/widget/gui.h"
 #include "src/widget/tool/recursivesignalblocker.h"
+#include "src/widget/tool/stallwatchdog.h"
 #include "src/widget/translator.h"
 
 /**
@@ -56,6 +58,7 @@ AdvancedForm::AdvancedForm()
     Settings& s = Settings::getInstance();
     bodyUI->cbEnableIPv6->setChecked(s.getEnableIPv6());
     bodyUI->cbMakeToxPortable->setChecked(Settings::getInstance().getMakeToxPortable());
+    bodyUI->cbUseOpenGLChatView->setChecked(s.getUseOpenGLChatView());
     bodyUI->proxyAddr->setText(s.getProxyAddr());
     quint16 port = s.getProxyPort();
     if (port > 0) {
@@ -84,6 +87,14 @@ AdvancedForm::AdvancedForm()
 
     bodyUI->warningLabel->setText(warning);
 
+    StallWatchdog& watchdog = StallWatchdog::getInstance();
+    bodyUI->stallThreshold->setValue(watchdog.getThreshold());
+    // queued, the signal is emitted from inside the watchdog's event filter
+    connect(&watchdog, &StallWatchdog::stallRecorded, this, &AdvancedForm::refreshStallLog,
+            Qt::QueuedConnection);
+    refreshStallLog();
+    bodyUI->memoryLog->setPlainText(MemoryRegistry::snapshot().join(QLatin1Char('\n')));
+
     eventsInit();
     Translator::registerHandler(std::bind(&AdvancedForm::retranslateUi, this), this);
 }
@@ -98,6 +109,11 @@ void AdvancedForm::on_cbMakeToxPortable_stateChanged()
 {
     Settings::getInstance().setMakeToxPortable(bodyUI->cbMakeToxPortable->isChecked());
 }
+
+void AdvancedForm::on_cbUseOpenGLChatView_stateChanged()
+{
+    Settings::getInstance().setUseOpenGLChatView(bodyUI->cbUseOpenGLChatView->isChecked());
+}
 void AdvancedForm::on_btnExportLog_clicked()
 {
     QString savefile =
@@ -155,6 +171,36 @@ void AdvancedForm::on_btnCopyDebug_clicked()
     }
 }
 
+void AdvancedForm::on_stallThreshold_valueChanged(int ms)
+{
+    StallWatchdog::getInstance().setThreshold(ms);
+}
+
+void AdvancedForm::on_btnRefreshMemory_clicked()
+{
+    bodyUI->memoryLog->setPlainText(MemoryRegistry::snapshot().join(QLatin1Char('\n')));
+    // mirror into the log, so exported debug logs carry the figures too
+    MemoryRegistry::dumpToLog();
+}
+
+/**
+ * @brief Rebuilds the UI freeze log from the watchdog's ring buffer, newest first.
+ */
+void AdvancedForm::refreshStallLog()
+{
+    const QVector<StallWatchdog::Stall> stalls = StallWatchdog::getInstance().recentStalls();
+
+    QStringList lines;
+    for (const StallWatchdog::Stall& stall : stalls) {
+        lines.prepend(QString("%1  %2 ms  %3")
+                          .arg(stall.when.time().toString("HH:mm:ss.zzz"))
+                          .arg(stall.durationMs)
+                          .arg(stall.context));
+    }
+
+    bodyUI->stallLog->setPlainText(lines.join(QLatin1Char('\n')));
+}
+
 void AdvancedForm::on_resetButton_clicked()
 {
     const QString titile = tr("Reset settings");
@@ -42,10 +42,14 @@ public:
 private slots:
     // Portable
     void on_cbMakeToxPortable_stateChanged();
+    void on_cbUseOpenGLChatView_stateChanged();
     void on_resetButton_clicked();
     // Debug
     void on_btnCopyDebug_clicked();
     void on_btnExportLog_clicked();
+    void on_stallThreshold_valueChanged(int ms);
+    void on_btnRefreshMemory_clicked();
+    void refreshStallLog();
     // Connection
     void on_cbEnableIPv6_stateChanged();
     void on_cbEnableUDP_stateChanged();
@@ -26,6 +26,7 @@
 #include <QDesktopWidget>
 #include <QScreen>
 #include <QShowEvent>
+#include <QtConcurrent/QtConcurrent>
 
 #include "src/audio/audio.h"
 #include "src/audio/iaudiosettings.h"
@@ -44,6 +45,13 @@
 #define ALC_ALL_DEVICES_SPECIFIER ALC_DEVICE_SPECIFIER
 #endif
 
+namespace {
+// last-known-good device lists, shown immediately when the audio tab opens
+// while the worker re-enumerates in the background
+QStringList lastAudioInDevices;
+QStringList lastAudioOutDevices;
+} // namespace
+
 AVForm::AVForm(IAudioControl& audio, CoreAV* coreAV, CameraSource& camera,
                IAudioSettings* audioSettings, IVideoSettings* videoSettings)
     : GenericForm(QPixmap(":/img/settings/av.png"))
@@ -68,6 +76,10 @@ AVForm::AVForm(IAudioControl& audio, CoreAV* coreAV, CameraSource& camera,
     cbEnableBackend2->setChecked(audioSettings->getEnableBackend2());
 
     connect(rescanButton, &QPushButton::clicked, this, &AVForm::rescanDevices);
+    connect(&videoDeviceWatcher, &QFutureWatcher<QVector<QPair<QString, QString>>>::finished,
+            this, &AVForm::onVideoDeviceListReady);
+    connect(&audioDeviceWatcher, &QFutureWatcher<QPair<QStringList, QStringList>>::finished, this,
+            &AVForm::onAudioDeviceListReady);
 
     playbackSlider->setTracking(false);
     playbackSlider->setMaximum(totalSliderSteps);
@@ -476,10 +488,35 @@ void AVForm::on_audioQualityComboBox_currentIndexChanged(int index)
 }
 
 void AVForm::getVideoDevices()
+{
+    if (videoDeviceWatcher.isRunning()) {
+        return;
+    }
+
+    // Enumerating devices probes hardware and used to block the GUI for
+    // seconds while the settings page opened. Run it in the background and
+    // fill the combo boxes in onVideoDeviceListReady() when it's done; the
+    // modes of the device we're about to select are probed along the way so
+    // the subsequent updateVideoModes() answers from the cache.
+    const QString settingsInDev = videoSettings->getVideoDev();
+    videoDeviceWatcher.setFuture(QtConcurrent::run([settingsInDev]() {
+        QVector<QPair<QString, QString>> devices = CameraDevice::getDeviceList();
+        for (const QPair<QString, QString>& device : devices) {
+            if (device.first == settingsInDev) {
+                CameraDevice::getVideoModes(device.first);
+                break;
+            }
+        }
+
+        return devices;
+    }));
+}
+
+void AVForm::onVideoDeviceListReady()
 {
     QString settingsInDev = videoSettings->getVideoDev();
     int videoDevIndex = 0;
-    videoDeviceList = CameraDevice::getDeviceList();
+    videoDeviceList = videoDeviceWatcher.result();
     // prevent currentIndexChanged to be fired while adding items
     videoDevCombobox->blockSignals(true);
     videoDevCombobox->clear();
@@ -499,9 +536,23 @@ int AVForm::getModeSize(VideoMode mode)
 }
 
 void AVForm::getAudioInDevices()
+{
+    // show the last known device list right away; the fresh enumeration
+    // replaces it in place once the worker answers
+    fillAudioInDevices(lastAudioInDevices);
+    refreshAudioDeviceLists();
+}
+
+void AVForm::getAudioOutDevices()
+{
+    fillAudioOutDevices(lastAudioOutDevices);
+    refreshAudioDeviceLists();
+}
+
+void AVForm::fillAudioInDevices(const QStringList& devices)
 {
     QStringList deviceNames;
-    deviceNames << tr("Disabled") << audio.inDeviceNames();
+    deviceNames << tr("Disabled") << devices;
 
     inDevCombobox->blockSignals(true);
     inDevCombobox->clear();
@@ -517,10 +568,10 @@ void AVForm::getAudioInDevices()
     inDevCombobox->setCurrentIndex(idx);
 }
 
-void AVForm::getAudioOutDevices()
+void AVForm::fillAudioOutDevices(const QStringList& devices)
 {
     QStringList deviceNames;
-    deviceNames << tr("Disabled") << audio.outDeviceNames();
+    deviceNames << tr("Disabled") << devices;
 
     outDevCombobox->blockSignals(true);
     outDevCombobox->clear();
@@ -536,6 +587,34 @@ void AVForm::getAudioOutDevices()
     outDevCombobox->setCurrentIndex(idx);
 }
 
+/**
+ * @brief Enumerates the audio devices on a worker thread.
+ *
+ * Some ALSA/Pulse setups take seconds to answer, so the settings page never
+ * asks the backend directly; onAudioDeviceListReady() refreshes the combo
+ * boxes and the cached snapshot when the answer arrives.
+ */
+void AVForm::refreshAudioDeviceLists()
+{
+    if (audioDeviceWatcher.isRunning()) {
+        return;
+    }
+
+    IAudioControl* audioControl = &audio;
+    audioDeviceWatcher.setFuture(QtConcurrent::run([audioControl]() {
+        return qMakePair(audioControl->inDeviceNames(), audioControl->outDeviceNames());
+    }));
+}
+
+void AVForm::onAudioDeviceListReady()
+{
+    const QPair<QStringList, QStringList> result = audioDeviceWatcher.result();
+    lastAudioInDevices = result.first;
+    lastAudioOutDevices = result.second;
+    fillAudioInDevices(result.first);
+    fillAudioOutDevices(result.second);
+}
+
 void AVForm::on_inDevCombobox_currentIndexChanged(int deviceIndex)
 {
     const bool inputEnabled = deviceIndex > 0;
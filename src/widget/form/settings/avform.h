@@ -20,6 +20,7 @@
 #ifndef AVFORM_H
 #define AVFORM_H
 
+#include <QFutureWatcher>
 #include <QList>
 #include <QObject>
 #include <QString>
@@ -53,6 +54,9 @@ public:
 private:
     void getAudioInDevices();
     void getAudioOutDevices();
+    void fillAudioInDevices(const QStringList& devices);
+    void fillAudioOutDevices(const QStringList& devices);
+    void refreshAudioDeviceLists();
     void getVideoDevices();
 
     static int getModeSize(VideoMode mode);
@@ -83,6 +87,7 @@ private slots:
 
     void rescanDevices();
     void setVolume(float value);
+    void onVideoDeviceListReady();
 
     void on_cbEnableBackend2_stateChanged();
 
@@ -96,6 +101,7 @@ private:
     int getStepsFromValue(qreal val, qreal valMin, qreal valMax);
     qreal getValueFromSteps(int steps, qreal valMin, qreal valMax);
     void trackNewScreenGeometry(QScreen* qScreen);
+    void onAudioDeviceListReady();
 
 private:
     IAudioControl& audio;
@@ -110,6 +116,10 @@ private:
     CameraSource& camera;
     QVector<QPair<QString, QString>> videoDeviceList;
     QVector<VideoMode> videoModes;
+    // runs the device probing off the GUI thread, see getVideoDevices()
+    QFutureWatcher<QVector<QPair<QString, QString>>> videoDeviceWatcher;
+    // same for the audio backends, see refreshAudioDeviceLists()
+    QFutureWatcher<QPair<QStringList, QStringList>> audioDeviceWatcher;
     uint alSource;
     const uint totalSliderSteps = 100; // arbitrary number of steps to give slider a good "feel"
 };
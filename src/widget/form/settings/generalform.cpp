@@ -186,7 +186,7 @@ void GeneralForm::on_cbSpellChecking_stateChanged()
 void GeneralForm::on_showSystemTray_stateChanged()
 {
     Settings::getInstance().setShowSystemTray(bodyUI->showSystemTray->isChecked());
-    Settings::getInstance().saveGlobal();
+    Settings::getInstance().scheduleSaveGlobal();
 }
 
 void GeneralForm::on_startInTray_stateChanged()
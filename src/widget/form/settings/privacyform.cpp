@@ -29,6 +29,7 @@
 #include "src/persistence/history.h"
 #include "src/persistence/profile.h"
 #include "src/persistence/settings.h"
+#include "src/util/asynctask.h"
 #include "src/widget/form/setpassworddialog.h"
 #include "src/widget/form/settingswidget.h"
 #include "src/widget/gui.h"
@@ -66,7 +67,15 @@ void PrivacyForm::on_cbKeepHistory_stateChanged()
                                   tr("Do you want to permanently delete all chat history?"),
                                   QMessageBox::Yes | QMessageBox::No);
         if (dialogDelHistory == QMessageBox::Yes) {
-            Nexus::getProfile()->getHistory()->eraseHistory();
+            // dropping every table and vacuuming takes a while on a large db;
+            // run it off the GUI thread, RawDatabase serializes the queries
+            History* history = Nexus::getProfile()->getHistory();
+            AsyncTask::runThen(this,
+                               [history] {
+                                   history->eraseHistory();
+                                   return true;
+                               },
+                               [](bool) { qDebug() << "Chat history erased"; });
         }
     }
 }
@@ -54,14 +54,15 @@ void FriendListLayout::init()
 
 void FriendListLayout::addFriendWidget(FriendWidget* w, Status::Status s)
 {
-    friendOfflineLayout.removeSortedWidget(w);
-    friendOnlineLayout.removeSortedWidget(w);
-
+    // only evict from the list the widget is leaving; a re-add within the
+    // same status list becomes an in-place move in addSortedWidget
     if (s == Status::Status::Offline) {
+        friendOnlineLayout.removeSortedWidget(w);
         friendOfflineLayout.addSortedWidget(w);
         return;
     }
 
+    friendOfflineLayout.removeSortedWidget(w);
     friendOnlineLayout.addSortedWidget(w);
 }
 
@@ -82,17 +83,21 @@ int FriendListLayout::indexOfFriendWidget(GenericChatItemWidget* widget, bool on
 
 void FriendListLayout::moveFriendWidgets(FriendListWidget* listWidget)
 {
+    // go through removeSortedWidget so the layouts' membership tracking
+    // stays in sync with the items
     while (!friendOnlineLayout.getLayout()->isEmpty()) {
-        QWidget* getWidget = friendOnlineLayout.getLayout()->takeAt(0)->widget();
+        QWidget* getWidget = friendOnlineLayout.getLayout()->itemAt(0)->widget();
 
         FriendWidget* friendWidget = qobject_cast<FriendWidget*>(getWidget);
+        friendOnlineLayout.removeSortedWidget(friendWidget);
         const Friend* f = friendWidget->getFriend();
         listWidget->moveWidget(friendWidget, f->getStatus(), true);
     }
     while (!friendOfflineLayout.getLayout()->isEmpty()) {
-        QWidget* getWidget = friendOfflineLayout.getLayout()->takeAt(0)->widget();
+        QWidget* getWidget = friendOfflineLayout.getLayout()->itemAt(0)->widget();
 
         FriendWidget* friendWidget = qobject_cast<FriendWidget*>(getWidget);
+        friendOfflineLayout.removeSortedWidget(friendWidget);
         const Friend* f = friendWidget->getFriend();
         listWidget->moveWidget(friendWidget, f->getStatus(), true);
     }
@@ -54,6 +54,12 @@ enum class Time
 
 static const int LAST_TIME = static_cast<int>(Time::Never);
 
+// Quiet period after which a burst of roster insertions is considered done.
+static const int BURST_QUIET_MS = 50;
+
+// Dirty rows accumulated within one frame are repainted together.
+static const int ROW_FLUSH_MS = 16;
+
 Time getTimeBucket(const QDateTime& date)
 {
     if (date == QDateTime()) {
@@ -121,6 +127,17 @@ FriendListWidget::FriendListWidget(Widget* parent, bool groupsOnTop)
     connect(dayTimer, &QTimer::timeout, this, &FriendListWidget::dayTimeout);
     dayTimer->start(timeUntilTomorrow());
 
+    // Friends arrive one queued signal at a time when a profile loads; see
+    // coalesceBurst().
+    burstTimer = new QTimer(this);
+    burstTimer->setSingleShot(true);
+    connect(burstTimer, &QTimer::timeout, this, &FriendListWidget::burstSettled);
+
+    // Rows marked dirty within one frame repaint together; see invalidateRow().
+    dirtyRowTimer = new QTimer(this);
+    dirtyRowTimer->setSingleShot(true);
+    connect(dirtyRowTimer, &QTimer::timeout, this, &FriendListWidget::flushDirtyRows);
+
     setAcceptDrops(true);
 }
 
@@ -292,6 +309,7 @@ FriendListWidget::SortingMode FriendListWidget::getMode() const
 
 void FriendListWidget::addGroupWidget(GroupWidget* widget)
 {
+    coalesceBurst();
     groupLayout.addSortedWidget(widget);
     Group* g = widget->getGroup();
     connect(g, &Group::titleChanged, [=](const QString& author, const QString& name) {
@@ -302,6 +320,7 @@ void FriendListWidget::addGroupWidget(GroupWidget* widget)
 
 void FriendListWidget::addFriendWidget(FriendWidget* w, Status::Status s, int circleIndex)
 {
+    coalesceBurst();
     CircleWidget* circleWidget = CircleWidget::getFromID(circleIndex);
     if (circleWidget == nullptr)
         moveWidget(w, s, true);
@@ -373,6 +392,10 @@ void FriendListWidget::removeCircleWidget(CircleWidget* widget)
 void FriendListWidget::searchChatrooms(const QString& searchString, bool hideOnline,
                                        bool hideOffline, bool hideGroups)
 {
+    // Every row the filter shows or hides invalidates the list layout, so the
+    // whole pass is applied as one batched visibility update.
+    setUpdatesEnabled(false);
+
     groupLayout.search(searchString, hideGroups);
     listLayout->searchChatrooms(searchString, hideOnline, hideOffline);
 
@@ -390,12 +413,16 @@ void FriendListWidget::searchChatrooms(const QString& searchString, bool hideOnl
             categoryWidget->setVisible(categoryWidget->hasChatrooms());
         }
     }
+
+    setUpdatesEnabled(true);
+    reDraw();
 }
 
 void FriendListWidget::renameGroupWidget(GroupWidget* groupWidget, const QString& newName)
 {
     groupLayout.removeSortedWidget(groupWidget);
     groupLayout.addSortedWidget(groupWidget);
+    invalidateRow(groupWidget);
 }
 
 void FriendListWidget::renameCircleWidget(CircleWidget* circleWidget, const QString& newName)
@@ -403,6 +430,7 @@ void FriendListWidget::renameCircleWidget(CircleWidget* circleWidget, const QStr
     circleLayout->removeSortedWidget(circleWidget);
     circleWidget->setName(newName);
     circleLayout->addSortedWidget(circleWidget);
+    invalidateRow(circleWidget);
 }
 
 void FriendListWidget::onFriendWidgetRenamed(FriendWidget* friendWidget)
@@ -425,6 +453,7 @@ void FriendListWidget::onFriendWidgetRenamed(FriendWidget* friendWidget)
             listLayout->addFriendWidget(friendWidget, status);
         }
     }
+    invalidateRow(friendWidget);
 }
 
 void FriendListWidget::onGroupchatPositionChanged(bool top)
@@ -608,13 +637,82 @@ void FriendListWidget::dropEvent(QDropEvent* event)
 void FriendListWidget::dayTimeout()
 {
     if (mode == SortingMode::Activity) {
-        setMode(SortingMode::Name);
-        setMode(SortingMode::Activity); // Refresh all.
+        rebucketFriends();
     }
 
     dayTimer->start(timeUntilTomorrow());
 }
 
+// Moves the friends whose activity bucket went stale overnight into their new
+// category in one pass. Rebuilding the whole activity layout for a date flip
+// caused a visible hitch on large friend lists.
+void FriendListWidget::rebucketFriends()
+{
+    // The month categories are labelled with concrete month names, which
+    // shift along with the current date.
+    QLocale ql(Settings::getInstance().getTranslation());
+    QDate today = QDate::currentDate();
+    for (int i = static_cast<int>(Time::Month1Ago); i <= static_cast<int>(Time::Month5Ago); ++i) {
+        QWidget* widget = activityLayout->itemAt(i)->widget();
+        CategoryWidget* categoryWidget = qobject_cast<CategoryWidget*>(widget);
+        int monthsAgo = i - static_cast<int>(Time::ThisMonth);
+        categoryWidget->setName(ql.monthName(today.addMonths(-monthsAgo).month()));
+    }
+
+    // Collect first: moving a widget while walking the layouts would shuffle
+    // the indices under the loop.
+    QVector<QPair<FriendWidget*, CategoryWidget*>> stale;
+    for (int i = 0; i < activityLayout->count(); ++i) {
+        QWidget* widget = activityLayout->itemAt(i)->widget();
+        CategoryWidget* categoryWidget = qobject_cast<CategoryWidget*>(widget);
+        for (QLayout* friends : {categoryWidget->friendOnlineLayout(), categoryWidget->friendOfflineLayout()}) {
+            for (int j = 0; j < friends->count(); ++j) {
+                FriendWidget* friendWidget = qobject_cast<FriendWidget*>(friends->itemAt(j)->widget());
+                if (friendWidget == nullptr)
+                    continue;
+
+                Time bucket = getTimeBucket(getActiveTimeFriend(friendWidget->getFriend()));
+                if (static_cast<int>(bucket) != i)
+                    stale.append({friendWidget, categoryWidget});
+            }
+        }
+    }
+
+    for (const auto& move : stale) {
+        FriendWidget* friendWidget = move.first;
+        const Friend* contact = friendWidget->getFriend();
+        move.second->removeFriendWidget(friendWidget, contact->getStatus());
+        getTimeCategoryWidget(contact)->addFriendWidget(friendWidget, contact->getStatus());
+        invalidateRow(friendWidget);
+    }
+
+    for (int i = 0; i < activityLayout->count(); ++i) {
+        QWidget* widget = activityLayout->itemAt(i)->widget();
+        CategoryWidget* categoryWidget = qobject_cast<CategoryWidget*>(widget);
+        categoryWidget->setVisible(categoryWidget->hasChatrooms());
+    }
+}
+
+// Suspends repaints while roster insertions arrive back to back. Loading a
+// profile delivers every friend and group as its own queued signal from the
+// core thread, and repainting the whole roster per insertion made startup
+// effectively quadratic in the contact count. Painting resumes in one pass
+// once the burst goes quiet.
+void FriendListWidget::coalesceBurst()
+{
+    if (!burstTimer->isActive()) {
+        setUpdatesEnabled(false);
+    }
+
+    burstTimer->start(BURST_QUIET_MS);
+}
+
+void FriendListWidget::burstSettled()
+{
+    setUpdatesEnabled(true);
+    reDraw();
+}
+
 void FriendListWidget::moveWidget(FriendWidget* widget, Status::Status s, bool add)
 {
     if (mode == SortingMode::Name) {
@@ -627,6 +725,7 @@ void FriendListWidget::moveWidget(FriendWidget* widget, Status::Status s, bool a
                 Settings::getInstance().setFriendCircleID(f->getPublicKey(), -1);
 
             listLayout->addFriendWidget(widget, s);
+            invalidateRow(widget);
             return;
         }
 
@@ -637,19 +736,70 @@ void FriendListWidget::moveWidget(FriendWidget* widget, Status::Status s, bool a
         categoryWidget->addFriendWidget(widget, contact->getStatus());
         categoryWidget->show();
     }
+    invalidateRow(widget);
 }
 
-void FriendListWidget::updateActivityTime(const QDateTime& time)
+// Moves a friend between activity categories after its activity date changed.
+// Touches at most the two affected categories; the rest of the list is left
+// alone.
+void FriendListWidget::friendActivityChanged(FriendWidget* widget, const QDateTime& oldTime)
 {
     if (mode != SortingMode::Activity)
         return;
 
-    int timeIndex = static_cast<int>(getTimeBucket(time));
-    QWidget* widget = activityLayout->itemAt(timeIndex)->widget();
-    CategoryWidget* categoryWidget = static_cast<CategoryWidget*>(widget);
-    categoryWidget->updateStatus();
+    const Friend* contact = widget->getFriend();
+    const Time oldBucket = getTimeBucket(oldTime);
+    const Time newBucket = getTimeBucket(getActiveTimeFriend(contact));
+    if (oldBucket == newBucket) {
+        // The date moved within one category; the order inside it is by name
+        // and does not change.
+        return;
+    }
+
+    QWidget* old = activityLayout->itemAt(static_cast<int>(oldBucket))->widget();
+    CategoryWidget* oldCategory = qobject_cast<CategoryWidget*>(old);
+    oldCategory->removeFriendWidget(widget, contact->getStatus());
+    oldCategory->setVisible(oldCategory->hasChatrooms());
 
-    categoryWidget->setVisible(categoryWidget->hasChatrooms());
+    CategoryWidget* newCategory = getTimeCategoryWidget(contact);
+    newCategory->addFriendWidget(widget, contact->getStatus());
+    newCategory->show();
+    invalidateRow(widget);
+}
+
+/**
+ * @brief Marks one row as needing a repaint, batched within a frame.
+ *
+ * reDraw() hides and re-shows the whole list, invalidating every row to
+ * refresh one. Status flips, renames, and sort moves only change the rows
+ * they touch, so those paths queue the affected rows here and one flush
+ * repaints exactly that set. Structural changes - mode switches, circles
+ * appearing or vanishing, search filtering - still take reDraw().
+ */
+void FriendListWidget::invalidateRow(QWidget* row)
+{
+    if (row == nullptr) {
+        return;
+    }
+
+    if (!dirtyRows.contains(row)) {
+        dirtyRows.append(row);
+    }
+
+    if (!dirtyRowTimer->isActive()) {
+        dirtyRowTimer->start(ROW_FLUSH_MS);
+    }
+}
+
+void FriendListWidget::flushDirtyRows()
+{
+    for (const auto& row : dirtyRows) {
+        // a row can be deleted between the mark and the flush
+        if (!row.isNull()) {
+            row->update();
+        }
+    }
+    dirtyRows.clear();
 }
 
 // update widget after add/delete/hide/show
@@ -24,6 +24,7 @@
 #include "src/core/core.h"
 #include "src/model/status.h"
 #include "src/persistence/settings.h"
+#include <QPointer>
 #include <QWidget>
 
 class QVBoxLayout;
@@ -60,7 +61,8 @@ public:
 
     void cycleContacts(GenericChatroomWidget* activeChatroomWidget, bool forward);
 
-    void updateActivityTime(const QDateTime& date);
+    void friendActivityChanged(FriendWidget* widget, const QDateTime& oldTime);
+    void invalidateRow(QWidget* row);
     void reDraw();
 
 signals:
@@ -81,13 +83,17 @@ protected:
 
 private slots:
     void dayTimeout();
+    void burstSettled();
+    void flushDirtyRows();
 
 private:
+    void coalesceBurst();
     CircleWidget* createCircleWidget(int id = -1);
     QLayout* nextLayout(QLayout* layout, bool forward) const;
     void moveFriends(QLayout* layout);
     CategoryWidget* getTimeCategoryWidget(const Friend* frd) const;
     void sortByMode(SortingMode mode);
+    void rebucketFriends();
 
     SortingMode mode;
     bool groupsOnTop;
@@ -96,6 +102,10 @@ private:
     GenericChatItemLayout groupLayout;
     QVBoxLayout* activityLayout = nullptr;
     QTimer* dayTimer;
+    QTimer* burstTimer;
+    // rows waiting for the batched repaint, see invalidateRow()
+    QVector<QPointer<QWidget>> dirtyRows;
+    QTimer* dirtyRowTimer;
 };
 
 #endif // FRIENDLISTWIDGET_H
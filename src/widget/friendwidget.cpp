@@ -32,6 +32,8 @@
 #include "src/model/group.h"
 #include "src/model/status.h"
 #include "src/persistence/settings.h"
+#include "src/nexus.h"
+#include "src/persistence/profile.h"
 #include "src/widget/about/aboutfriendform.h"
 #include "src/widget/form/chatform.h"
 #include "src/widget/style.h"
@@ -47,6 +49,7 @@
 #include <QInputDialog>
 #include <QMenu>
 #include <QMimeData>
+#include <QTimer>
 
 #include <cassert>
 
@@ -63,7 +66,7 @@ FriendWidget::FriendWidget(std::shared_ptr<FriendChatroom> chatroom, bool compac
     , isDefaultAvatar{true}
 {
     avatar->setPixmap(QPixmap(":/img/contact.svg"));
-    statusPic.setPixmap(QPixmap(Status::getIconPath(Status::Status::Offline)));
+    statusPic.setPixmap(Status::getIconPixmap(Status::Status::Offline));
     statusPic.setMargin(3);
 
     auto frnd = chatroom->getFriend();
@@ -258,7 +261,7 @@ void FriendWidget::moveToCircle(int newCircleId)
         newCircleWidget->addFriendWidget(this, frnd->getStatus());
         newCircleWidget->setExpanded(true);
         emit searchCircle(*newCircleWidget);
-        s.savePersonal();
+        s.scheduleSavePersonal();
     } else {
         s.setFriendCircleID(pk, newCircleId);
     }
@@ -316,7 +319,7 @@ void FriendWidget::updateStatusLight()
 {
     const auto frnd = chatroom->getFriend();
     const bool event = frnd->getEventFlag();
-    statusPic.setPixmap(QPixmap(Status::getIconPath(frnd->getStatus(), event)));
+    statusPic.setPixmap(Status::getIconPixmap(frnd->getStatus(), event));
 
     if (event) {
         const Settings& s = Settings::getInstance();
@@ -399,6 +402,28 @@ void FriendWidget::onAvatarRemoved(const ToxPk& friendPk)
     avatar->setPixmap(QPixmap(path));
 }
 
+/**
+ * @brief Requests this friend's avatar the first time the row is painted.
+ *
+ * Rows outside the viewport never paint, so startup avatar disk reads
+ * scale with what's on screen instead of with the roster size.
+ */
+void FriendWidget::paintEvent(QPaintEvent* ev)
+{
+    if (!avatarLoadRequested) {
+        avatarLoadRequested = true;
+        // defer the disk read out of the paint pass
+        QTimer::singleShot(0, this, [this] {
+            const QPixmap pic = Nexus::getProfile()->loadAvatar(chatroom->getFriend()->getPublicKey());
+            if (isDefaultAvatar && !pic.isNull()) {
+                isDefaultAvatar = false;
+                avatar->setPixmap(pic);
+            }
+        });
+    }
+    GenericChatroomWidget::paintEvent(ev);
+}
+
 void FriendWidget::mousePressEvent(QMouseEvent* ev)
 {
     if (ev->button() == Qt::LeftButton) {
@@ -66,6 +66,7 @@ public slots:
 protected:
     virtual void mousePressEvent(QMouseEvent* ev) override;
     virtual void mouseMoveEvent(QMouseEvent* ev) override;
+    virtual void paintEvent(QPaintEvent* ev) override;
     void setFriendAlias();
 
 private slots:
@@ -79,6 +80,9 @@ private slots:
 public:
     std::shared_ptr<FriendChatroom> chatroom;
     bool isDefaultAvatar;
+
+private:
+    bool avatarLoadRequested = false;
 };
 
 #endif // FRIENDWIDGET_H
@@ -41,51 +41,82 @@ GenericChatItemLayout::~GenericChatItemLayout()
 void GenericChatItemLayout::addSortedWidget(GenericChatItemWidget* widget, int stretch,
                                             Qt::Alignment alignment)
 {
+    // a second layout item for the same widget corrupts the ordering, so a
+    // re-add (e.g. after a rename) is a targeted move instead
+    if (slots.contains(widget)) {
+        moveSortedWidget(widget);
+        return;
+    }
+
     int closest = indexOfClosestSortedWidget(widget);
     layout->insertWidget(closest, widget, stretch, alignment);
+    shiftSlots(closest, 1);
+    slots.insert(widget, closest);
 }
 
-int GenericChatItemLayout::indexOfSortedWidget(GenericChatItemWidget* widget) const
+/**
+ * @brief Repositions a member whose sort key may have changed.
+ *
+ * Re-adding used to mean remove-and-insert, which detaches the widget from
+ * layout management and forces two relayouts of every row. Instead the
+ * neighbours are checked first - a key change that didn't cross either of
+ * them leaves the layout completely untouched - and an actual move
+ * transplants the existing layout item, costing a single relayout.
+ */
+void GenericChatItemLayout::moveSortedWidget(GenericChatItemWidget* widget)
 {
-    if (layout->isEmpty())
-        return -1;
-
-    int index = indexOfClosestSortedWidget(widget);
-
-    if (index >= layout->count())
-        return -1;
-
-    GenericChatItemWidget* atMid =
-        qobject_cast<GenericChatItemWidget*>(layout->itemAt(index)->widget());
-    assert(atMid != nullptr);
+    // the binary probe can't locate it - the widget may no longer sit where
+    // its new key sorts to - but the slot mirror always can
+    const int current = slots.value(widget, -1);
+    assert(current >= 0);
+
+    const auto widgetAt = [this](int index) {
+        return qobject_cast<GenericChatItemWidget*>(layout->itemAt(index)->widget());
+    };
+
+    // still ordered against both neighbours? then there's nothing to do,
+    // which is the common case when a widget is re-added unchanged
+    const bool beforePrev = current == 0 || sortsBefore(widgetAt(current - 1), widget);
+    const bool beforeNext =
+        current == layout->count() - 1 || sortsBefore(widget, widgetAt(current + 1));
+    if (beforePrev && beforeNext)
+        return;
 
-    if (atMid == widget)
-        return index;
+    // the probe needs a fully sorted sequence, so take the item out first;
+    // reinserting the same item keeps the widget attached throughout
+    QLayoutItem* item = layout->takeAt(current);
+    shiftSlots(current + 1, -1);
+    const int target = indexOfClosestSortedWidget(widget);
+    layout->insertItem(target, item);
+    shiftSlots(target, 1);
+    slots.insert(widget, target);
+}
 
-    return -1;
+int GenericChatItemLayout::indexOfSortedWidget(GenericChatItemWidget* widget) const
+{
+    // the callers of this run per status event, so the position comes from
+    // the mirror; a binary probe would also miss any widget whose key
+    // changed since it was inserted
+    return slots.value(widget, -1);
 }
 
 bool GenericChatItemLayout::existsSortedWidget(GenericChatItemWidget* widget) const
 {
-    return indexOfSortedWidget(widget) != -1;
+    return slots.contains(widget);
 }
 
 void GenericChatItemLayout::removeSortedWidget(GenericChatItemWidget* widget)
 {
-    if (layout->isEmpty())
-        return;
-
-    int index = indexOfClosestSortedWidget(widget);
-
-    if (layout->itemAt(index) == nullptr)
+    // Membership can't be answered by the binary probe: a rename changes
+    // the sort key while the widget still sits at its old position, so the
+    // probe would miss it and a re-add would duplicate the layout item.
+    const int index = slots.value(widget, -1);
+    if (index < 0)
         return;
 
-    GenericChatItemWidget* atMid =
-        qobject_cast<GenericChatItemWidget*>(layout->itemAt(index)->widget());
-    assert(atMid != nullptr);
-
-    if (atMid == widget)
-        layout->removeWidget(widget);
+    slots.remove(widget);
+    layout->removeWidget(widget);
+    shiftSlots(index + 1, -1);
 }
 
 void GenericChatItemLayout::search(const QString& searchString, bool hideAll)
@@ -114,22 +145,42 @@ int GenericChatItemLayout::indexOfClosestSortedWidget(GenericChatItemWidget* wid
             qobject_cast<GenericChatItemWidget*>(layout->itemAt(mid)->widget());
         assert(atMid != nullptr);
 
-        bool lessThan = false;
-
-        QCollator collator;
-        collator.setNumericMode(true);
-
-        int compareValue = collator.compare(atMid->getName(), widget->getName());
-
-        if (compareValue < 0)
-            lessThan = true;
-        else if (compareValue == 0)
-            lessThan = atMid < widget; // Consistent ordering.
-
-        if (lessThan)
+        if (sortsBefore(atMid, widget))
             min = mid + 1;
         else
             max = mid;
     }
     return min;
 }
+
+/**
+ * @brief Renumbers mirror entries at or past @a from by @a delta.
+ *
+ * An insertion or removal shifts every widget behind it by one slot. The
+ * walk is linear, but so is what the layout itself does to its item list
+ * for the same operation, so mutations keep their cost class while every
+ * position lookup drops to a hash access.
+ */
+void GenericChatItemLayout::shiftSlots(int from, int delta)
+{
+    for (auto it = slots.begin(); it != slots.end(); ++it) {
+        if (it.value() >= from)
+            it.value() += delta;
+    }
+}
+
+bool GenericChatItemLayout::sortsBefore(GenericChatItemWidget* a, GenericChatItemWidget* b)
+{
+    // constructing a collator means initializing the locale machinery, way
+    // too expensive to redo for every probe of every insertion
+    static QCollator collator = []() {
+        QCollator c;
+        c.setNumericMode(true);
+        return c;
+    }();
+
+    const int compareValue = collator.compare(a->getName(), b->getName());
+    if (compareValue != 0)
+        return compareValue < 0;
+    return a < b; // Consistent ordering.
+}
@@ -20,6 +20,7 @@
 #ifndef GENERICCHATITEMLAYOUT_H
 #define GENERICCHATITEMLAYOUT_H
 
+#include <QHash>
 #include <Qt>
 
 class QLayout;
@@ -42,8 +43,15 @@ public:
     QLayout* getLayout() const;
 
 private:
+    void moveSortedWidget(GenericChatItemWidget* widget);
     int indexOfClosestSortedWidget(GenericChatItemWidget* widget) const;
+    void shiftSlots(int from, int delta);
+    static bool sortsBefore(GenericChatItemWidget* a, GenericChatItemWidget* b);
     QVBoxLayout* layout;
+    // position mirror of the layout: answers both membership and "which
+    // slot" in constant time, where the layout itself has to be scanned
+    // or probed. Kept exact on every add, move and remove.
+    QHash<GenericChatItemWidget*, int> slots;
 };
 
 #endif // GENERICCHATITEMLAYOUT_H
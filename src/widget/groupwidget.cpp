@@ -47,7 +47,7 @@ GroupWidget::GroupWidget(std::shared_ptr<GroupChatroom> chatroom, bool compact)
     , chatroom{chatroom}
 {
     avatar->setPixmap(Style::scaleSvgImage(":img/group.svg", avatar->width(), avatar->height()));
-    statusPic.setPixmap(QPixmap(Status::getIconPath(Status::Status::Online)));
+    statusPic.setPixmap(Status::getIconPixmap(Status::Status::Online));
     statusPic.setMargin(3);
 
     Group* g = chatroom->getGroup();
@@ -171,7 +171,7 @@ void GroupWidget::updateStatusLight()
     Group* g = chatroom->getGroup();
 
     const bool event = g->getEventFlag();
-    statusPic.setPixmap(QPixmap(Status::getIconPath(Status::Status::Online, event)));
+    statusPic.setPixmap(Status::getIconPixmap(Status::Status::Online, event));
     statusPic.setMargin(event ? 1 : 3);
 }
 
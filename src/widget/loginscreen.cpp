@@ -29,8 +29,53 @@
 #include "src/widget/translator.h"
 #include <QDebug>
 #include <QDialog>
+#include <QDir>
 #include <QMessageBox>
+#include <QSaveFile>
 #include <QToolButton>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+
+QString profileNamesCachePath()
+{
+    return Settings::getInstance().getAppCacheDirPath() + QStringLiteral("profiles.cache");
+}
+
+// The list shown while the real scan runs; stale entries are corrected once
+// the scan finishes.
+QStringList loadCachedProfileNames()
+{
+    QFile file{profileNamesCachePath()};
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return {};
+    }
+
+    QStringList names;
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (!line.isEmpty()) {
+            names.append(line);
+        }
+    }
+    return names;
+}
+
+void saveCachedProfileNames(const QStringList& names)
+{
+    QDir{}.mkpath(Settings::getInstance().getAppCacheDirPath());
+    QSaveFile file{profileNamesCachePath()};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Couldn't write profile name cache";
+        return;
+    }
+
+    file.write(names.join(QLatin1Char('\n')).toUtf8());
+    file.write("\n");
+    file.commit();
+}
+
+} // namespace
 
 LoginScreen::LoginScreen(const QString& initialProfileName, QWidget* parent)
     : QDialog(parent)
@@ -58,6 +103,8 @@ LoginScreen::LoginScreen(const QString& initialProfileName, QWidget* parent)
     connect(ui->newPassConfirm, &QLineEdit::textChanged, this, &LoginScreen::onPasswordEdited);
     connect(ui->autoLoginCB, &QCheckBox::stateChanged, this, &LoginScreen::onAutoLoginCheckboxChanged);
     connect(ui->importButton, &QPushButton::clicked, this, &LoginScreen::onImportProfile);
+    connect(&profileScanWatcher, &QFutureWatcher<QStringList>::finished, this,
+            &LoginScreen::onProfileScanFinished);
 
     reset(initialProfileName);
     this->setStyleSheet(Style::getStylesheet("loginScreen/loginScreen.css"));
@@ -92,22 +139,65 @@ void LoginScreen::reset(const QString& initialProfileName)
     ui->loginPassword->clear();
     ui->loginUsernames->clear();
 
-    QStringList allProfileNames = Profile::getAllProfileNames();
+    requestedProfileName = initialProfileName;
+
+    // Show the names found on the previous run right away; scanning the
+    // settings directory can take seconds on network home directories, so
+    // the real scan runs in the background and corrects the list when done.
+    populateProfiles(loadCachedProfileNames(), initialProfileName);
 
-    if (allProfileNames.isEmpty()) {
+    if (!profileScanWatcher.isRunning()) {
+        profileScanWatcher.setFuture(QtConcurrent::run(Profile::scanProfileNames));
+    }
+}
+
+void LoginScreen::populateProfiles(const QStringList& profileNames, const QString& selectedName)
+{
+    ui->loginUsernames->clear();
+
+    if (profileNames.isEmpty()) {
         ui->stackedWidget->setCurrentIndex(0);
         ui->newUsername->setFocus();
     } else {
-        for (const QString& profileName : allProfileNames) {
+        for (const QString& profileName : profileNames) {
             ui->loginUsernames->addItem(profileName);
         }
 
-        ui->loginUsernames->setCurrentText(initialProfileName);
+        ui->loginUsernames->setCurrentText(selectedName);
         ui->stackedWidget->setCurrentIndex(1);
         ui->loginPassword->setFocus();
     }
 }
 
+void LoginScreen::onProfileScanFinished()
+{
+    // Importing newly found profiles touches Settings, so it stays on the
+    // GUI thread; only the directory listing itself ran in the background.
+    const QStringList profileNames = Profile::registerProfiles(profileScanWatcher.result());
+    saveCachedProfileNames(profileNames);
+
+    QStringList shownNames;
+    for (int i = 0; i < ui->loginUsernames->count(); ++i) {
+        shownNames.append(ui->loginUsernames->itemText(i));
+    }
+
+    if (shownNames == profileNames) {
+        return;
+    }
+
+    // don't yank the page away from someone already typing a new profile name
+    const bool keepNewProfilePage =
+        ui->stackedWidget->currentIndex() == 0 && !ui->newUsername->text().isEmpty();
+
+    const QString currentName = ui->loginUsernames->currentText();
+    populateProfiles(profileNames, currentName.isEmpty() ? requestedProfileName : currentName);
+
+    if (keepNewProfilePage) {
+        ui->stackedWidget->setCurrentIndex(0);
+        ui->newUsername->setFocus();
+    }
+}
+
 void LoginScreen::onProfileLoaded()
 {
     done(0);
@@ -21,6 +21,7 @@
 #ifndef LOGINSCREEN_H
 #define LOGINSCREEN_H
 
+#include <QFutureWatcher>
 #include <QShortcut>
 #include <QToolButton>
 #include <QDialog>
@@ -66,9 +67,11 @@ private slots:
     void onCreateNewProfile();
     void onLogin();
     void onImportProfile();
+    void onProfileScanFinished();
 
 private:
     void reset(const QString& initialProfileName = QString());
+    void populateProfiles(const QStringList& profileNames, const QString& selectedName);
     void retranslateUi();
     void showCapsIndicator();
     void hideCapsIndicator();
@@ -77,6 +80,8 @@ private:
 private:
     Ui::LoginScreen* ui;
     QShortcut quitShortcut;
+    QFutureWatcher<QStringList> profileScanWatcher;
+    QString requestedProfileName;
 };
 
 #endif // LOGINSCREEN_H
@@ -19,6 +19,7 @@
 
 #include "maskablepixmapwidget.h"
 #include <QPainter>
+#include <QPixmapCache>
 #include <QStyle>
 
 /**
@@ -26,6 +27,33 @@
  * @brief pointer to dynamically call the constructor.
  */
 
+namespace {
+/**
+ * @brief Returns the source scaled to the given size, shared process-wide.
+ *
+ * Every avatar widget showing the same picture at the same size (friend list
+ * rows, dialog tabs, chat headers) gets one shared scaled pixmap through
+ * QPixmapCache instead of scaling and keeping its own copy. A changed avatar
+ * comes in as a new pixmap with a new cache key, so stale entries simply age
+ * out of the cache.
+ */
+QPixmap scaledShared(const QPixmap& source, int width, int height)
+{
+    const QString key = QStringLiteral("maskable:%1:%2x%3")
+                            .arg(source.cacheKey())
+                            .arg(width)
+                            .arg(height);
+
+    QPixmap scaled;
+    if (!QPixmapCache::find(key, &scaled)) {
+        scaled = source.scaled(width, height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        QPixmapCache::insert(key, scaled);
+    }
+
+    return scaled;
+}
+} // namespace
+
 MaskablePixmapWidget::MaskablePixmapWidget(QWidget* parent, QSize size, QString maskName)
     : QLabel("", parent)
     , renderTarget(nullptr)
@@ -58,9 +86,7 @@ void MaskablePixmapWidget::setPixmap(const QPixmap& pmap)
     }
 
     unscaled = pmap;
-    pixmap = pmap.scaled(width(), height(),
-                         Qt::KeepAspectRatio,
-                         Qt::SmoothTransformation);
+    pixmap = scaledShared(pmap, width(), height());
     updatePixmap();
     update();
 }
@@ -82,9 +108,7 @@ void MaskablePixmapWidget::setSize(QSize size)
     }
 
     if (!unscaled.isNull()) {
-        pixmap = unscaled.scaled(width(), height(),
-                                 Qt::KeepAspectRatio,
-                                 Qt::SmoothTransformation);
+        pixmap = scaledShared(unscaled, width(), height());
         updatePixmap();
         update();
     }
@@ -120,11 +120,11 @@ void SearchForm::insertEditor(const QString &text)
 
 void SearchForm::reloadTheme()
 {
-    settingsButton->setStyleSheet(Style::getStylesheet(QStringLiteral("chatForm/buttons.css")));
-    upButton->setStyleSheet(Style::getStylesheet(QStringLiteral("chatForm/buttons.css")));
-    downButton->setStyleSheet(Style::getStylesheet(QStringLiteral("chatForm/buttons.css")));
-    hideButton->setStyleSheet(Style::getStylesheet(QStringLiteral("chatForm/buttons.css")));
-    startButton->setStyleSheet(Style::getStylesheet(QStringLiteral("chatForm/buttons.css")));
+    Style::setStylesheet(settingsButton, QStringLiteral("chatForm/buttons.css"));
+    Style::setStylesheet(upButton, QStringLiteral("chatForm/buttons.css"));
+    Style::setStylesheet(downButton, QStringLiteral("chatForm/buttons.css"));
+    Style::setStylesheet(hideButton, QStringLiteral("chatForm/buttons.css"));
+    Style::setStylesheet(startButton, QStringLiteral("chatForm/buttons.css"));
 
     settings->reloadTheme();
 }
@@ -19,8 +19,11 @@
 
 #include "style.h"
 #include "src/persistence/settings.h"
+#include "src/util/resourcebundle.h"
 #include "src/widget/gui.h"
 
+#include <QCoreApplication>
+#include <QDataStream>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
@@ -28,6 +31,7 @@
 #include <QMap>
 #include <QPainter>
 #include <QRegularExpression>
+#include <QSaveFile>
 #include <QSettings>
 #include <QStandardPaths>
 #include <QStringBuilder>
@@ -67,6 +71,28 @@ namespace {
     const QLatin1Literal ThemeSubFolder{"themes/"};
     const QLatin1Literal BuiltinThemeDefaultPath{":themes/default/"};
     const QLatin1Literal BuiltinThemeDarkPath{":themes/dark/"};
+
+    // on-disk stylesheet cache
+    const quint32 StylesheetCacheMagic = 0x71535343; // "qSSC"
+    const quint16 StylesheetCacheVersion = 1;
+
+    bool stylesheetCacheLoaded = false;
+    bool stylesheetCacheDirty = false;
+
+    QString stylesheetCachePath()
+    {
+        return Settings::getInstance().getAppCacheDirPath() % QStringLiteral("stylesheets.cache");
+    }
+
+    // Everything a resolved stylesheet depends on besides its own cache key:
+    // the theme folder, the theme color and the shipped theme files (which
+    // only change with the binary).
+    QString stylesheetCacheToken()
+    {
+        return Style::getThemeFolder() % QLatin1Char('|')
+               % QString::number(Settings::getInstance().getThemeColor()) % QLatin1Char('|')
+               % QStringLiteral(GIT_VERSION);
+    }
 }
 
 // helper functions
@@ -161,6 +187,10 @@ std::map<std::pair<const QString, const QFont>, const QString> Style::stylesheet
 
 const QString Style::getStylesheet(const QString& filename, const QFont& baseFont)
 {
+    if (!stylesheetCacheLoaded) {
+        loadStylesheetCache();
+    }
+
     const QString fullPath = getThemeFolder() + filename;
     const std::pair<const QString, const QFont> cacheKey(fullPath, baseFont);
     auto it = stylesheetsCache.find(cacheKey);
@@ -172,9 +202,92 @@ const QString Style::getStylesheet(const QString& filename, const QFont& baseFon
     // cache miss, new styleSheet, read it from file and add to cache
     const QString newStylesheet = resolve(filename, baseFont);
     stylesheetsCache.insert(std::make_pair(cacheKey, newStylesheet));
+    stylesheetCacheDirty = true;
     return newStylesheet;
 }
 
+/**
+ * @brief Sets a widget's stylesheet only if it actually changed.
+ *
+ * Used by the reloadTheme() cascade: handing Qt the identical sheet again
+ * still triggers a full style recomputation of the widget subtree, which is
+ * where most of a theme reload's time went.
+ */
+void Style::setStylesheet(QWidget* w, const QString& filename, const QFont& baseFont)
+{
+    const QString stylesheet = getStylesheet(filename, baseFont);
+    if (w->styleSheet() != stylesheet) {
+        w->setStyleSheet(stylesheet);
+    }
+}
+
+/**
+ * @brief Fills the stylesheet cache from the previous run's resolved sheets.
+ *
+ * One read replaces re-reading and re-resolving every theme file at startup.
+ * The cache is dropped wholesale when its token (theme, theme color, binary
+ * version) doesn't match.
+ */
+void Style::loadStylesheetCache()
+{
+    stylesheetCacheLoaded = true;
+    qAddPostRoutine(saveStylesheetCache);
+
+    QFile file{stylesheetCachePath()};
+    if (!file.open(QFile::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream{&file};
+    quint32 magic;
+    quint16 version;
+    QString token;
+    stream >> magic >> version >> token;
+    if (stream.status() != QDataStream::Ok || magic != StylesheetCacheMagic
+        || version != StylesheetCacheVersion || token != stylesheetCacheToken()) {
+        return;
+    }
+
+    quint32 count;
+    stream >> count;
+    for (quint32 i = 0; i < count; ++i) {
+        QString fullPath;
+        QFont font;
+        QString stylesheet;
+        stream >> fullPath >> font >> stylesheet;
+        if (stream.status() != QDataStream::Ok) {
+            stylesheetsCache.clear();
+            return;
+        }
+
+        stylesheetsCache.emplace(std::make_pair(fullPath, font), stylesheet);
+    }
+}
+
+void Style::saveStylesheetCache()
+{
+    if (!stylesheetCacheDirty) {
+        return;
+    }
+
+    QDir{}.mkpath(Settings::getInstance().getAppCacheDirPath());
+    QSaveFile file{stylesheetCachePath()};
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << "Failed to write stylesheet cache" << stylesheetCachePath();
+        return;
+    }
+
+    QDataStream stream{&file};
+    stream << StylesheetCacheMagic << StylesheetCacheVersion << stylesheetCacheToken();
+    stream << static_cast<quint32>(stylesheetsCache.size());
+    for (const auto& entry : stylesheetsCache) {
+        stream << entry.first.first << entry.first.second << entry.second;
+    }
+
+    file.commit();
+    stylesheetCacheDirty = false;
+}
+
 static QStringList existingImagesCache;
 const QString Style::getImagePath(const QString& filename)
 {
@@ -330,6 +443,7 @@ void Style::repolish(QWidget* w)
 void Style::setThemeColor(int color)
 {
     stylesheetsCache.clear(); // clear stylesheet cache which includes color info
+    stylesheetCacheDirty = true; // the on-disk copy is keyed to the old color
     palette.clear();
     dictColor.clear();
     initPalette();
@@ -423,8 +537,13 @@ void Style::initDictColor()
 
 QString Style::getThemePath()
 {
+    // a few .ui files reference default-theme icons directly, so the default
+    // bundle is needed even when the dark theme is active
+    ResourceBundle::ensureRegistered(QStringLiteral("theme_default"));
+
     const int num = Settings::getInstance().getThemeColor();
     if (themeNameColors[num].type == Dark) {
+        ResourceBundle::ensureRegistered(QStringLiteral("theme_dark"));
         return BuiltinThemeDarkPath;
     }
 
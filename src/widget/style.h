@@ -76,6 +76,7 @@ public:
 
     static QStringList getThemeColorNames();
     static const QString getStylesheet(const QString& filename, const QFont& baseFont = QFont());
+    static void setStylesheet(QWidget* w, const QString& filename, const QFont& baseFont = QFont());
     static const QString getImagePath(const QString& filename);
     static QString getThemeFolder();
     static QString getThemeName();
@@ -96,6 +97,8 @@ signals:
 
 private:
     Style();
+    static void loadStylesheetCache();
+    static void saveStylesheetCache();
 
 private:
     static QList<ThemeNameColor> themeNameColors;
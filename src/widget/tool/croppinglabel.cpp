@@ -18,6 +18,7 @@
 */
 
 #include "croppinglabel.h"
+#include "rowmetrics.h"
 #include <QKeyEvent>
 #include <QLineEdit>
 #include <QResizeEvent>
@@ -105,11 +106,7 @@ QSize CroppingLabel::sizeHint() const
 
 QSize CroppingLabel::minimumSizeHint() const
 {
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 11, 0))
-    return QSize(fontMetrics().horizontalAdvance("..."), QLabel::minimumSizeHint().height());
-#else
-    return QSize(fontMetrics().width("..."), QLabel::minimumSizeHint().height());
-#endif
+    return QSize(RowMetrics::ellipsisWidth(font()), QLabel::minimumSizeHint().height());
 }
 
 void CroppingLabel::mouseReleaseEvent(QMouseEvent* e)
@@ -133,7 +130,9 @@ void CroppingLabel::paintEvent(QPaintEvent* paintEvent)
 
 void CroppingLabel::setElidedText()
 {
-    QString elidedText = fontMetrics().elidedText(origText, elideMode, width());
+    // rows share fonts and column widths, so the measurement usually
+    // already happened in some other label at this size
+    QString elidedText = RowMetrics::elidedText(font(), origText, elideMode, width());
     if (elidedText != origText)
         setToolTip(Qt::convertFromPlainText(origText, Qt::WhiteSpaceNormal));
     else
@@ -174,11 +173,7 @@ void CroppingLabel::minimizeMaximumWidth()
 {
     // This function chooses the smallest possible maximum width.
     // Text width + padding. Without padding, we'll have elipses.
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 11, 0))
-    setMaximumWidth(fontMetrics().horizontalAdvance(origText) + fontMetrics().horizontalAdvance("..."));
-#else
-    setMaximumWidth(fontMetrics().width(origText) + fontMetrics().width("..."));
-#endif
+    setMaximumWidth(RowMetrics::textWidth(font(), origText) + RowMetrics::ellipsisWidth(font()));
 }
 
 void CroppingLabel::editingFinished()
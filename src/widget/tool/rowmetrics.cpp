@@ -0,0 +1,101 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "rowmetrics.h"
+
+#include <QCache>
+#include <QFontMetrics>
+#include <QHash>
+#include <QStringBuilder>
+
+namespace {
+// Bounds the cache to a few roster screens worth of distinct strings;
+// entries age out under LRU once the roster churns past that.
+constexpr int ELISION_CACHE_ENTRIES = 4096;
+
+QCache<QString, QString>& elisionCache()
+{
+    static QCache<QString, QString> cache{ELISION_CACHE_ENTRIES};
+    return cache;
+}
+
+QHash<QString, int>& widthCache()
+{
+    static QHash<QString, int> cache;
+    return cache;
+}
+
+int advance(const QFontMetrics& metrics, const QString& text)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 11, 0))
+    return metrics.horizontalAdvance(text);
+#else
+    return metrics.width(text);
+#endif
+}
+} // namespace
+
+/**
+ * @brief Elides text for a given font and width, cached across all rows.
+ *
+ * QFont::key() captures family, size, and style, so a font change under a
+ * new theme simply keys new entries; the old ones age out.
+ */
+QString RowMetrics::elidedText(const QFont& font, const QString& text, Qt::TextElideMode mode,
+                               int width)
+{
+    const QString key = font.key() % QLatin1Char('\n') % QString::number(static_cast<int>(mode))
+                        % QLatin1Char('\n') % QString::number(width) % QLatin1Char('\n') % text;
+    if (const QString* cached = elisionCache().object(key)) {
+        return *cached;
+    }
+
+    const QString elided = QFontMetrics(font).elidedText(text, mode, width);
+    elisionCache().insert(key, new QString(elided));
+    return elided;
+}
+
+/**
+ * @brief Pixel width of a string in a font, cached across all rows.
+ */
+int RowMetrics::textWidth(const QFont& font, const QString& text)
+{
+    const QString key = font.key() % QLatin1Char('\n') % text;
+    const auto it = widthCache().constFind(key);
+    if (it != widthCache().constEnd()) {
+        return *it;
+    }
+
+    const int width = advance(QFontMetrics(font), text);
+    // the width cache is tiny per entry but unbounded by QHash, so reuse
+    // the eliding cache's budget as a rough cap
+    if (widthCache().size() >= ELISION_CACHE_ENTRIES) {
+        widthCache().clear();
+    }
+    widthCache().insert(key, width);
+    return width;
+}
+
+/**
+ * @brief Width of the "..." ellipsis in a font; one entry per font in use.
+ */
+int RowMetrics::ellipsisWidth(const QFont& font)
+{
+    return textWidth(font, QStringLiteral("..."));
+}
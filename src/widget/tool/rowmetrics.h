@@ -0,0 +1,44 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ROWMETRICS_H
+#define ROWMETRICS_H
+
+#include <QFont>
+#include <QString>
+
+/**
+ * Shared cache for the text measurements the roster rows keep redoing.
+ * Rows use the same few fonts and the same column width, so elision and
+ * width results computed for one row serve every other row at that size;
+ * a compact-mode toggle or panel resize re-measures each distinct
+ * (font, width, text) combination once instead of once per label.
+ *
+ * GUI thread only, like the widgets it serves.
+ */
+class RowMetrics
+{
+public:
+    static QString elidedText(const QFont& font, const QString& text, Qt::TextElideMode mode,
+                              int width);
+    static int textWidth(const QFont& font, const QString& text);
+    static int ellipsisWidth(const QFont& font);
+};
+
+#endif // ROWMETRICS_H
@@ -0,0 +1,131 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stallwatchdog.h"
+
+#include <QAbstractEventDispatcher>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEvent>
+
+/**
+ * @class StallWatchdog
+ *
+ * Watches the GUI thread for event-loop stalls. Every event delivered on the
+ * main thread passes through an application-wide event filter, so the time
+ * between two consecutive deliveries is a good measure of how long the
+ * previous handler ran. Handlers that exceed the threshold are recorded in a
+ * small ring buffer together with the receiver's class, object name and event
+ * type; the advanced settings page shows that buffer so freezes reported by
+ * users can be attributed without a profiler attached.
+ *
+ * The dispatcher's aboutToBlock signal closes out the last event of a batch,
+ * so idle time spent blocked in the event loop is never counted as a stall.
+ */
+
+// anything slower than this misses several frames and is visible as a hang
+static const int DEFAULT_STALL_THRESHOLD_MS = 100;
+
+StallWatchdog::StallWatchdog()
+    : thresholdMs{DEFAULT_STALL_THRESHOLD_MS}
+{
+    bool ok = false;
+    const int envThreshold = qEnvironmentVariableIntValue("QTOX_STALL_THRESHOLD_MS", &ok);
+    if (ok && envThreshold > 0) {
+        thresholdMs = envThreshold;
+    }
+
+    stalls.reserve(RECENT_STALL_COUNT);
+
+    connect(QAbstractEventDispatcher::instance(), &QAbstractEventDispatcher::aboutToBlock, this,
+            &StallWatchdog::onAboutToBlock);
+    qApp->installEventFilter(this);
+}
+
+StallWatchdog& StallWatchdog::getInstance()
+{
+    static StallWatchdog instance;
+    return instance;
+}
+
+void StallWatchdog::setThreshold(int ms)
+{
+    if (ms > 0) {
+        thresholdMs = ms;
+    }
+}
+
+int StallWatchdog::getThreshold() const
+{
+    return thresholdMs;
+}
+
+/**
+ * @brief Recent stalls, oldest first.
+ */
+QVector<StallWatchdog::Stall> StallWatchdog::recentStalls() const
+{
+    return stalls;
+}
+
+bool StallWatchdog::eventFilter(QObject* watched, QEvent* event)
+{
+    // the previous event is done dispatching once the next one arrives
+    if (dispatching && dispatchTimer.elapsed() >= thresholdMs) {
+        recordStall(dispatchTimer.elapsed());
+    }
+
+    currentClassName = watched->metaObject()->className();
+    currentObjectName = watched->objectName();
+    currentEventType = static_cast<int>(event->type());
+    dispatching = true;
+    dispatchTimer.start();
+
+    return false;
+}
+
+void StallWatchdog::onAboutToBlock()
+{
+    // don't let the idle wait that follows count towards the last event
+    if (dispatching && dispatchTimer.elapsed() >= thresholdMs) {
+        recordStall(dispatchTimer.elapsed());
+    }
+
+    dispatching = false;
+}
+
+void StallWatchdog::recordStall(qint64 durationMs)
+{
+    dispatching = false;
+
+    QString context = QString::fromLatin1(currentClassName);
+    if (!currentObjectName.isEmpty()) {
+        context += QString(" \"%1\"").arg(currentObjectName);
+    }
+    context += QString(", event type %1").arg(currentEventType);
+
+    qWarning() << "GUI thread stalled for" << durationMs << "ms in" << context;
+
+    if (stalls.size() == RECENT_STALL_COUNT) {
+        stalls.removeFirst();
+    }
+    stalls.append(Stall{QDateTime::currentDateTime(), durationMs, context});
+
+    emit stallRecorded();
+}
@@ -0,0 +1,77 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class QEvent;
+
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stall
+    {
+        QDateTime when;
+        qint64 durationMs;
+        QString context;
+    };
+
+    static StallWatchdog& getInstance();
+
+    void setThreshold(int ms);
+    int getThreshold() const;
+    QVector<Stall> recentStalls() const;
+
+signals:
+    void stallRecorded();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) final override;
+
+private slots:
+    void onAboutToBlock();
+
+private:
+    StallWatchdog();
+    void recordStall(qint64 durationMs);
+
+private:
+    // how many stalls the ring buffer keeps before dropping the oldest
+    static const int RECENT_STALL_COUNT = 32;
+
+    int thresholdMs;
+    // identity of the event currently being dispatched, copied up front so a
+    // receiver deleted during dispatch can still be named in the stall record
+    QElapsedTimer dispatchTimer;
+    bool dispatching = false;
+    const char* currentClassName = nullptr;
+    QString currentObjectName;
+    int currentEventType = 0;
+    QVector<Stall> stalls;
+};
+
+#endif // STALLWATCHDOG_H
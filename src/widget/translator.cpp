@@ -19,6 +19,7 @@
 
 
 #include "translator.h"
+#include "src/util/resourcebundle.h"
 #include <QApplication>
 #include <QDebug>
 #include <QLibraryInfo>
@@ -47,6 +48,9 @@ void Translator::translate(const QString& localeName)
     QString locale = localeName.isEmpty() ? QLocale::system().name().section('_', 0, 0) : localeName;
 
     if (locale != "en") {
+        // each locale's catalog ships as its own standalone bundle; mounting
+        // only the active one keeps the other locales off disk and unmapped
+        ResourceBundle::ensureRegistered(QStringLiteral("translations_") + locale);
         if (translator->load(locale, ":translations/")) {
             qDebug() << "Loaded translation" << locale;
 
@@ -25,9 +25,11 @@
 #include <QDebug>
 #include <QDesktopServices>
 #include <QDesktopWidget>
+#include <QElapsedTimer>
 #include <QMessageBox>
 #include <QMouseEvent>
 #include <QPainter>
+#include <QPixmapCache>
 #include <QShortcut>
 #include <QString>
 #include <QSvgRenderer>
@@ -56,6 +58,7 @@
 #include "src/friendlist.h"
 #include "src/grouplist.h"
 #include "src/model/chathistory.h"
+#include "src/model/groupchathistory.h"
 #include "src/model/chatroom/friendchatroom.h"
 #include "src/model/chatroom/groupchatroom.h"
 #include "src/model/friend.h"
@@ -69,6 +72,8 @@
 #include "src/persistence/profile.h"
 #include "src/persistence/settings.h"
 #include "src/platform/timer.h"
+#include "src/util/coarsetimerservice.h"
+#include "src/util/idlemode.h"
 #include "src/widget/contentdialogmanager.h"
 #include "src/widget/form/addfriendform.h"
 #include "src/widget/form/chatform.h"
@@ -96,6 +101,9 @@ bool toxActivateEventHandler(const QByteArray&)
 
 namespace {
 
+// Quiet period after the last keystroke before the roster filter runs.
+constexpr int searchDebounceTime = 200;
+
 /**
  * @brief Dangerous way to find out if a path is writable.
  * @param filepath Path to file which should be deleted.
@@ -152,6 +160,10 @@ Widget::Widget(IAudioControl& audio, QWidget* parent)
     installEventFilter(this);
     QString locale = settings.getTranslation();
     Translator::translate(locale);
+
+    connect(&inboundMsgQueue, &InboundMsgQueue::messageReady, this,
+            &Widget::dispatchInboundMessage);
+    connect(&inboundMsgQueue, &InboundMsgQueue::messageShed, this, &Widget::onInboundMessageShed);
 }
 
 void Widget::init()
@@ -163,8 +175,9 @@ void Widget::init()
         setWindowIcon(themeIcon);
     }
 
-    timer = new QTimer();
-    timer->start(1000);
+    notificationDigestTimer = new QTimer(this);
+    notificationDigestTimer->setSingleShot(true);
+    connect(notificationDigestTimer, &QTimer::timeout, this, &Widget::flushNotificationDigests);
 
     icon_size = 15;
 
@@ -188,6 +201,9 @@ void Widget::init()
     actionLogout = new QAction(this);
     actionLogout->setIcon(prepareIcon(":/img/others/logout-icon.svg", icon_size, icon_size));
 
+    actionSwitchProfile = new QAction(this);
+    actionSwitchProfile->setIcon(prepareIcon(":/img/others/logout-icon.svg", icon_size, icon_size));
+
     actionQuit = new QAction(this);
 #ifndef Q_OS_OSX
     actionQuit->setMenuRole(QAction::QuitRole);
@@ -281,22 +297,24 @@ void Widget::init()
 #if UPDATE_CHECK_ENABLED
     updateCheck = std::unique_ptr<UpdateCheck>(new UpdateCheck(settings));
     connect(updateCheck.get(), &UpdateCheck::updateAvailable, this, &Widget::onUpdateAvailable);
-#endif
-    settingsWidget = new SettingsWidget(updateCheck.get(), audio, this);
-#if UPDATE_CHECK_ENABLED
     updateCheck->checkForUpdate();
 #endif
 
+    // The settings pages and the profile form are built on first access, see
+    // getOrCreateSettingsWidget() and getOrCreateProfileForm(); only the
+    // shell and the chat area have to exist before the window paints.
+
     core = Nexus::getCore();
     CoreFile* coreFile = core->getCoreFile();
-    Profile* profile = Nexus::getProfile();
-    profileInfo = new ProfileInfo(core, profile);
-    profileForm = new ProfileForm(profileInfo);
 
     // connect logout tray menu action
-    connect(actionLogout, &QAction::triggered, profileForm, &ProfileForm::onLogoutClicked);
+    connect(actionLogout, &QAction::triggered, this,
+            [this]() { getOrCreateProfileForm()->onLogoutClicked(); });
 
-    connect(profile, &Profile::selfAvatarChanged, profileForm, &ProfileForm::onSelfAvatarLoaded);
+    // unlike logout, this keeps the profile loaded and online in the
+    // background, see Nexus::switchProfile()
+    connect(actionSwitchProfile, &QAction::triggered, this,
+            []() { Nexus::getInstance().switchProfile(); });
 
     connect(coreFile, &CoreFile::fileReceiveRequested, this, &Widget::onFileReceiveRequested);
     connect(coreFile, &CoreFile::fileDownloadFinished, filesForm, &FilesForm::onFileDownloadComplete);
@@ -311,10 +329,28 @@ void Widget::init()
     connect(ui->mainSplitter, &QSplitter::splitterMoved, this, &Widget::onSplitterMoved);
     connect(addFriendForm, &AddFriendForm::friendRequested, this, &Widget::friendRequested);
     connect(groupInviteForm, &GroupInviteForm::groupCreate, core, &Core::createGroup);
-    connect(timer, &QTimer::timeout, this, &Widget::onUserAwayCheck);
-    connect(timer, &QTimer::timeout, this, &Widget::onEventIconTick);
-    connect(timer, &QTimer::timeout, this, &Widget::onTryCreateTrayIcon);
-    connect(ui->searchContactText, &QLineEdit::textChanged, this, &Widget::searchContacts);
+    // the away check, event icon blink and tray retry all tolerate coarse
+    // timing, so they share the process-wide coalesced timer instead of
+    // keeping a wakeup source of their own
+    CoarseTimerService::getInstance().subscribe(this, 1000, [this]() {
+        onUserAwayCheck();
+        onEventIconTick();
+        onTryCreateTrayIcon();
+    });
+    // idle mode spots returning input on its own; re-run the away check right
+    // away so the status flips back before the stretched shared timer fires
+    connect(&IdleMode::getInstance(), &IdleMode::idleChanged, this, [this](bool idle) {
+        if (!idle) {
+            onUserAwayCheck();
+        }
+    });
+    // Filtering the whole roster on every keystroke lags behind fast typing
+    // on large contact lists, so the filter only runs once typing pauses.
+    searchDebounceTimer = new QTimer(this);
+    searchDebounceTimer->setSingleShot(true);
+    connect(searchDebounceTimer, &QTimer::timeout, this, &Widget::searchContacts);
+    connect(ui->searchContactText, &QLineEdit::textChanged, this,
+            [this]() { searchDebounceTimer->start(searchDebounceTime); });
     connect(filterGroup, &QActionGroup::triggered, this, &Widget::searchContacts);
     connect(filterDisplayGroup, &QActionGroup::triggered, this, &Widget::changeDisplayMode);
     connect(ui->friendList, &QWidget::customContextMenuRequested, this, &Widget::friendListContextMenu);
@@ -541,14 +577,22 @@ void Widget::updateIcons()
     } else {
         QString color = settings.getLightTrayIcon() ? "light" : "dark";
         QString path = ":/img/taskbar/" + color + "/taskbar_" + assetSuffix + ".svg";
-        QSvgRenderer renderer(path);
 
-        // Prepare a QImage with desired characteritisc
-        QImage image = QImage(250, 250, QImage::Format_ARGB32);
-        image.fill(Qt::transparent);
-        QPainter painter(&image);
-        renderer.render(&painter);
-        ico = QIcon(QPixmap::fromImage(image));
+        // the event icon tick re-renders this on every blink; share the
+        // rasterization across repaints
+        QPixmap pm;
+        if (!QPixmapCache::find(path, &pm)) {
+            QSvgRenderer renderer(path);
+
+            // Prepare a QImage with desired characteritisc
+            QImage image = QImage(250, 250, QImage::Format_ARGB32);
+            image.fill(Qt::transparent);
+            QPainter painter(&image);
+            renderer.render(&painter);
+            pm = QPixmap::fromImage(image);
+            QPixmapCache::insert(path, pm);
+        }
+        ico = QIcon(pm);
     }
 
     setWindowIcon(ico);
@@ -590,7 +634,6 @@ Widget::~Widget()
     delete addFriendForm;
     delete groupInviteForm;
     delete filesForm;
-    delete timer;
     delete contentLayout;
     delete settingsWidget;
 
@@ -670,9 +713,10 @@ void Widget::onCoreChanged(Core& core)
     connect(&core, &Core::usernameSet, this, &Widget::setUsername);
     connect(&core, &Core::statusMessageSet, this, &Widget::setStatusMessage);
     connect(&core, &Core::friendAdded, this, &Widget::addFriend);
+    connect(&core, &Core::friendsLoaded, this, &Widget::onFriendsLoaded);
     connect(&core, &Core::failedToAddFriend, this, &Widget::addFriendFailed);
     connect(&core, &Core::friendUsernameChanged, this, &Widget::onFriendUsernameChanged);
-    connect(&core, &Core::friendStatusChanged, this, &Widget::onFriendStatusChanged);
+    connect(&core, &Core::friendsStatusesChanged, this, &Widget::onFriendsStatusesChanged);
     connect(&core, &Core::friendStatusMessageChanged, this, &Widget::onFriendStatusMessageChanged);
     connect(&core, &Core::friendRequestReceived, this, &Widget::onFriendRequestReceived);
     connect(&core, &Core::friendMessageReceived, this, &Widget::onFriendMessageReceived);
@@ -926,15 +970,16 @@ void Widget::onIconClick(QSystemTrayIcon::ActivationReason reason)
 
 void Widget::onShowSettings()
 {
+    SettingsWidget* const form = getOrCreateSettingsWidget();
     if (settings.getSeparateWindow()) {
-        if (!settingsWidget->isShown()) {
-            settingsWidget->show(createContentDialog(DialogType::SettingDialog));
+        if (!form->isShown()) {
+            form->show(createContentDialog(DialogType::SettingDialog));
         }
 
         setActiveToolMenuButton(ActiveToolMenuButton::None);
     } else {
         hideMainForms(nullptr);
-        settingsWidget->show(contentLayout);
+        form->show(contentLayout);
         setWindowTitle(fromDialogType(DialogType::SettingDialog));
         setActiveToolMenuButton(ActiveToolMenuButton::SettingButton);
     }
@@ -942,20 +987,76 @@ void Widget::onShowSettings()
 
 void Widget::showProfile() // onAvatarClicked, onUsernameClicked
 {
+    ProfileForm* const form = getOrCreateProfileForm();
     if (settings.getSeparateWindow()) {
-        if (!profileForm->isShown()) {
-            profileForm->show(createContentDialog(DialogType::ProfileDialog));
+        if (!form->isShown()) {
+            form->show(createContentDialog(DialogType::ProfileDialog));
         }
 
         setActiveToolMenuButton(ActiveToolMenuButton::None);
     } else {
         hideMainForms(nullptr);
-        profileForm->show(contentLayout);
+        form->show(contentLayout);
         setWindowTitle(fromDialogType(DialogType::ProfileDialog));
         setActiveToolMenuButton(ActiveToolMenuButton::None);
     }
 }
 
+/**
+ * @brief Returns the settings pages, building them on first access
+ *
+ * Constructing every settings form up front noticeably delayed the first
+ * paint of the main window; most sessions never open them.
+ */
+SettingsWidget* Widget::getOrCreateSettingsWidget()
+{
+    if (settingsWidget) {
+        return settingsWidget;
+    }
+
+    QElapsedTimer buildTime;
+    buildTime.start();
+    settingsWidget = new SettingsWidget(updateCheck.get(), audio, this);
+    qDebug() << "Built settings forms on first access in" << buildTime.elapsed() << "ms";
+
+#if UPDATE_CHECK_ENABLED
+    // The about page connects to UpdateCheck in its constructor and would
+    // miss a result that arrived before the settings were first opened.
+    updateCheck->checkForUpdate();
+#endif
+
+    return settingsWidget;
+}
+
+/**
+ * @brief Returns the profile form, building it on first access
+ */
+ProfileForm* Widget::getOrCreateProfileForm()
+{
+    if (profileForm != nullptr) {
+        return profileForm;
+    }
+
+    QElapsedTimer buildTime;
+    buildTime.start();
+
+    Profile* profile = Nexus::getProfile();
+    profileInfo = new ProfileInfo(core, profile);
+    profileForm = new ProfileForm(profileInfo);
+
+    connect(profile, &Profile::selfAvatarChanged, profileForm, &ProfileForm::onSelfAvatarLoaded);
+
+    // the avatar that arrived before the form existed
+    const QPixmap avatar = profile->loadAvatar();
+    if (!avatar.isNull()) {
+        profileForm->onSelfAvatarLoaded(avatar);
+    }
+
+    qDebug() << "Built profile form on first access in" << buildTime.elapsed() << "ms";
+
+    return profileForm;
+}
+
 void Widget::hideMainForms(GenericChatroomWidget* chatroomWidget)
 {
     setActiveToolMenuButton(ActiveToolMenuButton::None);
@@ -969,6 +1070,14 @@ void Widget::hideMainForms(GenericChatroomWidget* chatroomWidget)
     }
 
     activeChatroomWidget = chatroomWidget;
+
+    // the chat on screen gets its inbound messages drained first
+    const Friend* frnd = chatroomWidget ? chatroomWidget->getFriend() : nullptr;
+    if (frnd) {
+        inboundMsgQueue.setVisibleFriend(frnd->getPublicKey());
+    } else {
+        inboundMsgQueue.clearVisibleFriend();
+    }
 }
 
 void Widget::setUsername(const QString& username)
@@ -1139,17 +1248,21 @@ void Widget::addFriend(uint32_t friendId, const ToxPk& friendPk)
     auto chatHistory =
         std::make_shared<ChatHistory>(*newfriend, history, *core, Settings::getInstance(),
                                       *friendMessageDispatcher);
-    auto friendForm = new ChatForm(newfriend, *chatHistory, *friendMessageDispatcher);
-    connect(friendForm, &ChatForm::updateFriendActivity, this, &Widget::updateFriendActivity);
 
+    // The ChatForm itself is built lazily in getOrCreateChatForm() on first
+    // activation; constructing one per friend here dominated profile load
+    // time on large friend lists. The dispatcher and chat log above stay
+    // live so messages are received and stored either way.
     friendMessageDispatchers[friendPk] = friendMessageDispatcher;
     friendChatLogs[friendPk] = chatHistory;
     friendChatrooms[friendPk] = chatroom;
     friendWidgets[friendPk] = widget;
-    chatForms[friendPk] = friendForm;
 
     const auto activityTime = settings.getFriendActivity(friendPk);
-    const auto chatTime = friendForm->getLatestTime();
+    QDateTime chatTime;
+    if (chatHistory->getFirstIdx() != chatHistory->getNextIdx()) {
+        chatTime = chatHistory->at(chatHistory->getNextIdx() - 1).getTimestamp();
+    }
     if (chatTime > activityTime && chatTime.isValid()) {
         settings.setFriendActivity(friendPk, chatTime);
     }
@@ -1157,6 +1270,20 @@ void Widget::addFriend(uint32_t friendId, const ToxPk& friendPk)
     contactListWidget->addFriendWidget(widget, Status::Status::Offline,
                                        settings.getFriendCircleID(friendPk));
 
+    // restore the persisted unread badge; the state of every conversation is
+    // fetched in one query on the first friend and shared by the rest of the
+    // load, so this never reads message content
+    if (!readStatesLoaded && history != nullptr && history->isValid()) {
+        for (const History::ReadState& state : history->getReadStates()) {
+            persistedUnread[state.friendPk] = state.unreadCount;
+        }
+        readStatesLoaded = true;
+    }
+    if (persistedUnread.value(friendPk.toString(), 0) > 0) {
+        newfriend->setEventFlag(true);
+        widget->updateStatusLight();
+    }
+
 
     auto notifyReceivedCallback = [this, friendPk](const ToxPk& author, const Message& message) {
         auto isTargeted = std::any_of(message.metadata.begin(), message.metadata.end(),
@@ -1174,16 +1301,8 @@ void Widget::addFriend(uint32_t friendId, const ToxPk& friendPk)
     connect(newfriend, &Friend::aliasChanged, this, &Widget::onFriendAliasChanged);
     connect(newfriend, &Friend::displayedNameChanged, this, &Widget::onFriendDisplayedNameChanged);
 
-    connect(friendForm, &ChatForm::incomingNotification, this, &Widget::incomingNotification);
-    connect(friendForm, &ChatForm::outgoingNotification, this, &Widget::outgoingNotification);
-    connect(friendForm, &ChatForm::stopNotification, this, &Widget::onStopNotification);
-    connect(friendForm, &ChatForm::endCallNotification, this, &Widget::onCallEnd);
-    connect(friendForm, &ChatForm::rejectCall, this, &Widget::onRejectCall);
-
     connect(widget, &FriendWidget::newWindowOpened, this, &Widget::openNewDialog);
     connect(widget, &FriendWidget::chatroomWidgetClicked, this, &Widget::onChatroomWidgetClicked);
-    connect(widget, &FriendWidget::chatroomWidgetClicked, friendForm, &ChatForm::focusInput);
-    connect(widget, &FriendWidget::friendHistoryRemoved, friendForm, &ChatForm::clearChatArea);
     connect(widget, &FriendWidget::copyFriendIdToClipboard, this, &Widget::copyFriendIdToClipboard);
     connect(widget, &FriendWidget::contextMenuCalled, widget, &FriendWidget::onContextMenuCalled);
     connect(widget, SIGNAL(removeFriend(const ToxPk&)), this, SLOT(removeFriend(const ToxPk&)));
@@ -1192,15 +1311,70 @@ void Widget::addFriend(uint32_t friendId, const ToxPk& friendPk)
     connect(profile, &Profile::friendAvatarSet, widget, &FriendWidget::onAvatarSet);
     connect(profile, &Profile::friendAvatarRemoved, widget, &FriendWidget::onAvatarRemoved);
 
-    // Try to get the avatar from the cache
+    // the widget pulls its avatar from the profile on first paint, so
+    // building the roster doesn't read every avatar on disk up front; the
+    // prewarm batch decodes it (or renders the identicon) off-thread in the
+    // meantime so that first paint usually hits the cache
+    profile->prewarmAvatar(friendPk);
+
+    FilterCriteria filter = getFilterCriteria();
+    widget->search(ui->searchContactText->text(), filterOffline(filter));
+}
+
+void Widget::onFriendsLoaded(const QVector<CoreFriendInfo>& friends)
+{
+    // the whole roster in one pass with painting suspended, same idea as
+    // the reconnect-storm handling in onFriendsStatusesChanged; names and
+    // status messages come out of the snapshot instead of a queued signal
+    // per friend and per property
+    contactListWidget->setUpdatesEnabled(false);
+
+    for (const CoreFriendInfo& info : friends) {
+        addFriend(info.friendId, info.friendPk);
+        if (!info.username.isEmpty()) {
+            onFriendUsernameChanged(info.friendId, info.username);
+        }
+        if (!info.statusMessage.isEmpty()) {
+            onFriendStatusMessageChanged(info.friendId, info.statusMessage);
+        }
+    }
+
+    contactListWidget->setUpdatesEnabled(true);
+    contactListWidget->reDraw();
+}
+
+ChatForm* Widget::getOrCreateChatForm(const ToxPk& friendPk)
+{
+    ChatForm* form = chatForms.value(friendPk, nullptr);
+    if (form != nullptr) {
+        return form;
+    }
+
+    Friend* f = FriendList::findFriend(friendPk);
+    assert(f != nullptr);
+    form = new ChatForm(f, *friendChatLogs[friendPk], *friendMessageDispatchers[friendPk]);
+    chatForms[friendPk] = form;
+
+    connect(form, &ChatForm::updateFriendActivity, this, &Widget::updateFriendActivity);
+    connect(form, &ChatForm::incomingNotification, this, &Widget::incomingNotification);
+    connect(form, &ChatForm::outgoingNotification, this, &Widget::outgoingNotification);
+    connect(form, &ChatForm::stopNotification, this, &Widget::onStopNotification);
+    connect(form, &ChatForm::endCallNotification, this, &Widget::onCallEnd);
+    connect(form, &ChatForm::rejectCall, this, &Widget::onRejectCall);
+
+    FriendWidget* widget = friendWidgets[friendPk];
+    connect(widget, &FriendWidget::chatroomWidgetClicked, form, &ChatForm::focusInput);
+    connect(widget, &FriendWidget::friendHistoryRemoved, form, &ChatForm::clearChatArea);
+
+    // State the form would have received through signals had it existed
+    // since addFriend()
+    form->setStatusMessage(f->getStatusMessage());
     QPixmap avatar = Nexus::getProfile()->loadAvatar(friendPk);
     if (!avatar.isNull()) {
-        friendForm->onAvatarChanged(friendPk, avatar);
-        widget->onAvatarSet(friendPk, avatar);
+        form->onAvatarChanged(friendPk, avatar);
     }
 
-    FilterCriteria filter = getFilterCriteria();
-    widget->search(ui->searchContactText->text(), filterOffline(filter));
+    return form;
 }
 
 void Widget::addFriendFailed(const ToxPk&, const QString& errorInfo)
@@ -1234,13 +1408,43 @@ void Widget::onFriendStatusChanged(int friendId, Status::Status status)
 
     f->setStatus(status);
     widget->updateStatusLight();
-    if (widget->isActive()) {
+    if (widget->isActive() && !statusStormActive) {
         setWindowTitle(widget->getTitle());
     }
 
     ContentDialogManager::getInstance()->updateFriendStatus(friendPk);
 }
 
+void Widget::onFriendsStatusesChanged(const QVector<QPair<uint32_t, Status::Status>>& statuses)
+{
+    // past this size the burst is a reconnect storm, not individual activity
+    constexpr int stormThreshold = 10;
+
+    // Handle the whole batch in one event pass so a reconnect burst doesn't
+    // queue up one GUI event per friend. In a storm, additionally suspend
+    // friend-list painting and the per-friend window title churn; the list
+    // is repainted and the title set once after the batch.
+    const bool storm = statuses.size() >= stormThreshold;
+    if (storm) {
+        statusStormActive = true;
+        contactListWidget->setUpdatesEnabled(false);
+    }
+
+    for (const auto& change : statuses) {
+        onFriendStatusChanged(change.first, change.second);
+    }
+
+    if (storm) {
+        statusStormActive = false;
+        contactListWidget->setUpdatesEnabled(true);
+        contactListWidget->reDraw();
+
+        if (activeChatroomWidget != nullptr) {
+            setWindowTitle(activeChatroomWidget->getTitle());
+        }
+    }
+}
+
 void Widget::onFriendStatusMessageChanged(int friendId, const QString& message)
 {
     const auto& friendPk = FriendList::id2Key(friendId);
@@ -1254,7 +1458,9 @@ void Widget::onFriendStatusMessageChanged(int friendId, const QString& message)
     f->setStatusMessage(str);
 
     friendWidgets[friendPk]->setStatusMsg(str);
-    chatForms[friendPk]->setStatusMessage(str);
+    if (ChatForm* form = chatForms.value(friendPk, nullptr)) {
+        form->setStatusMessage(str);
+    }
 }
 
 void Widget::onFriendDisplayedNameChanged(const QString& displayed)
@@ -1299,7 +1505,7 @@ void Widget::onFriendAliasChanged(const ToxPk& friendId, const QString& alias)
     friendWidget->searchName(ui->searchContactText->text(), filter);
 
     settings.setFriendAlias(friendId, alias);
-    settings.savePersonal();
+    settings.scheduleSavePersonal();
 }
 
 void Widget::onChatroomWidgetClicked(GenericChatroomWidget* widget)
@@ -1316,13 +1522,19 @@ void Widget::openDialog(GenericChatroomWidget* widget, bool newWindow)
 {
     widget->resetEventFlags();
     widget->updateStatusLight();
+    if (const Friend* f = widget->getFriend()) {
+        History* history = Nexus::getProfile()->getHistory();
+        if (history) {
+            history->markConversationRead(f->getPublicKey());
+        }
+    }
 
     GenericChatForm* form;
     GroupId id;
     const Friend* frnd = widget->getFriend();
     const Group* group = widget->getGroup();
     if (frnd) {
-        form = chatForms[frnd->getPublicKey()];
+        form = getOrCreateChatForm(frnd->getPublicKey());
     } else {
         id = group->getPersistentId();
         form = groupChatForms[id].data();
@@ -1361,7 +1573,7 @@ void Widget::openDialog(GenericChatroomWidget* widget, bool newWindow)
     } else {
         hideMainForms(widget);
         if (frnd) {
-            chatForms[frnd->getPublicKey()]->show(contentLayout);
+            getOrCreateChatForm(frnd->getPublicKey())->show(contentLayout);
         } else {
             groupChatForms[group->getPersistentId()]->show(contentLayout);
         }
@@ -1378,7 +1590,40 @@ void Widget::onFriendMessageReceived(uint32_t friendnumber, const QString& messa
         return;
     }
 
-    friendMessageDispatchers[f->getPublicKey()]->onMessageReceived(isAction, message);
+    // bounded handoff: drained in budgeted batches so a flooding peer can't
+    // starve paint and input events
+    inboundMsgQueue.enqueue(f->getPublicKey(), isAction, message);
+}
+
+void Widget::dispatchInboundMessage(const ToxPk& friendPk, bool isAction, const QString& content)
+{
+    auto dispatcher = friendMessageDispatchers.value(friendPk);
+    if (!dispatcher) {
+        // removed while their messages were still queued
+        return;
+    }
+
+    dispatcher->onMessageReceived(isAction, content);
+}
+
+void Widget::onInboundMessageShed(const ToxPk& friendPk, bool isAction, const QString& content)
+{
+    // overflow goes straight to history, skipping processing and the view;
+    // it shows up in the transcript on the next history load
+    History* history = Nexus::getProfile()->getHistory();
+    if (!history || !history->isValid() || !settings.getEnableLogging()) {
+        return;
+    }
+
+    QString savedContent = content;
+    if (isAction) {
+        savedContent = ChatForm::ACTION_PREFIX + savedContent;
+    }
+
+    const Friend* f = FriendList::findFriend(friendPk);
+    const QString displayName = f ? f->getDisplayedName() : friendPk.toString();
+    history->queueNewMessage(friendPk.toString(), savedContent, friendPk.toString(),
+                             QDateTime::currentDateTime(), true, displayName);
 }
 
 void Widget::onReceiptReceived(int friendId, ReceiptNum receipt)
@@ -1404,7 +1649,7 @@ void Widget::addFriendDialog(const Friend* frnd, ContentDialog* dialog)
         onAddClicked();
     }
 
-    auto form = chatForms[friendPk];
+    auto form = getOrCreateChatForm(friendPk);
     auto chatroom = friendChatrooms[friendPk];
     FriendWidget* friendWidget =
         ContentDialogManager::getInstance()->addFriendToDialog(dialog, chatroom, form);
@@ -1526,13 +1771,22 @@ bool Widget::newFriendMessageAlert(const ToxPk& friendId, const QString& text, b
         }
     }
 
-    if (newMessageAlert(currentWindow, hasActive, sound)) {
+    // A busy conversation collapses into one digest notification per window
+    // instead of a popup, sound and taskbar flash per message. Messages that
+    // would not alert at all (chat active in the focused window) stay out of
+    // the scheduler's books.
+    const bool wouldAlert = isMinimized() || !currentWindow->isActiveWindow() || !hasActive;
+    const bool digest = wouldAlert && coalesceNotification(friendId.getByteArray(), friendId, GroupId{});
+
+    if (newMessageAlert(currentWindow, hasActive, sound && !digest, !digest)) {
         FriendWidget* widget = friendWidgets[friendId];
         f->setEventFlag(true);
         widget->updateStatusLight();
         ui->friendList->trackWidget(widget);
 #if DESKTOP_NOTIFICATIONS
-        if (settings.getNotifyHide()) {
+        if (digest) {
+            // notified later by flushNotificationDigests()
+        } else if (settings.getNotifyHide()) {
             notifier.notifyMessageSimple(file ? DesktopNotify::MessageType::FRIEND_FILE
                                               : DesktopNotify::MessageType::FRIEND);
         } else {
@@ -1556,6 +1810,13 @@ bool Widget::newFriendMessageAlert(const ToxPk& friendId, const QString& text, b
         return true;
     }
 
+    // read on arrival: the chat is on screen in the focused window, so keep
+    // the database's unread counter in step with what the user saw
+    History* history = Nexus::getProfile()->getHistory();
+    if (history) {
+        history->markConversationRead(friendId);
+    }
+
     return false;
 }
 
@@ -1576,14 +1837,19 @@ bool Widget::newGroupMessageAlert(const GroupId& groupId, const ToxPk& authorPk,
         hasActive = widget == activeChatroomWidget;
     }
 
-    if (!newMessageAlert(currentWindow, hasActive, true, notify)) {
+    const bool wouldAlert = isMinimized() || !currentWindow->isActiveWindow() || !hasActive;
+    const bool digest = wouldAlert && coalesceNotification(groupId.getByteArray(), ToxPk{}, groupId);
+
+    if (!newMessageAlert(currentWindow, hasActive, !digest, notify && !digest)) {
         return false;
     }
 
     g->setEventFlag(true);
     widget->updateStatusLight();
 #if DESKTOP_NOTIFICATIONS
-    if (settings.getNotifyHide()) {
+    if (digest) {
+        // notified later by flushNotificationDigests()
+    } else if (settings.getNotifyHide()) {
         notifier.notifyMessageSimple(DesktopNotify::MessageType::GROUP);
     } else {
         Friend* f = FriendList::findFriend(authorPk);
@@ -1627,6 +1893,108 @@ QString Widget::fromDialogType(DialogType type)
     return QString();
 }
 
+/**
+ * @brief Decides whether a message alert should be folded into a digest.
+ * @param id Persistent id bytes of the conversation.
+ * @param friendPk The friend, or a default ToxPk for group conversations.
+ * @param groupId The group, or a default GroupId for friend conversations.
+ * @return True if the event was absorbed; flushNotificationDigests() will
+ *         announce it later.
+ *
+ * A conversation that alerted within the last window, or anything while the
+ * global rate cap is reached, is only counted; one digest notification per
+ * conversation goes out when the window closes.
+ */
+bool Widget::coalesceNotification(const QByteArray& id, const ToxPk& friendPk, const GroupId& groupId)
+{
+    constexpr qint64 digestWindowMs = 4000;
+    constexpr qint64 rateWindowMs = 10000;
+    constexpr int rateCap = 6;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    while (!recentNotificationTimes.isEmpty() && now - recentNotificationTimes.first() > rateWindowMs) {
+        recentNotificationTimes.removeFirst();
+    }
+
+    const auto last = lastNotificationTimes.constFind(id);
+    const bool withinWindow =
+        last != lastNotificationTimes.constEnd() && now - last.value() < digestWindowMs;
+
+    if (!withinWindow && recentNotificationTimes.size() < rateCap) {
+        lastNotificationTimes[id] = now;
+        recentNotificationTimes.append(now);
+        return false;
+    }
+
+    NotificationDigest& entry = pendingNotifications[id];
+    entry.friendPk = friendPk;
+    entry.groupId = groupId;
+    entry.isGroup = friendPk == ToxPk{};
+    ++entry.count;
+
+    if (!notificationDigestTimer->isActive()) {
+        notificationDigestTimer->start(digestWindowMs);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Announces all pending digests with one sound and one flash.
+ */
+void Widget::flushNotificationDigests()
+{
+    const auto pending = pendingNotifications;
+    pendingNotifications.clear();
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool announced = false;
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+        const NotificationDigest& entry = it.value();
+        const Contact* contact = entry.isGroup
+                                     ? static_cast<const Contact*>(GroupList::findGroup(entry.groupId))
+                                     : static_cast<const Contact*>(FriendList::findFriend(entry.friendPk));
+        if (contact == nullptr || entry.count <= 0) {
+            continue;
+        }
+
+        announced = true;
+        // a continuing stream keeps digesting instead of alerting per message
+        lastNotificationTimes[it.key()] = now;
+
+#if DESKTOP_NOTIFICATIONS
+        if (settings.getNotifyHide()) {
+            notifier.notifyMessageSimple(entry.isGroup ? DesktopNotify::MessageType::GROUP
+                                                       : DesktopNotify::MessageType::FRIEND);
+        } else {
+            notifier.notifyMessage(contact->getDisplayedName(),
+                                   tr("%n new message(s)", "", entry.count));
+        }
+#endif
+    }
+
+    if (!announced) {
+        return;
+    }
+
+    if (settings.getNotify()) {
+#if DESKTOP_NOTIFICATIONS
+        if (!settings.getDesktopNotify()) {
+            QApplication::alert(window());
+        }
+#else
+        QApplication::alert(window());
+#endif
+        eventFlag = true;
+
+        const bool isBusy = core->getStatus() == Status::Status::Busy;
+        if (settings.getNotifySound() && (!isBusy || settings.getBusySound())) {
+            playNotificationSound(IAudioSink::Sound::NewMessage);
+        }
+    }
+}
+
 bool Widget::newMessageAlert(QWidget* currentWindow, bool isActive, bool sound, bool notify)
 {
     bool inactiveWindow = isMinimized() || !currentWindow->isActiveWindow();
@@ -1695,8 +2063,8 @@ void Widget::updateFriendActivity(const Friend& frnd)
     const auto newTime = QDateTime::currentDateTime();
     settings.setFriendActivity(pk, newTime);
     FriendWidget* widget = friendWidgets[frnd.getPublicKey()];
-    contactListWidget->moveWidget(widget, frnd.getStatus());
-    contactListWidget->updateActivityTime(oldTime); // update old category widget
+    // moves between at most the old and the new activity category
+    contactListWidget->friendActivityChanged(widget, oldTime);
 }
 
 void Widget::removeFriend(Friend* f, bool fake)
@@ -1745,7 +2113,7 @@ void Widget::removeFriend(Friend* f, bool fake)
     friendWidgets.remove(friendPk);
     delete widget;
 
-    auto chatForm = chatForms[friendPk];
+    auto chatForm = chatForms.value(friendPk, nullptr);
     chatForms.remove(friendPk);
     delete chatForm;
 
@@ -1766,6 +2134,12 @@ void Widget::onDialogShown(GenericChatroomWidget* widget)
 {
     widget->resetEventFlags();
     widget->updateStatusLight();
+    if (const Friend* f = widget->getFriend()) {
+        History* history = Nexus::getProfile()->getHistory();
+        if (history) {
+            history->markConversationRead(f->getPublicKey());
+        }
+    }
 
     ui->friendList->updateTracking(widget);
     resetIcon();
@@ -2088,14 +2462,13 @@ Group* Widget::createGroup(uint32_t groupnumber, const GroupId& groupId)
     auto messageDispatcher =
         std::make_shared<GroupMessageDispatcher>(*newgroup, std::move(messageProcessor), *core,
                                                  *core, Settings::getInstance());
-    auto groupChatLog = std::make_shared<SessionChatLog>(*core);
 
-    connect(messageDispatcher.get(), &IMessageDispatcher::messageReceived, groupChatLog.get(),
-            &SessionChatLog::onMessageReceived);
-    connect(messageDispatcher.get(), &IMessageDispatcher::messageSent, groupChatLog.get(),
-            &SessionChatLog::onMessageSent);
-    connect(messageDispatcher.get(), &IMessageDispatcher::messageComplete, groupChatLog.get(),
-            &SessionChatLog::onMessageComplete);
+    // Like ChatHistory for friends, GroupChatHistory hooks up the dispatcher
+    // signals itself so messages persist across restarts
+    auto history = Nexus::getProfile()->getHistory();
+    auto groupChatLog =
+        std::make_shared<GroupChatHistory>(*newgroup, history, *core, Settings::getInstance(),
+                                           *messageDispatcher);
 
     auto notifyReceivedCallback = [this, groupId](const ToxPk& author, const Message& message) {
         auto isTargeted = std::any_of(message.metadata.begin(), message.metadata.end(),
@@ -2223,10 +2596,12 @@ void Widget::onUserAwayCheck()
         qDebug() << "auto away activated at" << QTime::currentTime().toString();
         emit statusSet(Status::Status::Away);
         autoAwayActive = true;
+        IdleMode::getInstance().setIdle(true);
     } else if (autoAwayActive && !away) {
         qDebug() << "auto away deactivated at" << QTime::currentTime().toString();
         emit statusSet(Status::Status::Online);
         autoAwayActive = false;
+        IdleMode::getInstance().setIdle(false);
     }
 #endif
 }
@@ -2255,6 +2630,7 @@ void Widget::onTryCreateTrayIcon()
             trayMenu->addAction(statusAway);
             trayMenu->addAction(statusBusy);
             trayMenu->addSeparator();
+            trayMenu->addAction(actionSwitchProfile);
             trayMenu->addAction(actionLogout);
             trayMenu->addAction(actionQuit);
             icon->setContextMenu(trayMenu);
@@ -2277,10 +2653,15 @@ void Widget::onTryCreateTrayIcon()
             show();
         }
     } else {
-        disconnect(timer, &QTimer::timeout, this, &Widget::onTryCreateTrayIcon);
-        if (!icon) {
-            qWarning() << "No system tray detected!";
-            show();
+        // the shared coarse timer keeps ticking for the away check, so this
+        // settles into a no-op instead of severing a timer connection
+        static bool gaveUp = false;
+        if (!gaveUp) {
+            gaveUp = true;
+            if (!icon) {
+                qWarning() << "No system tray detected!";
+                show();
+            }
         }
     }
 }
@@ -2332,7 +2713,9 @@ void Widget::onFriendTypingChanged(uint32_t friendnumber, bool isTyping)
         return;
     }
 
-    chatForms[f->getPublicKey()]->setFriendTyping(isTyping);
+    if (ChatForm* form = chatForms.value(f->getPublicKey(), nullptr)) {
+        form->setFriendTyping(isTyping);
+    }
 }
 
 void Widget::onSetShowSystemTray(bool newValue)
@@ -2410,16 +2793,15 @@ void Widget::clearAllReceipts()
 
 void Widget::reloadTheme()
 {
-    this->setStyleSheet(Style::getStylesheet("window/general.css"));
-    QString statusPanelStyle = Style::getStylesheet("window/statusPanel.css");
-    ui->tooliconsZone->setStyleSheet(Style::getStylesheet("tooliconsZone/tooliconsZone.css"));
-    ui->statusPanel->setStyleSheet(statusPanelStyle);
-    ui->statusHead->setStyleSheet(statusPanelStyle);
-    ui->friendList->setStyleSheet(Style::getStylesheet("friendList/friendList.css"));
-    ui->statusButton->setStyleSheet(Style::getStylesheet("statusButton/statusButton.css"));
+    Style::setStylesheet(this, "window/general.css");
+    Style::setStylesheet(ui->tooliconsZone, "tooliconsZone/tooliconsZone.css");
+    Style::setStylesheet(ui->statusPanel, "window/statusPanel.css");
+    Style::setStylesheet(ui->statusHead, "window/statusPanel.css");
+    Style::setStylesheet(ui->friendList, "friendList/friendList.css");
+    Style::setStylesheet(ui->statusButton, "statusButton/statusButton.css");
     contactListWidget->reDraw();
 
-    profilePicture->setStyleSheet(Style::getStylesheet("window/profile.css"));
+    Style::setStylesheet(profilePicture, "window/profile.css");
 
     if (contentLayout != nullptr) {
         contentLayout->reloadTheme();
@@ -2434,8 +2816,8 @@ void Widget::reloadTheme()
     }
 
 
-    for (auto f : FriendList::getAllFriends()) {
-        chatForms[f->getPublicKey()]->reloadTheme();
+    for (auto form : chatForms) {
+        form->reloadTheme();
     }
 
     for (auto g : GroupList::getAllGroups()) {
@@ -2466,12 +2848,19 @@ inline QIcon Widget::prepareIcon(QString path, int w, int h)
     desktop = desktop.toLower();
     if (desktop == "xfce" || desktop.contains("gnome") || desktop == "mate" || desktop == "x-cinnamon") {
         if (w > 0 && h > 0) {
-            QSvgRenderer renderer(path);
-
-            QPixmap pm(w, h);
-            pm.fill(Qt::transparent);
-            QPainter painter(&pm);
-            renderer.render(&painter, pm.rect());
+            // the same few icons get re-prepared on every status change, so
+            // the rendered pixmaps are shared through QPixmapCache
+            const QString key = QStringLiteral("icon:%1:%2x%3").arg(path).arg(w).arg(h);
+            QPixmap pm;
+            if (!QPixmapCache::find(key, &pm)) {
+                QSvgRenderer renderer(path);
+
+                pm = QPixmap(w, h);
+                pm.fill(Qt::transparent);
+                QPainter painter(&pm);
+                renderer.render(&painter, pm.rect());
+                QPixmapCache::insert(key, pm);
+            }
 
             return QIcon(pm);
         }
@@ -2640,6 +3029,8 @@ void Widget::retranslateUi()
     statusAway->setText(tr("Away", "Button to set your status to 'Away'"));
     statusBusy->setText(tr("Busy", "Button to set your status to 'Busy'"));
     actionLogout->setText(tr("Logout", "Tray action menu to logout user"));
+    actionSwitchProfile->setText(
+        tr("Switch Profile", "Tray action menu to switch to another profile"));
     actionQuit->setText(tr("Exit", "Tray action menu to exit tox"));
     actionShow->setText(tr("Show", "Tray action menu to show qTox window"));
 
@@ -2672,7 +3063,7 @@ void Widget::focusChatInput()
 {
     if (activeChatroomWidget) {
         if (const Friend* f = activeChatroomWidget->getFriend()) {
-            chatForms[f->getPublicKey()]->focusInput();
+            getOrCreateChatForm(f->getPublicKey())->focusInput();
         } else if (Group* g = activeChatroomWidget->getGroup()) {
             groupChatForms[g->getPersistentId()]->focusInput();
         }
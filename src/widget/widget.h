@@ -23,6 +23,7 @@
 #include "ui_mainwindow.h"
 
 #include <QFileInfo>
+#include <QHash>
 #include <QMainWindow>
 #include <QPointer>
 #include <QSystemTrayIcon>
@@ -38,6 +39,7 @@
 #include "src/core/toxpk.h"
 #include "src/model/friendmessagedispatcher.h"
 #include "src/model/groupmessagedispatcher.h"
+#include "src/model/inboundmsgqueue.h"
 #if DESKTOP_NOTIFICATIONS
 #include "src/platform/desktop_notifications/desktopnotify.h"
 #endif
@@ -164,8 +166,10 @@ public slots:
     void setUsername(const QString& username);
     void setStatusMessage(const QString& statusMessage);
     void addFriend(uint32_t friendId, const ToxPk& friendPk);
+    void onFriendsLoaded(const QVector<CoreFriendInfo>& friends);
     void addFriendFailed(const ToxPk& userId, const QString& errorInfo = QString());
     void onFriendStatusChanged(int friendId, Status::Status status);
+    void onFriendsStatusesChanged(const QVector<QPair<uint32_t, Status::Status>>& statuses);
     void onFriendStatusMessageChanged(int friendId, const QString& message);
     void onFriendDisplayedNameChanged(const QString& displayed);
     void onFriendUsernameChanged(int friendId, const QString& username);
@@ -236,6 +240,8 @@ private slots:
     void incomingNotification(uint32_t friendId);
     void onRejectCall(uint32_t friendId);
     void onStopNotification();
+    void dispatchInboundMessage(const ToxPk& friendPk, bool isAction, const QString& content);
+    void onInboundMessageShed(const ToxPk& friendPk, bool isAction, const QString& content);
     void dispatchFile(ToxFile file);
     void dispatchFileWithBool(ToxFile file, bool);
     void dispatchFileSendFailed(uint32_t friendId, const QString& fileName);
@@ -255,6 +261,8 @@ private:
     void moveEvent(QMoveEvent* event) final override;
 
     bool newMessageAlert(QWidget* currentWindow, bool isActive, bool sound = true, bool notify = true);
+    bool coalesceNotification(const QByteArray& id, const ToxPk& friendPk, const GroupId& groupId);
+    void flushNotificationDigests();
     void setActiveToolMenuButton(ActiveToolMenuButton newActiveButton);
     void hideMainForms(GenericChatroomWidget* chatroomWidget);
     Group* createGroup(uint32_t groupnumber, const GroupId& groupId);
@@ -273,6 +281,9 @@ private:
     void retranslateUi();
     void focusChatInput();
     void openDialog(GenericChatroomWidget* widget, bool newWindow);
+    ChatForm* getOrCreateChatForm(const ToxPk& friendPk);
+    SettingsWidget* getOrCreateSettingsWidget();
+    ProfileForm* getOrCreateProfileForm();
     void playNotificationSound(IAudioSink::Sound sound, bool loop = false);
     void cleanupNotificationSound();
 
@@ -283,6 +294,7 @@ private:
     QAction* statusAway;
     QAction* statusBusy;
     QAction* actionLogout;
+    QAction* actionSwitchProfile;
     QAction* actionQuit;
     QAction* actionShow;
 
@@ -306,25 +318,44 @@ private:
     AddFriendForm* addFriendForm;
     GroupInviteForm* groupInviteForm;
 
-    ProfileInfo* profileInfo;
-    ProfileForm* profileForm;
+    // built on first access, see getOrCreateProfileForm()
+    ProfileInfo* profileInfo = nullptr;
+    ProfileForm* profileForm = nullptr;
 
     QPointer<SettingsWidget> settingsWidget;
     std::unique_ptr<UpdateCheck> updateCheck; // ownership should be moved outside Widget once non-singleton
     FilesForm* filesForm;
     static Widget* instance;
     GenericChatroomWidget* activeChatroomWidget;
+    // true while a status-change burst is being applied, see onFriendsStatusesChanged()
+    bool statusStormActive = false;
+
+    // notification scheduler state, see coalesceNotification()
+    struct NotificationDigest
+    {
+        bool isGroup = false;
+        ToxPk friendPk;
+        GroupId groupId;
+        int count = 0;
+    };
+    QHash<QByteArray, NotificationDigest> pendingNotifications;
+    QHash<QByteArray, qint64> lastNotificationTimes;
+    QVector<qint64> recentNotificationTimes;
+    QTimer* notificationDigestTimer;
     FriendListWidget* contactListWidget;
     MaskablePixmapWidget* profilePicture;
     bool notify(QObject* receiver, QEvent* event);
     bool autoAwayActive = false;
-    QTimer* timer;
+    QTimer* searchDebounceTimer;
     bool eventFlag;
     bool eventIcon;
     bool wasMaximized = false;
     QPushButton* friendRequestsButton;
     QPushButton* groupInvitesButton;
     unsigned int unreadGroupInvites;
+    // unread badges restored from the database, fetched once per profile load
+    QHash<QString, int> persistedUnread;
+    bool readStatesLoaded = false;
     int icon_size;
 
     IAudioControl& audio;
@@ -358,6 +389,7 @@ private:
 
 
     MessageProcessor::SharedParams sharedMessageProcessorParams;
+    InboundMsgQueue inboundMsgQueue;
 #if DESKTOP_NOTIFICATIONS
     DesktopNotify notifier;
 #endif
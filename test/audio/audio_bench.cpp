@@ -0,0 +1,149 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Not a test: a loopback benchmark for the OpenAL audio backend. Build the
+// qtox_bench_audio target and run it manually; it prints one JSON line so
+// results can be compared across revisions. It selects openal-soft's null
+// driver when the caller hasn't chosen one, so it runs headless in a lab,
+// where the playback figures are still meaningful (buffer queueing runs the
+// full path) while capture simply reports as unavailable if there is no
+// capture device.
+
+#include "src/audio/backend/openal.h"
+#include "src/audio/iaudiosink.h"
+#include "src/audio/iaudiosource.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+constexpr int sampleRate = 48000;
+constexpr unsigned channels = 2;
+// one 20ms frame, the cadence toxav uses
+constexpr int frameSamples = sampleRate / 50;
+constexpr int runSeconds = 3;
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) {
+        return -1;
+    }
+
+    std::sort(values.begin(), values.end());
+    const size_t idx = static_cast<size_t>(p * (values.size() - 1));
+    return values[idx];
+}
+
+QJsonObject percentiles(const std::vector<double>& values)
+{
+    QJsonObject result;
+    result["p50"] = percentile(values, 0.50);
+    result["p90"] = percentile(values, 0.90);
+    result["p99"] = percentile(values, 0.99);
+    return result;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // headless by default; respect an explicit driver choice from the caller
+    if (qEnvironmentVariableIsEmpty("ALSOFT_DRIVERS")) {
+        qputenv("ALSOFT_DRIVERS", "null");
+    }
+
+    QCoreApplication app(argc, argv);
+
+    OpenAL audio;
+
+    std::unique_ptr<IAudioSink> sink = audio.makeSink();
+    if (!sink || !*sink) {
+        fprintf(stderr, "No output device, playback path can't be measured\n");
+        return EXIT_FAILURE;
+    }
+
+    // one frame of a 440Hz tone
+    std::vector<int16_t> tone(static_cast<size_t>(frameSamples) * channels);
+    for (int i = 0; i < frameSamples; ++i) {
+        const int16_t sample =
+            static_cast<int16_t>(8192 * std::sin(2.0 * M_PI * 440.0 * i / sampleRate));
+        for (unsigned c = 0; c < channels; ++c) {
+            tone[static_cast<size_t>(i) * channels + c] = sample;
+        }
+    }
+
+    std::vector<double> enqueueUs;
+    std::vector<double> captureGapMs;
+    std::vector<double> loopbackUs;
+
+    // Playback: enqueue one frame per 20ms tick at real-time pace, timing
+    // each playAudioBuffer call
+    QTimer playbackTimer;
+    playbackTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&playbackTimer, &QTimer::timeout, [&]() {
+        QElapsedTimer timer;
+        timer.start();
+        sink->playAudioBuffer(tone.data(), frameSamples, channels, sampleRate);
+        enqueueUs.push_back(timer.nsecsElapsed() / 1e3);
+    });
+    playbackTimer.start(20);
+
+    // Capture: every delivered frame is looped straight back into the sink,
+    // timing the handler the way a call's send path would pay for it
+    std::unique_ptr<IAudioSource> source = audio.makeSource();
+    QElapsedTimer captureGapTimer;
+    if (source) {
+        QObject::connect(source.get(), &IAudioSource::frameAvailable,
+                         [&](const int16_t* pcm, size_t samples, uint8_t chans, uint32_t rate) {
+                             if (captureGapTimer.isValid()) {
+                                 captureGapMs.push_back(captureGapTimer.nsecsElapsed() / 1e6);
+                             }
+                             captureGapTimer.start();
+
+                             QElapsedTimer timer;
+                             timer.start();
+                             sink->playAudioBuffer(pcm, samples, chans, rate);
+                             loopbackUs.push_back(timer.nsecsElapsed() / 1e3);
+                         });
+    }
+
+    QTimer::singleShot(runSeconds * 1000, &app, &QCoreApplication::quit);
+    app.exec();
+    playbackTimer.stop();
+
+    QJsonObject root;
+    root["benchmark"] = QStringLiteral("qtox_bench_audio");
+    root["frames_played"] = static_cast<qint64>(enqueueUs.size());
+    root["enqueue_us"] = percentiles(enqueueUs);
+    root["jitter_target_depth"] = static_cast<qint64>(sink->getJitterTargetDepth());
+    root["jitter_underruns"] = static_cast<qint64>(sink->getJitterUnderruns());
+    root["capture_available"] = !captureGapMs.empty();
+    root["capture_frames"] = static_cast<qint64>(loopbackUs.size());
+    root["capture_gap_ms"] = percentiles(captureGapMs);
+    root["loopback_us"] = percentiles(loopbackUs);
+
+    printf("%s\n", QJsonDocument(root).toJson(QJsonDocument::Compact).constData());
+    return EXIT_SUCCESS;
+}
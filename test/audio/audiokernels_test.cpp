@@ -0,0 +1,269 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "src/audio/backend/audiokernels.h"
+
+#include <QtTest/QtTest>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+// one 20ms stereo frame at 48kHz, the size the backend feeds the kernels
+constexpr uint32_t frameSamples = 960 * 2;
+
+std::vector<int16_t> makeNoise(uint32_t samples, uint32_t seed)
+{
+    std::mt19937 gen{seed};
+    std::uniform_int_distribution<int32_t> dist{std::numeric_limits<int16_t>::min(),
+                                                std::numeric_limits<int16_t>::max()};
+    std::vector<int16_t> buffer(samples);
+    for (auto& sample : buffer) {
+        sample = static_cast<int16_t>(dist(gen));
+    }
+    return buffer;
+}
+
+// the scalar reference the vector paths must match
+void applyGainReference(int16_t* buffer, uint32_t samples, float gainFactor)
+{
+    for (uint32_t i = 0; i < samples; ++i) {
+        buffer[i] =
+            qBound<int16_t>(std::numeric_limits<int16_t>::min(), qRound(buffer[i] * gainFactor),
+                            std::numeric_limits<int16_t>::max());
+    }
+}
+} // namespace
+
+class TestAudioKernels : public QObject
+{
+    Q_OBJECT
+private slots:
+    void applyGainUnityTest();
+    void applyGainMatchesReferenceTest();
+    void applyGainClipsTest();
+    void applyGainOddLengthTest();
+    void sumOfSquaresTest();
+    void resampleFrameCountTest();
+    void resampleRampTest();
+    void resampleMatchesReferenceTest();
+    void resampleStereoKeepsChannelsTest();
+    void resampleSingleFrameTest();
+    void applyGainBenchmark();
+    void sumOfSquaresBenchmark();
+    void resampleBenchmark();
+};
+
+void TestAudioKernels::applyGainUnityTest()
+{
+    auto buffer = makeNoise(frameSamples, 1);
+    const auto original = buffer;
+
+    AudioKernels::applyGain(buffer.data(), frameSamples, 1.0f);
+    QVERIFY(buffer == original);
+}
+
+void TestAudioKernels::applyGainMatchesReferenceTest()
+{
+    const float gains[] = {0.0f, 0.25f, 0.7071f, 1.5f, 3.1623f};
+    for (const float gain : gains) {
+        auto buffer = makeNoise(frameSamples, 2);
+        auto expected = buffer;
+
+        AudioKernels::applyGain(buffer.data(), frameSamples, gain);
+        applyGainReference(expected.data(), frameSamples, gain);
+
+        for (uint32_t i = 0; i < frameSamples; ++i) {
+            // the vector and scalar paths round in single precision, but
+            // allow one LSB of slack in case libm rounds differently
+            QVERIFY(qAbs(buffer[i] - expected[i]) <= 1);
+        }
+    }
+}
+
+void TestAudioKernels::applyGainClipsTest()
+{
+    std::vector<int16_t> buffer(frameSamples);
+    for (uint32_t i = 0; i < frameSamples; ++i) {
+        buffer[i] = (i % 2 == 0) ? std::numeric_limits<int16_t>::max()
+                                 : std::numeric_limits<int16_t>::min();
+    }
+
+    AudioKernels::applyGain(buffer.data(), frameSamples, 100.0f);
+
+    for (uint32_t i = 0; i < frameSamples; ++i) {
+        const int16_t expected = (i % 2 == 0) ? std::numeric_limits<int16_t>::max()
+                                              : std::numeric_limits<int16_t>::min();
+        QCOMPARE(buffer[i], expected);
+    }
+}
+
+void TestAudioKernels::applyGainOddLengthTest()
+{
+    // lengths that don't divide by the vector width exercise the tail loop
+    for (const uint32_t samples : {1u, 7u, 8u, 9u, 15u}) {
+        auto buffer = makeNoise(samples, 3);
+        auto expected = buffer;
+
+        AudioKernels::applyGain(buffer.data(), samples, 2.0f);
+        applyGainReference(expected.data(), samples, 2.0f);
+
+        for (uint32_t i = 0; i < samples; ++i) {
+            QVERIFY(qAbs(buffer[i] - expected[i]) <= 1);
+        }
+    }
+}
+
+void TestAudioKernels::sumOfSquaresTest()
+{
+    const auto buffer = makeNoise(frameSamples, 4);
+
+    double expected = 0.0;
+    for (const int16_t sample : buffer) {
+        expected += static_cast<double>(sample) * sample;
+    }
+
+    const float sum = AudioKernels::sumOfSquares(buffer.data(), frameSamples);
+    // single precision accumulation, allow a small relative error
+    QVERIFY(std::fabs(sum - expected) <= expected * 1e-4);
+}
+
+void TestAudioKernels::resampleFrameCountTest()
+{
+    // the rates Opus actually produces, converted to the 48k device rate
+    QCOMPARE(AudioKernels::resampledFrameCount(480, 24000, 48000), 960u);
+    QCOMPARE(AudioKernels::resampledFrameCount(320, 16000, 48000), 960u);
+    QCOMPARE(AudioKernels::resampledFrameCount(960, 48000, 48000), 960u);
+    QCOMPARE(AudioKernels::resampledFrameCount(960, 48000, 24000), 480u);
+}
+
+void TestAudioKernels::resampleRampTest()
+{
+    // a linear ramp must come out of a linear interpolator as a linear ramp
+    constexpr uint32_t inFrames = 481;
+    std::vector<int16_t> in(inFrames);
+    for (uint32_t i = 0; i < inFrames; ++i) {
+        in[i] = static_cast<int16_t>(i * 20);
+    }
+
+    const uint32_t outFrames = 960;
+    std::vector<int16_t> out(outFrames);
+    AudioKernels::resampleLinear(in.data(), inFrames, out.data(), outFrames, 1);
+
+    for (uint32_t i = 0; i < outFrames; ++i) {
+        const double expected = static_cast<double>(i) * (inFrames - 1) / outFrames * 20.0;
+        QVERIFY(qAbs(out[i] - expected) <= 1.0);
+    }
+}
+
+void TestAudioKernels::resampleMatchesReferenceTest()
+{
+    // the mono vector path against the scalar formula it implements
+    const auto in = makeNoise(480, 7);
+    const uint32_t outFrames = 960;
+
+    std::vector<int16_t> out(outFrames);
+    AudioKernels::resampleLinear(in.data(), 480, out.data(), outFrames, 1);
+
+    const uint64_t step = (static_cast<uint64_t>(480 - 1) << 32) / outFrames;
+    uint64_t pos = 0;
+    for (uint32_t i = 0; i < outFrames; ++i) {
+        const uint32_t idx = static_cast<uint32_t>(pos >> 32);
+        const float frac = static_cast<uint32_t>(pos & 0xFFFFFFFFu) * (1.0f / 4294967296.0f);
+        const float s0 = in[idx];
+        const float s1 = in[idx + 1];
+        const int16_t expected = static_cast<int16_t>(qRound(s0 + (s1 - s0) * frac));
+        QVERIFY(qAbs(out[i] - expected) <= 1);
+        pos += step;
+    }
+}
+
+void TestAudioKernels::resampleStereoKeepsChannelsTest()
+{
+    // constant but different values per channel must survive interleaved
+    // resampling untouched
+    constexpr uint32_t inFrames = 320;
+    std::vector<int16_t> in(inFrames * 2);
+    for (uint32_t i = 0; i < inFrames; ++i) {
+        in[i * 2] = 1000;
+        in[i * 2 + 1] = -2000;
+    }
+
+    const uint32_t outFrames = 960;
+    std::vector<int16_t> out(outFrames * 2);
+    AudioKernels::resampleLinear(in.data(), inFrames, out.data(), outFrames, 2);
+
+    for (uint32_t i = 0; i < outFrames; ++i) {
+        QCOMPARE(out[i * 2], static_cast<int16_t>(1000));
+        QCOMPARE(out[i * 2 + 1], static_cast<int16_t>(-2000));
+    }
+}
+
+void TestAudioKernels::resampleSingleFrameTest()
+{
+    // one input frame has nothing to interpolate with and must be held
+    const int16_t in[2] = {123, -456};
+    std::vector<int16_t> out(10 * 2, 0);
+
+    AudioKernels::resampleLinear(in, 1, out.data(), 10, 2);
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        QCOMPARE(out[i * 2], static_cast<int16_t>(123));
+        QCOMPARE(out[i * 2 + 1], static_cast<int16_t>(-456));
+    }
+}
+
+void TestAudioKernels::applyGainBenchmark()
+{
+    auto buffer = makeNoise(frameSamples, 5);
+
+    QBENCHMARK
+    {
+        AudioKernels::applyGain(buffer.data(), frameSamples, 1.1f);
+    }
+}
+
+void TestAudioKernels::sumOfSquaresBenchmark()
+{
+    const auto buffer = makeNoise(frameSamples, 6);
+
+    QBENCHMARK
+    {
+        volatile float sum = AudioKernels::sumOfSquares(buffer.data(), frameSamples);
+        Q_UNUSED(sum);
+    }
+}
+
+void TestAudioKernels::resampleBenchmark()
+{
+    // one 20ms mono frame from 24k to the 48k device rate, the most common
+    // conversion a group call feeds through the playback path
+    const auto in = makeNoise(480, 8);
+    std::vector<int16_t> out(960);
+
+    QBENCHMARK
+    {
+        AudioKernels::resampleLinear(in.data(), 480, out.data(), 960, 1);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestAudioKernels)
+#include "audiokernels_test.moc"
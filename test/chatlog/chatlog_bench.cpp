@@ -0,0 +1,177 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Not a test: a standalone rendering benchmark for the chat view. Build the
+// qtox_bench_chatlog target and run it manually (it forces the offscreen
+// platform plugin, so it works headless); it prints one JSON line so results
+// can be compared across revisions. Pass a line count to override the
+// default, e.g. `qtox_bench_chatlog 100000`.
+
+#include "src/chatlog/chatlog.h"
+#include "src/chatlog/chatmessage.h"
+#include "src/core/toxfile.h"
+
+#include <QApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QScrollBar>
+
+namespace {
+constexpr int defaultLines = 10 * 1000;
+// insertChatlinesOnTop is fed in pages, like loading history does
+constexpr int pageSize = 100;
+constexpr int scrollSteps = 100;
+
+/**
+ * @brief One synthetic chat line; the mix approximates a real transcript.
+ */
+ChatLine::Ptr benchLine(int row, const QDateTime& baseTime)
+{
+    const QDateTime date = baseTime.addSecs(row);
+    const bool isMe = row % 2 == 0;
+    const QString sender = isMe ? QStringLiteral("Me") : QStringLiteral("Bench Friend");
+
+    // every 50th line is a file transfer widget
+    if (row % 50 == 0) {
+        ToxFile file{1, 0, QStringLiteral("bench-%1.bin").arg(row),
+                     QStringLiteral("/tmp/bench.bin"), ToxFile::SENDING};
+        return ChatMessage::createFileTransferMessage(sender, file, isMe, date);
+    }
+
+    QString text;
+    switch (row % 4) {
+    case 0:
+        text = QStringLiteral("ok");
+        break;
+    case 1:
+        text = QStringLiteral("a medium length line with an emoji \xF0\x9F\x98\x80 in it");
+        break;
+    case 2:
+        text = QStringLiteral("a longer message that wraps across several layout lines when "
+                              "the chat view is at a typical width, the kind of paragraph "
+                              "people paste from somewhere else %1")
+                   .arg(row);
+        break;
+    default:
+        text = QStringLiteral("short reply %1").arg(row);
+        break;
+    }
+
+    return ChatMessage::createChatMessage(sender, text, ChatMessage::NORMAL, isMe, date);
+}
+
+/**
+ * @brief Peak RSS in kilobytes, or -1 where /proc isn't available.
+ */
+qint64 peakRssKb()
+{
+    QFile status{QStringLiteral("/proc/self/status")};
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("VmHWM:")) {
+            return QString::fromLatin1(line.mid(6)).remove("kB").trimmed().toLongLong();
+        }
+    }
+    return -1;
+}
+
+double paintOnce(ChatLog& chatLog, QImage& target)
+{
+    target.fill(Qt::white);
+    QPainter painter{&target};
+    QElapsedTimer timer;
+    timer.start();
+    chatLog.render(&painter);
+    return timer.nsecsElapsed() / 1e6;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // headless by default; respect an explicit platform choice from the caller
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    int lines = defaultLines;
+    if (argc > 1) {
+        lines = QString::fromLocal8Bit(argv[1]).toInt();
+    }
+
+    ChatLog chatLog;
+    chatLog.resize(800, 600);
+    chatLog.show();
+
+    const QDateTime baseTime = QDateTime::currentDateTime().addDays(-30);
+
+    // Insert in pages on top, newest first, the way history loading feeds it
+    QElapsedTimer insertTimer;
+    insertTimer.start();
+    for (int first = lines - pageSize; first >= 0; first -= pageSize) {
+        QList<ChatLine::Ptr> page;
+        for (int row = first; row < first + pageSize; ++row) {
+            page.append(benchLine(row, baseTime));
+        }
+        chatLog.insertChatlinesOnTop(page);
+        app.processEvents();
+    }
+    const double insertMs = insertTimer.nsecsElapsed() / 1e6;
+
+    QElapsedTimer relayoutTimer;
+    relayoutTimer.start();
+    chatLog.forceRelayout();
+    const double relayoutMs = relayoutTimer.nsecsElapsed() / 1e6;
+
+    // Scripted scroll through the whole transcript, painting at every stop
+    QImage target{800, 600, QImage::Format_ARGB32_Premultiplied};
+    QScrollBar* scrollBar = chatLog.verticalScrollBar();
+    const int scrollMax = scrollBar->maximum();
+    double paintTotalMs = 0;
+    double paintWorstMs = 0;
+    for (int step = 0; step <= scrollSteps; ++step) {
+        scrollBar->setValue(scrollMax * step / scrollSteps);
+        app.processEvents();
+        const double ms = paintOnce(chatLog, target);
+        paintTotalMs += ms;
+        paintWorstMs = qMax(paintWorstMs, ms);
+    }
+
+    QJsonObject root;
+    root["benchmark"] = QStringLiteral("qtox_bench_chatlog");
+    root["lines"] = lines;
+    root["insert_ms"] = insertMs;
+    root["relayout_ms"] = relayoutMs;
+    root["paint_avg_ms"] = paintTotalMs / (scrollSteps + 1);
+    root["paint_worst_ms"] = paintWorstMs;
+    root["peak_rss_kb"] = peakRssKb();
+
+    printf("%s\n", QJsonDocument(root).toJson(QJsonDocument::Compact).constData());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "src/model/inboundmsgqueue.h"
+
+#include <QtTest/QtTest>
+
+namespace {
+ToxPk makePk(char c)
+{
+    return ToxPk{QByteArray(32, c)};
+}
+} // namespace
+
+class TestInboundMsgQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void testDelivery();
+    void testOverflowShedding();
+    void testVisiblePriority();
+
+    void onMessageReady(const ToxPk& friendPk, bool isAction, const QString& content)
+    {
+        ready.append({friendPk, content});
+    }
+
+    void onMessageShed(const ToxPk& friendPk, bool isAction, const QString& content)
+    {
+        shed.append({friendPk, content});
+    }
+
+private:
+    std::unique_ptr<InboundMsgQueue> queue;
+    QVector<QPair<ToxPk, QString>> ready;
+    QVector<QPair<ToxPk, QString>> shed;
+};
+
+/**
+ * @brief Test initialization, resets the queue and captured signals
+ */
+void TestInboundMsgQueue::init()
+{
+    queue = std::unique_ptr<InboundMsgQueue>(new InboundMsgQueue());
+    connect(queue.get(), &InboundMsgQueue::messageReady, this,
+            &TestInboundMsgQueue::onMessageReady);
+    connect(queue.get(), &InboundMsgQueue::messageShed, this, &TestInboundMsgQueue::onMessageShed);
+    ready.clear();
+    shed.clear();
+}
+
+/**
+ * @brief Tests that enqueued messages are delivered in order once the event
+ * loop runs, not synchronously from enqueue
+ */
+void TestInboundMsgQueue::testDelivery()
+{
+    const ToxPk friendPk = makePk('a');
+    queue->enqueue(friendPk, false, "one");
+    queue->enqueue(friendPk, false, "two");
+
+    // nothing is dispatched from inside the enqueueing call
+    QVERIFY(ready.isEmpty());
+    QCOMPARE(queue->depth(), static_cast<size_t>(2));
+
+    QTRY_COMPARE(ready.size(), 2);
+    QCOMPARE(ready[0].second, QString("one"));
+    QCOMPARE(ready[1].second, QString("two"));
+    QCOMPARE(queue->depth(), static_cast<size_t>(0));
+    QVERIFY(shed.isEmpty());
+}
+
+/**
+ * @brief Tests that a flooded queue sheds its oldest messages instead of
+ * growing without bound
+ */
+void TestInboundMsgQueue::testOverflowShedding()
+{
+    const ToxPk friendPk = makePk('b');
+
+    // well past any reasonable per-friend cap
+    const int flood = 10000;
+    for (int i = 0; i < flood; ++i) {
+        queue->enqueue(friendPk, false, QString::number(i));
+    }
+
+    QVERIFY(!shed.isEmpty());
+    QVERIFY(queue->depth() < static_cast<size_t>(flood));
+    QCOMPARE(queue->shedCount(), static_cast<quint64>(shed.size()));
+
+    // the oldest messages are the ones shed
+    QCOMPARE(shed.first().second, QString("0"));
+
+    // what survives is the tail of the flood, still in order
+    QTRY_COMPARE(static_cast<quint64>(ready.size()), flood - queue->shedCount());
+    QCOMPARE(ready.last().second, QString::number(flood - 1));
+}
+
+/**
+ * @brief Tests that the visible friend's messages are dispatched before a
+ * backlog queued for somebody else
+ */
+void TestInboundMsgQueue::testVisiblePriority()
+{
+    const ToxPk noisyPk = makePk('c');
+    const ToxPk visiblePk = makePk('d');
+    queue->setVisibleFriend(visiblePk);
+
+    for (int i = 0; i < 100; ++i) {
+        queue->enqueue(noisyPk, false, QString::number(i));
+    }
+    queue->enqueue(visiblePk, false, "on screen");
+
+    QTRY_VERIFY(!ready.isEmpty());
+    QCOMPARE(ready.first().first, visiblePk);
+    QCOMPARE(ready.first().second, QString("on screen"));
+
+    // the backlog still drains fully afterwards
+    QTRY_COMPARE(ready.size(), 101);
+}
+
+QTEST_GUILESS_MAIN(TestInboundMsgQueue)
+#include "inboundmsgqueue_test.moc"
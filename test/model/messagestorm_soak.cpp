@@ -0,0 +1,322 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Not a test: a soak harness for the messaging pipeline. It drives many
+// FriendMessageDispatcher/SessionChatLog pairs through the same mock sender
+// seam the unit tests use, at a configurable rate for a configurable time,
+// and fails if queues don't drain or memory grows out of proportion to the
+// stored messages. Prints one JSON line for cross-revision comparison.
+// Usage: `qtox_soak_messagestorm [friends] [msgs/s per friend] [seconds]`,
+// defaults 200 friends at 5 msg/s for 10s; pass a long duration for a real
+// soak run.
+
+#include "src/core/icorefriendmessagesender.h"
+#include "src/core/icoreidhandler.h"
+#include "src/model/friend.h"
+#include "src/model/friendmessagedispatcher.h"
+#include "src/model/message.h"
+#include "src/model/sessionchatlog.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace {
+constexpr int defaultFriends = 200;
+constexpr int defaultRate = 5;
+constexpr int defaultSeconds = 10;
+constexpr int tickMs = 100;
+// Generous per-message cap: a gross leak trips it, normal bookkeeping doesn't
+constexpr double maxBytesPerMessage = 16 * 1024;
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) {
+        return -1;
+    }
+
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(p * (values.size() - 1))];
+}
+
+/**
+ * @brief Current RSS in kilobytes, or -1 where /proc isn't available.
+ */
+qint64 rssKb()
+{
+    QFile status{QStringLiteral("/proc/self/status")};
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("VmRSS:")) {
+            return QString::fromLatin1(line.mid(6)).remove("kB").trimmed().toLongLong();
+        }
+    }
+    return -1;
+}
+
+class MockCoreIdHandler : public ICoreIdHandler
+{
+public:
+    ToxId getSelfId() const override
+    {
+        return ToxId();
+    }
+
+    ToxPk getSelfPublicKey() const override
+    {
+        return ToxPk(QByteArray(32, 's'));
+    }
+
+    QString getUsername() const override
+    {
+        return QStringLiteral("soak");
+    }
+};
+
+// Always accepts, like a healthy core; receipts are acked a tick later so
+// the offline message engine's bookkeeping stays exercised
+class StormMessageSender : public ICoreFriendMessageSender
+{
+public:
+    bool sendAction(uint32_t friendId, const QString& action, ReceiptNum& receipt) override
+    {
+        return sendMessage(friendId, action, receipt);
+    }
+
+    bool sendMessage(uint32_t friendId, const QString& message, ReceiptNum& receipt) override
+    {
+        receipt = nextReceipt;
+        nextReceipt.get() += 1;
+        pendingReceipts.push_back(receipt);
+        return true;
+    }
+
+    ReceiptNum nextReceipt{0};
+    std::deque<ReceiptNum> pendingReceipts;
+};
+
+ToxPk makePk(uint32_t friendId)
+{
+    QByteArray bytes(32, 0);
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<char>(friendId >> (8 * i));
+    }
+    return ToxPk{bytes};
+}
+
+// One friend's full pipeline: dispatcher through mock core, chat log attached
+// the way a chatroom wires it
+struct SoakFriend
+{
+    SoakFriend(uint32_t friendId, const ICoreIdHandler& idHandler,
+               MessageProcessor::SharedParams& sharedParams)
+        : f{friendId, makePk(friendId)}
+        , processor{sharedParams}
+        , dispatcher{f, processor, sender}
+        , log{idHandler}
+    {
+        f.setStatus(Status::Status::Online);
+
+        QObject::connect(&dispatcher, &IMessageDispatcher::messageSent, &log,
+                         &SessionChatLog::onMessageSent);
+        QObject::connect(&dispatcher, &IMessageDispatcher::messageComplete, &log,
+                         &SessionChatLog::onMessageComplete);
+        QObject::connect(&dispatcher, &IMessageDispatcher::messageReceived, &log,
+                         &SessionChatLog::onMessageReceived);
+    }
+
+    Friend f;
+    StormMessageSender sender;
+    MessageProcessor processor;
+    FriendMessageDispatcher dispatcher;
+    SessionChatLog log;
+    std::map<DispatchedMessageId, qint64> inFlight;
+};
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const int friends = argc > 1 ? QString::fromLocal8Bit(argv[1]).toInt() : defaultFriends;
+    const int rate = argc > 2 ? QString::fromLocal8Bit(argv[2]).toInt() : defaultRate;
+    const int seconds = argc > 3 ? QString::fromLocal8Bit(argv[3]).toInt() : defaultSeconds;
+
+    MockCoreIdHandler idHandler;
+    MessageProcessor::SharedParams sharedParams;
+
+    std::vector<std::unique_ptr<SoakFriend>> soakFriends;
+    soakFriends.reserve(friends);
+    for (int i = 0; i < friends; ++i) {
+        soakFriends.emplace_back(new SoakFriend(i, idHandler, sharedParams));
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+
+    std::vector<double> dispatchUs;
+    std::vector<double> receiveUs;
+    std::vector<double> completionMs;
+    size_t outstanding = 0;
+    size_t maxOutstanding = 0;
+    quint64 messagesSent = 0;
+    quint64 messagesReceived = 0;
+
+    // hook completion latency up per friend
+    for (auto& soakFriend : soakFriends) {
+        SoakFriend* sf = soakFriend.get();
+        QObject::connect(&sf->dispatcher, &IMessageDispatcher::messageSent,
+                         [&, sf](DispatchedMessageId id, const Message&) {
+                             sf->inFlight[id] = clock.nsecsElapsed();
+                             ++outstanding;
+                             maxOutstanding = std::max(maxOutstanding, outstanding);
+                         });
+        QObject::connect(&sf->dispatcher, &IMessageDispatcher::messageComplete,
+                         [&, sf](DispatchedMessageId id) {
+                             auto it = sf->inFlight.find(id);
+                             if (it != sf->inFlight.end()) {
+                                 completionMs.push_back((clock.nsecsElapsed() - it->second) / 1e6);
+                                 sf->inFlight.erase(it);
+                                 --outstanding;
+                             }
+                         });
+    }
+
+    const qint64 startRssKb = rssKb();
+    const int totalTicks = seconds * 1000 / tickMs;
+    const double msgsPerTick = static_cast<double>(rate) * tickMs / 1000.0;
+    double sendCarry = 0;
+
+    QElapsedTimer perCall;
+    for (int tick = 0; tick < totalTicks; ++tick) {
+        const qint64 tickStart = clock.elapsed();
+
+        sendCarry += msgsPerTick;
+        const int sendsThisTick = static_cast<int>(sendCarry);
+        sendCarry -= sendsThisTick;
+
+        for (auto& soakFriend : soakFriends) {
+            SoakFriend* sf = soakFriend.get();
+
+            // ack last tick's sends first, like receipts coming back a
+            // round-trip later
+            while (!sf->sender.pendingReceipts.empty()) {
+                sf->dispatcher.onReceiptReceived(sf->sender.pendingReceipts.front());
+                sf->sender.pendingReceipts.pop_front();
+            }
+
+            for (int i = 0; i < sendsThisTick; ++i) {
+                const QString text =
+                    QStringLiteral("soak message %1 from tick %2").arg(messagesSent).arg(tick);
+
+                perCall.start();
+                sf->dispatcher.sendMessage(false, text);
+                dispatchUs.push_back(perCall.nsecsElapsed() / 1e3);
+                ++messagesSent;
+
+                perCall.start();
+                sf->dispatcher.onMessageReceived(false, text);
+                receiveUs.push_back(perCall.nsecsElapsed() / 1e3);
+                ++messagesReceived;
+            }
+        }
+
+        app.processEvents();
+
+        // hold real-time pace; falling behind just means the tick runs hot
+        const qint64 spent = clock.elapsed() - tickStart;
+        if (spent < tickMs) {
+            QThread::msleep(tickMs - spent);
+        }
+    }
+
+    // final round of acks so every receipt has had its round-trip
+    for (auto& soakFriend : soakFriends) {
+        while (!soakFriend->sender.pendingReceipts.empty()) {
+            soakFriend->dispatcher.onReceiptReceived(soakFriend->sender.pendingReceipts.front());
+            soakFriend->sender.pendingReceipts.pop_front();
+        }
+    }
+
+    const qint64 endRssKb = rssKb();
+
+    bool passed = true;
+
+    // queues must drain completely once all receipts are in
+    if (outstanding != 0) {
+        fprintf(stderr, "%zu messages never completed\n", outstanding);
+        passed = false;
+    }
+
+    // in-flight depth should never exceed a tick's worth of sends per friend,
+    // give or take the ack delay
+    const size_t outstandingBound =
+        static_cast<size_t>(friends) * (static_cast<size_t>(msgsPerTick) + 1) * 2;
+    if (maxOutstanding > outstandingBound) {
+        fprintf(stderr, "In-flight depth peaked at %zu, bound was %zu\n", maxOutstanding,
+                outstandingBound);
+        passed = false;
+    }
+
+    // memory may grow linearly with stored messages, but not faster
+    const quint64 totalMessages = messagesSent + messagesReceived;
+    if (startRssKb >= 0 && endRssKb >= 0 && totalMessages > 0) {
+        const double bytesPerMessage = (endRssKb - startRssKb) * 1024.0 / totalMessages;
+        if (bytesPerMessage > maxBytesPerMessage) {
+            fprintf(stderr, "Memory grew by %.0f bytes per message, cap is %.0f\n",
+                    bytesPerMessage, maxBytesPerMessage);
+            passed = false;
+        }
+    }
+
+    QJsonObject root;
+    root["benchmark"] = QStringLiteral("qtox_soak_messagestorm");
+    root["friends"] = friends;
+    root["rate_per_friend"] = rate;
+    root["seconds"] = seconds;
+    root["messages_sent"] = static_cast<qint64>(messagesSent);
+    root["messages_received"] = static_cast<qint64>(messagesReceived);
+    root["dispatch_us_p50"] = percentile(dispatchUs, 0.50);
+    root["dispatch_us_p90"] = percentile(dispatchUs, 0.90);
+    root["dispatch_us_p99"] = percentile(dispatchUs, 0.99);
+    root["receive_us_p50"] = percentile(receiveUs, 0.50);
+    root["receive_us_p99"] = percentile(receiveUs, 0.99);
+    root["completion_ms_p50"] = percentile(completionMs, 0.50);
+    root["completion_ms_p99"] = percentile(completionMs, 0.99);
+    root["max_outstanding"] = static_cast<qint64>(maxOutstanding);
+    root["rss_start_kb"] = startRssKb;
+    root["rss_end_kb"] = endRssKb;
+    root["passed"] = passed;
+
+    printf("%s\n", QJsonDocument(root).toJson(QJsonDocument::Compact).constData());
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
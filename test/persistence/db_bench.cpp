@@ -0,0 +1,167 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Not a test: a standalone benchmark for the database layer. Build the
+// qtox_bench_db target and run it manually; it prints one JSON line so
+// results can be compared across revisions. Pass a row count to stop at a
+// smaller milestone for quick runs, e.g. `qtox_bench_db 100000`.
+
+#include "src/core/toxpk.h"
+#include "src/persistence/db/rawdatabase.h"
+#include "src/persistence/history.h"
+#include "src/widget/searchtypes.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <memory>
+
+namespace {
+// Page latencies are measured at each of these row counts
+const QVector<size_t> rowMilestones{10 * 1000, 100 * 1000, 1000 * 1000};
+// One page as the chat view loads it
+constexpr size_t pageSize = 100;
+constexpr int pageSamples = 50;
+// A phrase stored once near the start of history, so searching for it from
+// the end walks almost the whole table, like a user searching for an old
+// message
+const QString needle = QStringLiteral("qtoxbenchneedle");
+constexpr size_t needleRow = 500;
+
+QString benchMessage(size_t row)
+{
+    return QStringLiteral("benchmark message number %1 with some filler words to "
+                          "reach a realistic length for a chat line")
+        .arg(row);
+}
+
+/**
+ * @brief Average latency of fetching random pages, in microseconds.
+ */
+double samplePageLatency(History& history, const ToxPk& friendPk, size_t rows)
+{
+    QElapsedTimer timer;
+    qint64 totalNs = 0;
+    size_t fetched = 0;
+
+    for (int i = 0; i < pageSamples; ++i) {
+        const size_t first = qrand() % (rows - pageSize);
+        timer.start();
+        const QList<History::HistMessage> page =
+            history.getMessagesForFriend(friendPk, first, first + pageSize);
+        totalNs += timer.nsecsElapsed();
+        fetched += page.size();
+    }
+
+    if (fetched == 0) {
+        return -1;
+    }
+
+    return totalNs / 1000.0 / pageSamples;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    size_t maxRows = rowMilestones.last();
+    if (argc > 1) {
+        maxRows = QString::fromLocal8Bit(argv[1]).toULongLong();
+    }
+
+    const QString dbPath = QStringLiteral("qtox_bench_db.sqlite");
+    QFile::remove(dbPath);
+
+    auto db = std::make_shared<RawDatabase>(dbPath, QString{}, QByteArray{});
+    if (!db || !db->isOpen()) {
+        fprintf(stderr, "Failed to open %s\n", qPrintable(dbPath));
+        return EXIT_FAILURE;
+    }
+
+    // shared_ptr because History hands weak references to its async callbacks
+    auto history = std::make_shared<History>(db);
+    if (!history->isValid()) {
+        fprintf(stderr, "Failed to initialize history\n");
+        return EXIT_FAILURE;
+    }
+
+    const ToxPk friendPk{QByteArray(32, 'f')};
+    const ToxPk selfPk{QByteArray(32, 's')};
+    const QString friendPkStr = friendPk.toString();
+    const QString selfPkStr = selfPk.toString();
+    const QDateTime baseTime = QDateTime::currentDateTime().addDays(-30);
+
+    // fixed seed so page sampling hits the same offsets on every run
+    qsrand(0);
+
+    QJsonArray milestones;
+    size_t inserted = 0;
+    for (const size_t milestone : rowMilestones) {
+        if (milestone > maxRows) {
+            break;
+        }
+
+        QElapsedTimer insertTimer;
+        insertTimer.start();
+        const size_t batchStart = inserted;
+        for (; inserted < milestone; ++inserted) {
+            const QString message =
+                inserted == needleRow ? needle : benchMessage(inserted);
+            history->addNewMessage(friendPkStr, message, selfPkStr,
+                                   baseTime.addSecs(inserted), true, "Bench Friend");
+        }
+        db->sync();
+        const double insertSeconds = insertTimer.nsecsElapsed() / 1e9;
+
+        const double pageUs = samplePageLatency(*history, friendPk, milestone);
+
+        QElapsedTimer searchTimer;
+        searchTimer.start();
+        const QDateTime found =
+            history->getDateWhereFindPhrase(friendPkStr, QDateTime{}, needle, ParameterSearch{});
+        const double searchMs = searchTimer.nsecsElapsed() / 1e6;
+        if (!found.isValid()) {
+            fprintf(stderr, "Search failed to find the needle at %zu rows\n", milestone);
+            return EXIT_FAILURE;
+        }
+
+        QJsonObject result;
+        result["rows"] = static_cast<qint64>(milestone);
+        result["insert_msgs_per_s"] = (milestone - batchStart) / insertSeconds;
+        result["page_avg_us"] = pageUs;
+        result["search_ms"] = searchMs;
+        milestones.append(result);
+    }
+
+    QJsonObject root;
+    root["benchmark"] = QStringLiteral("qtox_bench_db");
+    root["page_size"] = static_cast<qint64>(pageSize);
+    root["milestones"] = milestones;
+
+    printf("%s\n", QJsonDocument(root).toJson(QJsonDocument::Compact).constData());
+
+    QFile::remove(dbPath);
+    return EXIT_SUCCESS;
+}
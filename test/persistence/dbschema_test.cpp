@@ -35,17 +35,32 @@ private slots:
     void testCreation();
     void testIsNewDb();
     void test0to1();
+    void test1to2();
+    void test2to3();
+    void test3to4();
+    void test4to5();
+    void test5to6();
+    void test6to7();
     void cleanupTestCase();
 private:
     bool initSucess{false};
     void verifyDb(std::shared_ptr<RawDatabase> db, const QMap<QString, QString>& expectedSql);
+    void createSchemaAtVersion(std::shared_ptr<RawDatabase> db, int version);
+    bool columnExists(std::shared_ptr<RawDatabase> db, const QString& table, const QString& column);
+    int64_t indexCount(std::shared_ptr<RawDatabase> db, const QString& index);
 };
 
 const QString testFileList[] = {
     "testCreation.db",
     "testIsNewDbTrue.db",
     "testIsNewDbFalse.db",
-    "test0to1.db"
+    "test0to1.db",
+    "test1to2.db",
+    "test2to3.db",
+    "test3to4.db",
+    "test4to5.db",
+    "test5to6.db",
+    "test6to7.db"
 };
 
 void TestDbSchema::initTestCase()
@@ -80,6 +95,74 @@ void TestDbSchema::verifyDb(std::shared_ptr<RawDatabase> db, const QMap<QString,
         })));
 }
 
+/**
+ * @brief Brings an empty db to the given schema version through the real
+ * migration chain, so each testNtoN+1 starts from the exact state the
+ * migration under test sees in the field.
+ */
+void TestDbSchema::createSchemaAtVersion(std::shared_ptr<RawDatabase> db, int version)
+{
+    QVector<RawDatabase::Query> queries;
+    queries += RawDatabase::Query(QStringLiteral(
+        "CREATE TABLE peers "
+        "(id INTEGER PRIMARY KEY, "
+        "public_key TEXT NOT NULL UNIQUE);"
+        "CREATE TABLE aliases "
+        "(id INTEGER PRIMARY KEY, "
+        "owner INTEGER, "
+        "display_name BLOB NOT NULL, "
+        "UNIQUE(owner, display_name));"
+        "CREATE TABLE history "
+        "(id INTEGER PRIMARY KEY, "
+        "timestamp INTEGER NOT NULL, "
+        "chat_id INTEGER NOT NULL, "
+        "sender_alias INTEGER NOT NULL, "
+        "message BLOB NOT NULL);"
+        "CREATE TABLE faux_offline_pending "
+        "(id INTEGER PRIMARY KEY);"));
+    if (version >= 1)
+        dbSchema0to1(db, queries);
+    if (version >= 2)
+        dbSchema1to2(queries);
+    if (version >= 3)
+        dbSchema2to3(queries);
+    if (version >= 4)
+        dbSchema3to4(queries);
+    if (version >= 5)
+        dbSchema4to5(queries);
+    if (version >= 6)
+        dbSchema5to6(queries);
+    if (version >= 7)
+        dbSchema6to7(queries);
+    QVERIFY(db->execNow(queries));
+}
+
+bool TestDbSchema::columnExists(std::shared_ptr<RawDatabase> db, const QString& table,
+                                const QString& column)
+{
+    bool found = false;
+    if (!db->execNow(RawDatabase::Query(QStringLiteral("PRAGMA table_info(%1);").arg(table),
+        [&](const QVector<QVariant>& row) {
+            if (row[1].toString() == column) {
+                found = true;
+            }
+        }))) {
+        return false;
+    }
+    return found;
+}
+
+int64_t TestDbSchema::indexCount(std::shared_ptr<RawDatabase> db, const QString& index)
+{
+    int64_t count = -1;
+    db->execNow(RawDatabase::Query(QStringLiteral(
+        "SELECT COUNT(*) FROM sqlite_master WHERE type='index' AND name='%1';").arg(index),
+        [&](const QVector<QVariant>& row) {
+            count = row[0].toLongLong();
+        }));
+    return count;
+}
+
 void TestDbSchema::testCreation()
 {
     QVector<RawDatabase::Query> queries;
@@ -88,9 +171,12 @@ void TestDbSchema::testCreation()
     QVERIFY(db->execNow(queries));
     const QMap<QString, QString> expectedSql {
         {"aliases", "CREATE TABLE aliases (id INTEGER PRIMARY KEY, owner INTEGER, display_name BLOB NOT NULL, UNIQUE(owner, display_name))"},
+        {"chat_day_counts", "CREATE TABLE chat_day_counts (chat_id INTEGER NOT NULL, day INTEGER NOT NULL, count INTEGER NOT NULL DEFAULT 0, PRIMARY KEY (chat_id, day))"},
+        {"chat_read_state", "CREATE TABLE chat_read_state (chat_id INTEGER PRIMARY KEY, last_read_id INTEGER NOT NULL DEFAULT 0, unread_count INTEGER NOT NULL DEFAULT 0)"},
         {"faux_offline_pending", "CREATE TABLE faux_offline_pending (id INTEGER PRIMARY KEY)"},
-        {"file_transfers", "CREATE TABLE file_transfers (id INTEGER PRIMARY KEY, chat_id INTEGER NOT NULL, file_restart_id BLOB NOT NULL, file_name BLOB NOT NULL, file_path BLOB NOT NULL, file_hash BLOB NOT NULL, file_size INTEGER NOT NULL, direction INTEGER NOT NULL, file_state INTEGER NOT NULL)"},
+        {"file_transfers", "CREATE TABLE file_transfers (id INTEGER PRIMARY KEY, chat_id INTEGER NOT NULL, file_restart_id BLOB NOT NULL, file_name BLOB NOT NULL, file_path BLOB NOT NULL, file_hash BLOB NOT NULL, file_size INTEGER NOT NULL, direction INTEGER NOT NULL, file_state INTEGER NOT NULL, completed_bytes INTEGER NOT NULL DEFAULT 0, timestamp INTEGER NOT NULL DEFAULT 0)"},
         {"history", "CREATE TABLE history (id INTEGER PRIMARY KEY, timestamp INTEGER NOT NULL, chat_id INTEGER NOT NULL, sender_alias INTEGER NOT NULL, message BLOB NOT NULL, file_id INTEGER)"},
+        {"message_urls", "CREATE TABLE message_urls (id INTEGER PRIMARY KEY, chat_id INTEGER NOT NULL, history_id INTEGER NOT NULL, timestamp INTEGER NOT NULL, url TEXT NOT NULL)"},
         {"peers", "CREATE TABLE peers (id INTEGER PRIMARY KEY, public_key TEXT NOT NULL UNIQUE)"}
     };
     verifyDb(db, expectedSql);
@@ -117,29 +203,109 @@ void TestDbSchema::test0to1()
         {"peers", "CREATE TABLE peers (id INTEGER PRIMARY KEY, public_key TEXT NOT NULL UNIQUE)"}
     };
     auto db = std::shared_ptr<RawDatabase>{new RawDatabase{"test0to1.db", {}, {}}};
+    createSchemaAtVersion(db, 1);
+    verifyDb(db, expectedSql);
+}
+
+void TestDbSchema::test1to2()
+{
+    auto db = std::shared_ptr<RawDatabase>{new RawDatabase{"test1to2.db", {}, {}}};
     QVector<RawDatabase::Query> queries;
-    queries += RawDatabase::Query(QStringLiteral(
-        "CREATE TABLE peers "
-        "(id INTEGER PRIMARY KEY, "
-        "public_key TEXT NOT NULL UNIQUE);"
-        "CREATE TABLE aliases "
-        "(id INTEGER PRIMARY KEY, "
-        "owner INTEGER, "
-        "display_name BLOB NOT NULL, "
-        "UNIQUE(owner, display_name));"
-        "CREATE TABLE history "
-        "(id INTEGER PRIMARY KEY, "
-        "timestamp INTEGER NOT NULL, "
-        "chat_id INTEGER NOT NULL, "
-        "sender_alias INTEGER NOT NULL, "
-        "message BLOB NOT NULL);"
-        "CREATE TABLE faux_offline_pending "
-        "(id INTEGER PRIMARY KEY);"));
+    generateCurrentSchema(queries);
     QVERIFY(db->execNow(queries));
+    // generateCurrentSchema already includes the index, migrations must match it
+    QVERIFY(db->execNow("DROP INDEX chat_id_idx;"));
     queries.clear();
-    dbSchema0to1(db, queries);
+    dbSchema1to2(queries);
     QVERIFY(db->execNow(queries));
-    verifyDb(db, expectedSql);
+    QVERIFY(indexCount(db, "chat_id_idx") == 1);
+}
+
+void TestDbSchema::test2to3()
+{
+    auto db = std::shared_ptr<RawDatabase>{new RawDatabase{"test2to3.db", {}, {}}};
+    createSchemaAtVersion(db, 2);
+    QVERIFY(!columnExists(db, "file_transfers", "completed_bytes"));
+    QVector<RawDatabase::Query> queries;
+    dbSchema2to3(queries);
+    QVERIFY(db->execNow(queries));
+    QVERIFY(columnExists(db, "file_transfers", "completed_bytes"));
+}
+
+void TestDbSchema::test3to4()
+{
+    auto db = std::shared_ptr<RawDatabase>{new RawDatabase{"test3to4.db", {}, {}}};
+    createSchemaAtVersion(db, 3);
+    QVector<RawDatabase::Query> queries;
+    dbSchema3to4(queries);
+    QVERIFY(db->execNow(queries));
+    QVERIFY(columnExists(db, "message_urls", "url"));
+    QVERIFY(indexCount(db, "message_urls_chat_idx") == 1);
+    QVERIFY(indexCount(db, "file_transfers_chat_idx") == 1);
+}
+
+void TestDbSchema::test4to5()
+{
+    auto db = std::shared_ptr<RawDatabase>{new RawDatabase{"test4to5.db", {}, {}}};
+    createSchemaAtVersion(db, 4);
+    QVector<RawDatabase::Query> queries;
+    dbSchema4to5(queries);
+    QVERIFY(db->execNow(queries));
+    QVERIFY(columnExists(db, "chat_read_state", "unread_count"));
+}
+
+void TestDbSchema::test5to6()
+{
+    auto db = std::shared_ptr<RawDatabase>{new RawDatabase{"test5to6.db", {}, {}}};
+    createSchemaAtVersion(db, 5);
+    // two messages on day 1 and one on day 2 of chat 1, one on day 1 of chat 2;
+    // the backfill must count them per (chat, day)
+    const int64_t day = 24 * 60 * 60 * 1000;
+    QVERIFY(db->execNow(RawDatabase::Query(QStringLiteral(
+        "INSERT INTO history (timestamp, chat_id, sender_alias, message) VALUES "
+        "(%1, 1, 1, 'a'), (%2, 1, 1, 'b'), (%3, 1, 1, 'c'), (%4, 2, 1, 'd');")
+        .arg(day + 1).arg(day + 2).arg(2 * day + 1).arg(day + 3))));
+    QVector<RawDatabase::Query> queries;
+    dbSchema5to6(queries);
+    QVERIFY(db->execNow(queries));
+    QMap<QPair<int64_t, int64_t>, int64_t> counts;
+    QVERIFY(db->execNow(RawDatabase::Query(QStringLiteral(
+        "SELECT chat_id, day, count FROM chat_day_counts;"),
+        [&](const QVector<QVariant>& row) {
+            counts[{row[0].toLongLong(), row[1].toLongLong()}] = row[2].toLongLong();
+        })));
+    QVERIFY(counts.size() == 3);
+    QVERIFY((counts[{1, 1}]) == 2);
+    QVERIFY((counts[{1, 2}]) == 1);
+    QVERIFY((counts[{2, 1}]) == 1);
+}
+
+void TestDbSchema::test6to7()
+{
+    auto db = std::shared_ptr<RawDatabase>{new RawDatabase{"test6to7.db", {}, {}}};
+    createSchemaAtVersion(db, 6);
+    // a transfer whose date lives on its history row, and an orphaned one
+    QVERIFY(db->execNow(RawDatabase::Query(QStringLiteral(
+        "INSERT INTO file_transfers (id, chat_id, file_restart_id, file_name, file_path, "
+        "file_hash, file_size, direction, file_state) VALUES "
+        "(1, 1, '', 'a.txt', '', '', 10, 0, 5), "
+        "(2, 1, '', 'b.txt', '', '', 20, 1, 4);"
+        "INSERT INTO history (timestamp, chat_id, sender_alias, message, file_id) "
+        "VALUES (4242, 1, 1, '', 1);"))));
+    QVector<RawDatabase::Query> queries;
+    dbSchema6to7(queries);
+    QVERIFY(db->execNow(queries));
+    QMap<int64_t, int64_t> timestamps;
+    QVERIFY(db->execNow(RawDatabase::Query(QStringLiteral(
+        "SELECT id, timestamp FROM file_transfers;"),
+        [&](const QVector<QVariant>& row) {
+            timestamps[row[0].toLongLong()] = row[1].toLongLong();
+        })));
+    QVERIFY(timestamps[1] == 4242);
+    QVERIFY(timestamps[2] == 0);
+    QVERIFY(indexCount(db, "file_transfers_browser_idx") == 1);
+    // the backfill helper index must not outlive the migration
+    QVERIFY(indexCount(db, "history_file_id_backfill_idx") == 0);
 }
 
 QTEST_GUILESS_MAIN(TestDbSchema)
@@ -0,0 +1,170 @@
+/*
+    Copyright © 2019 by The qTox Project Contributors
+
+    This file is part of qTox, a Qt-based graphical interface for Tox.
+
+    qTox is libre software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    qTox is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with qTox.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Not a test: a standalone microbenchmark for the VideoFrame conversion
+// pipeline. Build the qtox_bench_video target and run it manually; it prints
+// one JSON line per run so results can be compared across revisions and
+// platforms. Each scenario is measured cold (a fresh VideoFrame per call, so
+// every conversion runs) and cached (repeated calls on one instance, hitting
+// the internal buffer cache).
+
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+
+#include "src/video/videoframe.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSize>
+
+#include <cstring>
+
+namespace {
+// Each measurement loop runs for at least this long
+constexpr qint64 measureMs = 300;
+
+struct Scenario
+{
+    int width;
+    int height;
+    int pixFmt;
+    const char* name;
+};
+
+const Scenario scenarios[] = {
+    {640, 480, AV_PIX_FMT_YUV420P, "640x480 yuv420p"},
+    {1280, 720, AV_PIX_FMT_YUV420P, "1280x720 yuv420p"},
+    {1920, 1080, AV_PIX_FMT_YUV420P, "1920x1080 yuv420p"},
+    {1280, 720, AV_PIX_FMT_RGB24, "1280x720 rgb24"},
+    {1920, 1080, AV_PIX_FMT_RGB24, "1920x1080 rgb24"},
+};
+
+/**
+ * @brief Allocates a source frame filled with a synthetic gradient.
+ */
+AVFrame* makeSourceFrame(const Scenario& scenario)
+{
+    AVFrame* frame = av_frame_alloc();
+    if (!frame) {
+        return nullptr;
+    }
+
+    frame->width = scenario.width;
+    frame->height = scenario.height;
+    frame->format = scenario.pixFmt;
+
+    if (av_frame_get_buffer(frame, VideoFrame::dataAlignment) != 0) {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+
+    for (int plane = 0; plane < AV_NUM_DATA_POINTERS && frame->data[plane]; ++plane) {
+        const int planeHeight = (scenario.pixFmt == AV_PIX_FMT_YUV420P && plane > 0)
+                                    ? scenario.height / 2
+                                    : scenario.height;
+        for (int line = 0; line < planeHeight; ++line) {
+            memset(frame->data[plane] + line * frame->linesize[plane],
+                   (line + plane * 85) & 0xff, frame->linesize[plane]);
+        }
+    }
+
+    return frame;
+}
+
+/**
+ * @brief Calls fn in a loop for at least measureMs, returns calls per second.
+ */
+template <typename Fn>
+double callsPerSecond(Fn&& fn)
+{
+    QElapsedTimer timer;
+    timer.start();
+    qint64 calls = 0;
+    do {
+        fn();
+        ++calls;
+    } while (timer.elapsed() < measureMs);
+
+    return calls / (timer.nsecsElapsed() / 1e9);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Q_UNUSED(argc)
+    Q_UNUSED(argv)
+
+    QJsonArray results;
+
+    VideoFrame::IDType sourceId = 0;
+    for (const Scenario& scenario : scenarios) {
+        AVFrame* source = makeSourceFrame(scenario);
+        if (!source) {
+            fprintf(stderr, "Failed to allocate %s source frame\n", scenario.name);
+            return EXIT_FAILURE;
+        }
+
+        ++sourceId;
+
+        // fresh instance per call: every conversion actually runs
+        const double qimageColdFps = callsPerSecond([&]() {
+            VideoFrame frame{sourceId, source, false};
+            frame.toQImage({});
+        });
+        const double avframeColdFps = callsPerSecond([&]() {
+            VideoFrame frame{sourceId, source, false};
+            frame.getAVFrame({}, AV_PIX_FMT_RGB24, false);
+        });
+        const double yuvColdFps = callsPerSecond([&]() {
+            VideoFrame frame{sourceId, source, false};
+            frame.toToxYUVFrame({});
+        });
+
+        // one instance: repeated calls hit the internal buffer cache. Scoped
+        // so the instance is gone before the source frame is freed.
+        double qimageCachedFps;
+        double avframeCachedFps;
+        {
+            VideoFrame cachedFrame{sourceId, source, false};
+            qimageCachedFps = callsPerSecond([&]() { cachedFrame.toQImage({}); });
+            avframeCachedFps =
+                callsPerSecond([&]() { cachedFrame.getAVFrame({}, AV_PIX_FMT_RGB24, false); });
+        }
+
+        QJsonObject result;
+        result["scenario"] = scenario.name;
+        result["toqimage_fps_cold"] = qimageColdFps;
+        result["toqimage_fps_cached"] = qimageCachedFps;
+        result["toavframe_rgb24_fps_cold"] = avframeColdFps;
+        result["toavframe_rgb24_fps_cached"] = avframeCachedFps;
+        result["totoxyuv_fps_cold"] = yuvColdFps;
+        results.append(result);
+
+        av_frame_free(&source);
+    }
+
+    QJsonObject root;
+    root["benchmark"] = QStringLiteral("qtox_bench_video");
+    root["scenarios"] = results;
+
+    printf("%s\n", QJsonDocument(root).toJson(QJsonDocument::Compact).constData());
+    return EXIT_SUCCESS;
+}